@@ -21,6 +21,7 @@ int main(int argc, char *argv[])
     size_t bufsize;
     options.bench = COLLECTIVE;
     options.subtype = LAT;
+    options.backend = BACKEND_MPI;
 
     set_header(HEADER);
     set_benchmark_name("osu_allgather");
@@ -67,23 +68,28 @@ int main(int argc, char *argv[])
         options.max_message_size = options.max_mem_limit / numprocs;
     }
 
-    if (allocate_memory_coll((void**)&sendbuf, options.max_message_size, options.accel)) {
+    if (allocate_rotating_buffer((void**)&sendbuf, options.max_message_size, options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
     }
     set_buffer(sendbuf, options.accel, 1, options.max_message_size);
 
     bufsize = options.max_message_size * numprocs;
-    if (allocate_memory_coll((void**)&recvbuf, bufsize,
+    if (allocate_rotating_buffer((void**)&recvbuf, bufsize,
                 options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
     }
     set_buffer(recvbuf, options.accel, 0, bufsize);
 
+    if (BACKEND_NCCL == options.backend && init_nccl()) {
+        fprintf(stderr, "Could Not Initialize NCCL [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
     print_preamble(rank);
 
-    for(size=options.min_message_size; size <= options.max_message_size; size *= 2) {
+    for(size=options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
 
         if(size > LARGE_MESSAGE_SIZE) {
             options.skip = options.skip_large;
@@ -92,15 +98,23 @@ int main(int argc, char *argv[])
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
         timer=0.0;
-        for(i=0; i < options.iterations + options.skip ; i++) {
-            t_start = MPI_Wtime();
-            MPI_CHECK(MPI_Allgather( sendbuf, size, MPI_CHAR,
-                           recvbuf, size, MPI_CHAR, MPI_COMM_WORLD ));
-
-            t_stop = MPI_Wtime();
+        for(i=0; continue_iterations(i); i++) {
+            t_start = osu_wtime();
+            if (BACKEND_NCCL == options.backend) {
+                t_stop = t_start + nccl_collective(NCCL_ALLGATHER,
+                        rotate_buffer(sendbuf, size, i),
+                        rotate_buffer(recvbuf, size * numprocs, i), size,
+                        MPI_CHAR, MPI_OP_NULL, 0);
+            } else {
+                MPI_CHECK(MPI_Allgather(rotate_buffer(sendbuf, size, i), size, MPI_CHAR,
+                               rotate_buffer(recvbuf, size * numprocs, i), size, MPI_CHAR, MPI_COMM_WORLD ));
+
+                t_stop = osu_wtime();
+            }
 
             if(i >= options.skip) {
                 timer+= t_stop-t_start;
+                record_latency(t_stop - t_start);
             }
             MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
@@ -122,6 +136,10 @@ int main(int argc, char *argv[])
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
     }
 
+    if (BACKEND_NCCL == options.backend) {
+        cleanup_nccl();
+    }
+
     free_buffer(sendbuf, options.accel);
     free_buffer(recvbuf, options.accel);
 
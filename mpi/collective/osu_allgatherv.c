@@ -77,14 +77,14 @@ int main(int argc, char *argv[])
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
     }
 
-    if (allocate_memory_coll((void**)&sendbuf, options.max_message_size, options.accel)) {
+    if (allocate_rotating_buffer((void**)&sendbuf, options.max_message_size, options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
     }
     set_buffer(sendbuf, options.accel, 1, options.max_message_size);
 
     bufsize = options.max_message_size * numprocs;
-    if (allocate_memory_coll((void**)&recvbuf, bufsize,
+    if (allocate_rotating_buffer((void**)&recvbuf, bufsize,
                 options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
@@ -93,7 +93,7 @@ int main(int argc, char *argv[])
 
     print_preamble(rank);
 
-    for(size=options.min_message_size; size <= options.max_message_size; size *= 2) {
+    for(size=options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         if(size > LARGE_MESSAGE_SIZE) {
             options.skip = options.skip_large;
             options.iterations = options.iterations_large;
@@ -110,16 +110,18 @@ int main(int argc, char *argv[])
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
         timer=0.0;
-        for(i=0; i < options.iterations + options.skip ; i++) {
+        for(i=0; continue_iterations(i); i++) {
 
-            t_start = MPI_Wtime();
+            t_start = osu_wtime();
 
-            MPI_CHECK(MPI_Allgatherv(sendbuf, size, MPI_CHAR, recvbuf, recvcounts, rdispls, MPI_CHAR, MPI_COMM_WORLD));
+            MPI_CHECK(MPI_Allgatherv(rotate_buffer(sendbuf, size, i), size, MPI_CHAR,
+                        rotate_buffer(recvbuf, size * numprocs, i), recvcounts, rdispls, MPI_CHAR, MPI_COMM_WORLD));
 
-            t_stop = MPI_Wtime();
+            t_stop = osu_wtime();
 
             if(i >= options.skip) {
                 timer+= t_stop-t_start;
+                record_latency(t_stop - t_start);
             }
             MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
@@ -16,11 +16,29 @@ int main(int argc, char *argv[])
     double latency = 0.0, t_start = 0.0, t_stop = 0.0;
     double timer=0.0;
     double avg_time = 0.0, max_time = 0.0, min_time = 0.0;
-    float *sendbuf, *recvbuf;
+    double min_setting = 0.0, max_setting = 0.0;
+    int setting;
+    int pass;
+    int skew;
+    MPI_Comm comm;
+    void *sendbuf, *recvbuf;
+    MPI_Datatype dtype;
+    MPI_Op op;
+    size_t dtype_size;
     int po_ret;
     size_t bufsize;
     options.bench = COLLECTIVE;
     options.subtype = LAT;
+    options.backend = BACKEND_MPI;
+    options.mem_footprint = MEM_FOOTPRINT_OFF;
+    options.pvars = PVARS_OFF;
+    options.counters = COUNTERS_OFF;
+    options.back_to_back = BACK_TO_BACK_OFF;
+    options.skew = SKEW_OFF;
+    options.tune = TUNE_OFF;
+    options.dtype = DTYPE_FLOAT;
+    options.hierarchical = HIER_OFF;
+    options.pipeline = PIPELINE_OFF;
 
     set_header(HEADER);
     set_benchmark_name("osu_allreduce");
@@ -33,7 +51,9 @@ int main(int argc, char *argv[])
         }
     }
 
+    mem_footprint_sample(MEM_BEFORE_INIT, 0);
     MPI_CHECK(MPI_Init(&argc, &argv));
+    mem_footprint_sample(MEM_AFTER_INIT, 0);
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
 
@@ -72,28 +92,71 @@ int main(int argc, char *argv[])
         options.max_message_size = options.max_mem_limit;
     }
 
-    options.min_message_size /= sizeof(float);
+    dtype = reduction_datatype();
+    op = reduction_op();
+    dtype_size = reduction_extent();
+
+    options.min_message_size /= dtype_size;
     if (options.min_message_size < MIN_MESSAGE_SIZE) {
         options.min_message_size = MIN_MESSAGE_SIZE;
     }
 
-    bufsize = sizeof(float)*(options.max_message_size/sizeof(float));
-    if (allocate_memory_coll((void**)&sendbuf, bufsize, options.accel)) {
+    bufsize = dtype_size*(options.max_message_size/dtype_size);
+    if (allocate_rotating_buffer((void**)&sendbuf, bufsize, options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
     }
     set_buffer(sendbuf, options.accel, 1, bufsize);
 
-    bufsize = sizeof(float)*(options.max_message_size/sizeof(float));
-    if (allocate_memory_coll((void**)&recvbuf, bufsize, options.accel)) {
+    bufsize = dtype_size*(options.max_message_size/dtype_size);
+    if (allocate_rotating_buffer((void**)&recvbuf, bufsize, options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
     }
     set_buffer(recvbuf, options.accel, 0, bufsize);
 
+    if (HIER_ON == options.hierarchical && setup_hierarchy(bufsize, 1)) {
+        fprintf(stderr, "Could Not Allocate Shared Segment [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    if (BACKEND_NCCL == options.backend && init_nccl()) {
+        fprintf(stderr, "Could Not Initialize NCCL [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    mem_footprint_sample(MEM_AFTER_ALLOC, 0);
+
+    if (setup_pvars(rank)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(PVARS_LIST == options.pvars ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    if (setup_counters(rank)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (setup_back_to_back(rank)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (setup_arrival_skew(rank)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    skew = SKEW_OFF != options.skew;
+
+    if (setup_tuning(rank)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
     print_preamble(rank);
 
-    for(size=options.min_message_size; size*sizeof(float) <= options.max_message_size; size *= 2) {
+    for(size=options.min_message_size; size*dtype_size <= options.max_message_size; size = next_message_count(size, dtype_size)) {
 
         if(size > LARGE_MESSAGE_SIZE) {
             options.skip = options.skip_large;
@@ -102,33 +165,140 @@ int main(int argc, char *argv[])
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
-        timer=0.0;
-        for(i=0; i < options.iterations + options.skip ; i++) {
-            t_start = MPI_Wtime();
-            MPI_CHECK(MPI_Allreduce(sendbuf, recvbuf, size, MPI_FLOAT, MPI_SUM, MPI_COMM_WORLD ));
-            t_stop=MPI_Wtime();
-            if(i>=options.skip){
+        start_pvars();
+        start_counters();
+        start_arrival_skew();
+        for (setting = 0; setting < num_tune_settings(); setting++) {
+            comm = apply_tune_setting(setting);
+
+            timer=0.0;
+            for(i=0; continue_iterations(i); i++) {
+                if (skew) {
+                    arrival_delay();
+                }
+
+                t_start = osu_wtime();
+                if (BACKEND_NCCL == options.backend) {
+                    t_stop = t_start + nccl_collective(NCCL_ALLREDUCE,
+                            rotate_buffer(sendbuf, size * dtype_size, i),
+                            rotate_buffer(recvbuf, size * dtype_size, i), size,
+                            dtype, op, 0);
+                } else {
+                    MPI_CHECK(MPI_Allreduce(rotate_buffer(sendbuf, size * dtype_size, i),
+                                rotate_buffer(recvbuf, size * dtype_size, i), size, dtype, op, comm));
+                    t_stop=osu_wtime();
+                }
+
+                if (skew && i >= options.skip) {
+                    record_arrival(i - options.skip, t_start, t_stop);
+                }
+
+                if(i>=options.skip){
+
+                timer+=t_stop-t_start;
+                record_latency(t_stop - t_start);
+                }
+                MPI_CHECK(MPI_Barrier(comm));
+            }
+            latency = (double)(timer * 1e6) / options.iterations;
+
+            MPI_CHECK(MPI_Reduce(&latency, &min_setting, 1, MPI_DOUBLE,
+                    MPI_MIN, 0, MPI_COMM_WORLD));
+            MPI_CHECK(MPI_Reduce(&latency, &max_setting, 1, MPI_DOUBLE,
+                    MPI_MAX, 0, MPI_COMM_WORLD));
+            MPI_CHECK(MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM,
+                    0, MPI_COMM_WORLD));
+
+            if (0 == rank && record_tune_result(setting, avg_time / numprocs)) {
+                min_time = min_setting;
+                max_time = max_setting;
+            }
+        }
+        stop_pvars();
+        stop_counters((options.iterations + options.skip) *
+                num_tune_settings());
+        stop_arrival_skew();
+        avg_time = finish_tune_size(size * dtype_size);
+
+        if (HIER_ON == options.hierarchical) {
+            timer = 0.0;
+            for (i = 0; i < options.iterations + options.skip; i++) {
+                t_start = osu_wtime();
+                hier_allreduce(rotate_buffer(sendbuf, size * dtype_size, i),
+                        rotate_buffer(recvbuf, size * dtype_size, i), size,
+                        dtype, op);
+                t_stop = osu_wtime();
+                if (i >= options.skip) {
+                    timer += t_stop - t_start;
+                }
+                MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+            }
+            latency = (double)(timer * 1e6) / options.iterations;
+
+            MPI_CHECK(MPI_Reduce(&latency, &hierarchical_latency, 1,
+                        MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD));
+            hierarchical_latency /= numprocs;
+        }
 
-            timer+=t_stop-t_start;
+        if (PIPELINE_ON == options.pipeline) {
+            timer = 0.0;
+            for (i = 0; i < options.iterations + options.skip; i++) {
+                t_start = osu_wtime();
+                pipelined_allreduce(rotate_buffer(sendbuf, size * dtype_size, i),
+                        rotate_buffer(recvbuf, size * dtype_size, i), size,
+                        dtype, op);
+                t_stop = osu_wtime();
+                if (i >= options.skip) {
+                    timer += t_stop - t_start;
+                }
+                MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
             }
-            MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+            latency = (double)(timer * 1e6) / options.iterations;
+
+            MPI_CHECK(MPI_Reduce(&latency, &pipelined_latency, 1,
+                        MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD));
+            pipelined_latency /= numprocs;
         }
-        latency = (double)(timer * 1e6) / options.iterations;
 
-        MPI_CHECK(MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
-                MPI_COMM_WORLD));
-        MPI_CHECK(MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0,
-                MPI_COMM_WORLD));
-        MPI_CHECK(MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0,
-                MPI_COMM_WORLD));
-        avg_time = avg_time/numprocs;
+        for (pass = 0; pass < back_to_back_passes(); pass++) {
+            start_back_to_back(pass);
+            for (i = 0; i < options.iterations; i++) {
+                back_to_back_delay(pass);
+                if (BACKEND_NCCL == options.backend) {
+                    nccl_collective(NCCL_ALLREDUCE,
+                            rotate_buffer(sendbuf, size * dtype_size, i),
+                            rotate_buffer(recvbuf, size * dtype_size, i), size,
+                            dtype, op, 0);
+                } else {
+                    MPI_CHECK(MPI_Allreduce(rotate_buffer(sendbuf,
+                                    size * dtype_size, i),
+                                rotate_buffer(recvbuf, size * dtype_size, i),
+                                size, dtype, op, MPI_COMM_WORLD));
+                }
+            }
+            stop_back_to_back(pass, options.iterations);
+        }
 
-        print_stats(rank, size * sizeof(float), avg_time, min_time, max_time);
+        print_stats(rank, size * dtype_size, avg_time, min_time, max_time);
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+        mem_footprint_sample(MEM_AFTER_SIZE, size * dtype_size);
+    }
+
+    print_tuning_table(rank);
+    mem_footprint_report(rank);
+    cleanup_pvars();
+    cleanup_counters();
+    cleanup_arrival_skew();
+    cleanup_tuning();
+
+    if (BACKEND_NCCL == options.backend) {
+        cleanup_nccl();
     }
 
     free_buffer(sendbuf, options.accel);
     free_buffer(recvbuf, options.accel);
+    free_reduction_op();
+    cleanup_hierarchy();
 
     MPI_CHECK(MPI_Finalize());
 
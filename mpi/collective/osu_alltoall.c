@@ -19,9 +19,19 @@ main (int argc, char *argv[])
     double avg_time = 0.0, max_time = 0.0, min_time = 0.0;
     char * sendbuf = NULL, * recvbuf = NULL;
     int po_ret;
+    int mark;
+    int pass;
+    int skew;
     size_t bufsize;
     options.bench = COLLECTIVE;
     options.subtype = LAT;
+    options.backend = BACKEND_MPI;
+    options.mem_footprint = MEM_FOOTPRINT_OFF;
+    options.pvars = PVARS_OFF;
+    options.counters = COUNTERS_OFF;
+    options.global_clock = GLOBAL_CLOCK_OFF;
+    options.back_to_back = BACK_TO_BACK_OFF;
+    options.skew = SKEW_OFF;
 
     set_header(HEADER);
     set_benchmark_name("osu_alltoall");
@@ -34,7 +44,9 @@ main (int argc, char *argv[])
         }
     }
 
+    mem_footprint_sample(MEM_BEFORE_INIT, 0);
     MPI_CHECK(MPI_Init(&argc, &argv));
+    mem_footprint_sample(MEM_AFTER_INIT, 0);
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
 
@@ -70,23 +82,60 @@ main (int argc, char *argv[])
 
     bufsize = options.max_message_size * numprocs;
 
-    if (allocate_memory_coll((void**)&sendbuf, bufsize, options.accel)) {
+    if (allocate_rotating_buffer((void**)&sendbuf, bufsize, options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
     }
 
     set_buffer(sendbuf, options.accel, 1, bufsize);
 
-    if (allocate_memory_coll((void**)&recvbuf, options.max_message_size * numprocs,
+    if (allocate_rotating_buffer((void**)&recvbuf, options.max_message_size * numprocs,
                 options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
     }
 
     set_buffer(recvbuf, options.accel, 0, bufsize);
+
+    if (BACKEND_NCCL == options.backend && init_nccl()) {
+        fprintf(stderr, "Could Not Initialize NCCL [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    mem_footprint_sample(MEM_AFTER_ALLOC, 0);
+
+    if (setup_pvars(rank)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(PVARS_LIST == options.pvars ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    if (setup_counters(rank)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (setup_global_clock(rank)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (setup_back_to_back(rank)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (setup_arrival_skew(rank)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    skew = SKEW_OFF != options.skew;
+
+    mark = GLOBAL_CLOCK_ON == options.global_clock;
+
     print_preamble(rank);
 
-    for(size=options.min_message_size; size <= options.max_message_size; size *= 2) {
+    for(size=options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         if (size > LARGE_MESSAGE_SIZE) {
             options.skip = options.skip_large;
             options.iterations = options.iterations_large;
@@ -94,18 +143,51 @@ main (int argc, char *argv[])
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
         timer=0.0;
+        start_global_clock();
+        start_pvars();
+        start_counters();
+        start_arrival_skew();
+
+        for(i=0; continue_iterations(i); i++) {
+            if (skew) {
+                arrival_delay();
+            }
+
+            if (mark && i >= options.skip) {
+                mark_global_time(GT_ENTRY, i - options.skip);
+            }
+
+            t_start = osu_wtime();
+            if (BACKEND_NCCL == options.backend) {
+                t_stop = t_start + nccl_collective(NCCL_ALLTOALL,
+                        rotate_buffer(sendbuf, size * numprocs, i),
+                        rotate_buffer(recvbuf, size * numprocs, i), size,
+                        MPI_CHAR, MPI_OP_NULL, 0);
+            } else {
+                MPI_CHECK(MPI_Alltoall(rotate_buffer(sendbuf, size * numprocs, i), size, MPI_CHAR,
+                        rotate_buffer(recvbuf, size * numprocs, i), size, MPI_CHAR,
+                        MPI_COMM_WORLD));
+                t_stop = osu_wtime();
+            }
 
-        for (i=0; i < options.iterations + options.skip ; i++) {
-            t_start = MPI_Wtime();
-            MPI_CHECK(MPI_Alltoall(sendbuf, size, MPI_CHAR, recvbuf, size, MPI_CHAR,
-                    MPI_COMM_WORLD));
-            t_stop = MPI_Wtime();
+            if (skew && i >= options.skip) {
+                record_arrival(i - options.skip, t_start, t_stop);
+            }
+
+            if (mark && i >= options.skip) {
+                mark_global_time(GT_EXIT, i - options.skip);
+            }
 
             if (i >= options.skip) {
                 timer+=t_stop-t_start;
+                record_latency(t_stop - t_start);
             }
             MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
         }
+        stop_pvars();
+        stop_counters(i);
+        stop_arrival_skew();
+        stop_global_clock(i - options.skip);
         latency = (double)(timer * 1e6) / options.iterations;
 
         MPI_CHECK(MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
@@ -116,8 +198,38 @@ main (int argc, char *argv[])
                 MPI_COMM_WORLD));
         avg_time = avg_time/numprocs;
 
+        for (pass = 0; pass < back_to_back_passes(); pass++) {
+            start_back_to_back(pass);
+            for (i = 0; i < options.iterations; i++) {
+                back_to_back_delay(pass);
+                if (BACKEND_NCCL == options.backend) {
+                    nccl_collective(NCCL_ALLTOALL,
+                            rotate_buffer(sendbuf, size * numprocs, i),
+                            rotate_buffer(recvbuf, size * numprocs, i), size,
+                            MPI_CHAR, MPI_OP_NULL, 0);
+                } else {
+                    MPI_CHECK(MPI_Alltoall(rotate_buffer(sendbuf,
+                                    size * numprocs, i), size, MPI_CHAR,
+                                rotate_buffer(recvbuf, size * numprocs, i),
+                                size, MPI_CHAR, MPI_COMM_WORLD));
+                }
+            }
+            stop_back_to_back(pass, options.iterations);
+        }
+
         print_stats(rank, size, avg_time, min_time, max_time);
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+        mem_footprint_sample(MEM_AFTER_SIZE, size);
+    }
+
+    mem_footprint_report(rank);
+    cleanup_pvars();
+    cleanup_counters();
+    cleanup_arrival_skew();
+    cleanup_global_clock();
+
+    if (BACKEND_NCCL == options.backend) {
+        cleanup_nccl();
     }
 
     free_buffer(sendbuf, options.accel);
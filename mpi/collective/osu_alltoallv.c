@@ -12,16 +12,17 @@
 
 int main(int argc, char *argv[])
 {
-    int i = 0, rank = 0, size, numprocs, disp;
+    int i = 0, rank = 0, size, numprocs;
     double latency=0.0, t_start = 0.0, t_stop = 0.0;
     double timer=0.0;
     double avg_time = 0.0, max_time = 0.0, min_time = 0.0;
     char *sendbuf=NULL, *recvbuf=NULL;
     int *rdispls=NULL, *recvcounts=NULL, *sdispls=NULL, *sendcounts=NULL;
     int po_ret;
-    size_t bufsize;
+    size_t bufsize, footprint;
     options.bench = COLLECTIVE;
     options.subtype = LAT;
+    options.count_dist = COUNTS_UNIFORM;
 
     set_header(HEADER);
     set_benchmark_name("osu_alltoallv");
@@ -68,6 +69,10 @@ int main(int argc, char *argv[])
         options.max_message_size = options.max_mem_limit / numprocs;
     }
 
+    if (setup_count_distribution(rank, numprocs)) {
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
     if (allocate_memory_coll((void**)&recvcounts, numprocs*sizeof(int), NONE)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
@@ -86,14 +91,14 @@ int main(int argc, char *argv[])
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
     }
 
-    bufsize = options.max_message_size * numprocs;
-    if (allocate_memory_coll((void**)&sendbuf, bufsize, options.accel)) {
+    bufsize = count_buffer_size(numprocs);
+    if (allocate_rotating_buffer((void**)&sendbuf, bufsize, options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
     }
     set_buffer(sendbuf, options.accel, 1, bufsize);
 
-    if (allocate_memory_coll((void**)&recvbuf, bufsize,
+    if (allocate_rotating_buffer((void**)&recvbuf, bufsize,
                 options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
@@ -104,36 +109,31 @@ int main(int argc, char *argv[])
 
     MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
-    for(size=options.min_message_size; size <= options.max_message_size; size *= 2) {
+    for(size=options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         if(size > LARGE_MESSAGE_SIZE) {
             options.skip = options.skip_large;
             options.iterations = options.iterations_large;
         }
 
-        disp =0;
-        for ( i = 0; i < numprocs; i++) {
-            recvcounts[i] = size;
-            sendcounts[i] = size;
-            rdispls[i] = disp;
-            sdispls[i] = disp;
-            disp += size;
-
-        }
+        footprint = set_counts(rank, numprocs, size, sendcounts, sdispls,
+                recvcounts, rdispls);
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
         timer=0.0;
-        for(i = 0; i < options.iterations + options.skip; i++) {
-            t_start = MPI_Wtime();
+        for(i=0; continue_iterations(i); i++) {
+            t_start = osu_wtime();
 
-              MPI_CHECK(MPI_Alltoallv(sendbuf, sendcounts, sdispls, MPI_CHAR, recvbuf, recvcounts, rdispls, MPI_CHAR,
+              MPI_CHECK(MPI_Alltoallv(rotate_buffer(sendbuf, footprint, i), sendcounts, sdispls, MPI_CHAR,
+                      rotate_buffer(recvbuf, footprint, i), recvcounts, rdispls, MPI_CHAR,
                       MPI_COMM_WORLD));
 
-            t_stop = MPI_Wtime();
+            t_stop = osu_wtime();
 
             if(i>=options.skip)
             {
                 timer+=t_stop-t_start;
+                record_latency(t_stop - t_start);
             }
             MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
         }
@@ -159,6 +159,7 @@ int main(int argc, char *argv[])
     free_buffer(sendcounts, NONE);
     free_buffer(sendbuf, options.accel);
     free_buffer(recvbuf, options.accel);
+    cleanup_count_distribution();
 
     MPI_CHECK(MPI_Finalize());
 
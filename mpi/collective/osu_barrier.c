@@ -69,13 +69,14 @@ int main(int argc, char *argv[])
 
     timer = 0.0;
 
-    for(i=0; i < options.iterations + options.skip ; i++) {
-        t_start = MPI_Wtime();
+    for(i=0; continue_iterations(i); i++) {
+        t_start = osu_wtime();
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
-        t_stop = MPI_Wtime();
+        t_stop = osu_wtime();
 
         if(i>=options.skip){
             timer+=t_stop-t_start;
+            record_latency(t_stop - t_start);
         }
     }
 
@@ -19,8 +19,20 @@ int main(int argc, char *argv[])
     double timer=0.0;
     char *buffer=NULL;
     int po_ret;
+    int mark;
+    int pass;
+    int skew;
     options.bench = COLLECTIVE;
     options.subtype = LAT;
+    options.backend = BACKEND_MPI;
+    options.mem_footprint = MEM_FOOTPRINT_OFF;
+    options.pvars = PVARS_OFF;
+    options.counters = COUNTERS_OFF;
+    options.global_clock = GLOBAL_CLOCK_OFF;
+    options.back_to_back = BACK_TO_BACK_OFF;
+    options.skew = SKEW_OFF;
+    options.hierarchical = HIER_OFF;
+    options.pipeline = PIPELINE_OFF;
 
     set_header(HEADER);
     set_benchmark_name("osu_bcast");
@@ -33,7 +45,9 @@ int main(int argc, char *argv[])
         }
     }
 
+    mem_footprint_sample(MEM_BEFORE_INIT, 0);
     MPI_CHECK(MPI_Init(&argc, &argv));
+    mem_footprint_sample(MEM_AFTER_INIT, 0);
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
 
@@ -72,34 +86,108 @@ int main(int argc, char *argv[])
         options.max_message_size = options.max_mem_limit;
     }
 
-    if (allocate_memory_coll((void**)&buffer, options.max_message_size, options.accel)) {
+    if (allocate_rotating_buffer((void**)&buffer, options.max_message_size, options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
     }
     set_buffer(buffer, options.accel, 1, options.max_message_size);
 
+    if (HIER_ON == options.hierarchical &&
+            setup_hierarchy(options.max_message_size, 0)) {
+        fprintf(stderr, "Could Not Allocate Shared Segment [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    if (BACKEND_NCCL == options.backend && init_nccl()) {
+        fprintf(stderr, "Could Not Initialize NCCL [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    mem_footprint_sample(MEM_AFTER_ALLOC, 0);
+
+    if (setup_pvars(rank)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(PVARS_LIST == options.pvars ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    if (setup_counters(rank)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (setup_global_clock(rank)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (setup_back_to_back(rank)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (setup_arrival_skew(rank)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    skew = SKEW_OFF != options.skew;
+
+    mark = GLOBAL_CLOCK_ON == options.global_clock;
+
     print_preamble(rank);
 
-    for(size=options.min_message_size; size <= options.max_message_size; size *= 2) {
+    for(size=options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         if(size > LARGE_MESSAGE_SIZE) {
             options.skip = options.skip_large; 
             options.iterations = options.iterations_large;
         }
 
         timer=0.0;
-        for(i=0; i < options.iterations + options.skip ; i++) {
-            t_start = MPI_Wtime();
-            MPI_CHECK(MPI_Bcast(buffer, size, MPI_CHAR, 0, MPI_COMM_WORLD));
-            t_stop = MPI_Wtime();
+        start_global_clock();
+        start_pvars();
+        start_counters();
+        start_arrival_skew();
+        for(i=0; continue_iterations(i); i++) {
+            if (skew) {
+                arrival_delay();
+            }
+
+            if (mark && i >= options.skip) {
+                mark_global_time(GT_ENTRY, i - options.skip);
+            }
+
+            t_start = osu_wtime();
+            if (BACKEND_NCCL == options.backend) {
+                t_stop = t_start + nccl_collective(NCCL_BCAST,
+                        rotate_buffer(buffer, size, i),
+                        rotate_buffer(buffer, size, i), size, MPI_CHAR,
+                        MPI_OP_NULL, 0);
+            } else {
+                MPI_CHECK(MPI_Bcast(rotate_buffer(buffer, size, i), size, MPI_CHAR, 0, MPI_COMM_WORLD));
+                t_stop = osu_wtime();
+            }
+
+            if (skew && i >= options.skip) {
+                record_arrival(i - options.skip, t_start, t_stop);
+            }
+
+            if (mark && i >= options.skip) {
+                mark_global_time(GT_EXIT, i - options.skip);
+            }
 
             if(i>=options.skip){
                 timer+=t_stop-t_start;
+                record_latency(t_stop - t_start);
             }
             MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
         }
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+        stop_pvars();
+        stop_counters(i);
+        stop_arrival_skew();
+        stop_global_clock(i - options.skip);
 
         latency = (timer * 1e6) / options.iterations;
 
@@ -111,10 +199,74 @@ int main(int argc, char *argv[])
                 MPI_COMM_WORLD));
         avg_time = avg_time/numprocs;
 
+        if (HIER_ON == options.hierarchical) {
+            timer = 0.0;
+            for (i = 0; i < options.iterations + options.skip; i++) {
+                t_start = osu_wtime();
+                hier_bcast(rotate_buffer(buffer, size, i), size);
+                t_stop = osu_wtime();
+                if (i >= options.skip) {
+                    timer += t_stop - t_start;
+                }
+                MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+            }
+            latency = (timer * 1e6) / options.iterations;
+
+            MPI_CHECK(MPI_Reduce(&latency, &hierarchical_latency, 1,
+                        MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD));
+            hierarchical_latency /= numprocs;
+        }
+
+        if (PIPELINE_ON == options.pipeline) {
+            timer = 0.0;
+            for (i = 0; i < options.iterations + options.skip; i++) {
+                t_start = osu_wtime();
+                pipelined_bcast(rotate_buffer(buffer, size, i), size);
+                t_stop = osu_wtime();
+                if (i >= options.skip) {
+                    timer += t_stop - t_start;
+                }
+                MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+            }
+            latency = (timer * 1e6) / options.iterations;
+
+            MPI_CHECK(MPI_Reduce(&latency, &pipelined_latency, 1,
+                        MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD));
+            pipelined_latency /= numprocs;
+        }
+
+        for (pass = 0; pass < back_to_back_passes(); pass++) {
+            start_back_to_back(pass);
+            for (i = 0; i < options.iterations; i++) {
+                back_to_back_delay(pass);
+                if (BACKEND_NCCL == options.backend) {
+                    nccl_collective(NCCL_BCAST, rotate_buffer(buffer, size, i),
+                            rotate_buffer(buffer, size, i), size, MPI_CHAR,
+                            MPI_OP_NULL, 0);
+                } else {
+                    MPI_CHECK(MPI_Bcast(rotate_buffer(buffer, size, i), size,
+                                MPI_CHAR, 0, MPI_COMM_WORLD));
+                }
+            }
+            stop_back_to_back(pass, options.iterations);
+        }
+
         print_stats(rank, size, avg_time, min_time, max_time);
+        mem_footprint_sample(MEM_AFTER_SIZE, size);
+    }
+
+    mem_footprint_report(rank);
+    cleanup_pvars();
+    cleanup_counters();
+    cleanup_arrival_skew();
+    cleanup_global_clock();
+
+    if (BACKEND_NCCL == options.backend) {
+        cleanup_nccl();
     }
 
     free_buffer(buffer, options.accel);
+    cleanup_hierarchy();
 
     MPI_CHECK(MPI_Finalize());
 
@@ -0,0 +1,155 @@
+#define BENCHMARK "OSU MPI Large Count MPI_Bcast Bandwidth Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * MPI_Bcast from rank 0 of messages of 1 MB up to 8 GB, past the 2 GB that
+ * an int count can describe.  Messages beyond INT_MAX bytes take MPI_Bcast_c
+ * or a derived datatype, see --large-count, and the Count column shows
+ * which.  The average latency over the ranks is printed with the bandwidth
+ * it gives, the message size over the latency.  Each rank holds a single
+ * buffer and the largest size is lowered to what the memory available on
+ * the nodes holds.
+ */
+
+#include <osu_util_mpi.h>
+
+int main (int argc, char *argv[])
+{
+    int rank, numprocs, i;
+    int po_ret = 0;
+    size_t size, limit;
+    char *buf = NULL;
+    double t_start, t_total, latency, avg_latency;
+
+    options.bench = COLLECTIVE;
+    options.subtype = LARGE_COUNT;
+    options.large_count = LARGE_COUNT_AUTO;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_bcast_large");
+    po_ret = process_options(argc, argv);
+    options.show_size = 0;
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    set_num_ranks(numprocs);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_bad_usage_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (numprocs < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (setup_large_count(rank)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    limit = large_count_memory_limit(MPI_COMM_WORLD, 1);
+    if (limit && options.max_message_size > limit) {
+        if (0 == rank) {
+            fprintf(stderr, "Warning! The nodes only have memory for %zu "
+                    "bytes per rank.\nContinuing with max message size of "
+                    "%zu bytes\n", limit, limit);
+        }
+        options.max_message_size = limit;
+    }
+
+    if (posix_memalign((void **)&buf, getpagesize(),
+                MAX(1, options.max_message_size))) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    fill_host_buffer(buf, 1, options.max_message_size);
+
+    if (0 == rank && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "# Counts beyond %d bytes: %s\n", INT_MAX,
+                LARGE_COUNT_C == options.large_count ? "MPI_Bcast_c" :
+                "derived datatype");
+        fprintf(stdout, "%-*s%*s%*s%*s\n", 14, "# Size", FIELD_WIDTH,
+                "Avg Latency(us)", FIELD_WIDTH, "Bandwidth (MB/s)", 12,
+                "Count");
+        fflush(stdout);
+    }
+
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        t_total = 0.0;
+
+        for (i = 0; i < options.iterations + options.skip; i++) {
+            MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+            t_start = osu_wtime();
+            large_count_bcast(buf, size, 0, MPI_COMM_WORLD);
+
+            if (i >= options.skip) {
+                t_total += osu_wtime() - t_start;
+            }
+        }
+
+        latency = t_total * 1e6 / options.iterations;
+        MPI_CHECK(MPI_Reduce(&latency, &avg_latency, 1, MPI_DOUBLE, MPI_SUM,
+                    0, MPI_COMM_WORLD));
+
+        if (0 != rank) {
+            continue;
+        }
+
+        avg_latency /= numprocs;
+
+        if (OUTPUT_TABLE == options.output_format) {
+            fprintf(stdout, "%-*zu%*.*f%*.*f%*s\n", 14, size, FIELD_WIDTH,
+                    FLOAT_PRECISION, avg_latency, FIELD_WIDTH,
+                    FLOAT_PRECISION, size / avg_latency, 12,
+                    large_count_path(size));
+            fflush(stdout);
+        } else {
+            struct result_metric_t metrics[3] = {
+                {"avg_latency_us", avg_latency},
+                {"bandwidth_MBps", size / avg_latency},
+                {"large_count", size > INT_MAX},
+            };
+
+            output_result(numprocs, size, 3, metrics);
+        }
+    }
+
+    free(buf);
+
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
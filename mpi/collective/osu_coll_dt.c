@@ -0,0 +1,307 @@
+#define BENCHMARK "OSU MPI Derived Datatype Collective Latency Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * MPI_Bcast, MPI_Allgatherv and MPI_Alltoallw of one element of the derived
+ * datatype of osu_latency_dt per rank, built with the vector, indexed,
+ * subarray or struct constructor (-Q) over blocks of -B bytes every -S
+ * bytes, against the same collectives on the same number of contiguous
+ * bytes.  The elements of the ranks lie back to back, one extent of the
+ * datatype apart.  The Overhead column is what the datatype engine of the
+ * library adds to the contiguous latency.
+ */
+
+#include <osu_util_mpi.h>
+
+enum dt_coll {
+    COLL_BCAST,
+    COLL_ALLGATHERV,
+    COLL_ALLTOALLW,
+    COLL_NUM
+};
+
+static char const *coll_name[COLL_NUM] = {"MPI_Bcast", "MPI_Allgatherv",
+    "MPI_Alltoallw"};
+static char const *metric_name[COLL_NUM][3] = {
+    {"bcast_ddt_us", "bcast_contig_us", "bcast_overhead_pct"},
+    {"allgatherv_ddt_us", "allgatherv_contig_us", "allgatherv_overhead_pct"},
+    {"alltoallw_ddt_us", "alltoallw_contig_us", "alltoallw_overhead_pct"},
+};
+
+static char *sendbuf, *recvbuf;
+static int *counts, *displs, *byte_displs;
+static MPI_Datatype *types;
+
+static MPI_Aint dt_extent (int size);
+static void setup_layout (int nprocs, MPI_Datatype type, int count,
+        MPI_Aint extent);
+static void run_coll (enum dt_coll coll, MPI_Datatype type, int count);
+static double time_coll (enum dt_coll coll, MPI_Datatype type, int count,
+        int iterations, int skip);
+
+int main (int argc, char *argv[])
+{
+    int rank, nprocs, size, bytes, iterations, skip, c;
+    int po_ret = PO_OKAY;
+    size_t bufsize;
+    double ddt[COLL_NUM], contig[COLL_NUM], overhead[COLL_NUM];
+    MPI_Aint lb, extent;
+    MPI_Datatype type;
+    struct result_metric_t metrics[3 * COLL_NUM];
+
+    options.bench = COLLECTIVE;
+    options.subtype = COLL_DT;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_coll_dt");
+    po_ret = process_options(argc, argv);
+
+    if (PO_OKAY == po_ret && (0 == options.dt_block_size ||
+                options.dt_block_size > options.dt_stride_size)) {
+        bad_usage.message = "Block Size Must Be Between 1 and the Stride Size";
+        bad_usage.opt = 'B';
+        bad_usage.optarg = NULL;
+        po_ret = PO_BAD_USAGE;
+    }
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_bad_usage_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (nprocs < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    /* Every message size is a whole number of blocks */
+    options.min_message_size = MAX(options.min_message_size,
+            (size_t)options.dt_block_size);
+
+    if (options.max_message_size / options.dt_block_size >
+            MAX_DT_REPEAT_COUNT) {
+        options.max_message_size = (size_t)options.dt_block_size *
+            MAX_DT_REPEAT_COUNT;
+    }
+
+    /* MPI_Allgatherv and MPI_Alltoallw hold an extent for every rank */
+    while (options.max_message_size > options.min_message_size &&
+            nprocs * dt_extent(options.max_message_size) >
+            options.max_mem_limit) {
+        options.max_message_size /= 2;
+    }
+
+    if (options.max_message_size < options.min_message_size) {
+        if (rank == 0) {
+            fprintf(stderr, "The block size does not fit the message and "
+                    "memory limits\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    bufsize = nprocs * dt_extent(options.max_message_size);
+    sendbuf = malloc(bufsize);
+    recvbuf = malloc(bufsize);
+    counts = malloc(3 * nprocs * sizeof(int));
+    types = malloc(nprocs * sizeof(MPI_Datatype));
+
+    if (NULL == sendbuf || NULL == recvbuf || NULL == counts ||
+            NULL == types) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    displs = counts + nprocs;
+    byte_displs = displs + nprocs;
+    memset(sendbuf, 'a', bufsize);
+    memset(recvbuf, 'b', bufsize);
+
+    if (0 == rank && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "# Datatype: %s, %d byte blocks every %d bytes",
+                dt_layout_name(), options.dt_block_size,
+                options.dt_stride_size);
+        if (options.dt_increase_size) {
+            fprintf(stdout, " growing by %d", options.dt_increase_size);
+        }
+        fprintf(stdout, "\n# Overhead is relative to the contiguous bytes\n");
+        fprintf(stdout, "%-*s%*s%*s%*s%*s\n", 10, "# Size", 16, "Collective",
+                FIELD_WIDTH, "DDT (us)", FIELD_WIDTH, "Contig (us)", 14,
+                "Overhead (%)");
+        fflush(stdout);
+    }
+
+    reset_message_sizes();
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        if (size > LARGE_MESSAGE_SIZE) {
+            iterations = options.iterations_large;
+            skip = options.skip_large;
+        } else {
+            iterations = options.iterations;
+            skip = options.skip;
+        }
+
+        bytes = create_dt_type(size, &type) * options.dt_block_size;
+        MPI_CHECK(MPI_Type_get_extent(type, &lb, &extent));
+
+        for (c = 0; c < COLL_NUM; c++) {
+            setup_layout(nprocs, type, 1, extent);
+            ddt[c] = time_coll(c, type, 1, iterations, skip);
+
+            setup_layout(nprocs, MPI_CHAR, bytes, bytes);
+            contig[c] = time_coll(c, MPI_CHAR, bytes, iterations, skip);
+
+            overhead[c] = contig[c] > 0 ? 100.0 * (ddt[c] - contig[c]) /
+                contig[c] : 0;
+
+            metrics[3 * c] = (struct result_metric_t){metric_name[c][0],
+                ddt[c]};
+            metrics[3 * c + 1] = (struct result_metric_t){metric_name[c][1],
+                contig[c]};
+            metrics[3 * c + 2] = (struct result_metric_t){metric_name[c][2],
+                overhead[c]};
+        }
+
+        MPI_CHECK(MPI_Type_free(&type));
+
+        if (0 != rank) {
+            continue;
+        }
+
+        if (OUTPUT_TABLE != options.output_format) {
+            output_result(nprocs, bytes, 3 * COLL_NUM, metrics);
+            continue;
+        }
+
+        compare_baseline(nprocs, bytes, 3 * COLL_NUM, metrics);
+        checkpoint_result(nprocs, bytes, 3 * COLL_NUM, metrics);
+        for (c = 0; c < COLL_NUM; c++) {
+            fprintf(stdout, "%-*d%*s%*.*f%*.*f%*.*f\n", 10, bytes, 16,
+                    coll_name[c], FIELD_WIDTH, FLOAT_PRECISION, ddt[c],
+                    FIELD_WIDTH, FLOAT_PRECISION, contig[c], 14, 2,
+                    overhead[c]);
+        }
+        fflush(stdout);
+    }
+
+    free(sendbuf);
+    free(recvbuf);
+    free(counts);
+    free(types);
+
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+/* Extent in bytes of the datatype of SIZE */
+static MPI_Aint dt_extent (int size)
+{
+    MPI_Datatype type;
+    MPI_Aint lb, extent;
+
+    create_dt_type(size, &type);
+    MPI_CHECK(MPI_Type_get_extent(type, &lb, &extent));
+    MPI_CHECK(MPI_Type_free(&type));
+
+    return extent;
+}
+
+/*
+ * COUNT elements of TYPE per rank, the elements of the ranks EXTENT bytes
+ * apart
+ */
+static void setup_layout (int nprocs, MPI_Datatype type, int count,
+        MPI_Aint extent)
+{
+    int i;
+
+    for (i = 0; i < nprocs; i++) {
+        counts[i] = count;
+        displs[i] = i * count;
+        byte_displs[i] = i * extent;
+        types[i] = type;
+    }
+}
+
+static void run_coll (enum dt_coll coll, MPI_Datatype type, int count)
+{
+    switch (coll) {
+        case COLL_ALLGATHERV:
+            MPI_CHECK(MPI_Allgatherv(sendbuf, count, type, recvbuf, counts,
+                        displs, type, MPI_COMM_WORLD));
+            break;
+        case COLL_ALLTOALLW:
+            MPI_CHECK(MPI_Alltoallw(sendbuf, counts, byte_displs, types,
+                        recvbuf, counts, byte_displs, types,
+                        MPI_COMM_WORLD));
+            break;
+        default:
+            MPI_CHECK(MPI_Bcast(sendbuf, count, type, 0, MPI_COMM_WORLD));
+            break;
+    }
+}
+
+/*
+ * Latency in microseconds per collective, averaged over the ranks, with a
+ * barrier between collectives as in osu_allgatherv
+ */
+static double time_coll (enum dt_coll coll, MPI_Datatype type, int count,
+        int iterations, int skip)
+{
+    int i, nprocs;
+    double t_start, timer = 0, latency, sum;
+
+    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+    for (i = 0; i < iterations + skip; i++) {
+        t_start = osu_wtime();
+        run_coll(coll, type, count);
+        if (i >= skip) {
+            timer += osu_wtime() - t_start;
+        }
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+    }
+
+    latency = timer * 1e6 / iterations;
+
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    MPI_CHECK(MPI_Allreduce(&latency, &sum, 1, MPI_DOUBLE, MPI_SUM,
+                MPI_COMM_WORLD));
+
+    return sum / nprocs;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -0,0 +1,356 @@
+#define BENCHMARK "OSU MPI Collective Scaling Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * The collective of --group-op on sub-communicators of growing size, so that
+ * one launch gives the strong scaling curve that otherwise takes a job per
+ * rank count.  The communicators are node aligned: with PPN the fewest ranks
+ * of any node, the sizes are 2, 4, ... below PPN on the first node, then PPN
+ * times 1, 2, 4, ... nodes, taking the first PPN ranks of the first nodes,
+ * and finally all nodes and all ranks.  Every communicator is created once,
+ * before the first message size, and the ranks outside of it wait in a
+ * barrier on MPI_COMM_WORLD while it runs.
+ *
+ * For every message size a table of the number of ranks and nodes against
+ * the average, minimum and maximum latency over the ranks of the
+ * communicator is printed, with the latency relative to the smallest one.
+ */
+
+#include <osu_util_mpi.h>
+
+#define MAX_SCALING_COMMS 64
+
+enum scaling_metric {
+    METRIC_AVG,
+    METRIC_MIN,
+    METRIC_MAX,
+    METRIC_GROWTH,
+    METRIC_NUM
+};
+
+static char const *metric_column[METRIC_NUM] = {"Avg (us)", "Min (us)",
+    "Max (us)", "vs Smallest"};
+static char const *metric_name[METRIC_NUM] = {"avg_latency_us",
+    "min_latency_us", "max_latency_us", "growth"};
+static char const *op_name[] = {"", "MPI_Allreduce", "MPI_Bcast",
+    "MPI_Alltoall", "MPI_Barrier"};
+
+static char *sendbuf, *recvbuf;
+
+static int scaling_sizes (int nprocs, int * ranks, int * nodes,
+        int * color);
+static void run_op (MPI_Comm comm, int size);
+static double time_comm (MPI_Comm comm, int size, int iterations, int skip,
+        double * min_time, double * max_time);
+static void report (int ranks, int nodes, int size, double const *value);
+
+int main (int argc, char *argv[])
+{
+    int rank, nprocs, ncomms, c, size, iterations, skip;
+    int ranks[MAX_SCALING_COMMS], nodes[MAX_SCALING_COMMS];
+    int color[MAX_SCALING_COMMS];
+    int po_ret = PO_OKAY;
+    size_t bytes;
+    double value[METRIC_NUM], base = 0;
+    MPI_Comm comm[MAX_SCALING_COMMS];
+
+    options.bench = COLLECTIVE;
+    options.subtype = COMM_SCALING;
+    options.group_op = GROUP_OP_ALLREDUCE;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_comm_scaling");
+    po_ret = process_options(argc, argv);
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_bad_usage_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (nprocs < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    /* MPI_Alltoall sends the message size to every rank of the communicator */
+    bytes = GROUP_OP_ALLTOALL == options.group_op ? nprocs : 1;
+    if (options.max_message_size * bytes > options.max_mem_limit) {
+        if (rank == 0) {
+            fprintf(stderr, "Warning! Increase the Max Memory Limit to be able to run up to %zu bytes.\n"
+                            "Continuing with max message size of %zu bytes\n",
+                            options.max_message_size,
+                            options.max_mem_limit / bytes);
+        }
+        options.max_message_size = options.max_mem_limit / bytes;
+    }
+
+    if (GROUP_OP_BARRIER == options.group_op) {
+        options.min_message_size = 0;
+        options.max_message_size = 0;
+    }
+
+    bytes *= MAX(1, options.max_message_size);
+    sendbuf = malloc(bytes);
+    recvbuf = malloc(bytes);
+
+    if (NULL == sendbuf || NULL == recvbuf) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    memset(sendbuf, 'a', bytes);
+    memset(recvbuf, 'b', bytes);
+
+    ncomms = scaling_sizes(nprocs, ranks, nodes, color);
+    for (c = 0; c < ncomms; c++) {
+        MPI_CHECK(MPI_Comm_split(MPI_COMM_WORLD, color[c] ? 0 : MPI_UNDEFINED,
+                    rank, &comm[c]));
+    }
+
+    if (0 == rank && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "# %s on node aligned communicators of 2 up to %d "
+                "ranks\n", op_name[options.group_op], nprocs);
+        fflush(stdout);
+    }
+
+    reset_message_sizes();
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        if (size > LARGE_MESSAGE_SIZE) {
+            iterations = options.iterations_large;
+            skip = options.skip_large;
+        } else {
+            iterations = options.iterations;
+            skip = options.skip;
+        }
+
+        if (0 == rank && OUTPUT_TABLE == options.output_format) {
+            fprintf(stdout, "\n# Size: %d\n", size);
+            fprintf(stdout, "%-*s%*s", 10, "# Ranks", 8, "Nodes");
+            for (c = 0; c < METRIC_NUM; c++) {
+                fprintf(stdout, "%*s", FIELD_WIDTH, metric_column[c]);
+            }
+            fprintf(stdout, "\n");
+            fflush(stdout);
+        }
+
+        for (c = 0; c < ncomms; c++) {
+            double t[3] = {0, 0, 0};
+
+            if (MPI_COMM_NULL != comm[c]) {
+                t[0] = time_comm(comm[c], size, iterations, skip, &t[1],
+                        &t[2]);
+            }
+
+            /* Rank 0 is part of every communicator and prints their results */
+            MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+            if (0 != rank) {
+                continue;
+            }
+
+            value[METRIC_AVG] = t[0];
+            value[METRIC_MIN] = t[1];
+            value[METRIC_MAX] = t[2];
+
+            if (0 == c) {
+                base = t[0];
+            }
+            value[METRIC_GROWTH] = base > 0 ? t[0] / base : 0;
+
+            report(ranks[c], nodes[c], size, value);
+        }
+
+        if (GROUP_OP_BARRIER == options.group_op) {
+            break;
+        }
+    }
+
+    for (c = 0; c < ncomms; c++) {
+        if (MPI_COMM_NULL != comm[c]) {
+            MPI_CHECK(MPI_Comm_free(&comm[c]));
+        }
+    }
+
+    free(sendbuf);
+    free(recvbuf);
+
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * The rank counts of the sweep with the number of nodes they span and in
+ * COLOR whether the calling rank belongs to each of them.  Returns their
+ * number.
+ */
+static int scaling_sizes (int nprocs, int * ranks, int * nodes, int * color)
+{
+    MPI_Comm node_comm, leader_comm;
+    int rank, node_rank, node_size, node = 0, nnodes = 0, ppn, n, p;
+    int ncomms = 0;
+
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0,
+                MPI_INFO_NULL, &node_comm));
+    MPI_CHECK(MPI_Comm_rank(node_comm, &node_rank));
+    MPI_CHECK(MPI_Comm_size(node_comm, &node_size));
+    MPI_CHECK(MPI_Comm_split(MPI_COMM_WORLD, node_rank ? MPI_UNDEFINED : 0,
+                rank, &leader_comm));
+
+    if (0 == node_rank) {
+        MPI_CHECK(MPI_Comm_rank(leader_comm, &node));
+        MPI_CHECK(MPI_Comm_size(leader_comm, &nnodes));
+        MPI_CHECK(MPI_Comm_free(&leader_comm));
+    }
+
+    MPI_CHECK(MPI_Bcast(&node, 1, MPI_INT, 0, node_comm));
+    MPI_CHECK(MPI_Bcast(&nnodes, 1, MPI_INT, 0, node_comm));
+    MPI_CHECK(MPI_Comm_free(&node_comm));
+    MPI_CHECK(MPI_Allreduce(&node_size, &ppn, 1, MPI_INT, MPI_MIN,
+                MPI_COMM_WORLD));
+
+    for (p = 2; p < ppn && ncomms < MAX_SCALING_COMMS; p *= 2) {
+        ranks[ncomms] = p;
+        nodes[ncomms] = 1;
+        color[ncomms++] = 0 == node && node_rank < p;
+    }
+
+    for (n = 1; n <= nnodes && ncomms < MAX_SCALING_COMMS; n *= 2) {
+        if (n * ppn < 2) {
+            continue;
+        }
+
+        ranks[ncomms] = n * ppn;
+        nodes[ncomms] = n;
+        color[ncomms++] = node < n && node_rank < ppn;
+
+        if (n < nnodes && 2 * n > nnodes && ncomms < MAX_SCALING_COMMS) {
+            ranks[ncomms] = nnodes * ppn;
+            nodes[ncomms] = nnodes;
+            color[ncomms++] = node_rank < ppn;
+        }
+    }
+
+    /* Nodes with more ranks than the others add the remaining ones last */
+    if (nprocs > nnodes * ppn && ncomms < MAX_SCALING_COMMS) {
+        ranks[ncomms] = nprocs;
+        nodes[ncomms] = nnodes;
+        color[ncomms++] = 1;
+    }
+
+    return ncomms;
+}
+
+static void run_op (MPI_Comm comm, int size)
+{
+    switch (options.group_op) {
+        case GROUP_OP_BCAST:
+            MPI_CHECK(MPI_Bcast(sendbuf, size, MPI_CHAR, 0, comm));
+            break;
+        case GROUP_OP_ALLTOALL:
+            MPI_CHECK(MPI_Alltoall(sendbuf, size, MPI_CHAR, recvbuf, size,
+                        MPI_CHAR, comm));
+            break;
+        case GROUP_OP_BARRIER:
+            MPI_CHECK(MPI_Barrier(comm));
+            break;
+        default:
+            MPI_CHECK(MPI_Allreduce(sendbuf, recvbuf,
+                        MAX(1, size / (int)sizeof(float)), MPI_FLOAT,
+                        MPI_SUM, comm));
+            break;
+    }
+}
+
+/*
+ * Latency in microseconds per collective on COMM, averaged over its ranks,
+ * with a barrier between collectives as in osu_allreduce.  The minimum and
+ * maximum over the ranks go to MIN_TIME and MAX_TIME.
+ */
+static double time_comm (MPI_Comm comm, int size, int iterations, int skip,
+        double * min_time, double * max_time)
+{
+    int i, nranks;
+    double t_start, timer = 0, latency, sum;
+
+    for (i = 0; i < iterations + skip; i++) {
+        t_start = osu_wtime();
+        run_op(comm, size);
+        if (i >= skip) {
+            timer += osu_wtime() - t_start;
+        }
+        MPI_CHECK(MPI_Barrier(comm));
+    }
+
+    latency = timer * 1e6 / iterations;
+
+    MPI_CHECK(MPI_Comm_size(comm, &nranks));
+    MPI_CHECK(MPI_Allreduce(&latency, min_time, 1, MPI_DOUBLE, MPI_MIN,
+                comm));
+    MPI_CHECK(MPI_Allreduce(&latency, max_time, 1, MPI_DOUBLE, MPI_MAX,
+                comm));
+    MPI_CHECK(MPI_Allreduce(&latency, &sum, 1, MPI_DOUBLE, MPI_SUM, comm));
+
+    return sum / nranks;
+}
+
+static void report (int ranks, int nodes, int size, double const *value)
+{
+    struct result_metric_t metrics[METRIC_NUM + 1];
+    int i;
+
+    metrics[0].name = "nodes";
+    metrics[0].value = nodes;
+    for (i = 0; i < METRIC_NUM; i++) {
+        metrics[i + 1].name = metric_name[i];
+        metrics[i + 1].value = value[i];
+    }
+
+    if (OUTPUT_TABLE == options.output_format) {
+        compare_baseline(ranks, size, METRIC_NUM + 1, metrics);
+        checkpoint_result(ranks, size, METRIC_NUM + 1, metrics);
+        fprintf(stdout, "%-*d%*d", 10, ranks, 8, nodes);
+        for (i = 0; i < METRIC_NUM; i++) {
+            fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, value[i]);
+        }
+        fprintf(stdout, "\n");
+        fflush(stdout);
+        return;
+    }
+
+    output_result(ranks, size, METRIC_NUM + 1, metrics);
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -0,0 +1,276 @@
+#define BENCHMARK "OSU MPI Communicator Setup Scaling Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * On the first N ranks, with N swept over the powers of two from 2 up to
+ * all ranks as in osu_win_setup, every call creates up to COUNT
+ * communicators and keeps them all alive: MPI_Comm_split into the even and
+ * the odd ranks, MPI_Comm_split_type by shared memory, MPI_Comm_create_group
+ * of the whole group, MPI_Comm_dup and MPI_Comm_idup.  At every power of two
+ * of the number of communicators held, the minimum, average and maximum over
+ * the ranks of the creation time of the communicators added since the last
+ * report are printed, with the growth of the resident memory per
+ * communicator held since the first one, averaged over the ranks and at its
+ * maximum.  Afterwards the communicators are freed and the average time of
+ * MPI_Comm_free is reported.
+ */
+
+#include <osu_util_mpi.h>
+
+enum comm_call {
+    CALL_SPLIT,
+    CALL_SPLIT_TYPE,
+    CALL_CREATE_GROUP,
+    CALL_DUP,
+    CALL_IDUP,
+    CALL_NUM
+};
+
+static char const *call_name[CALL_NUM] = {"MPI_Comm_split",
+    "MPI_Comm_split_type", "MPI_Comm_create_group", "MPI_Comm_dup",
+    "MPI_Comm_idup"};
+
+static MPI_Comm *comms;
+
+static int next_ranks (int ranks, int max_ranks);
+static double create_comm (MPI_Comm parent, MPI_Group group,
+        enum comm_call call, MPI_Comm *comm);
+static void run_call (MPI_Comm parent, int ranks, enum comm_call call);
+static void report (int ranks, int count, enum comm_call call,
+        double const *value, double kb_avg, double kb_max);
+
+int main (int argc, char *argv[])
+{
+    int rank, nprocs, ranks, call;
+    int po_ret = PO_OKAY;
+    MPI_Comm comm;
+
+    options.bench = COLLECTIVE;
+    options.subtype = COMM_SETUP;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_comm_setup");
+    po_ret = process_options(argc, argv);
+    options.show_size = 0;
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_bad_usage_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (nprocs < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    comms = malloc(sizeof(MPI_Comm) * MAX(options.iterations, options.skip));
+
+    if (NULL == comms) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    if (0 == rank && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "%-*s%*s%*s%*s%*s%*s%*s%*s\n", 10, "# Ranks", 8,
+                "Comms", 24, "Call", FIELD_WIDTH, "Min (us)", FIELD_WIDTH,
+                "Avg (us)", FIELD_WIDTH, "Max (us)", FIELD_WIDTH,
+                "Avg KB/comm", FIELD_WIDTH, "Max KB/comm");
+        fflush(stdout);
+    }
+
+    for (ranks = 2; ranks <= nprocs; ranks = next_ranks(ranks, nprocs)) {
+        MPI_CHECK(MPI_Comm_split(MPI_COMM_WORLD,
+                    rank < ranks ? 0 : MPI_UNDEFINED, rank, &comm));
+
+        if (MPI_COMM_NULL != comm) {
+            for (call = CALL_SPLIT; call < CALL_NUM; call++) {
+                run_call(comm, ranks, call);
+            }
+
+            MPI_CHECK(MPI_Comm_free(&comm));
+        }
+
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+    }
+
+    free(comms);
+
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+static int next_ranks (int ranks, int max_ranks)
+{
+    if (ranks < max_ranks && 2 * ranks > max_ranks) {
+        return max_ranks;
+    }
+
+    return 2 * ranks;
+}
+
+/* Time of one creation on this rank in microseconds */
+static double create_comm (MPI_Comm parent, MPI_Group group,
+        enum comm_call call, MPI_Comm *comm)
+{
+    double t_start;
+    int rank;
+    MPI_Request request;
+
+    MPI_CHECK(MPI_Comm_rank(parent, &rank));
+    MPI_CHECK(MPI_Barrier(parent));
+
+    t_start = osu_wtime();
+    switch (call) {
+        case CALL_SPLIT:
+            MPI_CHECK(MPI_Comm_split(parent, rank % 2, rank, comm));
+            break;
+        case CALL_SPLIT_TYPE:
+            MPI_CHECK(MPI_Comm_split_type(parent, MPI_COMM_TYPE_SHARED, rank,
+                        MPI_INFO_NULL, comm));
+            break;
+        case CALL_CREATE_GROUP:
+            MPI_CHECK(MPI_Comm_create_group(parent, group, 0, comm));
+            break;
+        case CALL_DUP:
+            MPI_CHECK(MPI_Comm_dup(parent, comm));
+            break;
+        default:
+            MPI_CHECK(MPI_Comm_idup(parent, comm, &request));
+            MPI_CHECK(MPI_Wait(&request, MPI_STATUS_IGNORE));
+            break;
+    }
+
+    return (osu_wtime() - t_start) * 1e6;
+}
+
+static void run_call (MPI_Comm parent, int ranks, enum comm_call call)
+{
+    double t, t_sum = 0, t_free = 0, t_start, kb, kb_avg, kb_max;
+    double value[3];
+    long rss_start;
+    int i, count, last = 0, rank;
+    MPI_Group group;
+
+    MPI_CHECK(MPI_Comm_rank(parent, &rank));
+    MPI_CHECK(MPI_Comm_group(parent, &group));
+
+    for (i = 0; i < options.skip; i++) {
+        create_comm(parent, group, call, &comms[i]);
+    }
+    for (i = 0; i < options.skip; i++) {
+        MPI_CHECK(MPI_Comm_free(&comms[i]));
+    }
+
+    rss_start = resident_memory_kb();
+
+    for (count = 1; count <= options.iterations; count++) {
+        t_sum += create_comm(parent, group, call, &comms[count - 1]);
+
+        if (count != options.iterations && (count & (count - 1))) {
+            continue;
+        }
+
+        t = t_sum / (count - last);
+        MPI_CHECK(MPI_Reduce(&t, &value[0], 1, MPI_DOUBLE, MPI_MIN, 0,
+                    parent));
+        MPI_CHECK(MPI_Reduce(&t, &value[1], 1, MPI_DOUBLE, MPI_SUM, 0,
+                    parent));
+        MPI_CHECK(MPI_Reduce(&t, &value[2], 1, MPI_DOUBLE, MPI_MAX, 0,
+                    parent));
+
+        kb = rss_start < 0 ? 0 :
+            (double)(resident_memory_kb() - rss_start) / count;
+        MPI_CHECK(MPI_Reduce(&kb, &kb_avg, 1, MPI_DOUBLE, MPI_SUM, 0,
+                    parent));
+        MPI_CHECK(MPI_Reduce(&kb, &kb_max, 1, MPI_DOUBLE, MPI_MAX, 0,
+                    parent));
+
+        if (0 == rank) {
+            value[1] /= ranks;
+            report(ranks, count, call, value, kb_avg / ranks, kb_max);
+        }
+
+        t_sum = 0;
+        last = count;
+    }
+
+    MPI_CHECK(MPI_Barrier(parent));
+
+    for (i = 0; i < options.iterations; i++) {
+        t_start = osu_wtime();
+        MPI_CHECK(MPI_Comm_free(&comms[i]));
+        t_free += osu_wtime() - t_start;
+    }
+
+    t = t_free * 1e6 / options.iterations;
+    MPI_CHECK(MPI_Reduce(&t, &value[1], 1, MPI_DOUBLE, MPI_SUM, 0, parent));
+
+    if (0 == rank && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "# %s: %zu x MPI_Comm_free, avg %.*f us\n",
+                call_name[call], options.iterations, FLOAT_PRECISION,
+                value[1] / ranks);
+        fflush(stdout);
+    }
+
+    MPI_CHECK(MPI_Group_free(&group));
+}
+
+static void report (int ranks, int count, enum comm_call call,
+        double const *value, double kb_avg, double kb_max)
+{
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "%-*d%*d%*s%*.*f%*.*f%*.*f%*.*f%*.*f\n", 10, ranks, 8,
+                count, 24, call_name[call],
+                FIELD_WIDTH, FLOAT_PRECISION, value[0],
+                FIELD_WIDTH, FLOAT_PRECISION, value[1],
+                FIELD_WIDTH, FLOAT_PRECISION, value[2],
+                FIELD_WIDTH, FLOAT_PRECISION, kb_avg,
+                FIELD_WIDTH, FLOAT_PRECISION, kb_max);
+        fflush(stdout);
+    } else {
+        struct result_metric_t metrics[7] = {
+            {"call", call},
+            {"comms", count},
+            {"create_min_us", value[0]},
+            {"create_avg_us", value[1]},
+            {"create_max_us", value[2]},
+            {"rss_avg_kb_per_comm", kb_avg},
+            {"rss_max_kb_per_comm", kb_max},
+        };
+
+        output_result(ranks, count, 7, metrics);
+    }
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
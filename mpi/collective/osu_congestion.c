@@ -0,0 +1,363 @@
+#define BENCHMARK "OSU MPI Congestion Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * The ranks are split into the measuring ranks and the last N ranks of
+ * --background, which generate background traffic among themselves: windows
+ * of BACKGROUND_WINDOW sends from the first half of them to the second half,
+ * as osu_mbw_mr does, or MPI_Alltoall.  For every message size the measuring
+ * ranks time a ping-pong between the first and the last of them, as
+ * osu_latency does, and MPI_Allreduce over all of them, as osu_allreduce
+ * does, first with the background ranks idle and then with the background
+ * traffic running.  The latencies, their slowdown under load and the
+ * bandwidth the background traffic reached meanwhile are printed.
+ *
+ * The background ranks stop once all the measuring ranks have entered an
+ * MPI_Ibarrier on MPI_COMM_WORLD, which they test after every step of their
+ * traffic and agree on with an MPI_Allreduce so that all of them stop after
+ * the same step.
+ */
+
+#include <osu_util_mpi.h>
+
+enum congestion_metric {
+    METRIC_LAT_QUIET,
+    METRIC_LAT_LOADED,
+    METRIC_LAT_SLOWDOWN,
+    METRIC_AR_QUIET,
+    METRIC_AR_LOADED,
+    METRIC_AR_SLOWDOWN,
+    METRIC_BACKGROUND,
+    METRIC_NUM
+};
+
+static char const *metric_column[METRIC_NUM] = {"Latency (us)",
+    "Loaded (us)", "Slowdown", "Allreduce (us)", "Loaded (us)", "Slowdown",
+    "Background MB/s"};
+static char const *metric_name[METRIC_NUM] = {"latency_quiet_us",
+    "latency_loaded_us", "latency_slowdown", "allreduce_quiet_us",
+    "allreduce_loaded_us", "allreduce_slowdown", "background_mbps"};
+
+static char *sendbuf, *recvbuf;
+
+static double measure_latency (MPI_Comm comm, int size, int iterations,
+        int skip);
+static double measure_allreduce (MPI_Comm comm, int size, int iterations,
+        int skip);
+static double run_background (MPI_Comm comm, MPI_Request *stop);
+static void report (int nprocs, int size, double const *value);
+
+int main (int argc, char *argv[])
+{
+    int rank, nprocs, background, size, iterations, skip, i;
+    int po_ret = PO_OKAY;
+    size_t bytes;
+    double value[METRIC_NUM], bandwidth = 0;
+    MPI_Comm comm;
+    MPI_Request stop;
+
+    options.bench = COLLECTIVE;
+    options.subtype = CONGESTION;
+    options.background = BACKGROUND_STREAM;
+    options.background_ranks = -1;
+    options.background_size = BACKGROUND_STREAM_SIZE;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_congestion");
+    po_ret = process_options(argc, argv);
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_bad_usage_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (0 > options.background_ranks) {
+        options.background_ranks = nprocs / 2;
+    }
+
+    if (nprocs - options.background_ranks < 2 ||
+            options.background_ranks < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two measuring and "
+                    "two background processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (options.max_message_size > options.max_mem_limit) {
+        if (rank == 0) {
+            fprintf(stderr, "Warning! Increase the Max Memory Limit to be able to run up to %ld bytes.\n"
+                            "Continuing with max message size of %ld bytes\n",
+                            options.max_message_size, options.max_mem_limit);
+        }
+        options.max_message_size = options.max_mem_limit;
+    }
+
+    background = rank >= nprocs - options.background_ranks;
+    MPI_CHECK(MPI_Comm_split(MPI_COMM_WORLD, background, rank, &comm));
+
+    if (!background) {
+        bytes = options.max_message_size;
+    } else if (BACKGROUND_STREAM == options.background) {
+        bytes = options.background_size;
+    } else {
+        bytes = options.background_size * options.background_ranks;
+    }
+
+    sendbuf = malloc(bytes);
+    recvbuf = malloc(bytes);
+
+    if (NULL == sendbuf || NULL == recvbuf) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    memset(sendbuf, 'a', bytes);
+    memset(recvbuf, 'b', bytes);
+
+    if (0 == rank && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "# Background: %s of %zu bytes on the last %d of %d "
+                "ranks\n", BACKGROUND_STREAM == options.background ?
+                "stream" : "alltoall", options.background_size,
+                options.background_ranks, nprocs);
+        fprintf(stdout, "%-*s", 10, "# Size");
+        for (i = 0; i < METRIC_NUM; i++) {
+            fprintf(stdout, "%*s", FIELD_WIDTH, metric_column[i]);
+        }
+        fprintf(stdout, "\n");
+        fflush(stdout);
+    }
+
+    reset_message_sizes();
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        if (size > LARGE_MESSAGE_SIZE) {
+            iterations = options.iterations_large;
+            skip = options.skip_large;
+        } else {
+            iterations = options.iterations;
+            skip = options.skip;
+        }
+
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+        if (!background) {
+            value[METRIC_LAT_QUIET] = measure_latency(comm, size, iterations,
+                    skip);
+            value[METRIC_AR_QUIET] = measure_allreduce(comm, size, iterations,
+                    skip);
+        }
+
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+        if (background) {
+            MPI_CHECK(MPI_Ibarrier(MPI_COMM_WORLD, &stop));
+            bandwidth = run_background(comm, &stop);
+        } else {
+            value[METRIC_LAT_LOADED] = measure_latency(comm, size, iterations,
+                    skip);
+            value[METRIC_AR_LOADED] = measure_allreduce(comm, size,
+                    iterations, skip);
+            MPI_CHECK(MPI_Ibarrier(MPI_COMM_WORLD, &stop));
+            MPI_CHECK(MPI_Wait(&stop, MPI_STATUS_IGNORE));
+            bandwidth = 0;
+        }
+
+        MPI_CHECK(MPI_Reduce(&bandwidth, &value[METRIC_BACKGROUND], 1,
+                    MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD));
+
+        if (0 == rank) {
+            value[METRIC_LAT_SLOWDOWN] = value[METRIC_LAT_LOADED] /
+                value[METRIC_LAT_QUIET];
+            value[METRIC_AR_SLOWDOWN] = value[METRIC_AR_LOADED] /
+                value[METRIC_AR_QUIET];
+            report(nprocs, size, value);
+        }
+    }
+
+    MPI_CHECK(MPI_Comm_free(&comm));
+    free(sendbuf);
+    free(recvbuf);
+
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * One way latency in microseconds of a ping-pong between the first and the
+ * last rank of COMM, valid on rank 0 of COMM
+ */
+static double measure_latency (MPI_Comm comm, int size, int iterations,
+        int skip)
+{
+    int rank, ranks, peer, i;
+    double t_start = 0, t_stop = 0;
+
+    MPI_CHECK(MPI_Comm_rank(comm, &rank));
+    MPI_CHECK(MPI_Comm_size(comm, &ranks));
+    MPI_CHECK(MPI_Barrier(comm));
+
+    if (0 != rank && ranks - 1 != rank) {
+        return 0;
+    }
+
+    peer = 0 == rank ? ranks - 1 : 0;
+
+    for (i = 0; i < iterations + skip; i++) {
+        if (i == skip) {
+            t_start = osu_wtime();
+        }
+
+        if (0 == rank) {
+            MPI_CHECK(MPI_Send(sendbuf, size, MPI_CHAR, peer, 1, comm));
+            MPI_CHECK(MPI_Recv(recvbuf, size, MPI_CHAR, peer, 1, comm,
+                        MPI_STATUS_IGNORE));
+        } else {
+            MPI_CHECK(MPI_Recv(recvbuf, size, MPI_CHAR, peer, 1, comm,
+                        MPI_STATUS_IGNORE));
+            MPI_CHECK(MPI_Send(sendbuf, size, MPI_CHAR, peer, 1, comm));
+        }
+    }
+
+    t_stop = osu_wtime();
+
+    return (t_stop - t_start) * 1e6 / (2.0 * iterations);
+}
+
+/*
+ * MPI_Allreduce latency in microseconds over COMM, averaged over its ranks
+ * and valid on rank 0 of COMM
+ */
+static double measure_allreduce (MPI_Comm comm, int size, int iterations,
+        int skip)
+{
+    int ranks, count = MAX(1, size / (int)sizeof(float)), i;
+    double t_start, t_total = 0, latency, avg;
+
+    MPI_CHECK(MPI_Comm_size(comm, &ranks));
+
+    for (i = 0; i < iterations + skip; i++) {
+        MPI_CHECK(MPI_Barrier(comm));
+
+        t_start = osu_wtime();
+        MPI_CHECK(MPI_Allreduce(sendbuf, recvbuf, count, MPI_FLOAT, MPI_SUM,
+                    comm));
+
+        if (i >= skip) {
+            t_total += osu_wtime() - t_start;
+        }
+    }
+
+    latency = t_total * 1e6 / iterations;
+    MPI_CHECK(MPI_Reduce(&latency, &avg, 1, MPI_DOUBLE, MPI_SUM, 0, comm));
+
+    return avg / ranks;
+}
+
+/*
+ * Generate the background traffic over COMM until STOP completes on one of
+ * its ranks.  Returns the bandwidth this rank sent in MB/s.
+ */
+static double run_background (MPI_Comm comm, MPI_Request *stop)
+{
+    MPI_Request request[BACKGROUND_WINDOW];
+    int rank, ranks, half, sender, peer, done = 0, any = 0, j;
+    int size = options.background_size;
+    double t_start, bytes = 0;
+
+    MPI_CHECK(MPI_Comm_rank(comm, &rank));
+    MPI_CHECK(MPI_Comm_size(comm, &ranks));
+
+    /* With an odd number of ranks the last one only joins the agreement */
+    half = ranks / 2;
+    sender = rank < half;
+    peer = sender ? rank + half : rank - half;
+
+    t_start = osu_wtime();
+
+    while (!any) {
+        if (BACKGROUND_ALLTOALL == options.background) {
+            MPI_CHECK(MPI_Alltoall(sendbuf, size, MPI_CHAR, recvbuf, size,
+                        MPI_CHAR, comm));
+            bytes += (double)size * (ranks - 1);
+        } else if (peer < 2 * half) {
+            for (j = 0; j < BACKGROUND_WINDOW; j++) {
+                if (sender) {
+                    MPI_CHECK(MPI_Isend(sendbuf, size, MPI_CHAR, peer, 100,
+                                comm, &request[j]));
+                } else {
+                    MPI_CHECK(MPI_Irecv(recvbuf, size, MPI_CHAR, peer, 100,
+                                comm, &request[j]));
+                }
+            }
+            MPI_CHECK(MPI_Waitall(BACKGROUND_WINDOW, request,
+                        MPI_STATUSES_IGNORE));
+            bytes += sender ? (double)size * BACKGROUND_WINDOW : 0;
+        }
+
+        if (!done) {
+            MPI_CHECK(MPI_Test(stop, &done, MPI_STATUS_IGNORE));
+        }
+        MPI_CHECK(MPI_Allreduce(&done, &any, 1, MPI_INT, MPI_MAX, comm));
+    }
+
+    if (!done) {
+        MPI_CHECK(MPI_Wait(stop, MPI_STATUS_IGNORE));
+    }
+
+    return bytes / 1e6 / (osu_wtime() - t_start);
+}
+
+static void report (int nprocs, int size, double const *value)
+{
+    struct result_metric_t metrics[METRIC_NUM];
+    int i;
+
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "%-*d", 10, size);
+        for (i = 0; i < METRIC_NUM; i++) {
+            fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, value[i]);
+        }
+        fprintf(stdout, "\n");
+        fflush(stdout);
+        return;
+    }
+
+    for (i = 0; i < METRIC_NUM; i++) {
+        metrics[i].name = metric_name[i];
+        metrics[i].value = value[i];
+    }
+
+    output_result(nprocs, size, METRIC_NUM, metrics);
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
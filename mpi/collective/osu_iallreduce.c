@@ -23,9 +23,14 @@ int main(int argc, char *argv[])
     double init_total = 0.0, wait_total = 0.0;
     options.bench = COLLECTIVE;
     options.subtype = NBC;
+    options.nbc_window_mode = NBC_WINDOW_OFF;
+    options.dtype = DTYPE_FLOAT;
 
     char *sendbuf = NULL;
     char *recvbuf = NULL;
+    MPI_Datatype dtype;
+    MPI_Op op;
+    size_t dtype_size;
     int po_ret;
     size_t bufsize;
 
@@ -40,7 +45,7 @@ int main(int argc, char *argv[])
         }
     }
 
-    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(init_mpi_nbc(&argc, &argv));
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
     MPI_Request request;
@@ -81,45 +86,60 @@ int main(int argc, char *argv[])
         options.max_message_size = options.max_mem_limit;
     }
 
-    options.min_message_size /= sizeof(float);
+    dtype = reduction_datatype();
+    op = reduction_op();
+    dtype_size = reduction_extent();
+
+    options.min_message_size /= dtype_size;
     if (options.min_message_size < MIN_MESSAGE_SIZE) {
         options.min_message_size = MIN_MESSAGE_SIZE;
     }
 
-    bufsize = sizeof(float)*(options.max_message_size/sizeof(float));
+    setup_nbc_window(rank, 1);
+    bufsize = dtype_size*(options.max_message_size/dtype_size);
 
-    if (allocate_memory_coll((void**)&sendbuf, bufsize, options.accel)) {
+    if (allocate_memory_coll((void**)&sendbuf, bufsize * nbc_window_slots(),
+                options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
     }
-    set_buffer(sendbuf, options.accel, 1, bufsize);
+    set_buffer(sendbuf, options.accel, 1, bufsize * nbc_window_slots());
 
-    if (allocate_memory_coll((void**)&recvbuf, bufsize, options.accel)) {
+    if (allocate_memory_coll((void**)&recvbuf, bufsize * nbc_window_slots(),
+                options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
     }
-    set_buffer(recvbuf, options.accel, 0, bufsize);
+    set_buffer(recvbuf, options.accel, 0, bufsize * nbc_window_slots());
+
+    struct nbc_window_t window = {NBC_IALLREDUCE, sendbuf, recvbuf, bufsize,
+                                  bufsize, dtype, op, 0};
 
     print_preamble_nbc(rank);
 
-    for(size=options.min_message_size; size*sizeof(float) <= options.max_message_size; size *= 2) {
+    for(size=options.min_message_size; size*dtype_size <= options.max_message_size; size = next_message_count(size, dtype_size)) {
         if(size > LARGE_MESSAGE_SIZE) {
             options.skip = options.skip_large;
             options.iterations = options.iterations_large;
         }
 
+        if (NBC_WINDOW_OFF < options.nbc_window_mode) {
+            run_nbc_window(rank, numprocs, &window, size, size*dtype_size);
+            continue;
+        }
+
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
         timer = 0.0;
 
         for(i=0; i < options.iterations + options.skip ; i++) {
-            t_start = MPI_Wtime();
+            t_start = osu_wtime();
             MPI_CHECK(MPI_Iallreduce(sendbuf, recvbuf, size,
-                        MPI_FLOAT, MPI_SUM, MPI_COMM_WORLD,
+                        dtype, op, MPI_COMM_WORLD,
                         &request));
             MPI_CHECK(MPI_Wait(&request,&status));
 
-            t_stop = MPI_Wtime();
+            t_stop = osu_wtime();
 
             if(i>=options.skip){
                 timer += t_stop-t_start;
@@ -143,22 +163,22 @@ int main(int argc, char *argv[])
         test_time = 0.0, test_total = 0.0;
 
         for(i=0; i < options.iterations + options.skip ; i++) {
-            t_start = MPI_Wtime();
-            init_time = MPI_Wtime();
+            t_start = osu_wtime();
+            init_time = osu_wtime();
             MPI_CHECK(MPI_Iallreduce(sendbuf, recvbuf, size,
-                        MPI_FLOAT, MPI_SUM, MPI_COMM_WORLD,
+                        dtype, op, MPI_COMM_WORLD,
                         &request));
-            init_time = MPI_Wtime() - init_time;
+            init_time = osu_wtime() - init_time;
 
-            tcomp = MPI_Wtime();
+            tcomp = osu_wtime();
             test_time = dummy_compute(latency_in_secs, &request);
-            tcomp = MPI_Wtime() - tcomp;
+            tcomp = osu_wtime() - tcomp;
 
-            wait_time = MPI_Wtime();
+            wait_time = osu_wtime();
             MPI_CHECK(MPI_Wait(&request,&status));
-            wait_time = MPI_Wtime() - wait_time;
+            wait_time = osu_wtime() - wait_time;
 
-            t_stop = MPI_Wtime();
+            t_stop = osu_wtime();
 
             if(i>=options.skip){
                 timer += t_stop-t_start;
@@ -172,7 +192,7 @@ int main(int argc, char *argv[])
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
-        calculate_and_print_stats(rank, size*sizeof(float),
+        calculate_and_print_stats(rank, size*dtype_size,
                                   numprocs, timer, latency,
                                   test_total, tcomp_total,
                                   wait_total, init_total);
@@ -181,6 +201,8 @@ int main(int argc, char *argv[])
 
     free_buffer(sendbuf, options.accel);
     free_buffer(recvbuf, options.accel);
+    free_nbc_window();
+    free_reduction_op();
     MPI_CHECK(MPI_Finalize());
 
     if (NONE != options.accel) {
@@ -28,12 +28,12 @@ int main(int argc, char *argv[])
     MPI_Datatype *stypes = NULL, *rtypes = NULL;
     int po_ret;
     size_t bufsize;
-    int disp = 0;
     set_header(HEADER);
     set_benchmark_name("osu_ialltoallw");
 
     options.bench = COLLECTIVE;
     options.subtype = NBC;
+    options.count_dist = COUNTS_UNIFORM;
 
     po_ret = process_options(argc, argv);
 
@@ -44,7 +44,7 @@ int main(int argc, char *argv[])
         }
     }
 
-    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(init_mpi_nbc(&argc, &argv));
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
     MPI_Request request;
@@ -84,6 +84,10 @@ int main(int argc, char *argv[])
         }
         options.max_message_size = options.max_mem_limit / numprocs;
     }
+
+    if (setup_count_distribution(rank, numprocs)) {
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
      
     if (allocate_memory_coll((void**)&recvcounts, numprocs*sizeof(int), NONE)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
@@ -113,7 +117,7 @@ int main(int argc, char *argv[])
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
     }
 
-    bufsize = options.max_message_size * numprocs;
+    bufsize = count_buffer_size(numprocs);
     if (allocate_memory_coll((void**)&sendbuf, bufsize, options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
@@ -129,7 +133,7 @@ int main(int argc, char *argv[])
 
     print_preamble_nbc(rank);
 
-    for(size=options.min_message_size; size <=options.max_message_size; size *= 2) {
+    for(size=options.min_message_size; size <=options.max_message_size; size = next_message_size(size)) {
         if(size > LARGE_MESSAGE_SIZE) {
             options.skip = options.skip_large;
             options.iterations = options.iterations_large;
@@ -138,13 +142,9 @@ int main(int argc, char *argv[])
             options.skip = options.skip_large;
         }
         
-        disp =0;
-        for ( i = 0; i < numprocs; i++) {
-            recvcounts[i] = size;
-            sendcounts[i] = size;
-            rdispls[i] = disp;
-            sdispls[i] = disp;
-            disp += size;
+        set_counts(rank, numprocs, size, sendcounts, sdispls, recvcounts,
+                rdispls);
+        for (i = 0; i < numprocs; i++) {
             stypes[i] = MPI_CHAR;
             rtypes[i] = MPI_CHAR;
         }
@@ -153,13 +153,13 @@ int main(int argc, char *argv[])
         timer = 0.0;     
           
         for(i=0; i < options.iterations + options.skip ; i++) {
-            t_start = MPI_Wtime();
+            t_start = osu_wtime();
             MPI_CHECK(MPI_Ialltoallw(sendbuf, sendcounts, sdispls, stypes,
                           recvbuf, recvcounts, rdispls, rtypes,
                           MPI_COMM_WORLD, &request));
             MPI_CHECK(MPI_Wait(&request,&status));
             
-            t_stop = MPI_Wtime();
+            t_stop = osu_wtime();
             
             if(i>=options.skip){
                 timer += t_stop-t_start;
@@ -175,15 +175,8 @@ int main(int argc, char *argv[])
 
         init_arrays(latency_in_secs);
 
-        disp =0;
-        for ( i = 0; i < numprocs; i++) {
-            recvcounts[i] = size;
-            sendcounts[i] = size;
-            rdispls[i] = disp;
-            sdispls[i] = disp;
-            disp += size;
-
-        }
+        set_counts(rank, numprocs, size, sendcounts, sdispls, recvcounts,
+                rdispls);
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
@@ -192,23 +185,23 @@ int main(int argc, char *argv[])
         test_time = 0.0, test_total = 0.0;
  
         for(i=0; i < options.iterations + options.skip ; i++) {
-            t_start = MPI_Wtime();
+            t_start = osu_wtime();
 
-            init_time = MPI_Wtime();
+            init_time = osu_wtime();
             MPI_CHECK(MPI_Ialltoallw(sendbuf, sendcounts, sdispls, stypes,
                           recvbuf, recvcounts, rdispls, rtypes,
                           MPI_COMM_WORLD, &request));
-            init_time = MPI_Wtime() - init_time;
+            init_time = osu_wtime() - init_time;
 
-            tcomp = MPI_Wtime();             
+            tcomp = osu_wtime();             
             test_time = dummy_compute(latency_in_secs, &request); 
-            tcomp = MPI_Wtime() - tcomp;
+            tcomp = osu_wtime() - tcomp;
 
-            wait_time = MPI_Wtime();
+            wait_time = osu_wtime();
             MPI_CHECK(MPI_Wait(&request,&status));
-            wait_time = MPI_Wtime() - wait_time;
+            wait_time = osu_wtime() - wait_time;
 
-            t_stop = MPI_Wtime();
+            t_stop = osu_wtime();
             
             if(i>=options.skip){
                 test_total += test_time;
@@ -234,6 +227,7 @@ int main(int argc, char *argv[])
     free_buffer(sendcounts, NONE);
     free_buffer(sendbuf, options.accel);
     free_buffer(recvbuf, options.accel);
+    cleanup_count_distribution();
 
     MPI_CHECK(MPI_Finalize());
 
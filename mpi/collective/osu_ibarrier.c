@@ -40,7 +40,7 @@ int main(int argc, char *argv[])
 
     options.show_size = 0;
 
-    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(init_mpi_nbc(&argc, &argv));
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
     MPI_Request request;
@@ -82,10 +82,10 @@ int main(int argc, char *argv[])
     allocate_host_arrays();
 
     for(i=0; i < options.iterations + options.skip ; i++) {
-        t_start = MPI_Wtime();
+        t_start = osu_wtime();
         MPI_CHECK(MPI_Ibarrier(MPI_COMM_WORLD, &request));
         MPI_CHECK(MPI_Wait(&request,&status));
-        t_stop = MPI_Wtime();
+        t_stop = osu_wtime();
 
         if(i>=options.skip){
             timer+=t_stop-t_start;
@@ -108,21 +108,21 @@ int main(int argc, char *argv[])
     test_time = 0.0, test_total = 0.0;
 
     for(i=0; i < options.iterations + options.skip ; i++) {
-            t_start = MPI_Wtime();
+            t_start = osu_wtime();
 
-            init_time = MPI_Wtime();
+            init_time = osu_wtime();
             MPI_CHECK(MPI_Ibarrier(MPI_COMM_WORLD, &request));
-            init_time = MPI_Wtime() - init_time;
+            init_time = osu_wtime() - init_time;
 
-            tcomp = MPI_Wtime();
+            tcomp = osu_wtime();
             test_time = dummy_compute(latency_in_secs, &request);
-            tcomp = MPI_Wtime() - tcomp;
+            tcomp = osu_wtime() - tcomp;
 
-            wait_time = MPI_Wtime();
+            wait_time = osu_wtime();
             MPI_CHECK(MPI_Wait(&request,&status));
-            wait_time = MPI_Wtime() - wait_time;
+            wait_time = osu_wtime() - wait_time;
 
-            t_stop = MPI_Wtime();
+            t_stop = osu_wtime();
 
             if(i>=options.skip){
                 timer += t_stop-t_start;
@@ -142,9 +142,9 @@ int main(int argc, char *argv[])
                                   wait_total, init_total);
 
     free_host_arrays();
-#ifdef _ENABLE_CUDA_KERNEL_
+#ifdef _ENABLE_GPU_KERNEL_
     free_device_arrays();
-#endif /* #ifdef _ENABLE_CUDA_KERNEL_ */
+#endif /* #ifdef _ENABLE_GPU_KERNEL_ */
 
     MPI_CHECK(MPI_Finalize());
 
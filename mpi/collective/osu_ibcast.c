@@ -29,6 +29,7 @@ int main(int argc, char *argv[])
 
     options.bench = COLLECTIVE;
     options.subtype = NBC;
+    options.nbc_window_mode = NBC_WINDOW_OFF;
 
     po_ret = process_options(argc, argv);
 
@@ -39,7 +40,7 @@ int main(int argc, char *argv[])
         }
     }
 
-    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(init_mpi_nbc(&argc, &argv));
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
     MPI_Request request;
@@ -80,32 +81,45 @@ int main(int argc, char *argv[])
         options.max_message_size = options.max_mem_limit;
     }
 
-    if (allocate_memory_coll((void**)&buffer, options.max_message_size, options.accel)) {
+    setup_nbc_window(rank, 1);
+
+    if (allocate_memory_coll((void**)&buffer,
+                options.max_message_size * nbc_window_slots(), options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
     }
 
     if(rank==0)
-      set_buffer(buffer, options.accel, 1, options.max_message_size);
+      set_buffer(buffer, options.accel, 1, options.max_message_size * nbc_window_slots());
     else
-      set_buffer(buffer, options.accel, 0, options.max_message_size);
+      set_buffer(buffer, options.accel, 0, options.max_message_size * nbc_window_slots());
+
+    struct nbc_window_t window = {NBC_IBCAST, buffer, buffer,
+                                  options.max_message_size,
+                                  options.max_message_size, MPI_CHAR,
+                                  MPI_OP_NULL, 0};
 
     print_preamble_nbc(rank);
 
-    for(size=options.min_message_size; size <= options.max_message_size; size *= 2) {
+    for(size=options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         if(size > LARGE_MESSAGE_SIZE) {
             options.skip = options.skip_large; 
             options.iterations = options.iterations_large;
         }
 
+        if (NBC_WINDOW_OFF < options.nbc_window_mode) {
+            run_nbc_window(rank, numprocs, &window, size, size);
+            continue;
+        }
+
         timer = 0.0;
 
         for(i=0; i < options.iterations + options.skip ; i++) {
-            t_start = MPI_Wtime();
+            t_start = osu_wtime();
             MPI_CHECK(MPI_Ibcast(buffer, size, MPI_CHAR, 0, MPI_COMM_WORLD, &request));
             MPI_CHECK(MPI_Wait(&request,&status));
 
-            t_stop = MPI_Wtime();
+            t_stop = osu_wtime();
 
             if(i>=options.skip){
                 timer += t_stop-t_start;
@@ -129,20 +143,20 @@ int main(int argc, char *argv[])
         test_time = 0.0, test_total = 0.0;
 
         for(i=0; i < options.iterations + options.skip ; i++) {
-            t_start = MPI_Wtime();
-            init_time = MPI_Wtime();
+            t_start = osu_wtime();
+            init_time = osu_wtime();
             MPI_CHECK(MPI_Ibcast(buffer, size, MPI_CHAR, 0, MPI_COMM_WORLD, &request));
-            init_time = MPI_Wtime() - init_time;
+            init_time = osu_wtime() - init_time;
 
-            tcomp = MPI_Wtime();
+            tcomp = osu_wtime();
             test_time = dummy_compute(latency_in_secs, &request);
-            tcomp = MPI_Wtime() - tcomp;
+            tcomp = osu_wtime() - tcomp;
 
-            wait_time = MPI_Wtime();
+            wait_time = osu_wtime();
             MPI_CHECK(MPI_Wait(&request,&status));
-            wait_time = MPI_Wtime() - wait_time;
+            wait_time = osu_wtime() - wait_time;
 
-            t_stop = MPI_Wtime();
+            t_stop = osu_wtime();
 
             if(i>=options.skip){
                 timer += t_stop-t_start;
@@ -163,6 +177,7 @@ int main(int argc, char *argv[])
     }
 
     free_buffer(buffer, options.accel);
+    free_nbc_window();
 
     MPI_CHECK(MPI_Finalize());
 
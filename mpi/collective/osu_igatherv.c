@@ -40,7 +40,7 @@ int main(int argc, char *argv[])
         }
     }
 
-    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(init_mpi_nbc(&argc, &argv));
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
     MPI_Request request;
@@ -108,7 +108,7 @@ int main(int argc, char *argv[])
 
     print_preamble_nbc(rank);
 
-    for(size=options.min_message_size; size <=options.max_message_size; size *= 2) {
+    for(size=options.min_message_size; size <=options.max_message_size; size = next_message_size(size)) {
         if(size > LARGE_MESSAGE_SIZE) {
             options.skip = options.skip_large;
             options.iterations = options.iterations_large;
@@ -131,13 +131,13 @@ int main(int argc, char *argv[])
         timer = 0.0;     
           
         for(i=0; i < options.iterations + options.skip ; i++) {
-            t_start = MPI_Wtime();
+            t_start = osu_wtime();
             MPI_CHECK(MPI_Igatherv(sendbuf, size, MPI_CHAR,
                          recvbuf, recvcounts, rdispls,
                          MPI_CHAR, 0, MPI_COMM_WORLD, &request));
             MPI_CHECK(MPI_Wait(&request,&status));
             
-            t_stop = MPI_Wtime();
+            t_stop = osu_wtime();
             
             if(i>=options.skip){
                 timer += t_stop-t_start;
@@ -170,23 +170,23 @@ int main(int argc, char *argv[])
         test_time = 0.0, test_total = 0.0;
          
         for(i=0; i < options.iterations + options.skip ; i++) {
-            t_start = MPI_Wtime();
+            t_start = osu_wtime();
 
-            init_time = MPI_Wtime();
+            init_time = osu_wtime();
             MPI_CHECK(MPI_Igatherv(sendbuf, size, MPI_CHAR,
                          recvbuf, recvcounts, rdispls,
                          MPI_CHAR, 0, MPI_COMM_WORLD, &request));
-            init_time = MPI_Wtime() - init_time;
+            init_time = osu_wtime() - init_time;
             
-            tcomp = MPI_Wtime(); 
+            tcomp = osu_wtime(); 
             test_time = dummy_compute(latency_in_secs, &request); 
-            tcomp = MPI_Wtime() - tcomp;
+            tcomp = osu_wtime() - tcomp;
 
-            wait_time = MPI_Wtime();
+            wait_time = osu_wtime();
             MPI_CHECK(MPI_Wait(&request,&status));
-            wait_time = MPI_Wtime() - wait_time;
+            wait_time = osu_wtime() - wait_time;
 
-            t_stop = MPI_Wtime();
+            t_stop = osu_wtime();
             
             if(i>=options.skip){
                 timer += t_stop-t_start;
@@ -0,0 +1,220 @@
+#define BENCHMARK "OSU MPI Managed Memory MPI_Allreduce Latency Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * MPI_Allreduce, a sum of floats, on CUDA managed buffers, once for every
+ * residency state of --residency.  Before every iteration all ranks bring
+ * their send and receive buffers into the state and meet in a barrier,
+ * outside of the timing, so the latency only holds the page faults and
+ * migrations the collective itself causes.  The average latency over the
+ * ranks is printed with the bandwidth it gives, the message size over the
+ * latency, and the average time per iteration the ranks spent establishing
+ * the state, the migration cost on its own.
+ */
+
+#include <osu_util_mpi.h>
+
+static double time_allreduce (float * sendbuf, float * recvbuf, int count,
+        enum residency_state state, double * migration);
+
+int main (int argc, char *argv[])
+{
+    int rank, numprocs, state;
+    int po_ret = 0;
+    size_t size, bufsize;
+    float *sendbuf = NULL, *recvbuf = NULL;
+    double local[2], avg[2];
+
+    options.bench = COLLECTIVE;
+    options.subtype = MANAGED_MEM;
+    options.residency = RESIDENCY_MASK_ALL;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_managed_allreduce");
+    po_ret = process_options(argc, argv);
+
+    if (PO_OKAY == po_ret && CUDA_ENABLED) {
+        options.accel = MANAGED;
+        if (init_accel()) {
+            fprintf(stderr, "Error initializing device\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    set_num_ranks(numprocs);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_bad_usage_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (!CUDA_ENABLED) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires CUDA managed memory, please "
+                    "recompile the benchmarks with CUDA support\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (numprocs < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (options.max_message_size > options.max_mem_limit / 2) {
+        if (0 == rank) {
+            fprintf(stderr, "Warning! Increase the Max Memory Limit to be able "
+                    "to run up to %zu bytes.\nContinuing with max message size "
+                    "of %zu bytes\n", options.max_message_size,
+                    options.max_mem_limit / 2);
+        }
+        options.max_message_size = options.max_mem_limit / 2;
+    }
+
+    if (options.min_message_size < sizeof(float)) {
+        options.min_message_size = sizeof(float);
+    }
+
+    bufsize = MAX(sizeof(float), options.max_message_size);
+
+    if (allocate_memory_coll((void **)&sendbuf, bufsize, MANAGED) ||
+            allocate_memory_coll((void **)&recvbuf, bufsize, MANAGED)) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+    set_buffer(sendbuf, MANAGED, 0, bufsize);
+    set_buffer(recvbuf, MANAGED, 0, bufsize);
+
+    if (0 == rank && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "%-*s%*s%*s%*s%*s\n", 10, "# Size", 14, "Residency",
+                FIELD_WIDTH, "Avg Latency(us)", FIELD_WIDTH,
+                "Bandwidth (MB/s)", FIELD_WIDTH, "Migration (us)");
+        fflush(stdout);
+    }
+
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        int count = size / sizeof(float);
+
+        if (size > LARGE_MESSAGE_SIZE) {
+            options.iterations = options.iterations_large;
+            options.skip = options.skip_large;
+        }
+
+        for (state = 0; state < RESIDENCY_NUM; state++) {
+            if (!(options.residency & (1 << state))) {
+                continue;
+            }
+
+            local[0] = time_allreduce(sendbuf, recvbuf, count, state,
+                    &local[1]);
+            MPI_CHECK(MPI_Reduce(local, avg, 2, MPI_DOUBLE, MPI_SUM, 0,
+                        MPI_COMM_WORLD));
+
+            if (0 != rank) {
+                continue;
+            }
+
+            avg[0] /= numprocs;
+            avg[1] /= numprocs;
+
+            if (OUTPUT_TABLE == options.output_format) {
+                fprintf(stdout, "%-*zu%*s%*.*f%*.*f%*.*f\n", 10, size, 14,
+                        residency_name(state), FIELD_WIDTH, FLOAT_PRECISION,
+                        avg[0], FIELD_WIDTH, FLOAT_PRECISION, size / avg[0],
+                        FIELD_WIDTH, FLOAT_PRECISION, avg[1]);
+                fflush(stdout);
+            } else {
+                struct result_metric_t metrics[4] = {
+                    {"residency", state},
+                    {"avg_latency_us", avg[0]},
+                    {"bandwidth_MBps", size / avg[0]},
+                    {"migration_us", avg[1]},
+                };
+
+                output_result(numprocs, size, 4, metrics);
+            }
+        }
+    }
+
+    free_buffer(sendbuf, MANAGED);
+    free_buffer(recvbuf, MANAGED);
+
+    MPI_CHECK(MPI_Finalize());
+
+    if (cleanup_accel()) {
+        fprintf(stderr, "Error cleaning up device\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * Latency of one MPI_Allreduce of COUNT floats in microseconds, and in
+ * MIGRATION the microseconds per iteration that establishing STATE took
+ */
+static double time_allreduce (float * sendbuf, float * recvbuf, int count,
+        enum residency_state state, double * migration)
+{
+    size_t size = count * sizeof(float);
+    double t_start, t_total = 0.0, t_migration = 0.0, t;
+    int i;
+
+    advise_residency(sendbuf, size, state, 1);
+    advise_residency(recvbuf, size, state, 1);
+
+    for (i = 0; i < options.iterations + options.skip; i++) {
+        t = prepare_residency(sendbuf, size, state) +
+            prepare_residency(recvbuf, size, state);
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+        t_start = osu_wtime();
+        MPI_CHECK(MPI_Allreduce(sendbuf, recvbuf, count, MPI_FLOAT, MPI_SUM,
+                    MPI_COMM_WORLD));
+
+        if (i >= options.skip) {
+            t_total += osu_wtime() - t_start;
+            t_migration += t;
+        }
+    }
+
+    advise_residency(sendbuf, size, state, 0);
+    advise_residency(recvbuf, size, state, 0);
+
+    *migration = t_migration * 1e6 / options.iterations;
+
+    return t_total * 1e6 / options.iterations;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -0,0 +1,324 @@
+#define BENCHMARK "OSU MPI Concurrent Groups Throughput Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * MPI_COMM_WORLD is split into groups of consecutive ranks with
+ * MPI_Comm_split, as many as the largest K of --groups, each of the ranks
+ * divided by that K.  For every K and message size the first K groups run
+ * the collective of --group-op at the same time, back to back without a
+ * barrier in between, while the other groups stay idle.  The size of a group
+ * does not change with K, so a group would run as fast next to others as
+ * alone if the MPI library and the NIC shared nothing between them.
+ *
+ * Per K the minimum, average and maximum over the groups of the latency per
+ * collective are printed, with the collectives per second and the bytes per
+ * second handed to them summed over the groups, the message size on every
+ * rank and for MPI_Alltoall to every rank, and the efficiency, the
+ * average throughput of a group against the one with the smallest K.
+ */
+
+#include <osu_util_mpi.h>
+
+/* One group of every power of two up to half the ranks by default */
+#define DEF_GROUP_RANKS 2
+
+enum group_metric {
+    METRIC_MIN,
+    METRIC_AVG,
+    METRIC_MAX,
+    METRIC_OPS,
+    METRIC_MBPS,
+    METRIC_EFFICIENCY,
+    METRIC_NUM
+};
+
+static char const *metric_column[METRIC_NUM] = {"Min (us)", "Avg (us)",
+    "Max (us)", "Agg ops/s", "Agg MB/s", "Efficiency (%)"};
+static char const *metric_name[METRIC_NUM] = {"min_us", "avg_us", "max_us",
+    "aggregate_ops_per_sec", "aggregate_mbps", "efficiency_percent"};
+static char const *op_name[] = {"", "MPI_Allreduce", "MPI_Bcast",
+    "MPI_Alltoall", "MPI_Barrier"};
+
+static char *sendbuf, *recvbuf;
+
+static void run_op (MPI_Comm comm, int size);
+static double time_groups (MPI_Comm comm, int size, int iterations,
+        int skip);
+static void report (int nprocs, int size, int groups, double const *value);
+
+int main (int argc, char *argv[])
+{
+    int rank, nprocs, group_ranks, max_groups, k, groups, size, iterations;
+    int skip, i;
+    int po_ret = PO_OKAY;
+    size_t bytes;
+    double t, *all = NULL, value[METRIC_NUM], base = 0;
+    MPI_Comm comm;
+
+    options.bench = COLLECTIVE;
+    options.subtype = MULTI_GROUP;
+    options.group_op = GROUP_OP_ALLREDUCE;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_multi_group");
+    po_ret = process_options(argc, argv);
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_bad_usage_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (nprocs < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (!options.num_group_counts) {
+        for (k = 1; k <= nprocs / DEF_GROUP_RANKS &&
+                options.num_group_counts < MAX_GROUP_COUNTS; k *= 2) {
+            options.group_counts[options.num_group_counts++] = k;
+        }
+    }
+
+    max_groups = options.group_counts[options.num_group_counts - 1];
+
+    if (max_groups > nprocs) {
+        if (rank == 0) {
+            fprintf(stderr, "%d groups need at least %d processes\n",
+                    max_groups, max_groups);
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (options.max_message_size > options.max_mem_limit) {
+        if (rank == 0) {
+            fprintf(stderr, "Warning! Increase the Max Memory Limit to be able to run up to %ld bytes.\n"
+                            "Continuing with max message size of %ld bytes\n",
+                            options.max_message_size, options.max_mem_limit);
+        }
+        options.max_message_size = options.max_mem_limit;
+    }
+
+    if (GROUP_OP_BARRIER == options.group_op) {
+        options.min_message_size = 0;
+        options.max_message_size = 0;
+    }
+
+    group_ranks = nprocs / max_groups;
+
+    /* MPI_Alltoall sends the message size to every rank of the group */
+    bytes = MAX(1, options.max_message_size) *
+        (GROUP_OP_ALLTOALL == options.group_op ? group_ranks : 1);
+    sendbuf = malloc(bytes);
+    recvbuf = malloc(bytes);
+
+    if (NULL == sendbuf || NULL == recvbuf) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    memset(sendbuf, 'a', bytes);
+    memset(recvbuf, 'b', bytes);
+
+    if (0 == rank) {
+        all = malloc(sizeof(double) * nprocs);
+
+        if (NULL == all) {
+            fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+            MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+        }
+    }
+
+    if (0 == rank && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "# %s in groups of %d ranks\n",
+                op_name[options.group_op], group_ranks);
+        fprintf(stdout, "%-*s%*s", 10, "# Size", 8, "Groups");
+        for (i = 0; i < METRIC_NUM; i++) {
+            fprintf(stdout, "%*s", FIELD_WIDTH, metric_column[i]);
+        }
+        fprintf(stdout, "\n");
+        fflush(stdout);
+    }
+
+    reset_message_sizes();
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        if (size > LARGE_MESSAGE_SIZE) {
+            iterations = options.iterations_large;
+            skip = options.skip_large;
+        } else {
+            iterations = options.iterations;
+            skip = options.skip;
+        }
+
+        for (k = 0; k < options.num_group_counts; k++) {
+            groups = options.group_counts[k];
+
+            MPI_CHECK(MPI_Comm_split(MPI_COMM_WORLD,
+                        rank / group_ranks < groups ? rank / group_ranks :
+                        MPI_UNDEFINED, rank, &comm));
+
+            if (MPI_COMM_NULL == comm) {
+                MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+                t = -1;
+            } else {
+                t = time_groups(comm, size, iterations, skip);
+            }
+
+            MPI_CHECK(MPI_Gather(&t, 1, MPI_DOUBLE, all, 1, MPI_DOUBLE, 0,
+                        MPI_COMM_WORLD));
+
+            if (MPI_COMM_NULL != comm) {
+                MPI_CHECK(MPI_Comm_free(&comm));
+            }
+
+            if (0 != rank) {
+                continue;
+            }
+
+            /* The latency of a group is the one of its slowest rank */
+            value[METRIC_MIN] = value[METRIC_AVG] = value[METRIC_MAX] = 0;
+            value[METRIC_OPS] = 0;
+            for (i = 0; i < groups; i++) {
+                t = all[i * group_ranks];
+
+                value[METRIC_MIN] = 0 == i || t < value[METRIC_MIN] ? t :
+                    value[METRIC_MIN];
+                value[METRIC_MAX] = MAX(t, value[METRIC_MAX]);
+                value[METRIC_AVG] += t / groups;
+                value[METRIC_OPS] += 1e6 / t;
+            }
+
+            value[METRIC_MBPS] = value[METRIC_OPS] * size * group_ranks /
+                1e6 * (GROUP_OP_ALLTOALL == options.group_op ? group_ranks :
+                        1);
+
+            if (0 == k) {
+                base = value[METRIC_OPS] / groups;
+            }
+            value[METRIC_EFFICIENCY] = 100.0 * value[METRIC_OPS] / groups /
+                base;
+
+            report(nprocs, size, groups, value);
+        }
+
+        if (GROUP_OP_BARRIER == options.group_op) {
+            break;
+        }
+    }
+
+    free(all);
+    free(sendbuf);
+    free(recvbuf);
+
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+static void run_op (MPI_Comm comm, int size)
+{
+    switch (options.group_op) {
+        case GROUP_OP_BCAST:
+            MPI_CHECK(MPI_Bcast(sendbuf, size, MPI_CHAR, 0, comm));
+            break;
+        case GROUP_OP_ALLTOALL:
+            MPI_CHECK(MPI_Alltoall(sendbuf, size, MPI_CHAR, recvbuf, size,
+                        MPI_CHAR, comm));
+            break;
+        case GROUP_OP_BARRIER:
+            MPI_CHECK(MPI_Barrier(comm));
+            break;
+        default:
+            MPI_CHECK(MPI_Allreduce(sendbuf, recvbuf,
+                        MAX(1, size / (int)sizeof(float)), MPI_FLOAT,
+                        MPI_SUM, comm));
+            break;
+    }
+}
+
+/*
+ * Latency in microseconds per collective of the group COMM, the time of its
+ * slowest rank.  All groups start together after a barrier on
+ * MPI_COMM_WORLD, which the idle ranks enter as well.
+ */
+static double time_groups (MPI_Comm comm, int size, int iterations, int skip)
+{
+    int i;
+    double t_start, t, t_max;
+
+    for (i = 0; i < skip; i++) {
+        run_op(comm, size);
+    }
+
+    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+    t_start = osu_wtime();
+    for (i = 0; i < iterations; i++) {
+        run_op(comm, size);
+    }
+    t = (osu_wtime() - t_start) * 1e6 / iterations;
+
+    MPI_CHECK(MPI_Allreduce(&t, &t_max, 1, MPI_DOUBLE, MPI_MAX, comm));
+
+    return t_max;
+}
+
+static void report (int nprocs, int size, int groups, double const *value)
+{
+    struct result_metric_t metrics[METRIC_NUM + 1];
+    int i;
+
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "%-*d%*d", 10, size, 8, groups);
+        for (i = 0; i < METRIC_NUM; i++) {
+            fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, value[i]);
+        }
+        fprintf(stdout, "\n");
+        fflush(stdout);
+        return;
+    }
+
+    metrics[0].name = "groups";
+    metrics[0].value = groups;
+    for (i = 0; i < METRIC_NUM; i++) {
+        metrics[i + 1].name = metric_name[i];
+        metrics[i + 1].value = value[i];
+    }
+
+    output_result(nprocs, size, METRIC_NUM + 1, metrics);
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -0,0 +1,179 @@
+#define BENCHMARK "OSU MPI%s Neighborhood All-to-Allv Latency Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * Halo exchange of a stencil code with MPI_Neighbor_alltoallv, selected with
+ * -E, timed against the same exchange written with MPI_Isend/MPI_Irecv on the
+ * same communicator and buffers.
+ */
+
+#include <osu_util_mpi.h>
+
+int main(int argc, char *argv[])
+{
+    int i = 0, rank, size;
+    int numprocs, neighbors;
+    double avg_time = 0.0, max_time = 0.0, min_time = 0.0;
+    double latency = 0.0, t_start = 0.0, t_stop = 0.0;
+    double timer = 0.0;
+    char *sendbuf = NULL, *recvbuf = NULL;
+    int counts[MAX_STENCIL_NEIGHBORS], displs[MAX_STENCIL_NEIGHBORS];
+    size_t bufsize, total;
+    MPI_Comm comm;
+    int po_ret;
+    options.bench = COLLECTIVE;
+    options.subtype = LAT;
+    options.stencil = STENCIL_FACE;
+    options.stencil_dims = DEF_STENCIL_DIMS;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_neighbor_alltoallv");
+    po_ret = process_options(argc, argv);
+
+    if (PO_OKAY == po_ret && NONE != options.accel) {
+        if (init_accel()) {
+            fprintf(stderr, "Error initializing device\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_bad_usage_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if(numprocs < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    comm = setup_stencil();
+    neighbors = stencil_neighbors();
+
+    if (options.max_message_size * MAX_STENCIL_NEIGHBORS > options.max_mem_limit) {
+        if (rank == 0) {
+            fprintf(stderr, "Warning! Increase the Max Memory Limit to be able to run up to %ld bytes.\n"
+                            "Continuing with max message size of %ld bytes\n",
+                            options.max_message_size, options.max_mem_limit / MAX_STENCIL_NEIGHBORS);
+        }
+        options.max_message_size = options.max_mem_limit / MAX_STENCIL_NEIGHBORS;
+    }
+
+    /* Room for a face per neighbor, which covers the smaller edges and corners */
+    bufsize = options.max_message_size * MAX(1, neighbors);
+
+    if (allocate_rotating_buffer((void**)&sendbuf, bufsize, options.accel)) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+    set_buffer(sendbuf, options.accel, 1, bufsize);
+
+    if (allocate_rotating_buffer((void**)&recvbuf, bufsize, options.accel)) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+    set_buffer(recvbuf, options.accel, 0, bufsize);
+
+    print_preamble(rank);
+
+    for(size=options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
+        if(size > LARGE_MESSAGE_SIZE) {
+            options.skip = options.skip_large;
+            options.iterations = options.iterations_large;
+        }
+
+        total = stencil_layout(size, counts, displs);
+
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+        timer=0.0;
+        for(i=0; continue_iterations(i); i++) {
+            t_start = osu_wtime();
+            MPI_CHECK(MPI_Neighbor_alltoallv(rotate_buffer(sendbuf, total, i),
+                        counts, displs, MPI_CHAR,
+                        rotate_buffer(recvbuf, total, i), counts, displs,
+                        MPI_CHAR, comm));
+            t_stop = osu_wtime();
+
+            if(i>=options.skip){
+                timer+=t_stop-t_start;
+                record_latency(t_stop - t_start);
+            }
+            MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+        }
+
+        latency = (timer * 1e6) / options.iterations;
+
+        MPI_CHECK(MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
+                MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0,
+                MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0,
+                MPI_COMM_WORLD));
+        avg_time = avg_time/numprocs;
+
+        timer = 0.0;
+        for (i = 0; i < options.iterations + options.skip; i++) {
+            t_start = osu_wtime();
+            p2p_halo_exchange(rotate_buffer(sendbuf, total, i),
+                    rotate_buffer(recvbuf, total, i), counts, displs);
+            t_stop = osu_wtime();
+            if (i >= options.skip) {
+                timer += t_stop - t_start;
+            }
+            MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+        }
+        latency = (timer * 1e6) / options.iterations;
+
+        MPI_CHECK(MPI_Reduce(&latency, &p2p_halo_latency, 1, MPI_DOUBLE,
+                    MPI_SUM, 0, MPI_COMM_WORLD));
+        p2p_halo_latency /= numprocs;
+
+        print_stats(rank, size, avg_time, min_time, max_time);
+    }
+
+    free_buffer(sendbuf, options.accel);
+    free_buffer(recvbuf, options.accel);
+    cleanup_stencil();
+
+    MPI_CHECK(MPI_Finalize());
+
+    if (NONE != options.accel) {
+        if (cleanup_accel()) {
+            fprintf(stderr, "Error cleaning up device\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
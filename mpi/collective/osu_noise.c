@@ -0,0 +1,548 @@
+#define BENCHMARK "OSU MPI OS Noise Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * Every rank runs a fixed work quantum of about a microsecond of the host
+ * compute kernel, the chunks of compute_host_chunks(), COUNT times back to
+ * back and times each one.  A quantum that takes more than -T times the
+ * fastest is a noise event: the OS or another process took the core.  Per
+ * rank the share of the time lost to noise, the events per second and the
+ * largest event are reported as the minimum, average and maximum over the
+ * ranks, with a histogram of the time lost per event over all ranks.
+ *
+ * The events are kept with their start on the global clock of
+ * --global-clock, so rank 0 can tell how many of them overlap an event of
+ * another rank on the same node, a daemon that stops the whole node, or on
+ * another node, noise that is synchronized across the machine.
+ *
+ * Last, the amplification of the noise by the collectives: MPI_Barrier and
+ * an 8 byte MPI_Allreduce are timed once right after a barrier, and once
+ * after NOISE_WORK_QUANTA quanta of work, where every rank waits for the
+ * noisiest one.  The difference is the time the collective adds to the noise
+ * of each rank.
+ */
+
+#include <osu_util_mpi.h>
+
+/* Target length of a quantum */
+#define NOISE_QUANTUM       1e-6
+/* Events kept per rank for the correlation */
+#define MAX_NOISE_EVENTS    4096
+/* Buckets of the histogram, [2^(i-1), 2^i) us with bucket 0 below 1 us */
+#define NOISE_HIST_BUCKETS  24
+/* Quanta of work before every collective of the amplification */
+#define NOISE_WORK_QUANTA   1000
+#define NOISE_COLL_ITERATIONS 1000
+#define NOISE_COLL_SKIP     10
+
+enum noise_stat {
+    STAT_FASTEST,
+    STAT_NOISE,
+    STAT_RATE,
+    STAT_LARGEST,
+    STAT_NUM
+};
+
+static char const *stat_name[STAT_NUM] = {"Fastest quantum (us)", "Noise (%)",
+    "Events/s", "Largest event (us)"};
+static char const *stat_metric[STAT_NUM] = {"fastest_quantum_us",
+    "noise_percent", "events_per_sec", "largest_event_us"};
+
+enum noise_coll {
+    COLL_BARRIER,
+    COLL_ALLREDUCE,
+    COLL_NUM
+};
+
+static char const *coll_name[COLL_NUM] = {"MPI_Barrier", "MPI_Allreduce"};
+
+/* Start on the global clock and length of a noise event, in seconds */
+struct noise_event {
+    double start;
+    double length;
+};
+
+static struct noise_event *events;
+static int num_events;
+static long total_events;
+static long hist[NOISE_HIST_BUCKETS];
+
+static long quantum_chunks (void);
+static double fastest_quantum (long chunks);
+static void run_quanta (long chunks, double limit, double *stat);
+static int hist_bucket (double us);
+static int node_id (void);
+static void correlate (int rank, int nprocs);
+static int compare_start (void const *a, void const *b);
+static double time_coll (enum noise_coll coll, long work);
+static void report_stats (int nprocs, double const *min, double const *avg,
+        double const *max);
+
+int main (int argc, char *argv[])
+{
+    int rank, nprocs, s, coll;
+    int po_ret = PO_OKAY;
+    long chunks;
+    double tmin, stat[STAT_NUM], min[STAT_NUM], avg[STAT_NUM], max[STAT_NUM];
+    double t[3], sum[2];
+    long all_hist[NOISE_HIST_BUCKETS];
+
+    options.bench = COLLECTIVE;
+    options.subtype = NOISE;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_noise");
+    po_ret = process_options(argc, argv);
+    options.show_size = 0;
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_bad_usage_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (nprocs < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    events = malloc(sizeof(struct noise_event) * MAX_NOISE_EVENTS);
+
+    if (NULL == events) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    allocate_host_arrays();
+    calibrate_host_compute();
+    chunks = quantum_chunks();
+    tmin = fastest_quantum(chunks);
+
+    if (0 == rank && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "# Quantum: %ld chunks, %zu quanta per rank, noise "
+                "above %.2f x the fastest\n", chunks, options.iterations,
+                options.outlier_threshold);
+        fflush(stdout);
+    }
+
+    sync_global_clock();
+    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+    run_quanta(chunks, options.outlier_threshold * tmin, stat);
+    stat[STAT_FASTEST] = tmin * 1e6;
+
+    /* The second sync gives the drift over the run for the event starts */
+    sync_global_clock();
+    for (s = 0; s < num_events; s++) {
+        events[s].start = to_global_time(events[s].start);
+    }
+
+    MPI_CHECK(MPI_Reduce(stat, min, STAT_NUM, MPI_DOUBLE, MPI_MIN, 0,
+                MPI_COMM_WORLD));
+    MPI_CHECK(MPI_Reduce(stat, avg, STAT_NUM, MPI_DOUBLE, MPI_SUM, 0,
+                MPI_COMM_WORLD));
+    MPI_CHECK(MPI_Reduce(stat, max, STAT_NUM, MPI_DOUBLE, MPI_MAX, 0,
+                MPI_COMM_WORLD));
+    MPI_CHECK(MPI_Reduce(hist, all_hist, NOISE_HIST_BUCKETS, MPI_LONG,
+                MPI_SUM, 0, MPI_COMM_WORLD));
+
+    if (0 == rank) {
+        for (s = 0; s < STAT_NUM; s++) {
+            avg[s] /= nprocs;
+        }
+
+        report_stats(nprocs, min, avg, max);
+
+        if (OUTPUT_TABLE == options.output_format) {
+            fprintf(stdout, "# Time lost per event, all ranks\n");
+            for (s = 0; s < NOISE_HIST_BUCKETS; s++) {
+                if (all_hist[s]) {
+                    fprintf(stdout, "#   %10.1f - %10.1f us: %ld\n",
+                            s ? (1L << (s - 1)) * 1.0 : 0.0,
+                            (1L << s) * 1.0, all_hist[s]);
+                }
+            }
+            fflush(stdout);
+        }
+    }
+
+    correlate(rank, nprocs);
+
+    if (0 == rank && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "%-*s%*s%*s%*s\n", 24, "# Collective", FIELD_WIDTH,
+                "Quiet (us)", FIELD_WIDTH, "After work (us)", FIELD_WIDTH,
+                "Added (us)");
+        fflush(stdout);
+    }
+
+    for (coll = COLL_BARRIER; coll < COLL_NUM; coll++) {
+        t[0] = time_coll(coll, 0) * 1e6;
+        t[1] = time_coll(coll, chunks * NOISE_WORK_QUANTA) * 1e6;
+        MPI_CHECK(MPI_Reduce(t, sum, 2, MPI_DOUBLE, MPI_SUM, 0,
+                    MPI_COMM_WORLD));
+
+        if (0 == rank) {
+            t[0] = sum[0] / nprocs;
+            t[1] = sum[1] / nprocs;
+            t[2] = t[1] - t[0];
+
+            if (OUTPUT_TABLE == options.output_format) {
+                fprintf(stdout, "%-*s%*.*f%*.*f%*.*f\n", 24, coll_name[coll],
+                        FIELD_WIDTH, FLOAT_PRECISION, t[0],
+                        FIELD_WIDTH, FLOAT_PRECISION, t[1],
+                        FIELD_WIDTH, FLOAT_PRECISION, t[2]);
+                fflush(stdout);
+            } else {
+                struct result_metric_t metrics[4] = {
+                    {"collective", coll},
+                    {"quiet_us", t[0]},
+                    {"after_work_us", t[1]},
+                    {"added_us", t[2]},
+                };
+
+                output_result(nprocs, 0, 4, metrics);
+            }
+        }
+    }
+
+    free(events);
+    free_host_compute();
+
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+/* Chunks of the host kernel in one quantum of about NOISE_QUANTUM */
+static long quantum_chunks (void)
+{
+    double chunk = host_chunk_time();
+
+    return chunk > 0.0 && NOISE_QUANTUM / chunk > 1.0 ?
+        (long)(NOISE_QUANTUM / chunk) : 1;
+}
+
+/* The fastest of the -x warmup quanta, the time of a quantum without noise */
+static double fastest_quantum (long chunks)
+{
+    double t_start, t_stop, tmin = 0;
+    int i;
+
+    t_start = osu_wtime();
+    for (i = 0; i < options.skip; i++) {
+        compute_host_chunks(chunks);
+        t_stop = osu_wtime();
+
+        if (0 == i || t_stop - t_start < tmin) {
+            tmin = t_stop - t_start;
+        }
+        t_start = t_stop;
+    }
+
+    return tmin;
+}
+
+/*
+ * Time the quanta back to back, one clock read between two of them, so that
+ * a detour between the quanta is caught as well.  Every quantum over LIMIT
+ * is an event, its length is the time lost beyond the fastest quantum.
+ */
+static void run_quanta (long chunks, double limit, double *stat)
+{
+    double t_begin, t_start, t_stop, tmin = limit /
+        options.outlier_threshold, lost = 0, largest = 0;
+    int i;
+
+    num_events = 0;
+    total_events = 0;
+
+    t_begin = t_start = t_stop = osu_wtime();
+    for (i = 0; i < options.iterations; i++) {
+        compute_host_chunks(chunks);
+        t_stop = osu_wtime();
+
+        if (t_stop - t_start > limit) {
+            double length = t_stop - t_start - tmin;
+
+            if (num_events < MAX_NOISE_EVENTS) {
+                events[num_events].start = t_start;
+                events[num_events].length = length;
+                num_events++;
+            }
+
+            total_events++;
+            lost += length;
+            largest = length > largest ? length : largest;
+            hist[hist_bucket(length * 1e6)]++;
+        }
+        t_start = t_stop;
+    }
+
+    stat[STAT_NOISE] = 100.0 * lost / (t_stop - t_begin);
+    stat[STAT_RATE] = total_events / (t_stop - t_begin);
+    stat[STAT_LARGEST] = largest * 1e6;
+}
+
+static int hist_bucket (double us)
+{
+    int i = 0;
+
+    while (us >= 1 && i < NOISE_HIST_BUCKETS - 1) {
+        us /= 2;
+        i++;
+    }
+
+    return i;
+}
+
+/* The lowest world rank on the node of this rank */
+static int node_id (void)
+{
+    int rank, id;
+    MPI_Comm node;
+
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+                MPI_INFO_NULL, &node));
+    MPI_CHECK(MPI_Allreduce(&rank, &id, 1, MPI_INT, MPI_MIN, node));
+    MPI_CHECK(MPI_Comm_free(&node));
+
+    return id;
+}
+
+/* Events of all ranks on rank 0, with the rank that saw them */
+struct ranked_event {
+    struct noise_event event;
+    int rank;
+};
+
+static int compare_start (void const *a, void const *b)
+{
+    double sa = ((struct ranked_event const *)a)->event.start;
+    double sb = ((struct ranked_event const *)b)->event.start;
+
+    return sa < sb ? -1 : sa > sb;
+}
+
+/*
+ * Gather the events on rank 0, sort them by start and count those that
+ * overlap an event of another rank on the same node and on another node
+ */
+static void correlate (int rank, int nprocs)
+{
+    int *counts = NULL, *displs = NULL, *nodes = NULL;
+    int id = node_id(), i, j, total = 0;
+    long dropped = total_events - num_events, all_dropped = 0;
+    double *all = NULL;
+    struct ranked_event *sorted = NULL;
+    char *overlap = NULL;
+    long same = 0, other = 0;
+
+    if (0 == rank) {
+        counts = malloc(sizeof(int) * nprocs);
+        displs = malloc(sizeof(int) * nprocs);
+        nodes = malloc(sizeof(int) * nprocs);
+
+        if (NULL == counts || NULL == displs || NULL == nodes) {
+            fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+            MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+        }
+    }
+
+    i = 2 * num_events;
+    MPI_CHECK(MPI_Gather(&i, 1, MPI_INT, counts, 1, MPI_INT, 0,
+                MPI_COMM_WORLD));
+    MPI_CHECK(MPI_Gather(&id, 1, MPI_INT, nodes, 1, MPI_INT, 0,
+                MPI_COMM_WORLD));
+    MPI_CHECK(MPI_Reduce(&dropped, &all_dropped, 1, MPI_LONG, MPI_SUM, 0,
+                MPI_COMM_WORLD));
+
+    if (0 == rank) {
+        for (i = 0; i < nprocs; i++) {
+            displs[i] = total;
+            total += counts[i];
+        }
+
+        all = malloc(sizeof(double) * MAX(total, 1));
+        sorted = malloc(sizeof(struct ranked_event) * MAX(total / 2, 1));
+        overlap = calloc(MAX(total / 2, 1), 1);
+
+        if (NULL == all || NULL == sorted || NULL == overlap) {
+            fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+            MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+        }
+    }
+
+    MPI_CHECK(MPI_Gatherv(events, 2 * num_events, MPI_DOUBLE, all, counts,
+                displs, MPI_DOUBLE, 0, MPI_COMM_WORLD));
+
+    if (0 != rank) {
+        return;
+    }
+
+    for (i = 0; i < nprocs; i++) {
+        for (j = 0; j < counts[i] / 2; j++) {
+            struct ranked_event *e = &sorted[displs[i] / 2 + j];
+
+            e->event.start = all[displs[i] + 2 * j];
+            e->event.length = all[displs[i] + 2 * j + 1];
+            e->rank = i;
+        }
+    }
+    total /= 2;
+
+    qsort(sorted, total, sizeof(struct ranked_event), compare_start);
+
+    /* Bit 0: overlaps an event on the same node, bit 1: on another node */
+    for (i = 0; i < total; i++) {
+        double end = sorted[i].event.start + sorted[i].event.length;
+
+        for (j = i + 1; j < total && sorted[j].event.start < end; j++) {
+            int bit;
+
+            if (sorted[j].rank == sorted[i].rank) {
+                continue;
+            }
+
+            bit = nodes[sorted[j].rank] == nodes[sorted[i].rank] ? 1 : 2;
+            overlap[i] |= bit;
+            overlap[j] |= bit;
+        }
+    }
+
+    for (i = 0; i < total; i++) {
+        same += overlap[i] & 1;
+        other += overlap[i] >> 1;
+    }
+
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "# Correlation of %d events", total);
+        if (all_dropped) {
+            fprintf(stdout, " (%ld more beyond %d per rank not kept)",
+                    all_dropped, MAX_NOISE_EVENTS);
+        }
+        fprintf(stdout, "\n");
+        fprintf(stdout, "#   overlapping another rank on the same node: "
+                "%.*f %%\n", FLOAT_PRECISION, total ? 100.0 * same / total :
+                0.0);
+        fprintf(stdout, "#   overlapping another rank on another node:  "
+                "%.*f %%\n", FLOAT_PRECISION, total ? 100.0 * other / total :
+                0.0);
+        fflush(stdout);
+    } else {
+        struct result_metric_t metrics[3] = {
+            {"events", total},
+            {"same_node_percent", total ? 100.0 * same / total : 0.0},
+            {"other_node_percent", total ? 100.0 * other / total : 0.0},
+        };
+
+        output_result(nprocs, 0, 3, metrics);
+    }
+
+    free(overlap);
+    free(sorted);
+    free(all);
+    free(nodes);
+    free(displs);
+    free(counts);
+}
+
+/*
+ * Average time of COLL on this rank in seconds, each call after a barrier
+ * and WORK chunks of the host kernel
+ */
+static double time_coll (enum noise_coll coll, long work)
+{
+    double t_start, t_sum = 0, in = 1.0, out;
+    int i;
+
+    for (i = 0; i < NOISE_COLL_ITERATIONS + NOISE_COLL_SKIP; i++) {
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+        if (work) {
+            compute_host_chunks(work);
+        }
+
+        t_start = osu_wtime();
+        if (COLL_BARRIER == coll) {
+            MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+        } else {
+            MPI_CHECK(MPI_Allreduce(&in, &out, 1, MPI_DOUBLE, MPI_SUM,
+                        MPI_COMM_WORLD));
+        }
+
+        if (i >= NOISE_COLL_SKIP) {
+            t_sum += osu_wtime() - t_start;
+        }
+    }
+
+    return t_sum / NOISE_COLL_ITERATIONS;
+}
+
+static void report_stats (int nprocs, double const *min, double const *avg,
+        double const *max)
+{
+    int s;
+
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "%-*s%*s%*s%*s\n", 24, "# Per rank", FIELD_WIDTH,
+                "Min", FIELD_WIDTH, "Avg", FIELD_WIDTH, "Max");
+        for (s = 0; s < STAT_NUM; s++) {
+            fprintf(stdout, "%-*s%*.*f%*.*f%*.*f\n", 24, stat_name[s],
+                    FIELD_WIDTH, FLOAT_PRECISION, min[s],
+                    FIELD_WIDTH, FLOAT_PRECISION, avg[s],
+                    FIELD_WIDTH, FLOAT_PRECISION, max[s]);
+        }
+        fflush(stdout);
+    } else {
+        struct result_metric_t metrics[3 * STAT_NUM];
+        char names[3 * STAT_NUM][64];
+
+        for (s = 0; s < STAT_NUM; s++) {
+            snprintf(names[3 * s], sizeof(names[0]), "%s_min", stat_metric[s]);
+            snprintf(names[3 * s + 1], sizeof(names[0]), "%s_avg",
+                    stat_metric[s]);
+            snprintf(names[3 * s + 2], sizeof(names[0]), "%s_max",
+                    stat_metric[s]);
+            metrics[3 * s].name = names[3 * s];
+            metrics[3 * s].value = min[s];
+            metrics[3 * s + 1].name = names[3 * s + 1];
+            metrics[3 * s + 1].value = avg[s];
+            metrics[3 * s + 2].name = names[3 * s + 2];
+            metrics[3 * s + 2].value = max[s];
+        }
+
+        output_result(nprocs, 0, 3 * STAT_NUM, metrics);
+    }
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -16,7 +16,10 @@ int main(int argc, char *argv[])
     double latency = 0.0, t_start = 0.0, t_stop = 0.0;
     double timer=0.0;
     double avg_time = 0.0, max_time = 0.0, min_time = 0.0;
-    float *sendbuf, *recvbuf;
+    void *sendbuf, *recvbuf;
+    MPI_Datatype dtype;
+    MPI_Op op;
+    size_t dtype_size;
     int po_ret;
     size_t bufsize;
 
@@ -25,6 +28,8 @@ int main(int argc, char *argv[])
 
     options.bench = COLLECTIVE;
     options.subtype = LAT;
+    options.backend = BACKEND_MPI;
+    options.dtype = DTYPE_FLOAT;
 
     po_ret = process_options(argc, argv);
 
@@ -74,30 +79,39 @@ int main(int argc, char *argv[])
         options.max_message_size = options.max_mem_limit;
     }
 
-    options.min_message_size /= sizeof(float);
+    dtype = reduction_datatype();
+    op = reduction_op();
+    dtype_size = reduction_extent();
+
+    options.min_message_size /= dtype_size;
     if (options.min_message_size < MIN_MESSAGE_SIZE) {
         options.min_message_size = MIN_MESSAGE_SIZE;
     }
 
-    bufsize = sizeof(float)*(options.max_message_size/sizeof(float));
-    if (allocate_memory_coll((void**)&recvbuf, bufsize,
+    bufsize = dtype_size*(options.max_message_size/dtype_size);
+    if (allocate_rotating_buffer((void**)&recvbuf, bufsize,
                 options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
     }
     set_buffer(recvbuf, options.accel, 1, bufsize);
 
-    bufsize = sizeof(float)*(options.max_message_size/sizeof(float));
-    if (allocate_memory_coll((void**)&sendbuf, bufsize,
+    bufsize = dtype_size*(options.max_message_size/dtype_size);
+    if (allocate_rotating_buffer((void**)&sendbuf, bufsize,
                 options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
     }
     set_buffer(sendbuf, options.accel, 0, bufsize);
 
+    if (BACKEND_NCCL == options.backend && init_nccl()) {
+        fprintf(stderr, "Could Not Initialize NCCL [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
     print_preamble(rank);
 
-    for(size=options.min_message_size; size*sizeof(float) <= options.max_message_size; size *= 2) {
+    for(size=options.min_message_size; size*dtype_size <= options.max_message_size; size = next_message_count(size, dtype_size)) {
 
         if(size > LARGE_MESSAGE_SIZE) {
             options.skip = options.skip_large;
@@ -107,14 +121,23 @@ int main(int argc, char *argv[])
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
         timer=0.0;
-        for(i=0; i < options.iterations + options.skip ; i++) {
-            t_start = MPI_Wtime();
-
-            MPI_CHECK(MPI_Reduce(sendbuf, recvbuf, size, MPI_FLOAT, MPI_SUM, 0, MPI_COMM_WORLD ));
-            t_stop=MPI_Wtime();
+        for(i=0; continue_iterations(i); i++) {
+            t_start = osu_wtime();
+
+            if (BACKEND_NCCL == options.backend) {
+                t_stop = t_start + nccl_collective(NCCL_REDUCE,
+                        rotate_buffer(sendbuf, size * dtype_size, i),
+                        rotate_buffer(recvbuf, size * dtype_size, i), size,
+                        dtype, op, 0);
+            } else {
+                MPI_CHECK(MPI_Reduce(rotate_buffer(sendbuf, size * dtype_size, i),
+                            rotate_buffer(recvbuf, size * dtype_size, i), size, dtype, op, 0, MPI_COMM_WORLD ));
+                t_stop=osu_wtime();
+            }
             if(i>=options.skip){
 
             timer+=t_stop-t_start;
+            record_latency(t_stop - t_start);
             }
             MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
         }
@@ -128,11 +151,16 @@ int main(int argc, char *argv[])
                 MPI_COMM_WORLD));
         avg_time = avg_time/numprocs;
 
-        print_stats(rank, size * sizeof(float), avg_time, min_time, max_time);
+        print_stats(rank, size * dtype_size, avg_time, min_time, max_time);
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
     }
 
+    if (BACKEND_NCCL == options.backend) {
+        cleanup_nccl();
+    }
+
     free_buffer(recvbuf, options.accel);
+    free_reduction_op();
     free_buffer(sendbuf, options.accel);
 
     MPI_CHECK(MPI_Finalize());
@@ -0,0 +1,262 @@
+#define BENCHMARK "OSU MPI_Reduce_local Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * The local reduction of a message, without any communication, the ceiling
+ * that the reduction puts on the bandwidth of MPI_Allreduce and MPI_Reduce.
+ * Every rank reduces -m bytes of the datatype of -y with the operation of -O
+ * into a second buffer, at the same time as the other ranks so that they
+ * share the memory bandwidth of the node the way they do in a collective:
+ *
+ *   MPI     MPI_Reduce_local of the library on the buffers of -d
+ *   Vector  the vectorized host kernels of the user-defined operation, on
+ *           host buffers, not for the pair types
+ *   Kernel  the reduction kernel of util/kernel.cu on CUDA and ROCm buffers,
+ *           when the benchmarks are built with the kernels
+ *
+ * The average latency over the ranks is printed with the bandwidth it gives,
+ * the message size over the latency.  The buffers hold zeros, which no
+ * operation turns into denormals.
+ */
+
+#include <osu_util_mpi.h>
+
+enum local_column {
+    COLUMN_MPI,
+    COLUMN_VECTOR,
+    COLUMN_KERNEL,
+    COLUMN_NUM
+};
+
+static char const *latency_column[COLUMN_NUM] = {"MPI (us)", "Vector (us)",
+    "Kernel (us)"};
+static char const *bandwidth_column[COLUMN_NUM] = {"MPI (MB/s)",
+    "Vector (MB/s)", "Kernel (MB/s)"};
+static char const *latency_metric[COLUMN_NUM] = {"mpi_us", "vector_us",
+    "kernel_us"};
+static char const *bandwidth_metric[COLUMN_NUM] = {"mpi_MBps", "vector_MBps",
+    "kernel_MBps"};
+
+static double time_column (enum local_column column, void * in, void * inout,
+        int count);
+
+int main (int argc, char *argv[])
+{
+    int rank, numprocs, count, i, n;
+    int po_ret = 0, active[COLUMN_NUM] = {0};
+    size_t dtype_size, bufsize, size, bytes;
+    char *sendbuf = NULL, *recvbuf = NULL, *host_in = NULL, *host_inout = NULL;
+    double latency[COLUMN_NUM], avg_latency[COLUMN_NUM];
+
+    options.bench = COLLECTIVE;
+    options.subtype = REDUCE_LOCAL;
+    options.dtype = DTYPE_FLOAT;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_reduce_local");
+    po_ret = process_options(argc, argv);
+
+    if (PO_OKAY == po_ret && NONE != options.accel) {
+        if (init_accel()) {
+            fprintf(stderr, "Error initializing device\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    set_num_ranks(numprocs);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_bad_usage_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (options.max_message_size > options.max_mem_limit) {
+        if (rank == 0) {
+            fprintf(stderr, "Warning! Increase the Max Memory Limit to be able to run up to %ld bytes.\n"
+                            "Continuing with max message size of %ld bytes\n",
+                            options.max_message_size, options.max_mem_limit);
+        }
+        options.max_message_size = options.max_mem_limit;
+    }
+
+    dtype_size = reduction_extent();
+    if (options.min_message_size < dtype_size) {
+        options.min_message_size = dtype_size;
+    }
+
+    bufsize = MAX(dtype_size, dtype_size * (options.max_message_size /
+                dtype_size));
+
+    if (allocate_memory_coll((void **)&sendbuf, bufsize, options.accel) ||
+            allocate_memory_coll((void **)&recvbuf, bufsize, options.accel)) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+    set_buffer(sendbuf, options.accel, 0, bufsize);
+    set_buffer(recvbuf, options.accel, 0, bufsize);
+
+    /* The vectorized kernels run on host copies of the buffers */
+    if (NONE == options.accel) {
+        host_in = sendbuf;
+        host_inout = recvbuf;
+    } else if (allocate_memory_coll((void **)&host_in, bufsize, NONE) ||
+            allocate_memory_coll((void **)&host_inout, bufsize, NONE)) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    } else {
+        fill_host_buffer(host_in, 0, bufsize);
+        fill_host_buffer(host_inout, 0, bufsize);
+    }
+
+    active[COLUMN_MPI] = 1;
+    active[COLUMN_VECTOR] = 0 == reduction_reference(host_in, host_inout, 0);
+    active[COLUMN_KERNEL] = 0 == reduction_kernel(sendbuf, recvbuf, 0);
+
+    if (0 == rank && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "# Datatype: %s, Operation: %s, %s buffers\n",
+                reduce_dtype_name(), reduce_op_name(),
+                NONE == options.accel ? "host" : "device");
+        fprintf(stdout, "%-*s", 10, "# Size");
+        for (i = 0; i < COLUMN_NUM; i++) {
+            if (active[i]) {
+                fprintf(stdout, "%*s%*s", FIELD_WIDTH, latency_column[i],
+                        FIELD_WIDTH, bandwidth_column[i]);
+            }
+        }
+        fprintf(stdout, "\n");
+        fflush(stdout);
+    }
+
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        count = size / dtype_size;
+        bytes = count * dtype_size;
+
+        if (size > LARGE_MESSAGE_SIZE) {
+            options.iterations = options.iterations_large;
+            options.skip = options.skip_large;
+        }
+
+        for (i = 0; i < COLUMN_NUM; i++) {
+            MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+            latency[i] = !active[i] ? 0.0 : COLUMN_VECTOR == i ?
+                time_column(i, host_in, host_inout, count) :
+                time_column(i, sendbuf, recvbuf, count);
+        }
+
+        MPI_CHECK(MPI_Reduce(latency, avg_latency, COLUMN_NUM, MPI_DOUBLE,
+                    MPI_SUM, 0, MPI_COMM_WORLD));
+
+        if (0 != rank) {
+            continue;
+        }
+
+        for (i = 0; i < COLUMN_NUM; i++) {
+            avg_latency[i] /= numprocs;
+        }
+
+        record_message_size(size, avg_latency[COLUMN_MPI]);
+
+        if (OUTPUT_TABLE == options.output_format) {
+            fprintf(stdout, "%-*zu", 10, bytes);
+            for (i = 0; i < COLUMN_NUM; i++) {
+                if (active[i]) {
+                    fprintf(stdout, "%*.*f%*.*f", FIELD_WIDTH,
+                            FLOAT_PRECISION, avg_latency[i], FIELD_WIDTH,
+                            FLOAT_PRECISION, bytes / avg_latency[i]);
+                }
+            }
+            fprintf(stdout, "\n");
+            fflush(stdout);
+        } else {
+            struct result_metric_t metrics[2 * COLUMN_NUM];
+
+            for (i = n = 0; i < COLUMN_NUM; i++) {
+                if (active[i]) {
+                    metrics[n].name = latency_metric[i];
+                    metrics[n++].value = avg_latency[i];
+                    metrics[n].name = bandwidth_metric[i];
+                    metrics[n++].value = bytes / avg_latency[i];
+                }
+            }
+
+            output_result(numprocs, bytes, n, metrics);
+        }
+    }
+
+    if (NONE != options.accel) {
+        free_buffer(host_in, NONE);
+        free_buffer(host_inout, NONE);
+    }
+    free_buffer(sendbuf, options.accel);
+    free_buffer(recvbuf, options.accel);
+    free_reduction_op();
+
+    MPI_CHECK(MPI_Finalize());
+
+    if (NONE != options.accel) {
+        if (cleanup_accel()) {
+            fprintf(stderr, "Error cleaning up device\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/* Latency in microseconds of one reduction of COUNT elements */
+static double time_column (enum local_column column, void * in, void * inout,
+        int count)
+{
+    MPI_Datatype dtype = reduction_datatype();
+    MPI_Op op = reduction_op();
+    double t_start = 0.0;
+    int i;
+
+    for (i = 0; i < options.iterations + options.skip; i++) {
+        if (i == options.skip) {
+            t_start = osu_wtime();
+        }
+
+        switch (column) {
+            case COLUMN_VECTOR:
+                reduction_reference(in, inout, count);
+                break;
+            case COLUMN_KERNEL:
+                reduction_kernel(in, inout, count);
+                break;
+            default:
+                MPI_CHECK(MPI_Reduce_local(in, inout, count, dtype, op));
+                break;
+        }
+    }
+
+    return (osu_wtime() - t_start) * 1e6 / options.iterations;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -16,16 +16,20 @@ int main(int argc, char *argv[])
     double latency = 0.0, t_start = 0.0, t_stop = 0.0;
     double timer=0.0;
     double avg_time = 0.0, max_time = 0.0, min_time = 0.0;
-    float *sendbuf, *recvbuf;
+    void *sendbuf, *recvbuf;
+    MPI_Datatype dtype;
+    MPI_Op op;
+    size_t dtype_size;
     int *recvcounts;
     int po_ret;
     size_t bufsize;
 
     set_header(HEADER);
-    set_benchmark_name("osu_scatter");
+    set_benchmark_name("osu_reduce_scatter");
 
     options.bench = COLLECTIVE;
     options.subtype = LAT;
+    options.dtype = DTYPE_FLOAT;
 
     po_ret = process_options(argc, argv);
 
@@ -75,7 +79,11 @@ int main(int argc, char *argv[])
         options.max_message_size = options.max_mem_limit;
     }
 
-    options.min_message_size /= sizeof(float);
+    dtype = reduction_datatype();
+    op = reduction_op();
+    dtype_size = reduction_extent();
+
+    options.min_message_size /= dtype_size;
     if (options.min_message_size < MIN_MESSAGE_SIZE) {
         options.min_message_size = MIN_MESSAGE_SIZE;
     }
@@ -85,15 +93,15 @@ int main(int argc, char *argv[])
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
     }
 
-    bufsize = sizeof(float)*(options.max_message_size/sizeof(float));
-    if (allocate_memory_coll((void**)&sendbuf, bufsize, options.accel)) {
+    bufsize = dtype_size*(options.max_message_size/dtype_size);
+    if (allocate_rotating_buffer((void**)&sendbuf, bufsize, options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
     }
     set_buffer(sendbuf, options.accel, 1, bufsize);
 
-    bufsize = sizeof(float)*(options.max_message_size/numprocs/sizeof(float)+1);
-    if (allocate_memory_coll((void**)&recvbuf, bufsize,
+    bufsize = dtype_size*(options.max_message_size/numprocs/dtype_size+1);
+    if (allocate_rotating_buffer((void**)&recvbuf, bufsize,
                 options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
@@ -102,7 +110,7 @@ int main(int argc, char *argv[])
 
     print_preamble(rank);
 
-    for(size=options.min_message_size; size*sizeof(float) <= options.max_message_size; size *= 2) {
+    for(size=options.min_message_size; size*dtype_size <= options.max_message_size; size = next_message_count(size, dtype_size)) {
 
         if(size > LARGE_MESSAGE_SIZE) {
             options.skip = options.skip_large;
@@ -129,14 +137,16 @@ int main(int argc, char *argv[])
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
         timer=0.0;
-        for(i=0; i < options.iterations + options.skip ; i++) {
-            t_start = MPI_Wtime();
+        for(i=0; continue_iterations(i); i++) {
+            t_start = osu_wtime();
 
-            MPI_CHECK(MPI_Reduce_scatter( sendbuf, recvbuf, recvcounts, MPI_FLOAT, MPI_SUM, MPI_COMM_WORLD ));
-            t_stop=MPI_Wtime();
+            MPI_CHECK(MPI_Reduce_scatter(rotate_buffer(sendbuf, size * dtype_size, i),
+                        rotate_buffer(recvbuf, size * dtype_size, i), recvcounts, dtype, op, MPI_COMM_WORLD ));
+            t_stop=osu_wtime();
             if(i>=options.skip){
 
             timer+=t_stop-t_start;
+            record_latency(t_stop - t_start);
             }
             MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
         }
@@ -150,13 +160,14 @@ int main(int argc, char *argv[])
                 MPI_COMM_WORLD));
         avg_time = avg_time/numprocs;
 
-        print_stats(rank, size * sizeof(float), avg_time, min_time, max_time);
+        print_stats(rank, size * dtype_size, avg_time, min_time, max_time);
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
     }
 
     free_buffer(recvcounts, NONE);
     free_buffer(sendbuf, options.accel);
     free_buffer(recvbuf, options.accel);
+    free_reduction_op();
 
     MPI_CHECK(MPI_Finalize());
 
@@ -72,14 +72,14 @@ main (int argc, char *argv[])
 
     if (0 == rank) {
         bufsize = options.max_message_size * numprocs;
-        if (allocate_memory_coll((void**)&sendbuf, bufsize, options.accel)) {
+        if (allocate_rotating_buffer((void**)&sendbuf, bufsize, options.accel)) {
             fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
             MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
         }
         set_buffer(sendbuf, options.accel, 1, bufsize);
     }
 
-    if (allocate_memory_coll((void**)&recvbuf, options.max_message_size,
+    if (allocate_rotating_buffer((void**)&recvbuf, options.max_message_size,
                 options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
@@ -88,7 +88,7 @@ main (int argc, char *argv[])
 
     print_preamble(rank);
 
-    for(size=options.min_message_size; size <= options.max_message_size; size *= 2) {
+    for(size=options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         if (size > LARGE_MESSAGE_SIZE) {
             options.skip = options.skip_large;
             options.iterations = options.iterations_large;
@@ -97,14 +97,16 @@ main (int argc, char *argv[])
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
         timer=0.0;
 
-        for (i=0; i < options.iterations + options.skip ; i++) {
-            t_start = MPI_Wtime();
-            MPI_CHECK(MPI_Scatter(sendbuf, size, MPI_CHAR, recvbuf, size, MPI_CHAR, 0,
+        for(i=0; continue_iterations(i); i++) {
+            t_start = osu_wtime();
+            MPI_CHECK(MPI_Scatter(rotate_buffer(sendbuf, size * numprocs, i), size, MPI_CHAR,
+                    rotate_buffer(recvbuf, size, i), size, MPI_CHAR, 0,
                     MPI_COMM_WORLD));
-            t_stop = MPI_Wtime();
+            t_stop = osu_wtime();
 
             if (i >= options.skip) {
                 timer+=t_stop-t_start;
+                record_latency(t_stop - t_start);
             }
             MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
         }
@@ -86,14 +86,14 @@ int main(int argc, char *argv[])
         }
 
         bufsize = options.max_message_size * numprocs;
-        if (allocate_memory_coll((void**)&sendbuf, bufsize, options.accel)) {
+        if (allocate_rotating_buffer((void**)&sendbuf, bufsize, options.accel)) {
             fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
             MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
         }
         set_buffer(sendbuf, options.accel, 1, bufsize);
     }
 
-    if (allocate_memory_coll((void**)&recvbuf, options.max_message_size,
+    if (allocate_rotating_buffer((void**)&recvbuf, options.max_message_size,
                 options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
@@ -102,7 +102,7 @@ int main(int argc, char *argv[])
 
     print_preamble(rank);
 
-    for(size=options.min_message_size; size <= options.max_message_size; size *= 2) {
+    for(size=options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
 
         if(size > LARGE_MESSAGE_SIZE) {
             options.skip = options.skip_large;
@@ -124,15 +124,17 @@ int main(int argc, char *argv[])
 
         timer=0.0;
 
-        for(i=0; i < options.iterations + options.skip ; i++) {
+        for(i=0; continue_iterations(i); i++) {
 
-            t_start = MPI_Wtime();
-            MPI_CHECK(MPI_Scatterv(sendbuf, sendcounts, sdispls, MPI_CHAR, recvbuf,
+            t_start = osu_wtime();
+            MPI_CHECK(MPI_Scatterv(rotate_buffer(sendbuf, size * numprocs, i), sendcounts, sdispls,
+                      MPI_CHAR, rotate_buffer(recvbuf, size, i),
                       size, MPI_CHAR, 0, MPI_COMM_WORLD));
 
-            t_stop = MPI_Wtime();
+            t_stop = osu_wtime();
             if(i >= options.skip) {
                 timer+=t_stop-t_start;
+                record_latency(t_stop - t_start);
             }
             MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
         }
@@ -0,0 +1,103 @@
+#define BENCHMARK "OSU MPI-IO MPI_File_write_at_all Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * Collective MPI_File_write_at_all of -m bytes per rank into a shared file,
+ * the contiguous or the strided view of --file-view, with the hints of
+ * --io-hints.
+ * The latency per call over the ranks is printed with the bandwidth of all
+ * ranks together and per node, see report_io().
+ */
+
+#include <osu_util_mpi.h>
+
+int main (int argc, char *argv[])
+{
+    int rank, numprocs, i;
+    int po_ret = 0;
+    size_t size;
+    char *buf = NULL;
+    double t_start = 0.0, latency;
+    MPI_File fh;
+
+    options.bench = COLLECTIVE;
+    options.subtype = IO;
+    options.file_view = FILE_VIEW_CONTIGUOUS;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_write_at_all");
+    po_ret = process_options(argc, argv);
+    options.show_size = 0;
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    set_num_ranks(numprocs);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_bad_usage_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (setup_io(rank, &fh)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (posix_memalign((void **)&buf, getpagesize(),
+                MAX(1, options.max_message_size))) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    fill_host_buffer(buf, 'a' + rank % 26, options.max_message_size);
+
+    print_io_header(rank, numprocs, fh);
+
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        set_io_view(fh, rank, numprocs, size);
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+        for (i = 0; i < options.iterations + options.skip; i++) {
+            if (i == options.skip) {
+                t_start = osu_wtime();
+            }
+
+            MPI_CHECK(MPI_File_write_at_all(fh, 0, buf, size, MPI_BYTE,
+                        MPI_STATUS_IGNORE));
+        }
+
+        latency = (osu_wtime() - t_start) * 1e6 / options.iterations;
+        report_io(rank, numprocs, size, latency);
+    }
+
+    cleanup_io(&fh);
+    free(buf);
+
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -11,16 +11,16 @@
 
 #include <osu_util_mpi.h>
 
-double  t_start = 0.0, t_end = 0.0;
-char    *sbuf=NULL, *win_base=NULL;
+static double  t_start = 0.0, t_end = 0.0;
+static char    *sbuf=NULL, *win_base=NULL;
 
-void print_latency (int, int);
-void run_acc_with_lock (int, enum WINDOW);
-void run_acc_with_fence (int, enum WINDOW);
-void run_acc_with_lock_all (int, enum WINDOW);
-void run_acc_with_flush (int, enum WINDOW);
-void run_acc_with_flush_local (int, enum WINDOW);
-void run_acc_with_pscw (int, enum WINDOW);
+static void print_latency (int, int);
+static void run_acc_with_lock (int, enum WINDOW);
+static void run_acc_with_fence (int, enum WINDOW);
+static void run_acc_with_lock_all (int, enum WINDOW);
+static void run_acc_with_flush (int, enum WINDOW);
+static void run_acc_with_flush_local (int, enum WINDOW);
+static void run_acc_with_pscw (int, enum WINDOW);
 
 int main (int argc, char *argv[])
 {
@@ -52,6 +52,7 @@ int main (int argc, char *argv[])
 
     MPI_CHECK(MPI_Init(&argc, &argv));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
 
     if (0 == rank) {
@@ -139,24 +140,23 @@ int main (int argc, char *argv[])
     return EXIT_SUCCESS;
 }
 
-void print_latency(int rank, int size)
+static void print_latency(int rank, int size)
 {
     if (rank == 0) {
-        fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.iterations);
+        print_result(size, (t_end - t_start) * 1.0e6 / options.iterations);
         fflush(stdout);
     }
 }
 
 #if MPI_VERSION >= 3
 /*Run ACC with flush */
-void run_acc_with_flush (int rank, enum WINDOW type)
+static void run_acc_with_flush (int rank, enum WINDOW type)
 {
     int size, i;
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &sbuf, &win_base, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -171,12 +171,12 @@ void run_acc_with_flush (int rank, enum WINDOW type)
             MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Accumulate(sbuf, size, MPI_CHAR, 1, disp, size, MPI_CHAR, MPI_SUM, win));
                 MPI_CHECK(MPI_Win_flush(1, win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
             MPI_CHECK(MPI_Win_unlock(1, win));
         }
 
@@ -189,13 +189,13 @@ void run_acc_with_flush (int rank, enum WINDOW type)
 }
 
 /*Run ACC with flush local*/
-void run_acc_with_flush_local (int rank, enum WINDOW type)
+static void run_acc_with_flush_local (int rank, enum WINDOW type)
 {
     int size, i;
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &sbuf, &win_base, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -210,12 +210,12 @@ void run_acc_with_flush_local (int rank, enum WINDOW type)
             MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Accumulate(sbuf, size, MPI_CHAR, 1, disp, size, MPI_CHAR, MPI_SUM, win));
                 MPI_CHECK(MPI_Win_flush_local(1, win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
             MPI_CHECK(MPI_Win_unlock(1, win));
         }
 
@@ -228,13 +228,13 @@ void run_acc_with_flush_local (int rank, enum WINDOW type)
 }
 
 /*Run ACC with Lock_all/unlock_all */
-void run_acc_with_lock_all (int rank, enum WINDOW type)
+static void run_acc_with_lock_all (int rank, enum WINDOW type)
 {
     int size, i;
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &sbuf, &win_base, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -249,13 +249,13 @@ void run_acc_with_lock_all (int rank, enum WINDOW type)
         if(rank == 0) {
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Win_lock_all(0, win));
                 MPI_CHECK(MPI_Accumulate(sbuf, size, MPI_CHAR, 1, disp, size, MPI_CHAR, MPI_SUM, win));
                 MPI_CHECK(MPI_Win_unlock_all(win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
         }
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
@@ -268,13 +268,13 @@ void run_acc_with_lock_all (int rank, enum WINDOW type)
 #endif
 
 /*Run ACC with Lock/unlock */
-void run_acc_with_lock(int rank, enum WINDOW type)
+static void run_acc_with_lock(int rank, enum WINDOW type)
 {
     int size, i;
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &sbuf, &win_base, size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -290,13 +290,13 @@ void run_acc_with_lock(int rank, enum WINDOW type)
         if(rank == 0) {
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
                 MPI_CHECK(MPI_Accumulate(sbuf, size, MPI_CHAR, 1, disp, size, MPI_CHAR, MPI_SUM, win));
                 MPI_CHECK(MPI_Win_unlock(1, win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
         }
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
@@ -308,14 +308,14 @@ void run_acc_with_lock(int rank, enum WINDOW type)
 }
 
 /*Run ACC with Fence */
-void run_acc_with_fence(int rank, enum WINDOW type)
+static void run_acc_with_fence(int rank, enum WINDOW type)
 {
     int size, i;
     MPI_Aint disp = 0;
     MPI_Win     win;
 
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &sbuf, &win_base, size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -334,14 +334,14 @@ void run_acc_with_fence(int rank, enum WINDOW type)
         if(rank == 0) {
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Win_fence(0, win));
                 MPI_CHECK(MPI_Accumulate(sbuf, size, MPI_CHAR, 1, disp, size, MPI_CHAR, MPI_SUM, win));
                 MPI_CHECK(MPI_Win_fence(0, win));
                 MPI_CHECK(MPI_Win_fence(0, win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
         } else {
             for (i = 0; i < options.skip + options.iterations; i++) {
                 MPI_CHECK(MPI_Win_fence(0, win));
@@ -354,8 +354,7 @@ void run_acc_with_fence(int rank, enum WINDOW type)
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
         if (rank == 0) {
-            fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                    FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.iterations / 2);
+            print_result(size, (t_end - t_start) * 1.0e6 / options.iterations / 2);
             fflush(stdout);
         }
 
@@ -364,7 +363,7 @@ void run_acc_with_fence(int rank, enum WINDOW type)
 }
 
 /*Run ACC with Post/Start/Complete/Wait */
-void run_acc_with_pscw(int rank, enum WINDOW type)
+static void run_acc_with_pscw(int rank, enum WINDOW type)
 {
     int destrank, size, i;
     MPI_Aint disp = 0;
@@ -373,7 +372,7 @@ void run_acc_with_pscw(int rank, enum WINDOW type)
 
     MPI_CHECK(MPI_Comm_group(MPI_COMM_WORLD, &comm_group));
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &sbuf, &win_base, size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -396,7 +395,7 @@ void run_acc_with_pscw(int rank, enum WINDOW type)
             for (i = 0; i < options.skip + options.iterations; i++) {
                 MPI_CHECK(MPI_Win_start (group, 0, win));
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Accumulate(sbuf, size, MPI_CHAR, 1, disp, size, MPI_CHAR, MPI_SUM, win));
                 MPI_CHECK(MPI_Win_complete(win));
@@ -404,7 +403,7 @@ void run_acc_with_pscw(int rank, enum WINDOW type)
                 MPI_CHECK(MPI_Win_wait(win));
             }
 
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
         } else {
             /* rank=1 */
             destrank = 0;
@@ -424,8 +423,7 @@ void run_acc_with_pscw(int rank, enum WINDOW type)
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
         if (rank == 0) {
-            fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                    FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.iterations / 2);
+            print_result(size, (t_end - t_start) * 1.0e6 / options.iterations / 2);
             fflush(stdout);
         }
 
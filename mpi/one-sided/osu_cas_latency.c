@@ -11,16 +11,16 @@
 
 #include <osu_util_mpi.h>
 
-double  t_start = 0.0, t_end = 0.0;
-uint64_t *sbuf=NULL, *tbuf=NULL, *cbuf=NULL, *win_base=NULL;
+static double  t_start = 0.0, t_end = 0.0;
+static uint64_t *sbuf=NULL, *tbuf=NULL, *cbuf=NULL, *win_base=NULL;
 
-void print_latency (int, int);
-void run_cas_with_lock (int, enum WINDOW);
-void run_cas_with_fence (int, enum WINDOW);
-void run_cas_with_lock_all (int, enum WINDOW);
-void run_cas_with_flush (int, enum WINDOW);
-void run_cas_with_flush_local (int, enum WINDOW);
-void run_cas_with_pscw (int, enum WINDOW);
+static void print_latency (int, int);
+static void run_cas_with_lock (int, enum WINDOW);
+static void run_cas_with_fence (int, enum WINDOW);
+static void run_cas_with_lock_all (int, enum WINDOW);
+static void run_cas_with_flush (int, enum WINDOW);
+static void run_cas_with_flush_local (int, enum WINDOW);
+static void run_cas_with_pscw (int, enum WINDOW);
 
 int main (int argc, char *argv[])
 {
@@ -48,6 +48,7 @@ int main (int argc, char *argv[])
 
     MPI_CHECK(MPI_Init(&argc, &argv));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
 
     if (0 == rank) {
@@ -131,17 +132,16 @@ int main (int argc, char *argv[])
     return EXIT_SUCCESS;
 }
 
-void print_latency(int rank, int size)
+static void print_latency(int rank, int size)
 {
     if (rank == 0) {
-        fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.iterations);
+        print_result(size, (t_end - t_start) * 1.0e6 / options.iterations);
         fflush(stdout);
     }
 }
 
 /*Run CAS with flush */
-void run_cas_with_flush (int rank, enum WINDOW type)
+static void run_cas_with_flush (int rank, enum WINDOW type)
 {
     int i;
     MPI_Aint disp = 0;
@@ -160,12 +160,12 @@ void run_cas_with_flush (int rank, enum WINDOW type)
         MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
         for (i = 0; i < options.skip + options.iterations; i++) {
             if (i == options.skip) {
-                t_start = MPI_Wtime ();
+                t_start = osu_wtime ();
             }
             MPI_CHECK(MPI_Compare_and_swap(sbuf, cbuf, tbuf, MPI_LONG_LONG, 1, disp, win));
             MPI_CHECK(MPI_Win_flush(1, win));
         }
-        t_end = MPI_Wtime ();
+        t_end = osu_wtime ();
         MPI_CHECK(MPI_Win_unlock(1, win));
     }                
 
@@ -177,7 +177,7 @@ void run_cas_with_flush (int rank, enum WINDOW type)
 }
 
 /*Run CAS with Lock_all/unlock_all */
-void run_cas_with_lock_all (int rank, enum WINDOW type)
+static void run_cas_with_lock_all (int rank, enum WINDOW type)
 {
     int i;
     MPI_Aint disp = 0;
@@ -195,13 +195,13 @@ void run_cas_with_lock_all (int rank, enum WINDOW type)
 
         for (i = 0; i < options.skip + options.iterations; i++) {
             if (i == options.skip) {
-                t_start = MPI_Wtime ();
+                t_start = osu_wtime ();
             }
             MPI_CHECK(MPI_Win_lock_all(0, win));
             MPI_CHECK(MPI_Compare_and_swap(sbuf, cbuf, tbuf, MPI_LONG_LONG, 1, disp, win));
             MPI_CHECK(MPI_Win_unlock_all(win));
         }
-        t_end = MPI_Wtime ();
+        t_end = osu_wtime ();
     }                
 
     MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
@@ -212,7 +212,7 @@ void run_cas_with_lock_all (int rank, enum WINDOW type)
 }
 
 /*Run CAS with flush */
-void run_cas_with_flush_local (int rank, enum WINDOW type)
+static void run_cas_with_flush_local (int rank, enum WINDOW type)
 {
     int i;
     MPI_Aint disp = 0;
@@ -232,12 +232,12 @@ void run_cas_with_flush_local (int rank, enum WINDOW type)
         MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
         for (i = 0; i < options.skip + options.iterations; i++) {
             if (i == options.skip) {
-                t_start = MPI_Wtime ();
+                t_start = osu_wtime ();
             }
             MPI_CHECK(MPI_Compare_and_swap(sbuf, cbuf, tbuf, MPI_LONG_LONG, 1, disp, win));
             MPI_CHECK(MPI_Win_flush_local(1, win));
         }
-        t_end = MPI_Wtime ();
+        t_end = osu_wtime ();
         MPI_CHECK(MPI_Win_unlock(1, win));
     }                
 
@@ -249,7 +249,7 @@ void run_cas_with_flush_local (int rank, enum WINDOW type)
 }
 
 /*Run CAS with Lock/unlock */
-void run_cas_with_lock(int rank, enum WINDOW type)
+static void run_cas_with_lock(int rank, enum WINDOW type)
 {
     int i;
     MPI_Aint disp = 0;
@@ -266,13 +266,13 @@ void run_cas_with_lock(int rank, enum WINDOW type)
         }
         for (i = 0; i < options.skip + options.iterations; i++) {
             if (i == options.skip) {
-                t_start = MPI_Wtime ();
+                t_start = osu_wtime ();
             }
             MPI_CHECK(MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 1, 0, win));
             MPI_CHECK(MPI_Compare_and_swap(sbuf, cbuf, tbuf, MPI_LONG_LONG, 1, disp, win));
             MPI_CHECK(MPI_Win_unlock(1, win));
         }
-        t_end = MPI_Wtime ();
+        t_end = osu_wtime ();
     }                
 
     MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
@@ -283,7 +283,7 @@ void run_cas_with_lock(int rank, enum WINDOW type)
 }
 
 /*Run CAS with Fence */
-void run_cas_with_fence(int rank, enum WINDOW type)
+static void run_cas_with_fence(int rank, enum WINDOW type)
 {
     int i;
     MPI_Aint disp = 0;
@@ -301,14 +301,14 @@ void run_cas_with_fence(int rank, enum WINDOW type)
     if(rank == 0) {
         for (i = 0; i < options.skip + options.iterations; i++) {
             if (i == options.skip) {
-                t_start = MPI_Wtime ();
+                t_start = osu_wtime ();
             }
             MPI_CHECK(MPI_Win_fence(0, win));
             MPI_CHECK(MPI_Compare_and_swap(sbuf, cbuf, tbuf, MPI_LONG_LONG, 1, disp, win));
             MPI_CHECK(MPI_Win_fence(0, win));
             MPI_CHECK(MPI_Win_fence(0, win));
         }
-        t_end = MPI_Wtime ();
+        t_end = osu_wtime ();
     } else {
         for (i = 0; i < options.skip + options.iterations; i++) {
             MPI_CHECK(MPI_Win_fence(0, win));
@@ -321,8 +321,7 @@ void run_cas_with_fence(int rank, enum WINDOW type)
     MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
     if (rank == 0) {
-        fprintf(stdout, "%-*d%*.*f\n", 10, 8, FIELD_WIDTH,
-                FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.iterations / 2);
+        print_result(8, (t_end - t_start) * 1.0e6 / options.iterations / 2);
         fflush(stdout);
     }
 
@@ -330,7 +329,7 @@ void run_cas_with_fence(int rank, enum WINDOW type)
 }
 
 /*Run CAS with Post/Start/Complete/Wait */
-void run_cas_with_pscw(int rank, enum WINDOW type)
+static void run_cas_with_pscw(int rank, enum WINDOW type)
 {
     int destrank, i;
     MPI_Aint disp = 0;
@@ -357,7 +356,7 @@ void run_cas_with_pscw(int rank, enum WINDOW type)
             MPI_CHECK(MPI_Win_start (group, 0, win));
 
             if (i == options.skip) {
-                t_start = MPI_Wtime ();
+                t_start = osu_wtime ();
             }
 
             MPI_CHECK(MPI_Compare_and_swap(sbuf, cbuf, tbuf, MPI_LONG_LONG, 1, disp, win));
@@ -366,7 +365,7 @@ void run_cas_with_pscw(int rank, enum WINDOW type)
             MPI_CHECK(MPI_Win_wait(win));
         }
 
-        t_end = MPI_Wtime ();
+        t_end = osu_wtime ();
     } else {
         /* rank=1 */
         destrank = 0;
@@ -386,8 +385,7 @@ void run_cas_with_pscw(int rank, enum WINDOW type)
     MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
     if (rank == 0) {
-        fprintf(stdout, "%-*d%*.*f\n", 10, 8, FIELD_WIDTH,
-                FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.iterations / 2);
+        print_result(8, (t_end - t_start) * 1.0e6 / options.iterations / 2);
         fflush(stdout);
     }
 
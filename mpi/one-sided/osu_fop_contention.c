@@ -0,0 +1,448 @@
+#define BENCHMARK "OSU MPI_Fetch_and_op%s Contention Test"
+/*
+ * Copyright (C) 2003-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * osu_fop_latency has a single origin.  Here up to all ranks but rank 0 call
+ * MPI_Fetch_and_op on counters of rank 0 at the same time, the way the ranks
+ * of a distributed hash table or work queue hit a hot bucket.  The origins are
+ * swept over the powers of two up to -t and spread round robin over -l
+ * counters: one slot shows how the target serializes updates to a single
+ * location, more slots how far it scales with independent ones.  Every window
+ * creation and synchronization mode is run unless -w or -s picks one.
+ */
+
+#include <osu_util_mpi.h>
+
+#define TARGET 0
+
+static uint64_t *counters = NULL;
+static MPI_Aint slot_base = 0;
+
+static void create_window (int rank, enum WINDOW type, MPI_Win *win);
+static void free_window (int rank, enum WINDOW type, MPI_Win *win);
+static void reset_counters (int rank, MPI_Win win);
+static uint64_t sum_counters (int rank, MPI_Win win);
+static double run_contention (int rank, int origins, enum SYNC sync,
+        MPI_Win win);
+static void report (int origins, double const *times, enum WINDOW type,
+        enum SYNC sync);
+
+/* Powers of two, and the largest count even if it is not one */
+static int next_origins (int origins, int max_origins)
+{
+    if (origins < max_origins && 2 * origins > max_origins) {
+        return max_origins;
+    }
+
+    return 2 * origins;
+}
+
+int main (int argc, char *argv[])
+{
+    int rank, nprocs, origins, max_origins;
+    int po_ret = PO_OKAY;
+    int win, sync, first_win, last_win, first_sync, last_sync;
+    double t_rank, *times = NULL;
+    uint64_t expected, total;
+    MPI_Win mpi_win;
+
+    options.win = WIN_ALLOCATE;
+    options.sync = FLUSH;
+    options.win_sweep = 1;
+    options.sync_sweep = 1;
+
+    options.bench = ONE_SIDED;
+    options.subtype = CONTENTION;
+    options.synctype = ALL_SYNC;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_fop_contention");
+
+    po_ret = process_options(argc, argv);
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+
+    if (0 == rank) {
+        switch (po_ret) {
+            case PO_BAD_USAGE:
+                print_bad_usage_message(rank);
+            case PO_HELP_MESSAGE:
+                usage_one_sided("osu_fop_contention");
+                break;
+            case PO_VERSION_MESSAGE:
+                print_version_message(rank);
+                MPI_CHECK(MPI_Finalize());
+                exit(EXIT_SUCCESS);
+            case PO_OKAY:
+                break;
+        }
+    }
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+        case PO_VERSION_MESSAGE:
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (nprocs < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+
+        return EXIT_FAILURE;
+    }
+
+    max_origins = nprocs - 1;
+    if (options.rma_origins && options.rma_origins < max_origins) {
+        max_origins = options.rma_origins;
+    }
+
+    first_win = options.win_sweep ? WIN_CREATE : options.win;
+    last_win = options.win_sweep ? WIN_DYNAMIC : options.win;
+    first_sync = options.sync_sweep ? LOCK : options.sync;
+    last_sync = options.sync_sweep ? LOCK_ALL : options.sync;
+
+    if (0 == rank) {
+        times = malloc(sizeof(double) * nprocs);
+        if (NULL == times) {
+            fprintf(stderr, "Error allocating memory on Rank %d\n", rank);
+            MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+        }
+
+        if (OUTPUT_TABLE == options.output_format) {
+            printf(benchmark_header, "");
+            fprintf(stdout, "# Target: rank %d, %d slot(s) %d bytes apart, "
+                    "up to %d origins\n", TARGET, options.rma_slots,
+                    RMA_SLOT_SPACING, max_origins);
+            fflush(stdout);
+        }
+    }
+
+    for (win = first_win; win <= last_win; win++) {
+        create_window(rank, win, &mpi_win);
+
+        for (sync = first_sync; sync <= last_sync; sync++) {
+            if (0 == rank && OUTPUT_TABLE == options.output_format) {
+                fprintf(stdout, "# Window creation: %s\n", win_info[win]);
+                fprintf(stdout, "# Synchronization: %s\n", sync_info[sync]);
+                fprintf(stdout, "%-*s%*s%*s%*s%*s%*s%*s\n", 10, "# Origins",
+                        10, "Slots", FIELD_WIDTH, "Ops/s",
+                        FIELD_WIDTH, "Min Origin(op/s)",
+                        FIELD_WIDTH, "Max Origin(op/s)",
+                        FIELD_WIDTH, "Fairness", FIELD_WIDTH, "Latency (us)");
+                fflush(stdout);
+            }
+
+            for (origins = 1; origins <= max_origins;
+                    origins = next_origins(origins, max_origins)) {
+                reset_counters(rank, mpi_win);
+
+                t_rank = run_contention(rank, origins, sync, mpi_win);
+
+                MPI_CHECK(MPI_Gather(&t_rank, 1, MPI_DOUBLE, times, 1,
+                            MPI_DOUBLE, 0, MPI_COMM_WORLD));
+
+                /* Every increment has to land, a lost update is a bug */
+                total = sum_counters(rank, mpi_win);
+                expected = (uint64_t)origins * (options.skip +
+                        options.iterations);
+
+                if (0 == rank) {
+                    if (total != expected) {
+                        fprintf(stderr, "Warning! %d origins: counters sum to "
+                                "%llu instead of %llu\n", origins,
+                                (unsigned long long)total,
+                                (unsigned long long)expected);
+                    }
+
+                    report(origins, times, win, sync);
+                }
+            }
+        }
+
+        free_window(rank, win, &mpi_win);
+    }
+
+    free(times);
+
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * Only the target exposes memory.  The dynamic window attaches it after the
+ * creation and broadcasts its address, which is the displacement of slot 0.
+ */
+static void create_window (int rank, enum WINDOW type, MPI_Win *win)
+{
+    size_t bytes = (size_t)options.rma_slots * RMA_SLOT_SPACING;
+    MPI_Aint size = (TARGET == rank) ? bytes : 0;
+
+    counters = NULL;
+    slot_base = 0;
+
+    if (TARGET == rank && WIN_ALLOCATE != type) {
+        if (posix_memalign((void **)&counters, RMA_SLOT_SPACING, bytes)) {
+            fprintf(stderr, "Error allocating memory on Rank %d\n", rank);
+            MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+        }
+    }
+
+    switch (type) {
+        case WIN_CREATE:
+            MPI_CHECK(MPI_Win_create(counters, size, 1, MPI_INFO_NULL,
+                        MPI_COMM_WORLD, win));
+            break;
+        case WIN_ALLOCATE:
+            MPI_CHECK(MPI_Win_allocate(size, 1, MPI_INFO_NULL, MPI_COMM_WORLD,
+                        &counters, win));
+            break;
+        default:
+            MPI_CHECK(MPI_Win_create_dynamic(MPI_INFO_NULL, MPI_COMM_WORLD,
+                        win));
+            if (TARGET == rank) {
+                MPI_CHECK(MPI_Win_attach(*win, counters, bytes));
+                MPI_CHECK(MPI_Get_address(counters, &slot_base));
+            }
+            MPI_CHECK(MPI_Bcast(&slot_base, 1, MPI_AINT, TARGET,
+                        MPI_COMM_WORLD));
+            break;
+    }
+}
+
+static void free_window (int rank, enum WINDOW type, MPI_Win *win)
+{
+    if (WIN_DYNAMIC == type && TARGET == rank) {
+        MPI_CHECK(MPI_Win_detach(*win, counters));
+    }
+
+    MPI_CHECK(MPI_Win_free(win));
+
+    if (WIN_ALLOCATE != type) {
+        free(counters);
+    }
+    counters = NULL;
+}
+
+/* The target touches its own window in an exclusive epoch only */
+static void reset_counters (int rank, MPI_Win win)
+{
+    if (TARGET == rank) {
+        MPI_CHECK(MPI_Win_lock(MPI_LOCK_EXCLUSIVE, TARGET, 0, win));
+        memset(counters, 0, (size_t)options.rma_slots * RMA_SLOT_SPACING);
+        MPI_CHECK(MPI_Win_unlock(TARGET, win));
+    }
+
+    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+}
+
+static uint64_t sum_counters (int rank, MPI_Win win)
+{
+    uint64_t total = 0;
+    int i;
+
+    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+    if (TARGET == rank) {
+        MPI_CHECK(MPI_Win_lock(MPI_LOCK_EXCLUSIVE, TARGET, 0, win));
+        for (i = 0; i < options.rma_slots; i++) {
+            total += counters[i * RMA_SLOT_SPACING / sizeof(uint64_t)];
+        }
+        MPI_CHECK(MPI_Win_unlock(TARGET, win));
+    }
+
+    return total;
+}
+
+/*
+ * Ranks 1 to ORIGINS increment their slot skip + iterations times and return
+ * the time of the timed iterations.  Fence is collective over the window, so
+ * the idle ranks and the target go through the same number of fences; with
+ * PSCW the target exposes its window to the group of origins.
+ */
+static double run_contention (int rank, int origins, enum SYNC sync,
+        MPI_Win win)
+{
+    int active = (rank > 0 && rank <= origins);
+    int target = TARGET;
+    MPI_Aint disp = slot_base +
+        (MPI_Aint)((rank - 1) % options.rma_slots) * RMA_SLOT_SPACING;
+    uint64_t one = 1, result = 0;
+    double t_start = 0.0;
+    MPI_Group world_group, group;
+    int range[1][3] = {{1, origins, 1}};
+    int i;
+
+    if (!active && FENCE != sync && PSCW != sync) {
+        return 0.0;
+    }
+    if (!active && PSCW == sync && TARGET != rank) {
+        return 0.0;
+    }
+
+    switch (sync) {
+        case LOCK:
+            for (i = 0; i < options.skip + options.iterations; i++) {
+                if (i == options.skip) {
+                    t_start = osu_wtime();
+                }
+                MPI_CHECK(MPI_Win_lock(MPI_LOCK_EXCLUSIVE, TARGET, 0, win));
+                MPI_CHECK(MPI_Fetch_and_op(&one, &result, MPI_UINT64_T,
+                            TARGET, disp, MPI_SUM, win));
+                MPI_CHECK(MPI_Win_unlock(TARGET, win));
+            }
+            break;
+        case LOCK_ALL:
+            for (i = 0; i < options.skip + options.iterations; i++) {
+                if (i == options.skip) {
+                    t_start = osu_wtime();
+                }
+                MPI_CHECK(MPI_Win_lock_all(0, win));
+                MPI_CHECK(MPI_Fetch_and_op(&one, &result, MPI_UINT64_T,
+                            TARGET, disp, MPI_SUM, win));
+                MPI_CHECK(MPI_Win_unlock_all(win));
+            }
+            break;
+        case FLUSH:
+        case FLUSH_LOCAL:
+            MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, TARGET, 0, win));
+            for (i = 0; i < options.skip + options.iterations; i++) {
+                if (i == options.skip) {
+                    t_start = osu_wtime();
+                }
+                MPI_CHECK(MPI_Fetch_and_op(&one, &result, MPI_UINT64_T,
+                            TARGET, disp, MPI_SUM, win));
+                if (FLUSH == sync) {
+                    MPI_CHECK(MPI_Win_flush(TARGET, win));
+                } else {
+                    MPI_CHECK(MPI_Win_flush_local(TARGET, win));
+                }
+            }
+            MPI_CHECK(MPI_Win_unlock(TARGET, win));
+            break;
+        case FENCE:
+            MPI_CHECK(MPI_Win_fence(0, win));
+            for (i = 0; i < options.skip + options.iterations; i++) {
+                if (i == options.skip) {
+                    t_start = osu_wtime();
+                }
+                if (active) {
+                    MPI_CHECK(MPI_Fetch_and_op(&one, &result, MPI_UINT64_T,
+                                TARGET, disp, MPI_SUM, win));
+                }
+                MPI_CHECK(MPI_Win_fence(0, win));
+            }
+            break;
+        case PSCW:
+            MPI_CHECK(MPI_Comm_group(MPI_COMM_WORLD, &world_group));
+            if (TARGET == rank) {
+                MPI_CHECK(MPI_Group_range_incl(world_group, 1, range, &group));
+            } else {
+                MPI_CHECK(MPI_Group_incl(world_group, 1, &target, &group));
+            }
+
+            for (i = 0; i < options.skip + options.iterations; i++) {
+                if (i == options.skip) {
+                    t_start = osu_wtime();
+                }
+                if (TARGET == rank) {
+                    MPI_CHECK(MPI_Win_post(group, 0, win));
+                    MPI_CHECK(MPI_Win_wait(win));
+                } else {
+                    MPI_CHECK(MPI_Win_start(group, 0, win));
+                    MPI_CHECK(MPI_Fetch_and_op(&one, &result, MPI_UINT64_T,
+                                TARGET, disp, MPI_SUM, win));
+                    MPI_CHECK(MPI_Win_complete(win));
+                }
+            }
+
+            MPI_CHECK(MPI_Group_free(&group));
+            MPI_CHECK(MPI_Group_free(&world_group));
+            break;
+    }
+
+    return active ? osu_wtime() - t_start : 0.0;
+}
+
+/*
+ * The aggregate rate is taken over the slowest origin.  Fairness is Jain's
+ * index of the per-origin rates, 1 when all origins get the same share and
+ * 1 / ORIGINS when a single one is served.
+ */
+static void report (int origins, double const *times, enum WINDOW type,
+        enum SYNC sync)
+{
+    double ops = options.iterations;
+    double rate, sum = 0.0, sum_sq = 0.0, min_rate = 0.0, max_rate = 0.0;
+    double max_time = 0.0, total_time = 0.0, aggregate, fairness, latency;
+    int i;
+
+    for (i = 1; i <= origins; i++) {
+        rate = ops / times[i];
+
+        sum += rate;
+        sum_sq += rate * rate;
+        total_time += times[i];
+
+        if (times[i] > max_time) {
+            max_time = times[i];
+        }
+        if (1 == i || rate < min_rate) {
+            min_rate = rate;
+        }
+        if (1 == i || rate > max_rate) {
+            max_rate = rate;
+        }
+    }
+
+    aggregate = ops * origins / max_time;
+    fairness = sum * sum / (origins * sum_sq);
+    latency = total_time * 1e6 / (ops * origins);
+
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "%-*d%*d%*.*f%*.*f%*.*f%*.*f%*.*f\n", 10, origins,
+                10, options.rma_slots,
+                FIELD_WIDTH, FLOAT_PRECISION, aggregate,
+                FIELD_WIDTH, FLOAT_PRECISION, min_rate,
+                FIELD_WIDTH, FLOAT_PRECISION, max_rate,
+                FIELD_WIDTH, FLOAT_PRECISION, fairness,
+                FIELD_WIDTH, FLOAT_PRECISION, latency);
+        fflush(stdout);
+    } else {
+        struct result_metric_t metrics[9] = {
+            {"window", type},
+            {"sync", sync},
+            {"origins", origins},
+            {"slots", options.rma_slots},
+            {"ops_per_sec", aggregate},
+            {"min_origin_rate", min_rate},
+            {"max_origin_rate", max_rate},
+            {"fairness", fairness},
+            {"latency_us", latency},
+        };
+
+        output_result(benchmark_num_ranks, sizeof(uint64_t), 9, metrics);
+    }
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -11,16 +11,16 @@
 
 #include <osu_util_mpi.h>
 
-double  t_start = 0.0, t_end = 0.0;
-uint64_t *sbuf=NULL, *tbuf=NULL, *win_base = NULL;
+static double  t_start = 0.0, t_end = 0.0;
+static uint64_t *sbuf=NULL, *tbuf=NULL, *win_base = NULL;
 
-void print_latency (int, int);
-void run_fop_with_lock (int, enum WINDOW);
-void run_fop_with_fence (int, enum WINDOW);
-void run_fop_with_lock_all (int, enum WINDOW);
-void run_fop_with_flush (int, enum WINDOW);
-void run_fop_with_flush_local (int, enum WINDOW);
-void run_fop_with_pscw (int, enum WINDOW);
+static void print_latency (int, int);
+static void run_fop_with_lock (int, enum WINDOW);
+static void run_fop_with_fence (int, enum WINDOW);
+static void run_fop_with_lock_all (int, enum WINDOW);
+static void run_fop_with_flush (int, enum WINDOW);
+static void run_fop_with_flush_local (int, enum WINDOW);
+static void run_fop_with_pscw (int, enum WINDOW);
 
 int main (int argc, char *argv[])
 {
@@ -48,6 +48,7 @@ int main (int argc, char *argv[])
 
     MPI_CHECK(MPI_Init(&argc, &argv));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
 
     if (0 == rank) {
@@ -136,17 +137,16 @@ int main (int argc, char *argv[])
 
 
 
-void print_latency(int rank, int size)
+static void print_latency(int rank, int size)
 {
     if (rank == 0) {
-        fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.iterations);
+        print_result(size, (t_end - t_start) * 1.0e6 / options.iterations);
         fflush(stdout);
     }
 }
 
 /*Run FOP with flush local*/
-void run_fop_with_flush_local (int rank, enum WINDOW type)
+static void run_fop_with_flush_local (int rank, enum WINDOW type)
 {
     int i;
     MPI_Win     win;
@@ -166,12 +166,12 @@ void run_fop_with_flush_local (int rank, enum WINDOW type)
         MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
         for (i = 0; i < options.skip + options.iterations; i++) {
             if (i == options.skip) {
-                t_start = MPI_Wtime ();
+                t_start = osu_wtime ();
             }
             MPI_CHECK(MPI_Fetch_and_op(sbuf, tbuf, MPI_LONG_LONG, 1, disp, MPI_SUM, win));
             MPI_CHECK(MPI_Win_flush_local(1, win));
         }
-        t_end = MPI_Wtime ();
+        t_end = osu_wtime ();
         MPI_CHECK(MPI_Win_unlock(1, win));
     }                
 
@@ -183,7 +183,7 @@ void run_fop_with_flush_local (int rank, enum WINDOW type)
 }
 
 /*Run FOP with flush */
-void run_fop_with_flush (int rank, enum WINDOW type)
+static void run_fop_with_flush (int rank, enum WINDOW type)
 {
     int i;
     MPI_Aint disp = 0;
@@ -201,12 +201,12 @@ void run_fop_with_flush (int rank, enum WINDOW type)
         MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
         for (i = 0; i < options.skip + options.iterations; i++) {
             if (i == options.skip) {
-                t_start = MPI_Wtime ();
+                t_start = osu_wtime ();
             }
             MPI_CHECK(MPI_Fetch_and_op(sbuf, tbuf, MPI_LONG_LONG, 1, disp, MPI_SUM, win));
             MPI_CHECK(MPI_Win_flush(1, win));
         }
-        t_end = MPI_Wtime ();
+        t_end = osu_wtime ();
         MPI_CHECK(MPI_Win_unlock(1, win));
     }                
 
@@ -218,7 +218,7 @@ void run_fop_with_flush (int rank, enum WINDOW type)
 }
 
 /*Run FOP with Lock_all/unlock_all */
-void run_fop_with_lock_all (int rank, enum WINDOW type)
+static void run_fop_with_lock_all (int rank, enum WINDOW type)
 {
     int i;
     MPI_Aint disp = 0;
@@ -234,13 +234,13 @@ void run_fop_with_lock_all (int rank, enum WINDOW type)
 
         for (i = 0; i < options.skip + options.iterations; i++) {
             if (i == options.skip) {
-                t_start = MPI_Wtime ();
+                t_start = osu_wtime ();
             }
             MPI_CHECK(MPI_Win_lock_all(0, win));
             MPI_CHECK(MPI_Fetch_and_op(sbuf, tbuf, MPI_LONG_LONG, 1, disp, MPI_SUM, win));
             MPI_CHECK(MPI_Win_unlock_all(win));
         }
-        t_end = MPI_Wtime ();
+        t_end = osu_wtime ();
     }                
 
     MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
@@ -251,7 +251,7 @@ void run_fop_with_lock_all (int rank, enum WINDOW type)
 }
 
 /*Run FOP with Lock/unlock */
-void run_fop_with_lock(int rank, enum WINDOW type)
+static void run_fop_with_lock(int rank, enum WINDOW type)
 {
     int i;
     MPI_Aint disp = 0;
@@ -267,13 +267,13 @@ void run_fop_with_lock(int rank, enum WINDOW type)
 
         for (i = 0; i < options.skip + options.iterations; i++) {
             if (i == options.skip) {
-                t_start = MPI_Wtime ();
+                t_start = osu_wtime ();
             }
             MPI_CHECK(MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 1, 0, win));
             MPI_CHECK(MPI_Fetch_and_op(sbuf, tbuf, MPI_LONG_LONG, 1, disp, MPI_SUM, win));
             MPI_CHECK(MPI_Win_unlock(1, win));
         }
-        t_end = MPI_Wtime ();
+        t_end = osu_wtime ();
     }                
 
     MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
@@ -284,7 +284,7 @@ void run_fop_with_lock(int rank, enum WINDOW type)
 }
 
 /*Run FOP with Fence */
-void run_fop_with_fence(int rank, enum WINDOW type)
+static void run_fop_with_fence(int rank, enum WINDOW type)
 {
     int i;
     MPI_Aint disp = 0;
@@ -302,14 +302,14 @@ void run_fop_with_fence(int rank, enum WINDOW type)
 
         for (i = 0; i < options.skip + options.iterations; i++) {
             if (i == options.skip) {
-                t_start = MPI_Wtime ();
+                t_start = osu_wtime ();
             }
             MPI_CHECK(MPI_Win_fence(0, win));
             MPI_CHECK(MPI_Fetch_and_op(sbuf, tbuf, MPI_LONG_LONG, 1, disp, MPI_SUM, win));
             MPI_CHECK(MPI_Win_fence(0, win));
             MPI_CHECK(MPI_Win_fence(0, win));
         }
-        t_end = MPI_Wtime ();
+        t_end = osu_wtime ();
     } else {
         for (i = 0; i < options.skip + options.iterations; i++) {
             MPI_CHECK(MPI_Win_fence(0, win));
@@ -322,8 +322,7 @@ void run_fop_with_fence(int rank, enum WINDOW type)
     MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
     if (rank == 0) {
-        fprintf(stdout, "%-*d%*.*f\n", 10, 8, FIELD_WIDTH,
-                FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.iterations / 2);
+        print_result(8, (t_end - t_start) * 1.0e6 / options.iterations / 2);
         fflush(stdout);
     }
 
@@ -331,7 +330,7 @@ void run_fop_with_fence(int rank, enum WINDOW type)
 }
 
 /*Run FOP with Post/Start/Complete/Wait */
-void run_fop_with_pscw(int rank, enum WINDOW type)
+static void run_fop_with_pscw(int rank, enum WINDOW type)
 {
     int destrank, i;
     MPI_Aint disp = 0;
@@ -357,7 +356,7 @@ void run_fop_with_pscw(int rank, enum WINDOW type)
             MPI_CHECK(MPI_Win_start (group, 0, win));
 
             if (i == options.skip) {
-                t_start = MPI_Wtime ();
+                t_start = osu_wtime ();
             }
 
             MPI_CHECK(MPI_Fetch_and_op(sbuf, tbuf, MPI_LONG_LONG, 1, disp, MPI_SUM, win));
@@ -366,7 +365,7 @@ void run_fop_with_pscw(int rank, enum WINDOW type)
             MPI_CHECK(MPI_Win_wait(win));
         }
 
-        t_end = MPI_Wtime ();
+        t_end = osu_wtime ();
     } else {
         /* rank=1 */
         destrank = 0;
@@ -386,8 +385,7 @@ void run_fop_with_pscw(int rank, enum WINDOW type)
     MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
     if (rank == 0) {
-        fprintf(stdout, "%-*d%*.*f\n", 10, 8, FIELD_WIDTH,
-                FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.iterations / 2);
+        print_result(8, (t_end - t_start) * 1.0e6 / options.iterations / 2);
         fflush(stdout);
     }
 
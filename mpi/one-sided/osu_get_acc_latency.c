@@ -11,21 +11,21 @@
 
 #include <osu_util_mpi.h>
 
-double  t_start = 0.0, t_end = 0.0;
-char    *sbuf=NULL, *rbuf=NULL, *cbuf=NULL;
-MPI_Aint sdisp_remote;
-MPI_Aint sdisp_local;
+static double  t_start = 0.0, t_end = 0.0;
+static char    *sbuf=NULL, *rbuf=NULL, *cbuf=NULL;
+static MPI_Aint sdisp_remote;
+static MPI_Aint sdisp_local;
 
 
-void allocate_memory_get_acc_lat (int, char *, int, enum WINDOW, MPI_Win *win);
-void print_header_get_acc_lat (int, enum WINDOW, enum SYNC);
-void print_latency_get_acc_lat (int, int);
-void run_get_acc_with_lock (int, enum WINDOW);
-void run_get_acc_with_fence (int, enum WINDOW);
-void run_get_acc_with_lock_all (int, enum WINDOW);
-void run_get_acc_with_flush (int, enum WINDOW);
-void run_get_acc_with_flush_local (int, enum WINDOW);
-void run_get_acc_with_pscw (int, enum WINDOW);
+static void allocate_memory_get_acc_lat (int, char *, int, enum WINDOW, MPI_Win *win);
+static void print_header_get_acc_lat (int, enum WINDOW, enum SYNC);
+static void print_latency_get_acc_lat (int, int);
+static void run_get_acc_with_lock (int, enum WINDOW);
+static void run_get_acc_with_fence (int, enum WINDOW);
+static void run_get_acc_with_lock_all (int, enum WINDOW);
+static void run_get_acc_with_flush (int, enum WINDOW);
+static void run_get_acc_with_flush_local (int, enum WINDOW);
+static void run_get_acc_with_pscw (int, enum WINDOW);
 
 
 int main (int argc, char *argv[])
@@ -40,6 +40,7 @@ int main (int argc, char *argv[])
  
     MPI_CHECK(MPI_Init(&argc, &argv));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
 
     if(nprocs != 2) {
@@ -128,13 +129,13 @@ int main (int argc, char *argv[])
 
 
 /*Run Get_accumulate with flush */
-void run_get_acc_with_flush(int rank, enum WINDOW type)
+static void run_get_acc_with_flush(int rank, enum WINDOW type)
 {
     int size, i;
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : size + 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_get_acc_lat(rank, rbuf, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -150,13 +151,13 @@ void run_get_acc_with_flush(int rank, enum WINDOW type)
             MPI_CHECK(MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 1, 0, win));
             for (i = 0; i <  options.skip +  options.iterations; i++) {
                 if (i ==  options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Get_accumulate(sbuf, size, MPI_CHAR, cbuf, size, MPI_CHAR, 1, disp, size,
                     MPI_CHAR, MPI_SUM, win));
                 MPI_CHECK(MPI_Win_flush(1, win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
             MPI_CHECK(MPI_Win_unlock(1, win));
         }                
 
@@ -169,13 +170,13 @@ void run_get_acc_with_flush(int rank, enum WINDOW type)
 }
 
 /*Run Get_accumulate with flush local*/
-void run_get_acc_with_flush_local(int rank, enum WINDOW type)
+static void run_get_acc_with_flush_local(int rank, enum WINDOW type)
 {
     int size, i;
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : size + 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_get_acc_lat(rank, rbuf, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -191,13 +192,13 @@ void run_get_acc_with_flush_local(int rank, enum WINDOW type)
             MPI_CHECK(MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 1, 0, win));
             for (i = 0; i <  options.skip +  options.iterations; i++) {
                 if (i ==  options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Get_accumulate(sbuf, size, MPI_CHAR, cbuf, size, MPI_CHAR, 1, disp, size,
                     MPI_CHAR, MPI_SUM, win));
                 MPI_CHECK(MPI_Win_flush_local(1, win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
             MPI_CHECK(MPI_Win_unlock(1, win));
         }                
 
@@ -210,13 +211,13 @@ void run_get_acc_with_flush_local(int rank, enum WINDOW type)
 }
 
 /*Run Get_accumulate with Lock_all/unlock_all */
-void run_get_acc_with_lock_all(int rank, enum WINDOW type)
+static void run_get_acc_with_lock_all(int rank, enum WINDOW type)
 {
     int size, i;
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : size + 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_get_acc_lat(rank, rbuf, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -231,14 +232,14 @@ void run_get_acc_with_lock_all(int rank, enum WINDOW type)
         if(rank == 0) {
             for (i = 0; i <  options.skip +  options.iterations; i++) {
                 if (i ==  options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Win_lock_all(0, win));
                 MPI_CHECK(MPI_Get_accumulate(sbuf, size, MPI_CHAR, cbuf, size, MPI_CHAR, 1, disp, size,
                     MPI_CHAR, MPI_SUM, win));
                 MPI_CHECK(MPI_Win_unlock_all(win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
         }                
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
@@ -250,13 +251,13 @@ void run_get_acc_with_lock_all(int rank, enum WINDOW type)
 }
 
 /*Run Get_accumulate with Lock/unlock */
-void run_get_acc_with_lock(int rank, enum WINDOW type)
+static void run_get_acc_with_lock(int rank, enum WINDOW type)
 {
     int size, i;
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : size + 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_get_acc_lat(rank, rbuf, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -271,14 +272,14 @@ void run_get_acc_with_lock(int rank, enum WINDOW type)
         if(rank == 0) {
             for (i = 0; i <  options.skip +  options.iterations; i++) {
                 if (i ==  options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 1, 0, win));
                 MPI_CHECK(MPI_Get_accumulate(sbuf, size, MPI_CHAR, cbuf, size, MPI_CHAR, 1, disp, size,
                     MPI_CHAR, MPI_SUM, win));
                 MPI_CHECK(MPI_Win_unlock(1, win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
         }                
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
@@ -290,13 +291,13 @@ void run_get_acc_with_lock(int rank, enum WINDOW type)
 }
 
 /*Run Get_accumulate with Fence */
-void run_get_acc_with_fence(int rank, enum WINDOW type)
+static void run_get_acc_with_fence(int rank, enum WINDOW type)
 {
     int size, i;
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : size + 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_get_acc_lat(rank, rbuf, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -313,7 +314,7 @@ void run_get_acc_with_fence(int rank, enum WINDOW type)
         if(rank == 0) {
             for (i = 0; i <  options.skip +  options.iterations; i++) {
                 if (i ==  options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Win_fence(0, win));
                 MPI_CHECK(MPI_Get_accumulate(sbuf, size, MPI_CHAR, cbuf, size, MPI_CHAR, 1, disp, size,
@@ -321,7 +322,7 @@ void run_get_acc_with_fence(int rank, enum WINDOW type)
                 MPI_CHECK(MPI_Win_fence(0, win));
                 MPI_CHECK(MPI_Win_fence(0, win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
         } else {
             for (i = 0; i <  options.skip +  options.iterations; i++) {
                 MPI_CHECK(MPI_Win_fence(0, win));
@@ -335,8 +336,7 @@ void run_get_acc_with_fence(int rank, enum WINDOW type)
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
         if (rank == 0) {
-            fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                    FLOAT_PRECISION, (t_end - t_start) * 1.0e6 /  options.iterations / 2);
+            print_result(size, (t_end - t_start) * 1.0e6 / options.iterations / 2);
             fflush(stdout);
         }
 
@@ -345,7 +345,7 @@ void run_get_acc_with_fence(int rank, enum WINDOW type)
 }
 
 /*Run GET with Post/Start/Complete/Wait */
-void run_get_acc_with_pscw(int rank, enum WINDOW type)
+static void run_get_acc_with_pscw(int rank, enum WINDOW type)
 {
     int destrank, size, i;
     MPI_Aint disp = 0;
@@ -354,7 +354,7 @@ void run_get_acc_with_pscw(int rank, enum WINDOW type)
     MPI_Group       comm_group, group;
     MPI_CHECK(MPI_Comm_group(MPI_COMM_WORLD, &comm_group));
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_get_acc_lat(rank, rbuf, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -377,7 +377,7 @@ void run_get_acc_with_pscw(int rank, enum WINDOW type)
             for (i = 0; i <  options.skip +  options.iterations; i++) {
                 MPI_CHECK(MPI_Win_start (group, 0, win));
                 if (i ==  options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Get_accumulate(sbuf, size, MPI_CHAR, cbuf, size, MPI_CHAR, 1, disp, size,
                     MPI_CHAR, MPI_SUM, win));
@@ -386,7 +386,7 @@ void run_get_acc_with_pscw(int rank, enum WINDOW type)
                 MPI_CHECK(MPI_Win_wait(win));
             }
 
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
         } else {
             /* rank=1 */
             destrank = 0;
@@ -407,8 +407,7 @@ void run_get_acc_with_pscw(int rank, enum WINDOW type)
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
         if (rank == 0) {
-            fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                    FLOAT_PRECISION, (t_end - t_start) * 1.0e6 /  options.iterations / 2);
+            print_result(size, (t_end - t_start) * 1.0e6 / options.iterations / 2);
             fflush(stdout);
         }
 
@@ -420,7 +419,7 @@ void run_get_acc_with_pscw(int rank, enum WINDOW type)
     MPI_CHECK(MPI_Group_free(&comm_group));
 }
 
-void allocate_memory_get_acc_lat(int rank, char *rbuf, int size, enum WINDOW type, MPI_Win *win)
+static void allocate_memory_get_acc_lat(int rank, char *rbuf, int size, enum WINDOW type, MPI_Win *win)
 {
     MPI_Status  reqstat;
 
@@ -447,9 +446,9 @@ void allocate_memory_get_acc_lat(int rank, char *rbuf, int size, enum WINDOW typ
     }
 }
 
-void print_header_get_acc_lat (int rank, enum WINDOW win, enum SYNC sync)
+static void print_header_get_acc_lat (int rank, enum WINDOW win, enum SYNC sync)
 {
-    if(rank == 0) {
+    if(rank == 0 && OUTPUT_TABLE == options.output_format) {
         fprintf(stdout, HEADER);
         fprintf(stdout, "# Window creation: %s\n",
                 win_info[win]);
@@ -460,11 +459,10 @@ void print_header_get_acc_lat (int rank, enum WINDOW win, enum SYNC sync)
     }
 }
 
-void print_latency_get_acc_lat(int rank, int size)
+static void print_latency_get_acc_lat(int rank, int size)
 {
     if (rank == 0) {
-        fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                FLOAT_PRECISION, (t_end - t_start) * 1.0e6 /  options.iterations);
+        print_result(size, (t_end - t_start) * 1.0e6 / options.iterations);
         fflush(stdout);
     }
 }
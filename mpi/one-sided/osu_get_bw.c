@@ -11,18 +11,18 @@
 
 #include <osu_util_mpi.h>
 
-double  t_start = 0.0, t_end = 0.0;
-char    *rbuf=NULL, *win_base = NULL;
+static double  t_start = 0.0, t_end = 0.0;
+static char    *rbuf=NULL, *win_base = NULL;
 
-void print_bw (int, int, double);
-void run_get_with_lock (int, enum WINDOW);
-void run_get_with_fence (int, enum WINDOW);
+static void print_bw (int, int, double);
+static void run_get_with_lock (int, enum WINDOW);
+static void run_get_with_fence (int, enum WINDOW);
 #if MPI_VERSION >= 3
-void run_get_with_lock_all (int, enum WINDOW);
-void run_get_with_flush (int, enum WINDOW);
-void run_get_with_flush_local (int, enum WINDOW);
+static void run_get_with_lock_all (int, enum WINDOW);
+static void run_get_with_flush (int, enum WINDOW);
+static void run_get_with_flush_local (int, enum WINDOW);
 #endif
-void run_get_with_pscw (int, enum WINDOW);
+static void run_get_with_pscw (int, enum WINDOW);
 
 int main (int argc, char *argv[])
 {
@@ -54,6 +54,7 @@ int main (int argc, char *argv[])
 
     MPI_CHECK(MPI_Init(&argc, &argv));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
 
     if (0 == rank) {
@@ -139,20 +140,19 @@ int main (int argc, char *argv[])
     return EXIT_SUCCESS;
 }
 
-void print_bw(int rank, int size, double t)
+static void print_bw(int rank, int size, double t)
 {
     if (rank == 0) {
         double tmp = size / 1e6 * options.iterations * options.window_size;
 
-        fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                FLOAT_PRECISION, tmp / t);
+        print_result(size, tmp / t);
         fflush(stdout);
     }
 }
 
 #if MPI_VERSION >= 3
 /*Run GET with flush local */
-void run_get_with_flush_local (int rank, enum WINDOW type)
+static void run_get_with_flush_local (int rank, enum WINDOW type)
 {
     double t = 0.0;
     int size, i, j;
@@ -160,7 +160,7 @@ void run_get_with_flush_local (int rank, enum WINDOW type)
     MPI_Win     win;
 
     int window_size = options.window_size;
-    for (size = options.min_message_size; size <= options.max_message_size; size = size * 2) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &rbuf, &win_base, size*window_size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -175,7 +175,7 @@ void run_get_with_flush_local (int rank, enum WINDOW type)
             MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 for(j = 0; j < window_size; j++) {
                     MPI_CHECK(MPI_Get(rbuf+(j*size), size, MPI_CHAR, 1, disp + (j * size), size, MPI_CHAR,
@@ -183,7 +183,7 @@ void run_get_with_flush_local (int rank, enum WINDOW type)
                 }
                 MPI_CHECK(MPI_Win_flush_local(1, win));
             }
-            t_end = MPI_Wtime();
+            t_end = osu_wtime();
             MPI_CHECK(MPI_Win_unlock(1, win ));
             t = t_end - t_start;
         }
@@ -197,7 +197,7 @@ void run_get_with_flush_local (int rank, enum WINDOW type)
 }
 
 /*Run GET with flush */
-void run_get_with_flush (int rank, enum WINDOW type)
+static void run_get_with_flush (int rank, enum WINDOW type)
 {
     double t= 0.0;
     int size, i, j;
@@ -205,7 +205,7 @@ void run_get_with_flush (int rank, enum WINDOW type)
     MPI_Win     win;
 
     int window_size = options.window_size;
-    for (size = options.min_message_size; size <= options.max_message_size; size = size * 2) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &rbuf, &win_base, size*window_size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -221,7 +221,7 @@ void run_get_with_flush (int rank, enum WINDOW type)
             MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 for(j = 0; j < window_size; j++) {
                     MPI_CHECK(MPI_Get(rbuf+(j*size), size, MPI_CHAR, 1, disp + (j * size), size, MPI_CHAR,
@@ -229,7 +229,7 @@ void run_get_with_flush (int rank, enum WINDOW type)
                 }
                 MPI_CHECK(MPI_Win_flush(1, win));
             }
-            t_end = MPI_Wtime();
+            t_end = osu_wtime();
             MPI_CHECK(MPI_Win_unlock(1, win));
             t = t_end - t_start;
         }
@@ -243,7 +243,7 @@ void run_get_with_flush (int rank, enum WINDOW type)
 }
 
 /*Run GET with Lock_all/unlock_all */
-void run_get_with_lock_all (int rank, enum WINDOW type)
+static void run_get_with_lock_all (int rank, enum WINDOW type)
 {
     double t = 0.0;
     int size, i, j;
@@ -251,7 +251,7 @@ void run_get_with_lock_all (int rank, enum WINDOW type)
     MPI_Win     win;
 
     int window_size = options.window_size;
-    for (size = options.min_message_size; size <= options.max_message_size; size = size * 2) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &rbuf, &win_base, size*window_size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -265,7 +265,7 @@ void run_get_with_lock_all (int rank, enum WINDOW type)
         if (rank == 0) {
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Win_lock_all(0, win));
                 for(j = 0; j < window_size; j++) {
@@ -274,7 +274,7 @@ void run_get_with_lock_all (int rank, enum WINDOW type)
                 }
                 MPI_CHECK(MPI_Win_unlock_all(win));
             }
-            t_end = MPI_Wtime();
+            t_end = osu_wtime();
             t = t_end - t_start;
         }
 
@@ -288,7 +288,7 @@ void run_get_with_lock_all (int rank, enum WINDOW type)
 #endif
 
 /*Run GET with Lock/unlock */
-void run_get_with_lock(int rank, enum WINDOW type)
+static void run_get_with_lock(int rank, enum WINDOW type)
 {
     double t = 0.0;
     int size, i, j;
@@ -296,7 +296,7 @@ void run_get_with_lock(int rank, enum WINDOW type)
     MPI_Win     win;
 
     int window_size = options.window_size;
-    for (size = options.min_message_size; size <= options.max_message_size; size = size * 2) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &rbuf, &win_base, size*window_size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -312,7 +312,7 @@ void run_get_with_lock(int rank, enum WINDOW type)
         if (rank == 0) {
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
                 for(j = 0; j < window_size; j++) {
@@ -321,7 +321,7 @@ void run_get_with_lock(int rank, enum WINDOW type)
                 }
                 MPI_CHECK(MPI_Win_unlock(1, win ));
             }
-            t_end = MPI_Wtime();
+            t_end = osu_wtime();
             t = t_end - t_start;
         }
 
@@ -334,7 +334,7 @@ void run_get_with_lock(int rank, enum WINDOW type)
 }
 
 /*Run GET with Fence */
-void run_get_with_fence(int rank, enum WINDOW type)
+static void run_get_with_fence(int rank, enum WINDOW type)
 {
     double t = 0.0; 
     int size, i, j;
@@ -342,7 +342,7 @@ void run_get_with_fence(int rank, enum WINDOW type)
     MPI_Win     win;
 
     int window_size = options.window_size;
-    for (size = options.min_message_size; size <= options.max_message_size; size = size * 2) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &rbuf, &win_base, size*window_size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -361,7 +361,7 @@ void run_get_with_fence(int rank, enum WINDOW type)
         if(rank == 0) {
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Win_fence(0, win));
                 for(j = 0; j < window_size; j++) {
@@ -370,7 +370,7 @@ void run_get_with_fence(int rank, enum WINDOW type)
                 }
                 MPI_CHECK(MPI_Win_fence(0, win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
             t = t_end - t_start;
         } else {
             for (i = 0; i < options.skip + options.iterations; i++) {
@@ -388,7 +388,7 @@ void run_get_with_fence(int rank, enum WINDOW type)
 }
 
 /*Run GET with Post/Start/Complete/Wait */
-void run_get_with_pscw(int rank, enum WINDOW type)
+static void run_get_with_pscw(int rank, enum WINDOW type)
 {
     double t = 0.0; 
     int destrank, size, i, j;
@@ -398,7 +398,7 @@ void run_get_with_pscw(int rank, enum WINDOW type)
     MPI_CHECK(MPI_Comm_group(MPI_COMM_WORLD, &comm_group));
 
     int window_size = options.window_size;
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &rbuf, &win_base, size*window_size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -421,7 +421,7 @@ void run_get_with_pscw(int rank, enum WINDOW type)
             for (i = 0; i < options.skip + options.iterations; i++) {
                 MPI_CHECK(MPI_Win_start(group, 0, win));
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 for(j = 0; j < window_size; j++) {
                     MPI_CHECK(MPI_Get(rbuf + j*size, size, MPI_CHAR, 1, disp + (j*size), size, MPI_CHAR,
@@ -429,7 +429,7 @@ void run_get_with_pscw(int rank, enum WINDOW type)
                 }
                 MPI_CHECK(MPI_Win_complete(win));
             }
-            t_end = MPI_Wtime();
+            t_end = osu_wtime();
             t = t_end - t_start;
         } else {
 
@@ -11,18 +11,18 @@
 
 #include <osu_util_mpi.h>
 
-double  t_start = 0.0, t_end = 0.0;
-char    *rbuf=NULL, *win_base = NULL;
+static double  t_start = 0.0, t_end = 0.0;
+static char    *rbuf=NULL, *win_base = NULL;
 
-void print_latency (int, int);
-void run_get_with_lock (int, enum WINDOW);
-void run_get_with_fence (int, enum WINDOW);
+static void print_latency (int, int);
+static void run_get_with_lock (int, enum WINDOW);
+static void run_get_with_fence (int, enum WINDOW);
 #if MPI_VERSION >= 3
-void run_get_with_lock_all (int, enum WINDOW);
-void run_get_with_flush (int, enum WINDOW);
-void run_get_with_flush_local (int, enum WINDOW);
+static void run_get_with_lock_all (int, enum WINDOW);
+static void run_get_with_flush (int, enum WINDOW);
+static void run_get_with_flush_local (int, enum WINDOW);
 #endif
-void run_get_with_pscw (int, enum WINDOW);
+static void run_get_with_pscw (int, enum WINDOW);
 
 int main (int argc, char *argv[])
 {
@@ -54,6 +54,7 @@ int main (int argc, char *argv[])
 
     MPI_CHECK(MPI_Init(&argc, &argv));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
 
     if (0 == rank) {
@@ -141,24 +142,23 @@ int main (int argc, char *argv[])
     return EXIT_SUCCESS;
 }
 
-void print_latency(int rank, int size)
+static void print_latency(int rank, int size)
 {
     if (rank == 0) {
-        fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.iterations);
+        print_result(size, (t_end - t_start) * 1.0e6 / options.iterations);
         fflush(stdout);
     }
 }
 
 #if MPI_VERSION >= 3
 /*Run Get with flush */
-void run_get_with_flush(int rank, enum WINDOW type)
+static void run_get_with_flush(int rank, enum WINDOW type)
 {
     int size, i;
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : size + 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &rbuf, &win_base, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -173,12 +173,12 @@ void run_get_with_flush(int rank, enum WINDOW type)
             MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Get(rbuf, size, MPI_CHAR, 1, disp, size, MPI_CHAR, win));
                 MPI_CHECK(MPI_Win_flush(1, win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
             MPI_CHECK(MPI_Win_unlock(1, win));
         }                
 
@@ -191,13 +191,13 @@ void run_get_with_flush(int rank, enum WINDOW type)
 }
 
 /*Run Get with flush local */
-void run_get_with_flush_local(int rank, enum WINDOW type)
+static void run_get_with_flush_local(int rank, enum WINDOW type)
 {
     int size, i;
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : size + 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &rbuf, &win_base, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -213,12 +213,12 @@ void run_get_with_flush_local(int rank, enum WINDOW type)
             MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Get(rbuf, size, MPI_CHAR, 1, disp, size, MPI_CHAR, win));
                 MPI_CHECK(MPI_Win_flush_local(1, win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
             MPI_CHECK(MPI_Win_unlock(1, win));
         }                
 
@@ -231,13 +231,13 @@ void run_get_with_flush_local(int rank, enum WINDOW type)
 }
 
 /*Run Get with Lock_all/unlock_all */
-void run_get_with_lock_all(int rank, enum WINDOW type)
+static void run_get_with_lock_all(int rank, enum WINDOW type)
 {
     int size, i;
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : size + 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &rbuf, &win_base, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -252,13 +252,13 @@ void run_get_with_lock_all(int rank, enum WINDOW type)
         if(rank == 0) {
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Win_lock_all(0, win));
                 MPI_CHECK(MPI_Get(rbuf, size, MPI_CHAR, 1, disp, size, MPI_CHAR, win));
                 MPI_CHECK(MPI_Win_unlock_all(win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
         }                
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
@@ -271,13 +271,13 @@ void run_get_with_lock_all(int rank, enum WINDOW type)
 #endif
 
 /*Run Get with Lock/unlock */
-void run_get_with_lock(int rank, enum WINDOW type)
+static void run_get_with_lock(int rank, enum WINDOW type)
 {
     int size, i;
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : size + 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &rbuf, &win_base, size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -294,13 +294,13 @@ void run_get_with_lock(int rank, enum WINDOW type)
         if(rank == 0) {
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
                 MPI_CHECK(MPI_Get(rbuf, size, MPI_CHAR, 1, disp, size, MPI_CHAR, win));
                 MPI_CHECK(MPI_Win_unlock(1, win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
         }                
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
@@ -312,13 +312,13 @@ void run_get_with_lock(int rank, enum WINDOW type)
 }
 
 /*Run Get with Fence */
-void run_get_with_fence(int rank, enum WINDOW type)
+static void run_get_with_fence(int rank, enum WINDOW type)
 {
     int size, i;
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : size + 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &rbuf, &win_base, size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -337,14 +337,14 @@ void run_get_with_fence(int rank, enum WINDOW type)
         if(rank == 0) {
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Win_fence(0, win));
                 MPI_CHECK(MPI_Get(rbuf, size, MPI_CHAR, 1, disp, size, MPI_CHAR, win));
                 MPI_CHECK(MPI_Win_fence(0, win));
                 MPI_CHECK(MPI_Win_fence(0, win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
         } else {
             for (i = 0; i < options.skip + options.iterations; i++) {
                 MPI_CHECK(MPI_Win_fence(0, win));
@@ -357,8 +357,7 @@ void run_get_with_fence(int rank, enum WINDOW type)
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
          if (rank == 0) {
-            fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                    FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.iterations / 2);
+            print_result(size, (t_end - t_start) * 1.0e6 / options.iterations / 2);
             fflush(stdout);
         }
 
@@ -367,7 +366,7 @@ void run_get_with_fence(int rank, enum WINDOW type)
 }
 
 /*Run GET with Post/Start/Complete/Wait */
-void run_get_with_pscw(int rank, enum WINDOW type)
+static void run_get_with_pscw(int rank, enum WINDOW type)
 {
     int destrank, size, i;
     MPI_Aint disp = 0;
@@ -376,7 +375,7 @@ void run_get_with_pscw(int rank, enum WINDOW type)
     MPI_Group       comm_group, group;
     MPI_CHECK(MPI_Comm_group(MPI_COMM_WORLD, &comm_group));
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &rbuf, &win_base, size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -402,7 +401,7 @@ void run_get_with_pscw(int rank, enum WINDOW type)
                 MPI_CHECK(MPI_Win_start (group, 0, win));
 
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
 
                 MPI_CHECK(MPI_Get(rbuf, size, MPI_CHAR, 1, disp, size, MPI_CHAR, win));
@@ -411,7 +410,7 @@ void run_get_with_pscw(int rank, enum WINDOW type)
                 MPI_CHECK(MPI_Win_wait(win));
             }
 
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
         } else {
             /* rank=1 */
             destrank = 0;
@@ -431,8 +430,7 @@ void run_get_with_pscw(int rank, enum WINDOW type)
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
         if (rank == 0) {
-            fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                    FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.iterations / 2);
+            print_result(size, (t_end - t_start) * 1.0e6 / options.iterations / 2);
             fflush(stdout);
         }
 
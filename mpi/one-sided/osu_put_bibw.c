@@ -11,12 +11,12 @@
 
 #include <osu_util_mpi.h>
 
-double  t_start = 0.0, t_end = 0.0;
-char    *sbuf=NULL, *win_base=NULL;
+static double  t_start = 0.0, t_end = 0.0;
+static char    *sbuf=NULL, *win_base=NULL;
 
-void print_bibw (int, int, double);
-void run_put_with_fence (int, enum WINDOW);
-void run_put_with_pscw (int, enum WINDOW);
+static void print_bibw (int, int, double);
+static void run_put_with_fence (int, enum WINDOW);
+static void run_put_with_pscw (int, enum WINDOW);
 
 int main (int argc, char *argv[])
 {
@@ -49,6 +49,7 @@ int main (int argc, char *argv[])
 
     MPI_CHECK(MPI_Init(&argc, &argv));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
 
     if (0 == rank) {
@@ -129,19 +130,18 @@ int main (int argc, char *argv[])
     return EXIT_SUCCESS;
 }
 
-void print_bibw(int rank, int size, double t)
+static void print_bibw(int rank, int size, double t)
 {
     if (rank == 0) {
         double tmp = size / 1e6 * options.iterations * options.window_size;
 
-        fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                FLOAT_PRECISION, (tmp / t) * 2);
+        print_result(size, (tmp / t) * 2);
         fflush(stdout);
     }
 }
 
 /*Run PUT with Fence */
-void run_put_with_fence(int rank, enum WINDOW type)
+static void run_put_with_fence(int rank, enum WINDOW type)
 {
     double t = 0.0; 
     int size, i, j;
@@ -149,7 +149,7 @@ void run_put_with_fence(int rank, enum WINDOW type)
     MPI_Win     win;
 
     int window_size = options.window_size;
-    for (size = options.min_message_size; size <= options.max_message_size; size = size * 2) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &sbuf, &win_base, size*window_size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -168,7 +168,7 @@ void run_put_with_fence(int rank, enum WINDOW type)
         if(rank == 0) {
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Win_fence(0, win));
                 for(j = 0; j < window_size; j++) {
@@ -177,7 +177,7 @@ void run_put_with_fence(int rank, enum WINDOW type)
                 }
                 MPI_CHECK(MPI_Win_fence(0, win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
             t = t_end - t_start;
         } else {
             for (i = 0; i < options.skip + options.iterations; i++) {
@@ -199,7 +199,7 @@ void run_put_with_fence(int rank, enum WINDOW type)
 }
 
 /*Run PUT with Post/Start/Complete/Wait */
-void run_put_with_pscw(int rank, enum WINDOW type)
+static void run_put_with_pscw(int rank, enum WINDOW type)
 {
     double t = 0.0; 
     int destrank, size, i, j;
@@ -210,7 +210,7 @@ void run_put_with_pscw(int rank, enum WINDOW type)
     MPI_CHECK(MPI_Comm_group(MPI_COMM_WORLD, &comm_group));
 
     int window_size = options.window_size;
-    for (size = options.min_message_size; size <= options.max_message_size; size = size * 2) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &sbuf, &win_base, size*window_size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -233,7 +233,7 @@ void run_put_with_pscw(int rank, enum WINDOW type)
             for (i = 0; i < options.skip + options.iterations; i++) {
 
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
 
                 MPI_CHECK(MPI_Win_post(group, 0, win));
@@ -247,7 +247,7 @@ void run_put_with_pscw(int rank, enum WINDOW type)
                 MPI_CHECK(MPI_Win_complete(win));
                 MPI_CHECK(MPI_Win_wait(win));
             }
-            t_end = MPI_Wtime();
+            t_end = osu_wtime();
             t = t_end - t_start;
         } else {
             destrank = 0;
@@ -11,17 +11,17 @@
 
 #include <osu_util_mpi.h>
 
-double  t_start = 0.0, t_end = 0.0;
-char    *sbuf=NULL, *win_base = NULL;
+static double  t_start = 0.0, t_end = 0.0;
+static char    *sbuf=NULL, *win_base = NULL;
 
-void print_bw (int, int, double);
-void run_put_with_lock (int, enum WINDOW);
-void run_put_with_fence (int, enum WINDOW);
-void run_put_with_pscw (int, enum WINDOW);
+static void print_bw (int, int, double);
+static void run_put_with_lock (int, enum WINDOW);
+static void run_put_with_fence (int, enum WINDOW);
+static void run_put_with_pscw (int, enum WINDOW);
 #if MPI_VERSION >= 3
-void run_put_with_lock_all (int, enum WINDOW);
-void run_put_with_flush (int, enum WINDOW);
-void run_put_with_flush_local (int, enum WINDOW);
+static void run_put_with_lock_all (int, enum WINDOW);
+static void run_put_with_flush (int, enum WINDOW);
+static void run_put_with_flush_local (int, enum WINDOW);
 #endif
 
 int main (int argc, char *argv[])
@@ -40,6 +40,7 @@ int main (int argc, char *argv[])
     options.bench = ONE_SIDED;
     options.subtype = BW;
     options.synctype = ALL_SYNC;
+    options.stream = STREAM_OFF;
 
     set_header(HEADER);
     set_benchmark_name("osu_put_bw");
@@ -55,6 +56,7 @@ int main (int argc, char *argv[])
 
     MPI_CHECK(MPI_Init(&argc, &argv));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
 
     if (0 == rank) {
@@ -105,6 +107,11 @@ int main (int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
+    if (setup_stream(rank)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
     print_header_one_sided(rank, options.win, options.sync);
 
     switch (options.sync){
@@ -130,6 +137,7 @@ int main (int argc, char *argv[])
 #endif
     }
 
+    cleanup_stream();
     MPI_CHECK(MPI_Finalize());
 
     if (NONE != options.accel) {
@@ -142,20 +150,21 @@ int main (int argc, char *argv[])
     return EXIT_SUCCESS;
 }
 
-void print_bw(int rank, int size, double t)
+static void print_bw(int rank, int size, double t)
 {
-    if (rank == 0) {
+    if (STREAM_ON == options.stream) {
+        report_stream(rank, size);
+    } else if (rank == 0) {
         double tmp = size / 1e6 * options.iterations * options.window_size;
 
-        fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                FLOAT_PRECISION, tmp / t);
+        print_result(size, tmp / t);
         fflush(stdout);
     }
 }
 
 #if MPI_VERSION >= 3
 /*Run PUT with flush local */
-void run_put_with_flush_local (int rank, enum WINDOW type)
+static void run_put_with_flush_local (int rank, enum WINDOW type)
 {
     double t = 0.0;
     int size, i, j;
@@ -163,7 +172,7 @@ void run_put_with_flush_local (int rank, enum WINDOW type)
     MPI_Win     win;
 
     int window_size = options.window_size;
-    for (size = options.min_message_size; size <= options.max_message_size; size = size * 2) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &sbuf, &win_base, size*window_size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -176,9 +185,9 @@ void run_put_with_flush_local (int rank, enum WINDOW type)
         }
         if (rank == 0) {
             MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
-            for (i = 0; i < options.skip + options.iterations; i++) {
+            for (i = 0; stream_step(i, (double)size * window_size, MPI_COMM_SELF); i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 for(j = 0; j < window_size; j++) {
                     MPI_CHECK(MPI_Put(sbuf+(j*size), size, MPI_CHAR, 1, disp + (j * size), size, MPI_CHAR,
@@ -186,7 +195,7 @@ void run_put_with_flush_local (int rank, enum WINDOW type)
                 }
                 MPI_CHECK(MPI_Win_flush_local(1, win));
             }
-            t_end = MPI_Wtime();
+            t_end = osu_wtime();
             MPI_CHECK(MPI_Win_unlock(1, win));
             t = t_end - t_start;
         }
@@ -200,7 +209,7 @@ void run_put_with_flush_local (int rank, enum WINDOW type)
 }
 
 /*Run PUT with flush */
-void run_put_with_flush (int rank, enum WINDOW type)
+static void run_put_with_flush (int rank, enum WINDOW type)
 {
     double t = 0.0;
     int size, i, j;
@@ -208,7 +217,7 @@ void run_put_with_flush (int rank, enum WINDOW type)
     MPI_Win     win;
 
     int window_size = options.window_size;
-    for (size = options.min_message_size; size <= options.max_message_size; size = size * 2) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &sbuf, &win_base, size*window_size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -222,9 +231,9 @@ void run_put_with_flush (int rank, enum WINDOW type)
 
         if (rank == 0) {
             MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
-            for (i = 0; i < options.skip + options.iterations; i++) {
+            for (i = 0; stream_step(i, (double)size * window_size, MPI_COMM_SELF); i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 for(j = 0; j < window_size; j++) {
                     MPI_CHECK(MPI_Put(sbuf+(j*size), size, MPI_CHAR, 1, disp + (j * size), size, MPI_CHAR,
@@ -232,7 +241,7 @@ void run_put_with_flush (int rank, enum WINDOW type)
                 }
                 MPI_CHECK(MPI_Win_flush(1, win));
             }
-            t_end = MPI_Wtime();
+            t_end = osu_wtime();
             MPI_CHECK(MPI_Win_unlock(1, win));
             t = t_end - t_start;
         }
@@ -246,7 +255,7 @@ void run_put_with_flush (int rank, enum WINDOW type)
 }
 
 /*Run PUT with Lock_all/unlock_all */
-void run_put_with_lock_all (int rank, enum WINDOW type)
+static void run_put_with_lock_all (int rank, enum WINDOW type)
 {
     double t = 0.0;
     int size, i, j;
@@ -254,7 +263,7 @@ void run_put_with_lock_all (int rank, enum WINDOW type)
     MPI_Win     win;
 
     int window_size = options.window_size;
-    for (size = options.min_message_size; size <= options.max_message_size; size = size * 2) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &sbuf, &win_base, size*window_size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -267,9 +276,9 @@ void run_put_with_lock_all (int rank, enum WINDOW type)
         }
 
         if (rank == 0) {
-            for (i = 0; i < options.skip + options.iterations; i++) {
+            for (i = 0; stream_step(i, (double)size * window_size, MPI_COMM_SELF); i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Win_lock_all(0, win));
                 for(j = 0; j < window_size; j++) {
@@ -278,7 +287,7 @@ void run_put_with_lock_all (int rank, enum WINDOW type)
                 }
                 MPI_CHECK(MPI_Win_unlock_all(win));
             }
-            t_end = MPI_Wtime();
+            t_end = osu_wtime();
             t = t_end - t_start;
         }
 
@@ -292,7 +301,7 @@ void run_put_with_lock_all (int rank, enum WINDOW type)
 #endif
 
 /*Run PUT with Lock/unlock */
-void run_put_with_lock(int rank, enum WINDOW type)
+static void run_put_with_lock(int rank, enum WINDOW type)
 {
     double t = 0.0;
 
@@ -301,7 +310,7 @@ void run_put_with_lock(int rank, enum WINDOW type)
     MPI_Win     win;
 
     int window_size = options.window_size;
-    for (size = options.min_message_size; size <= options.max_message_size; size = size * 2) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &sbuf, &win_base, size*window_size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -315,9 +324,9 @@ void run_put_with_lock(int rank, enum WINDOW type)
             options.skip = options.skip_large;
         }
         if (rank == 0) {
-            for (i = 0; i < options.skip + options.iterations; i++) {
+            for (i = 0; stream_step(i, (double)size * window_size, MPI_COMM_SELF); i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
                 for(j = 0; j < window_size; j++) {
@@ -326,7 +335,7 @@ void run_put_with_lock(int rank, enum WINDOW type)
                 }
                 MPI_CHECK(MPI_Win_unlock(1, win ));
             }
-            t_end = MPI_Wtime();
+            t_end = osu_wtime();
             t = t_end - t_start;
         }
 
@@ -339,7 +348,7 @@ void run_put_with_lock(int rank, enum WINDOW type)
 }
 
 /*Run PUT with Fence */
-void run_put_with_fence(int rank, enum WINDOW type)
+static void run_put_with_fence(int rank, enum WINDOW type)
 {
     double t = 0.0;
 
@@ -348,7 +357,7 @@ void run_put_with_fence(int rank, enum WINDOW type)
     MPI_Win     win;
 
     int window_size = options.window_size;
-    for (size = options.min_message_size; size <= options.max_message_size; size = size * 2) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &sbuf, &win_base, size*window_size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -365,9 +374,9 @@ void run_put_with_fence(int rank, enum WINDOW type)
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
         if(rank == 0) {
-            for (i = 0; i < options.skip + options.iterations; i++) {
+            for (i = 0; stream_step(i, (double)size * window_size, MPI_COMM_WORLD); i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Win_fence(0, win));
                 for(j = 0; j < window_size; j++) {
@@ -376,10 +385,10 @@ void run_put_with_fence(int rank, enum WINDOW type)
                 }
                 MPI_CHECK(MPI_Win_fence(0, win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
             t = t_end - t_start;
         } else {
-            for (i = 0; i < options.skip + options.iterations; i++) {
+            for (i = 0; stream_step(i, (double)size * window_size, MPI_COMM_WORLD); i++) {
                 MPI_CHECK(MPI_Win_fence(0, win));
                 MPI_CHECK(MPI_Win_fence(0, win));
             }
@@ -394,7 +403,7 @@ void run_put_with_fence(int rank, enum WINDOW type)
 }
 
 /*Run PUT with Post/Start/Complete/Wait */
-void run_put_with_pscw(int rank, enum WINDOW type)
+static void run_put_with_pscw(int rank, enum WINDOW type)
 {
     double t = 0.0;
 
@@ -406,7 +415,7 @@ void run_put_with_pscw(int rank, enum WINDOW type)
     MPI_CHECK(MPI_Comm_group(MPI_COMM_WORLD, &comm_group));
 
     int window_size = options.window_size;
-    for (size = options.min_message_size; size <= options.max_message_size; size = size * 2) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &sbuf, &win_base, size*window_size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -427,10 +436,10 @@ void run_put_with_pscw(int rank, enum WINDOW type)
             destrank = 1;
             MPI_CHECK(MPI_Group_incl (comm_group, 1, &destrank, &group));
 
-            for (i = 0; i < options.skip + options.iterations; i++) {
+            for (i = 0; stream_step(i, (double)size * window_size, MPI_COMM_WORLD); i++) {
                 MPI_CHECK(MPI_Win_start(group, 0, win));
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 for(j = 0; j < window_size; j++) {
                     MPI_CHECK(MPI_Put(sbuf + j*size, size, MPI_CHAR, 1, disp + (j*size), size, MPI_CHAR,
@@ -438,13 +447,13 @@ void run_put_with_pscw(int rank, enum WINDOW type)
                 }
                 MPI_CHECK(MPI_Win_complete(win));
             }
-            t_end = MPI_Wtime();
+            t_end = osu_wtime();
             t = t_end - t_start;
         } else {
 
             destrank = 0;
             MPI_CHECK(MPI_Group_incl(comm_group, 1, &destrank, &group));
-            for (i = 0; i < options.skip + options.iterations; i++) {
+            for (i = 0; stream_step(i, (double)size * window_size, MPI_COMM_WORLD); i++) {
                 MPI_CHECK(MPI_Win_post(group, 0, win));
                 MPI_CHECK(MPI_Win_wait(win));
             }
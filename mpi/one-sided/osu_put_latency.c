@@ -11,17 +11,17 @@
 
 #include <osu_util_mpi.h>
 
-double  t_start = 0.0, t_end = 0.0;
-char    *sbuf=NULL, *win_base = NULL;
+static double  t_start = 0.0, t_end = 0.0;
+static char    *sbuf=NULL, *win_base = NULL;
 
-void print_latency (int, int);
-void run_put_with_lock (int, enum WINDOW);
-void run_put_with_fence (int, enum WINDOW);
-void run_put_with_pscw (int, enum WINDOW);
+static void print_latency (int, int);
+static void run_put_with_lock (int, enum WINDOW);
+static void run_put_with_fence (int, enum WINDOW);
+static void run_put_with_pscw (int, enum WINDOW);
 #if MPI_VERSION >= 3
-void run_put_with_lock_all (int, enum WINDOW);
-void run_put_with_flush (int, enum WINDOW);
-void run_put_with_flush_local (int, enum WINDOW);
+static void run_put_with_lock_all (int, enum WINDOW);
+static void run_put_with_flush (int, enum WINDOW);
+static void run_put_with_flush_local (int, enum WINDOW);
 #endif
 
 int main (int argc, char *argv[])
@@ -55,6 +55,7 @@ int main (int argc, char *argv[])
 
     MPI_CHECK(MPI_Init(&argc, &argv));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
 
     if (0 == rank) {
@@ -142,24 +143,23 @@ int main (int argc, char *argv[])
     return EXIT_SUCCESS;
 }
 
-void print_latency(int rank, int size)
+static void print_latency(int rank, int size)
 {
     if (rank == 0) {
-        fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.iterations);
+        print_result(size, (t_end - t_start) * 1.0e6 / options.iterations);
         fflush(stdout);
     }
 }
 
 #if MPI_VERSION >= 3
 /*Run PUT with flush_local */
-void run_put_with_flush_local (int rank, enum WINDOW type)
+static void run_put_with_flush_local (int rank, enum WINDOW type)
 {
     int size, i;
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &sbuf, &win_base, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -175,12 +175,12 @@ void run_put_with_flush_local (int rank, enum WINDOW type)
             MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Put(sbuf, size, MPI_CHAR, 1, disp, size, MPI_CHAR, win));
                 MPI_CHECK(MPI_Win_flush_local(1, win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
             MPI_CHECK(MPI_Win_unlock(1, win));
         }                
 
@@ -193,13 +193,13 @@ void run_put_with_flush_local (int rank, enum WINDOW type)
 }
 
 /*Run PUT with flush */
-void run_put_with_flush (int rank, enum WINDOW type)
+static void run_put_with_flush (int rank, enum WINDOW type)
 {
     int size, i;
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &sbuf, &win_base, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -215,12 +215,12 @@ void run_put_with_flush (int rank, enum WINDOW type)
             MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Put(sbuf, size, MPI_CHAR, 1, disp, size, MPI_CHAR, win));
                 MPI_CHECK(MPI_Win_flush(1, win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
             MPI_CHECK(MPI_Win_unlock(1, win));
         }                
 
@@ -233,13 +233,13 @@ void run_put_with_flush (int rank, enum WINDOW type)
 }
 
 /*Run PUT with Lock_all/unlock_all */
-void run_put_with_lock_all (int rank, enum WINDOW type)
+static void run_put_with_lock_all (int rank, enum WINDOW type)
 {
     int size, i;
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &sbuf, &win_base, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -254,13 +254,13 @@ void run_put_with_lock_all (int rank, enum WINDOW type)
         if(rank == 0) {
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Win_lock_all(0, win));
                 MPI_CHECK(MPI_Put(sbuf, size, MPI_CHAR, 1, disp, size, MPI_CHAR, win));
                 MPI_CHECK(MPI_Win_unlock_all(win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
         }                
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
@@ -273,13 +273,13 @@ void run_put_with_lock_all (int rank, enum WINDOW type)
 #endif 
 
 /*Run PUT with Lock/unlock */
-void run_put_with_lock(int rank, enum WINDOW type)
+static void run_put_with_lock(int rank, enum WINDOW type)
 {
     int size, i;
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &sbuf, &win_base, size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -296,13 +296,13 @@ void run_put_with_lock(int rank, enum WINDOW type)
         if(rank == 0) {
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
                 MPI_CHECK(MPI_Put(sbuf, size, MPI_CHAR, 1, disp, size, MPI_CHAR, win));
                 MPI_CHECK(MPI_Win_unlock(1, win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
         }                
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
@@ -314,13 +314,13 @@ void run_put_with_lock(int rank, enum WINDOW type)
 }
 
 /*Run PUT with Fence */
-void run_put_with_fence(int rank, enum WINDOW type)
+static void run_put_with_fence(int rank, enum WINDOW type)
 {
     int size, i;
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &sbuf, &win_base, size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -339,14 +339,14 @@ void run_put_with_fence(int rank, enum WINDOW type)
         if(rank == 0) {
             for (i = 0; i < options.skip + options.iterations; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Win_fence(0, win));
                 MPI_CHECK(MPI_Put(sbuf, size, MPI_CHAR, 1, disp, size, MPI_CHAR, win));
                 MPI_CHECK(MPI_Win_fence(0, win));
                 MPI_CHECK(MPI_Win_fence(0, win));
             }
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
         } else {
             for (i = 0; i < options.skip + options.iterations; i++) {
                 MPI_CHECK(MPI_Win_fence(0, win));
@@ -359,8 +359,7 @@ void run_put_with_fence(int rank, enum WINDOW type)
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
         if (rank == 0) {
-            fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                    FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.iterations / 2);
+            print_result(size, (t_end - t_start) * 1.0e6 / options.iterations / 2);
             fflush(stdout);
         }
 
@@ -369,7 +368,7 @@ void run_put_with_fence(int rank, enum WINDOW type)
 }
 
 /*Run PUT with Post/Start/Complete/Wait */
-void run_put_with_pscw(int rank, enum WINDOW type)
+static void run_put_with_pscw(int rank, enum WINDOW type)
 {
     int destrank, size, i;
     MPI_Aint disp = 0;
@@ -378,7 +377,7 @@ void run_put_with_pscw(int rank, enum WINDOW type)
 
     MPI_CHECK(MPI_Comm_group(MPI_COMM_WORLD, &comm_group));
 
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         allocate_memory_one_sided(rank, &sbuf, &win_base, size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -401,7 +400,7 @@ void run_put_with_pscw(int rank, enum WINDOW type)
             for (i = 0; i < options.skip + options.iterations; i++) {
                 MPI_CHECK(MPI_Win_start (group, 0, win));
                 if (i == options.skip) {
-                    t_start = MPI_Wtime ();
+                    t_start = osu_wtime ();
                 }
                 MPI_CHECK(MPI_Put(sbuf, size, MPI_CHAR, 1, disp, size, MPI_CHAR, win));
                 MPI_CHECK(MPI_Win_complete(win));
@@ -409,7 +408,7 @@ void run_put_with_pscw(int rank, enum WINDOW type)
                 MPI_CHECK(MPI_Win_wait(win));
             }
 
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
         } else {
             /* rank=1 */
             destrank = 0;
@@ -429,8 +428,7 @@ void run_put_with_pscw(int rank, enum WINDOW type)
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
         if (rank == 0) {
-            fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                    FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.iterations / 2);
+            print_result(size, (t_end - t_start) * 1.0e6 / options.iterations / 2);
             fflush(stdout);
         }
 
@@ -0,0 +1,476 @@
+#define BENCHMARK "OSU MPI_Put/MPI_Get%s Multiple Bandwidth / Message Rate Test"
+/*
+ * Copyright (C) 2003-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * osu_mbw_mr for one-sided communication.  osu_put_bw and osu_get_bw always
+ * target rank 1; here -X picks which ranks are origins and which are targets,
+ * from the pairs of osu_mbw_mr to one origin scattering to all ranks (fanout)
+ * or all ranks converging on one (fanin).  Every origin issues a window of
+ * puts, then of gets, to each of its targets per iteration and the aggregate
+ * rate over all origins is reported for every synchronization mode.
+ *
+ * All origins of a target use the same region of its window and the gets of
+ * an origin from different targets land in the same local buffer, like the
+ * receives of osu_mbw_mr, so only the rate is meaningful, not the data.
+ */
+
+#include <osu_util_mpi.h>
+
+enum rma_op {
+    RMA_PUT,
+    RMA_GET
+};
+
+/* Ranks are origins of the targets [first, first + count) and vice versa */
+struct rma_range_t {
+    int first;
+    int count;
+};
+
+static char *lbuf = NULL, *wbuf = NULL;
+static MPI_Aint *disps = NULL;
+
+static void get_roles (int rank, int nprocs, struct rma_range_t *targets,
+        struct rma_range_t *origins);
+static void create_window (int rank, int nprocs, size_t bytes,
+        enum WINDOW type, MPI_Win *win);
+static void free_window (enum WINDOW type, MPI_Win *win);
+static double run_rma (int rank, enum rma_op op, enum SYNC sync, int size,
+        struct rma_range_t const *targets, struct rma_range_t const *origins,
+        MPI_Win win);
+static void issue (enum rma_op op, int size, struct rma_range_t const *targets,
+        MPI_Win win);
+static void report (int size, int win, int sync, double const *rate);
+
+int main (int argc, char *argv[])
+{
+    int rank, nprocs, size, i;
+    int po_ret = PO_OKAY;
+    int win, sync, first_win, last_win, first_sync, last_sync;
+    int num_origins = 0, num_targets = 0;
+    int iterations, skip;
+    struct rma_range_t targets, origins;
+    double t, msgs, max_t, total_msgs, rate[4];
+    enum rma_op op;
+    MPI_Win mpi_win;
+
+    options.win = WIN_ALLOCATE;
+    options.sync = FLUSH;
+    options.win_sweep = 0;
+    options.sync_sweep = 1;
+    options.rma_pattern = RMA_PAIRS;
+
+    options.bench = ONE_SIDED;
+    options.subtype = RMA_MR;
+    options.synctype = ALL_SYNC;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_rma_mbw_mr");
+
+    po_ret = process_options(argc, argv);
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+
+    if (0 == rank) {
+        switch (po_ret) {
+            case PO_BAD_USAGE:
+                print_bad_usage_message(rank);
+            case PO_HELP_MESSAGE:
+                usage_one_sided("osu_rma_mbw_mr");
+                break;
+            case PO_VERSION_MESSAGE:
+                print_version_message(rank);
+                MPI_CHECK(MPI_Finalize());
+                exit(EXIT_SUCCESS);
+            case PO_OKAY:
+                break;
+        }
+    }
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+        case PO_VERSION_MESSAGE:
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (nprocs < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < nprocs; i++) {
+        get_roles(i, nprocs, &targets, &origins);
+        num_origins += (targets.count > 0);
+        num_targets += (origins.count > 0);
+    }
+    get_roles(rank, nprocs, &targets, &origins);
+
+    disps = malloc(sizeof(MPI_Aint) * nprocs);
+    if (NULL == disps) {
+        fprintf(stderr, "Error allocating memory on Rank %d\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    iterations = options.iterations;
+    skip = options.skip;
+    first_win = options.win_sweep ? WIN_CREATE : options.win;
+    last_win = options.win_sweep ? WIN_DYNAMIC : options.win;
+    first_sync = options.sync_sweep ? LOCK : options.sync;
+    last_sync = options.sync_sweep ? LOCK_ALL : options.sync;
+
+    if (0 == rank && OUTPUT_TABLE == options.output_format) {
+        printf(benchmark_header, "");
+        fprintf(stdout, "# Pattern: %s, %d origin(s), %d target(s), "
+                "window size %d\n", rma_pattern_name(), num_origins,
+                num_targets, options.window_size);
+        fflush(stdout);
+    }
+
+    for (win = first_win; win <= last_win; win++) {
+        for (sync = first_sync; sync <= last_sync; sync++) {
+            if (0 == rank && OUTPUT_TABLE == options.output_format) {
+                fprintf(stdout, "# Window creation: %s\n", win_info[win]);
+                fprintf(stdout, "# Synchronization: %s\n", sync_info[sync]);
+                fprintf(stdout, "%-*s%*s%*s%*s%*s\n", 10, "# Size",
+                        FIELD_WIDTH, "Put MB/s", FIELD_WIDTH, "Put Messages/s",
+                        FIELD_WIDTH, "Get MB/s", FIELD_WIDTH, "Get Messages/s");
+                fflush(stdout);
+            }
+
+            options.iterations = iterations;
+            options.skip = skip;
+            reset_message_sizes();
+            for (size = options.min_message_size;
+                    size <= options.max_message_size;
+                    size = next_message_size(size)) {
+                if (size > LARGE_MESSAGE_SIZE) {
+                    options.iterations = options.iterations_large;
+                    options.skip = options.skip_large;
+                }
+
+                create_window(rank, nprocs, (size_t)size * options.window_size,
+                        win, &mpi_win);
+
+                for (op = RMA_PUT; op <= RMA_GET; op++) {
+                    t = run_rma(rank, op, sync, size, &targets, &origins,
+                            mpi_win);
+                    msgs = (t > 0.0) ? (double)options.iterations *
+                        options.window_size * targets.count : 0.0;
+
+                    MPI_CHECK(MPI_Reduce(&t, &max_t, 1, MPI_DOUBLE, MPI_MAX, 0,
+                                MPI_COMM_WORLD));
+                    MPI_CHECK(MPI_Reduce(&msgs, &total_msgs, 1, MPI_DOUBLE,
+                                MPI_SUM, 0, MPI_COMM_WORLD));
+
+                    rate[2 * op + 1] = total_msgs / max_t;
+                    rate[2 * op] = rate[2 * op + 1] * size / 1e6;
+                }
+
+                free_window(win, &mpi_win);
+
+                if (0 == rank) {
+                    record_message_size(size, rate[0]);
+                    report(size, win, sync, rate);
+                }
+            }
+        }
+    }
+
+    free(disps);
+
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * Origins and targets are disjoint in every pattern.  With an odd number of
+ * ranks the last rank sits out the pairs and many patterns.
+ */
+static void get_roles (int rank, int nprocs, struct rma_range_t *targets,
+        struct rma_range_t *origins)
+{
+    int pairs = nprocs / 2;
+
+    targets->first = origins->first = 0;
+    targets->count = origins->count = 0;
+
+    switch (options.rma_pattern) {
+        case RMA_FANOUT:
+            if (0 == rank) {
+                targets->first = 1;
+                targets->count = nprocs - 1;
+            } else {
+                origins->count = 1;
+            }
+            break;
+        case RMA_FANIN:
+            if (0 == rank) {
+                origins->first = 1;
+                origins->count = nprocs - 1;
+            } else {
+                targets->count = 1;
+            }
+            break;
+        case RMA_MANY:
+            if (rank < pairs) {
+                targets->first = pairs;
+                targets->count = pairs;
+            } else if (rank < 2 * pairs) {
+                origins->count = pairs;
+            }
+            break;
+        default:
+            if (rank < pairs) {
+                targets->first = rank + pairs;
+                targets->count = 1;
+            } else if (rank < 2 * pairs) {
+                origins->first = rank - pairs;
+                origins->count = 1;
+            }
+            break;
+    }
+}
+
+/*
+ * Every rank exposes BYTES so the displacements are the same everywhere, the
+ * dynamic window gathers the address of every attached buffer instead.
+ */
+static void create_window (int rank, int nprocs, size_t bytes,
+        enum WINDOW type, MPI_Win *win)
+{
+    MPI_Aint base = 0;
+    int page_size = getpagesize();
+
+    if (posix_memalign((void **)&lbuf, page_size, bytes)) {
+        fprintf(stderr, "Error allocating memory on Rank %d\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+    memset(lbuf, 'a', bytes);
+
+    if (WIN_ALLOCATE != type) {
+        if (posix_memalign((void **)&wbuf, page_size, bytes)) {
+            fprintf(stderr, "Error allocating memory on Rank %d\n", rank);
+            MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+        }
+        memset(wbuf, 'b', bytes);
+    }
+
+    switch (type) {
+        case WIN_CREATE:
+            MPI_CHECK(MPI_Win_create(wbuf, bytes, 1, MPI_INFO_NULL,
+                        MPI_COMM_WORLD, win));
+            break;
+        case WIN_ALLOCATE:
+            MPI_CHECK(MPI_Win_allocate(bytes, 1, MPI_INFO_NULL, MPI_COMM_WORLD,
+                        &wbuf, win));
+            break;
+        default:
+            MPI_CHECK(MPI_Win_create_dynamic(MPI_INFO_NULL, MPI_COMM_WORLD,
+                        win));
+            MPI_CHECK(MPI_Win_attach(*win, wbuf, bytes));
+            MPI_CHECK(MPI_Get_address(wbuf, &base));
+            break;
+    }
+
+    MPI_CHECK(MPI_Allgather(&base, 1, MPI_AINT, disps, 1, MPI_AINT,
+                MPI_COMM_WORLD));
+}
+
+static void free_window (enum WINDOW type, MPI_Win *win)
+{
+    if (WIN_DYNAMIC == type) {
+        MPI_CHECK(MPI_Win_detach(*win, wbuf));
+    }
+
+    MPI_CHECK(MPI_Win_free(win));
+
+    if (WIN_ALLOCATE != type) {
+        free(wbuf);
+    }
+    free(lbuf);
+    wbuf = lbuf = NULL;
+}
+
+static void issue (enum rma_op op, int size, struct rma_range_t const *targets,
+        MPI_Win win)
+{
+    int t, j;
+
+    for (t = targets->first; t < targets->first + targets->count; t++) {
+        for (j = 0; j < options.window_size; j++) {
+            if (RMA_PUT == op) {
+                MPI_CHECK(MPI_Put(lbuf + j * size, size, MPI_CHAR, t,
+                            disps[t] + j * size, size, MPI_CHAR, win));
+            } else {
+                MPI_CHECK(MPI_Get(lbuf + j * size, size, MPI_CHAR, t,
+                            disps[t] + j * size, size, MPI_CHAR, win));
+            }
+        }
+    }
+}
+
+/*
+ * Returns the time of the timed iterations on an origin and 0 elsewhere.
+ * Lock takes a shared lock on every target for each window, flush and
+ * flush_local keep a lock_all epoch open and complete each window with
+ * MPI_Win_flush_all or MPI_Win_flush_local_all.  Fence is collective over the
+ * window, so the ranks that are neither origin nor target take part as well.
+ */
+static double run_rma (int rank, enum rma_op op, enum SYNC sync, int size,
+        struct rma_range_t const *targets, struct rma_range_t const *origins,
+        MPI_Win win)
+{
+    int is_origin = (targets->count > 0);
+    int is_target = (origins->count > 0);
+    int range[1][3];
+    int t, i;
+    double t_start = 0.0;
+    MPI_Group world_group, group;
+
+    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+    if (!is_origin && FENCE != sync && !(PSCW == sync && is_target)) {
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+        return 0.0;
+    }
+
+    switch (sync) {
+        case LOCK:
+            for (i = 0; i < options.skip + options.iterations; i++) {
+                if (i == options.skip) {
+                    t_start = osu_wtime();
+                }
+                for (t = targets->first; t < targets->first + targets->count;
+                        t++) {
+                    MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, t, 0, win));
+                }
+                issue(op, size, targets, win);
+                for (t = targets->first; t < targets->first + targets->count;
+                        t++) {
+                    MPI_CHECK(MPI_Win_unlock(t, win));
+                }
+            }
+            break;
+        case LOCK_ALL:
+            for (i = 0; i < options.skip + options.iterations; i++) {
+                if (i == options.skip) {
+                    t_start = osu_wtime();
+                }
+                MPI_CHECK(MPI_Win_lock_all(0, win));
+                issue(op, size, targets, win);
+                MPI_CHECK(MPI_Win_unlock_all(win));
+            }
+            break;
+        case FLUSH:
+        case FLUSH_LOCAL:
+            MPI_CHECK(MPI_Win_lock_all(0, win));
+            for (i = 0; i < options.skip + options.iterations; i++) {
+                if (i == options.skip) {
+                    t_start = osu_wtime();
+                }
+                issue(op, size, targets, win);
+                if (FLUSH == sync) {
+                    MPI_CHECK(MPI_Win_flush_all(win));
+                } else {
+                    MPI_CHECK(MPI_Win_flush_local_all(win));
+                }
+            }
+            MPI_CHECK(MPI_Win_unlock_all(win));
+            break;
+        case FENCE:
+            MPI_CHECK(MPI_Win_fence(0, win));
+            for (i = 0; i < options.skip + options.iterations; i++) {
+                if (i == options.skip) {
+                    t_start = osu_wtime();
+                }
+                if (is_origin) {
+                    issue(op, size, targets, win);
+                }
+                MPI_CHECK(MPI_Win_fence(0, win));
+            }
+            break;
+        case PSCW:
+            range[0][0] = is_origin ? targets->first : origins->first;
+            range[0][1] = range[0][0] +
+                (is_origin ? targets->count : origins->count) - 1;
+            range[0][2] = 1;
+
+            MPI_CHECK(MPI_Comm_group(MPI_COMM_WORLD, &world_group));
+            MPI_CHECK(MPI_Group_range_incl(world_group, 1, range, &group));
+
+            for (i = 0; i < options.skip + options.iterations; i++) {
+                if (i == options.skip) {
+                    t_start = osu_wtime();
+                }
+                if (is_origin) {
+                    MPI_CHECK(MPI_Win_start(group, 0, win));
+                    issue(op, size, targets, win);
+                    MPI_CHECK(MPI_Win_complete(win));
+                } else {
+                    MPI_CHECK(MPI_Win_post(group, 0, win));
+                    MPI_CHECK(MPI_Win_wait(win));
+                }
+            }
+
+            MPI_CHECK(MPI_Group_free(&group));
+            MPI_CHECK(MPI_Group_free(&world_group));
+            break;
+    }
+
+    if (is_origin) {
+        t_start = osu_wtime() - t_start;
+    }
+
+    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+    return is_origin ? t_start : 0.0;
+}
+
+static void report (int size, int win, int sync, double const *rate)
+{
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "%-*d%*.*f%*.*f%*.*f%*.*f\n", 10, size,
+                FIELD_WIDTH, FLOAT_PRECISION, rate[0],
+                FIELD_WIDTH, FLOAT_PRECISION, rate[1],
+                FIELD_WIDTH, FLOAT_PRECISION, rate[2],
+                FIELD_WIDTH, FLOAT_PRECISION, rate[3]);
+        fflush(stdout);
+    } else {
+        struct result_metric_t metrics[6] = {
+            {"window", win},
+            {"sync", sync},
+            {"put_bandwidth_MBps", rate[0]},
+            {"put_message_rate", rate[1]},
+            {"get_bandwidth_MBps", rate[2]},
+            {"get_message_rate", rate[3]},
+        };
+
+        output_result(benchmark_num_ranks, size, 6, metrics);
+    }
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
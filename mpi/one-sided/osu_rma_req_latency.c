@@ -0,0 +1,308 @@
+#define BENCHMARK "OSU MPI_Rput/MPI_Rget/MPI_Raccumulate%s Latency Test"
+/*
+ * Copyright (C) 2003-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * Every iteration rank 0 issues -q requests of MPI_Rput, MPI_Rget or
+ * MPI_Raccumulate to rank 1 and waits for all of them, so the latency is the
+ * time to complete a batch of requests without flushing the epoch.  A
+ * completed MPI_Rget has its data, a completed MPI_Rput or MPI_Raccumulate
+ * only guarantees that the origin buffer may be reused; lock and lock_all
+ * close the epoch and flush flushes it after every batch on top of that.
+ */
+
+#include <osu_util_mpi.h>
+
+enum rma_req_op {
+    RMA_RPUT,
+    RMA_RGET,
+    RMA_RACC
+};
+
+static char *sbuf = NULL, *win_base = NULL;
+
+static void issue_batch (enum rma_req_op op, int size, MPI_Aint disp,
+        MPI_Win win);
+static double run_rma_req (enum rma_req_op op, int size, MPI_Aint disp,
+        MPI_Win win);
+static void print_req_header (int rank);
+static void report (int size, double const *latency);
+
+int main (int argc, char *argv[])
+{
+    int rank, nprocs, size;
+    int po_ret = PO_OKAY;
+    double t, latency[3];
+    enum rma_req_op op;
+    MPI_Aint disp = 0;
+    MPI_Win win;
+
+    options.win = WIN_ALLOCATE;
+    options.sync = FLUSH;
+    options.rma_inflight = 1;
+
+    options.bench = ONE_SIDED;
+    options.subtype = LAT;
+    options.synctype = ALL_SYNC;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_rma_req_latency");
+
+    po_ret = process_options(argc, argv);
+
+    if (PO_OKAY == po_ret && NONE != options.accel) {
+        if (init_accel()) {
+            fprintf(stderr, "Error initializing device\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+
+    if (0 == rank) {
+        switch (po_ret) {
+            case PO_CUDA_NOT_AVAIL:
+                fprintf(stderr, "CUDA support not enabled.  Please recompile "
+                        "benchmark with CUDA support.\n");
+                break;
+            case PO_OPENACC_NOT_AVAIL:
+                fprintf(stderr, "OPENACC support not enabled.  Please "
+                        "recompile benchmark with OPENACC support.\n");
+                break;
+            case PO_BAD_USAGE:
+                print_bad_usage_message(rank);
+            case PO_HELP_MESSAGE:
+                usage_one_sided("osu_rma_req_latency");
+                break;
+            case PO_VERSION_MESSAGE:
+                print_version_message(rank);
+                MPI_CHECK(MPI_Finalize());
+                exit(EXIT_SUCCESS);
+            case PO_OKAY:
+                break;
+        }
+    }
+
+    switch (po_ret) {
+        case PO_CUDA_NOT_AVAIL:
+        case PO_OPENACC_NOT_AVAIL:
+        case PO_BAD_USAGE:
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+        case PO_VERSION_MESSAGE:
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (nprocs != 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires exactly two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+
+        return EXIT_FAILURE;
+    }
+
+    if (PSCW == options.sync || FENCE == options.sync) {
+        if (rank == 0) {
+            fprintf(stderr, "Request-based RMA requires passive target "
+                    "synchronization (lock, flush, flush_local or "
+                    "lock_all)\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+
+        return EXIT_FAILURE;
+    }
+
+    print_req_header(rank);
+
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        allocate_memory_one_sided(rank, &sbuf, &win_base,
+                (size_t)size * options.rma_inflight, options.win, &win);
+
+        if (WIN_DYNAMIC == options.win) {
+            disp = disp_remote;
+        }
+
+        if (size > LARGE_MESSAGE_SIZE) {
+            options.iterations = options.iterations_large;
+            options.skip = options.skip_large;
+        }
+
+        for (op = RMA_RPUT; op <= RMA_RACC; op++) {
+            MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+            if (rank == 0) {
+                t = run_rma_req(op, size, disp, win);
+                latency[op] = t * 1.0e6 / options.iterations;
+            }
+
+            MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+        }
+
+        if (rank == 0) {
+            record_message_size(size, latency[RMA_RPUT]);
+            report(size, latency);
+        }
+
+        free_memory_one_sided(sbuf, win_base, options.win, win, rank);
+    }
+
+    MPI_CHECK(MPI_Finalize());
+
+    if (NONE != options.accel) {
+        if (cleanup_accel()) {
+            fprintf(stderr, "Error cleaning up device\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/* Issue one batch of requests to rank 1 and wait for all of them */
+static void issue_batch (enum rma_req_op op, int size, MPI_Aint disp,
+        MPI_Win win)
+{
+    int j;
+
+    for (j = 0; j < options.rma_inflight; j++) {
+        switch (op) {
+            case RMA_RPUT:
+                MPI_CHECK(MPI_Rput(sbuf + j * size, size, MPI_CHAR, 1,
+                            disp + j * size, size, MPI_CHAR, win, request + j));
+                break;
+            case RMA_RGET:
+                MPI_CHECK(MPI_Rget(sbuf + j * size, size, MPI_CHAR, 1,
+                            disp + j * size, size, MPI_CHAR, win, request + j));
+                break;
+            case RMA_RACC:
+                MPI_CHECK(MPI_Raccumulate(sbuf + j * size, size, MPI_CHAR, 1,
+                            disp + j * size, size, MPI_CHAR, MPI_SUM, win,
+                            request + j));
+                break;
+        }
+    }
+
+    MPI_CHECK(MPI_Waitall(options.rma_inflight, request, reqstat));
+}
+
+static double run_rma_req (enum rma_req_op op, int size, MPI_Aint disp,
+        MPI_Win win)
+{
+    double t_start = 0.0;
+    int i;
+
+    if (FLUSH == options.sync || FLUSH_LOCAL == options.sync) {
+        MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
+    }
+
+    for (i = 0; i < options.skip + options.iterations; i++) {
+        if (i == options.skip) {
+            t_start = osu_wtime();
+        }
+
+        switch (options.sync) {
+            case LOCK:
+                MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, 1, 0, win));
+                issue_batch(op, size, disp, win);
+                MPI_CHECK(MPI_Win_unlock(1, win));
+                break;
+            case LOCK_ALL:
+                MPI_CHECK(MPI_Win_lock_all(0, win));
+                issue_batch(op, size, disp, win);
+                MPI_CHECK(MPI_Win_unlock_all(win));
+                break;
+            case FLUSH:
+                issue_batch(op, size, disp, win);
+                MPI_CHECK(MPI_Win_flush(1, win));
+                break;
+            default:
+                issue_batch(op, size, disp, win);
+                break;
+        }
+    }
+
+    t_start = osu_wtime() - t_start;
+
+    if (FLUSH == options.sync || FLUSH_LOCAL == options.sync) {
+        MPI_CHECK(MPI_Win_unlock(1, win));
+    }
+
+    return t_start;
+}
+
+static void print_req_header (int rank)
+{
+    if (rank == 0 && OUTPUT_TABLE == options.output_format) {
+        switch (options.accel) {
+            case CUDA:
+                printf(benchmark_header, "-CUDA");
+                break;
+            case OPENACC:
+                printf(benchmark_header, "-OPENACC");
+                break;
+            case ROCM:
+                printf(benchmark_header, "-ROCM");
+                break;
+            case SYCL:
+                printf(benchmark_header, "-SYCL");
+                break;
+            default:
+                printf(benchmark_header, "");
+                break;
+        }
+        fprintf(stdout, "# Window creation: %s\n", win_info[options.win]);
+        fprintf(stdout, "# Synchronization: %s\n", sync_info[options.sync]);
+        fprintf(stdout, "# Requests per batch: %d\n", options.rma_inflight);
+        if (NONE != options.accel) {
+            fprintf(stdout, "# Rank 0 Memory on %s and Rank 1 Memory on %s\n",
+                    'M' == options.src ? "MANAGED (M)" : ('D' == options.src ?
+                        "DEVICE (D)" : "HOST (H)"),
+                    'M' == options.dst ? "MANAGED (M)" : ('D' == options.dst ?
+                        "DEVICE (D)" : "HOST (H)"));
+        }
+        fprintf(stdout, "%-*s%*s%*s%*s\n", 10, "# Size",
+                FIELD_WIDTH, "Rput (us)", FIELD_WIDTH, "Rget (us)",
+                FIELD_WIDTH, "Raccumulate (us)");
+        fflush(stdout);
+    }
+}
+
+static void report (int size, double const *latency)
+{
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "%-*d%*.*f%*.*f%*.*f\n", 10, size,
+                FIELD_WIDTH, FLOAT_PRECISION, latency[RMA_RPUT],
+                FIELD_WIDTH, FLOAT_PRECISION, latency[RMA_RGET],
+                FIELD_WIDTH, FLOAT_PRECISION, latency[RMA_RACC]);
+        fflush(stdout);
+    } else {
+        struct result_metric_t metrics[4] = {
+            {"requests", options.rma_inflight},
+            {"rput_latency_us", latency[RMA_RPUT]},
+            {"rget_latency_us", latency[RMA_RGET]},
+            {"raccumulate_latency_us", latency[RMA_RACC]},
+        };
+
+        output_result(benchmark_num_ranks, size, 4, metrics);
+    }
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -0,0 +1,302 @@
+#define BENCHMARK "OSU MPI_Win_attach/detach%s Latency Test"
+/*
+ * Copyright (C) 2003-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * The dynamic window of the other one-sided tests attaches one buffer once.
+ * Here rank 1 attaches a set of regions to a dynamic window every iteration,
+ * sends their addresses to rank 0, which reads every region once right after
+ * it learned the address (first access) and once more (warm access), and
+ * detaches them all again.  The number of regions is swept over the powers
+ * of two up to -k for every region size.
+ *
+ * The same buffers are attached again every iteration, as a runtime recycling
+ * its allocations would, so a library that keeps registrations across a
+ * detach shows it as a cheaper attach and first access.
+ */
+
+#include <osu_util_mpi.h>
+
+#define ADDR_TAG    100
+#define ACK_TAG     101
+#define DONE_TAG    102
+
+enum attach_timer {
+    T_ATTACH,
+    T_DETACH,
+    T_EXCHANGE,
+    T_FIRST,
+    T_WARM,
+    T_NUM
+};
+
+static char *regions[MAX_ATTACH_REGIONS];
+static MPI_Aint addrs[MAX_ATTACH_REGIONS];
+static char *lbuf = NULL;
+
+static void run_target (int size, int n, MPI_Win win, double *t);
+static void run_origin (int size, int n, MPI_Win win, double *t);
+static void report (int size, int n, double const *t);
+
+int main (int argc, char *argv[])
+{
+    int rank, nprocs, size, n, k;
+    int po_ret = PO_OKAY;
+    int page_size = getpagesize();
+    double t[T_NUM], t_sum[T_NUM];
+    MPI_Win win;
+
+    options.bench = ONE_SIDED;
+    options.subtype = ATTACH;
+    options.synctype = ALL_SYNC;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_win_attach");
+
+    po_ret = process_options(argc, argv);
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+
+    if (0 == rank) {
+        switch (po_ret) {
+            case PO_BAD_USAGE:
+                print_bad_usage_message(rank);
+            case PO_HELP_MESSAGE:
+                usage_one_sided("osu_win_attach");
+                break;
+            case PO_VERSION_MESSAGE:
+                print_version_message(rank);
+                MPI_CHECK(MPI_Finalize());
+                exit(EXIT_SUCCESS);
+            case PO_OKAY:
+                break;
+        }
+    }
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+        case PO_VERSION_MESSAGE:
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (nprocs != 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires exactly two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+
+        return EXIT_FAILURE;
+    }
+
+    if ((double)options.num_buffers * options.max_message_size >
+            options.max_mem_limit) {
+        n = options.max_mem_limit / options.max_message_size;
+        if (n < 1) {
+            n = 1;
+        }
+
+        if (rank == 0) {
+            fprintf(stderr, "Warning! Increase the Max Memory Limit to be able "
+                    "to attach %d regions of %ld bytes.\n"
+                    "Continuing with %d regions\n", options.num_buffers,
+                    options.max_message_size, n);
+        }
+        options.num_buffers = n;
+    }
+
+    /* Rank 1 attaches the regions, rank 0 reads them into lbuf */
+    if (rank == 1) {
+        for (k = 0; k < options.num_buffers; k++) {
+            if (posix_memalign((void **)&regions[k], page_size,
+                        options.max_message_size)) {
+                fprintf(stderr, "Error allocating memory on Rank %d\n", rank);
+                MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+            }
+            memset(regions[k], 'b', options.max_message_size);
+        }
+    } else {
+        if (posix_memalign((void **)&lbuf, page_size,
+                    options.max_message_size)) {
+            fprintf(stderr, "Error allocating memory on Rank %d\n", rank);
+            MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+        }
+        memset(lbuf, 'a', options.max_message_size);
+    }
+
+    MPI_CHECK(MPI_Win_create_dynamic(MPI_INFO_NULL, MPI_COMM_WORLD, &win));
+
+    if (rank == 0 && OUTPUT_TABLE == options.output_format) {
+        printf(benchmark_header, "");
+        fprintf(stdout, "# Window creation: %s\n", win_info[WIN_DYNAMIC]);
+        fprintf(stdout, "# Synchronization: %s\n", sync_info[FLUSH]);
+        fprintf(stdout, "# Attach, detach, first and warm access per region, "
+                "exchange per round\n");
+        fprintf(stdout, "%-*s%*s%*s%*s%*s%*s%*s\n", 10, "# Size", 10,
+                "Regions", FIELD_WIDTH, "Attach (us)", FIELD_WIDTH,
+                "Detach (us)", FIELD_WIDTH, "Exchange (us)", FIELD_WIDTH,
+                "First Get (us)", FIELD_WIDTH, "Warm Get (us)");
+        fflush(stdout);
+    }
+
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        if (size > LARGE_MESSAGE_SIZE) {
+            options.iterations = options.iterations_large;
+            options.skip = options.skip_large;
+        }
+
+        for (n = 1; n <= options.num_buffers; n *= 2) {
+            memset(t, 0, sizeof(t));
+
+            MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+            if (rank == 1) {
+                run_target(size, n, win, t);
+            } else {
+                run_origin(size, n, win, t);
+            }
+
+            MPI_CHECK(MPI_Reduce(t, t_sum, T_NUM, MPI_DOUBLE, MPI_SUM, 0,
+                        MPI_COMM_WORLD));
+
+            if (rank == 0) {
+                report(size, n, t_sum);
+            }
+        }
+    }
+
+    MPI_CHECK(MPI_Win_free(&win));
+
+    if (rank == 1) {
+        for (k = 0; k < options.num_buffers; k++) {
+            free(regions[k]);
+        }
+    } else {
+        free(lbuf);
+    }
+
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * The exchange is timed from the first MPI_Get_address to the
+ * acknowledgement of rank 0, so it covers the round trip a runtime needs
+ * before a peer may access a new region.
+ */
+static void run_target (int size, int n, MPI_Win win, double *t)
+{
+    double t_start;
+    int i, k;
+
+    for (i = 0; i < options.skip + options.iterations; i++) {
+        t_start = osu_wtime();
+        for (k = 0; k < n; k++) {
+            MPI_CHECK(MPI_Win_attach(win, regions[k], size));
+        }
+        if (i >= options.skip) {
+            t[T_ATTACH] += osu_wtime() - t_start;
+        }
+
+        t_start = osu_wtime();
+        for (k = 0; k < n; k++) {
+            MPI_CHECK(MPI_Get_address(regions[k], &addrs[k]));
+        }
+        MPI_CHECK(MPI_Send(addrs, n, MPI_AINT, 0, ADDR_TAG, MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Recv(NULL, 0, MPI_CHAR, 0, ACK_TAG, MPI_COMM_WORLD,
+                    MPI_STATUS_IGNORE));
+        if (i >= options.skip) {
+            t[T_EXCHANGE] += osu_wtime() - t_start;
+        }
+
+        /* Rank 0 is done with the regions */
+        MPI_CHECK(MPI_Recv(NULL, 0, MPI_CHAR, 0, DONE_TAG, MPI_COMM_WORLD,
+                    MPI_STATUS_IGNORE));
+
+        t_start = osu_wtime();
+        for (k = 0; k < n; k++) {
+            MPI_CHECK(MPI_Win_detach(win, regions[k]));
+        }
+        if (i >= options.skip) {
+            t[T_DETACH] += osu_wtime() - t_start;
+        }
+    }
+}
+
+/* Rank 0 keeps a lock_all epoch open, attaching needs none on the target */
+static void run_origin (int size, int n, MPI_Win win, double *t)
+{
+    double t_start;
+    int i, k, pass;
+
+    MPI_CHECK(MPI_Win_lock_all(0, win));
+
+    for (i = 0; i < options.skip + options.iterations; i++) {
+        MPI_CHECK(MPI_Recv(addrs, n, MPI_AINT, 1, ADDR_TAG, MPI_COMM_WORLD,
+                    MPI_STATUS_IGNORE));
+        MPI_CHECK(MPI_Send(NULL, 0, MPI_CHAR, 1, ACK_TAG, MPI_COMM_WORLD));
+
+        for (pass = T_FIRST; pass <= T_WARM; pass++) {
+            t_start = osu_wtime();
+            for (k = 0; k < n; k++) {
+                MPI_CHECK(MPI_Get(lbuf, size, MPI_CHAR, 1, addrs[k], size,
+                            MPI_CHAR, win));
+                MPI_CHECK(MPI_Win_flush(1, win));
+            }
+            if (i >= options.skip) {
+                t[pass] += osu_wtime() - t_start;
+            }
+        }
+
+        MPI_CHECK(MPI_Send(NULL, 0, MPI_CHAR, 1, DONE_TAG, MPI_COMM_WORLD));
+    }
+
+    MPI_CHECK(MPI_Win_unlock_all(win));
+}
+
+static void report (int size, int n, double const *t)
+{
+    double per_region = 1e6 / ((double)options.iterations * n);
+    double per_round = 1e6 / options.iterations;
+
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "%-*d%*d%*.*f%*.*f%*.*f%*.*f%*.*f\n", 10, size, 10, n,
+                FIELD_WIDTH, FLOAT_PRECISION, t[T_ATTACH] * per_region,
+                FIELD_WIDTH, FLOAT_PRECISION, t[T_DETACH] * per_region,
+                FIELD_WIDTH, FLOAT_PRECISION, t[T_EXCHANGE] * per_round,
+                FIELD_WIDTH, FLOAT_PRECISION, t[T_FIRST] * per_region,
+                FIELD_WIDTH, FLOAT_PRECISION, t[T_WARM] * per_region);
+        fflush(stdout);
+    } else {
+        struct result_metric_t metrics[6] = {
+            {"regions", n},
+            {"attach_latency_us", t[T_ATTACH] * per_region},
+            {"detach_latency_us", t[T_DETACH] * per_region},
+            {"exchange_latency_us", t[T_EXCHANGE] * per_round},
+            {"first_access_latency_us", t[T_FIRST] * per_region},
+            {"warm_access_latency_us", t[T_WARM] * per_region},
+        };
+
+        output_result(benchmark_num_ranks, size, 6, metrics);
+    }
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
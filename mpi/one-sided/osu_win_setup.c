@@ -0,0 +1,349 @@
+#define BENCHMARK "OSU MPI Window Setup%s Scaling Test"
+/*
+ * Copyright (C) 2003-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * The other one-sided tests only time transfers once the window exists.
+ * Here every iteration creates a window of the message size on the first N
+ * ranks, opens and closes its first epoch and frees it again, with N swept
+ * over the powers of two from 2 up to all ranks.  Like osu_init, the minimum,
+ * average and maximum over the ranks are reported for every step.
+ *
+ * The first epoch carries no operation, so implementations that only set up
+ * an epoch when the first operation arrives show a cheap epoch here and move
+ * the cost into the first transfer.
+ */
+
+#include <osu_util_mpi.h>
+
+enum setup_timer {
+    T_CREATE,
+    T_EPOCH,
+    T_FREE,
+    T_NUM
+};
+
+static char const *setup_name[T_NUM] = {"create", "epoch", "free"};
+
+static char *wbuf = NULL;
+
+static int next_ranks (int ranks, int max_ranks);
+static void run_setup (MPI_Comm comm, int size, enum WINDOW type,
+        enum SYNC sync, double *t);
+static void open_epoch (MPI_Comm comm, enum SYNC sync, MPI_Win win);
+static void report (int ranks, int size, double const *t_min,
+        double const *t_avg, double const *t_max, int win, int sync);
+
+int main (int argc, char *argv[])
+{
+    int rank, nprocs, size, ranks, i;
+    int po_ret = PO_OKAY;
+    int win, sync, first_win, last_win, first_sync, last_sync;
+    double t[T_NUM], t_min[T_NUM], t_avg[T_NUM], t_max[T_NUM];
+    MPI_Comm comm;
+
+    options.win = WIN_ALLOCATE;
+    options.sync = LOCK_ALL;
+    options.win_sweep = 1;
+    options.sync_sweep = 0;
+
+    options.bench = ONE_SIDED;
+    options.subtype = WIN_SETUP;
+    options.synctype = ALL_SYNC;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_win_setup");
+
+    po_ret = process_options(argc, argv);
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+
+    if (0 == rank) {
+        switch (po_ret) {
+            case PO_BAD_USAGE:
+                print_bad_usage_message(rank);
+            case PO_HELP_MESSAGE:
+                usage_one_sided("osu_win_setup");
+                break;
+            case PO_VERSION_MESSAGE:
+                print_version_message(rank);
+                MPI_CHECK(MPI_Finalize());
+                exit(EXIT_SUCCESS);
+            case PO_OKAY:
+                break;
+        }
+    }
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+        case PO_VERSION_MESSAGE:
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (nprocs < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+
+        return EXIT_FAILURE;
+    }
+
+    if (options.max_message_size > options.max_mem_limit) {
+        if (rank == 0) {
+            fprintf(stderr, "Warning! Increase the Max Memory Limit to be able "
+                    "to create windows of %ld bytes.\n"
+                    "Continuing with %ld bytes\n", options.max_message_size,
+                    options.max_mem_limit);
+        }
+        options.max_message_size = options.max_mem_limit;
+    }
+
+    /* MPI_Win_create and MPI_Win_attach expose this buffer */
+    if (posix_memalign((void **)&wbuf, getpagesize(),
+                options.max_message_size)) {
+        fprintf(stderr, "Error allocating memory on Rank %d\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+    memset(wbuf, 'a', options.max_message_size);
+
+    first_win = options.win_sweep ? WIN_CREATE : options.win;
+    last_win = options.win_sweep ? WIN_DYNAMIC : options.win;
+    first_sync = options.sync_sweep ? LOCK : options.sync;
+    last_sync = options.sync_sweep ? LOCK_ALL : options.sync;
+
+    if (0 == rank && OUTPUT_TABLE == options.output_format) {
+        printf(benchmark_header, "");
+        fflush(stdout);
+    }
+
+    for (win = first_win; win <= last_win; win++) {
+        for (sync = first_sync; sync <= last_sync; sync++) {
+            if (0 == rank && OUTPUT_TABLE == options.output_format) {
+                fprintf(stdout, "# Window creation: %s\n", win_info[win]);
+                fprintf(stdout, "# Synchronization: %s\n", sync_info[sync]);
+                fprintf(stdout, "%-*s%*s%*s%*s%*s%*s\n", 10, "# Size", 10,
+                        "Ranks", 10, "Step", FIELD_WIDTH, "Min (us)",
+                        FIELD_WIDTH, "Avg (us)", FIELD_WIDTH, "Max (us)");
+                fflush(stdout);
+            }
+
+            for (ranks = 2; ranks <= nprocs;
+                    ranks = next_ranks(ranks, nprocs)) {
+                MPI_CHECK(MPI_Comm_split(MPI_COMM_WORLD,
+                            rank < ranks ? 0 : MPI_UNDEFINED, rank, &comm));
+
+                reset_message_sizes();
+                for (size = options.min_message_size;
+                        size <= options.max_message_size;
+                        size = next_message_size(size)) {
+                    if (MPI_COMM_NULL != comm) {
+                        run_setup(comm, size, win, sync, t);
+
+                        MPI_CHECK(MPI_Reduce(t, t_min, T_NUM, MPI_DOUBLE,
+                                    MPI_MIN, 0, comm));
+                        MPI_CHECK(MPI_Reduce(t, t_max, T_NUM, MPI_DOUBLE,
+                                    MPI_MAX, 0, comm));
+                        MPI_CHECK(MPI_Reduce(t, t_avg, T_NUM, MPI_DOUBLE,
+                                    MPI_SUM, 0, comm));
+                    }
+
+                    if (0 == rank) {
+                        for (i = 0; i < T_NUM; i++) {
+                            t_avg[i] /= ranks;
+                        }
+                        record_message_size(size, t_avg[T_CREATE]);
+                        report(ranks, size, t_min, t_avg, t_max, win, sync);
+                    }
+
+                    /* Idle ranks follow the sizes for the adaptive schedule */
+                    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+                }
+
+                if (MPI_COMM_NULL != comm) {
+                    MPI_CHECK(MPI_Comm_free(&comm));
+                }
+            }
+        }
+    }
+
+    free(wbuf);
+
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+static int next_ranks (int ranks, int max_ranks)
+{
+    if (ranks < max_ranks && 2 * ranks > max_ranks) {
+        return max_ranks;
+    }
+
+    return 2 * ranks;
+}
+
+/* Average time of every step on this rank in microseconds */
+static void run_setup (MPI_Comm comm, int size, enum WINDOW type,
+        enum SYNC sync, double *t)
+{
+    double t_start;
+    char *base = NULL;
+    int i, j;
+    MPI_Win win;
+
+    for (j = 0; j < T_NUM; j++) {
+        t[j] = 0.0;
+    }
+
+    for (i = 0; i < options.skip + options.iterations; i++) {
+        MPI_CHECK(MPI_Barrier(comm));
+
+        t_start = osu_wtime();
+        switch (type) {
+            case WIN_CREATE:
+                MPI_CHECK(MPI_Win_create(wbuf, size, 1, MPI_INFO_NULL, comm,
+                            &win));
+                break;
+            case WIN_ALLOCATE:
+                MPI_CHECK(MPI_Win_allocate(size, 1, MPI_INFO_NULL, comm,
+                            &base, &win));
+                break;
+            default:
+                MPI_CHECK(MPI_Win_create_dynamic(MPI_INFO_NULL, comm, &win));
+                MPI_CHECK(MPI_Win_attach(win, wbuf, size));
+                break;
+        }
+        if (i >= options.skip) {
+            t[T_CREATE] += osu_wtime() - t_start;
+        }
+
+        MPI_CHECK(MPI_Barrier(comm));
+
+        t_start = osu_wtime();
+        open_epoch(comm, sync, win);
+        if (i >= options.skip) {
+            t[T_EPOCH] += osu_wtime() - t_start;
+        }
+
+        MPI_CHECK(MPI_Barrier(comm));
+
+        t_start = osu_wtime();
+        if (WIN_DYNAMIC == type) {
+            MPI_CHECK(MPI_Win_detach(win, wbuf));
+        }
+        MPI_CHECK(MPI_Win_free(&win));
+        if (i >= options.skip) {
+            t[T_FREE] += osu_wtime() - t_start;
+        }
+    }
+
+    for (j = 0; j < T_NUM; j++) {
+        t[j] = t[j] * 1e6 / options.iterations;
+    }
+}
+
+/*
+ * Open and close the first epoch of a fresh window.  Lock and pscw pair a
+ * rank with its neighbours in the ring, the flush modes flush the lock_all
+ * epoch once before closing it.
+ */
+static void open_epoch (MPI_Comm comm, enum SYNC sync, MPI_Win win)
+{
+    int rank, ranks, peers[2];
+    MPI_Group comm_group, group;
+
+    MPI_CHECK(MPI_Comm_rank(comm, &rank));
+    MPI_CHECK(MPI_Comm_size(comm, &ranks));
+
+    peers[0] = (rank + 1) % ranks;
+    peers[1] = (rank + ranks - 1) % ranks;
+
+    switch (sync) {
+        case LOCK:
+            MPI_CHECK(MPI_Win_lock(MPI_LOCK_SHARED, peers[0], 0, win));
+            MPI_CHECK(MPI_Win_unlock(peers[0], win));
+            break;
+        case PSCW:
+            MPI_CHECK(MPI_Comm_group(comm, &comm_group));
+            MPI_CHECK(MPI_Group_incl(comm_group, peers[0] == peers[1] ? 1 : 2,
+                        peers, &group));
+            MPI_CHECK(MPI_Win_post(group, 0, win));
+            MPI_CHECK(MPI_Win_start(group, 0, win));
+            MPI_CHECK(MPI_Win_complete(win));
+            MPI_CHECK(MPI_Win_wait(win));
+            MPI_CHECK(MPI_Group_free(&group));
+            MPI_CHECK(MPI_Group_free(&comm_group));
+            break;
+        case FENCE:
+            MPI_CHECK(MPI_Win_fence(0, win));
+            MPI_CHECK(MPI_Win_fence(0, win));
+            break;
+        case FLUSH:
+        case FLUSH_LOCAL:
+            MPI_CHECK(MPI_Win_lock_all(0, win));
+            if (FLUSH == sync) {
+                MPI_CHECK(MPI_Win_flush_all(win));
+            } else {
+                MPI_CHECK(MPI_Win_flush_local_all(win));
+            }
+            MPI_CHECK(MPI_Win_unlock_all(win));
+            break;
+        default:
+            MPI_CHECK(MPI_Win_lock_all(0, win));
+            MPI_CHECK(MPI_Win_unlock_all(win));
+            break;
+    }
+}
+
+static void report (int ranks, int size, double const *t_min,
+        double const *t_avg, double const *t_max, int win, int sync)
+{
+    int i;
+
+    if (OUTPUT_TABLE == options.output_format) {
+        for (i = 0; i < T_NUM; i++) {
+            fprintf(stdout, "%-*d%*d%*s%*.*f%*.*f%*.*f\n", 10, size, 10,
+                    ranks, 10, setup_name[i],
+                    FIELD_WIDTH, FLOAT_PRECISION, t_min[i],
+                    FIELD_WIDTH, FLOAT_PRECISION, t_avg[i],
+                    FIELD_WIDTH, FLOAT_PRECISION, t_max[i]);
+        }
+        fflush(stdout);
+    } else {
+        struct result_metric_t metrics[11] = {
+            {"window", win},
+            {"sync", sync},
+            {"create_min_us", t_min[T_CREATE]},
+            {"create_avg_us", t_avg[T_CREATE]},
+            {"create_max_us", t_max[T_CREATE]},
+            {"epoch_min_us", t_min[T_EPOCH]},
+            {"epoch_avg_us", t_avg[T_EPOCH]},
+            {"epoch_max_us", t_max[T_EPOCH]},
+            {"free_min_us", t_min[T_FREE]},
+            {"free_avg_us", t_avg[T_FREE]},
+            {"free_max_us", t_max[T_FREE]},
+        };
+
+        output_result(ranks, size, 11, metrics);
+    }
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -0,0 +1,342 @@
+#define BENCHMARK "OSU MPI Shared Memory Window%s Load/Store Test"
+/*
+ * Copyright (C) 2003-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * Two ranks of a node share a window from MPI_Win_allocate_shared.  Rank 0
+ * stores into and loads from the segment of rank 1 through the pointer of
+ * MPI_Win_shared_query, completing every transfer with MPI_Win_sync, and
+ * compares that with MPI_Put and MPI_Get plus MPI_Win_flush on the same
+ * window.  The latency is the time to complete one transfer, the bandwidth
+ * that of a window of -W transfers completed together.
+ *
+ * The window is allocated both contiguous, where the library may place all
+ * segments in one allocation, and with alloc_shared_noncontig, where every
+ * segment starts on its own page.  Each rank first touches its own segment,
+ * so noncontiguous segments land on the NUMA node of their owner unless -N
+ * binds them all to one node.
+ */
+
+#include <osu_util_mpi.h>
+
+enum shm_op {
+    SHM_STORE,
+    SHM_PUT,
+    SHM_LOAD,
+    SHM_GET,
+    SHM_NUM_OPS
+};
+
+enum shm_layout {
+    SHM_CONTIG,
+    SHM_NONCONTIG
+};
+
+static char const *layout_name[] = {"contiguous", "noncontiguous"};
+
+static char *lbuf = NULL, *peer = NULL;
+
+static void create_window (int rank, int size, enum shm_layout layout,
+        MPI_Win *win);
+static double run_shm (enum shm_op op, int size, int window, MPI_Win win);
+static void report (int size, int bw, enum shm_layout layout,
+        double const *value);
+
+int main (int argc, char *argv[])
+{
+    int rank, nprocs, local_size, size, bw;
+    int po_ret = PO_OKAY;
+    int iterations, skip;
+    double t, value[SHM_NUM_OPS];
+    enum shm_layout layout;
+    enum shm_op op;
+    MPI_Comm node_comm;
+    MPI_Win win;
+
+    options.bench = ONE_SIDED;
+    options.subtype = SHM_WIN;
+    options.synctype = ALL_SYNC;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_win_shared");
+
+    po_ret = process_options(argc, argv);
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+
+    if (0 == rank) {
+        switch (po_ret) {
+            case PO_BAD_USAGE:
+                print_bad_usage_message(rank);
+            case PO_HELP_MESSAGE:
+                usage_one_sided("osu_win_shared");
+                break;
+            case PO_VERSION_MESSAGE:
+                print_version_message(rank);
+                MPI_CHECK(MPI_Finalize());
+                exit(EXIT_SUCCESS);
+            case PO_OKAY:
+                break;
+        }
+    }
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+        case PO_VERSION_MESSAGE:
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    MPI_CHECK(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+                MPI_INFO_NULL, &node_comm));
+    MPI_CHECK(MPI_Comm_size(node_comm, &local_size));
+    MPI_CHECK(MPI_Comm_free(&node_comm));
+
+    if (nprocs != 2 || local_size != 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires exactly two processes on the "
+                    "same node\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+
+        return EXIT_FAILURE;
+    }
+
+    if (setup_affinity()) {
+        if (rank == 0) {
+            fprintf(stderr, "Could not apply the requested CPU binding\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+
+        return EXIT_FAILURE;
+    }
+
+    if ((double)options.max_message_size * options.window_size >
+            options.max_mem_limit) {
+        options.max_message_size = options.max_mem_limit /
+            options.window_size;
+
+        if (rank == 0) {
+            fprintf(stderr, "Warning! Increase the Max Memory Limit to be able "
+                    "to use windows of %d messages.\n"
+                    "Continuing with messages up to %ld bytes\n",
+                    options.window_size, options.max_message_size);
+        }
+    }
+
+    if (posix_memalign((void **)&lbuf, getpagesize(),
+                options.max_message_size * options.window_size) ||
+            bind_memory(lbuf, options.max_message_size *
+                options.window_size)) {
+        fprintf(stderr, "Error allocating memory on Rank %d\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+    memset(lbuf, 'a', options.max_message_size * options.window_size);
+
+    if (0 == rank && OUTPUT_TABLE == options.output_format) {
+        printf(benchmark_header, "");
+        print_affinity_summary();
+        fprintf(stdout, "# Window creation: MPI_Win_allocate_shared\n");
+        fprintf(stdout, "# Synchronization: %s, MPI_Win_sync for load/store\n",
+                sync_info[FLUSH]);
+        fflush(stdout);
+    }
+
+    iterations = options.iterations;
+    skip = options.skip;
+
+    for (layout = SHM_CONTIG; layout <= SHM_NONCONTIG; layout++) {
+        for (bw = 0; bw <= 1; bw++) {
+            if (0 == rank && OUTPUT_TABLE == options.output_format) {
+                fprintf(stdout, "# Layout: %s, %s\n", layout_name[layout],
+                        bw ? "bandwidth (MB/s)" : "latency (us)");
+                fprintf(stdout, "%-*s%*s%*s%*s%*s\n", 10, "# Size",
+                        FIELD_WIDTH, "Store", FIELD_WIDTH, "Put",
+                        FIELD_WIDTH, "Load", FIELD_WIDTH, "Get");
+                fflush(stdout);
+            }
+
+            options.iterations = iterations;
+            options.skip = skip;
+            reset_message_sizes();
+            for (size = options.min_message_size;
+                    size <= options.max_message_size;
+                    size = next_message_size(size)) {
+                if (size > LARGE_MESSAGE_SIZE) {
+                    options.iterations = options.iterations_large;
+                    options.skip = options.skip_large;
+                }
+
+                create_window(rank, size, layout, &win);
+
+                for (op = SHM_STORE; op < SHM_NUM_OPS; op++) {
+                    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+                    /* Rank 1 only owns the target segment */
+                    if (rank == 0) {
+                        t = run_shm(op, size, bw ? options.window_size : 1,
+                                win);
+                        value[op] = bw ? size / 1e6 * options.iterations *
+                            options.window_size / t :
+                            t * 1e6 / options.iterations;
+                    }
+
+                    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+                }
+
+                MPI_CHECK(MPI_Win_free(&win));
+
+                if (rank == 0) {
+                    record_message_size(size, value[SHM_STORE]);
+                    report(size, bw, layout, value);
+                }
+            }
+        }
+    }
+
+    free(lbuf);
+
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * Every rank owns a segment of a window of -W messages and touches it first.
+ * Rank 0 looks up the segment of rank 1.
+ */
+static void create_window (int rank, int size, enum shm_layout layout,
+        MPI_Win *win)
+{
+    MPI_Aint bytes = (MPI_Aint)size * options.window_size, peer_bytes;
+    MPI_Info info = MPI_INFO_NULL;
+    char *base = NULL;
+    int disp_unit;
+
+    if (SHM_NONCONTIG == layout) {
+        MPI_CHECK(MPI_Info_create(&info));
+        MPI_CHECK(MPI_Info_set(info, "alloc_shared_noncontig", "true"));
+    }
+
+    MPI_CHECK(MPI_Win_allocate_shared(bytes, 1, info, MPI_COMM_WORLD, &base,
+                win));
+
+    if (MPI_INFO_NULL != info) {
+        MPI_CHECK(MPI_Info_free(&info));
+    }
+
+    if (bind_memory(base, bytes)) {
+        fprintf(stderr, "Error binding the segment of Rank %d to node %d\n",
+                rank, options.mem_node);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+    memset(base, 'b', bytes);
+
+    MPI_CHECK(MPI_Win_shared_query(*win, 1, &peer_bytes, &disp_unit, &peer));
+}
+
+/*
+ * Time a window of transfers into or out of the segment of rank 1, within
+ * one lock_all epoch.  A store is made visible with MPI_Win_sync after the
+ * copy, a load picks up the public copy with MPI_Win_sync before it.
+ */
+static double run_shm (enum shm_op op, int size, int window, MPI_Win win)
+{
+    double t_start = 0.0;
+    int i, j;
+
+    MPI_CHECK(MPI_Win_lock_all(MPI_MODE_NOCHECK, win));
+
+    for (i = 0; i < options.skip + options.iterations; i++) {
+        if (i == options.skip) {
+            t_start = osu_wtime();
+        }
+
+        switch (op) {
+            case SHM_STORE:
+                for (j = 0; j < window; j++) {
+                    memcpy(peer + j * size, lbuf + j * size, size);
+                }
+                MPI_CHECK(MPI_Win_sync(win));
+                break;
+            case SHM_PUT:
+                for (j = 0; j < window; j++) {
+                    MPI_CHECK(MPI_Put(lbuf + j * size, size, MPI_CHAR, 1,
+                                j * size, size, MPI_CHAR, win));
+                }
+                MPI_CHECK(MPI_Win_flush(1, win));
+                break;
+            case SHM_LOAD:
+                MPI_CHECK(MPI_Win_sync(win));
+                for (j = 0; j < window; j++) {
+                    memcpy(lbuf + j * size, peer + j * size, size);
+                }
+                break;
+            default:
+                for (j = 0; j < window; j++) {
+                    MPI_CHECK(MPI_Get(lbuf + j * size, size, MPI_CHAR, 1,
+                                j * size, size, MPI_CHAR, win));
+                }
+                MPI_CHECK(MPI_Win_flush(1, win));
+                break;
+        }
+    }
+
+    t_start = osu_wtime() - t_start;
+
+    MPI_CHECK(MPI_Win_unlock_all(win));
+
+    return t_start;
+}
+
+static void report (int size, int bw, enum shm_layout layout,
+        double const *value)
+{
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "%-*d%*.*f%*.*f%*.*f%*.*f\n", 10, size,
+                FIELD_WIDTH, FLOAT_PRECISION, value[SHM_STORE],
+                FIELD_WIDTH, FLOAT_PRECISION, value[SHM_PUT],
+                FIELD_WIDTH, FLOAT_PRECISION, value[SHM_LOAD],
+                FIELD_WIDTH, FLOAT_PRECISION, value[SHM_GET]);
+        fflush(stdout);
+    } else if (bw) {
+        struct result_metric_t metrics[5] = {
+            {"noncontig", layout},
+            {"store_bandwidth_MBps", value[SHM_STORE]},
+            {"put_bandwidth_MBps", value[SHM_PUT]},
+            {"load_bandwidth_MBps", value[SHM_LOAD]},
+            {"get_bandwidth_MBps", value[SHM_GET]},
+        };
+
+        output_result(benchmark_num_ranks, size, 5, metrics);
+    } else {
+        struct result_metric_t metrics[5] = {
+            {"noncontig", layout},
+            {"store_latency_us", value[SHM_STORE]},
+            {"put_latency_us", value[SHM_PUT]},
+            {"load_latency_us", value[SHM_LOAD]},
+            {"get_latency_us", value[SHM_GET]},
+        };
+
+        output_result(benchmark_num_ranks, size, 5, metrics);
+    }
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
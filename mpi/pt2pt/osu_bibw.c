@@ -18,8 +18,13 @@ int main(int argc, char *argv[])
     double t_start = 0.0, t_end = 0.0, t = 0.0;
     int window_size = 64;
     int po_ret = 0;
+    size_t errors = 0;
     options.bench = PT2PT;
     options.subtype = BW;
+    options.validate = VALIDATE_OFF;
+    options.mem_footprint = MEM_FOOTPRINT_OFF;
+    options.pvars = PVARS_OFF;
+    options.counters = COUNTERS_OFF;
 
     set_header(HEADER);
     set_benchmark_name("osu_bibw");
@@ -34,8 +39,11 @@ int main(int argc, char *argv[])
         }
     }
 
+    mem_footprint_sample(MEM_BEFORE_INIT, 0);
     MPI_CHECK(MPI_Init(&argc, &argv));
+    mem_footprint_sample(MEM_AFTER_INIT, 0);
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    set_num_ranks(numprocs);
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &myid));
 
     if (0 == myid) {
@@ -86,16 +94,37 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
+    if (setup_affinity()) {
+        if (myid == 0) {
+            fprintf(stderr, "Could not apply the requested CPU binding\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
     if (allocate_memory_pt2pt(&s_buf, &r_buf, myid)) {
         /* Error allocating memory */
         MPI_CHECK(MPI_Finalize());
         exit(EXIT_FAILURE);
     }
 
+    mem_footprint_sample(MEM_AFTER_ALLOC, 0);
+
+    if (setup_pvars(myid)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(PVARS_LIST == options.pvars ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    if (setup_counters(myid)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
     print_header(myid, BW);
 
     /* Bi-Directional Bandwidth test */
-    for(size = options.min_message_size; size <= options.max_message_size; size *= 2) {
+    for(size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         /* touch the data */
         set_buffer_pt2pt(s_buf, myid, options.accel, 'a', size);
         set_buffer_pt2pt(r_buf, myid, options.accel, 'b', size);
@@ -105,19 +134,24 @@ int main(int argc, char *argv[])
             options.skip = options.skip_large;
         }
 
+        start_pvars();
+        start_counters();
+
         if(myid == 0) {
             for(i = 0; i < options.iterations + options.skip; i++) {
                 if(i == options.skip) {
-                    t_start = MPI_Wtime();
+                    t_start = osu_wtime();
                 }
 
                 for(j = 0; j < window_size; j++) {
-                    MPI_CHECK(MPI_Irecv(r_buf, size, MPI_CHAR, 1, 10, MPI_COMM_WORLD,
+                    MPI_CHECK(MPI_Irecv(rotate_buffer(r_buf, size, i * window_size + j),
+                            size, MPI_CHAR, 1, 10, MPI_COMM_WORLD,
                             recv_request + j));
                 }
 
                 for(j = 0; j < window_size; j++) {
-                    MPI_CHECK(MPI_Isend(s_buf, size, MPI_CHAR, 1, 100, MPI_COMM_WORLD,
+                    MPI_CHECK(MPI_Isend(rotate_buffer(s_buf, size, i * window_size + j),
+                            size, MPI_CHAR, 1, 100, MPI_COMM_WORLD,
                             send_request + j));
                 }
 
@@ -125,7 +159,7 @@ int main(int argc, char *argv[])
                 MPI_CHECK(MPI_Waitall(window_size, recv_request, reqstat));
             }
 
-            t_end = MPI_Wtime();
+            t_end = osu_wtime();
             t = t_end - t_start;
 
         }
@@ -133,12 +167,14 @@ int main(int argc, char *argv[])
         else if(myid == 1) {
             for(i = 0; i < options.iterations + options.skip; i++) {
                 for(j = 0; j < window_size; j++) {
-                    MPI_CHECK(MPI_Irecv(r_buf, size, MPI_CHAR, 0, 100, MPI_COMM_WORLD,
+                    MPI_CHECK(MPI_Irecv(rotate_buffer(r_buf, size, i * window_size + j),
+                            size, MPI_CHAR, 0, 100, MPI_COMM_WORLD,
                             recv_request + j));
                 }
 
                 for (j = 0; j < window_size; j++) {
-                    MPI_CHECK(MPI_Isend(s_buf, size, MPI_CHAR, 0, 10, MPI_COMM_WORLD,
+                    MPI_CHECK(MPI_Isend(rotate_buffer(s_buf, size, i * window_size + j),
+                            size, MPI_CHAR, 0, 10, MPI_COMM_WORLD,
                             send_request + j));
                 }
 
@@ -147,15 +183,31 @@ int main(int argc, char *argv[])
             }
         }
 
+        stop_pvars();
+        stop_counters(options.iterations + options.skip);
+
+        if (VALIDATE_ON == options.validate) {
+            errors = validate_pt2pt(s_buf, r_buf, size, myid);
+        }
+
         if(myid == 0) {
             double tmp = size / 1e6 * options.iterations * window_size * 2;
 
-            fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                    FLOAT_PRECISION, tmp / t);
+            if (VALIDATE_ON == options.validate) {
+                print_validated_result(size, tmp / t, errors);
+            } else {
+                print_result(size, tmp / t);
+            }
             fflush(stdout);
         }
+
+        mem_footprint_sample(MEM_AFTER_SIZE, size);
     }
 
+    mem_footprint_report(myid);
+    cleanup_pvars();
+    cleanup_counters();
+
     free_memory(s_buf, r_buf, myid);
     MPI_CHECK(MPI_Finalize());
 
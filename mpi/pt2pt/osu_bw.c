@@ -17,11 +17,21 @@ main (int argc, char *argv[])
     int myid, numprocs, i, j;
     int size;
     char *s_buf, *r_buf;
-    double t_start = 0.0, t_end = 0.0, t = 0.0;
+    double t_start = 0.0, t_end = 0.0, t = 0.0, bw = 0.0;
+    int setting;
+    MPI_Comm comm;
     int window_size = 64;
     int po_ret = 0;
+    size_t errors = 0;
     options.bench = PT2PT;
     options.subtype = BW;
+    options.validate = VALIDATE_OFF;
+    options.mem_footprint = MEM_FOOTPRINT_OFF;
+    options.pvars = PVARS_OFF;
+    options.counters = COUNTERS_OFF;
+    options.tune = TUNE_OFF;
+    options.send_mode = SEND_MODE_STANDARD;
+    options.stream = STREAM_OFF;
 
     set_header(HEADER);
     set_benchmark_name("osu_bw");
@@ -36,8 +46,11 @@ main (int argc, char *argv[])
         }
     }
     
+    mem_footprint_sample(MEM_BEFORE_INIT, 0);
     MPI_CHECK(MPI_Init(&argc, &argv));
+    mem_footprint_sample(MEM_AFTER_INIT, 0);
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    set_num_ranks(numprocs);
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &myid));
 
     if (0 == myid) {
@@ -88,16 +101,51 @@ main (int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
+    if (setup_affinity()) {
+        if (myid == 0) {
+            fprintf(stderr, "Could not apply the requested CPU binding\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
     if (allocate_memory_pt2pt(&s_buf, &r_buf, myid)) {
         /* Error allocating memory */
         MPI_CHECK(MPI_Finalize());
         exit(EXIT_FAILURE);
     }
 
+    mem_footprint_sample(MEM_AFTER_ALLOC, 0);
+
+    if (setup_pvars(myid)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(PVARS_LIST == options.pvars ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    if (setup_counters(myid)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (setup_tuning(myid)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (setup_send_mode(myid, options.max_message_size, window_size)) {
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    if (setup_stream(myid)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
     print_header(myid, BW);
 
     /* Bandwidth test */
-    for(size = options.min_message_size; size <= options.max_message_size; size *= 2) {
+    for(size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         set_buffer_pt2pt(s_buf, myid, options.accel, 'a', size);
         set_buffer_pt2pt(r_buf, myid, options.accel, 'b', size);
 
@@ -107,47 +155,120 @@ main (int argc, char *argv[])
             options.skip = options.skip_large;
         }
 
-        if(myid == 0) {
-            for(i = 0; i < options.iterations + options.skip; i++) {
-                if(i == options.skip) {
-                    t_start = MPI_Wtime();
-                }
+        start_pvars();
+        start_counters();
+
+        for (setting = 0; setting < num_tune_settings(); setting++) {
+            comm = apply_tune_setting(setting);
 
+            /* Persistent sends keep the buffers of the first window */
+            if (SEND_MODE_PERSISTENT == options.send_mode && myid == 0) {
                 for(j = 0; j < window_size; j++) {
-                    MPI_CHECK(MPI_Isend(s_buf, size, MPI_CHAR, 1, 100, MPI_COMM_WORLD,
-                            request + j));
+                    MPI_CHECK(MPI_Send_init(rotate_buffer(s_buf, size, j),
+                            size, MPI_CHAR, 1, 100, comm, request + j));
                 }
+            }
 
-                MPI_CHECK(MPI_Waitall(window_size, request, reqstat));
-                MPI_CHECK(MPI_Recv(r_buf, 4, MPI_CHAR, 1, 101, MPI_COMM_WORLD,
+            /*
+             * MPI_Irsend needs the receives posted, so in ready mode the
+             * receiver posts the next window before it acknowledges one
+             */
+            if (SEND_MODE_READY == options.send_mode && myid == 1) {
+                for(j = 0; j < window_size; j++) {
+                    MPI_CHECK(MPI_Irecv(rotate_buffer(r_buf, size, j),
+                            size, MPI_CHAR, 0, 100, comm, request + j));
+                }
+                MPI_CHECK(MPI_Send(s_buf, 4, MPI_CHAR, 0, 101, comm));
+            } else if (SEND_MODE_READY == options.send_mode && myid == 0) {
+                MPI_CHECK(MPI_Recv(r_buf, 4, MPI_CHAR, 1, 101, comm,
                         &reqstat[0]));
             }
 
-            t_end = MPI_Wtime();
-            t = t_end - t_start;
-        }
+            if(myid == 0) {
+                for(i = 0; stream_step(i, (double)size * window_size, comm); i++) {
+                    if(i == options.skip) {
+                        t_start = osu_wtime();
+                    }
 
-        else if(myid == 1) {
-            for(i = 0; i < options.iterations + options.skip; i++) {
-                for(j = 0; j < window_size; j++) {
-                    MPI_CHECK(MPI_Irecv(r_buf, size, MPI_CHAR, 0, 100, MPI_COMM_WORLD,
-                            request + j));
+                    for(j = 0; j < window_size; j++) {
+                        mode_isend(rotate_buffer(s_buf, size, i * window_size + j),
+                                size, MPI_CHAR, 1, 100, comm, request + j);
+                    }
+
+                    MPI_CHECK(MPI_Waitall(window_size, request, reqstat));
+                    MPI_CHECK(MPI_Recv(r_buf, 4, MPI_CHAR, 1, 101, comm,
+                            &reqstat[0]));
+                    drain_send_mode();
+                }
+
+                t_end = osu_wtime();
+                t = t_end - t_start;
+                record_tune_result(setting,
+                        size / 1e6 * options.iterations * window_size / t);
+
+                if (SEND_MODE_PERSISTENT == options.send_mode) {
+                    for(j = 0; j < window_size; j++) {
+                        MPI_CHECK(MPI_Request_free(request + j));
+                    }
                 }
+            }
 
-                MPI_CHECK(MPI_Waitall(window_size, request, reqstat));
-                MPI_CHECK(MPI_Send(s_buf, 4, MPI_CHAR, 0, 101, MPI_COMM_WORLD));
+            else if(myid == 1) {
+                for(i = 0; stream_step(i, (double)size * window_size, comm); i++) {
+                    if (SEND_MODE_READY != options.send_mode) {
+                        for(j = 0; j < window_size; j++) {
+                            MPI_CHECK(MPI_Irecv(rotate_buffer(r_buf, size, i * window_size + j),
+                                    size, MPI_CHAR, 0, 100, comm, request + j));
+                        }
+                    }
+
+                    MPI_CHECK(MPI_Waitall(window_size, request, reqstat));
+
+                    if (SEND_MODE_READY == options.send_mode &&
+                            i + 1 < options.iterations + options.skip) {
+                        for(j = 0; j < window_size; j++) {
+                            MPI_CHECK(MPI_Irecv(rotate_buffer(r_buf, size, (i + 1) * window_size + j),
+                                    size, MPI_CHAR, 0, 100, comm, request + j));
+                        }
+                    }
+
+                    MPI_CHECK(MPI_Send(s_buf, 4, MPI_CHAR, 0, 101, comm));
+                }
             }
         }
 
-        if(myid == 0) {
-            double tmp = size / 1e6 * options.iterations * window_size;
+        bw = finish_tune_size(size);
+
+        stop_pvars();
+        stop_counters((options.iterations + options.skip) *
+                num_tune_settings());
 
-            fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                    FLOAT_PRECISION, tmp / t);
+        if (VALIDATE_ON == options.validate) {
+            errors = validate_pt2pt(s_buf, r_buf, size, myid);
+        }
+
+        if(myid == 0) {
+            if (STREAM_ON == options.stream) {
+                report_stream(myid, size);
+            } else if (VALIDATE_ON == options.validate) {
+                print_validated_result(size, bw, errors);
+            } else {
+                print_result(size, bw);
+            }
             fflush(stdout);
         }
+
+        mem_footprint_sample(MEM_AFTER_SIZE, size);
     }
 
+    print_tuning_table(myid);
+    mem_footprint_report(myid);
+    cleanup_pvars();
+    cleanup_counters();
+    cleanup_tuning();
+    cleanup_send_mode();
+    cleanup_stream();
+
     free_memory(s_buf, r_buf, myid);
     MPI_CHECK(MPI_Finalize());
 
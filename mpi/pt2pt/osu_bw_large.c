@@ -0,0 +1,173 @@
+#define BENCHMARK "OSU MPI Large Count Bandwidth Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * The windowed bandwidth of osu_bw for messages of 1 MB up to 8 GB, past the
+ * 2 GB that an int count can describe.  Rank 0 sends windows of -W messages
+ * to rank 1, which acknowledges every window.  Messages beyond INT_MAX bytes
+ * take the MPI-4 _c functions or a derived datatype, see --large-count, and
+ * the Count column shows which.  Each rank holds a single buffer, the ranks
+ * of a window reuse it, and the largest size is lowered to what the memory
+ * available on the nodes holds.
+ */
+
+#include <osu_util_mpi.h>
+
+#define DATA_TAG    100
+#define ACK_TAG     101
+
+int main (int argc, char *argv[])
+{
+    int myid, numprocs, i, j;
+    int po_ret = 0;
+    size_t size, limit;
+    char *buf = NULL;
+    double t_start = 0.0, t, bw;
+    MPI_Request *requests;
+
+    options.bench = PT2PT;
+    options.subtype = LARGE_COUNT;
+    options.large_count = LARGE_COUNT_AUTO;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_bw_large");
+    po_ret = process_options(argc, argv);
+    options.show_size = 0;
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    set_num_ranks(numprocs);
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &myid));
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_bad_usage_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (numprocs != 2) {
+        if (myid == 0) {
+            fprintf(stderr, "This test requires exactly two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (setup_large_count(myid)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    limit = large_count_memory_limit(MPI_COMM_WORLD, 1);
+    if (limit && options.max_message_size > limit) {
+        if (0 == myid) {
+            fprintf(stderr, "Warning! The nodes only have memory for %zu "
+                    "bytes per rank.\nContinuing with max message size of "
+                    "%zu bytes\n", limit, limit);
+        }
+        options.max_message_size = limit;
+    }
+
+    requests = malloc(sizeof(MPI_Request) * options.window_size);
+
+    if (NULL == requests || posix_memalign((void **)&buf, getpagesize(),
+                MAX(1, options.max_message_size))) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", myid);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    fill_host_buffer(buf, 0 == myid ? 'a' : 'b', options.max_message_size);
+
+    if (0 == myid && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "# Window size: %d, counts beyond %d bytes: %s\n",
+                options.window_size, INT_MAX,
+                LARGE_COUNT_C == options.large_count ? "MPI-4 _c functions" :
+                "derived datatype");
+        fprintf(stdout, "%-*s%*s%*s\n", 14, "# Size", FIELD_WIDTH,
+                "Bandwidth (MB/s)", 12, "Count");
+        fflush(stdout);
+    }
+
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+        for (i = 0; i < options.iterations + options.skip; i++) {
+            if (i == options.skip) {
+                t_start = osu_wtime();
+            }
+
+            if (0 == myid) {
+                for (j = 0; j < options.window_size; j++) {
+                    large_count_isend(buf, size, 1, DATA_TAG, MPI_COMM_WORLD,
+                            &requests[j]);
+                }
+
+                MPI_CHECK(MPI_Waitall(options.window_size, requests,
+                            MPI_STATUSES_IGNORE));
+                MPI_CHECK(MPI_Recv(buf, 0, MPI_CHAR, 1, ACK_TAG,
+                            MPI_COMM_WORLD, MPI_STATUS_IGNORE));
+            } else {
+                for (j = 0; j < options.window_size; j++) {
+                    large_count_irecv(buf, size, 0, DATA_TAG, MPI_COMM_WORLD,
+                            &requests[j]);
+                }
+
+                MPI_CHECK(MPI_Waitall(options.window_size, requests,
+                            MPI_STATUSES_IGNORE));
+                MPI_CHECK(MPI_Send(buf, 0, MPI_CHAR, 0, ACK_TAG,
+                            MPI_COMM_WORLD));
+            }
+        }
+
+        if (0 != myid) {
+            continue;
+        }
+
+        t = osu_wtime() - t_start;
+        bw = size / 1e6 * options.iterations * options.window_size / t;
+
+        if (OUTPUT_TABLE == options.output_format) {
+            fprintf(stdout, "%-*zu%*.*f%*s\n", 14, size, FIELD_WIDTH,
+                    FLOAT_PRECISION, bw, 12, large_count_path(size));
+            fflush(stdout);
+        } else {
+            struct result_metric_t metrics[2] = {
+                {"bandwidth_MBps", bw},
+                {"large_count", size > INT_MAX},
+            };
+
+            output_result(numprocs, size, 2, metrics);
+        }
+    }
+
+    free(requests);
+    free(buf);
+
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -0,0 +1,263 @@
+#define BENCHMARK "OSU MPI%s Pipeline Bandwidth Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * The windowed bandwidth of osu_bw between device buffers, for every window
+ * of WINDOW_SIZES, the sweep of osu_mbw_mr -V, so that the depth of the
+ * pipeline the MPI library stages large device messages through shows in
+ * how the bandwidth grows with the number of messages in flight.  Every
+ * window is run twice: on an idle GPU, then with the dummy compute kernel
+ * of the non-blocking collectives busying the GPU of both ranks on another
+ * stream for DEVICE_LOAD_FACTOR times the duration of the idle run.  The
+ * Loss column is the share of the idle bandwidth the busy GPU costs.  The
+ * busy run needs the benchmarks built with GPU kernel support.
+ */
+
+#include <osu_util_mpi.h>
+
+#define DATA_TAG    100
+#define ACK_TAG     101
+
+static double window_bandwidth (int myid, char * s_buf, char * r_buf,
+        size_t size, int window, double load, double * elapsed);
+
+int main (int argc, char *argv[])
+{
+    int myid, numprocs, i, loaded;
+    int po_ret = 0;
+    int window_array[] = WINDOW_SIZES;
+    size_t size;
+    char *s_buf = NULL, *r_buf = NULL;
+    double idle, busy, loss, elapsed;
+
+    options.bench = PT2PT;
+    options.subtype = GPU_PIPELINE;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_bw_pipeline");
+    po_ret = process_options(argc, argv);
+    options.src = options.dst = 'D';
+
+    if (PO_OKAY == po_ret && NONE != options.accel) {
+        if (init_accel()) {
+            fprintf(stderr, "Error initializing device\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    set_num_ranks(numprocs);
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &myid));
+
+    switch (po_ret) {
+        case PO_CUDA_NOT_AVAIL:
+            if (0 == myid) {
+                fprintf(stderr, "CUDA support not enabled.  Please recompile "
+                        "benchmark with CUDA support.\n");
+            }
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_BAD_USAGE:
+            print_bad_usage_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (CUDA != options.accel && ROCM != options.accel) {
+        if (0 == myid) {
+            fprintf(stderr, "This test requires CUDA or ROCm device buffers, "
+                    "please run it with -d cuda or -d rocm\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (numprocs != 2) {
+        if (myid == 0) {
+            fprintf(stderr, "This test requires exactly two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (options.max_message_size > options.max_mem_limit / 2) {
+        if (0 == myid) {
+            fprintf(stderr, "Warning! Increase the Max Memory Limit to be able "
+                    "to run up to %zu bytes.\nContinuing with max message size "
+                    "of %zu bytes\n", options.max_message_size,
+                    options.max_mem_limit / 2);
+        }
+        options.max_message_size = options.max_mem_limit / 2;
+    }
+
+    if (setup_affinity()) {
+        if (myid == 0) {
+            fprintf(stderr, "Could not apply the requested CPU binding\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (allocate_memory_pt2pt(&s_buf, &r_buf, myid)) {
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    loaded = 0 == setup_device_load();
+
+    if (0 == myid && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER, ROCM == options.accel ? "-ROCM" : "-CUDA");
+        if (loaded) {
+            fprintf(stdout, "# Device load: compute kernel on %d floats for "
+                    "%.1fx the idle time\n", options.device_array_size,
+                    DEVICE_LOAD_FACTOR);
+            fprintf(stdout, "%-*s%*s%*s%*s%*s\n", 10, "# Size", 8, "Window",
+                    FIELD_WIDTH, "Idle (MB/s)", FIELD_WIDTH, "Busy (MB/s)",
+                    12, "Loss (%)");
+        } else {
+            fprintf(stdout, "# Device load: not available, OMB was built "
+                    "without GPU kernel support\n");
+            fprintf(stdout, "%-*s%*s%*s\n", 10, "# Size", 8, "Window",
+                    FIELD_WIDTH, "Idle (MB/s)");
+        }
+        fflush(stdout);
+    }
+
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        set_buffer_pt2pt(s_buf, myid, options.accel, 'a', size);
+        set_buffer_pt2pt(r_buf, myid, options.accel, 'b', size);
+
+        if (size > LARGE_MESSAGE_SIZE) {
+            options.iterations = options.iterations_large;
+            options.skip = options.skip_large;
+        }
+
+        for (i = 0; i < WINDOW_SIZES_COUNT; i++) {
+            idle = window_bandwidth(myid, s_buf, r_buf, size, window_array[i],
+                    0.0, &elapsed);
+            busy = !loaded ? 0.0 : window_bandwidth(myid, s_buf, r_buf, size,
+                    window_array[i], DEVICE_LOAD_FACTOR * elapsed, &elapsed);
+
+            if (0 != myid) {
+                continue;
+            }
+
+            loss = loaded && idle > 0.0 ? 100.0 * (idle - busy) / idle : 0.0;
+
+            if (OUTPUT_TABLE == options.output_format) {
+                fprintf(stdout, "%-*zu%*d%*.*f", 10, size, 8, window_array[i],
+                        FIELD_WIDTH, FLOAT_PRECISION, idle);
+                if (loaded) {
+                    fprintf(stdout, "%*.*f%*.*f", FIELD_WIDTH,
+                            FLOAT_PRECISION, busy, 12, FLOAT_PRECISION, loss);
+                }
+                fprintf(stdout, "\n");
+                fflush(stdout);
+            } else {
+                struct result_metric_t metrics[4] = {
+                    {"window", window_array[i]},
+                    {"idle_MBps", idle},
+                    {"busy_MBps", busy},
+                    {"loss_pct", loss},
+                };
+
+                output_result(numprocs, size, loaded ? 4 : 2, metrics);
+            }
+        }
+    }
+
+    cleanup_device_load();
+    free_memory(s_buf, r_buf, myid);
+
+    MPI_CHECK(MPI_Finalize());
+
+    if (cleanup_accel()) {
+        fprintf(stderr, "Error cleaning up device\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * Bandwidth in MB/s of windows of WINDOW messages from rank 0 to rank 1, with
+ * the GPU of both ranks busy for LOAD seconds from the start if LOAD is not
+ * 0, and in ELAPSED the seconds all iterations took, on every rank
+ */
+static double window_bandwidth (int myid, char * s_buf, char * r_buf,
+        size_t size, int window, double load, double * elapsed)
+{
+    MPI_Request requests[128];
+    double t_start, t_timed = 0.0;
+    int i, j;
+
+    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+    if (load > 0.0) {
+        start_device_load(load);
+    }
+
+    t_start = osu_wtime();
+
+    for (i = 0; i < options.iterations + options.skip; i++) {
+        if (i == options.skip) {
+            t_timed = osu_wtime();
+        }
+
+        if (0 == myid) {
+            for (j = 0; j < window; j++) {
+                MPI_CHECK(MPI_Isend(s_buf, size, MPI_CHAR, 1, DATA_TAG,
+                            MPI_COMM_WORLD, &requests[j]));
+            }
+
+            MPI_CHECK(MPI_Waitall(window, requests, MPI_STATUSES_IGNORE));
+            MPI_CHECK(MPI_Recv(r_buf, 0, MPI_CHAR, 1, ACK_TAG,
+                        MPI_COMM_WORLD, MPI_STATUS_IGNORE));
+        } else {
+            for (j = 0; j < window; j++) {
+                MPI_CHECK(MPI_Irecv(r_buf, size, MPI_CHAR, 0, DATA_TAG,
+                            MPI_COMM_WORLD, &requests[j]));
+            }
+
+            MPI_CHECK(MPI_Waitall(window, requests, MPI_STATUSES_IGNORE));
+            MPI_CHECK(MPI_Send(s_buf, 0, MPI_CHAR, 0, ACK_TAG,
+                        MPI_COMM_WORLD));
+        }
+    }
+
+    t_timed = osu_wtime() - t_timed;
+    *elapsed = osu_wtime() - t_start;
+
+    if (load > 0.0) {
+        stop_device_load();
+    }
+
+    /* Both ranks launch the next load for the duration rank 0 saw */
+    MPI_CHECK(MPI_Bcast(elapsed, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD));
+
+    return size / 1e6 * options.iterations * window / t_timed;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -0,0 +1,276 @@
+#define BENCHMARK "OSU MPI%s Registration Cache Bandwidth / Latency Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * osu_bw and osu_latency send from the same buffer every time, so a library
+ * that caches memory registrations only pays for pinning once.  Here every
+ * message of a window goes to the next buffer of a working set of distinct
+ * allocations, swept over powers of two with -k, and -u frees and reallocates
+ * one of them every few iterations.  Once the working set outgrows the
+ * registration cache, or the churn invalidates its entries, the bandwidth and
+ * latency drop towards those of an uncached transfer.
+ */
+
+#include <osu_util_mpi.h>
+
+#define DATA_TAG    100
+#define ACK_TAG     101
+
+char *s_bufs[MAX_REGCACHE_BUFFERS];
+char *r_bufs[MAX_REGCACHE_BUFFERS];
+int churn_next = 0;
+
+static void churn_buffer (int myid, int buffers);
+static void report (int size, int buffers, double bw, double lat);
+
+int
+main (int argc, char *argv[])
+{
+    int myid, numprocs, i, j, k;
+    int size, buffers, peer;
+    double t_start = 0.0, t_end = 0.0, t_bw = 0.0, t_lat = 0.0;
+    int window_size;
+    int po_ret = 0;
+    options.bench = PT2PT;
+    options.subtype = REG_CACHE;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_bw_regcache");
+
+    po_ret = process_options(argc, argv);
+    window_size = options.window_size;
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    set_num_ranks(numprocs);
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &myid));
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_bad_usage_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (numprocs != 2) {
+        if (myid == 0) {
+            fprintf(stderr, "This test requires exactly two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (setup_affinity()) {
+        if (myid == 0) {
+            fprintf(stderr, "Could not apply the requested CPU binding\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    /* Every buffer of the working set holds a send and a receive buffer */
+    if ((double)options.num_buffers * 2 * options.max_message_size >
+            options.max_mem_limit) {
+        buffers = options.max_mem_limit / (2 * options.max_message_size);
+        if (buffers < 1) {
+            buffers = 1;
+        }
+
+        if (myid == 0) {
+            fprintf(stderr, "Warning! Increase the Max Memory Limit to be able "
+                    "to use %d buffers of %ld bytes.\n"
+                    "Continuing with %d buffers\n", options.num_buffers,
+                    options.max_message_size, buffers);
+        }
+        options.num_buffers = buffers;
+    }
+
+    for (k = 0; k < options.num_buffers; k++) {
+        if (allocate_memory_pt2pt(&s_bufs[k], &r_bufs[k], myid)) {
+            /* Error allocating memory */
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    peer = 1 - myid;
+
+    print_header(myid, REG_CACHE);
+    if (0 == myid && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "# Window size: %d, allocator: %s, churn: ", window_size,
+                host_allocator_name());
+        if (options.buffer_churn) {
+            fprintf(stdout, "one buffer every %d iterations\n",
+                    options.buffer_churn);
+        } else {
+            fprintf(stdout, "none\n");
+        }
+        fprintf(stdout, "%-*s%*s%*s%*s%*s\n", 10, "# Size", 10, "Buffers",
+                FIELD_WIDTH, "Working Set", FIELD_WIDTH, "Bandwidth (MB/s)",
+                FIELD_WIDTH, "Latency (us)");
+        fflush(stdout);
+    }
+
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        if (size > LARGE_MESSAGE_SIZE) {
+            options.iterations = options.iterations_large;
+            options.skip = options.skip_large;
+        }
+
+        for (buffers = 1; buffers <= options.num_buffers; buffers *= 2) {
+            for (k = 0; k < buffers; k++) {
+                set_buffer_pt2pt(s_bufs[k], myid, options.accel, 'a', size);
+                set_buffer_pt2pt(r_bufs[k], myid, options.accel, 'b', size);
+            }
+            churn_next = 0;
+
+            /* Bandwidth, one buffer of the working set per message */
+            MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+            for (i = 0; i < options.iterations + options.skip; i++) {
+                if (i == options.skip) {
+                    t_start = osu_wtime();
+                }
+
+                if (myid == 0) {
+                    for (j = 0; j < window_size; j++) {
+                        k = (i * window_size + j) % buffers;
+                        MPI_CHECK(MPI_Isend(s_bufs[k], size, MPI_CHAR, peer,
+                                    DATA_TAG, MPI_COMM_WORLD, request + j));
+                    }
+
+                    MPI_CHECK(MPI_Waitall(window_size, request, reqstat));
+                    MPI_CHECK(MPI_Recv(r_bufs[0], 4, MPI_CHAR, peer, ACK_TAG,
+                                MPI_COMM_WORLD, &reqstat[0]));
+                } else {
+                    for (j = 0; j < window_size; j++) {
+                        k = (i * window_size + j) % buffers;
+                        MPI_CHECK(MPI_Irecv(r_bufs[k], size, MPI_CHAR, peer,
+                                    DATA_TAG, MPI_COMM_WORLD, request + j));
+                    }
+
+                    MPI_CHECK(MPI_Waitall(window_size, request, reqstat));
+                    MPI_CHECK(MPI_Send(s_bufs[0], 4, MPI_CHAR, peer, ACK_TAG,
+                                MPI_COMM_WORLD));
+                }
+
+                if (options.buffer_churn &&
+                        (i + 1) % options.buffer_churn == 0) {
+                    churn_buffer(myid, buffers);
+                }
+            }
+
+            t_end = osu_wtime();
+            t_bw = t_end - t_start;
+
+            /* Ping-pong latency, one buffer of the working set per round */
+            MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+            for (i = 0; i < options.iterations + options.skip; i++) {
+                if (i == options.skip) {
+                    t_start = osu_wtime();
+                }
+
+                k = i % buffers;
+                if (myid == 0) {
+                    MPI_CHECK(MPI_Send(s_bufs[k], size, MPI_CHAR, peer,
+                                DATA_TAG, MPI_COMM_WORLD));
+                    MPI_CHECK(MPI_Recv(r_bufs[k], size, MPI_CHAR, peer,
+                                DATA_TAG, MPI_COMM_WORLD, &reqstat[0]));
+                } else {
+                    MPI_CHECK(MPI_Recv(r_bufs[k], size, MPI_CHAR, peer,
+                                DATA_TAG, MPI_COMM_WORLD, &reqstat[0]));
+                    MPI_CHECK(MPI_Send(s_bufs[k], size, MPI_CHAR, peer,
+                                DATA_TAG, MPI_COMM_WORLD));
+                }
+
+                if (options.buffer_churn &&
+                        (i + 1) % options.buffer_churn == 0) {
+                    churn_buffer(myid, buffers);
+                }
+            }
+
+            t_end = osu_wtime();
+            t_lat = t_end - t_start;
+
+            if (myid == 0) {
+                report(size, buffers,
+                        size / 1e6 * options.iterations * window_size / t_bw,
+                        t_lat * 1e6 / (2.0 * options.iterations));
+            }
+        }
+    }
+
+    for (k = 0; k < options.num_buffers; k++) {
+        free_memory(s_bufs[k], r_bufs[k], myid);
+    }
+
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * Both ranks replace the buffers round robin at the same iterations, while no
+ * request is in flight.  The new allocation may well land on the address that
+ * was just freed, which is exactly the case a registration cache has to catch
+ * through its memory hooks.
+ */
+static void churn_buffer (int myid, int buffers)
+{
+    int k = churn_next;
+
+    churn_next = (churn_next + 1) % buffers;
+
+    free_memory(s_bufs[k], r_bufs[k], myid);
+
+    if (allocate_memory_pt2pt(&s_bufs[k], &r_bufs[k], myid)) {
+        fprintf(stderr, "Error reallocating buffer %d on Rank %d\n", k, myid);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+}
+
+static void report (int size, int buffers, double bw, double lat)
+{
+    size_t working_set = (size_t)buffers * size;
+
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "%-*d%*d%*zu%*.*f%*.*f\n", 10, size, 10, buffers,
+                FIELD_WIDTH, working_set,
+                FIELD_WIDTH, FLOAT_PRECISION, bw,
+                FIELD_WIDTH, FLOAT_PRECISION, lat);
+        fflush(stdout);
+    } else {
+        struct result_metric_t metrics[4] = {
+            {"buffers", buffers},
+            {"working_set_bytes", working_set},
+            {"bandwidth_MBps", bw},
+            {"latency_us", lat},
+        };
+
+        output_result(benchmark_num_ranks, size, 4, metrics);
+    }
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
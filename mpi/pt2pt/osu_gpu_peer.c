@@ -0,0 +1,247 @@
+#define BENCHMARK "OSU MPI%s GPU Peer-to-Peer Comparison Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * MPI between the device buffers of two ranks of a node against the direct
+ * copies between their GPUs, to tell whether the library takes the fastest
+ * path or stages through the host.  The MPI latency is half the round trip
+ * of the ping-pong of osu_latency, the copies are issued by rank 0 and
+ * waited for one at a time:
+ *
+ *   MPI   MPI_Send and MPI_Recv on the buffers of -d cuda or -d rocm
+ *   Peer  cudaMemcpyPeerAsync or hipMemcpyPeerAsync to the device of rank 1
+ *   IPC   a copy into the buffer of rank 1 mapped from its IPC handle
+ *
+ * Every latency is printed with the bandwidth it gives, the message size
+ * over the latency.  The Peer column is left out when rank 0 cannot see the
+ * device of rank 1, e.g. under CUDA_VISIBLE_DEVICES.
+ */
+
+#include <osu_util_mpi.h>
+
+enum peer_column {
+    COLUMN_MPI,
+    COLUMN_PEER,
+    COLUMN_IPC,
+    COLUMN_NUM
+};
+
+static char const *latency_column[COLUMN_NUM] = {"MPI (us)", "Peer (us)",
+    "IPC (us)"};
+static char const *bandwidth_column[COLUMN_NUM] = {"MPI (MB/s)",
+    "Peer (MB/s)", "IPC (MB/s)"};
+static char const *latency_metric[COLUMN_NUM] = {"mpi_us", "peer_us",
+    "ipc_us"};
+static char const *bandwidth_metric[COLUMN_NUM] = {"mpi_MBps", "peer_MBps",
+    "ipc_MBps"};
+
+static double ping_pong (int myid, char * s_buf, char * r_buf, size_t size);
+
+int main (int argc, char *argv[])
+{
+    int myid, numprocs, i, n;
+    int po_ret = 0, active[COLUMN_NUM] = {0};
+    size_t size;
+    char *s_buf = NULL, *r_buf = NULL;
+    double latency[COLUMN_NUM];
+
+    options.bench = PT2PT;
+    options.subtype = GPU_PEER;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_gpu_peer");
+    po_ret = process_options(argc, argv);
+    options.src = options.dst = 'D';
+
+    if (PO_OKAY == po_ret && NONE != options.accel) {
+        if (init_accel()) {
+            fprintf(stderr, "Error initializing device\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    set_num_ranks(numprocs);
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &myid));
+
+    switch (po_ret) {
+        case PO_CUDA_NOT_AVAIL:
+            if (0 == myid) {
+                fprintf(stderr, "CUDA support not enabled.  Please recompile "
+                        "benchmark with CUDA support.\n");
+            }
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_BAD_USAGE:
+            print_bad_usage_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (numprocs != 2) {
+        if (myid == 0) {
+            fprintf(stderr, "This test requires exactly two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (options.max_message_size > options.max_mem_limit / 2) {
+        if (0 == myid) {
+            fprintf(stderr, "Warning! Increase the Max Memory Limit to be able "
+                    "to run up to %zu bytes.\nContinuing with max message size "
+                    "of %zu bytes\n", options.max_message_size,
+                    options.max_mem_limit / 2);
+        }
+        options.max_message_size = options.max_mem_limit / 2;
+    }
+
+    if (setup_affinity()) {
+        if (myid == 0) {
+            fprintf(stderr, "Could not apply the requested CPU binding\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (setup_peer_copy(myid, options.max_message_size)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (allocate_memory_pt2pt(&s_buf, &r_buf, myid)) {
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    active[COLUMN_MPI] = 1;
+    active[COLUMN_PEER] = peer_copy_available(PEER_COPY_PEER);
+    active[COLUMN_IPC] = peer_copy_available(PEER_COPY_IPC);
+
+    if (0 == myid && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER, ROCM == options.accel ? "-ROCM" : "-CUDA");
+        fprintf(stdout, "# Peer access between the devices: %s\n",
+                !active[COLUMN_PEER] ? "unknown, device of rank 1 not "
+                "visible" : peer_access_enabled() ? "enabled" :
+                "not supported, copies staged through the host");
+        fprintf(stdout, "%-*s", 10, "# Size");
+        for (i = 0; i < COLUMN_NUM; i++) {
+            if (active[i]) {
+                fprintf(stdout, "%*s%*s", FIELD_WIDTH, latency_column[i],
+                        FIELD_WIDTH, bandwidth_column[i]);
+            }
+        }
+        fprintf(stdout, "\n");
+        fflush(stdout);
+    }
+
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        set_buffer_pt2pt(s_buf, myid, options.accel, 'a', size);
+        set_buffer_pt2pt(r_buf, myid, options.accel, 'b', size);
+
+        if (size > LARGE_MESSAGE_SIZE) {
+            options.iterations = options.iterations_large;
+            options.skip = options.skip_large;
+        }
+
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+        latency[COLUMN_MPI] = ping_pong(myid, s_buf, r_buf, size);
+
+        if (0 != myid) {
+            continue;
+        }
+
+        for (i = COLUMN_PEER; i < COLUMN_NUM; i++) {
+            latency[i] = active[i] ? time_peer_copy(COLUMN_PEER == i ?
+                    PEER_COPY_PEER : PEER_COPY_IPC, s_buf, size) : 0.0;
+        }
+
+        if (OUTPUT_TABLE == options.output_format) {
+            fprintf(stdout, "%-*zu", 10, size);
+            for (i = 0; i < COLUMN_NUM; i++) {
+                if (active[i]) {
+                    fprintf(stdout, "%*.*f%*.*f", FIELD_WIDTH,
+                            FLOAT_PRECISION, latency[i], FIELD_WIDTH,
+                            FLOAT_PRECISION, size / latency[i]);
+                }
+            }
+            fprintf(stdout, "\n");
+            fflush(stdout);
+        } else {
+            struct result_metric_t metrics[2 * COLUMN_NUM];
+
+            for (i = n = 0; i < COLUMN_NUM; i++) {
+                if (active[i]) {
+                    metrics[n].name = latency_metric[i];
+                    metrics[n++].value = latency[i];
+                    metrics[n].name = bandwidth_metric[i];
+                    metrics[n++].value = size / latency[i];
+                }
+            }
+
+            output_result(numprocs, size, n, metrics);
+        }
+    }
+
+    free_peer_copy(myid);
+    free_memory(s_buf, r_buf, myid);
+
+    MPI_CHECK(MPI_Finalize());
+
+    if (cleanup_accel()) {
+        fprintf(stderr, "Error cleaning up device\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/* Half the round trip in microseconds, on rank 0 */
+static double ping_pong (int myid, char * s_buf, char * r_buf, size_t size)
+{
+    double t_start = 0.0;
+    int i, peer = 1 - myid;
+
+    for (i = 0; i < options.iterations + options.skip; i++) {
+        if (i == options.skip) {
+            t_start = osu_wtime();
+        }
+
+        if (0 == myid) {
+            MPI_CHECK(MPI_Send(s_buf, size, MPI_CHAR, peer, 1,
+                        MPI_COMM_WORLD));
+            MPI_CHECK(MPI_Recv(r_buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD,
+                        MPI_STATUS_IGNORE));
+        } else {
+            MPI_CHECK(MPI_Recv(r_buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD,
+                        MPI_STATUS_IGNORE));
+            MPI_CHECK(MPI_Send(s_buf, size, MPI_CHAR, peer, 1,
+                        MPI_COMM_WORLD));
+        }
+    }
+
+    return (osu_wtime() - t_start) * 1e6 / (2.0 * options.iterations);
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
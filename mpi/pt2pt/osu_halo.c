@@ -0,0 +1,470 @@
+#define BENCHMARK "OSU MPI%s Halo Exchange Packing Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * Every rank owns an N^DIMS block of doubles of a non-periodic grid and
+ * exchanges its faces with the face neighbors, -E face[:DIMS].  The face
+ * normal to dimension i is N^(DIMS-1-i) blocks of N^i contiguous elements, so
+ * the faces range from fully strided to contiguous.  They are sent three
+ * ways: straight from the grid with vector datatypes, packed by hand into
+ * contiguous buffers, and packed with MPI_Pack.  For the two packing schemes
+ * the time spent packing and unpacking is reported apart from the time on
+ * the wire.
+ */
+
+#include <osu_util_mpi.h>
+
+#define MAX_FACES   (2 * MAX_STENCIL_DIMS)
+
+struct face_t {
+    int neighbor;
+    int send_tag;
+    int recv_tag;
+    size_t offset;
+};
+
+static struct face_t faces[MAX_FACES];
+static MPI_Datatype face_type[MAX_STENCIL_DIMS];
+static int face_count[MAX_STENCIL_DIMS], face_block[MAX_STENCIL_DIMS];
+static int face_stride[MAX_STENCIL_DIMS];
+static int ndims, face_elems;
+
+static double *grid, *ghost;
+static double *send_faces[MAX_FACES], *recv_faces[MAX_FACES];
+static MPI_Request requests[2 * MAX_FACES];
+
+static void setup_faces (MPI_Comm comm, int edge);
+static void free_faces (void);
+static double exchange_derived (MPI_Comm comm);
+static double exchange_manual (MPI_Comm comm, double * pack_time);
+static double exchange_mpi_pack (MPI_Comm comm, double * pack_time);
+static void report (int numprocs, int edge, double derived, double manual_pack,
+        double manual_wire, double mpi_pack, double mpi_pack_wire);
+
+int
+main (int argc, char *argv[])
+{
+    int rank, numprocs, i, f, size, edge, last_edge = 0, max_edge;
+    double manual_pack, mpi_pack;
+    double t_derived, t_manual, t_manual_pack, t_mpi, t_mpi_pack;
+    size_t grid_bytes;
+    MPI_Comm comm;
+    int po_ret = 0;
+    options.bench = PT2PT;
+    options.subtype = HALO;
+    options.stencil = STENCIL_FACE;
+    options.stencil_dims = DEF_STENCIL_DIMS;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_halo");
+
+    po_ret = process_options(argc, argv);
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    set_num_ranks(numprocs);
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_bad_usage_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(rank);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (numprocs < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (STENCIL_FACE != options.stencil) {
+        if (rank == 0) {
+            fprintf(stderr, "This test only exchanges the faces of a "
+                    "Cartesian grid (-E face[:DIMS])\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (setup_affinity()) {
+        if (rank == 0) {
+            fprintf(stderr, "Could not apply the requested CPU binding\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    comm = setup_stencil();
+    ndims = options.stencil_dims;
+
+    /* A face of the largest grid that fits twice, with its faces, into -M */
+    max_edge = (1 == ndims) ? 2 : (int)pow(options.max_message_size /
+            (double)sizeof(double), 1.0 / (ndims - 1));
+    while (max_edge > 2 && 2.0 * (pow(max_edge, ndims) + 4.0 * ndims *
+                pow(max_edge, ndims - 1)) * sizeof(double) >
+            options.max_mem_limit) {
+        max_edge--;
+    }
+
+    grid_bytes = sizeof(double) * (size_t)pow(max_edge, ndims);
+
+    if (allocate_host_buffer((void **)&grid, grid_bytes) ||
+            allocate_host_buffer((void **)&ghost, grid_bytes)) {
+        fprintf(stderr, "Error allocating memory on Rank %d\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    for (f = 0; f < 2 * ndims; f++) {
+        if (allocate_host_buffer((void **)&send_faces[f],
+                    grid_bytes / max_edge) ||
+                allocate_host_buffer((void **)&recv_faces[f],
+                    grid_bytes / max_edge)) {
+            fprintf(stderr, "Error allocating memory on Rank %d\n", rank);
+            MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+        }
+    }
+
+    if (bind_memory(grid, grid_bytes) || bind_memory(ghost, grid_bytes)) {
+        fprintf(stderr, "Error binding memory to NUMA node %d on Rank %d\n",
+                options.mem_node, rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    for (i = 0; i < (int)(grid_bytes / sizeof(double)); i++) {
+        grid[i] = rank + i * 1e-6;
+        ghost[i] = 0.0;
+    }
+
+    print_header(rank, HALO);
+    if (0 == rank && OUTPUT_TABLE == options.output_format) {
+        print_stencil_summary();
+        fprintf(stdout, "# Size is the bytes of a face, Edge the side of the "
+                "grid of doubles on each rank\n");
+        fprintf(stdout, "%-*s%*s%*s%*s%*s%*s%*s\n", 10, "# Size", 10, "Edge",
+                FIELD_WIDTH, "Derived(us)", FIELD_WIDTH, "Manual Pack(us)",
+                FIELD_WIDTH, "Manual Wire(us)", FIELD_WIDTH, "MPI_Pack(us)",
+                FIELD_WIDTH, "MPI_Pack Wire(us)");
+        fflush(stdout);
+    }
+
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        edge = (1 == ndims) ? 2 : (int)(pow(size / (double)sizeof(double),
+                    1.0 / (ndims - 1)) + 0.5);
+
+        /* Neighboring sizes can round to the same grid */
+        if (edge < 2 || edge == last_edge || edge > max_edge) {
+            continue;
+        }
+        last_edge = edge;
+
+        if (size > LARGE_MESSAGE_SIZE) {
+            options.iterations = options.iterations_large;
+            options.skip = options.skip_large;
+        }
+
+        setup_faces(comm, edge);
+
+        t_derived = t_manual = t_manual_pack = t_mpi = t_mpi_pack = 0.0;
+
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+        for (i = 0; i < options.iterations + options.skip; i++) {
+            double t = exchange_derived(comm);
+
+            if (i >= options.skip) {
+                t_derived += t;
+            }
+            MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+        }
+
+        for (i = 0; i < options.iterations + options.skip; i++) {
+            double t = exchange_manual(comm, &manual_pack);
+
+            if (i >= options.skip) {
+                t_manual += t;
+                t_manual_pack += manual_pack;
+            }
+            MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+        }
+
+        for (i = 0; i < options.iterations + options.skip; i++) {
+            double t = exchange_mpi_pack(comm, &mpi_pack);
+
+            if (i >= options.skip) {
+                t_mpi += t;
+                t_mpi_pack += mpi_pack;
+            }
+            MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+        }
+
+        free_faces();
+
+        report(numprocs, edge, t_derived, t_manual_pack,
+                t_manual - t_manual_pack, t_mpi_pack, t_mpi - t_mpi_pack);
+    }
+
+    for (f = 0; f < 2 * ndims; f++) {
+        free_host_buffer(send_faces[f]);
+        free_host_buffer(recv_faces[f]);
+    }
+    free_host_buffer(grid);
+    free_host_buffer(ghost);
+    cleanup_stencil();
+
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * Face 2i is the low and face 2i + 1 the high face normal to dimension i.
+ * A rank receives from its low neighbor what that neighbor sent from its
+ * high face, hence the swapped tags.
+ */
+static void setup_faces (MPI_Comm comm, int edge)
+{
+    int i, low, high, block = 1;
+
+    face_elems = 1;
+    for (i = 1; i < ndims; i++) {
+        face_elems *= edge;
+    }
+
+    for (i = 0; i < ndims; i++) {
+        face_block[i] = block;
+        face_stride[i] = block * edge;
+        face_count[i] = face_elems / block;
+
+        MPI_CHECK(MPI_Type_vector(face_count[i], face_block[i],
+                    face_stride[i], MPI_DOUBLE, &face_type[i]));
+        MPI_CHECK(MPI_Type_commit(&face_type[i]));
+
+        MPI_CHECK(MPI_Cart_shift(comm, i, 1, &low, &high));
+
+        faces[2 * i] = (struct face_t){low, 2 * i, 2 * i + 1, 0};
+        faces[2 * i + 1] = (struct face_t){high, 2 * i + 1, 2 * i,
+            (size_t)(edge - 1) * block};
+
+        block *= edge;
+    }
+}
+
+static void free_faces (void)
+{
+    int i;
+
+    for (i = 0; i < ndims; i++) {
+        MPI_CHECK(MPI_Type_free(&face_type[i]));
+    }
+}
+
+/*
+ * Gathers COUNT blocks of BLOCK doubles STRIDE apart.  Single elements get a
+ * plain strided loop and longer blocks a copy each, both of which the
+ * compiler vectorizes as the buffers cannot alias.
+ */
+static void pack_face (double * restrict dst, double const * restrict src,
+        int count, int block, int stride)
+{
+    int k;
+
+    if (1 == block) {
+        for (k = 0; k < count; k++) {
+            dst[k] = src[(size_t)k * stride];
+        }
+    } else {
+        for (k = 0; k < count; k++) {
+            memcpy(dst + (size_t)k * block, src + (size_t)k * stride,
+                    block * sizeof(double));
+        }
+    }
+}
+
+static void unpack_face (double * restrict dst, double const * restrict src,
+        int count, int block, int stride)
+{
+    int k;
+
+    if (1 == block) {
+        for (k = 0; k < count; k++) {
+            dst[(size_t)k * stride] = src[k];
+        }
+    } else {
+        for (k = 0; k < count; k++) {
+            memcpy(dst + (size_t)k * stride, src + (size_t)k * block,
+                    block * sizeof(double));
+        }
+    }
+}
+
+static double exchange_derived (MPI_Comm comm)
+{
+    double t_start = osu_wtime();
+    int f, n = 2 * ndims;
+
+    for (f = 0; f < n; f++) {
+        MPI_CHECK(MPI_Irecv(ghost + faces[f].offset, 1, face_type[f / 2],
+                    faces[f].neighbor, faces[f].recv_tag, comm, &requests[f]));
+    }
+    for (f = 0; f < n; f++) {
+        MPI_CHECK(MPI_Isend(grid + faces[f].offset, 1, face_type[f / 2],
+                    faces[f].neighbor, faces[f].send_tag, comm,
+                    &requests[n + f]));
+    }
+    MPI_CHECK(MPI_Waitall(2 * n, requests, MPI_STATUSES_IGNORE));
+
+    return osu_wtime() - t_start;
+}
+
+/* Faces without a neighbor are neither packed nor unpacked */
+static double exchange_manual (MPI_Comm comm, double * pack_time)
+{
+    double t_start = osu_wtime(), t_pack, t_wire;
+    int f, d, n = 2 * ndims;
+
+    for (f = 0; f < n; f++) {
+        MPI_CHECK(MPI_Irecv(recv_faces[f], face_elems, MPI_DOUBLE,
+                    faces[f].neighbor, faces[f].recv_tag, comm, &requests[f]));
+    }
+
+    t_pack = osu_wtime();
+    for (f = 0; f < n; f++) {
+        d = f / 2;
+        if (MPI_PROC_NULL != faces[f].neighbor) {
+            pack_face(send_faces[f], grid + faces[f].offset, face_count[d],
+                    face_block[d], face_stride[d]);
+        }
+    }
+    t_pack = osu_wtime() - t_pack;
+
+    for (f = 0; f < n; f++) {
+        MPI_CHECK(MPI_Isend(send_faces[f], face_elems, MPI_DOUBLE,
+                    faces[f].neighbor, faces[f].send_tag, comm,
+                    &requests[n + f]));
+    }
+    MPI_CHECK(MPI_Waitall(2 * n, requests, MPI_STATUSES_IGNORE));
+
+    t_wire = osu_wtime();
+    for (f = 0; f < n; f++) {
+        d = f / 2;
+        if (MPI_PROC_NULL != faces[f].neighbor) {
+            unpack_face(ghost + faces[f].offset, recv_faces[f], face_count[d],
+                    face_block[d], face_stride[d]);
+        }
+    }
+    *pack_time = t_pack + osu_wtime() - t_wire;
+
+    return osu_wtime() - t_start;
+}
+
+static double exchange_mpi_pack (MPI_Comm comm, double * pack_time)
+{
+    double t_start = osu_wtime(), t_pack, t_wire;
+    int f, n = 2 * ndims, bytes, position;
+
+    MPI_CHECK(MPI_Pack_size(1, face_type[0], comm, &bytes));
+
+    for (f = 0; f < n; f++) {
+        MPI_CHECK(MPI_Irecv(recv_faces[f], bytes, MPI_PACKED,
+                    faces[f].neighbor, faces[f].recv_tag, comm, &requests[f]));
+    }
+
+    t_pack = osu_wtime();
+    for (f = 0; f < n; f++) {
+        if (MPI_PROC_NULL != faces[f].neighbor) {
+            position = 0;
+            MPI_CHECK(MPI_Pack(grid + faces[f].offset, 1, face_type[f / 2],
+                        send_faces[f], bytes, &position, comm));
+        }
+    }
+    t_pack = osu_wtime() - t_pack;
+
+    for (f = 0; f < n; f++) {
+        MPI_CHECK(MPI_Isend(send_faces[f], bytes, MPI_PACKED,
+                    faces[f].neighbor, faces[f].send_tag, comm,
+                    &requests[n + f]));
+    }
+    MPI_CHECK(MPI_Waitall(2 * n, requests, MPI_STATUSES_IGNORE));
+
+    t_wire = osu_wtime();
+    for (f = 0; f < n; f++) {
+        if (MPI_PROC_NULL != faces[f].neighbor) {
+            position = 0;
+            MPI_CHECK(MPI_Unpack(recv_faces[f], bytes, &position,
+                        ghost + faces[f].offset, 1, face_type[f / 2], comm));
+        }
+    }
+    *pack_time = t_pack + osu_wtime() - t_wire;
+
+    return osu_wtime() - t_start;
+}
+
+/* Times are summed over the timed iterations and averaged over the ranks */
+static void report (int numprocs, int edge, double derived, double manual_pack,
+        double manual_wire, double mpi_pack, double mpi_pack_wire)
+{
+    double times[5] = {derived, manual_pack, manual_wire, mpi_pack,
+        mpi_pack_wire};
+    size_t size = face_elems * sizeof(double);
+    int rank, k;
+
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Reduce(rank ? times : MPI_IN_PLACE, times, 5, MPI_DOUBLE,
+                MPI_SUM, 0, MPI_COMM_WORLD));
+
+    if (rank) {
+        return;
+    }
+
+    for (k = 0; k < 5; k++) {
+        times[k] = times[k] * 1e6 / options.iterations / numprocs;
+    }
+
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "%-*zu%*d%*.*f%*.*f%*.*f%*.*f%*.*f\n", 10, size,
+                10, edge,
+                FIELD_WIDTH, FLOAT_PRECISION, times[0],
+                FIELD_WIDTH, FLOAT_PRECISION, times[1],
+                FIELD_WIDTH, FLOAT_PRECISION, times[2],
+                FIELD_WIDTH, FLOAT_PRECISION, times[3],
+                FIELD_WIDTH, FLOAT_PRECISION, times[4]);
+        fflush(stdout);
+    } else {
+        struct result_metric_t metrics[6] = {
+            {"edge", edge},
+            {"derived_us", times[0]},
+            {"manual_pack_us", times[1]},
+            {"manual_wire_us", times[2]},
+            {"mpi_pack_us", times[3]},
+            {"mpi_pack_wire_us", times[4]},
+        };
+
+        output_result(benchmark_num_ranks, size, 6, metrics);
+    }
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -10,17 +10,40 @@
  */
 #include <osu_util_mpi.h>
 
+/*
+ * The timed loops of --loop.  Each runs the warmup and timed iterations of
+ * one message size and returns the seconds of the timed ones on rank 0.
+ */
+typedef double (*latency_loop_t) (char *s_buf, char *r_buf, int size,
+        int myid);
+
+static double generic_loop (char *s_buf, char *r_buf, int size, int myid);
+static double fast_loop (char *s_buf, char *r_buf, int size, int myid);
+static double null_loop (char *s_buf, char *r_buf, int size, int myid);
+
+static MPI_Request send_req = MPI_REQUEST_NULL, recv_req;
+static int mark;
+static volatile int null_iteration;
+
 int
 main (int argc, char *argv[])
 {
-    int myid, numprocs, i;
+    int myid, numprocs;
     int size;
-    MPI_Status reqstat;
     char *s_buf, *r_buf;
-    double t_start = 0.0, t_end = 0.0;
+    double elapsed;
     int po_ret = 0;
+    size_t errors = 0;
+    latency_loop_t timed_loop;
     options.bench = PT2PT;
     options.subtype = LAT;
+    options.validate = VALIDATE_OFF;
+    options.mem_footprint = MEM_FOOTPRINT_OFF;
+    options.pvars = PVARS_OFF;
+    options.counters = COUNTERS_OFF;
+    options.global_clock = GLOBAL_CLOCK_OFF;
+    options.send_mode = SEND_MODE_STANDARD;
+    options.loop = LOOP_AUTO;
 
     set_header(HEADER);
     set_benchmark_name("osu_latency");
@@ -34,8 +57,11 @@ main (int argc, char *argv[])
         }
     }
 
+    mem_footprint_sample(MEM_BEFORE_INIT, 0);
     MPI_CHECK(MPI_Init(&argc, &argv));
+    mem_footprint_sample(MEM_AFTER_INIT, 0);
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    set_num_ranks(numprocs);
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &myid));
 
     if (0 == myid) {
@@ -86,56 +112,129 @@ main (int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
+    if (setup_affinity()) {
+        if (myid == 0) {
+            fprintf(stderr, "Could not apply the requested CPU binding\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
     if (allocate_memory_pt2pt(&s_buf, &r_buf, myid)) {
         /* Error allocating memory */
         MPI_CHECK(MPI_Finalize());
         exit(EXIT_FAILURE);
     }
 
+    mem_footprint_sample(MEM_AFTER_ALLOC, 0);
+
+    if (setup_pvars(myid)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(PVARS_LIST == options.pvars ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    if (setup_counters(myid)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (setup_global_clock(myid)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (setup_send_mode(myid, options.max_message_size, 1)) {
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    mark = GLOBAL_CLOCK_ON == options.global_clock;
+
+    switch (options.loop) {
+        case LOOP_FAST:
+            timed_loop = fast_loop;
+            break;
+        case LOOP_NULL:
+            /* Keep the harness overhead apart from latencies in records */
+            set_benchmark_name("osu_latency-null");
+            timed_loop = null_loop;
+            break;
+        default:
+            timed_loop = generic_loop;
+            break;
+    }
+
     print_header(myid, LAT);
 
     
     /* Latency test */
-    for(size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : 1)) {
-        set_buffer_pt2pt(s_buf, myid, options.accel, 'a', size);
-        set_buffer_pt2pt(r_buf, myid, options.accel, 'b', size);
+    for(size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
+        if (LOOP_GENERIC == options.loop) {
+            set_buffer_pt2pt(s_buf, myid, options.accel, 'a', size);
+            set_buffer_pt2pt(r_buf, myid, options.accel, 'b', size);
+        } else {
+            fill_host_buffer(s_buf, 'a', size);
+            fill_host_buffer(r_buf, 'b', size);
+        }
 
         if(size > LARGE_MESSAGE_SIZE) {
             options.iterations = options.iterations_large;
             options.skip = options.skip_large;
         }
 
-        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+        if (SEND_MODE_PERSISTENT == options.send_mode) {
+            MPI_CHECK(MPI_Send_init(s_buf, size, MPI_CHAR, 1 - myid, 1,
+                        MPI_COMM_WORLD, &send_req));
+        }
 
-        if(myid == 0) {
-            for(i = 0; i < options.iterations + options.skip; i++) {
-                if(i == options.skip) {
-                    t_start = MPI_Wtime();
-                }
+        /*
+         * MPI_Rsend needs the receive posted, so in ready mode every rank
+         * posts its next receive before it sends
+         */
+        if (SEND_MODE_READY == options.send_mode && 1 == myid) {
+            MPI_CHECK(MPI_Irecv(r_buf, size, MPI_CHAR, 0, 1, MPI_COMM_WORLD,
+                        &recv_req));
+        }
 
-                MPI_CHECK(MPI_Send(s_buf, size, MPI_CHAR, 1, 1, MPI_COMM_WORLD));
-                MPI_CHECK(MPI_Recv(r_buf, size, MPI_CHAR, 1, 1, MPI_COMM_WORLD, &reqstat));
-            }
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+        start_global_clock();
+        start_pvars();
+        start_counters();
+
+        elapsed = timed_loop(s_buf, r_buf, size, myid);
 
-            t_end = MPI_Wtime();
+        if (SEND_MODE_PERSISTENT == options.send_mode) {
+            MPI_CHECK(MPI_Request_free(&send_req));
         }
 
-        else if(myid == 1) {
-            for(i = 0; i < options.iterations + options.skip; i++) {
-                MPI_CHECK(MPI_Recv(r_buf, size, MPI_CHAR, 0, 1, MPI_COMM_WORLD, &reqstat));
-                MPI_CHECK(MPI_Send(s_buf, size, MPI_CHAR, 0, 1, MPI_COMM_WORLD));
-            }
+        stop_pvars();
+        stop_counters(options.iterations + options.skip);
+        stop_global_clock(options.iterations);
+
+        if (VALIDATE_ON == options.validate) {
+            errors = validate_pt2pt(s_buf, r_buf, size, myid);
         }
 
         if(myid == 0) {
-            double latency = (t_end - t_start) * 1e6 / (2.0 * options.iterations);
+            double latency = elapsed * 1e6 / (2.0 * options.iterations);
 
-            fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                    FLOAT_PRECISION, latency);
+            if (VALIDATE_ON == options.validate) {
+                print_validated_result(size, latency, errors);
+            } else {
+                print_result(size, latency);
+            }
             fflush(stdout);
         }
+
+        mem_footprint_sample(MEM_AFTER_SIZE, size);
     }
 
+    mem_footprint_report(myid);
+    cleanup_pvars();
+    cleanup_counters();
+    cleanup_global_clock();
+    cleanup_send_mode();
+
     free_memory(s_buf, r_buf, myid);
     MPI_CHECK(MPI_Finalize());
 
@@ -149,3 +248,122 @@ main (int argc, char *argv[])
     return EXIT_SUCCESS;
 }
 
+/* Every option of the benchmark: send modes, global clock marks, devices */
+static double generic_loop (char *s_buf, char *r_buf, int size, int myid)
+{
+    MPI_Status reqstat;
+    double t_start = 0.0, t_end = 0.0;
+    int i;
+
+    if(myid == 0) {
+        for(i = 0; i < options.iterations + options.skip; i++) {
+            if(i == options.skip) {
+                t_start = osu_wtime();
+            }
+
+            if (mark && i >= options.skip) {
+                mark_global_time(GT_SEND, 0);
+            }
+
+            if (SEND_MODE_READY == options.send_mode) {
+                MPI_CHECK(MPI_Irecv(r_buf, size, MPI_CHAR, 1, 1,
+                            MPI_COMM_WORLD, &recv_req));
+                mode_send(s_buf, size, MPI_CHAR, 1, 1, MPI_COMM_WORLD,
+                        &send_req);
+                MPI_CHECK(MPI_Wait(&recv_req, &reqstat));
+            } else {
+                mode_send(s_buf, size, MPI_CHAR, 1, 1, MPI_COMM_WORLD,
+                        &send_req);
+                MPI_CHECK(MPI_Recv(r_buf, size, MPI_CHAR, 1, 1, MPI_COMM_WORLD, &reqstat));
+            }
+
+            if (mark && i >= options.skip) {
+                mark_global_time(GT_RECV, 0);
+            }
+        }
+
+        t_end = osu_wtime();
+    }
+
+    else if(myid == 1) {
+        for(i = 0; i < options.iterations + options.skip; i++) {
+            if (SEND_MODE_READY == options.send_mode) {
+                MPI_CHECK(MPI_Wait(&recv_req, &reqstat));
+                if (i + 1 < options.iterations + options.skip) {
+                    MPI_CHECK(MPI_Irecv(r_buf, size, MPI_CHAR, 0, 1,
+                                MPI_COMM_WORLD, &recv_req));
+                }
+            } else {
+                MPI_CHECK(MPI_Recv(r_buf, size, MPI_CHAR, 0, 1, MPI_COMM_WORLD, &reqstat));
+            }
+
+            if (mark && i >= options.skip) {
+                mark_global_time(GT_RECV, 0);
+                mark_global_time(GT_SEND, 0);
+            }
+
+            mode_send(s_buf, size, MPI_CHAR, 0, 1, MPI_COMM_WORLD,
+                    &send_req);
+        }
+    }
+
+    return t_end - t_start;
+}
+
+/*
+ * Host buffers, MPI_Send/MPI_Recv and a fixed tag with nothing else between
+ * the messages.  MPI_COMM_WORLD aborts on errors, so the return codes are
+ * not checked either.
+ */
+static double fast_loop (char *s_buf, char *r_buf, int size, int myid)
+{
+    int const peer = 1 - myid, skip = options.skip;
+    int const total = options.iterations + options.skip;
+    double t_start = 0.0;
+    int i;
+
+    if (0 != myid) {
+        for (i = 0; i < total; i++) {
+            MPI_Recv(r_buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD,
+                    MPI_STATUS_IGNORE);
+            MPI_Send(s_buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD);
+        }
+
+        return 0.0;
+    }
+
+    for (i = 0; i < total; i++) {
+        if (i == skip) {
+            t_start = osu_wtime();
+        }
+
+        MPI_Send(s_buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD);
+        MPI_Recv(r_buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD,
+                MPI_STATUS_IGNORE);
+    }
+
+    return osu_wtime() - t_start;
+}
+
+/*
+ * The loop of fast_loop() without the messages: what the harness itself
+ * adds to every iteration.  The store to the volatile null_iteration keeps
+ * the compiler from removing the loop.
+ */
+static double null_loop (char *s_buf, char *r_buf, int size, int myid)
+{
+    int const skip = options.skip;
+    int const total = options.iterations + options.skip;
+    double t_start = 0.0;
+    int i;
+
+    for (i = 0; i < total; i++) {
+        if (i == skip) {
+            t_start = osu_wtime();
+        }
+
+        null_iteration = i;
+    }
+
+    return 0 == myid ? osu_wtime() - t_start : 0.0;
+}
@@ -8,6 +8,15 @@
  * For detailed copyright and licensing information, please refer to the
  * copyright file COPYRIGHT in the top level OMB directory.
  */
+
+/*
+ * Ping-pong of one element of a derived datatype, built with the vector,
+ * indexed, subarray or struct constructor (-Q) over the same blocks.  Every
+ * size is timed a second time with the application packing the blocks itself
+ * into a contiguous buffer, on the device when the buffers are (-d), which
+ * shows how much of the latency is the library's datatype engine.
+ */
+
 #include <osu_util_mpi.h>
 
 int
@@ -17,11 +26,11 @@ main (int argc, char *argv[])
     int size;
     MPI_Request request;
     MPI_Status reqstat;
-    char *s_buf, *r_buf;
-    double t_start = 0.0, t_end = 0.0;
+    char *s_buf, *r_buf, *p_buf;
+    char buf_type;
+    double t_start = 0.0, t_end = 0.0, t_pack = 0.0;
     int po_ret = 0;
-    int rep_count;
-    int lengs[MAX_DT_REPEAT_COUNT], disps[MAX_DT_REPEAT_COUNT];
+    int rep_count, packed;
     MPI_Datatype type;
     options.bench = PT2PT;
     options.subtype = LAT_DT;
@@ -56,6 +65,7 @@ main (int argc, char *argv[])
 
     MPI_CHECK(MPI_Init(&argc, &argv));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    set_num_ranks(numprocs);
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &myid));
 
     if (0 == myid) {
@@ -106,7 +116,19 @@ main (int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
-    if (allocate_memory_pt2pt(&s_buf, &r_buf, myid)) {
+    if (setup_affinity()) {
+        if (myid == 0) {
+            fprintf(stderr, "Could not apply the requested CPU binding\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    buf_type = (myid == 0) ? options.src : options.dst;
+
+    if (allocate_memory_pt2pt(&s_buf, &r_buf, myid) ||
+            allocate_dt_pack_buffer(&p_buf, buf_type)) {
         /* Error allocating memory */
         MPI_CHECK(MPI_Finalize());
         exit(EXIT_FAILURE);
@@ -115,7 +137,7 @@ main (int argc, char *argv[])
     print_header(myid, LAT);
 
     /* Latency test */
-    for(size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+    for(size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         set_buffer_pt2pt(s_buf, myid, options.accel, 'a', size);
         set_buffer_pt2pt(r_buf, myid, options.accel, 'b', size);
 
@@ -125,32 +147,15 @@ main (int argc, char *argv[])
         }
 
         /* Define DDT */
-        rep_count = size / options.dt_block_size;
-        //fprintf(stderr, "rank %d, size %d, block_size %d, rep_count %d\n", myid, size, options.dt_block_size, rep_count);
-        if (options.dt_increase_size == 0) {
-            /* Vector */
-            MPI_CHECK(MPI_Type_vector(rep_count, options.dt_block_size, options.dt_stride_size, MPI_CHAR, &type));
-        } else {
-            /* Indexed */
-            for (i = 0; i < rep_count; i++) {
-                lengs[i] = options.dt_block_size;
-                if (i == 0) {
-                    disps[i] = 0;
-                } else {
-                    disps[i] = disps[i-1] + options.dt_stride_size + (i - 1) * options.dt_increase_size;
-                    //fprintf(stderr, "rank %d, size %d, block_size %d, rep_count %d, length %d, displacement %d\n", myid, size, options.dt_block_size, rep_count, lengs[i], disps[i]);
-                }
-            }
-            MPI_CHECK(MPI_Type_indexed(rep_count, lengs, disps, MPI_CHAR, &type));
-        }
-        MPI_CHECK(MPI_Type_commit(&type));
+        rep_count = create_dt_type(size, &type);
+        packed = rep_count * options.dt_block_size;
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
         if(myid == 0) {
             for(i = 0; i < options.iterations + options.skip; i++) {
                 if(i == options.skip) {
-                    t_start = MPI_Wtime();
+                    t_start = osu_wtime();
                 }
 
                 MPI_CHECK(MPI_Isend(s_buf, 1, type, 1, 1, MPI_COMM_WORLD, &request));
@@ -159,7 +164,7 @@ main (int argc, char *argv[])
                 MPI_CHECK(MPI_Wait(&request, &reqstat));
             }
 
-            t_end = MPI_Wtime();
+            t_end = osu_wtime();
         }
 
         else if(myid == 1) {
@@ -173,20 +178,68 @@ main (int argc, char *argv[])
 
         MPI_CHECK(MPI_Type_free(&type));
 
+        /* Same blocks, packed by the application */
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
         if(myid == 0) {
-            double latency = (t_end - t_start) * 1e6 / (2.0 * options.iterations);
+            for(i = 0; i < options.iterations + options.skip; i++) {
+                if(i == options.skip) {
+                    t_pack = osu_wtime();
+                }
+
+                dt_pack(p_buf, s_buf, rep_count, buf_type, 0);
+                MPI_CHECK(MPI_Isend(p_buf, packed, MPI_CHAR, 1, 1, MPI_COMM_WORLD, &request));
+                MPI_CHECK(MPI_Wait(&request, &reqstat));
+                MPI_CHECK(MPI_Irecv(p_buf, packed, MPI_CHAR, 1, 1, MPI_COMM_WORLD, &request));
+                MPI_CHECK(MPI_Wait(&request, &reqstat));
+                dt_pack(p_buf, r_buf, rep_count, buf_type, 1);
+            }
+
+            t_pack = osu_wtime() - t_pack;
+        }
+
+        else if(myid == 1) {
+            for(i = 0; i < options.iterations + options.skip; i++) {
+                MPI_CHECK(MPI_Irecv(p_buf, packed, MPI_CHAR, 0, 1, MPI_COMM_WORLD, &request));
+                MPI_CHECK(MPI_Wait(&request, &reqstat));
+                dt_pack(p_buf, r_buf, rep_count, buf_type, 1);
+                dt_pack(p_buf, s_buf, rep_count, buf_type, 0);
+                MPI_CHECK(MPI_Isend(p_buf, packed, MPI_CHAR, 0, 1, MPI_COMM_WORLD, &request));
+                MPI_CHECK(MPI_Wait(&request, &reqstat));
+            }
+        }
 
-            fprintf(stdout, "%-*d%-*d%-*d%-*d%*.*f\n",
-                    10, size,
-                    10, options.dt_block_size,
-                    10, options.dt_stride_size,
-                    10, options.dt_increase_size,
-                    FIELD_WIDTH, FLOAT_PRECISION, latency);
-            fflush(stdout);
+        if(myid == 0) {
+            double latency = (t_end - t_start) * 1e6 / (2.0 * options.iterations);
+            double pack_latency = t_pack * 1e6 / (2.0 * options.iterations);
+
+            record_message_size(size, latency);
+
+            if (OUTPUT_TABLE != options.output_format) {
+                struct result_metric_t metrics[] = {
+                    {"block_size", options.dt_block_size},
+                    {"stride_size", options.dt_stride_size},
+                    {"increase_size", options.dt_increase_size},
+                    {"latency_us", latency},
+                    {"user_pack_latency_us", pack_latency},
+                };
+
+                output_result(benchmark_num_ranks, size, 5, metrics);
+            } else {
+                fprintf(stdout, "%-*d%-*d%-*d%-*d%*.*f%*.*f\n",
+                        10, size,
+                        10, options.dt_block_size,
+                        10, options.dt_stride_size,
+                        10, options.dt_increase_size,
+                        FIELD_WIDTH, FLOAT_PRECISION, latency,
+                        FIELD_WIDTH, FLOAT_PRECISION, pack_latency);
+                fflush(stdout);
+            }
         }
         //getchar();
     }
 
+    free_dt_pack_buffer(p_buf, buf_type);
     free_memory(s_buf, r_buf, myid);
     MPI_CHECK(MPI_Finalize());
 
@@ -9,9 +9,47 @@
  * copyright file COPYRIGHT in the top level OMB directory.
  */
 
+/*
+ * With the default --child-mode sleep the children sleep while the parents
+ * run the latency test, and the test checks that the MPI library survives
+ * the fork.  With touch and buffers the children keep writing to memory
+ * they inherited, the way forked worker processes do, and allocate and touch
+ * fresh memory every pass.  Their writes and the parents' own ones fault
+ * on the pages that fork made copy-on-write, which the registration cache
+ * of the MPI library has to notice.  The latency and the bandwidth of every
+ * size are timed three times: before the fork, while the children run and
+ * once they have been reaped.  The buffers mode also writes to the message
+ * buffers of the parent; a library that marks its registered memory
+ * MADV_DONTFORK leaves them out of the child, which then dies from SIGSEGV.
+ */
+
 #include <osu_util_mpi.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+enum phase {
+    PHASE_BEFORE,
+    PHASE_DURING,
+    PHASE_AFTER,
+    PHASE_NUM
+};
+
+static char const *latency_column[PHASE_NUM] = {"Before (us)",
+    "During (us)", "After (us)"};
+static char const *bandwidth_column[PHASE_NUM] = {"Before (MB/s)",
+    "During (MB/s)", "After (MB/s)"};
+
+static char *arena;
 
 void communicate(int myid); 
+static int num_children (int myid);
+static void fork_children (int count, pid_t *pids, char *s_buf,
+        char *r_buf);
+static void child_write (char *s_buf, char *r_buf);
+static void reap_children (int count, pid_t *pids, int myid);
+static void run_phases (int myid, int numprocs);
+static double time_latency (int myid, int size, char *s_buf, char *r_buf);
+static double time_bandwidth (int myid, int size, char *s_buf, char *r_buf);
 
 int main(int argc, char *argv[])
 {
@@ -25,6 +63,7 @@ int main(int argc, char *argv[])
 
     options.bench = PT2PT;
     options.subtype = LAT_MP;
+    options.child_mode = CHILD_MODE_SLEEP;
 
     set_header(HEADER);
     set_benchmark_name("osu_latency_mp");
@@ -40,6 +79,7 @@ int main(int argc, char *argv[])
 
     MPI_CHECK(MPI_Init(&argc, &argv));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    set_num_ranks(numprocs);
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &myid));
 
     if (0 == myid) {
@@ -88,20 +128,53 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
+    if (setup_affinity()) {
+        if (myid == 0) {
+            fprintf(stderr, "Could not apply the requested CPU binding\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
     if (options.sender_processes != -1) {
         num_processes_sender = options.sender_processes;
     }
 
+    if (CHILD_MODE_BUFFERS == options.child_mode && NONE != options.accel) {
+        if (myid == 0) {
+            fprintf(stderr, "--child-mode buffers needs host buffers\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
     print_header(myid, LAT_MP);
     
-    if (myid == 0) {
+    if (myid == 0 && OUTPUT_TABLE == options.output_format) {
         fprintf(stdout, "# Number of forked processes in sender: %d\n",
-                num_processes_sender); 
+                CHILD_MODE_SLEEP == options.child_mode ?
+                num_processes_sender : num_children(0));
         fprintf(stdout, "# Number of forked processes in receiver: %d\n",
-                options.num_processes );
-        fprintf(stdout, "%-*s%*s\n", 10, "# Size", FIELD_WIDTH,
-                "Latency (us)");
+                CHILD_MODE_SLEEP == options.child_mode ?
+                options.num_processes : num_children(1));
         fflush(stdout);
+    }
+
+    if (CHILD_MODE_SLEEP != options.child_mode) {
+        run_phases(myid, numprocs);
+        MPI_CHECK(MPI_Finalize());
+
+        return EXIT_SUCCESS;
+    }
+
+    if (myid == 0) {
+        if (OUTPUT_TABLE == options.output_format) {
+            fprintf(stdout, "%-*s%*s\n", 10, "# Size", FIELD_WIDTH,
+                    "Latency (us)");
+            fflush(stdout);
+        }
         
         for (i = 0; i < num_processes_sender; i++) {
             sr_processes[i] = fork();
@@ -158,7 +231,7 @@ void communicate(int myid)
         exit(EXIT_FAILURE);
     }
     
-    for (size = options.min_message_size; size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+    for (size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
         set_buffer_pt2pt(s_buf, myid, options.accel, 'a', size);
         set_buffer_pt2pt(r_buf, myid, options.accel, 'b', size);
 
@@ -172,14 +245,14 @@ void communicate(int myid)
         if (myid == 0) {
             for (i = 0; i < options.iterations + options.skip; i++) {
                 if (i == options.skip) {
-                    t_start = MPI_Wtime();
+                    t_start = osu_wtime();
                 }
                 MPI_CHECK(MPI_Send(s_buf, size, MPI_CHAR, 1, 1, 
                         MPI_COMM_WORLD));
                 MPI_CHECK(MPI_Recv(r_buf, size, MPI_CHAR, 1, 1, 
                         MPI_COMM_WORLD, &reqstat));
             }
-            t_end = MPI_Wtime();
+            t_end = osu_wtime();
         } else if (myid == 1) {
             for (i = 0; i < options.iterations + options.skip; i++) {
                 MPI_CHECK(MPI_Recv(r_buf, size, MPI_CHAR, 0, 1, 
@@ -190,12 +263,281 @@ void communicate(int myid)
         }
         if (myid == 0) {
             double latency = (t_end - t_start) * 1e6 / (2.0 * options.iterations);
-            fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH, 
-                    FLOAT_PRECISION, latency);
+            print_result(size, latency);
             fflush(stdout);
         }
     }
     free_memory(s_buf, r_buf, myid);
 }
 
+/* -t counts the parent among the processes of a rank */
+static int num_children (int myid)
+{
+    if (0 == myid) {
+        return options.sender_processes > 0 ? options.sender_processes - 1 :
+            0;
+    }
+
+    return options.num_processes - 1;
+}
+
+/* The children never return from child_write() */
+static void fork_children (int count, pid_t *pids, char *s_buf,
+        char *r_buf)
+{
+    int i;
+
+    fflush(stdout);
+    fflush(stderr);
+
+    for (i = 0; i < count; i++) {
+        pids[i] = fork();
+
+        if (0 == pids[i]) {
+            child_write(s_buf, r_buf);
+        } else if (0 > pids[i]) {
+            perror("fork");
+            MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+        }
+    }
+}
+
+/*
+ * A child never calls MPI and leaves with _exit(), the MPI state it
+ * inherited belongs to the parent.  It stops once the parent kills it, or
+ * when the parent is gone.
+ */
+static void child_write (char *s_buf, char *r_buf)
+{
+    pid_t parent = getppid();
+    size_t page = getpagesize(), off;
+    char value = 0, *fresh;
+
+    while (getppid() == parent) {
+        value++;
+
+        for (off = 0; off < CHILD_ARENA_SIZE; off += page) {
+            arena[off] = value;
+        }
+
+        if (CHILD_MODE_BUFFERS == options.child_mode) {
+            for (off = 0; off < options.max_message_size; off += page) {
+                s_buf[off] = value;
+                r_buf[off] = value;
+            }
+        }
+
+        fresh = malloc(CHILD_ARENA_SIZE);
+
+        if (NULL != fresh) {
+            memset(fresh, value, CHILD_ARENA_SIZE);
+            free(fresh);
+        }
+    }
+
+    _exit(EXIT_SUCCESS);
+}
+
+static void reap_children (int count, pid_t *pids, int myid)
+{
+    int i, status;
+
+    for (i = 0; i < count; i++) {
+        kill(pids[i], SIGTERM);
+    }
+
+    for (i = 0; i < count; i++) {
+        if (0 > waitpid(pids[i], &status, 0)) {
+            continue;
+        }
+
+        if (WIFSIGNALED(status) && SIGTERM != WTERMSIG(status)) {
+            fprintf(stderr, "Child %d of rank %d died from signal %d\n", i,
+                    myid, WTERMSIG(status));
+        }
+    }
+}
+
+/*
+ * The children of both ranks are forked after every size has been timed
+ * once in their absence, and the two ranks only start the second sweep once
+ * all children exist.
+ */
+static void run_phases (int myid, int numprocs)
+{
+    pid_t pids[MAX_NUM_PROCESSES];
+    char *s_buf, *r_buf;
+    double *lat, *bw;
+    int count = num_children(myid), nsizes = 0, size, k, p;
+
+    if (allocate_memory_pt2pt(&s_buf, &r_buf, myid)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    arena = malloc(CHILD_ARENA_SIZE);
+
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        nsizes++;
+    }
+
+    lat = malloc(sizeof(double) * PHASE_NUM * nsizes);
+    bw = malloc(sizeof(double) * PHASE_NUM * nsizes);
+
+    if (NULL == arena || NULL == lat || NULL == bw) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", myid);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    /* Inherited pages only turn copy-on-write if they exist */
+    memset(arena, 'c', CHILD_ARENA_SIZE);
+
+    for (p = PHASE_BEFORE; p < PHASE_NUM; p++) {
+        if (PHASE_DURING == p) {
+            fork_children(count, pids, s_buf, r_buf);
+        } else if (PHASE_AFTER == p) {
+            reap_children(count, pids, myid);
+        }
+
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+        reset_message_sizes();
+        for (k = 0, size = options.min_message_size;
+                size <= options.max_message_size;
+                size = next_message_size(size), k++) {
+            set_buffer_pt2pt(s_buf, myid, options.accel, 'a', size);
+            set_buffer_pt2pt(r_buf, myid, options.accel, 'b', size);
+
+            lat[p * nsizes + k] = time_latency(myid, size, s_buf, r_buf);
+            bw[p * nsizes + k] = time_bandwidth(myid, size, s_buf, r_buf);
+        }
+    }
+
+    if (0 == myid && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "# Children: %s\n", CHILD_MODE_TOUCH ==
+                options.child_mode ? "touch inherited and fresh memory" :
+                "touch inherited memory and message buffers");
+        fprintf(stdout, "%-*s", 10, "# Size");
+        for (p = PHASE_BEFORE; p < PHASE_NUM; p++) {
+            fprintf(stdout, "%*s", FIELD_WIDTH, latency_column[p]);
+        }
+        for (p = PHASE_BEFORE; p < PHASE_NUM; p++) {
+            fprintf(stdout, "%*s", FIELD_WIDTH, bandwidth_column[p]);
+        }
+        fprintf(stdout, "\n");
+    }
+
+    reset_message_sizes();
+    for (k = 0, size = options.min_message_size;
+            0 == myid && size <= options.max_message_size;
+            size = next_message_size(size), k++) {
+        if (OUTPUT_TABLE == options.output_format) {
+            fprintf(stdout, "%-*d", 10, size);
+            for (p = PHASE_BEFORE; p < PHASE_NUM; p++) {
+                fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                        lat[p * nsizes + k]);
+            }
+            for (p = PHASE_BEFORE; p < PHASE_NUM; p++) {
+                fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                        bw[p * nsizes + k]);
+            }
+            fprintf(stdout, "\n");
+        } else {
+            struct result_metric_t metrics[2 * PHASE_NUM] = {
+                {"latency_before_us", lat[k]},
+                {"latency_during_us", lat[nsizes + k]},
+                {"latency_after_us", lat[2 * nsizes + k]},
+                {"bandwidth_before_MBps", bw[k]},
+                {"bandwidth_during_MBps", bw[nsizes + k]},
+                {"bandwidth_after_MBps", bw[2 * nsizes + k]},
+            };
+
+            output_result(numprocs, size, 2 * PHASE_NUM, metrics);
+        }
+    }
+    fflush(stdout);
+
+    free(lat);
+    free(bw);
+    free(arena);
+    free_memory(s_buf, r_buf, myid);
+}
+
+/* Half the round trip in microseconds on rank 0 */
+static double time_latency (int myid, int size, char *s_buf, char *r_buf)
+{
+    double t_start = 0.0;
+    int i, iterations = options.iterations, skip = options.skip;
+
+    if (size > LARGE_MESSAGE_SIZE) {
+        iterations = options.iterations_large;
+        skip = options.skip_large;
+    }
+
+    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+    for (i = 0; i < iterations + skip; i++) {
+        if (i == skip) {
+            t_start = osu_wtime();
+        }
+
+        if (0 == myid) {
+            MPI_CHECK(MPI_Send(s_buf, size, MPI_CHAR, 1, 1, MPI_COMM_WORLD));
+            MPI_CHECK(MPI_Recv(r_buf, size, MPI_CHAR, 1, 1, MPI_COMM_WORLD,
+                        MPI_STATUS_IGNORE));
+        } else {
+            MPI_CHECK(MPI_Recv(r_buf, size, MPI_CHAR, 0, 1, MPI_COMM_WORLD,
+                        MPI_STATUS_IGNORE));
+            MPI_CHECK(MPI_Send(s_buf, size, MPI_CHAR, 0, 1, MPI_COMM_WORLD));
+        }
+    }
+
+    return (osu_wtime() - t_start) * 1e6 / (2.0 * iterations);
+}
+
+/* Windows of osu_bw with its loop counts, MB/s on rank 0 */
+static double time_bandwidth (int myid, int size, char *s_buf, char *r_buf)
+{
+    MPI_Request requests[WINDOW_SIZE_LARGE];
+    double t_start = 0.0;
+    int i, j, iterations = BW_LOOP_SMALL, skip = BW_SKIP_SMALL;
+
+    if (size > LARGE_MESSAGE_SIZE) {
+        iterations = BW_LOOP_LARGE;
+        skip = BW_SKIP_LARGE;
+    }
+
+    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+    for (i = 0; i < iterations + skip; i++) {
+        if (i == skip) {
+            t_start = osu_wtime();
+        }
+
+        for (j = 0; j < WINDOW_SIZE_LARGE; j++) {
+            if (0 == myid) {
+                MPI_CHECK(MPI_Isend(s_buf, size, MPI_CHAR, 1, 2,
+                            MPI_COMM_WORLD, &requests[j]));
+            } else {
+                MPI_CHECK(MPI_Irecv(r_buf, size, MPI_CHAR, 0, 2,
+                            MPI_COMM_WORLD, &requests[j]));
+            }
+        }
+
+        MPI_CHECK(MPI_Waitall(WINDOW_SIZE_LARGE, requests,
+                    MPI_STATUSES_IGNORE));
+
+        if (0 == myid) {
+            MPI_CHECK(MPI_Recv(r_buf, 0, MPI_CHAR, 1, 3, MPI_COMM_WORLD,
+                        MPI_STATUS_IGNORE));
+        } else {
+            MPI_CHECK(MPI_Send(s_buf, 0, MPI_CHAR, 0, 3, MPI_COMM_WORLD));
+        }
+    }
+
+    return size / 1e6 * iterations * WINDOW_SIZE_LARGE /
+        (osu_wtime() - t_start);
+}
+
 /* vi: set sw=4 sts=4 tw=80: */
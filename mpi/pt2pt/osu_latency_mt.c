@@ -66,6 +66,7 @@ int main(int argc, char *argv[])
     }
 
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    set_num_ranks(numprocs);
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &myid));
 
     if (0 == myid) {
@@ -134,6 +135,15 @@ int main(int argc, char *argv[])
     }
     
     
+    if (setup_affinity()) {
+        if (myid == 0) {
+            fprintf(stderr, "Could not apply the requested CPU binding\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
     if (options.sender_thread != -1) {
         num_threads_sender = options.sender_thread;
     }
@@ -143,11 +153,15 @@ int main(int argc, char *argv[])
 
 
     if (myid == 0) {
-        printf("# Number of Sender threads: %d \n# Number of Receiver threads: %d\n",num_threads_sender,options.num_threads );
+        if (OUTPUT_TABLE == options.output_format) {
+            printf("# Number of Sender threads: %d \n# Number of Receiver threads: %d\n",num_threads_sender,options.num_threads );
+        }
     
         print_header(myid, LAT_MT);
-        fprintf(stdout, "%-*s%*s\n", 10, "# Size", FIELD_WIDTH, "Latency (us)");
-        fflush(stdout);
+        if (OUTPUT_TABLE == options.output_format) {
+            fprintf(stdout, "%-*s%*s\n", 10, "# Size", FIELD_WIDTH, "Latency (us)");
+            fflush(stdout);
+        }
 
         for (i = 0; i < num_threads_sender; i++) {
             tags[i].id = i;
@@ -185,6 +199,7 @@ void * recv_thread(void *arg)
     val = thread_id->id;
 
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &myid));
+    bind_thread(val);
 
     if (NONE != options.accel && init_accel()) {
         fprintf(stderr, "Error initializing device\n");
@@ -198,7 +213,7 @@ void * recv_thread(void *arg)
         return ret;
     }
 
-    for (size = options.min_message_size, iter = 0; size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+    for (size = options.min_message_size, iter = 0; size <= options.max_message_size; size = next_message_size(size)) {
         pthread_mutex_lock(&finished_size_mutex);
 
         if (finished_size == options.num_threads) {
@@ -262,6 +277,7 @@ void * send_thread(void *arg)
     val = thread_id->id;
 
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &myid));
+    bind_thread(val);
 
     if (NONE != options.accel && init_accel()) {
         fprintf(stderr, "Error initializing device\n");
@@ -275,7 +291,7 @@ void * send_thread(void *arg)
         return ret;
     }
 
-    for (size = options.min_message_size, iter = 0; size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+    for (size = options.min_message_size, iter = 0; size <= options.max_message_size; size = next_message_size(size)) {
         pthread_mutex_lock(&finished_size_sender_mutex);
         
         if (finished_size_sender == num_threads_sender) {
@@ -304,7 +320,7 @@ void * send_thread(void *arg)
         int flag_print=0;
         for (i = val; i < options.iterations + options.skip; i+=num_threads_sender) {
             if (i == options.skip) {
-                t_start = MPI_Wtime();
+                t_start = osu_wtime();
                 flag_print =1;
             }
 
@@ -321,12 +337,11 @@ void * send_thread(void *arg)
 
         pthread_barrier_wait(&sender_barrier);
         if (flag_print==1) {
-            t_end = MPI_Wtime ();
+            t_end = osu_wtime ();
             t = t_end - t_start;
 
             latency = (t) * 1.0e6 / (2.0 * options.iterations / num_threads_sender);
-            fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH, FLOAT_PRECISION,
-                    latency);
+            print_result(size, latency);
             fflush(stdout);
         }
         iter++;
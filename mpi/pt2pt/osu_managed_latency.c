@@ -0,0 +1,215 @@
+#define BENCHMARK "OSU MPI Managed Memory Latency Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * The ping-pong of osu_latency on CUDA managed buffers, once for every
+ * residency state of --residency.  Before every iteration both ranks bring
+ * their buffers into the state and meet in a barrier, outside of the timing,
+ * so the latency only holds the page faults and migrations the communication
+ * itself causes.  Half the round trip is printed with the bandwidth it gives,
+ * the message size over the latency, and the time rank 0 spent establishing
+ * the state per iteration, the migration cost on its own.
+ */
+
+#include <osu_util_mpi.h>
+
+static double ping_pong (int myid, char * s_buf, char * r_buf, size_t size,
+        enum residency_state state, double * migration);
+
+int main (int argc, char *argv[])
+{
+    int myid, numprocs, state;
+    int po_ret = 0;
+    size_t size;
+    char *s_buf = NULL, *r_buf = NULL;
+    double latency, migration;
+
+    options.bench = PT2PT;
+    options.subtype = MANAGED_MEM;
+    options.residency = RESIDENCY_MASK_ALL;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_managed_latency");
+    po_ret = process_options(argc, argv);
+
+    if (PO_OKAY == po_ret && CUDA_ENABLED) {
+        options.accel = MANAGED;
+        if (init_accel()) {
+            fprintf(stderr, "Error initializing device\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    set_num_ranks(numprocs);
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &myid));
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_bad_usage_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (!CUDA_ENABLED) {
+        if (myid == 0) {
+            fprintf(stderr, "This test requires CUDA managed memory, please "
+                    "recompile the benchmarks with CUDA support\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (numprocs != 2) {
+        if (myid == 0) {
+            fprintf(stderr, "This test requires exactly two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (options.max_message_size > options.max_mem_limit / 2) {
+        if (0 == myid) {
+            fprintf(stderr, "Warning! Increase the Max Memory Limit to be able "
+                    "to run up to %zu bytes.\nContinuing with max message size "
+                    "of %zu bytes\n", options.max_message_size,
+                    options.max_mem_limit / 2);
+        }
+        options.max_message_size = options.max_mem_limit / 2;
+    }
+
+    if (allocate_memory_coll((void **)&s_buf, MAX(1, options.max_message_size),
+                MANAGED) ||
+            allocate_memory_coll((void **)&r_buf,
+                MAX(1, options.max_message_size), MANAGED)) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", myid);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+    set_buffer(s_buf, MANAGED, 'a', options.max_message_size);
+    set_buffer(r_buf, MANAGED, 'b', options.max_message_size);
+
+    if (0 == myid && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "%-*s%*s%*s%*s%*s\n", 10, "# Size", 14, "Residency",
+                FIELD_WIDTH, "Latency (us)", FIELD_WIDTH, "Bandwidth (MB/s)",
+                FIELD_WIDTH, "Migration (us)");
+        fflush(stdout);
+    }
+
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        if (size > LARGE_MESSAGE_SIZE) {
+            options.iterations = options.iterations_large;
+            options.skip = options.skip_large;
+        }
+
+        for (state = 0; state < RESIDENCY_NUM; state++) {
+            if (!(options.residency & (1 << state))) {
+                continue;
+            }
+
+            latency = ping_pong(myid, s_buf, r_buf, size, state, &migration);
+
+            if (0 != myid) {
+                continue;
+            }
+
+            if (OUTPUT_TABLE == options.output_format) {
+                fprintf(stdout, "%-*zu%*s%*.*f%*.*f%*.*f\n", 10, size, 14,
+                        residency_name(state), FIELD_WIDTH, FLOAT_PRECISION,
+                        latency, FIELD_WIDTH, FLOAT_PRECISION, size / latency,
+                        FIELD_WIDTH, FLOAT_PRECISION, migration);
+                fflush(stdout);
+            } else {
+                struct result_metric_t metrics[4] = {
+                    {"residency", state},
+                    {"latency_us", latency},
+                    {"bandwidth_MBps", size / latency},
+                    {"migration_us", migration},
+                };
+
+                output_result(numprocs, size, 4, metrics);
+            }
+        }
+    }
+
+    free_buffer(s_buf, MANAGED);
+    free_buffer(r_buf, MANAGED);
+
+    MPI_CHECK(MPI_Finalize());
+
+    if (cleanup_accel()) {
+        fprintf(stderr, "Error cleaning up device\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * Half the round trip in microseconds on rank 0, and in MIGRATION the
+ * microseconds per iteration that establishing STATE took there
+ */
+static double ping_pong (int myid, char * s_buf, char * r_buf, size_t size,
+        enum residency_state state, double * migration)
+{
+    double t_start, t_total = 0.0, t_migration = 0.0, t;
+    int i, peer = 1 - myid;
+
+    advise_residency(s_buf, size, state, 1);
+    advise_residency(r_buf, size, state, 1);
+
+    for (i = 0; i < options.iterations + options.skip; i++) {
+        t = prepare_residency(s_buf, size, state) +
+            prepare_residency(r_buf, size, state);
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+        t_start = osu_wtime();
+        if (0 == myid) {
+            MPI_CHECK(MPI_Send(s_buf, size, MPI_CHAR, peer, 1,
+                        MPI_COMM_WORLD));
+            MPI_CHECK(MPI_Recv(r_buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD,
+                        MPI_STATUS_IGNORE));
+        } else {
+            MPI_CHECK(MPI_Recv(r_buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD,
+                        MPI_STATUS_IGNORE));
+            MPI_CHECK(MPI_Send(s_buf, size, MPI_CHAR, peer, 1,
+                        MPI_COMM_WORLD));
+        }
+
+        if (i >= options.skip) {
+            t_total += osu_wtime() - t_start;
+            t_migration += t;
+        }
+    }
+
+    advise_residency(s_buf, size, state, 0);
+    advise_residency(r_buf, size, state, 0);
+
+    *migration = t_migration * 1e6 / options.iterations;
+
+    return t_total * 1e6 / (2.0 * options.iterations);
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
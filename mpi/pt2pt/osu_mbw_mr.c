@@ -17,10 +17,11 @@
 #   define HEADER "# " BENCHMARK "\n"
 #endif
 
-MPI_Request * mbw_request;
-MPI_Status * mbw_reqstat;
+static MPI_Request * mbw_request;
+static MPI_Status * mbw_reqstat;
 
-double calc_bw(int rank, int size, int num_pairs, int window_size, char *s_buf, char *r_buf);
+static double calc_bw(int rank, int size, int num_pairs, int window_size, char *s_buf, char *r_buf,
+        double *class_bw);
 
 static int loop_override;
 static int skip_override;
@@ -36,11 +37,15 @@ int main(int argc, char *argv[])
 
     options.bench = MBW_MR;
     options.subtype = BW;
+    options.pairing = PAIRING_BLOCK;
+    options.stream = STREAM_OFF;
+    set_benchmark_name("osu_mbw_mr");
     
     MPI_CHECK(MPI_Init(&argc, &argv));
 
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    set_num_ranks(numprocs);
 
     options.pairs            = numprocs / 2;
 
@@ -57,6 +62,12 @@ int main(int argc, char *argv[])
         po_ret = PO_BAD_USAGE;
     }
 
+    if(PO_OKAY == po_ret && options.window_varied && options.show_locality) {
+        bad_usage.message = "Pairing Patterns Cannot Be Used With -V";
+        bad_usage.optarg = NULL;
+        po_ret = PO_BAD_USAGE;
+    }
+
     if (0 == rank) {
         switch (po_ret) {
             case PO_CUDA_NOT_AVAIL:
@@ -96,7 +107,27 @@ int main(int argc, char *argv[])
             break;
     }
 
-    if (allocate_memory_pt2pt_mul(&s_buf, &r_buf, rank, options.pairs)) {
+    if (setup_affinity()) {
+        if (rank == 0) {
+            fprintf(stderr, "Could not apply the requested CPU binding\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (setup_pairing(rank, numprocs, options.pairs)) {
+        if (0 == rank) {
+            fprintf(stderr, "No rank pairs match the pairing pattern\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    options.pairs = pairing.num_pairs;
+
+    if (allocate_memory_pt2pt_mul(&s_buf, &r_buf, pairing.vrank, options.pairs)) {
         /* Error allocating memory */
         MPI_CHECK(MPI_Finalize());
         exit(EXIT_FAILURE);
@@ -112,7 +143,17 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
-    if(rank == 0) {
+    if (setup_stream(rank)) {
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if(options.window_varied && OUTPUT_TABLE != options.output_format) {
+        /* The window size profile is a two dimensional table */
+        options.output_format = OUTPUT_TABLE;
+    }
+
+    if(rank == 0 && OUTPUT_TABLE == options.output_format) {
         fprintf(stdout, HEADER);
         print_header(rank, BW);
 
@@ -125,7 +166,18 @@ int main(int argc, char *argv[])
             fprintf(stdout, "# [ pairs: %d ] [ window size: %d ]\n", options.pairs,
                     options.window_size);
 
-            if(options.print_rate) {
+            if(STREAM_ON == options.stream) {
+                print_stream_header();
+            }
+
+            else if(options.show_locality) {
+                char const * titles[] = {"MB/s", "Messages/s"};
+
+                print_pairing_summary();
+                print_locality_header(options.print_rate ? 2 : 1, titles, "MB/s");
+            }
+
+            else if(options.print_rate) {
                 fprintf(stdout, "%-*s%*s%*s\n", 10, "# Size", FIELD_WIDTH,
                         "MB/s", FIELD_WIDTH, "Messages/s");
             }
@@ -184,7 +236,7 @@ int main(int argc, char *argv[])
 
            for(i = 0; i < WINDOW_SIZES_COUNT; i++) {
                bandwidth_results[j][i] = calc_bw(rank, curr_size, options.pairs,
-                       window_array[i], s_buf, r_buf);
+                       window_array[i], s_buf, r_buf, NULL);
 
                if(rank == 0) {
                    fprintf(stdout, "  %10.*f", FLOAT_PRECISION,
@@ -230,15 +282,41 @@ int main(int argc, char *argv[])
        mbw_request = (MPI_Request *)malloc(sizeof(MPI_Request) * options.window_size);
        mbw_reqstat = (MPI_Status *)malloc(sizeof(MPI_Status) * options.window_size);
 
-       for(curr_size = options.min_message_size; curr_size <= options.max_message_size; curr_size *= 2) {
-           double bw, rate;
+       for(curr_size = options.min_message_size; curr_size <= options.max_message_size; curr_size = next_message_size(curr_size)) {
+           double bw, rate, class_bw[LOCALITY_CLASSES];
+
+           bw = calc_bw(rank, curr_size, options.pairs, options.window_size, s_buf, r_buf,
+                   class_bw);
 
-           bw = calc_bw(rank, curr_size, options.pairs, options.window_size, s_buf, r_buf);
+           if(STREAM_ON == options.stream) {
+               report_stream(rank, curr_size);
+               continue;
+           }
 
            if(rank == 0) {
+               struct result_metric_t metrics[2];
+
                rate = 1e6 * bw / curr_size;
+               metrics[0] = (struct result_metric_t){"bandwidth_MBps", bw};
+               metrics[1] = (struct result_metric_t){"message_rate", rate};
+
+               if(options.show_locality) {
+                   print_locality_result(curr_size, options.print_rate ? 2 : 1,
+                           metrics, class_bw);
+                   continue;
+               }
+
+               record_message_size(curr_size, bw);
+               /* The gap of one pair, bw is the sum over all of them */
+               record_model_point(FIT_LOGGP_GAP, numprocs, curr_size,
+                       bw > 0.0 ? curr_size * options.pairs / bw : 0.0);
+
+               if(OUTPUT_TABLE != options.output_format) {
+                   output_result(numprocs, curr_size, options.print_rate ? 2 : 1,
+                           metrics);
+               }
 
-               if(options.print_rate) {
+               else if(options.print_rate) {
                    fprintf(stdout, "%-*d%*.*f%*.*f\n", 10, curr_size,
                            FIELD_WIDTH, FLOAT_PRECISION, bw, FIELD_WIDTH,
                            FLOAT_PRECISION, rate);
@@ -252,31 +330,33 @@ int main(int argc, char *argv[])
        }
    }
 
-   free_memory_pt2pt_mul(s_buf, r_buf, rank, options.pairs);
+   cleanup_stream();
+   free_memory_pt2pt_mul(s_buf, r_buf, pairing.vrank, options.pairs);
 
    MPI_CHECK(MPI_Finalize());
 
    return EXIT_SUCCESS;
 }
 
-double calc_bw(int rank, int size, int num_pairs, int window_size, char *s_buf,
-        char *r_buf)
+static double calc_bw(int rank, int size, int num_pairs, int window_size, char *s_buf,
+        char *r_buf, double *class_bw)
 {
     double t_start = 0, t_end = 0, t = 0, sum_time = 0, bw = 0;
+    double bytes = (double)size * num_pairs * window_size;
     int i, j, target;
 
-	set_buffer_pt2pt(s_buf, rank, options.accel, 'a', size);
-	set_buffer_pt2pt(r_buf, rank, options.accel, 'b', size);
+	set_buffer_pt2pt(s_buf, pairing.vrank, options.accel, 'a', size);
+	set_buffer_pt2pt(r_buf, pairing.vrank, options.accel, 'b', size);
 
     MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
-    if(rank < num_pairs) {
-        target = rank + num_pairs;
+    if(pairing.vrank < num_pairs) {
+        target = pairing.partner;
 
-        for(i = 0; i <  options.iterations +  options.skip; i++) {
+        for(i = 0; stream_step(i, bytes, MPI_COMM_WORLD); i++) {
             if(i ==  options.skip) {
                 MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
-                t_start = MPI_Wtime();
+                t_start = osu_wtime();
             }
 
             for(j = 0; j < window_size; j++) {
@@ -288,14 +368,14 @@ double calc_bw(int rank, int size, int num_pairs, int window_size, char *s_buf,
                     &mbw_reqstat[0]));
         }
 
-        t_end = MPI_Wtime();
+        t_end = osu_wtime();
         t = t_end - t_start;
     }
 
-    else if(rank < num_pairs * 2) {
-        target = rank - num_pairs;
+    else if(pairing.vrank < num_pairs * 2) {
+        target = pairing.partner;
 
-        for(i = 0; i <  options.iterations +  options.skip; i++) {
+        for(i = 0; stream_step(i, bytes, MPI_COMM_WORLD); i++) {
             if(i ==  options.skip) {
                 MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
             }
@@ -310,12 +390,33 @@ double calc_bw(int rank, int size, int num_pairs, int window_size, char *s_buf,
         }
     }
 
+    else if(STREAM_ON == options.stream) {
+        /* Idle ranks only take part in the end of every window */
+        for(i = 0; stream_step(i, bytes, MPI_COMM_WORLD); i++) {
+            if(i ==  options.skip) {
+                MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+            }
+        }
+    }
+
     else {
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
     }
 
     MPI_CHECK(MPI_Reduce(&t, &sum_time, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD));
 
+    if(class_bw && options.show_locality) {
+        /* Only senders time the transfers, receivers add nothing */
+        reduce_by_locality(t, class_bw);
+
+        for(i = 0; rank == 0 && i < LOCALITY_CLASSES; i++) {
+            if(pairing.class_pairs[i]) {
+                class_bw[i] = size / 1e6 * pairing.class_pairs[i] * options.iterations
+                    * window_size / (class_bw[i] / pairing.class_pairs[i]);
+            }
+        }
+    }
+
     if(rank == 0) {
         double tmp = size / 1e6 * num_pairs ;
         
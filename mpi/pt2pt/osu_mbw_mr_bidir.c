@@ -0,0 +1,428 @@
+#define BENCHMARK "OSU MPI Multiple Bi-Directional Bandwidth / Message Rate Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University. 
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * The bidirectional counterpart of osu_mbw_mr: the ranks are paired as in
+ * osu_mbw_mr, and in every iteration both ranks of a pair post a window of
+ * receives from and a window of sends to each other and wait for all of
+ * them, as osu_bibw does for a single pair.  The bandwidth and the message
+ * rate are summed over both directions of all pairs.  Node MB/s is the
+ * bandwidth the ranks of the busiest node send and receive together.
+ */
+
+#include <osu_util_mpi.h>
+
+#ifdef PACKAGE_VERSION
+#   define HEADER "# " BENCHMARK " v" PACKAGE_VERSION "\n"
+#else
+#   define HEADER "# " BENCHMARK "\n"
+#endif
+
+static MPI_Request * mbw_request;
+static MPI_Status * mbw_reqstat;
+static MPI_Comm node_comm;
+
+static double calc_bw(int rank, int size, int num_pairs, int window_size, char *s_buf, char *r_buf,
+        double *class_bw, double *node_bw);
+
+static int loop_override;
+static int skip_override;
+
+int main(int argc, char *argv[])
+{
+    char *s_buf, *r_buf;
+    int numprocs, rank;
+    int c, curr_size;
+
+    loop_override = 0;
+    skip_override = 0;
+
+    options.bench = MBW_MR;
+    options.subtype = BW;
+    options.pairing = PAIRING_BLOCK;
+    set_benchmark_name("osu_mbw_mr_bidir");
+    
+    MPI_CHECK(MPI_Init(&argc, &argv));
+
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    set_num_ranks(numprocs);
+
+    options.pairs            = numprocs / 2;
+
+    int po_ret = process_options(argc, argv);
+
+    if (PO_OKAY == po_ret && NONE != options.accel) {
+        if (init_accel()) {
+            fprintf(stderr, "Error initializing device\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if(options.pairs > (numprocs / 2)) {
+        po_ret = PO_BAD_USAGE;
+    }
+
+    if(PO_OKAY == po_ret && options.window_varied && options.show_locality) {
+        bad_usage.message = "Pairing Patterns Cannot Be Used With -V";
+        bad_usage.optarg = NULL;
+        po_ret = PO_BAD_USAGE;
+    }
+
+    if (0 == rank) {
+        switch (po_ret) {
+            case PO_CUDA_NOT_AVAIL:
+                fprintf(stderr, "CUDA support not enabled.  Please recompile "
+                        "benchmark with CUDA support.\n");
+                break;
+            case PO_OPENACC_NOT_AVAIL:
+                fprintf(stderr, "OPENACC support not enabled.  Please "
+                        "recompile benchmark with OPENACC support.\n");
+                break;
+            case PO_BAD_USAGE:
+                print_bad_usage_message(rank);
+                break;
+            case PO_HELP_MESSAGE:
+                usage_mbw_mr();
+                break;
+            case PO_VERSION_MESSAGE:
+                print_version_message(rank);
+                MPI_CHECK(MPI_Finalize());
+                break;
+            case PO_OKAY:
+                break;
+        }
+    }
+
+    switch (po_ret) {
+        case PO_CUDA_NOT_AVAIL:
+        case PO_OPENACC_NOT_AVAIL:
+        case PO_BAD_USAGE:
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+        case PO_VERSION_MESSAGE:
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (setup_affinity()) {
+        if (rank == 0) {
+            fprintf(stderr, "Could not apply the requested CPU binding\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (setup_pairing(rank, numprocs, options.pairs)) {
+        if (0 == rank) {
+            fprintf(stderr, "No rank pairs match the pairing pattern\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    options.pairs = pairing.num_pairs;
+
+    if (allocate_memory_pt2pt_mul(&s_buf, &r_buf, pairing.vrank, options.pairs)) {
+        /* Error allocating memory */
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if(numprocs < 2) {
+        if(rank == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+
+        return EXIT_FAILURE;
+    }
+
+    MPI_CHECK(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+                MPI_INFO_NULL, &node_comm));
+
+    if(options.window_varied && OUTPUT_TABLE != options.output_format) {
+        /* The window size profile is a two dimensional table */
+        options.output_format = OUTPUT_TABLE;
+    }
+
+    if(rank == 0 && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        print_header(rank, BW);
+
+        if(options.window_varied) {
+            fprintf(stdout, "# [ pairs: %d ] [ window size: varied ]\n", options.pairs);
+            fprintf(stdout, "\n# Bi-directional Bandwidth (MB/sec)\n");
+        }
+
+        else {
+            fprintf(stdout, "# [ pairs: %d ] [ window size: %d ]\n", options.pairs,
+                    options.window_size);
+
+            if(options.show_locality) {
+                char const * titles[] = {"MB/s", "Messages/s"};
+
+                print_pairing_summary();
+                print_locality_header(options.print_rate ? 2 : 1, titles, "MB/s");
+            }
+
+            else if(options.print_rate) {
+                fprintf(stdout, "%-*s%*s%*s%*s\n", 10, "# Size", FIELD_WIDTH,
+                        "MB/s", FIELD_WIDTH, "Messages/s", FIELD_WIDTH,
+                        "Node MB/s");
+            }
+
+            else {
+                fprintf(stdout, "%-*s%*s%*s\n", 10, "# Size", FIELD_WIDTH,
+                        "MB/s", FIELD_WIDTH, "Node MB/s");
+            }
+        }
+
+        fflush(stdout);
+    }
+
+   /* More than one window size */
+
+   if(options.window_varied) {
+       int window_array[] = WINDOW_SIZES;
+       double ** bandwidth_results;
+       int log_val = 1, tmp_message_size = options.max_message_size;
+       int i, j;
+
+       for(i = 0; i < WINDOW_SIZES_COUNT; i++) {
+           if(window_array[i] > options.window_size) {
+               options.window_size = window_array[i];
+           }
+       }
+
+       mbw_request = (MPI_Request *) malloc(sizeof(MPI_Request) * 2 * options.window_size);
+       mbw_reqstat = (MPI_Status *) malloc(sizeof(MPI_Status) * 2 * options.window_size);
+
+       while(tmp_message_size >>= 1) {
+           log_val++;
+       }
+
+       bandwidth_results = (double **) malloc(sizeof(double *) * log_val);
+
+       for(i = 0; i < log_val; i++) {
+           bandwidth_results[i] = (double *)malloc(sizeof(double) *
+                   WINDOW_SIZES_COUNT);
+       }
+
+       if(rank == 0) {
+           fprintf(stdout, "#      ");
+
+           for(i = 0; i < WINDOW_SIZES_COUNT; i++) {
+               fprintf(stdout, "  %10d", window_array[i]);
+           }
+
+           fprintf(stdout, "\n");
+           fflush(stdout);
+       }
+    
+       for(j = 0, curr_size = options.min_message_size; curr_size <= options.max_message_size; curr_size *= 2, j++) {
+           if(rank == 0) {
+               fprintf(stdout, "%-7d", curr_size);
+           }
+
+           for(i = 0; i < WINDOW_SIZES_COUNT; i++) {
+               bandwidth_results[j][i] = calc_bw(rank, curr_size, options.pairs,
+                       window_array[i], s_buf, r_buf, NULL, NULL);
+
+               if(rank == 0) {
+                   fprintf(stdout, "  %10.*f", FLOAT_PRECISION,
+                           bandwidth_results[j][i]);
+               }
+           }
+
+           if(rank == 0) {
+               fprintf(stdout, "\n");
+               fflush(stdout);
+           }
+       }
+
+       if(rank == 0 && options.print_rate) {
+            fprintf(stdout, "\n# Message Rate Profile\n");
+            fprintf(stdout, "#      ");
+
+            for(i = 0; i < WINDOW_SIZES_COUNT; i++) {
+                fprintf(stdout, "  %10d", window_array[i]);
+            }       
+
+            fprintf(stdout, "\n");
+            fflush(stdout);
+
+            for(c = 0, curr_size = options.min_message_size; curr_size <= options.max_message_size; curr_size *= 2) {
+                fprintf(stdout, "%-7d", curr_size); 
+
+                for(i = 0; i < WINDOW_SIZES_COUNT; i++) {
+                    double rate = 1e6 * bandwidth_results[c][i] / curr_size;
+
+                    fprintf(stdout, "  %10.2f", rate);
+                }       
+
+                fprintf(stdout, "\n");
+                fflush(stdout);
+                c++;    
+            }
+       }
+   }
+
+   else {
+       /* Just one window size */
+       mbw_request = (MPI_Request *)malloc(sizeof(MPI_Request) * 2 * options.window_size);
+       mbw_reqstat = (MPI_Status *)malloc(sizeof(MPI_Status) * 2 * options.window_size);
+
+       for(curr_size = options.min_message_size; curr_size <= options.max_message_size; curr_size = next_message_size(curr_size)) {
+           double bw, rate, node_bw, class_bw[LOCALITY_CLASSES];
+
+           bw = calc_bw(rank, curr_size, options.pairs, options.window_size, s_buf, r_buf,
+                   class_bw, &node_bw);
+
+           if(rank == 0) {
+               struct result_metric_t metrics[3];
+
+               rate = 1e6 * bw / curr_size;
+               metrics[0] = (struct result_metric_t){"bandwidth_MBps", bw};
+               metrics[1] = (struct result_metric_t){"message_rate", rate};
+               metrics[2] = (struct result_metric_t){"node_bandwidth_MBps",
+                   node_bw};
+
+               if(options.show_locality) {
+                   print_locality_result(curr_size, options.print_rate ? 2 : 1,
+                           metrics, class_bw);
+                   continue;
+               }
+
+               record_message_size(curr_size, bw);
+
+               if(OUTPUT_TABLE != options.output_format) {
+                   if(!options.print_rate) {
+                       metrics[1] = metrics[2];
+                   }
+
+                   output_result(numprocs, curr_size, options.print_rate ? 3 : 2,
+                           metrics);
+               }
+
+               else if(options.print_rate) {
+                   fprintf(stdout, "%-*d%*.*f%*.*f%*.*f\n", 10, curr_size,
+                           FIELD_WIDTH, FLOAT_PRECISION, bw, FIELD_WIDTH,
+                           FLOAT_PRECISION, rate, FIELD_WIDTH,
+                           FLOAT_PRECISION, node_bw);
+               }
+
+               else {
+                   fprintf(stdout, "%-*d%*.*f%*.*f\n", 10, curr_size,
+                           FIELD_WIDTH, FLOAT_PRECISION, bw, FIELD_WIDTH,
+                           FLOAT_PRECISION, node_bw);
+               }
+           } 
+       }
+   }
+
+   free_memory_pt2pt_mul(s_buf, r_buf, pairing.vrank, options.pairs);
+   MPI_CHECK(MPI_Comm_free(&node_comm));
+
+   MPI_CHECK(MPI_Finalize());
+
+   return EXIT_SUCCESS;
+}
+
+/*
+ * Bandwidth in MB/s summed over both directions of all pairs, valid on rank
+ * 0, and in NODE_BW if not NULL the bandwidth of the busiest node
+ */
+static double calc_bw(int rank, int size, int num_pairs, int window_size, char *s_buf,
+        char *r_buf, double *class_bw, double *node_bw)
+{
+    double t_start = 0, t_end = 0, t = 0, sum_time = 0, bw = 0;
+    double local_bw = 0, node_sum = 0;
+    int i, j, target;
+
+	set_buffer_pt2pt(s_buf, pairing.vrank, options.accel, 'a', size);
+	set_buffer_pt2pt(r_buf, pairing.vrank, options.accel, 'b', size);
+
+    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+    if(pairing.vrank < num_pairs * 2) {
+        target = pairing.partner;
+
+        for(i = 0; i <  options.iterations +  options.skip; i++) {
+            if(i ==  options.skip) {
+                MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+                t_start = osu_wtime();
+            }
+
+            for(j = 0; j < window_size; j++) {
+                MPI_CHECK(MPI_Irecv(r_buf, size, MPI_CHAR, target, 10, MPI_COMM_WORLD,
+                        mbw_request + j));
+            }
+            for(j = 0; j < window_size; j++) {
+                MPI_CHECK(MPI_Isend(s_buf, size, MPI_CHAR, target, 10, MPI_COMM_WORLD,
+                        mbw_request + window_size + j));
+            }
+            MPI_CHECK(MPI_Waitall(2 * window_size, mbw_request, mbw_reqstat));
+        }
+
+        t_end = osu_wtime();
+        t = t_end - t_start;
+
+        /* Sent and received */
+        local_bw = 2.0 * size / 1e6 * options.iterations * window_size / t;
+    }
+
+    else {
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+    }
+
+    MPI_CHECK(MPI_Reduce(&t, &sum_time, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD));
+
+    if(node_bw) {
+        MPI_CHECK(MPI_Allreduce(&local_bw, &node_sum, 1, MPI_DOUBLE, MPI_SUM,
+                    node_comm));
+        MPI_CHECK(MPI_Reduce(&node_sum, node_bw, 1, MPI_DOUBLE, MPI_MAX, 0,
+                    MPI_COMM_WORLD));
+    }
+
+    if(class_bw && options.show_locality) {
+        /* The first rank of every pair times it for the locality classes */
+        reduce_by_locality(pairing.vrank < num_pairs ? t : 0, class_bw);
+
+        for(i = 0; rank == 0 && i < LOCALITY_CLASSES; i++) {
+            if(pairing.class_pairs[i]) {
+                class_bw[i] = 2 * size / 1e6 * pairing.class_pairs[i] *
+                    options.iterations * window_size /
+                    (class_bw[i] / pairing.class_pairs[i]);
+            }
+        }
+    }
+
+    if(rank == 0) {
+        double tmp = 2 * size / 1e6 * num_pairs;
+
+        sum_time /= 2 * num_pairs;
+        tmp = tmp *  options.iterations * window_size;
+        bw = tmp / sum_time;
+
+        return bw;
+    }
+
+    return 0;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
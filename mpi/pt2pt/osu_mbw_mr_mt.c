@@ -0,0 +1,346 @@
+#define BENCHMARK "OSU MPI%s Multi-threaded Bandwidth / Message Rate Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * Thread i of rank 0 streams windows of messages to thread i of rank 1, like
+ * a pair of osu_mbw_mr but with threads instead of processes.  Whether the
+ * threads share MPI_COMM_WORLD and its tag space or get communicators of
+ * their own is selected with -e, which shows how much of the rate is lost to
+ * shared matching queues and locks in the library.
+ */
+
+#include <osu_util_mpi.h>
+
+#define DATA_TAG    1
+#define ACK_TAG     2
+
+pthread_barrier_t thread_barrier;
+
+MPI_Comm thread_comm[MAX_NUM_THREADS];
+int num_comms = 1;
+int peer = 0;
+size_t msg_size = 0;
+char *s_bufs[MAX_NUM_THREADS];
+char *r_bufs[MAX_NUM_THREADS];
+MPI_Request *thread_requests[MAX_NUM_THREADS];
+double thread_time[MAX_NUM_THREADS];
+
+typedef struct thread_tag  {
+        int id;
+} thread_tag_t;
+
+void * rate_thread(void *arg);
+static void report (int threads);
+
+int main(int argc, char *argv[])
+{
+    int numprocs = 0, provided = 0, myid = 0, err = 0;
+    int po_ret = 0;
+    int i = 0, threads = 0;
+    pthread_t workers[MAX_NUM_THREADS];
+    thread_tag_t tags[MAX_NUM_THREADS];
+    MPI_Info info;
+
+    options.bench = PT2PT;
+    options.subtype = MR_MT;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_mbw_mr_mt");
+
+    po_ret = process_options(argc, argv);
+
+    err = MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+
+    if (err != MPI_SUCCESS) {
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, 1));
+    }
+
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    set_num_ranks(numprocs);
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &myid));
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_bad_usage_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (numprocs != 2) {
+        if (myid == 0) {
+            fprintf(stderr, "This test requires exactly two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+
+        return EXIT_FAILURE;
+    }
+
+    if (provided != MPI_THREAD_MULTIPLE) {
+        if (myid == 0) {
+            fprintf(stderr,
+                "MPI_Init_thread must return MPI_THREAD_MULTIPLE!\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+
+        return EXIT_FAILURE;
+    }
+
+    if (setup_affinity()) {
+        if (myid == 0) {
+            fprintf(stderr, "Could not apply the requested CPU binding\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    peer = 1 - myid;
+
+    /*
+     * Private communicators promise that no wildcards are used, which lets
+     * libraries that honor the MPI-4 assertions skip the wildcard checks.
+     */
+    if (THREAD_COMM_PRIVATE == options.thread_comm) {
+        num_comms = options.thread_comms ? options.thread_comms
+                                         : options.num_threads;
+
+        MPI_CHECK(MPI_Info_create(&info));
+        MPI_CHECK(MPI_Info_set(info, "mpi_assert_no_any_tag", "true"));
+        MPI_CHECK(MPI_Info_set(info, "mpi_assert_no_any_source", "true"));
+
+        for (i = 0; i < num_comms; i++) {
+            MPI_CHECK(MPI_Comm_dup_with_info(MPI_COMM_WORLD, info,
+                        &thread_comm[i]));
+        }
+
+        MPI_CHECK(MPI_Info_free(&info));
+    } else {
+        num_comms = 1;
+        thread_comm[0] = MPI_COMM_WORLD;
+    }
+
+    for (i = 0; i < options.num_threads; i++) {
+        if (posix_memalign((void **)&s_bufs[i], getpagesize(),
+                    options.max_message_size) ||
+                posix_memalign((void **)&r_bufs[i], getpagesize(),
+                    options.max_message_size)) {
+            fprintf(stderr, "Error allocating memory on Rank %d\n", myid);
+            MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+        }
+
+        if (bind_memory(s_bufs[i], options.max_message_size) ||
+                bind_memory(r_bufs[i], options.max_message_size)) {
+            fprintf(stderr, "Error binding memory to NUMA node %d on Rank %d\n",
+                    options.mem_node, myid);
+            MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+        }
+
+        memset(s_bufs[i], 'a', options.max_message_size);
+        memset(r_bufs[i], 'b', options.max_message_size);
+
+        thread_requests[i] = malloc(sizeof(MPI_Request) * options.window_size);
+        if (NULL == thread_requests[i]) {
+            fprintf(stderr, "Error allocating memory on Rank %d\n", myid);
+            MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+        }
+    }
+
+    print_header(myid, MR_MT);
+    if (0 == myid && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "# Window size: %d, thread mapping: %s",
+                options.window_size, thread_comm_name());
+        if (THREAD_COMM_PRIVATE == options.thread_comm) {
+            fprintf(stdout, " (%d communicators)", num_comms);
+        }
+        fprintf(stdout, "\n");
+        fprintf(stdout, "%-*s%*s%*s%*s%*s%*s\n", 10, "# Size", 10, "Threads",
+                FIELD_WIDTH, "MB/s", FIELD_WIDTH, "Messages/s",
+                FIELD_WIDTH, "Min Thread(msg/s)",
+                FIELD_WIDTH, "Max Thread(msg/s)");
+        fflush(stdout);
+    }
+
+    for (msg_size = options.min_message_size;
+            msg_size <= options.max_message_size;
+            msg_size = next_message_size(msg_size)) {
+        if (msg_size > LARGE_MESSAGE_SIZE) {
+            options.iterations = options.iterations_large;
+            options.skip = options.skip_large;
+        }
+
+        for (threads = 1; threads <= options.num_threads; threads *= 2) {
+            pthread_barrier_init(&thread_barrier, NULL, threads);
+            MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+            for (i = 0; i < threads; i++) {
+                tags[i].id = i;
+                pthread_create(&workers[i], NULL, rate_thread, &tags[i]);
+            }
+
+            for (i = 0; i < threads; i++) {
+                pthread_join(workers[i], NULL);
+            }
+
+            pthread_barrier_destroy(&thread_barrier);
+
+            if (0 == myid) {
+                report(threads);
+            }
+        }
+    }
+
+    for (i = 0; i < options.num_threads; i++) {
+        free(s_bufs[i]);
+        free(r_bufs[i]);
+        free(thread_requests[i]);
+    }
+
+    if (THREAD_COMM_PRIVATE == options.thread_comm) {
+        for (i = 0; i < num_comms; i++) {
+            MPI_CHECK(MPI_Comm_free(&thread_comm[i]));
+        }
+    }
+
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * The aggregate rate is taken over the slowest thread, so an unfair library
+ * shows up as a gap between the minimum and maximum per-thread rates rather
+ * than inflating the total.
+ */
+static void report (int threads)
+{
+    double msgs = (double)options.iterations * options.window_size;
+    double max_time = 0.0, rate = 0.0, min_rate = 0.0, max_rate = 0.0;
+    double thread_rate[MAX_NUM_THREADS];
+    int i;
+
+    for (i = 0; i < threads; i++) {
+        thread_rate[i] = msgs / thread_time[i];
+
+        if (thread_time[i] > max_time) {
+            max_time = thread_time[i];
+        }
+        if (0 == i || thread_rate[i] < min_rate) {
+            min_rate = thread_rate[i];
+        }
+        if (0 == i || thread_rate[i] > max_rate) {
+            max_rate = thread_rate[i];
+        }
+    }
+
+    rate = msgs * threads / max_time;
+
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "%-*zu%*d%*.*f%*.*f%*.*f%*.*f\n", 10, msg_size,
+                10, threads,
+                FIELD_WIDTH, FLOAT_PRECISION, rate * msg_size / 1e6,
+                FIELD_WIDTH, FLOAT_PRECISION, rate,
+                FIELD_WIDTH, FLOAT_PRECISION, min_rate,
+                FIELD_WIDTH, FLOAT_PRECISION, max_rate);
+
+        if (options.show_full) {
+            for (i = 0; i < threads; i++) {
+                fprintf(stdout, "#   thread %-*d%*.*f\n", 17, i,
+                        2 * FIELD_WIDTH, FLOAT_PRECISION, thread_rate[i]);
+            }
+        }
+
+        fflush(stdout);
+    } else {
+        struct result_metric_t metrics[5] = {
+            {"threads", threads},
+            {"bandwidth_MBps", rate * msg_size / 1e6},
+            {"message_rate", rate},
+            {"min_thread_rate", min_rate},
+            {"max_thread_rate", max_rate},
+        };
+
+        output_result(benchmark_num_ranks, msg_size, 5, metrics);
+
+        if (options.show_full) {
+            for (i = 0; i < threads; i++) {
+                struct result_metric_t per_thread[3] = {
+                    {"threads", threads},
+                    {"thread", i},
+                    {"thread_rate", thread_rate[i]},
+                };
+
+                output_result(benchmark_num_ranks, msg_size, 3, per_thread);
+            }
+        }
+    }
+}
+
+void * rate_thread(void *arg)
+{
+    thread_tag_t *thread_id = (thread_tag_t *)arg;
+    int id = thread_id->id;
+    MPI_Comm comm = thread_comm[id % num_comms];
+    MPI_Request *reqs = thread_requests[id];
+    int data_tag = DATA_TAG, ack_tag = ACK_TAG;
+    int i = 0, j = 0;
+    double t_start = 0.0;
+
+    if (THREAD_COMM_TAG == options.thread_comm) {
+        data_tag = 2 * id + DATA_TAG;
+        ack_tag = 2 * id + ACK_TAG;
+    }
+
+    bind_thread(id);
+    pthread_barrier_wait(&thread_barrier);
+
+    for (i = 0; i < options.iterations + options.skip; i++) {
+        if (i == options.skip) {
+            t_start = osu_wtime();
+        }
+
+        if (0 == peer) {
+            for (j = 0; j < options.window_size; j++) {
+                MPI_CHECK(MPI_Irecv(r_bufs[id], msg_size, MPI_CHAR, peer,
+                            data_tag, comm, &reqs[j]));
+            }
+            MPI_CHECK(MPI_Waitall(options.window_size, reqs,
+                        MPI_STATUSES_IGNORE));
+            MPI_CHECK(MPI_Send(s_bufs[id], 0, MPI_CHAR, peer, ack_tag, comm));
+        } else {
+            for (j = 0; j < options.window_size; j++) {
+                MPI_CHECK(MPI_Isend(s_bufs[id], msg_size, MPI_CHAR, peer,
+                            data_tag, comm, &reqs[j]));
+            }
+            MPI_CHECK(MPI_Waitall(options.window_size, reqs,
+                        MPI_STATUSES_IGNORE));
+            MPI_CHECK(MPI_Recv(r_bufs[id], 0, MPI_CHAR, peer, ack_tag, comm,
+                        MPI_STATUS_IGNORE));
+        }
+    }
+
+    thread_time[id] = osu_wtime() - t_start;
+
+    return NULL;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
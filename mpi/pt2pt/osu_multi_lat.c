@@ -11,7 +11,7 @@
 
 #include <osu_util_mpi.h>
 
-char *s_buf, *r_buf;
+static char *s_buf, *r_buf;
 
 static void multi_latency(int rank, int pairs);
 
@@ -22,6 +22,7 @@ int main(int argc, char* argv[])
     int po_ret = 0;
     options.bench = PT2PT;
     options.subtype = LAT;
+    options.pairing = PAIRING_BLOCK;
 
     set_header(HEADER);
     set_benchmark_name("osu_multi_lat");
@@ -38,8 +39,7 @@ int main(int argc, char* argv[])
 
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
-
-    pairs = nprocs/2;
+    set_num_ranks(nprocs);
 
     if (0 == rank) {
         switch (po_ret) {
@@ -80,7 +80,27 @@ int main(int argc, char* argv[])
             break;
     }
 
-    if (allocate_memory_pt2pt_mul(&s_buf, &r_buf, rank, pairs)) {
+    if (setup_affinity()) {
+        if (rank == 0) {
+            fprintf(stderr, "Could not apply the requested CPU binding\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (setup_pairing(rank, nprocs, nprocs / 2)) {
+        if (0 == rank) {
+            fprintf(stderr, "No rank pairs match the pairing pattern\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    pairs = pairing.num_pairs;
+
+    if (allocate_memory_pt2pt_mul(&s_buf, &r_buf, pairing.vrank, pairs)) {
         /* Error allocating memory */
         MPI_CHECK(MPI_Finalize());
         exit(EXIT_FAILURE);
@@ -99,7 +119,7 @@ int main(int argc, char* argv[])
 
     MPI_CHECK(MPI_Finalize());
 
-    free_memory_pt2pt_mul(s_buf, r_buf, rank, pairs);
+    free_memory_pt2pt_mul(s_buf, r_buf, pairing.vrank, pairs);
 
     return EXIT_SUCCESS;
 }
@@ -111,11 +131,12 @@ static void multi_latency(int rank, int pairs)
     double t_start = 0.0, t_end = 0.0,
            latency = 0.0, total_lat = 0.0,
            avg_lat = 0.0;
+    double class_lat[LOCALITY_CLASSES];
 
     MPI_Status reqstat;
 
 
-    for(size = options.min_message_size; size <= options.max_message_size; size  = (size ? size * 2 : 1)) {
+    for(size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
@@ -127,13 +148,13 @@ static void multi_latency(int rank, int pairs)
             options.skip = options.skip;
         }
 
-        if (rank < pairs) {
-            partner = rank + pairs;
+        if (pairing.vrank < pairs) {
+            partner = pairing.partner;
 
             for (i = 0; i < options.iterations + options.skip; i++) {
 
                 if (i == options.skip) {
-                    t_start = MPI_Wtime();
+                    t_start = osu_wtime();
                     MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
                 }
 
@@ -142,15 +163,15 @@ static void multi_latency(int rank, int pairs)
                          &reqstat));
             }
 
-            t_end = MPI_Wtime();
+            t_end = osu_wtime();
 
-        } else {
-            partner = rank - pairs;
+        } else if (pairing.vrank < pairs * 2) {
+            partner = pairing.partner;
 
             for (i = 0; i < options.iterations + options.skip; i++) {
 
                 if (i == options.skip) {
-                    t_start = MPI_Wtime();
+                    t_start = osu_wtime();
                     MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
                 }
 
@@ -159,7 +180,11 @@ static void multi_latency(int rank, int pairs)
                 MPI_CHECK(MPI_Send(s_buf, size, MPI_CHAR, partner, 1, MPI_COMM_WORLD));
             }
 
-            t_end = MPI_Wtime();
+            t_end = osu_wtime();
+        } else {
+            /* Ranks left out by the pairing only join the start barrier */
+            MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+            t_start = t_end = 0.0;
         }
 
         latency = (t_end - t_start) * 1.0e6 / (2.0 * options.iterations);
@@ -169,9 +194,22 @@ static void multi_latency(int rank, int pairs)
 
         avg_lat = total_lat/(double) (pairs * 2);
 
-        if(0 == rank) {
-            fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                    FLOAT_PRECISION, avg_lat);
+        if (options.show_locality) {
+            reduce_by_locality(latency, class_lat);
+        }
+
+        if(0 == rank && options.show_locality) {
+            struct result_metric_t metric = {"latency_us", avg_lat};
+
+            for (i = 0; i < LOCALITY_CLASSES; i++) {
+                if (pairing.class_pairs[i]) {
+                    class_lat[i] /= 2.0 * pairing.class_pairs[i];
+                }
+            }
+
+            print_locality_result(size, 1, &metric, class_lat);
+        } else if(0 == rank) {
+            print_result(size, avg_lat);
             fflush(stdout);
         }
     }
@@ -9,9 +9,16 @@
  * copyright file COPYRIGHT in the top level OMB directory.
  */
 
+
+/*
+ * osu_latency_dt between every rank of the first half and its partner in the
+ * second half, averaged over all ranks.
+ */
+
 #include <osu_util_mpi.h>
 
-char *s_buf, *r_buf;
+static char *s_buf, *r_buf, *p_buf;
+static char buf_type;
 
 static void multi_latency(int rank, int pairs);
 
@@ -35,6 +42,11 @@ int main(int argc, char* argv[])
         po_ret = PO_BAD_USAGE;
     }
 
+    if (options.max_message_size / options.dt_block_size + 1 >
+            MAX_DT_REPEAT_COUNT) {
+        po_ret = PO_BAD_USAGE;
+    }
+
     if (options.dt_block_size > options.min_message_size) {
         options.min_message_size = options.dt_block_size;
     }
@@ -49,6 +61,7 @@ int main(int argc, char* argv[])
 
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
     MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
 
     pairs = nprocs/2;
 
@@ -91,7 +104,19 @@ int main(int argc, char* argv[])
             break;
     }
 
-    if (allocate_memory_pt2pt_mul(&s_buf, &r_buf, rank, pairs)) {
+    if (setup_affinity()) {
+        if (rank == 0) {
+            fprintf(stderr, "Could not apply the requested CPU binding\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    buf_type = (rank < pairs) ? options.src : options.dst;
+
+    if (allocate_memory_pt2pt_mul(&s_buf, &r_buf, rank, pairs) ||
+            allocate_dt_pack_buffer(&p_buf, buf_type)) {
         /* Error allocating memory */
         MPI_CHECK(MPI_Finalize());
         exit(EXIT_FAILURE);
@@ -110,6 +135,7 @@ int main(int argc, char* argv[])
 
     MPI_CHECK(MPI_Finalize());
 
+    free_dt_pack_buffer(p_buf, buf_type);
     free_memory_pt2pt_mul(s_buf, r_buf, rank, pairs);
 
     return EXIT_SUCCESS;
@@ -121,16 +147,16 @@ static void multi_latency(int rank, int pairs)
     int i;
     double t_start = 0.0, t_end = 0.0,
            latency = 0.0, total_lat = 0.0,
-           avg_lat = 0.0;
+           avg_lat = 0.0, pack_lat = 0.0, avg_pack_lat = 0.0;
 
     MPI_Request request;
     MPI_Status reqstat;
 
-    int rep_count;
+    int rep_count, packed;
     MPI_Datatype type;
 
 
-    for(size = options.min_message_size; size <= options.max_message_size; size  = (size ? size * 2 : 1)) {
+    for(size = options.min_message_size; size <= options.max_message_size; size = next_message_size(size)) {
 
         if(size > LARGE_MESSAGE_SIZE) {
             options.iterations = options.iterations_large;
@@ -141,9 +167,8 @@ static void multi_latency(int rank, int pairs)
         }
 
         /* Define DDT */
-        rep_count = size / options.dt_block_size;
-        MPI_CHECK(MPI_Type_vector(rep_count, options.dt_block_size, options.dt_stride_size, MPI_CHAR, &type));
-        MPI_CHECK(MPI_Type_commit(&type));
+        rep_count = create_dt_type(size, &type);
+        packed = rep_count * options.dt_block_size;
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
@@ -153,7 +178,7 @@ static void multi_latency(int rank, int pairs)
             for (i = 0; i < options.iterations + options.skip; i++) {
 
                 if (i == options.skip) {
-                    t_start = MPI_Wtime();
+                    t_start = osu_wtime();
                     MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
                 }
 
@@ -163,7 +188,7 @@ static void multi_latency(int rank, int pairs)
                 MPI_CHECK(MPI_Wait(&request, &reqstat));
             }
 
-            t_end = MPI_Wtime();
+            t_end = osu_wtime();
 
         } else {
             partner = rank - pairs;
@@ -171,7 +196,7 @@ static void multi_latency(int rank, int pairs)
             for (i = 0; i < options.iterations + options.skip; i++) {
 
                 if (i == options.skip) {
-                    t_start = MPI_Wtime();
+                    t_start = osu_wtime();
                     MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
                 }
 
@@ -181,7 +206,7 @@ static void multi_latency(int rank, int pairs)
                 MPI_CHECK(MPI_Wait(&request, &reqstat));
             }
 
-            t_end = MPI_Wtime();
+            t_end = osu_wtime();
         }
 
         MPI_CHECK(MPI_Type_free(&type));
@@ -193,13 +218,67 @@ static void multi_latency(int rank, int pairs)
 
         avg_lat = total_lat/(double) (pairs * 2);
 
+        /* Same blocks, packed by the application */
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+        partner = (rank < pairs) ? rank + pairs : rank - pairs;
+
+        for (i = 0; i < options.iterations + options.skip; i++) {
+
+            if (i == options.skip) {
+                t_start = osu_wtime();
+                MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+            }
+
+            if (rank < pairs) {
+                dt_pack(p_buf, s_buf, rep_count, buf_type, 0);
+                MPI_CHECK(MPI_Isend(p_buf, packed, MPI_CHAR, partner, 1, MPI_COMM_WORLD, &request));
+                MPI_CHECK(MPI_Wait(&request, &reqstat));
+                MPI_CHECK(MPI_Irecv(p_buf, packed, MPI_CHAR, partner, 1, MPI_COMM_WORLD, &request));
+                MPI_CHECK(MPI_Wait(&request, &reqstat));
+                dt_pack(p_buf, r_buf, rep_count, buf_type, 1);
+            } else {
+                MPI_CHECK(MPI_Irecv(p_buf, packed, MPI_CHAR, partner, 1, MPI_COMM_WORLD, &request));
+                MPI_CHECK(MPI_Wait(&request, &reqstat));
+                dt_pack(p_buf, r_buf, rep_count, buf_type, 1);
+                dt_pack(p_buf, s_buf, rep_count, buf_type, 0);
+                MPI_CHECK(MPI_Isend(p_buf, packed, MPI_CHAR, partner, 1, MPI_COMM_WORLD, &request));
+                MPI_CHECK(MPI_Wait(&request, &reqstat));
+            }
+        }
+
+        t_end = osu_wtime();
+
+        latency = (t_end - t_start) * 1.0e6 / (2.0 * options.iterations);
+
+        MPI_CHECK(MPI_Reduce(&latency, &pack_lat, 1, MPI_DOUBLE, MPI_SUM, 0,
+                   MPI_COMM_WORLD));
+
+        avg_pack_lat = pack_lat/(double) (pairs * 2);
+
         if(0 == rank) {
-            fprintf(stdout, "%-*d%-*d%-*d%*.*f\n",
-                    10, size,
-                    10, options.dt_block_size,
-                    10, options.dt_stride_size,
-                    FIELD_WIDTH, FLOAT_PRECISION, avg_lat);
-            fflush(stdout);
+            record_message_size(size, avg_lat);
+
+            if (OUTPUT_TABLE != options.output_format) {
+                struct result_metric_t metrics[] = {
+                    {"block_size", options.dt_block_size},
+                    {"stride_size", options.dt_stride_size},
+                    {"increase_size", options.dt_increase_size},
+                    {"latency_us", avg_lat},
+                    {"user_pack_latency_us", avg_pack_lat},
+                };
+
+                output_result(benchmark_num_ranks, size, 5, metrics);
+            } else {
+                fprintf(stdout, "%-*d%-*d%-*d%-*d%*.*f%*.*f\n",
+                        10, size,
+                        10, options.dt_block_size,
+                        10, options.dt_stride_size,
+                        10, options.dt_increase_size,
+                        FIELD_WIDTH, FLOAT_PRECISION, avg_lat,
+                        FIELD_WIDTH, FLOAT_PRECISION, avg_pack_lat);
+                fflush(stdout);
+            }
         }
     }
 }
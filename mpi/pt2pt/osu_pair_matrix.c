@@ -0,0 +1,458 @@
+#define BENCHMARK "OSU MPI All-Pairs Latency / Bandwidth Matrix Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+#include <osu_util_mpi.h>
+
+/*
+ * Every rank meets every other rank once in a round robin tournament: with
+ * the ranks padded to an even count M + 1, rank M sits still and the others
+ * rotate, which gives M rounds of disjoint pairs.  In every round each pair
+ * measures its latency and the bandwidth in both directions, so the full
+ * matrices take O(N) rounds instead of O(N^2) sequential tests.
+ */
+#define MATRIX_MAGIC "OMBPAIRS"
+#define MATRIX_VERSION 1
+#define MAX_OUTLIERS_PRINTED 20
+#define MAX_RANKS_PRINTED 10
+
+static char *s_buf, *r_buf;
+static MPI_Request *mbw_request;
+static MPI_Status *mbw_reqstat;
+
+static int round_partner(int rank, int nprocs, int round);
+static double measure_latency(int initiator, int partner);
+static double send_bandwidth(int partner);
+static void recv_bandwidth(int partner);
+static void print_matrix_report(int nprocs, int nrounds, double *lat, double *bw);
+static int write_matrix_file(char const *file, int nprocs, double const *lat,
+        double const *bw);
+
+int main(int argc, char *argv[])
+{
+    int rank, nprocs, nrounds, round, partner;
+    double *lat_row, *bw_row, *lat = NULL, *bw = NULL;
+    int po_ret = 0;
+
+    options.bench = PT2PT;
+    options.subtype = MATRIX;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_pair_matrix");
+
+    po_ret = process_options(argc, argv);
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    set_num_ranks(nprocs);
+
+    if (0 == rank) {
+        switch (po_ret) {
+            case PO_BAD_USAGE:
+                print_bad_usage_message(rank);
+                break;
+            case PO_HELP_MESSAGE:
+                print_help_message(rank);
+                break;
+            case PO_VERSION_MESSAGE:
+                print_version_message(rank);
+                break;
+            default:
+                break;
+        }
+    }
+
+    switch (po_ret) {
+        case PO_OKAY:
+            break;
+        case PO_HELP_MESSAGE:
+        case PO_VERSION_MESSAGE:
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        default:
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+    }
+
+    if (nprocs < 2) {
+        if (0 == rank) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (options.min_message_size > options.max_message_size) {
+        options.min_message_size = options.max_message_size;
+    }
+
+    if (setup_affinity()) {
+        if (rank == 0) {
+            fprintf(stderr, "Could not apply the requested CPU binding\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (allocate_memory_pt2pt_mul(&s_buf, &r_buf, rank, nprocs)) {
+        /* Error allocating memory */
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    set_buffer(s_buf, NONE, 'a', options.max_message_size);
+    set_buffer(r_buf, NONE, 'b', options.max_message_size);
+
+    mbw_request = malloc(sizeof(MPI_Request) * options.window_size);
+    mbw_reqstat = malloc(sizeof(MPI_Status) * options.window_size);
+    lat_row = calloc(nprocs, sizeof(double));
+    bw_row = calloc(nprocs, sizeof(double));
+
+    if (0 == rank) {
+        lat = malloc(sizeof(double) * nprocs * nprocs);
+        bw = malloc(sizeof(double) * nprocs * nprocs);
+    }
+
+    if (!mbw_request || !mbw_reqstat || !lat_row || !bw_row ||
+            (0 == rank && (!lat || !bw))) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    nrounds = nprocs + (nprocs & 1) - 1;
+
+    for (round = 0; round < nrounds; round++) {
+        partner = round_partner(rank, nprocs, round);
+
+        /* Keep the rounds apart so that only disjoint pairs overlap */
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+        if (0 > partner) {
+            continue;
+        }
+
+        lat_row[partner] = measure_latency(rank < partner, partner);
+
+        if (rank < partner) {
+            bw_row[partner] = send_bandwidth(partner);
+            recv_bandwidth(partner);
+        } else {
+            recv_bandwidth(partner);
+            bw_row[partner] = send_bandwidth(partner);
+        }
+    }
+
+    MPI_CHECK(MPI_Gather(lat_row, nprocs, MPI_DOUBLE, lat, nprocs, MPI_DOUBLE,
+                0, MPI_COMM_WORLD));
+    MPI_CHECK(MPI_Gather(bw_row, nprocs, MPI_DOUBLE, bw, nprocs, MPI_DOUBLE,
+                0, MPI_COMM_WORLD));
+
+    if (0 == rank) {
+        print_matrix_report(nprocs, nrounds, lat, bw);
+
+        if (options.matrix_file &&
+                write_matrix_file(options.matrix_file, nprocs, lat, bw)) {
+            fprintf(stderr, "Could not write matrix file %s\n",
+                    options.matrix_file);
+        }
+
+        free(lat);
+        free(bw);
+    }
+
+    free(mbw_request);
+    free(mbw_reqstat);
+    free(lat_row);
+    free(bw_row);
+    free_memory_pt2pt_mul(s_buf, r_buf, rank, nprocs);
+
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+static int round_partner(int rank, int nprocs, int round)
+{
+    int fixed = nprocs + (nprocs & 1) - 1;
+    int partner;
+
+    if (rank == fixed) {
+        partner = round;
+    } else if (rank == round) {
+        partner = fixed;
+    } else {
+        partner = ((2 * round - rank) % fixed + fixed) % fixed;
+    }
+
+    /* The padding rank of an odd count is a bye */
+    return (partner < nprocs) ? partner : -1;
+}
+
+static double measure_latency(int initiator, int partner)
+{
+    int size = options.min_message_size;
+    double t_start = 0.0, t_end = 0.0;
+    MPI_Status reqstat;
+    int i;
+
+    for (i = 0; i < options.iterations + options.skip; i++) {
+        if (i == options.skip) {
+            t_start = osu_wtime();
+        }
+
+        if (initiator) {
+            MPI_CHECK(MPI_Send(s_buf, size, MPI_CHAR, partner, 1, MPI_COMM_WORLD));
+            MPI_CHECK(MPI_Recv(r_buf, size, MPI_CHAR, partner, 1, MPI_COMM_WORLD,
+                        &reqstat));
+        } else {
+            MPI_CHECK(MPI_Recv(r_buf, size, MPI_CHAR, partner, 1, MPI_COMM_WORLD,
+                        &reqstat));
+            MPI_CHECK(MPI_Send(s_buf, size, MPI_CHAR, partner, 1, MPI_COMM_WORLD));
+        }
+    }
+
+    t_end = osu_wtime();
+
+    return (t_end - t_start) * 1e6 / (2.0 * options.iterations);
+}
+
+static double send_bandwidth(int partner)
+{
+    int size = options.max_message_size;
+    double t_start = 0.0, t_end = 0.0;
+    int i, j;
+
+    for (i = 0; i < options.iterations_large + options.skip_large; i++) {
+        if (i == options.skip_large) {
+            t_start = osu_wtime();
+        }
+
+        for (j = 0; j < options.window_size; j++) {
+            MPI_CHECK(MPI_Isend(s_buf, size, MPI_CHAR, partner, 100,
+                        MPI_COMM_WORLD, mbw_request + j));
+        }
+
+        MPI_CHECK(MPI_Waitall(options.window_size, mbw_request, mbw_reqstat));
+        MPI_CHECK(MPI_Recv(r_buf, 4, MPI_CHAR, partner, 101, MPI_COMM_WORLD,
+                    &mbw_reqstat[0]));
+    }
+
+    t_end = osu_wtime();
+
+    return size / 1e6 * options.iterations_large * options.window_size /
+        (t_end - t_start);
+}
+
+static void recv_bandwidth(int partner)
+{
+    int size = options.max_message_size;
+    int i, j;
+
+    for (i = 0; i < options.iterations_large + options.skip_large; i++) {
+        for (j = 0; j < options.window_size; j++) {
+            MPI_CHECK(MPI_Irecv(r_buf, size, MPI_CHAR, partner, 100,
+                        MPI_COMM_WORLD, mbw_request + j));
+        }
+
+        MPI_CHECK(MPI_Waitall(options.window_size, mbw_request, mbw_reqstat));
+        MPI_CHECK(MPI_Send(s_buf, 4, MPI_CHAR, partner, 101, MPI_COMM_WORLD));
+    }
+}
+
+static int compare_double(void const *a, void const *b)
+{
+    double x = *(double const *)a, y = *(double const *)b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+ * Sorts the off-diagonal entries of MATRIX into SCRATCH; returns the count
+ */
+static int sort_links(int nprocs, double const *matrix, double *scratch)
+{
+    int i, j, n = 0;
+
+    for (i = 0; i < nprocs; i++) {
+        for (j = 0; j < nprocs; j++) {
+            if (i != j) {
+                scratch[n++] = matrix[i * nprocs + j];
+            }
+        }
+    }
+
+    qsort(scratch, n, sizeof(double), compare_double);
+
+    return n;
+}
+
+static void print_matrix_report(int nprocs, int nrounds, double *lat, double *bw)
+{
+    double *scratch = malloc(sizeof(double) * nprocs * nprocs);
+    int *rank_outliers = calloc(nprocs, sizeof(int));
+    double lat_min, lat_med, lat_max, bw_min, bw_med, bw_max;
+    double threshold = options.outlier_threshold;
+    int i, j, n, outliers = 0, printed = 0;
+
+    if (!scratch || !rank_outliers) {
+        fprintf(stderr, "Could not allocate memory for the report\n");
+        free(scratch);
+        free(rank_outliers);
+        return;
+    }
+
+    n = sort_links(nprocs, lat, scratch);
+    lat_min = scratch[0];
+    lat_med = scratch[n / 2];
+    lat_max = scratch[n - 1];
+
+    n = sort_links(nprocs, bw, scratch);
+    bw_min = scratch[0];
+    bw_med = scratch[n / 2];
+    bw_max = scratch[n - 1];
+
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "# [ ranks: %d ] [ rounds: %d ] [ latency size: %d ] "
+                "[ bandwidth size: %d ] [ window size: %d ]\n", nprocs, nrounds,
+                (int)options.min_message_size, (int)options.max_message_size,
+                options.window_size);
+        fprintf(stdout, "%-*s%*s%*s%*s\n", 20, "#", FIELD_WIDTH, "Min",
+                FIELD_WIDTH, "Median", FIELD_WIDTH, "Max");
+        fprintf(stdout, "%-*s%*.*f%*.*f%*.*f\n", 20, "# Latency (us)",
+                FIELD_WIDTH, FLOAT_PRECISION, lat_min,
+                FIELD_WIDTH, FLOAT_PRECISION, lat_med,
+                FIELD_WIDTH, FLOAT_PRECISION, lat_max);
+        fprintf(stdout, "%-*s%*.*f%*.*f%*.*f\n", 20, "# Bandwidth (MB/s)",
+                FIELD_WIDTH, FLOAT_PRECISION, bw_min,
+                FIELD_WIDTH, FLOAT_PRECISION, bw_med,
+                FIELD_WIDTH, FLOAT_PRECISION, bw_max);
+        fprintf(stdout, "#\n# Outlier links (latency above %.2f x median or "
+                "bandwidth below median / %.2f)\n", threshold, threshold);
+        fprintf(stdout, "%-*s%*s%*s%*s\n", 10, "# Src", 10, "Dst",
+                FIELD_WIDTH, "Latency (us)", FIELD_WIDTH, "Bandwidth (MB/s)");
+    }
+
+    for (i = 0; i < nprocs; i++) {
+        for (j = 0; j < nprocs; j++) {
+            double l = lat[i * nprocs + j], b = bw[i * nprocs + j];
+            int outlier = (i != j) && (l > threshold * lat_med ||
+                    b * threshold < bw_med);
+
+            if (i == j) {
+                continue;
+            }
+
+            if (outlier) {
+                outliers++;
+                rank_outliers[i]++;
+                rank_outliers[j]++;
+            }
+
+            if (OUTPUT_TABLE != options.output_format) {
+                struct result_metric_t metrics[] = {
+                    {"src_rank", i},
+                    {"dst_rank", j},
+                    {"latency_us", l},
+                    {"bw_size", options.max_message_size},
+                    {"bandwidth_MBps", b},
+                    {"outlier", outlier},
+                };
+
+                output_result(nprocs, options.min_message_size,
+                        sizeof(metrics) / sizeof(metrics[0]), metrics);
+            } else if (outlier && printed++ < MAX_OUTLIERS_PRINTED) {
+                fprintf(stdout, "%-*d%*d%*.*f%*.*f\n", 10, i, 10, j,
+                        FIELD_WIDTH, FLOAT_PRECISION, l,
+                        FIELD_WIDTH, FLOAT_PRECISION, b);
+            }
+        }
+    }
+
+    if (OUTPUT_TABLE == options.output_format) {
+        if (outliers > MAX_OUTLIERS_PRINTED) {
+            fprintf(stdout, "# ... %d more\n", outliers - MAX_OUTLIERS_PRINTED);
+        }
+
+        fprintf(stdout, "# %d of %d links are outliers\n", outliers,
+                nprocs * (nprocs - 1));
+
+        /*
+         * A bad node or HCA shows up on many links, a bad cable on one; list
+         * the ranks that take part in the most outlier links
+         */
+        if (outliers) {
+            fprintf(stdout, "#\n%-*s%*s\n", 10, "# Rank", FIELD_WIDTH,
+                    "Outlier links");
+
+            for (printed = 0; printed < MAX_RANKS_PRINTED; printed++) {
+                int worst = 0;
+
+                for (i = 1; i < nprocs; i++) {
+                    if (rank_outliers[i] > rank_outliers[worst]) {
+                        worst = i;
+                    }
+                }
+
+                if (0 == rank_outliers[worst]) {
+                    break;
+                }
+
+                fprintf(stdout, "%-*d%*d\n", 10, worst, FIELD_WIDTH,
+                        rank_outliers[worst]);
+                rank_outliers[worst] = 0;
+            }
+        }
+
+        fflush(stdout);
+    }
+
+    free(scratch);
+    free(rank_outliers);
+}
+
+/*
+ * Binary layout, native byte order: the 8 byte magic "OMBPAIRS", int32
+ * version, int32 number of ranks, uint64 latency and bandwidth message
+ * sizes, then the row major latency (us) and bandwidth (MB/s) matrices as
+ * doubles.  Row i holds the values measured by rank i towards every rank.
+ */
+static int write_matrix_file(char const *file, int nprocs, double const *lat,
+        double const *bw)
+{
+    FILE *fp = fopen(file, "wb");
+    int32_t header[2] = {MATRIX_VERSION, nprocs};
+    uint64_t sizes[2] = {options.min_message_size, options.max_message_size};
+    size_t count = (size_t)nprocs * nprocs;
+    int ret = 0;
+
+    if (NULL == fp) {
+        return -1;
+    }
+
+    if (1 != fwrite(MATRIX_MAGIC, 8, 1, fp) ||
+            2 != fwrite(header, sizeof(int32_t), 2, fp) ||
+            2 != fwrite(sizes, sizeof(uint64_t), 2, fp) ||
+            count != fwrite(lat, sizeof(double), count, fp) ||
+            count != fwrite(bw, sizeof(double), count, fp)) {
+        ret = -1;
+    }
+
+    if (fclose(fp)) {
+        ret = -1;
+    }
+
+    return ret;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
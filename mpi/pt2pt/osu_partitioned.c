@@ -0,0 +1,365 @@
+#define BENCHMARK "OSU MPI%s Partitioned Point-to-Point Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * Rank 0 fills a partitioned send buffer from a pool of producer threads,
+ * each of which marks its partitions with MPI_Pready as soon as they are
+ * written.  Rank 1 polls MPI_Parrived and timestamps every partition.  Ready
+ * and arrival times are put on a common clock with estimate_clock_offset(),
+ * giving the per-partition ready-to-arrival latency and the time from the
+ * first MPI_Pready to the last arrival, which the bandwidth is based on.
+ */
+
+#include <osu_util_mpi.h>
+
+#define PART_TAG            1
+#define CLOCK_SYNC_ROUNDS   100
+
+pthread_barrier_t start_barrier;
+pthread_barrier_t done_barrier;
+
+MPI_Request part_request;
+char *part_buf = NULL;
+int part_count = 0;
+int part_per_thread = 0;
+int part_fill = 0;
+int stop_threads = 0;
+double t_ready[MAX_NUM_PARTITIONS];
+
+typedef struct thread_tag  {
+        int id;
+} thread_tag_t;
+
+void * producer_thread(void *arg);
+static void run_sender (size_t size, int partitions, int threads,
+        double offset);
+static void run_receiver (size_t size, int partitions);
+
+int main(int argc, char *argv[])
+{
+    int numprocs = 0, provided = 0, myid = 0, err = 0;
+    int po_ret = 0;
+    int threads = 0, partitions = 0;
+    size_t size = 0;
+    double offset = 0.0;
+
+    options.bench = PT2PT;
+    options.subtype = LAT_PART;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_partitioned");
+
+    po_ret = process_options(argc, argv);
+
+    err = MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+
+    if (err != MPI_SUCCESS) {
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, 1));
+    }
+
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    set_num_ranks(numprocs);
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &myid));
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_bad_usage_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (numprocs != 2) {
+        if (myid == 0) {
+            fprintf(stderr, "This test requires exactly two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+
+        return EXIT_FAILURE;
+    }
+
+    if (provided != MPI_THREAD_MULTIPLE) {
+        if (myid == 0) {
+            fprintf(stderr,
+                "MPI_Init_thread must return MPI_THREAD_MULTIPLE!\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+
+        return EXIT_FAILURE;
+    }
+
+    if (setup_affinity()) {
+        if (myid == 0) {
+            fprintf(stderr, "Could not apply the requested CPU binding\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    if (posix_memalign((void **)&part_buf, getpagesize(),
+                options.max_message_size)) {
+        fprintf(stderr, "Error allocating memory on Rank %d\n", myid);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+    if (bind_memory(part_buf, options.max_message_size)) {
+        fprintf(stderr, "Error binding memory to NUMA node %d on Rank %d\n",
+                options.mem_node, myid);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+    memset(part_buf, 0, options.max_message_size);
+
+    print_header(myid, LAT_PART);
+    if (0 == myid && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "# Max sender threads: %d, max partitions: %d\n",
+                options.num_threads, options.num_partitions);
+        fprintf(stdout, "%-*s%*s%*s%*s%*s%*s%*s\n", 10, "# Size",
+                12, "Partitions", 10, "Threads",
+                FIELD_WIDTH, "Avg Part(us)", FIELD_WIDTH, "Max Part(us)",
+                FIELD_WIDTH, "Complete(us)", FIELD_WIDTH, "Bandwidth(MB/s)");
+        fflush(stdout);
+    }
+
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        if (size > LARGE_MESSAGE_SIZE) {
+            options.iterations = options.iterations_large;
+            options.skip = options.skip_large;
+        }
+
+        for (threads = 1; threads <= options.num_threads; threads *= 2) {
+            for (partitions = threads; partitions <= options.num_partitions;
+                    partitions *= 2) {
+                /* every partition must hold a whole number of bytes */
+                if (size < partitions || size % partitions) {
+                    continue;
+                }
+
+                MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+                offset = estimate_clock_offset(1 - myid, CLOCK_SYNC_ROUNDS);
+
+                if (0 == myid) {
+                    run_sender(size, partitions, threads, offset);
+                } else {
+                    run_receiver(size, partitions);
+                }
+            }
+        }
+    }
+
+    free(part_buf);
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * Times are converted to the sender's clock with OFFSET, the receiver's
+ * MPI_Wtime() minus the sender's.
+ */
+static void run_sender (size_t size, int partitions, int threads,
+        double offset)
+{
+    pthread_t producers[MAX_NUM_THREADS];
+    thread_tag_t tags[MAX_NUM_THREADS];
+    double sum_ready[MAX_NUM_PARTITIONS] = {0};
+    double remote[MAX_NUM_PARTITIONS + 1];
+    double sum_first = 0.0, first = 0.0, latency = 0.0;
+    double avg_lat = 0.0, max_lat = 0.0, complete = 0.0, bw = 0.0;
+    int i = 0, p = 0;
+
+    MPI_CHECK(MPI_Psend_init(part_buf, partitions, size / partitions,
+                MPI_CHAR, 1, PART_TAG, MPI_COMM_WORLD, MPI_INFO_NULL,
+                &part_request));
+
+    part_count = size / partitions;
+    part_per_thread = partitions / threads;
+    stop_threads = 0;
+
+    /* the main thread drives MPI_Start and MPI_Wait around the producers */
+    pthread_barrier_init(&start_barrier, NULL, threads + 1);
+    pthread_barrier_init(&done_barrier, NULL, threads + 1);
+
+    for (i = 0; i < threads; i++) {
+        tags[i].id = i;
+        pthread_create(&producers[i], NULL, producer_thread, &tags[i]);
+    }
+
+    for (i = 0; i < options.iterations + options.skip; i++) {
+        MPI_CHECK(MPI_Start(&part_request));
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+        part_fill = i;
+        pthread_barrier_wait(&start_barrier);
+        pthread_barrier_wait(&done_barrier);
+
+        MPI_CHECK(MPI_Wait(&part_request, MPI_STATUS_IGNORE));
+
+        if (i >= options.skip) {
+            first = t_ready[0];
+            for (p = 0; p < partitions; p++) {
+                sum_ready[p] += t_ready[p];
+                if (t_ready[p] < first) {
+                    first = t_ready[p];
+                }
+            }
+            sum_first += first;
+        }
+    }
+
+    stop_threads = 1;
+    pthread_barrier_wait(&start_barrier);
+
+    for (i = 0; i < threads; i++) {
+        pthread_join(producers[i], NULL);
+    }
+
+    pthread_barrier_destroy(&start_barrier);
+    pthread_barrier_destroy(&done_barrier);
+    MPI_CHECK(MPI_Request_free(&part_request));
+
+    /* per-partition arrival sums followed by the last-arrival sum */
+    MPI_CHECK(MPI_Recv(remote, partitions + 1, MPI_DOUBLE, 1, PART_TAG,
+                MPI_COMM_WORLD, MPI_STATUS_IGNORE));
+
+    for (p = 0; p < partitions; p++) {
+        latency = (remote[p] - sum_ready[p]) / options.iterations - offset;
+        avg_lat += latency;
+        if (latency > max_lat) {
+            max_lat = latency;
+        }
+    }
+
+    avg_lat = avg_lat * 1e6 / partitions;
+    max_lat *= 1e6;
+    complete = ((remote[partitions] - sum_first) / options.iterations
+            - offset) * 1e6;
+    bw = complete > 0 ? size / complete : 0.0;
+
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "%-*zu%*d%*d%*.*f%*.*f%*.*f%*.*f\n", 10, size,
+                12, partitions, 10, threads,
+                FIELD_WIDTH, FLOAT_PRECISION, avg_lat,
+                FIELD_WIDTH, FLOAT_PRECISION, max_lat,
+                FIELD_WIDTH, FLOAT_PRECISION, complete,
+                FIELD_WIDTH, FLOAT_PRECISION, bw);
+        fflush(stdout);
+    } else {
+        struct result_metric_t metrics[6] = {
+            {"partitions", partitions},
+            {"threads", threads},
+            {"partition_latency_us", avg_lat},
+            {"max_partition_latency_us", max_lat},
+            {"completion_us", complete},
+            {"bandwidth_MBps", bw},
+        };
+
+        output_result(benchmark_num_ranks, size, 6, metrics);
+    }
+}
+
+static void run_receiver (size_t size, int partitions)
+{
+    double sums[MAX_NUM_PARTITIONS + 1] = {0};
+    double t_arrived[MAX_NUM_PARTITIONS];
+    int arrived[MAX_NUM_PARTITIONS];
+    int i = 0, p = 0, remaining = 0, flag = 0;
+    double last = 0.0;
+
+    MPI_CHECK(MPI_Precv_init(part_buf, partitions, size / partitions,
+                MPI_CHAR, 0, PART_TAG, MPI_COMM_WORLD, MPI_INFO_NULL,
+                &part_request));
+
+    for (i = 0; i < options.iterations + options.skip; i++) {
+        memset(arrived, 0, partitions * sizeof(int));
+        remaining = partitions;
+
+        MPI_CHECK(MPI_Start(&part_request));
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+        while (remaining) {
+            for (p = 0; p < partitions; p++) {
+                if (arrived[p]) {
+                    continue;
+                }
+
+                MPI_CHECK(MPI_Parrived(part_request, p, &flag));
+                if (flag) {
+                    t_arrived[p] = osu_wtime();
+                    arrived[p] = 1;
+                    remaining--;
+                }
+            }
+        }
+
+        MPI_CHECK(MPI_Wait(&part_request, MPI_STATUS_IGNORE));
+
+        if (i >= options.skip) {
+            last = t_arrived[0];
+            for (p = 0; p < partitions; p++) {
+                sums[p] += t_arrived[p];
+                if (t_arrived[p] > last) {
+                    last = t_arrived[p];
+                }
+            }
+            sums[partitions] += last;
+        }
+    }
+
+    MPI_CHECK(MPI_Request_free(&part_request));
+    MPI_CHECK(MPI_Send(sums, partitions + 1, MPI_DOUBLE, 0, PART_TAG,
+                MPI_COMM_WORLD));
+}
+
+/*
+ * Each producer owns a contiguous block of partitions.  It writes a
+ * partition, timestamps it and hands it to MPI right away, so partitions
+ * become ready in a staggered fashion as they would from a compute loop.
+ */
+void * producer_thread(void *arg)
+{
+    thread_tag_t *thread_id = (thread_tag_t *)arg;
+    int first = thread_id->id * part_per_thread;
+    int p = 0;
+
+    bind_thread(thread_id->id);
+
+    for (;;) {
+        pthread_barrier_wait(&start_barrier);
+        if (stop_threads) {
+            break;
+        }
+
+        for (p = first; p < first + part_per_thread; p++) {
+            memset(part_buf + (size_t)p * part_count, part_fill & 0xff,
+                    part_count);
+            t_ready[p] = osu_wtime();
+            MPI_CHECK(MPI_Pready(p, part_request));
+        }
+
+        pthread_barrier_wait(&done_barrier);
+    }
+
+    return NULL;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -0,0 +1,328 @@
+#define BENCHMARK "OSU MPI Multi-threaded Probe Latency Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * Thread i of rank 0 runs a ping-pong with rank 1, whose threads receive the
+ * pings the way a server of variable-size messages does, for every message
+ * size and every power of two of threads up to -t:
+ *
+ *   Recv     MPI_Recv of the known size, the baseline
+ *   Probe    MPI_Probe, MPI_Get_count and MPI_Recv
+ *   Iprobe   MPI_Iprobe polled until it succeeds, then MPI_Recv
+ *   Mprobe   MPI_Mprobe, MPI_Get_count and MPI_Mrecv
+ *   Improbe  MPI_Improbe polled until it succeeds, then MPI_Mrecv
+ *
+ * MPI_Probe and MPI_Iprobe are only thread safe if no other thread can
+ * receive the probed message, so with them every thread has a tag of its
+ * own.  The matched probes take the message off the queue and are what a
+ * multi-threaded server uses, they probe with MPI_ANY_TAG and any thread of
+ * rank 1 may serve any thread of rank 0.  The reply goes back with the tag
+ * of the ping.  Half the round trip of the slowest thread of rank 0 is
+ * printed.
+ */
+
+#include <osu_util_mpi.h>
+
+#define DATA_TAG    1
+
+enum probe_mode {
+    PROBE_RECV,
+    PROBE_PROBE,
+    PROBE_IPROBE,
+    PROBE_MPROBE,
+    PROBE_IMPROBE,
+    PROBE_NUM
+};
+
+static char const *mode_column[PROBE_NUM] = {"Recv (us)", "Probe (us)",
+    "Iprobe (us)", "Mprobe (us)", "Improbe (us)"};
+static char const *mode_metric[PROBE_NUM] = {"recv_us", "probe_us",
+    "iprobe_us", "mprobe_us", "improbe_us"};
+
+pthread_barrier_t thread_barrier;
+
+int myid = 0;
+size_t msg_size = 0;
+enum probe_mode mode = PROBE_RECV;
+char *s_bufs[MAX_NUM_THREADS];
+char *r_bufs[MAX_NUM_THREADS];
+double thread_time[MAX_NUM_THREADS];
+
+typedef struct thread_tag  {
+        int id;
+} thread_tag_t;
+
+void * probe_thread(void *arg);
+static int serve (int id, int tag);
+static double run_mode (int threads);
+
+int main(int argc, char *argv[])
+{
+    int numprocs = 0, provided = 0, err = 0;
+    int po_ret = 0;
+    int i = 0, threads = 0;
+    double value[PROBE_NUM];
+
+    options.bench = PT2PT;
+    options.subtype = PROBE_MT;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_probe_mt");
+
+    po_ret = process_options(argc, argv);
+
+    err = MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+
+    if (err != MPI_SUCCESS) {
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, 1));
+    }
+
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    set_num_ranks(numprocs);
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &myid));
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_bad_usage_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (numprocs != 2) {
+        if (myid == 0) {
+            fprintf(stderr, "This test requires exactly two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+
+        return EXIT_FAILURE;
+    }
+
+    if (provided != MPI_THREAD_MULTIPLE) {
+        if (myid == 0) {
+            fprintf(stderr,
+                "MPI_Init_thread must return MPI_THREAD_MULTIPLE!\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+
+        return EXIT_FAILURE;
+    }
+
+    if (setup_affinity()) {
+        if (myid == 0) {
+            fprintf(stderr, "Could not apply the requested CPU binding\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    for (i = 0; i < options.num_threads; i++) {
+        if (posix_memalign((void **)&s_bufs[i], getpagesize(),
+                    MAX(1, options.max_message_size)) ||
+                posix_memalign((void **)&r_bufs[i], getpagesize(),
+                    MAX(1, options.max_message_size))) {
+            fprintf(stderr, "Error allocating memory on Rank %d\n", myid);
+            MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+        }
+
+        if (bind_memory(s_bufs[i], options.max_message_size) ||
+                bind_memory(r_bufs[i], options.max_message_size)) {
+            fprintf(stderr, "Error binding memory to NUMA node %d on Rank %d\n",
+                    options.mem_node, myid);
+            MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+        }
+
+        memset(s_bufs[i], 'a', options.max_message_size);
+        memset(r_bufs[i], 'b', options.max_message_size);
+    }
+
+    if (0 == myid && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "%-*s%*s", 10, "# Size", 10, "Threads");
+        for (i = 0; i < PROBE_NUM; i++) {
+            fprintf(stdout, "%*s", FIELD_WIDTH, mode_column[i]);
+        }
+        fprintf(stdout, "\n");
+        fflush(stdout);
+    }
+
+    for (msg_size = options.min_message_size;
+            msg_size <= options.max_message_size;
+            msg_size = next_message_size(msg_size)) {
+        if (msg_size > LARGE_MESSAGE_SIZE) {
+            options.iterations = options.iterations_large;
+            options.skip = options.skip_large;
+        }
+
+        for (threads = 1; threads <= options.num_threads; threads *= 2) {
+            for (mode = PROBE_RECV; mode < PROBE_NUM; mode++) {
+                value[mode] = run_mode(threads);
+            }
+
+            if (0 != myid) {
+                continue;
+            }
+
+            if (OUTPUT_TABLE == options.output_format) {
+                fprintf(stdout, "%-*zu%*d", 10, msg_size, 10, threads);
+                for (i = 0; i < PROBE_NUM; i++) {
+                    fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                            value[i]);
+                }
+                fprintf(stdout, "\n");
+                fflush(stdout);
+            } else {
+                struct result_metric_t metrics[PROBE_NUM + 1];
+
+                metrics[0].name = "threads";
+                metrics[0].value = threads;
+                for (i = 0; i < PROBE_NUM; i++) {
+                    metrics[i + 1].name = mode_metric[i];
+                    metrics[i + 1].value = value[i];
+                }
+
+                output_result(numprocs, msg_size, PROBE_NUM + 1, metrics);
+            }
+        }
+    }
+
+    for (i = 0; i < options.num_threads; i++) {
+        free(s_bufs[i]);
+        free(r_bufs[i]);
+    }
+
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+/* Half the round trip of the slowest thread in microseconds on rank 0 */
+static double run_mode (int threads)
+{
+    pthread_t workers[MAX_NUM_THREADS];
+    thread_tag_t tags[MAX_NUM_THREADS];
+    double max_time = 0.0;
+    int i;
+
+    pthread_barrier_init(&thread_barrier, NULL, threads);
+    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+    for (i = 0; i < threads; i++) {
+        tags[i].id = i;
+        pthread_create(&workers[i], NULL, probe_thread, &tags[i]);
+    }
+
+    for (i = 0; i < threads; i++) {
+        pthread_join(workers[i], NULL);
+        max_time = MAX(max_time, thread_time[i]);
+    }
+
+    pthread_barrier_destroy(&thread_barrier);
+
+    return max_time * 1e6 / (2.0 * options.iterations);
+}
+
+/*
+ * Receive one ping on rank 1 with the probe of the current mode and return
+ * the tag to reply with.
+ */
+static int serve (int id, int tag)
+{
+    MPI_Status status;
+    MPI_Message message;
+    int count = msg_size, flag = 0;
+
+    switch (mode) {
+        case PROBE_RECV:
+            MPI_CHECK(MPI_Recv(r_bufs[id], msg_size, MPI_CHAR, 0, tag,
+                        MPI_COMM_WORLD, &status));
+            break;
+        case PROBE_PROBE:
+            MPI_CHECK(MPI_Probe(0, tag, MPI_COMM_WORLD, &status));
+            MPI_CHECK(MPI_Get_count(&status, MPI_CHAR, &count));
+            MPI_CHECK(MPI_Recv(r_bufs[id], count, MPI_CHAR, 0, tag,
+                        MPI_COMM_WORLD, MPI_STATUS_IGNORE));
+            break;
+        case PROBE_IPROBE:
+            do {
+                MPI_CHECK(MPI_Iprobe(0, tag, MPI_COMM_WORLD, &flag, &status));
+            } while (!flag);
+            MPI_CHECK(MPI_Get_count(&status, MPI_CHAR, &count));
+            MPI_CHECK(MPI_Recv(r_bufs[id], count, MPI_CHAR, 0, tag,
+                        MPI_COMM_WORLD, MPI_STATUS_IGNORE));
+            break;
+        case PROBE_MPROBE:
+            MPI_CHECK(MPI_Mprobe(0, MPI_ANY_TAG, MPI_COMM_WORLD, &message,
+                        &status));
+            MPI_CHECK(MPI_Get_count(&status, MPI_CHAR, &count));
+            MPI_CHECK(MPI_Mrecv(r_bufs[id], count, MPI_CHAR, &message,
+                        MPI_STATUS_IGNORE));
+            break;
+        default:
+            do {
+                MPI_CHECK(MPI_Improbe(0, MPI_ANY_TAG, MPI_COMM_WORLD, &flag,
+                            &message, &status));
+            } while (!flag);
+            MPI_CHECK(MPI_Get_count(&status, MPI_CHAR, &count));
+            MPI_CHECK(MPI_Mrecv(r_bufs[id], count, MPI_CHAR, &message,
+                        MPI_STATUS_IGNORE));
+            break;
+    }
+
+    return status.MPI_TAG;
+}
+
+void * probe_thread(void *arg)
+{
+    thread_tag_t *thread_id = (thread_tag_t *)arg;
+    int id = thread_id->id;
+    int tag = DATA_TAG + id, reply_tag = 0;
+    int i = 0;
+    double t_start = 0.0;
+
+    bind_thread(id);
+    pthread_barrier_wait(&thread_barrier);
+
+    for (i = 0; i < options.iterations + options.skip; i++) {
+        if (i == options.skip) {
+            t_start = osu_wtime();
+        }
+
+        if (0 == myid) {
+            MPI_CHECK(MPI_Send(s_bufs[id], msg_size, MPI_CHAR, 1, tag,
+                        MPI_COMM_WORLD));
+            MPI_CHECK(MPI_Recv(r_bufs[id], msg_size, MPI_CHAR, 1, tag,
+                        MPI_COMM_WORLD, MPI_STATUS_IGNORE));
+        } else {
+            reply_tag = serve(id, tag);
+            MPI_CHECK(MPI_Send(s_bufs[id], msg_size, MPI_CHAR, 0, reply_tag,
+                        MPI_COMM_WORLD));
+        }
+    }
+
+    thread_time[id] = osu_wtime() - t_start;
+
+    return NULL;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
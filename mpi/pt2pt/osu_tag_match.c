@@ -0,0 +1,272 @@
+#define BENCHMARK "OSU MPI Tag Matching Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * The matching cost of 0-byte messages with a queue of DEPTH entries that do
+ * not match, for every DEPTH of -m in the powers of two:
+ *
+ *   posted      rank 1 posts DEPTH receives with other tags and the matching
+ *               receive, behind them (--order tail) or ahead of them (head),
+ *               then rank 0 times a ping-pong.  Half the round trip is
+ *               printed, the receives that did not match are cancelled
+ *               outside of the timing.
+ *   unexpected  rank 0 sends DEPTH messages with other tags and the matching
+ *               one, after them (tail) or before them (head), and once they
+ *               have arrived rank 1 times MPI_Recv of the matching message.
+ *               The others are received outside of the timing.
+ *
+ * --wildcard source posts all receives with MPI_ANY_SOURCE, tag posts the
+ * matching receive with MPI_ANY_TAG, which matches the oldest unexpected
+ * message, and both does both.  The receives of the two ranks that keep them
+ * in step use a duplicate of MPI_COMM_WORLD so that they never share a queue
+ * with the measured ones.
+ */
+
+#include <osu_util_mpi.h>
+
+#define MATCH_TAG   1
+#define OTHER_TAG   2
+
+static MPI_Request *queue;
+static MPI_Comm sync_comm;
+
+static double posted_latency (int myid, int depth, int iterations, int skip);
+static double unexpected_latency (int myid, int depth, int iterations,
+        int skip);
+static int next_depth (int depth);
+static int recv_source (void);
+static int match_tag (void);
+
+int main (int argc, char *argv[])
+{
+    int myid, numprocs, depth, iterations, skip;
+    int po_ret = 0;
+    double value[2];
+    static char const * const wildcard_name[] = {"", "none", "MPI_ANY_SOURCE",
+        "MPI_ANY_TAG", "MPI_ANY_SOURCE and MPI_ANY_TAG"};
+
+    options.bench = PT2PT;
+    options.subtype = TAG_MATCH;
+    options.wildcard = TAG_WILDCARD_OFF;
+    options.match_order = MATCH_ORDER_TAIL;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_tag_match");
+    po_ret = process_options(argc, argv);
+    options.show_size = 0;
+
+    MPI_CHECK(MPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    set_num_ranks(numprocs);
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &myid));
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_bad_usage_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(myid);
+            MPI_CHECK(MPI_Finalize());
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (numprocs != 2) {
+        if (myid == 0) {
+            fprintf(stderr, "This test requires exactly two processes\n");
+        }
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
+    }
+
+    queue = malloc(sizeof(MPI_Request) * (options.max_message_size + 1));
+
+    if (NULL == queue) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", myid);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    MPI_CHECK(MPI_Comm_dup(MPI_COMM_WORLD, &sync_comm));
+
+    if (0 == myid && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "# Wildcards: %s, matching entry at the %s\n",
+                wildcard_name[options.wildcard],
+                MATCH_ORDER_HEAD == options.match_order ? "head" : "tail");
+        fprintf(stdout, "%-*s%*s%*s\n", 10, "# Depth", FIELD_WIDTH,
+                "Posted (us)", FIELD_WIDTH, "Unexpected (us)");
+        fflush(stdout);
+    }
+
+    for (depth = options.min_message_size; depth <= options.max_message_size;
+            depth = next_depth(depth)) {
+        if (depth > TAG_MATCH_LARGE_DEPTH) {
+            iterations = options.iterations_large;
+            skip = options.skip_large;
+        } else {
+            iterations = options.iterations;
+            skip = options.skip;
+        }
+
+        value[0] = posted_latency(myid, depth, iterations, skip);
+        value[1] = unexpected_latency(myid, depth, iterations, skip);
+
+        /* Rank 0 times the posted queue and rank 1 the unexpected one */
+        if (1 == myid) {
+            MPI_CHECK(MPI_Send(&value[1], 1, MPI_DOUBLE, 0, 0, sync_comm));
+        } else {
+            MPI_CHECK(MPI_Recv(&value[1], 1, MPI_DOUBLE, 1, 0, sync_comm,
+                        MPI_STATUS_IGNORE));
+        }
+
+        if (0 != myid) {
+            continue;
+        }
+
+        if (OUTPUT_TABLE == options.output_format) {
+            fprintf(stdout, "%-*d%*.*f%*.*f\n", 10, depth, FIELD_WIDTH,
+                    FLOAT_PRECISION, value[0], FIELD_WIDTH, FLOAT_PRECISION,
+                    value[1]);
+            fflush(stdout);
+        } else {
+            struct result_metric_t metrics[2] = {
+                {"posted_us", value[0]},
+                {"unexpected_us", value[1]},
+            };
+
+            output_result(numprocs, depth, 2, metrics);
+        }
+    }
+
+    MPI_CHECK(MPI_Comm_free(&sync_comm));
+    free(queue);
+
+    MPI_CHECK(MPI_Finalize());
+
+    return EXIT_SUCCESS;
+}
+
+static int next_depth (int depth)
+{
+    return depth ? 2 * depth : 1;
+}
+
+static int recv_source (void)
+{
+    return TAG_WILDCARD_SOURCE == options.wildcard ||
+        TAG_WILDCARD_BOTH == options.wildcard ? MPI_ANY_SOURCE : 0;
+}
+
+static int match_tag (void)
+{
+    return TAG_WILDCARD_TAG == options.wildcard ||
+        TAG_WILDCARD_BOTH == options.wildcard ? MPI_ANY_TAG : MATCH_TAG;
+}
+
+/* Half the round trip in microseconds on rank 0 */
+static double posted_latency (int myid, int depth, int iterations, int skip)
+{
+    double t_start, t_total = 0;
+    int i, k, match = MATCH_ORDER_HEAD == options.match_order ? 0 : depth;
+    char ready;
+
+    for (i = 0; i < iterations + skip; i++) {
+        if (0 == myid) {
+            MPI_CHECK(MPI_Recv(&ready, 0, MPI_CHAR, 1, 0, sync_comm,
+                        MPI_STATUS_IGNORE));
+
+            t_start = osu_wtime();
+            MPI_CHECK(MPI_Send(NULL, 0, MPI_CHAR, 1, MATCH_TAG,
+                        MPI_COMM_WORLD));
+            MPI_CHECK(MPI_Recv(NULL, 0, MPI_CHAR, 1, MATCH_TAG,
+                        MPI_COMM_WORLD, MPI_STATUS_IGNORE));
+
+            if (i >= skip) {
+                t_total += osu_wtime() - t_start;
+            }
+            continue;
+        }
+
+        for (k = 0; k <= depth; k++) {
+            MPI_CHECK(MPI_Irecv(NULL, 0, MPI_CHAR, recv_source(),
+                        k == match ? match_tag() : OTHER_TAG + k,
+                        MPI_COMM_WORLD, &queue[k]));
+        }
+
+        MPI_CHECK(MPI_Send(&ready, 0, MPI_CHAR, 0, 0, sync_comm));
+        MPI_CHECK(MPI_Wait(&queue[match], MPI_STATUS_IGNORE));
+        MPI_CHECK(MPI_Send(NULL, 0, MPI_CHAR, 0, MATCH_TAG, MPI_COMM_WORLD));
+
+        for (k = 0; k <= depth; k++) {
+            if (k != match) {
+                MPI_CHECK(MPI_Cancel(&queue[k]));
+                MPI_CHECK(MPI_Wait(&queue[k], MPI_STATUS_IGNORE));
+            }
+        }
+    }
+
+    return t_total * 1e6 / (2.0 * iterations);
+}
+
+/* Time of the matching MPI_Recv in microseconds on rank 1 */
+static double unexpected_latency (int myid, int depth, int iterations,
+        int skip)
+{
+    double t_start, t_total = 0;
+    int i, k, match = MATCH_ORDER_HEAD == options.match_order ? 0 : depth;
+    char done;
+
+    for (i = 0; i < iterations + skip; i++) {
+        if (0 == myid) {
+            for (k = 0; k <= depth; k++) {
+                MPI_CHECK(MPI_Send(NULL, 0, MPI_CHAR, 1,
+                            k == match ? MATCH_TAG : OTHER_TAG + k,
+                            MPI_COMM_WORLD));
+            }
+
+            /* Ordered behind the messages above on the same connection */
+            MPI_CHECK(MPI_Send(&done, 0, MPI_CHAR, 1, 0, sync_comm));
+            MPI_CHECK(MPI_Recv(&done, 0, MPI_CHAR, 1, 0, sync_comm,
+                        MPI_STATUS_IGNORE));
+            continue;
+        }
+
+        MPI_CHECK(MPI_Recv(&done, 0, MPI_CHAR, 0, 0, sync_comm,
+                    MPI_STATUS_IGNORE));
+
+        t_start = osu_wtime();
+        MPI_CHECK(MPI_Recv(NULL, 0, MPI_CHAR, recv_source(), match_tag(),
+                    MPI_COMM_WORLD, MPI_STATUS_IGNORE));
+
+        if (i >= skip) {
+            t_total += osu_wtime() - t_start;
+        }
+
+        /* MPI_ANY_TAG takes the oldest message, whichever is left over */
+        for (k = 0; k < depth; k++) {
+            MPI_CHECK(MPI_Recv(NULL, 0, MPI_CHAR, 0, MPI_ANY_TAG,
+                        MPI_COMM_WORLD, MPI_STATUS_IGNORE));
+        }
+
+        MPI_CHECK(MPI_Send(&done, 0, MPI_CHAR, 0, 0, sync_comm));
+    }
+
+    return t_total * 1e6 / iterations;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -0,0 +1,259 @@
+#define BENCHMARK "OSU MPI Startup Phases Test"
+#ifdef PACKAGE_VERSION
+#   define HEADER "# " BENCHMARK " v" PACKAGE_VERSION "\n"
+#else
+#   define HEADER "# " BENCHMARK "\n"
+#endif
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * Times the phases of the startup of every process separately: MPI_Init, or
+ * with -s MPI_Session_init and the creation of a communicator from the
+ * mpi://WORLD process set (MPI-4), the first barrier, a first exchange of
+ * one byte with every other rank, which is where a library that connects
+ * lazily sets up its connections, the same exchange once more in steady
+ * state, MPI_Comm_dup and MPI_Comm_split.  For every phase the minimum,
+ * average and maximum over the ranks are printed, followed by the number of
+ * ranks per power of two of the phase time.
+ */
+#include <mpi.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+enum phase {
+    PHASE_INIT,
+    PHASE_FIRST_BARRIER,
+    PHASE_FIRST_TOUCH,
+    PHASE_STEADY,
+    PHASE_COMM_DUP,
+    PHASE_COMM_SPLIT,
+    PHASE_NUM
+};
+
+static char const * phase_name[] = {"MPI_Init", "first MPI_Barrier",
+    "first all-to-all", "steady all-to-all", "MPI_Comm_dup",
+    "MPI_Comm_split"};
+
+/* Buckets of the histogram, [2^(i-1), 2^i) us with bucket 0 below 1 us */
+#define STARTUP_HIST_BUCKETS 40
+
+static double
+now_ms (void)
+{
+    struct timespec tp;
+
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+
+    return tp.tv_sec * 1e3 + tp.tv_nsec / 1e6;
+}
+
+/* Exchange one byte with every other rank, one peer at a time */
+static void
+exchange_all (MPI_Comm comm, int rank, int numprocs)
+{
+    char sbuf = 'a', rbuf;
+    int k;
+
+    for (k = 1; k < numprocs; k++) {
+        MPI_Sendrecv(&sbuf, 1, MPI_CHAR, (rank + k) % numprocs, 1, &rbuf, 1,
+                MPI_CHAR, (rank - k + numprocs) % numprocs, 1, comm,
+                MPI_STATUS_IGNORE);
+    }
+}
+
+static int
+hist_bucket (double ms)
+{
+    double us = ms * 1e3;
+    int i = 0;
+
+    while (us >= 1 && i < STARTUP_HIST_BUCKETS - 1) {
+        us /= 2;
+        i++;
+    }
+
+    return i;
+}
+
+static void
+print_phase (enum phase p, double const * all, int numprocs)
+{
+    int count[STARTUP_HIST_BUCKETS] = {0};
+    double min = all[0], max = all[0], avg = 0;
+    int i;
+
+    for (i = 0; i < numprocs; i++) {
+        min = all[i] < min ? all[i] : min;
+        max = all[i] > max ? all[i] : max;
+        avg += all[i];
+        count[hist_bucket(all[i])]++;
+    }
+
+    fprintf(stdout, "%-*s%*.3f%*.3f%*.3f\n", 20, phase_name[p], 14, min, 14,
+            avg / numprocs, 14, max);
+
+    for (i = 0; i < STARTUP_HIST_BUCKETS; i++) {
+        if (count[i]) {
+            fprintf(stdout, "#   %12.3f - %12.3f ms: %d\n",
+                    i ? (1L << (i - 1)) / 1e3 : 0.0, (1L << i) / 1e3, count[i]);
+        }
+    }
+}
+
+static void
+usage (char const * prog)
+{
+    fprintf(stdout, " USAGE : %s [-s] [-h]\n", prog);
+    fprintf(stdout, "  -s, : Start with MPI_Session_init and a communicator "
+            "of the mpi://WORLD\n");
+    fprintf(stdout, "        process set instead of MPI_Init (MPI-4).\n");
+    fprintf(stdout, "  -h, : Print this help.\n");
+    fflush(stdout);
+}
+
+int
+main (int argc, char *argv[])
+{
+    int myid, numprocs, use_session = 0, c;
+    double t_start, duration[PHASE_NUM], *all = NULL;
+    MPI_Comm comm = MPI_COMM_WORLD, dup, split;
+#if MPI_VERSION >= 4
+    MPI_Session session = MPI_SESSION_NULL;
+    MPI_Group group;
+#endif
+    enum phase p;
+
+    /* The options are read before MPI starts, every process reads them */
+    while ((c = getopt(argc, argv, "sh")) != -1) {
+        switch (c) {
+            case 's':
+                use_session = 1;
+                break;
+            case 'h':
+                usage(argv[0]);
+                return EXIT_SUCCESS;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+#if MPI_VERSION < 4
+    if (use_session) {
+        fprintf(stderr, "MPI sessions (-s) need an MPI-4 library\n");
+        return EXIT_FAILURE;
+    }
+#endif
+
+    t_start = now_ms();
+#if MPI_VERSION >= 4
+    if (use_session) {
+        MPI_Session_init(MPI_INFO_NULL, MPI_ERRORS_ARE_FATAL, &session);
+        MPI_Group_from_session_pset(session, "mpi://WORLD", &group);
+        MPI_Comm_create_from_group(group, "osu_startup", MPI_INFO_NULL,
+                MPI_ERRORS_ARE_FATAL, &comm);
+        MPI_Group_free(&group);
+    } else
+#endif
+    MPI_Init(&argc, &argv);
+    duration[PHASE_INIT] = now_ms() - t_start;
+
+    MPI_Comm_size(comm, &numprocs);
+    MPI_Comm_rank(comm, &myid);
+
+    t_start = now_ms();
+    MPI_Barrier(comm);
+    duration[PHASE_FIRST_BARRIER] = now_ms() - t_start;
+
+    t_start = now_ms();
+    exchange_all(comm, myid, numprocs);
+    duration[PHASE_FIRST_TOUCH] = now_ms() - t_start;
+
+    MPI_Barrier(comm);
+
+    t_start = now_ms();
+    exchange_all(comm, myid, numprocs);
+    duration[PHASE_STEADY] = now_ms() - t_start;
+
+    MPI_Barrier(comm);
+
+    t_start = now_ms();
+    MPI_Comm_dup(comm, &dup);
+    duration[PHASE_COMM_DUP] = now_ms() - t_start;
+
+    MPI_Barrier(comm);
+
+    t_start = now_ms();
+    MPI_Comm_split(comm, myid % 2, myid, &split);
+    duration[PHASE_COMM_SPLIT] = now_ms() - t_start;
+
+    if (myid == 0) {
+        all = malloc(sizeof(double) * PHASE_NUM * numprocs);
+
+        if (NULL == all) {
+            fprintf(stderr, "Failed to allocate memory\n");
+            MPI_Abort(comm, EXIT_FAILURE);
+        }
+    }
+
+    MPI_Gather(duration, PHASE_NUM, MPI_DOUBLE, all, PHASE_NUM, MPI_DOUBLE, 0,
+            comm);
+
+    if (myid == 0) {
+        double *phase_all = malloc(sizeof(double) * numprocs);
+        int i;
+
+        if (NULL == phase_all) {
+            fprintf(stderr, "Failed to allocate memory\n");
+            MPI_Abort(comm, EXIT_FAILURE);
+        }
+
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "# nprocs: %d, start: %s\n", numprocs,
+                use_session ? "MPI_Session_init" : "MPI_Init");
+        fprintf(stdout, "%-*s%*s%*s%*s\n", 20, "# Phase", 14, "Min(ms)", 14,
+                "Avg(ms)", 14, "Max(ms)");
+
+        for (p = PHASE_INIT; p < PHASE_NUM; p++) {
+            for (i = 0; i < numprocs; i++) {
+                phase_all[i] = all[i * PHASE_NUM + p];
+            }
+
+            if (PHASE_INIT == p && use_session) {
+                phase_name[p] = "MPI_Session_init";
+            }
+
+            print_phase(p, phase_all, numprocs);
+        }
+
+        fflush(stdout);
+        free(phase_all);
+        free(all);
+    }
+
+    MPI_Comm_free(&split);
+    MPI_Comm_free(&dup);
+
+#if MPI_VERSION >= 4
+    if (use_session) {
+        MPI_Comm_free(&comm);
+        MPI_Session_finalize(&session);
+        return EXIT_SUCCESS;
+    }
+#endif
+
+    MPI_Finalize();
+
+    return EXIT_SUCCESS;
+}
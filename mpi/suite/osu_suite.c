@@ -0,0 +1,376 @@
+#define BENCHMARK "OSU MPI Benchmark Suite"
+#ifdef PACKAGE_VERSION
+#   define HEADER "# " BENCHMARK " v" PACKAGE_VERSION "\n"
+#else
+#   define HEADER "# " BENCHMARK "\n"
+#endif
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * osu_suite runs a list of benchmarks inside a single MPI session.  Every
+ * benchmark is linked in with its main() renamed to <benchmark>_main (see
+ * Makefile.am).  MPI_Init, MPI_Init_thread and MPI_Finalize are intercepted
+ * through the MPI profiling interface so the calls made by each benchmark
+ * become no-ops; the real PMPI_Init/PMPI_Finalize are issued once by the
+ * driver.  Buffers released by a benchmark are parked in the buffer pool of
+ * util/osu_util_mpi.c and handed out again to the next one.
+ */
+#include <osu_util_mpi.h>
+
+enum suite_procs {
+    PROCS_ANY,
+    PROCS_TWO,
+    PROCS_EVEN
+};
+
+struct suite_benchmark {
+    char const * name;
+    char const * group;
+    enum suite_procs procs;
+    int (*run)(int argc, char *argv[]);
+    int selected;
+};
+
+#define SUITE_COLLECTIVE(X) \
+    X(osu_allgather, "collective", PROCS_ANY) \
+    X(osu_allgatherv, "collective", PROCS_ANY) \
+    X(osu_allreduce, "collective", PROCS_ANY) \
+    X(osu_alltoall, "collective", PROCS_ANY) \
+    X(osu_alltoallv, "collective", PROCS_ANY) \
+    X(osu_barrier, "collective", PROCS_ANY) \
+    X(osu_bcast, "collective", PROCS_ANY) \
+    X(osu_gather, "collective", PROCS_ANY) \
+    X(osu_gatherv, "collective", PROCS_ANY) \
+    X(osu_reduce, "collective", PROCS_ANY) \
+    X(osu_reduce_scatter, "collective", PROCS_ANY) \
+    X(osu_scatter, "collective", PROCS_ANY) \
+    X(osu_scatterv, "collective", PROCS_ANY) \
+    X(osu_iallgather, "collective", PROCS_ANY) \
+    X(osu_iallgatherv, "collective", PROCS_ANY) \
+    X(osu_iallreduce, "collective", PROCS_ANY) \
+    X(osu_ialltoall, "collective", PROCS_ANY) \
+    X(osu_ialltoallv, "collective", PROCS_ANY) \
+    X(osu_ialltoallw, "collective", PROCS_ANY) \
+    X(osu_ibarrier, "collective", PROCS_ANY) \
+    X(osu_ibcast, "collective", PROCS_ANY) \
+    X(osu_igather, "collective", PROCS_ANY) \
+    X(osu_igatherv, "collective", PROCS_ANY) \
+    X(osu_ireduce, "collective", PROCS_ANY) \
+    X(osu_iscatter, "collective", PROCS_ANY) \
+    X(osu_iscatterv, "collective", PROCS_ANY)
+
+#define SUITE_PT2PT(X) \
+    X(osu_latency, "pt2pt", PROCS_TWO) \
+    X(osu_bw, "pt2pt", PROCS_TWO) \
+    X(osu_bibw, "pt2pt", PROCS_TWO) \
+    X(osu_latency_dt, "pt2pt", PROCS_TWO) \
+    X(osu_multi_lat, "pt2pt", PROCS_EVEN) \
+    X(osu_multi_lat_dt, "pt2pt", PROCS_EVEN) \
+    X(osu_mbw_mr, "pt2pt", PROCS_EVEN) \
+    X(osu_pair_matrix, "pt2pt", PROCS_EVEN)
+
+#ifdef _ENABLE_SUITE_ONE_SIDED_
+#define SUITE_ONE_SIDED(X) \
+    X(osu_put_latency, "one-sided", PROCS_TWO) \
+    X(osu_get_latency, "one-sided", PROCS_TWO) \
+    X(osu_put_bw, "one-sided", PROCS_TWO) \
+    X(osu_get_bw, "one-sided", PROCS_TWO) \
+    X(osu_put_bibw, "one-sided", PROCS_TWO) \
+    X(osu_acc_latency, "one-sided", PROCS_TWO)
+#else
+#define SUITE_ONE_SIDED(X)
+#endif
+
+#ifdef _ENABLE_SUITE_MPI3_ONE_SIDED_
+#define SUITE_MPI3_ONE_SIDED(X) \
+    X(osu_get_acc_latency, "one-sided", PROCS_TWO) \
+    X(osu_fop_latency, "one-sided", PROCS_TWO) \
+    X(osu_cas_latency, "one-sided", PROCS_TWO)
+#else
+#define SUITE_MPI3_ONE_SIDED(X)
+#endif
+
+#ifdef _ENABLE_SUITE_PERSISTENT_
+#define SUITE_PERSISTENT(X) \
+    X(osu_allgather_persistent, "collective", PROCS_ANY) \
+    X(osu_allreduce_persistent, "collective", PROCS_ANY) \
+    X(osu_alltoall_persistent, "collective", PROCS_ANY) \
+    X(osu_barrier_persistent, "collective", PROCS_ANY) \
+    X(osu_bcast_persistent, "collective", PROCS_ANY) \
+    X(osu_gather_persistent, "collective", PROCS_ANY) \
+    X(osu_reduce_persistent, "collective", PROCS_ANY) \
+    X(osu_scatter_persistent, "collective", PROCS_ANY)
+#else
+#define SUITE_PERSISTENT(X)
+#endif
+
+#define SUITE_BENCHMARKS(X) \
+    SUITE_COLLECTIVE(X) \
+    SUITE_PERSISTENT(X) \
+    SUITE_PT2PT(X) \
+    SUITE_ONE_SIDED(X) \
+    SUITE_MPI3_ONE_SIDED(X)
+
+#define SUITE_DECLARE(name, group, procs) int name##_main (int, char *[]);
+SUITE_BENCHMARKS(SUITE_DECLARE)
+
+#define SUITE_ENTRY(name, group, procs) {#name, group, procs, name##_main, 0},
+static struct suite_benchmark benchmarks[] = {
+    SUITE_BENCHMARKS(SUITE_ENTRY)
+};
+
+#define NUM_BENCHMARKS (sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+static int in_session = 0;
+
+/*
+ * MPI profiling interface wrappers.  The benchmarks initialize and finalize
+ * MPI themselves; inside the suite those calls must not tear down the session
+ * shared by all of them.
+ */
+int MPI_Init (int * argc, char *** argv)
+{
+    if (in_session) {
+        return MPI_SUCCESS;
+    }
+
+    return PMPI_Init(argc, argv);
+}
+
+int MPI_Init_thread (int * argc, char *** argv, int required, int * provided)
+{
+    if (in_session) {
+        return PMPI_Query_thread(provided);
+    }
+
+    return PMPI_Init_thread(argc, argv, required, provided);
+}
+
+int MPI_Finalize (void)
+{
+    if (in_session) {
+        return MPI_SUCCESS;
+    }
+
+    return PMPI_Finalize();
+}
+
+/*
+ * Benchmarks exit() directly on bad usage and after printing help; make sure
+ * the session is still shut down cleanly in that case.
+ */
+static void suite_atexit (void)
+{
+    int finalized = 0;
+
+    MPI_Finalized(&finalized);
+
+    if (in_session && !finalized) {
+        in_session = 0;
+        set_buffer_pool(0);
+        PMPI_Finalize();
+    }
+}
+
+static void suite_usage (int rank, char const * prog)
+{
+    size_t i;
+
+    if (rank) {
+        return;
+    }
+
+    fprintf(stdout, "Usage: %s [options] [BENCHMARK ...] [-- BENCHMARK OPTIONS]\n",
+            prog);
+    fprintf(stdout, "Run several benchmarks inside a single MPI session.\n\n");
+    fprintf(stdout, "BENCHMARK is a benchmark name (the osu_ prefix may be omitted), a group\n");
+    fprintf(stdout, "name (collective, pt2pt, one-sided) or all (default).  Benchmarks whose\n");
+    fprintf(stdout, "process count requirement is not met are skipped.  Everything after `--'\n");
+    fprintf(stdout, "is passed to every selected benchmark, so only use options that all of\n");
+    fprintf(stdout, "them accept.\n\n");
+    fprintf(stdout, "Options:\n");
+    fprintf(stdout, "  -l, --list                  list the available benchmarks\n");
+    fprintf(stdout, "  -h, --help                  print this help\n");
+    fprintf(stdout, "  -v, --version               print version info\n");
+    fprintf(stdout, "\nBenchmarks:\n");
+
+    for (i = 0; i < NUM_BENCHMARKS; i++) {
+        fprintf(stdout, "  %-24s%s\n", benchmarks[i].name, benchmarks[i].group);
+    }
+
+    fflush(stdout);
+}
+
+static int select_benchmarks (char const * pattern)
+{
+    size_t i;
+    int found = 0;
+
+    for (i = 0; i < NUM_BENCHMARKS; i++) {
+        char const * name = benchmarks[i].name;
+
+        if (0 == strcmp(pattern, "all") ||
+                0 == strcmp(pattern, benchmarks[i].group) ||
+                0 == strcmp(pattern, name) ||
+                0 == strcmp(pattern, name + strlen("osu_"))) {
+            benchmarks[i].selected = 1;
+            found = 1;
+        }
+    }
+
+    return found;
+}
+
+static char const * procs_message (enum suite_procs procs, int numprocs)
+{
+    switch (procs) {
+        case PROCS_TWO:
+            return (2 == numprocs) ? NULL : "requires exactly two processes";
+        case PROCS_EVEN:
+            return (numprocs >= 2 && 0 == numprocs % 2) ? NULL :
+                "requires an even number of processes";
+        default:
+            return (numprocs >= 2) ? NULL : "requires at least two processes";
+    }
+}
+
+int main (int argc, char *argv[])
+{
+    int rank, numprocs, i, bench_argc = 1;
+    int selected = 0, passed = 0, failed = 0, skipped = 0;
+    char ** suite_argv, ** bench_argv;
+    size_t b;
+
+    MPI_CHECK(PMPI_Init(&argc, &argv));
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+
+    in_session = 1;
+    atexit(suite_atexit);
+
+    suite_argv = malloc(sizeof(char *) * (argc + 1));
+    bench_argv = malloc(sizeof(char *) * (argc + 1));
+    if (NULL == suite_argv || NULL == bench_argv) {
+        fprintf(stderr, "Error allocating argument list\n");
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    for (i = 1; i < argc; i++) {
+        if (0 == strcmp(argv[i], "--")) {
+            for (i++; i < argc; i++) {
+                suite_argv[bench_argc++] = argv[i];
+            }
+            break;
+        } else if (0 == strcmp(argv[i], "-h") || 0 == strcmp(argv[i], "--help") ||
+                0 == strcmp(argv[i], "-l") || 0 == strcmp(argv[i], "--list")) {
+            suite_usage(rank, argv[0]);
+            exit(EXIT_SUCCESS);
+        } else if (0 == strcmp(argv[i], "-v") || 0 == strcmp(argv[i], "--version")) {
+            if (0 == rank) {
+                fprintf(stdout, HEADER);
+                fflush(stdout);
+            }
+            exit(EXIT_SUCCESS);
+        } else if (!select_benchmarks(argv[i])) {
+            if (0 == rank) {
+                fprintf(stderr, "Unknown benchmark [%s]\n\n", argv[i]);
+                suite_usage(rank, argv[0]);
+            }
+            exit(EXIT_FAILURE);
+        } else {
+            selected = 1;
+        }
+    }
+
+
+    if (!selected) {
+        select_benchmarks("all");
+    }
+
+    set_buffer_pool(1);
+
+    for (b = 0; b < NUM_BENCHMARKS; b++) {
+        char const * skip_reason;
+        double t_start, t_end;
+        int ret;
+
+        if (!benchmarks[b].selected) {
+            continue;
+        }
+
+        skip_reason = procs_message(benchmarks[b].procs, numprocs);
+        if (skip_reason) {
+            if (0 == rank) {
+                fprintf(stderr, "# Skipping %s: %s\n", benchmarks[b].name,
+                        skip_reason);
+            }
+            skipped++;
+            continue;
+        }
+
+        /* Start every benchmark from the state of a freshly loaded process */
+        memset(&options, 0, sizeof(options));
+        benchmark_header = NULL;
+        set_benchmark_name(benchmarks[b].name);
+        set_num_ranks(numprocs);
+        optind = 1;
+
+        /* Option parsing modifies its arguments (strtok), hand out copies */
+        suite_argv[0] = (char *)benchmarks[b].name;
+        for (i = 0; i < bench_argc; i++) {
+            bench_argv[i] = strdup(suite_argv[i]);
+        }
+        bench_argv[bench_argc] = NULL;
+
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+        t_start = osu_wtime();
+        ret = benchmarks[b].run(bench_argc, bench_argv);
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+        t_end = osu_wtime();
+
+        /* --fit reports at exit, which only comes after the last benchmark */
+        print_model_fit();
+
+        for (i = 0; i < bench_argc; i++) {
+            free(bench_argv[i]);
+        }
+
+        if (EXIT_SUCCESS == ret) {
+            passed++;
+        } else {
+            failed++;
+        }
+
+        if (0 == rank) {
+            fprintf(stderr, "# %s: %s in %.2f s\n", benchmarks[b].name,
+                    EXIT_SUCCESS == ret ? "completed" : "failed",
+                    t_end - t_start);
+        }
+    }
+
+    if (0 == rank) {
+        fprintf(stderr, "# %d completed, %d failed, %d skipped\n", passed,
+                failed, skipped);
+    }
+
+    print_buffer_pool_summary(rank);
+
+    in_session = 0;
+    set_buffer_pool(0);
+    free(suite_argv);
+    free(bench_argv);
+
+    MPI_CHECK(PMPI_Finalize());
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -0,0 +1,121 @@
+#define BENCHMARK "OSU NVSHMEM GPU-Initiated Put Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * The puts of osu_oshm_put issued from inside a kernel on PE 0 to the GPU
+ * of PE 1, on buffers of the NVSHMEM symmetric heap.  Every message size is
+ * run with a single thread (nvshmem_putmem), a warp (nvshmemx_putmem_warp)
+ * and a block (nvshmemx_putmem_block) issuing the put.  The latency is that
+ * of a blocking put and nvshmem_quiet, the bandwidth that of windows of -W
+ * non-blocking puts closed by nvshmem_quiet.  Both are printed as the kernel
+ * measured them with the GPU global timer and as the host observed them,
+ * from the launch to the completion of the kernel.
+ */
+
+#include <osu_util_nvshmem.h>
+
+int main (int argc, char *argv[])
+{
+    int myid, numprocs, scope;
+    int po_ret;
+    size_t size;
+    char *s_buf, *r_buf;
+    double kernel_lat, host_lat, kernel_window, host_window;
+
+    init_nvshmem(&myid, &numprocs);
+
+    options.bench = OSHM;
+    options.subtype = PGAS_DEVICE;
+    options.pgas_memory = PGAS_MEMORY_NONE;
+
+    set_header(HEADER);
+    po_ret = process_options(argc, argv);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_usage_pgas_pt2pt(myid, argv[0], "");
+            nvshmem_finalize();
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_usage_pgas_pt2pt(myid, argv[0], "");
+            nvshmem_finalize();
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            if (myid == 0) {
+                print_version_pgas(HEADER);
+            }
+            nvshmem_finalize();
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (numprocs != 2) {
+        if (myid == 0) {
+            fprintf(stderr, "This test requires exactly two processes\n");
+        }
+
+        nvshmem_finalize();
+        return EXIT_FAILURE;
+    }
+
+    limit_message_size_pgas(myid, options.max_mem_limit / 2);
+
+    s_buf = (char *)nvshmem_malloc(MAX(1, options.max_message_size));
+    r_buf = (char *)nvshmem_malloc(MAX(1, options.max_message_size));
+
+    if (NULL == s_buf || NULL == r_buf) {
+        fprintf(stderr, "Could Not Allocate Memory [PE %d]\n", myid);
+        nvshmem_global_exit(EXIT_FAILURE);
+    }
+
+    cudaMemset(s_buf, 'a', options.max_message_size);
+    cudaMemset(r_buf, 'b', options.max_message_size);
+    cudaDeviceSynchronize();
+
+    print_header_nvshmem(myid);
+
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        if (size > LARGE_MESSAGE_SIZE) {
+            options.iterations = options.iterations_large;
+            options.skip = options.skip_large;
+        }
+
+        nvshmem_barrier_all();
+
+        if (myid == 0) {
+            for (scope = 0; scope < SCOPE_NUM; scope++) {
+                time_device_ops(DEVICE_PUT, (enum device_scope)scope, r_buf,
+                        s_buf, size, 1, 1, &kernel_lat, &host_lat);
+                time_device_ops(DEVICE_PUT, (enum device_scope)scope, r_buf,
+                        s_buf, size, 1, options.window_size, &kernel_window,
+                        &host_window);
+
+                print_data_nvshmem(myid, size, (enum device_scope)scope,
+                        kernel_lat, host_lat,
+                        size * options.window_size / kernel_window,
+                        size * options.window_size / host_window);
+            }
+        }
+
+        nvshmem_barrier_all();
+    }
+
+    nvshmem_free(s_buf);
+    nvshmem_free(r_buf);
+
+    nvshmem_finalize();
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -30,8 +30,33 @@ union data_types {
     long long   longlong_type;
     float       float_type;
     double      double_type;
+    unsigned int    uint_type;
+    unsigned long long ulonglong_type;
 } global_msg_buffer[OSHM_LOOP_ATOMIC];
 
+/*
+ * Besides the latency of every atomic between pairs of PEs, OpenSHMEM 1.4
+ * libraries can run the 1.4 atomics on unsigned int and unsigned long long in
+ * a throughput mode, where a window of atomics is completed by shmem_quiet,
+ * and in a contention mode, where all PEs update one word on PE 0.
+ */
+enum atomic_mode {
+    ATOMIC_LATENCY,
+    ATOMIC_THROUGHPUT,
+    ATOMIC_CONTENTION
+};
+
+static char const * mode_name[] = {"latency", "throughput", "contention"};
+
+#define DEF_ATOMIC_WINDOW 64
+
+#if defined(SHMEM_MAJOR_VERSION) && (SHMEM_MAJOR_VERSION > 1 \
+        || SHMEM_MINOR_VERSION >= 5)
+#   define ATOMIC_NBI 1
+#else
+#   define ATOMIC_NBI 0
+#endif
+
 double pwrk1[_SHMEM_REDUCE_MIN_WRKDATA_SIZE];
 double pwrk2[_SHMEM_REDUCE_MIN_WRKDATA_SIZE];
 
@@ -63,9 +88,19 @@ static void
 print_usage (int myid)
 {
     if (myid == 0) {
+#ifdef OSHM_1_4
+        if (MEMORY_SELECTION) {
+            fprintf(stderr, "Usage: osu_oshm_atomics <heap|global> "
+                    "[latency|throughput|contention [WINDOW]]\n");
+            fprintf(stderr, "    WINDOW  atomics between calls to "
+                    "shmem_quiet in throughput mode, 1 to %d (default %d)\n",
+                    OSHM_LOOP_ATOMIC, DEF_ATOMIC_WINDOW);
+        }
+#else
         if (MEMORY_SELECTION) {
             fprintf(stderr, "Usage: osu_oshm_atomics <heap|global>\n");
         }
+#endif
 
         else {
             fprintf(stderr, "Usage: osu_oshm_atomics\n");
@@ -74,8 +109,34 @@ print_usage (int myid)
 }
 
 void
-check_usage (int me, int npes, int argc, char * argv [])
+check_usage (int me, int npes, int argc, char * argv [],
+        enum atomic_mode * mode, int * window)
 {
+    *mode = ATOMIC_LATENCY;
+    *window = DEF_ATOMIC_WINDOW;
+
+#ifdef OSHM_1_4
+    if (MEMORY_SELECTION && 2 < argc && 5 > argc) {
+        for (*mode = ATOMIC_LATENCY; *mode <= ATOMIC_CONTENTION; (*mode)++) {
+            if (!strncmp(argv[2], mode_name[*mode], 12)) {
+                break;
+            }
+        }
+
+        if (3 < argc) {
+            *window = atoi(argv[3]);
+        }
+
+        if (ATOMIC_CONTENTION < *mode || 1 > *window
+                || OSHM_LOOP_ATOMIC < *window) {
+            print_usage(me);
+            exit(EXIT_FAILURE);
+        }
+
+        argc = 2;
+    }
+#endif
+
     if (MEMORY_SELECTION) {
         if (2 == argc) {
             /*
@@ -105,11 +166,21 @@ check_usage (int me, int npes, int argc, char * argv [])
 }
 
 void
-print_header_local (int myid)
+print_header_local (int myid, enum atomic_mode mode, int window)
 {
     if (myid == 0) {
         fprintf(stdout, HEADER);
-        fprintf(stdout, "%-*s%*s%*s\n", 20, "# Operation", FIELD_WIDTH,
+
+        if (ATOMIC_THROUGHPUT == mode) {
+            fprintf(stdout, "# Mode: throughput, %d atomics per shmem_quiet"
+                    "%s\n", window, ATOMIC_NBI ? "" :
+                    ", fetching atomics are blocking");
+        } else if (ATOMIC_CONTENTION == mode) {
+            fprintf(stdout, "# Mode: contention, all PEs target one word on "
+                    "PE 0\n");
+        }
+
+        fprintf(stdout, "%-*s%*s%*s\n", 34, "# Operation", FIELD_WIDTH,
                 "Million ops/s", FIELD_WIDTH, "Latency (us)");
         fflush(stdout);
     }
@@ -144,7 +215,7 @@ void
 print_operation_rate (int myid, char * operation, double rate, double lat)
 {
     if (myid == 0) {
-        fprintf(stdout, "%-*s%*.*f%*.*f\n", 20, operation, FIELD_WIDTH,
+        fprintf(stdout, "%-*s%*.*f%*.*f\n", 34, operation, FIELD_WIDTH,
                 FLOAT_PRECISION, rate, FIELD_WIDTH, FLOAT_PRECISION, lat);
         fflush(stdout);
     }
@@ -732,9 +803,294 @@ benchmark_set_longlong (struct pe_vars v, union data_types *buffer,
 }
 
 
+#ifdef OSHM_1_4
+enum atomic_op {
+    AOP_FETCH_ADD,
+    AOP_FETCH_INC,
+    AOP_ADD,
+    AOP_INC,
+    AOP_COMPARE_SWAP,
+    AOP_SWAP,
+    AOP_SET,
+    AOP_FETCH,
+    AOP_FETCH_AND,
+    AOP_FETCH_OR,
+    AOP_FETCH_XOR,
+    AOP_AND,
+    AOP_OR,
+    AOP_XOR,
+    AOP_NUM
+};
+
+static char const * aop_name[] = {"fetch_add", "fetch_inc", "add", "inc",
+    "compare_swap", "swap", "set", "fetch", "fetch_and", "fetch_or",
+    "fetch_xor", "and", "or", "xor"};
+
+#define AOP_IS_FETCHING(op) (AOP_ADD != (op) && AOP_INC != (op) \
+        && AOP_SET != (op) && AOP_AND != (op) && AOP_OR != (op) \
+        && AOP_XOR != (op))
+
+/* Local results of the fetching atomics */
+static union data_types fetch_buffer[OSHM_LOOP_ATOMIC];
+
+/*
+ * Issue one 1.4 atomic on an unsigned int.  With nbi the fetching
+ * atomics are the non-blocking ones of OpenSHMEM 1.5, completed by the next
+ * shmem_quiet.
+ */
+static void
+atomic_uint (enum atomic_op op, unsigned int *target, unsigned int *fetch,
+        unsigned int cond, unsigned int value, int pe, int nbi)
+{
+#if ATOMIC_NBI
+    if (nbi) {
+        switch (op) {
+            case AOP_FETCH_ADD:
+                shmem_uint_atomic_fetch_add_nbi(fetch, target, value, pe);
+                return;
+            case AOP_FETCH_INC:
+                shmem_uint_atomic_fetch_inc_nbi(fetch, target, pe);
+                return;
+            case AOP_COMPARE_SWAP:
+                shmem_uint_atomic_compare_swap_nbi(fetch, target, cond,
+                        value, pe);
+                return;
+            case AOP_SWAP:
+                shmem_uint_atomic_swap_nbi(fetch, target, value, pe);
+                return;
+            case AOP_FETCH:
+                shmem_uint_atomic_fetch_nbi(fetch, target, pe);
+                return;
+            case AOP_FETCH_AND:
+                shmem_uint_atomic_fetch_and_nbi(fetch, target, value, pe);
+                return;
+            case AOP_FETCH_OR:
+                shmem_uint_atomic_fetch_or_nbi(fetch, target, value, pe);
+                return;
+            case AOP_FETCH_XOR:
+                shmem_uint_atomic_fetch_xor_nbi(fetch, target, value, pe);
+                return;
+            default:
+                break;
+        }
+    }
+#endif
+
+    switch (op) {
+        case AOP_FETCH_ADD:
+            *fetch = shmem_uint_atomic_fetch_add(target, value, pe);
+            break;
+        case AOP_FETCH_INC:
+            *fetch = shmem_uint_atomic_fetch_inc(target, pe);
+            break;
+        case AOP_ADD:
+            shmem_uint_atomic_add(target, value, pe);
+            break;
+        case AOP_INC:
+            shmem_uint_atomic_inc(target, pe);
+            break;
+        case AOP_COMPARE_SWAP:
+            *fetch = shmem_uint_atomic_compare_swap(target, cond, value, pe);
+            break;
+        case AOP_SWAP:
+            *fetch = shmem_uint_atomic_swap(target, value, pe);
+            break;
+        case AOP_SET:
+            shmem_uint_atomic_set(target, value, pe);
+            break;
+        case AOP_FETCH:
+            *fetch = shmem_uint_atomic_fetch(target, pe);
+            break;
+        case AOP_FETCH_AND:
+            *fetch = shmem_uint_atomic_fetch_and(target, value, pe);
+            break;
+        case AOP_FETCH_OR:
+            *fetch = shmem_uint_atomic_fetch_or(target, value, pe);
+            break;
+        case AOP_FETCH_XOR:
+            *fetch = shmem_uint_atomic_fetch_xor(target, value, pe);
+            break;
+        case AOP_AND:
+            shmem_uint_atomic_and(target, value, pe);
+            break;
+        case AOP_OR:
+            shmem_uint_atomic_or(target, value, pe);
+            break;
+        default:
+            shmem_uint_atomic_xor(target, value, pe);
+            break;
+    }
+}
+
+/* Issue one 1.4 atomic on an unsigned long long */
+static void
+atomic_ulonglong (enum atomic_op op, unsigned long long *target,
+        unsigned long long *fetch, unsigned long long cond,
+        unsigned long long value, int pe, int nbi)
+{
+#if ATOMIC_NBI
+    if (nbi) {
+        switch (op) {
+            case AOP_FETCH_ADD:
+                shmem_ulonglong_atomic_fetch_add_nbi(fetch, target, value, pe);
+                return;
+            case AOP_FETCH_INC:
+                shmem_ulonglong_atomic_fetch_inc_nbi(fetch, target, pe);
+                return;
+            case AOP_COMPARE_SWAP:
+                shmem_ulonglong_atomic_compare_swap_nbi(fetch, target, cond,
+                        value, pe);
+                return;
+            case AOP_SWAP:
+                shmem_ulonglong_atomic_swap_nbi(fetch, target, value, pe);
+                return;
+            case AOP_FETCH:
+                shmem_ulonglong_atomic_fetch_nbi(fetch, target, pe);
+                return;
+            case AOP_FETCH_AND:
+                shmem_ulonglong_atomic_fetch_and_nbi(fetch, target, value, pe);
+                return;
+            case AOP_FETCH_OR:
+                shmem_ulonglong_atomic_fetch_or_nbi(fetch, target, value, pe);
+                return;
+            case AOP_FETCH_XOR:
+                shmem_ulonglong_atomic_fetch_xor_nbi(fetch, target, value, pe);
+                return;
+            default:
+                break;
+        }
+    }
+#endif
+
+    switch (op) {
+        case AOP_FETCH_ADD:
+            *fetch = shmem_ulonglong_atomic_fetch_add(target, value, pe);
+            break;
+        case AOP_FETCH_INC:
+            *fetch = shmem_ulonglong_atomic_fetch_inc(target, pe);
+            break;
+        case AOP_ADD:
+            shmem_ulonglong_atomic_add(target, value, pe);
+            break;
+        case AOP_INC:
+            shmem_ulonglong_atomic_inc(target, pe);
+            break;
+        case AOP_COMPARE_SWAP:
+            *fetch = shmem_ulonglong_atomic_compare_swap(target, cond, value, pe);
+            break;
+        case AOP_SWAP:
+            *fetch = shmem_ulonglong_atomic_swap(target, value, pe);
+            break;
+        case AOP_SET:
+            shmem_ulonglong_atomic_set(target, value, pe);
+            break;
+        case AOP_FETCH:
+            *fetch = shmem_ulonglong_atomic_fetch(target, pe);
+            break;
+        case AOP_FETCH_AND:
+            *fetch = shmem_ulonglong_atomic_fetch_and(target, value, pe);
+            break;
+        case AOP_FETCH_OR:
+            *fetch = shmem_ulonglong_atomic_fetch_or(target, value, pe);
+            break;
+        case AOP_FETCH_XOR:
+            *fetch = shmem_ulonglong_atomic_fetch_xor(target, value, pe);
+            break;
+        case AOP_AND:
+            shmem_ulonglong_atomic_and(target, value, pe);
+            break;
+        case AOP_OR:
+            shmem_ulonglong_atomic_or(target, value, pe);
+            break;
+        default:
+            shmem_ulonglong_atomic_xor(target, value, pe);
+            break;
+    }
+}
+
+/*
+ * Between pairs every atomic goes to its own word of the peer PE, in
+ * contention mode all PEs but PE 0 update the first word of PE 0.  The
+ * latency is the time per atomic of an origin PE, so in throughput mode it
+ * is the inverse of the rate rather than the time to complete one atomic.
+ */
+double
+benchmark_atomic (struct pe_vars v, union data_types *buffer,
+        enum atomic_mode mode, int window, enum atomic_op op, int longlong,
+        unsigned long iterations)
+{
+    double begin, end;
+    int i, k, pe, origins, active;
+    int nbi = ATOMIC_THROUGHPUT == mode && ATOMIC_NBI;
+    static double rate = 0, sum_rate = 0, lat = 0, sum_lat = 0;
+    char name[64];
+
+    if (ATOMIC_CONTENTION == mode) {
+        active = 0 != v.me;
+        pe = 0;
+        origins = v.npes - 1;
+    } else {
+        active = v.me < v.pairs;
+        pe = v.nxtpe;
+        origins = v.pairs;
+    }
+
+    /*
+     * Touch memory, compare_swap succeeds on the first try of every word
+     */
+    for (i = 0; i < OSHM_LOOP_ATOMIC; i++) {
+        if (!longlong) {
+            buffer[i].uint_type = v.me;
+        } else {
+            buffer[i].ulonglong_type = v.me;
+        }
+    }
+
+    shmem_barrier_all();
+
+    if (active) {
+        begin = TIME();
+        for (i = 0; i < iterations; i++) {
+            k = ATOMIC_CONTENTION == mode ? 0 : i;
+
+            if (!longlong) {
+                atomic_uint(op, &buffer[k].uint_type,
+                        &fetch_buffer[i].uint_type, pe, 1U << (i % 32), pe,
+                        nbi);
+            } else {
+                atomic_ulonglong(op, &buffer[k].ulonglong_type,
+                        &fetch_buffer[i].ulonglong_type, pe,
+                        1ULL << (i % 64), pe, nbi);
+            }
+
+            if (ATOMIC_THROUGHPUT == mode && 0 == (i + 1) % window) {
+                shmem_quiet();
+            }
+        }
+        shmem_quiet();
+        end = TIME();
+
+        rate = ((double)iterations * 1e6) / (end - begin);
+        lat = (end - begin) / (double)iterations;
+    }
+
+    shmem_double_sum_to_all(&sum_rate, &rate, 1, 0, 0, v.npes, pwrk1, psync1);
+    shmem_double_sum_to_all(&sum_lat, &lat, 1, 0, 0, v.npes, pwrk2, psync2);
+    snprintf(name, sizeof(name), "shmem_%s_atomic_%s%s",
+            longlong ? "ulonglong" : "uint", aop_name[op], nbi && AOP_IS_FETCHING(op) ? "_nbi" : "");
+    print_operation_rate(v.me, name, sum_rate/1e6, sum_lat/origins);
+
+    return 0;
+}
+#endif
+
 void
-benchmark (struct pe_vars v, union data_types *msg_buffer)
+benchmark (struct pe_vars v, union data_types *msg_buffer,
+        enum atomic_mode mode, int window)
 {
+#ifdef OSHM_1_4
+    enum atomic_op op;
+#endif
 
     srand(v.me);
 
@@ -750,6 +1106,25 @@ benchmark (struct pe_vars v, union data_types *msg_buffer)
         }
     }
    
+#ifdef OSHM_1_4
+    /*
+     * Performance with the 1.4 atomics on unsigned types
+     */
+    if (ATOMIC_LATENCY != mode) {
+        for (op = AOP_FETCH_ADD; op < AOP_NUM; op++) {
+            benchmark_atomic(v, msg_buffer, mode, window, op, 0,
+                    OSHM_LOOP_ATOMIC);
+        }
+
+        for (op = AOP_FETCH_ADD; op < AOP_NUM; op++) {
+            benchmark_atomic(v, msg_buffer, mode, window, op, 1,
+                    OSHM_LOOP_ATOMIC);
+        }
+
+        return;
+    }
+#endif
+
     /*
      * Performance with atomics
      */ 
@@ -770,6 +1145,18 @@ benchmark (struct pe_vars v, union data_types *msg_buffer)
     benchmark_swap_longlong(v, msg_buffer, OSHM_LOOP_ATOMIC);
 	benchmark_set_longlong(v, msg_buffer, OSHM_LOOP_ATOMIC);
 	benchmark_fetch_longlong(v, msg_buffer, OSHM_LOOP_ATOMIC);
+
+#ifdef OSHM_1_4
+    for (op = AOP_FETCH_ADD; op < AOP_NUM; op++) {
+        benchmark_atomic(v, msg_buffer, mode, window, op, 0,
+                OSHM_LOOP_ATOMIC);
+    }
+
+    for (op = AOP_FETCH_ADD; op < AOP_NUM; op++) {
+        benchmark_atomic(v, msg_buffer, mode, window, op, 1,
+                OSHM_LOOP_ATOMIC);
+    }
+#endif
 }
 
 int
@@ -778,13 +1165,14 @@ main (int argc, char *argv[])
     int i;
     struct pe_vars v;
     union data_types * msg_buffer;
-    int use_heap;
+    int use_heap, window;
+    enum atomic_mode mode;
 
     /*
      * Initialize
      */
     v = init_openshmem();
-    check_usage(v.me, v.npes, argc, argv);
+    check_usage(v.me, v.npes, argc, argv, &mode, &window);
 
     for (i = 0; i < _SHMEM_REDUCE_SYNC_SIZE; i += 1) {
         psync1[i] = _SHMEM_SYNC_VALUE;
@@ -792,7 +1180,7 @@ main (int argc, char *argv[])
     }
     shmem_barrier_all();
 
-    print_header_local(v.me);
+    print_header_local(v.me, mode, window);
 
     /*
      * Allocate Memory
@@ -804,7 +1192,7 @@ main (int argc, char *argv[])
     /*
      * Time Put Message Rate
      */
-    benchmark(v, msg_buffer);
+    benchmark(v, msg_buffer, mode, window);
 
     /*
      * Finalize
@@ -74,6 +74,7 @@ int main(int argc, char *argv[])
     }
 
     options.show_size = 0;
+    set_num_ranks(numprocs);
     print_header_pgas(HEADER, rank, options.show_full);
 
     skip = options.skip_large;
@@ -117,6 +117,7 @@ int main(int argc, char *argv[])
         max_msg_size = options.max_mem_limit/numprocs;
     } 
 
+    set_num_ranks(numprocs);
     print_header_pgas(HEADER, rank, full);
 
 
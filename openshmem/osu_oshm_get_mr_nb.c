@@ -12,11 +12,15 @@
 #include <shmem.h>
 #include <osu_util_pgas.h>
 
-#define ITERS_SMALL     (500)          
-#define ITERS_LARGE     (50)
-
 char global_msg_buffer[MYBUFSIZE_MR];
 
+/*
+ * Bytes of the aligned buffer, OSHM_LOOP_LARGE_MR messages of the largest size
+ * unless -M or the global buffer allow less.  Consecutive messages go to
+ * consecutive offsets, wrapping around at the end of the buffer.
+ */
+static size_t buffer_size;
+
 #ifndef MEMORY_SELECTION
 #   define MEMORY_SELECTION 1
 #endif
@@ -52,23 +56,29 @@ init_openshmem (void)
 void
 check_usage (int me, int npes, int argc, char * argv [])
 {
-    if (MEMORY_SELECTION) {
-        if (2 == argc) {
-            /*
-             * Compare more than 4 and 6 characters respectively to make sure
-             * that we're not simply matching a prefix but the entire string.
-             */
-            if (strncmp(argv[1], "heap", 10)
-                && strncmp(argv[1], "global", 10)) {
-                usage_oshm_pt2pt(me);
-                exit(EXIT_FAILURE);
-            }
-        }
+    int po_ret;
+
+    options.bench = OSHM;
+    options.subtype = PGAS_MR;
+    options.pgas_memory = MEMORY_SELECTION ? PGAS_MEMORY_GLOBAL :
+        PGAS_MEMORY_NONE;
 
-        else {
-            usage_oshm_pt2pt(me);
+    po_ret = process_options(argc, argv);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_usage_pgas_pt2pt(me, argv[0], "");
             exit(EXIT_FAILURE);
-        }
+        case PO_HELP_MESSAGE:
+            print_usage_pgas_pt2pt(me, argv[0], "");
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            if (me == 0) {
+                print_version_pgas(HEADER);
+            }
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
     }
 
     if (2 > npes) {
@@ -100,9 +110,9 @@ allocate_memory (int me, long align_size, int use_heap)
     }
 
 #ifdef OSHM_1_3   
-	msg_buffer = (char *)shmem_malloc(MAX_MESSAGE_SIZE * OSHM_LOOP_LARGE_MR + align_size);
+	msg_buffer = (char *)shmem_malloc(buffer_size + align_size);
 #else
-	msg_buffer = (char *)shmalloc(MAX_MESSAGE_SIZE * OSHM_LOOP_LARGE_MR + align_size);
+	msg_buffer = (char *)shmalloc(buffer_size + align_size);
 #endif
 
     if (NULL == msg_buffer) {
@@ -120,22 +130,30 @@ align_memory (unsigned long address, int const align_size)
 }
 
 double
-message_rate (struct pe_vars v, char * buffer, unsigned long size, int iterations)
+message_rate (struct pe_vars v, char * buffer, unsigned long size, int iterations,
+        int skip)
 {
-    double begin, end; 
+    double begin = 0, end;
     int i, offset;
 
     /*
      * Touch memory
      */
-    memset(buffer, size, MAX_MESSAGE_SIZE  * ITERS_LARGE);
+    memset(buffer, size, buffer_size);
 
     shmem_barrier_all();
 
     if (v.me < v.pairs) {
-        begin = TIME();
+        for (i = 0, offset = 0; i < iterations + skip; i++, offset += size) {
+            if (i == skip) {
+                shmem_quiet();
+                begin = TIME();
+            }
+
+            if (offset + size > buffer_size) {
+                offset = 0;
+            }
 
-        for (i = 0, offset = 0; i < iterations; i++, offset += size) {
             shmem_getmem_nbi(&buffer[offset], &buffer[offset], size, v.nxtpe);
         }
 
@@ -172,8 +190,10 @@ benchmark (struct pe_vars v, char * msg_buffer)
      * Warmup
      */
     if (v.me < v.pairs) {
-        for (i = 0; i < (OSHM_LOOP_LARGE_MR * MAX_MESSAGE_SIZE); i += MAX_MESSAGE_SIZE) {
-            shmem_putmem(&msg_buffer[i], &msg_buffer[i], MAX_MESSAGE_SIZE , v.nxtpe);
+        for (i = 0; i + options.max_message_size <= buffer_size;
+                i += options.max_message_size) {
+            shmem_putmem(&msg_buffer[i], &msg_buffer[i],
+                    options.max_message_size, v.nxtpe);
         }
     }
     
@@ -182,10 +202,15 @@ benchmark (struct pe_vars v, char * msg_buffer)
     /*
      * Benchmark
      */
-    for (size = 1; size <= MAX_MESSAGE_SIZE ; size <<= 1) {
-        i = size < LARGE_MESSAGE_SIZE ? OSHM_LOOP_SMALL_MR : OSHM_LOOP_LARGE_MR;
-
-        mr = message_rate(v, msg_buffer, size, i);
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        if (size < LARGE_MESSAGE_SIZE) {
+            mr = message_rate(v, msg_buffer, size, options.iterations,
+                    options.skip);
+        } else {
+            mr = message_rate(v, msg_buffer, size, options.iterations_large,
+                    options.skip_large);
+        }
         shmem_double_sum_to_all(&mr_sum, &mr, 1, 0, 0, v.npes, pwrk, psync);
         print_message_rate(v.me, size, mr_sum);
     }	
@@ -209,11 +234,18 @@ main (int argc, char *argv[])
     /*
      * Allocate Memory
      */
-    use_heap = !strncmp(argv[1], "heap", 10);
+    use_heap = (PGAS_MEMORY_HEAP == options.pgas_memory);
     alignment = use_heap ? sysconf(_SC_PAGESIZE) : MESSAGE_ALIGNMENT_MR;
+    buffer_size = use_heap ? options.max_mem_limit - alignment :
+        MYBUFSIZE_MR - MESSAGE_ALIGNMENT_MR;
+    limit_message_size_pgas(v.me, buffer_size);
+    if (buffer_size > options.max_message_size * OSHM_LOOP_LARGE_MR) {
+        buffer_size = options.max_message_size * OSHM_LOOP_LARGE_MR;
+    }
+
     msg_buffer = allocate_memory(v.me, alignment, use_heap);
     aligned_buffer = align_memory((unsigned long)msg_buffer, alignment);
-    memset(aligned_buffer, 0, MAX_MESSAGE_SIZE * OSHM_LOOP_LARGE_MR);
+    memset(aligned_buffer, 0, buffer_size);
 
     /*
      * Time Put Message Rate
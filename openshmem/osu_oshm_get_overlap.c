@@ -0,0 +1,236 @@
+#define BENCHMARK "OSU OpenSHMEM Get_nbi Overlap Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * PE 0 first times shmem_getmem_nbi plus shmem_quiet from PE 1, then issues
+ * the get, computes on the host for that long with the engine of the MPI
+ * non-blocking collectives and completes the get with shmem_quiet.  The
+ * overlap is the share of the communication hidden behind the compute,
+ * computed as by the MPI benchmarks.
+ */
+
+#include <shmem.h>
+#include <osu_util_pgas.h>
+
+char s_buf_original[MYBUFSIZE + MESSAGE_ALIGNMENT];
+char r_buf_original[MYBUFSIZE + MESSAGE_ALIGNMENT];
+
+/* Tested by the progress calls, never written */
+long progress_flag = 0;
+
+/*
+ * There is no test for a pending non-blocking get, testing a symmetric
+ * variable that is already set makes the library progress instead.
+ */
+static void
+progress_shmem (void * arg)
+{
+#ifdef OSHM_1_4
+    shmem_long_test(&progress_flag, SHMEM_CMP_EQ, 0);
+#else
+    shmem_long_wait_until(&progress_flag, _SHMEM_CMP_EQ, 0);
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+    int myid, numprocs, i;
+    int size, loop, skip;
+    char *s_buf, *r_buf;
+    char *s_buf_heap = NULL, *r_buf_heap = NULL;
+    int align_size;
+    int use_heap = 0;   //default uses global
+    int po_ret;
+    double t_start = 0.0, t_stop = 0.0, timer = 0.0, latency_in_secs = 0.0;
+    double tcomp = 0.0, tcomp_total = 0.0, test_time = 0.0, test_total = 0.0;
+    double init_time = 0.0, init_total = 0.0, wait_time = 0.0;
+    double wait_total = 0.0;
+
+#ifdef OSHM_1_3
+    shmem_init();
+    myid = shmem_my_pe();
+    numprocs = shmem_n_pes();
+#else
+    start_pes(0);
+    myid = _my_pe();
+    numprocs = _num_pes();
+#endif
+
+    options.bench = OSHM;
+    options.subtype = PGAS_NBC;
+    options.pgas_memory = PGAS_MEMORY_GLOBAL;
+
+    set_header(HEADER);
+
+    po_ret = process_options(argc, argv);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_usage_pgas_pt2pt(myid, argv[0], "");
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_usage_pgas_pt2pt(myid, argv[0], "");
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            if (myid == 0) {
+                print_version_pgas(HEADER);
+            }
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    use_heap = (PGAS_MEMORY_HEAP == options.pgas_memory);
+
+    if(numprocs != 2) {
+        if(myid == 0) {
+            fprintf(stderr, "This test requires exactly two processes\n");
+        }
+
+        return EXIT_FAILURE;
+    }
+
+    align_size = MESSAGE_ALIGNMENT;
+
+    limit_message_size_pgas(myid, use_heap ?
+            options.max_mem_limit / 2 - align_size : MYBUFSIZE);
+
+    /**************Allocating Memory*********************/
+
+    if(use_heap){
+#ifdef OSHM_1_3
+        s_buf_heap = (char *)shmem_malloc(options.max_message_size + align_size);
+        r_buf_heap = (char *)shmem_malloc(options.max_message_size + align_size);
+#else
+        s_buf_heap = (char *)shmalloc(options.max_message_size + align_size);
+        r_buf_heap = (char *)shmalloc(options.max_message_size + align_size);
+#endif
+
+        s_buf =
+            (char *) (((unsigned long) s_buf_heap + (align_size - 1)) /
+                      align_size * align_size);
+
+        r_buf =
+            (char *) (((unsigned long) r_buf_heap + (align_size - 1)) /
+                      align_size * align_size);
+    } else {
+
+        s_buf =
+            (char *) (((unsigned long) s_buf_original + (align_size - 1)) /
+                      align_size * align_size);
+
+        r_buf =
+            (char *) (((unsigned long) r_buf_original + (align_size - 1)) /
+                      align_size * align_size);
+    }
+
+    allocate_host_arrays();
+
+    /**************Memory Allocation Done*********************/
+
+    print_header_overlap_pgas(myid, "Get Init", "Quiet");
+
+    for(size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+
+        /* touch the data */
+        touch_host_buffer(s_buf, size);
+        touch_host_buffer(r_buf, size);
+
+        if(size > LARGE_MESSAGE_SIZE) {
+            loop = options.iterations_large;
+            skip = options.skip_large;
+        } else {
+            loop = options.iterations;
+            skip = options.skip;
+        }
+
+        shmem_barrier_all();
+
+        if(myid == 0) {
+            timer = 0.0;
+
+            for(i = 0; i < loop + skip; i++) {
+                t_start = TIME();
+                shmem_getmem_nbi(r_buf, s_buf, size, 1);
+                shmem_quiet();
+                t_stop = TIME();
+
+                if(i >= skip) {
+                    timer += t_stop - t_start;
+                }
+            }
+
+            /* Comm. latency in seconds, fed to the compute */
+            latency_in_secs = timer / loop * 1e-6;
+
+            calibrate_host_compute();
+
+            timer = 0.0; tcomp_total = 0.0; test_total = 0.0;
+            init_total = 0.0; wait_total = 0.0;
+
+            for(i = 0; i < loop + skip; i++) {
+                t_start = TIME();
+                init_time = TIME();
+                shmem_getmem_nbi(r_buf, s_buf, size, 1);
+                init_time = TIME() - init_time;
+
+                tcomp = TIME();
+                test_time = do_compute_and_progress(latency_in_secs,
+                        progress_shmem, NULL);
+                tcomp = TIME() - tcomp;
+
+                wait_time = TIME();
+                shmem_quiet();
+                wait_time = TIME() - wait_time;
+
+                t_stop = TIME();
+
+                if(i >= skip) {
+                    timer += t_stop - t_start;
+                    tcomp_total += tcomp;
+                    test_total += test_time * 1e6;
+                    init_total += init_time;
+                    wait_total += wait_time;
+                }
+            }
+
+            print_data_overlap_pgas(myid, size, timer / loop,
+                    tcomp_total / loop, latency_in_secs * 1e6,
+                    wait_total / loop, init_total / loop, test_total / loop);
+        }
+
+        shmem_barrier_all();
+    }
+
+    shmem_barrier_all();
+
+    free_host_compute();
+
+    if(use_heap){
+#ifdef OSHM_1_3
+        shmem_free(s_buf_heap);
+        shmem_free(r_buf_heap);
+#else
+        shfree(s_buf_heap);
+        shfree(r_buf_heap);
+#endif
+    }
+
+    shmem_barrier_all();
+
+#ifdef OSHM_1_3
+    shmem_finalize();
+#endif
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
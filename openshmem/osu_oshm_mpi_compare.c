@@ -0,0 +1,430 @@
+#define BENCHMARK "OSU MPI / OpenSHMEM Comparison Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * Runs equivalent primitives of MPI and OpenSHMEM in one job, with MPI_Init
+ * and shmem_init on the same processes, and prints them side by side:
+ *
+ *   put latency       MPI_Put + MPI_Win_flush     shmem_putmem + shmem_quiet
+ *   get bandwidth     window of MPI_Get,          window of shmem_getmem_nbi,
+ *                     MPI_Win_flush               shmem_quiet
+ *   broadcast         MPI_Bcast                   shmem_broadcast64
+ *   allreduce         MPI_Allreduce (long, sum)   shmem_long_sum_to_all
+ *   alltoall          MPI_Alltoall                shmem_alltoall64
+ *
+ * Both runtimes use the same symmetric buffers, the MPI window is created on
+ * them.  The point-to-point primitives run between rank 0 and rank 1, the
+ * collectives on all ranks with a barrier between iterations, and report the
+ * average latency over the ranks.  The collectives move 64-bit elements and
+ * skip the sizes below 8 bytes.  This needs an MPI and an OpenSHMEM that can
+ * be initialized together, as the OpenSHMEM of Open MPI or MVAPICH2-X.
+ */
+
+#include <mpi.h>
+#include <shmem.h>
+#include <osu_util_pgas.h>
+
+enum primitive {
+    PRIM_PUT_LAT,
+    PRIM_GET_BW,
+    PRIM_BCAST,
+    PRIM_ALLREDUCE,
+    PRIM_ALLTOALL,
+    PRIM_NUM
+};
+
+static char const * prim_name[] = {"put_lat(us)", "get_bw(MB/s)",
+    "bcast(us)", "allreduce(us)", "alltoall(us)"};
+static char const * metric_name[][2] = {
+    {"mpi_put_latency_us", "shmem_put_latency_us"},
+    {"mpi_get_bw_mbps", "shmem_get_bw_mbps"},
+    {"mpi_bcast_latency_us", "shmem_bcast_latency_us"},
+    {"mpi_allreduce_latency_us", "shmem_allreduce_latency_us"},
+    {"mpi_alltoall_latency_us", "shmem_alltoall_latency_us"}};
+
+long pSyncBcast[_SHMEM_BCAST_SYNC_SIZE];
+long pSyncRed[_SHMEM_REDUCE_SYNC_SIZE];
+#ifdef OSHM_1_3
+long pSyncAlltoall[_SHMEM_ALLTOALL_SYNC_SIZE];
+#endif
+
+static int rank, numprocs;
+static size_t alltoall_max;
+static char *sbuf, *rbuf;
+static long *pWrk;
+static MPI_Win win;
+
+/* A run of skip + loop operations of size bytes, on MPI or OpenSHMEM */
+static double
+run_put_lat (int shmem, int size, int loop, int skip)
+{
+    double t_start = 0, timer = 0;
+    int i;
+
+    if (rank != 0) {
+        return 0;
+    }
+
+    for (i = 0; i < loop + skip; i++) {
+        t_start = TIME();
+
+        if (shmem) {
+            shmem_putmem(rbuf, sbuf, size, 1);
+            shmem_quiet();
+        } else {
+            MPI_Put(sbuf, size, MPI_CHAR, 1, 0, size, MPI_CHAR, win);
+            MPI_Win_flush(1, win);
+        }
+
+        if (i >= skip) {
+            timer += TIME() - t_start;
+        }
+    }
+
+    return timer / loop;
+}
+
+static double
+run_get_bw (int shmem, int size, int loop, int skip)
+{
+    double t_start = 0;
+    int i, j;
+
+    if (rank != 0) {
+        return 0;
+    }
+
+    for (i = 0; i < loop + skip; i++) {
+        if (i == skip) {
+            t_start = TIME();
+        }
+
+        for (j = 0; j < options.window_size; j++) {
+            if (shmem) {
+#ifdef OSHM_1_3
+                shmem_getmem_nbi(sbuf, rbuf, size, 1);
+#else
+                shmem_getmem(sbuf, rbuf, size, 1);
+#endif
+            } else {
+                MPI_Get(sbuf, size, MPI_CHAR, 1, 0, size, MPI_CHAR, win);
+            }
+        }
+
+        if (shmem) {
+            shmem_quiet();
+        } else {
+            MPI_Win_flush(1, win);
+        }
+    }
+
+    return (double)size * options.window_size * loop / (TIME() - t_start);
+}
+
+static void
+run_coll_once (int shmem, enum primitive prim, int size)
+{
+    int count = size / sizeof(long);
+
+    switch (prim) {
+        case PRIM_BCAST:
+            if (shmem) {
+                shmem_broadcast64(rbuf, sbuf, count, 0, 0, 0, numprocs,
+                        pSyncBcast);
+            } else {
+                MPI_Bcast(sbuf, size, MPI_CHAR, 0, MPI_COMM_WORLD);
+            }
+            break;
+        case PRIM_ALLREDUCE:
+            if (shmem) {
+                shmem_long_sum_to_all((long *)rbuf, (long *)sbuf, count, 0, 0,
+                        numprocs, pWrk, pSyncRed);
+            } else {
+                MPI_Allreduce(sbuf, rbuf, count, MPI_LONG, MPI_SUM,
+                        MPI_COMM_WORLD);
+            }
+            break;
+        default:
+            if (shmem) {
+#ifdef OSHM_1_3
+                shmem_alltoall64(rbuf, sbuf, count, 0, 0, numprocs,
+                        pSyncAlltoall);
+#endif
+            } else {
+                MPI_Alltoall(sbuf, size, MPI_CHAR, rbuf, size, MPI_CHAR,
+                        MPI_COMM_WORLD);
+            }
+            break;
+    }
+}
+
+static double
+run_coll (int shmem, enum primitive prim, int size, int loop, int skip)
+{
+    double t_start = 0, timer = 0, latency, total = 0;
+    int i;
+
+    for (i = 0; i < loop + skip; i++) {
+        t_start = TIME();
+        run_coll_once(shmem, prim, size);
+
+        if (i >= skip) {
+            timer += TIME() - t_start;
+        }
+
+        if (shmem) {
+            shmem_barrier_all();
+        } else {
+            MPI_Barrier(MPI_COMM_WORLD);
+        }
+    }
+
+    latency = timer / loop;
+    MPI_Reduce(&latency, &total, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    return total / numprocs;
+}
+
+/* Run prim at size, or return a negative value where it does not apply */
+static double
+run_primitive (int shmem, enum primitive prim, int size, int loop, int skip)
+{
+    double value;
+
+    if (PRIM_PUT_LAT != prim && PRIM_GET_BW != prim &&
+            (size < sizeof(long) || size % sizeof(long))) {
+        return -1;
+    }
+
+#ifndef OSHM_1_3
+    if (PRIM_ALLTOALL == prim && shmem) {
+        return -1;
+    }
+#endif
+
+    if (PRIM_ALLTOALL == prim && size > alltoall_max) {
+        return -1;
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    shmem_barrier_all();
+
+    switch (prim) {
+        case PRIM_PUT_LAT:
+            value = run_put_lat(shmem, size, loop, skip);
+            break;
+        case PRIM_GET_BW:
+            value = run_get_bw(shmem, size, loop, skip);
+            break;
+        default:
+            value = run_coll(shmem, prim, size, loop, skip);
+            break;
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    shmem_barrier_all();
+
+    return value;
+}
+
+static void
+print_compare_data (enum primitive prim, int size, double const * value)
+{
+    if (rank != 0 || (0 > value[0] && 0 > value[1])) {
+        return;
+    }
+
+    if (OUTPUT_TABLE != options.output_format) {
+        struct result_metric_t metrics[2];
+        int n = 0, i;
+
+        for (i = 0; i < 2; i++) {
+            if (0 <= value[i]) {
+                metrics[n].name = metric_name[prim][i];
+                metrics[n++].value = value[i];
+            }
+        }
+
+        output_result(benchmark_num_ranks, size, n, metrics);
+        return;
+    }
+
+    fprintf(stdout, "%-*s%*d", 16, prim_name[prim], 10, size);
+    if (0 <= value[0]) {
+        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, value[0]);
+    } else {
+        fprintf(stdout, "%*s", FIELD_WIDTH, "-");
+    }
+    if (0 <= value[1]) {
+        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, value[1]);
+    } else {
+        fprintf(stdout, "%*s", FIELD_WIDTH, "-");
+    }
+    if (0 < value[0] && 0 <= value[1]) {
+        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                value[1] / value[0]);
+    } else {
+        fprintf(stdout, "%*s", FIELD_WIDTH, "-");
+    }
+    fprintf(stdout, "\n");
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+    int size, loop, skip, po_ret, mpi_rank, t;
+    double value[2];
+    size_t bufsize;
+    enum primitive prim;
+
+    MPI_Init(&argc, &argv);
+#ifdef OSHM_1_3
+    shmem_init();
+    rank = shmem_my_pe();
+    numprocs = shmem_n_pes();
+#else
+    start_pes(0);
+    rank = _my_pe();
+    numprocs = _num_pes();
+#endif
+
+    for (t = 0; t < _SHMEM_BCAST_SYNC_SIZE; t++) {
+        pSyncBcast[t] = _SHMEM_SYNC_VALUE;
+    }
+    for (t = 0; t < _SHMEM_REDUCE_SYNC_SIZE; t++) {
+        pSyncRed[t] = _SHMEM_SYNC_VALUE;
+    }
+#ifdef OSHM_1_3
+    for (t = 0; t < _SHMEM_ALLTOALL_SYNC_SIZE; t++) {
+        pSyncAlltoall[t] = _SHMEM_SYNC_VALUE;
+    }
+#endif
+
+    options.bench = OSHM;
+    options.subtype = PGAS_COMPARE;
+
+    po_ret = process_options(argc, argv);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_usage_pgas_pt2pt(rank, argv[0], "");
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_usage_pgas_pt2pt(rank, argv[0], "");
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            if (rank == 0) {
+                print_version_pgas(HEADER);
+            }
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+
+    if (numprocs < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+        return EXIT_FAILURE;
+    }
+
+    if (mpi_rank != rank) {
+        fprintf(stderr, "MPI rank %d is PE %d, the runtimes must number the "
+                "processes alike\n", mpi_rank, rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    set_header(HEADER);
+    set_num_ranks(numprocs);
+
+    /* The alltoall buffers hold numprocs blocks, the other primitives one */
+    limit_message_size_pgas(rank, options.max_mem_limit / 2);
+    alltoall_max = MIN(options.max_message_size,
+            options.max_mem_limit / 2 / numprocs);
+    bufsize = MAX(options.max_message_size, alltoall_max * numprocs);
+
+#ifdef OSHM_1_3
+    sbuf = (char *)shmem_malloc(bufsize);
+    rbuf = (char *)shmem_malloc(bufsize);
+    pWrk = (long *)shmem_malloc(sizeof(long) *
+            MAX(options.max_message_size / sizeof(long) / 2 + 1,
+                _SHMEM_REDUCE_MIN_WRKDATA_SIZE));
+#else
+    sbuf = (char *)shmalloc(bufsize);
+    rbuf = (char *)shmalloc(bufsize);
+    pWrk = (long *)shmalloc(sizeof(long) *
+            MAX(options.max_message_size / sizeof(long) / 2 + 1,
+                _SHMEM_REDUCE_MIN_WRKDATA_SIZE));
+#endif
+
+    if (NULL == sbuf || NULL == rbuf || NULL == pWrk) {
+        fprintf(stderr, "Failed to allocate memory (rank: %d)\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    memset(sbuf, 'a', bufsize);
+    memset(rbuf, 'b', bufsize);
+
+    MPI_Win_create(rbuf, options.max_message_size, 1, MPI_INFO_NULL,
+            MPI_COMM_WORLD, &win);
+    MPI_Win_lock_all(0, win);
+
+    if (rank == 0 && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "# [ processes: %d ] get window: %d\n", numprocs,
+                options.window_size);
+        fprintf(stdout, "%-*s%*s%*s%*s%*s\n", 16, "# Primitive", 10, "Size",
+                FIELD_WIDTH, "MPI", FIELD_WIDTH, "OpenSHMEM", FIELD_WIDTH,
+                "SHMEM / MPI");
+        fflush(stdout);
+    }
+
+    for (prim = PRIM_PUT_LAT; prim < PRIM_NUM; prim++) {
+        reset_message_sizes();
+        for (size = options.min_message_size; size <= options.max_message_size;
+                size = next_message_size(size)) {
+            if (size > LARGE_MESSAGE_SIZE) {
+                loop = options.iterations_large;
+                skip = options.skip_large;
+            } else {
+                loop = options.iterations;
+                skip = options.skip;
+            }
+
+            value[0] = run_primitive(0, prim, size, loop, skip);
+            value[1] = run_primitive(1, prim, size, loop, skip);
+
+            print_compare_data(prim, size, value);
+        }
+    }
+
+    MPI_Win_unlock_all(win);
+    MPI_Win_free(&win);
+
+#ifdef OSHM_1_3
+    shmem_free(pWrk);
+    shmem_free(rbuf);
+    shmem_free(sbuf);
+    shmem_finalize();
+#else
+    shfree(pWrk);
+    shfree(rbuf);
+    shfree(sbuf);
+#endif
+
+    MPI_Finalize();
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
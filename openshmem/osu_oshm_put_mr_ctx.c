@@ -0,0 +1,417 @@
+#define BENCHMARK "OSU OpenSHMEM Multi-threaded Put Message Rate Test with Contexts"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * The PEs are paired as in osu_oshm_put_mr.  On the first PE of every pair
+ * a number of threads issue back-to-back puts to the peer PE, either all
+ * through the default context, through one context shared by all threads,
+ * or through contexts private to every thread, which they use round-robin.
+ * The number of threads is swept over the powers of two up to the requested
+ * one, and the aggregate message rate of all pairs is reported for every
+ * thread count, message size and kind of context.
+ */
+
+#include <shmem.h>
+#include <pthread.h>
+#include <osu_util_pgas.h>
+
+#define MAX_THREADS         16
+#define DEF_THREADS         4
+#define MAX_CONTEXTS        16
+#define DEF_CONTEXTS        1
+#define CTX_MAX_MESSAGE_SIZE LARGE_MESSAGE_SIZE
+#define CTX_SLOTS           OSHM_LOOP_LARGE_MR
+#define CTX_WARMUP          10
+
+#define THREAD_BUFSIZE (CTX_MAX_MESSAGE_SIZE * CTX_SLOTS)
+
+char global_msg_buffer[MAX_THREADS * THREAD_BUFSIZE + MESSAGE_ALIGNMENT_MR];
+
+enum ctx_mode {
+    CTX_MODE_DEFAULT,
+    CTX_MODE_SHARED,
+    CTX_MODE_PRIVATE,
+    CTX_NUM_MODES
+};
+
+struct pe_vars {
+    int me;
+    int npes;
+    int pairs;
+    int nxtpe;
+};
+
+struct thread_vars {
+    pthread_t thread;
+    struct pe_vars v;
+    enum ctx_mode mode;
+    char * buffer;
+    int size;
+    int iterations;
+    int contexts;
+    shmem_ctx_t shared_ctx;
+    int ctx_failed;
+    double begin, end;
+};
+
+static pthread_barrier_t thread_barrier;
+
+struct pe_vars
+init_openshmem (void)
+{
+    struct pe_vars v;
+    int provided;
+
+    shmem_init_thread(SHMEM_THREAD_MULTIPLE, &provided);
+    v.me = shmem_my_pe();
+    v.npes = shmem_n_pes();
+
+    if (SHMEM_THREAD_MULTIPLE != provided) {
+        if (0 == v.me) {
+            fprintf(stderr, "This test requires SHMEM_THREAD_MULTIPLE\n");
+        }
+
+        shmem_finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    v.pairs = v.npes / 2;
+    v.nxtpe = v.me < v.pairs ? v.me + v.pairs : v.me - v.pairs;
+
+    return v;
+}
+
+void
+usage (int me)
+{
+    if (0 == me) {
+        fprintf(stderr, "Invalid arguments. Usage: <prog_name> <heap|global> "
+                "[THREADS [CONTEXTS]]\n");
+        fprintf(stderr, "    THREADS   maximum number of threads per PE, "
+                "1 to %d (default %d)\n", MAX_THREADS, DEF_THREADS);
+        fprintf(stderr, "    CONTEXTS  private contexts per thread, "
+                "1 to %d (default %d)\n", MAX_CONTEXTS, DEF_CONTEXTS);
+    }
+}
+
+void
+check_usage (int me, int npes, int argc, char * argv [], int * threads,
+        int * contexts)
+{
+    *threads = DEF_THREADS;
+    *contexts = DEF_CONTEXTS;
+
+    if (2 > argc || 4 < argc || (strncmp(argv[1], "heap", 10)
+                && strncmp(argv[1], "global", 10))) {
+        usage(me);
+        exit(EXIT_FAILURE);
+    }
+
+    if (2 < argc) {
+        *threads = atoi(argv[2]);
+    }
+
+    if (3 < argc) {
+        *contexts = atoi(argv[3]);
+    }
+
+    if (1 > *threads || MAX_THREADS < *threads || 1 > *contexts
+            || MAX_CONTEXTS < *contexts) {
+        usage(me);
+        exit(EXIT_FAILURE);
+    }
+
+    if (2 > npes) {
+        if (0 == me) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        exit(EXIT_FAILURE);
+    }
+}
+
+void
+print_header_local (int myid, int contexts)
+{
+    if(myid == 0) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "# Private contexts per thread: %d\n", contexts);
+        fprintf(stdout, "%-*s%*s%*s%*s%*s\n", 10, "# Threads", 10, "Size",
+                FIELD_WIDTH, "Default ctx/s", FIELD_WIDTH, "Shared ctx/s",
+                FIELD_WIDTH, "Private ctx/s");
+        fflush(stdout);
+    }
+}
+
+char *
+allocate_memory (int me, long align_size, int use_heap)
+{
+    char * msg_buffer;
+
+    if (!use_heap) {
+        return global_msg_buffer;
+    }
+
+    msg_buffer = (char *)shmem_malloc(MAX_THREADS * THREAD_BUFSIZE +
+            align_size);
+
+    if (NULL == msg_buffer) {
+        fprintf(stderr, "Failed to shmalloc (pe: %d)\n", me);
+        exit(EXIT_FAILURE);
+    }
+
+    return msg_buffer;
+}
+
+char *
+align_memory (unsigned long address, int const align_size)
+{
+    return (char *) ((address + (align_size - 1)) / align_size * align_size);
+}
+
+/*
+ * Every thread puts into its own part of the buffer of the peer PE, cycling
+ * through CTX_SLOTS messages.  Private contexts are created by the thread
+ * that uses them and fall back to the default context if the library runs
+ * out of them.
+ */
+void *
+put_thread (void * arg)
+{
+    struct thread_vars * t = (struct thread_vars *)arg;
+    shmem_ctx_t ctx[MAX_CONTEXTS];
+    int i, c, n, offset;
+
+    n = 1;
+    ctx[0] = SHMEM_CTX_DEFAULT;
+
+    switch (t->mode) {
+        case CTX_MODE_DEFAULT:
+            break;
+        case CTX_MODE_SHARED:
+            ctx[0] = t->shared_ctx;
+            break;
+        default:
+            n = t->contexts;
+            for (c = 0; c < n; c++) {
+                if (shmem_ctx_create(SHMEM_CTX_PRIVATE, &ctx[c])) {
+                    ctx[c] = SHMEM_CTX_DEFAULT;
+                    t->ctx_failed = 1;
+                }
+            }
+            break;
+    }
+
+    for (i = 0, offset = 0; i < CTX_WARMUP; i++) {
+        shmem_ctx_putmem(ctx[i % n], &t->buffer[offset], &t->buffer[offset],
+                t->size, t->v.nxtpe);
+        offset = (offset + t->size) % (t->size * CTX_SLOTS);
+    }
+
+    for (c = 0; c < n; c++) {
+        shmem_ctx_quiet(ctx[c]);
+    }
+
+    pthread_barrier_wait(&thread_barrier);
+
+    t->begin = TIME();
+
+    for (i = 0, offset = 0; i < t->iterations; i++) {
+        shmem_ctx_putmem(ctx[i % n], &t->buffer[offset], &t->buffer[offset],
+                t->size, t->v.nxtpe);
+        offset = (offset + t->size) % (t->size * CTX_SLOTS);
+    }
+
+    for (c = 0; c < n; c++) {
+        shmem_ctx_quiet(ctx[c]);
+    }
+
+    t->end = TIME();
+
+    if (CTX_MODE_PRIVATE == t->mode) {
+        for (c = 0; c < n; c++) {
+            if (SHMEM_CTX_DEFAULT != ctx[c]) {
+                shmem_ctx_destroy(ctx[c]);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * The rate of a PE counts the messages of all of its threads over the time
+ * from the first thread starting to the last thread completing.
+ */
+double
+message_rate (struct pe_vars v, char * buffer, int size, int threads,
+        int contexts, enum ctx_mode mode, int * ctx_failed)
+{
+    static struct thread_vars t[MAX_THREADS];
+    shmem_ctx_t shared_ctx = SHMEM_CTX_DEFAULT;
+    double begin, end;
+    int i, iterations;
+
+    iterations = size < LARGE_MESSAGE_SIZE ? OSHM_LOOP_SMALL_MR
+        : OSHM_LOOP_LARGE_MR;
+
+    shmem_barrier_all();
+
+    if (v.me >= v.pairs) {
+        return 0;
+    }
+
+    if (CTX_MODE_SHARED == mode && shmem_ctx_create(0, &shared_ctx)) {
+        shared_ctx = SHMEM_CTX_DEFAULT;
+        *ctx_failed = 1;
+    }
+
+    pthread_barrier_init(&thread_barrier, NULL, threads);
+
+    for (i = 0; i < threads; i++) {
+        t[i].v = v;
+        t[i].mode = mode;
+        t[i].buffer = buffer + i * THREAD_BUFSIZE;
+        t[i].size = size;
+        t[i].iterations = iterations;
+        t[i].contexts = contexts;
+        t[i].shared_ctx = shared_ctx;
+        t[i].ctx_failed = 0;
+        pthread_create(&t[i].thread, NULL, put_thread, &t[i]);
+    }
+
+    begin = 0;
+    end = 0;
+
+    for (i = 0; i < threads; i++) {
+        pthread_join(t[i].thread, NULL);
+
+        if (0 == i || t[i].begin < begin) {
+            begin = t[i].begin;
+        }
+
+        if (0 == i || t[i].end > end) {
+            end = t[i].end;
+        }
+
+        *ctx_failed |= t[i].ctx_failed;
+    }
+
+    pthread_barrier_destroy(&thread_barrier);
+
+    if (SHMEM_CTX_DEFAULT != shared_ctx) {
+        shmem_ctx_destroy(shared_ctx);
+    }
+
+    return ((double)threads * iterations * 1e6) / (end - begin);
+}
+
+void
+print_message_rate (int myid, int threads, int size, double const * rate)
+{
+    if (myid == 0) {
+        fprintf(stdout, "%-*d%*d%*.*f%*.*f%*.*f\n", 10, threads, 10, size,
+                FIELD_WIDTH, FLOAT_PRECISION, rate[CTX_MODE_DEFAULT],
+                FIELD_WIDTH, FLOAT_PRECISION, rate[CTX_MODE_SHARED],
+                FIELD_WIDTH, FLOAT_PRECISION, rate[CTX_MODE_PRIVATE]);
+        fflush(stdout);
+    }
+}
+
+/* Powers of two, ending with max_threads itself */
+int
+next_threads (int threads, int max_threads)
+{
+    if (threads == max_threads) {
+        return max_threads + 1;
+    }
+
+    return threads << 1 < max_threads ? threads << 1 : max_threads;
+}
+
+void
+benchmark (struct pe_vars v, char * msg_buffer, int max_threads, int contexts)
+{
+    static double pwrk[_SHMEM_REDUCE_MIN_WRKDATA_SIZE];
+    static long psync[_SHMEM_REDUCE_SYNC_SIZE];
+    static double mr[CTX_NUM_MODES], mr_sum[CTX_NUM_MODES];
+    static int failed, failed_any;
+    static int iwrk[_SHMEM_REDUCE_MIN_WRKDATA_SIZE];
+    enum ctx_mode mode;
+    int threads, size;
+
+    memset(psync, _SHMEM_SYNC_VALUE, sizeof(long[_SHMEM_REDUCE_SYNC_SIZE]));
+    memset(msg_buffer, 1, MAX_THREADS * THREAD_BUFSIZE);
+
+    failed = 0;
+
+    for (threads = 1; threads <= max_threads;
+            threads = next_threads(threads, max_threads)) {
+        for (size = 1; size <= CTX_MAX_MESSAGE_SIZE; size <<= 1) {
+            for (mode = CTX_MODE_DEFAULT; mode < CTX_NUM_MODES; mode++) {
+                mr[mode] = message_rate(v, msg_buffer, size, threads,
+                        contexts, mode, &failed);
+            }
+
+            shmem_double_sum_to_all(mr_sum, mr, CTX_NUM_MODES, 0, 0, v.npes,
+                    pwrk, psync);
+            print_message_rate(v.me, threads, size, mr_sum);
+        }
+    }
+
+    shmem_barrier_all();
+    shmem_int_or_to_all(&failed_any, &failed, 1, 0, 0, v.npes, iwrk, psync);
+
+    if (0 == v.me && failed_any) {
+        fprintf(stderr, "Warning! Not all contexts could be created, some "
+                "threads used the default context instead\n");
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+    struct pe_vars v;
+    char * msg_buffer, * aligned_buffer;
+    long alignment;
+    int use_heap, threads, contexts;
+
+    /*
+     * Initialize
+     */
+    v = init_openshmem();
+    check_usage(v.me, v.npes, argc, argv, &threads, &contexts);
+    print_header_local(v.me, contexts);
+
+    /*
+     * Allocate Memory
+     */
+    use_heap = !strncmp(argv[1], "heap", 10);
+    alignment = use_heap ? sysconf(_SC_PAGESIZE) : MESSAGE_ALIGNMENT_MR;
+    msg_buffer = allocate_memory(v.me, alignment, use_heap);
+    aligned_buffer = align_memory((unsigned long)msg_buffer, alignment);
+
+    /*
+     * Time Put Message Rate
+     */
+    benchmark(v, aligned_buffer, threads, contexts);
+
+    /*
+     * Finalize
+     */
+    if (use_heap) {
+        shmem_free(msg_buffer);
+    }
+
+    shmem_finalize();
+
+    return EXIT_SUCCESS;
+}
@@ -12,14 +12,11 @@
 #include <shmem.h>
 #include <osu_util_pgas.h>
 
-char s_buf_original[MYBUFSIZE];
-char r_buf_original[MYBUFSIZE];
+char s_buf_original[MYBUFSIZE + MESSAGE_ALIGNMENT];
+char r_buf_original[MYBUFSIZE + MESSAGE_ALIGNMENT];
 
-int skip = 1000;
-int loop = 10000;
-int skip_large = 10;
-int loop_large = 100;
-int large_message_size = 8192;
+int skip;
+int loop;
 
 int main(int argc, char *argv[])
 {
@@ -30,6 +27,7 @@ int main(int argc, char *argv[])
     int align_size;
     double t_start = 0, t_end = 0;
     int use_heap = 0;   //default uses global
+    int po_ret;
 
 #ifdef OSHM_1_3 
     shmem_init();
@@ -41,6 +39,30 @@ int main(int argc, char *argv[])
     numprocs = _num_pes();
 #endif
 
+    options.bench = OSHM;
+    options.subtype = PGAS_LAT;
+    options.pgas_memory = PGAS_MEMORY_GLOBAL;
+
+    po_ret = process_options(argc, argv);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_usage_pgas_pt2pt(myid, argv[0], "");
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_usage_pgas_pt2pt(myid, argv[0], "");
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            if (myid == 0) {
+                print_version_pgas(HEADER);
+            }
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    use_heap = (PGAS_MEMORY_HEAP == options.pgas_memory);
+
     if(numprocs != 2) {
         if(myid == 0) {
             fprintf(stderr, "This test requires exactly two processes\n");
@@ -49,33 +71,21 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
-    if(argc != 2) {
-        usage_oshm_pt2pt(myid);
-		
-        return EXIT_FAILURE;
-    }
-
-    if(0 == strncmp(argv[1], "heap", strlen("heap"))){
-        use_heap = 1;
-    } else if(0 == strncmp(argv[1], "global", strlen("global"))){
-        use_heap = 0;
-    } else {
-        usage_oshm_pt2pt(myid);
-        return EXIT_FAILURE;
-    }
-
     align_size = MESSAGE_ALIGNMENT;
 
+    limit_message_size_pgas(myid, use_heap ?
+            options.max_mem_limit / 2 - align_size : MYBUFSIZE);
+
     /**************Allocating Memory*********************/
 
     if(use_heap){
 
 #ifdef OSHM_1_3 
-        s_buf_heap = (char *)shmem_malloc(MYBUFSIZE);
-        r_buf_heap = (char *)shmem_malloc(MYBUFSIZE);
+        s_buf_heap = (char *)shmem_malloc(options.max_message_size + align_size);
+        r_buf_heap = (char *)shmem_malloc(options.max_message_size + align_size);
 #else
-		s_buf_heap = (char *)shmalloc(MYBUFSIZE);
-        r_buf_heap = (char *)shmalloc(MYBUFSIZE);
+		s_buf_heap = (char *)shmalloc(options.max_message_size + align_size);
+        r_buf_heap = (char *)shmalloc(options.max_message_size + align_size);
 #endif
 		
         s_buf =
@@ -104,17 +114,19 @@ int main(int argc, char *argv[])
         fflush(stdout);
     }
 
-    for(size = 1; size <= MAX_MSG_SIZE_PT2PT; size = (size ? size * 2 : 1)) {
+    for(size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
         
         /* touch the data */
-        for(i = 0; i < size; i++) {
-            s_buf[i] = 'a';
-            r_buf[i] = 'b';
-        }
-
-        if(size > large_message_size) {
-            loop = loop_large = 100;
-            skip = skip_large = 0;
+        touch_host_buffer(s_buf, size);
+        touch_host_buffer(r_buf, size);
+
+        if(size > LARGE_MESSAGE_SIZE) {
+            loop = options.iterations_large;
+            skip = options.skip_large;
+        } else {
+            loop = options.iterations;
+            skip = options.skip;
         }
 
         shmem_barrier_all();
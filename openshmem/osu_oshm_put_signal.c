@@ -0,0 +1,326 @@
+#define BENCHMARK "OSU OpenSHMEM Put with Signal Latency and Bandwidth Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * A producer hands data to a consumer, which polls for it.  The traditional
+ * way puts the data, orders it with shmem_fence and puts a flag that the
+ * consumer waits for with shmem_long_wait_until.  OpenSHMEM 1.5 libraries
+ * also deliver the data and a signal with one shmem_putmem_signal or
+ * shmem_putmem_signal_nbi, waited for with shmem_signal_wait_until.
+ *
+ * The latency is half the round trip of a signaled message sent back and
+ * forth.  For the bandwidth PE 0 sends a window of signaled messages and
+ * PE 1 acknowledges the window once it saw the signal of the last one.
+ */
+
+#include <shmem.h>
+#include <osu_util_pgas.h>
+
+#define SIGNAL_WINDOW WINDOW_SIZE_LARGE
+
+enum signal_method {
+    METHOD_FLAG,
+#ifdef OSHM_1_5
+    METHOD_SIGNAL,
+    METHOD_SIGNAL_NBI,
+#endif
+    METHOD_NUM
+};
+
+static char const * method_name[] = {"Put+Fence+Flag", "Put Signal",
+    "Put Signal NBI"};
+
+char s_buf_original[MYBUFSIZE + MESSAGE_ALIGNMENT];
+char r_buf_original[MYBUFSIZE + MESSAGE_ALIGNMENT];
+
+long flag, ack;
+uint64_t sig;
+
+static char *s_buf, *r_buf;
+
+/* Deliver size bytes to the peer together with its count-th signal */
+static void
+send_signaled (enum signal_method method, int size, long count, int peer)
+{
+    switch (method) {
+#ifdef OSHM_1_5
+        case METHOD_SIGNAL:
+            shmem_putmem_signal(r_buf, s_buf, size, &sig, 1,
+                    SHMEM_SIGNAL_ADD, peer);
+            break;
+        case METHOD_SIGNAL_NBI:
+            shmem_putmem_signal_nbi(r_buf, s_buf, size, &sig, 1,
+                    SHMEM_SIGNAL_ADD, peer);
+            break;
+#endif
+        default:
+            shmem_putmem(r_buf, s_buf, size, peer);
+            shmem_fence();
+            shmem_long_p(&flag, count, peer);
+            break;
+    }
+}
+
+static void
+wait_signaled (enum signal_method method, long count)
+{
+#ifdef OSHM_1_5
+    if (METHOD_FLAG != method) {
+        shmem_signal_wait_until(&sig, SHMEM_CMP_GE, count);
+        return;
+    }
+#endif
+
+    shmem_long_wait_until(&flag, _SHMEM_CMP_GE, count);
+}
+
+static void
+reset_signals (void)
+{
+    shmem_barrier_all();
+    flag = 0;
+    ack = 0;
+    sig = 0;
+    shmem_barrier_all();
+}
+
+static double
+latency_test (int myid, enum signal_method method, int size, int loop,
+        int skip)
+{
+    double t_start = 0, t_end = 0;
+    int i;
+
+    reset_signals();
+
+    for (i = 0; i < loop + skip; i++) {
+        if (i == skip) {
+            t_start = TIME();
+        }
+
+        if (myid == 0) {
+            send_signaled(method, size, i + 1, 1);
+            wait_signaled(method, i + 1);
+        } else {
+            wait_signaled(method, i + 1);
+            send_signaled(method, size, i + 1, 0);
+        }
+    }
+
+    t_end = TIME();
+    shmem_quiet();
+
+    return (t_end - t_start) / (2.0 * loop);
+}
+
+static double
+bandwidth_test (int myid, enum signal_method method, int size, int loop,
+        int skip)
+{
+    double t_start = 0, t_end = 0;
+    long count = 0;
+    int i, j;
+
+    reset_signals();
+
+    for (i = 0; i < loop + skip; i++) {
+        if (i == skip) {
+            t_start = TIME();
+        }
+
+        if (myid == 0) {
+            for (j = 0; j < SIGNAL_WINDOW; j++) {
+                send_signaled(method, size, ++count, 1);
+            }
+            shmem_long_wait_until(&ack, _SHMEM_CMP_GE, i + 1);
+        } else {
+            count += SIGNAL_WINDOW;
+            wait_signaled(method, count);
+            shmem_long_p(&ack, i + 1, 0);
+        }
+    }
+
+    t_end = TIME();
+    shmem_quiet();
+
+    return ((double)size * SIGNAL_WINDOW * loop) / (t_end - t_start);
+}
+
+static void
+print_signal_header (int myid, char const * title)
+{
+    enum signal_method method;
+
+    if (myid == 0) {
+        fprintf(stdout, "# %s\n", title);
+        fprintf(stdout, "%-*s", 10, "# Size");
+        for (method = METHOD_FLAG; method < METHOD_NUM; method++) {
+            fprintf(stdout, "%*s", FIELD_WIDTH, method_name[method]);
+        }
+        fprintf(stdout, "\n");
+        fflush(stdout);
+    }
+}
+
+static void
+print_signal_data (int myid, int size, double const * value)
+{
+    enum signal_method method;
+
+    if (myid == 0) {
+        fprintf(stdout, "%-*d", 10, size);
+        for (method = METHOD_FLAG; method < METHOD_NUM; method++) {
+            fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                    value[method]);
+        }
+        fprintf(stdout, "\n");
+        fflush(stdout);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int myid, numprocs, bw;
+    int size, loop, skip;
+    char *s_buf_heap = NULL, *r_buf_heap = NULL;
+    int align_size;
+    int use_heap = 0;   //default uses global
+    int po_ret;
+    double value[METHOD_NUM];
+    enum signal_method method;
+
+#ifdef OSHM_1_3
+    shmem_init();
+    myid = shmem_my_pe();
+    numprocs = shmem_n_pes();
+#else
+    start_pes(0);
+    myid = _my_pe();
+    numprocs = _num_pes();
+#endif
+
+    options.bench = OSHM;
+    options.subtype = PGAS_LAT;
+    options.pgas_memory = PGAS_MEMORY_GLOBAL;
+
+    po_ret = process_options(argc, argv);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_usage_pgas_pt2pt(myid, argv[0], "");
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_usage_pgas_pt2pt(myid, argv[0], "");
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            if (myid == 0) {
+                print_version_pgas(HEADER);
+            }
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    use_heap = (PGAS_MEMORY_HEAP == options.pgas_memory);
+
+    if(numprocs != 2) {
+        if(myid == 0) {
+            fprintf(stderr, "This test requires exactly two processes\n");
+        }
+
+        return EXIT_FAILURE;
+    }
+
+    align_size = MESSAGE_ALIGNMENT;
+
+    limit_message_size_pgas(myid, use_heap ?
+            options.max_mem_limit / 2 - align_size : MYBUFSIZE);
+
+    if(use_heap) {
+#ifdef OSHM_1_3
+        s_buf_heap = (char *)shmem_malloc(options.max_message_size + align_size);
+        r_buf_heap = (char *)shmem_malloc(options.max_message_size + align_size);
+#else
+        s_buf_heap = (char *)shmalloc(options.max_message_size + align_size);
+        r_buf_heap = (char *)shmalloc(options.max_message_size + align_size);
+#endif
+
+        s_buf =
+            (char *) (((unsigned long) s_buf_heap + (align_size - 1)) /
+                      align_size * align_size);
+
+        r_buf =
+            (char *) (((unsigned long) r_buf_heap + (align_size - 1)) /
+                      align_size * align_size);
+    } else {
+        s_buf =
+            (char *) (((unsigned long) s_buf_original + (align_size - 1)) /
+                      align_size * align_size);
+
+        r_buf =
+            (char *) (((unsigned long) r_buf_original + (align_size - 1)) /
+                      align_size * align_size);
+    }
+
+    if(myid == 0) {
+        fprintf(stdout, HEADER);
+        fflush(stdout);
+    }
+
+    for (bw = 0; bw <= 1; bw++) {
+        print_signal_header(myid, bw ? "Bandwidth (MB/s)" : "Latency (us)");
+
+        reset_message_sizes();
+        for(size = options.min_message_size; size <= options.max_message_size;
+                size = next_message_size(size)) {
+            /* touch the data */
+            touch_host_buffer(s_buf, size);
+            touch_host_buffer(r_buf, size);
+
+            if(size > LARGE_MESSAGE_SIZE) {
+                loop = options.iterations_large;
+                skip = options.skip_large;
+            } else {
+                loop = options.iterations;
+                skip = options.skip;
+            }
+
+            for (method = METHOD_FLAG; method < METHOD_NUM; method++) {
+                value[method] = bw ?
+                    bandwidth_test(myid, method, size, loop, skip) :
+                    latency_test(myid, method, size, loop, skip);
+            }
+
+            print_signal_data(myid, size, value);
+        }
+    }
+
+    shmem_barrier_all();
+
+    if(use_heap){
+#ifdef OSHM_1_3
+        shmem_free(s_buf_heap);
+        shmem_free(r_buf_heap);
+#else
+        shfree(s_buf_heap);
+        shfree(r_buf_heap);
+#endif
+    }
+
+    shmem_barrier_all();
+#ifdef OSHM_1_3
+    shmem_finalize ();
+#endif
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -0,0 +1,301 @@
+#define BENCHMARK "OSU OpenSHMEM Strided Put/Get Latency and Bandwidth Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * PE 0 transfers a number of 64-bit elements, STRIDE elements apart on both
+ * sides, to and from PE 1 with shmem_iput64 and shmem_iget64.  The same
+ * elements are also moved through a contiguous buffer: packed by PE 0 and
+ * sent with shmem_putmem, or fetched with shmem_getmem and unpacked by PE 0,
+ * which is what a code without strided transfers does.  The target side of
+ * the contiguous transfers stays contiguous, so unpacking there is not part
+ * of the time.
+ */
+
+#include <shmem.h>
+#include <osu_util_pgas.h>
+
+#define DEF_STRIDE          2
+#define STRIDED_WINDOW      WINDOW_SIZE_LARGE
+
+enum strided_op {
+    OP_IPUT,
+    OP_PACK_PUT,
+    OP_IGET,
+    OP_GET_UNPACK,
+    OP_NUM
+};
+
+static char const * op_name[] = {"shmem_iput64", "Pack+Put", "shmem_iget64",
+    "Get+Unpack"};
+
+uint64_t s_buf_original[MYBUFSIZE / sizeof(uint64_t)];
+uint64_t r_buf_original[MYBUFSIZE / sizeof(uint64_t)];
+
+static uint64_t *s_buf, *r_buf, *pack_buf;
+static int stride = DEF_STRIDE;
+
+static void
+usage (int myid, char const * prog)
+{
+    print_usage_pgas_pt2pt(myid, prog, " [STRIDE]");
+
+    if (myid == 0) {
+        fprintf(stdout, "  STRIDE             : Distance of the elements in 64-bit "
+                "words (default %d).\n", DEF_STRIDE);
+        fprintf(stdout, "                       The message size is that of the "
+                "elements moved.\n\n");
+        fflush(stdout);
+    }
+}
+
+/*
+ * Move nelems elements once.  The contiguous variants put into and get from
+ * the start of the receive buffer of PE 1.
+ */
+static void
+transfer (enum strided_op op, int nelems)
+{
+    int k;
+
+    switch (op) {
+        case OP_IPUT:
+            shmem_iput64(r_buf, s_buf, stride, stride, nelems, 1);
+            break;
+        case OP_PACK_PUT:
+            for (k = 0; k < nelems; k++) {
+                pack_buf[k] = s_buf[k * stride];
+            }
+            shmem_putmem(r_buf, pack_buf, nelems * sizeof(uint64_t), 1);
+            break;
+        case OP_IGET:
+            shmem_iget64(s_buf, r_buf, stride, stride, nelems, 1);
+            break;
+        default:
+            shmem_getmem(pack_buf, r_buf, nelems * sizeof(uint64_t), 1);
+            for (k = 0; k < nelems; k++) {
+                s_buf[k * stride] = pack_buf[k];
+            }
+            break;
+    }
+}
+
+/*
+ * Time loop iterations of window transfers, each iteration completed by
+ * shmem_quiet, and return the time per iteration in us.
+ */
+static double
+run_strided (enum strided_op op, int nelems, int window, int loop, int skip)
+{
+    double t_start = 0, t_end = 0;
+    int i, j;
+
+    for (i = 0; i < loop + skip; i++) {
+        if (i == skip) {
+            t_start = TIME();
+        }
+
+        for (j = 0; j < window; j++) {
+            transfer(op, nelems);
+        }
+        shmem_quiet();
+    }
+
+    t_end = TIME();
+
+    return (t_end - t_start) / loop;
+}
+
+static void
+print_strided_header (int myid, char const * title)
+{
+    enum strided_op op;
+
+    if (myid == 0) {
+        fprintf(stdout, "# %s\n", title);
+        fprintf(stdout, "%-*s%*s", 10, "# Elements", 10, "Bytes");
+        for (op = OP_IPUT; op < OP_NUM; op++) {
+            fprintf(stdout, "%*s", FIELD_WIDTH, op_name[op]);
+        }
+        fprintf(stdout, "\n");
+        fflush(stdout);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int myid, numprocs, bw, nelems, min_elements, max_elements;
+    int loop, skip, po_ret;
+    uint64_t *s_buf_heap = NULL, *r_buf_heap = NULL;
+    int use_heap = 0;   //default uses global
+    size_t buf_size;
+    double value[OP_NUM], t;
+    enum strided_op op;
+
+#ifdef OSHM_1_3
+    shmem_init();
+    myid = shmem_my_pe();
+    numprocs = shmem_n_pes();
+#else
+    start_pes(0);
+    myid = _my_pe();
+    numprocs = _num_pes();
+#endif
+
+    options.bench = OSHM;
+    options.subtype = PGAS_LAT;
+    options.pgas_memory = PGAS_MEMORY_GLOBAL;
+
+    po_ret = process_options(argc, argv);
+
+    if (PO_OKAY == po_ret && optind < argc) {
+        stride = atoi(argv[optind++]);
+        if (stride < 1 || optind < argc) {
+            po_ret = PO_BAD_USAGE;
+        }
+    }
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            usage(myid, argv[0]);
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            usage(myid, argv[0]);
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            if (myid == 0) {
+                print_version_pgas(HEADER);
+            }
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    use_heap = (PGAS_MEMORY_HEAP == options.pgas_memory);
+
+    if(numprocs != 2) {
+        if(myid == 0) {
+            fprintf(stderr, "This test requires exactly two processes\n");
+        }
+
+        return EXIT_FAILURE;
+    }
+
+    /* The strided side spans STRIDE words for every element moved */
+    limit_message_size_pgas(myid, (use_heap ? options.max_mem_limit / 2 :
+                MYBUFSIZE) / stride);
+    max_elements = options.max_message_size / sizeof(uint64_t);
+    min_elements = (options.min_message_size + sizeof(uint64_t) - 1) /
+        sizeof(uint64_t);
+    min_elements = min_elements ? min_elements : 1;
+
+    if (max_elements < 1) {
+        if (myid == 0) {
+            fprintf(stderr, "STRIDE leaves no room for a single element\n");
+        }
+        return EXIT_FAILURE;
+    }
+
+    buf_size = (size_t)max_elements * stride * sizeof(uint64_t);
+
+    if(use_heap) {
+#ifdef OSHM_1_3
+        s_buf_heap = (uint64_t *)shmem_malloc(buf_size);
+        r_buf_heap = (uint64_t *)shmem_malloc(buf_size);
+#else
+        s_buf_heap = (uint64_t *)shmalloc(buf_size);
+        r_buf_heap = (uint64_t *)shmalloc(buf_size);
+#endif
+        s_buf = s_buf_heap;
+        r_buf = r_buf_heap;
+    } else {
+        s_buf = s_buf_original;
+        r_buf = r_buf_original;
+    }
+
+    pack_buf = (uint64_t *)malloc(max_elements * sizeof(uint64_t));
+
+    if (NULL == s_buf || NULL == r_buf || NULL == pack_buf) {
+        fprintf(stderr, "Failed to allocate memory (pe: %d)\n", myid);
+        return EXIT_FAILURE;
+    }
+
+    memset(s_buf, 'a', buf_size);
+    memset(r_buf, 'b', buf_size);
+    memset(pack_buf, 'c', max_elements * sizeof(uint64_t));
+
+    if(myid == 0) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "# Stride: %d elements of 8 bytes\n", stride);
+        fflush(stdout);
+    }
+
+    for (bw = 0; bw <= 1; bw++) {
+        print_strided_header(myid, bw ? "Bandwidth (MB/s)" : "Latency (us)");
+
+        reset_message_sizes();
+        for (nelems = min_elements; nelems <= max_elements;
+                nelems = next_message_count(nelems, sizeof(uint64_t))) {
+            if (nelems * sizeof(uint64_t) > LARGE_MESSAGE_SIZE) {
+                loop = options.iterations_large;
+                skip = options.skip_large;
+            } else {
+                loop = options.iterations;
+                skip = options.skip;
+            }
+
+            shmem_barrier_all();
+
+            /* PE 1 only provides the remote buffer */
+            for (op = OP_IPUT; op < OP_NUM && myid == 0; op++) {
+                t = run_strided(op, nelems, bw ? STRIDED_WINDOW : 1, loop,
+                        skip);
+                value[op] = bw ? (double)nelems * sizeof(uint64_t) *
+                    STRIDED_WINDOW / t : t;
+            }
+
+            shmem_barrier_all();
+
+            if (myid == 0) {
+                fprintf(stdout, "%-*d%*lu", 10, nelems, 10,
+                        (unsigned long)(nelems * sizeof(uint64_t)));
+                for (op = OP_IPUT; op < OP_NUM; op++) {
+                    fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                            value[op]);
+                }
+                fprintf(stdout, "\n");
+                fflush(stdout);
+            }
+        }
+    }
+
+    shmem_barrier_all();
+
+    free(pack_buf);
+
+    if(use_heap){
+#ifdef OSHM_1_3
+        shmem_free(s_buf_heap);
+        shmem_free(r_buf_heap);
+#else
+        shfree(s_buf_heap);
+        shfree(r_buf_heap);
+#endif
+    }
+
+    shmem_barrier_all();
+#ifdef OSHM_1_3
+    shmem_finalize ();
+#endif
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -0,0 +1,353 @@
+#define BENCHMARK "OSU OpenSHMEM Team Collectives Latency Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * Every collective runs on SHMEM_TEAM_WORLD and on teams split from it with
+ * shmem_team_split_strided, once through the OpenSHMEM 1.5 team API and once
+ * through the legacy active-set routine on the same PEs, so both
+ * implementations of the library are compared on identical PE sets.  A team
+ * is a strided set of PEs starting at PE 0, which is how an active set is
+ * described and which keeps PE 0 in every team to print the results.
+ */
+
+#include <shmem.h>
+#include <osu_util_pgas.h>
+
+enum team_kind {
+    TEAM_WORLD,
+    TEAM_EVEN,
+    TEAM_LOWER_HALF,
+    TEAM_NUM
+};
+
+enum coll_kind {
+    COLL_BROADCAST,
+    COLL_REDUCE,
+    COLL_ALLTOALL,
+    COLL_FCOLLECT,
+    COLL_NUM
+};
+
+static char const * team_name[] = {"world", "even PEs", "lower half"};
+
+static char const * team_coll_name[] = {"shmem_broadcastmem",
+    "shmem_int_sum_reduce", "shmem_alltoallmem", "shmem_fcollectmem"};
+
+static char const * legacy_coll_name[] = {"shmem_broadcast32",
+    "shmem_int_sum_to_all", "shmem_alltoall32", "shmem_fcollect32"};
+
+long pSyncBcast[_SHMEM_BCAST_SYNC_SIZE];
+long pSyncRed[_SHMEM_REDUCE_SYNC_SIZE];
+long pSyncAlltoall[_SHMEM_ALLTOALL_SYNC_SIZE];
+long pSyncCollect[_SHMEM_COLLECT_SYNC_SIZE];
+long pSyncBarrier[_SHMEM_BARRIER_SYNC_SIZE];
+
+struct team_vars {
+    shmem_team_t team;
+    int start;
+    int log_stride;
+    int size;
+};
+
+static char *sendbuff, *recvbuff;
+static int *pWrk;
+
+/*
+ * Run one collective of size bytes per PE, through the team API or through
+ * the active set of the team, and return the average latency of this PE.
+ */
+static double
+run_coll (struct team_vars const * t, enum coll_kind coll, int legacy,
+        int size, int iterations, int skip)
+{
+    double t_start, timer = 0;
+    int i;
+
+    for (i = 0; i < iterations + skip; i++) {
+        t_start = TIME();
+
+        if (legacy) {
+            switch (coll) {
+                case COLL_BROADCAST:
+                    shmem_broadcast32(recvbuff, sendbuff, size / 4, 0,
+                            t->start, t->log_stride, t->size, pSyncBcast);
+                    break;
+                case COLL_REDUCE:
+                    shmem_int_sum_to_all((int *)recvbuff, (int *)sendbuff,
+                            size / sizeof(int), t->start, t->log_stride,
+                            t->size, pWrk, pSyncRed);
+                    break;
+                case COLL_ALLTOALL:
+                    shmem_alltoall32(recvbuff, sendbuff, size / 4, t->start,
+                            t->log_stride, t->size, pSyncAlltoall);
+                    break;
+                default:
+                    shmem_fcollect32(recvbuff, sendbuff, size / 4, t->start,
+                            t->log_stride, t->size, pSyncCollect);
+                    break;
+            }
+        } else {
+            switch (coll) {
+                case COLL_BROADCAST:
+                    shmem_broadcastmem(t->team, recvbuff, sendbuff, size, 0);
+                    break;
+                case COLL_REDUCE:
+                    shmem_int_sum_reduce(t->team, (int *)recvbuff,
+                            (int *)sendbuff, size / sizeof(int));
+                    break;
+                case COLL_ALLTOALL:
+                    shmem_alltoallmem(t->team, recvbuff, sendbuff, size);
+                    break;
+                default:
+                    shmem_fcollectmem(t->team, recvbuff, sendbuff, size);
+                    break;
+            }
+        }
+
+        if (i >= skip) {
+            timer += TIME() - t_start;
+        }
+
+        /* Also makes the pSync of the active set safe to reuse */
+        if (legacy) {
+            shmem_barrier(t->start, t->log_stride, t->size, pSyncBarrier);
+        } else {
+            shmem_team_sync(t->team);
+        }
+    }
+
+    return timer / iterations;
+}
+
+static void
+print_team_header (int rank, enum team_kind kind, int team_size,
+        enum coll_kind coll, int full)
+{
+    if (rank == 0 && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "# Team: %s (%d PEs), %s vs %s\n", team_name[kind],
+                team_size, team_coll_name[coll], legacy_coll_name[coll]);
+        fprintf(stdout, "%-*s%*s%*s", 10, "# Size", FIELD_WIDTH,
+                "Team (us)", FIELD_WIDTH, "Legacy (us)");
+
+        if (full) {
+            fprintf(stdout, "%*s%*s%*s", FIELD_WIDTH, "Team Max (us)",
+                    FIELD_WIDTH, "Legacy Max (us)", 12, "Iterations");
+        }
+
+        fprintf(stdout, "\n");
+        fflush(stdout);
+    }
+}
+
+static void
+print_team_data (int rank, int full, enum team_kind kind, enum coll_kind coll,
+        int size, double const * avg_time, double const * max_time,
+        int iterations)
+{
+    if (rank != 0) {
+        return;
+    }
+
+    if (OUTPUT_TABLE != options.output_format) {
+        struct result_metric_t metrics[] = {
+            {"team", kind},
+            {"collective", coll},
+            {"team_avg_latency_us", avg_time[0]},
+            {"legacy_avg_latency_us", avg_time[1]},
+            {"team_max_latency_us", max_time[0]},
+            {"legacy_max_latency_us", max_time[1]},
+            {"iterations", iterations},
+        };
+
+        output_result(benchmark_num_ranks, size, full ? 7 : 4, metrics);
+        return;
+    }
+
+    fprintf(stdout, "%-*d%*.*f%*.*f", 10, size,
+            FIELD_WIDTH, FLOAT_PRECISION, avg_time[0],
+            FIELD_WIDTH, FLOAT_PRECISION, avg_time[1]);
+
+    if (full) {
+        fprintf(stdout, "%*.*f%*.*f%*d", FIELD_WIDTH, FLOAT_PRECISION,
+                max_time[0], FIELD_WIDTH, FLOAT_PRECISION, max_time[1], 12,
+                iterations);
+    }
+
+    fprintf(stdout, "\n");
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+    int i, rank, numprocs, size, iterations, skip, legacy, full;
+    long max_msg_size;
+    static double latency[2], sum_time[2], max_time[2], avg_time[2];
+    struct team_vars teams[TEAM_NUM];
+    enum team_kind kind;
+    enum coll_kind coll;
+    int po_ret;
+
+    options.bench = OSHM;
+
+    for (i = 0; i < _SHMEM_BCAST_SYNC_SIZE; i++) {
+        pSyncBcast[i] = _SHMEM_SYNC_VALUE;
+    }
+    for (i = 0; i < _SHMEM_REDUCE_SYNC_SIZE; i++) {
+        pSyncRed[i] = _SHMEM_SYNC_VALUE;
+    }
+    for (i = 0; i < _SHMEM_ALLTOALL_SYNC_SIZE; i++) {
+        pSyncAlltoall[i] = _SHMEM_SYNC_VALUE;
+    }
+    for (i = 0; i < _SHMEM_COLLECT_SYNC_SIZE; i++) {
+        pSyncCollect[i] = _SHMEM_SYNC_VALUE;
+    }
+    for (i = 0; i < _SHMEM_BARRIER_SYNC_SIZE; i++) {
+        pSyncBarrier[i] = _SHMEM_SYNC_VALUE;
+    }
+
+    shmem_init();
+    rank = shmem_my_pe();
+    numprocs = shmem_n_pes();
+
+    po_ret = process_options(argc, argv);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_usage_pgas(rank, argv[0], 1);
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_usage_pgas(rank, argv[0], 1);
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            if (rank == 0) {
+                print_version_pgas(HEADER);
+            }
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (numprocs < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+        return -1;
+    }
+
+    max_msg_size = options.max_message_size;
+    full = options.show_full;
+    set_num_ranks(numprocs);
+
+    /* Alltoall and fcollect receive size bytes from every PE */
+    if ((uint64_t)max_msg_size * numprocs > options.max_mem_limit) {
+        max_msg_size = options.max_mem_limit / numprocs;
+    }
+
+    /*
+     * The teams, described as active sets: all PEs, the even PEs and the
+     * lower half of the PEs.  Teams of one PE are left out.
+     */
+    teams[TEAM_WORLD].team = SHMEM_TEAM_WORLD;
+    teams[TEAM_WORLD].start = 0;
+    teams[TEAM_WORLD].log_stride = 0;
+    teams[TEAM_WORLD].size = numprocs;
+
+    teams[TEAM_EVEN].start = 0;
+    teams[TEAM_EVEN].log_stride = 1;
+    teams[TEAM_EVEN].size = (numprocs + 1) / 2;
+
+    teams[TEAM_LOWER_HALF].start = 0;
+    teams[TEAM_LOWER_HALF].log_stride = 0;
+    teams[TEAM_LOWER_HALF].size = numprocs / 2;
+
+    for (kind = TEAM_EVEN; kind < TEAM_NUM; kind++) {
+        shmem_team_split_strided(SHMEM_TEAM_WORLD, teams[kind].start,
+                1 << teams[kind].log_stride, teams[kind].size, NULL, 0,
+                &teams[kind].team);
+    }
+
+    sendbuff = (char *)shmem_malloc(max_msg_size * numprocs);
+    recvbuff = (char *)shmem_malloc(max_msg_size * numprocs);
+    pWrk = (int *)shmem_malloc(sizeof(int) * (max_msg_size / sizeof(int) / 2
+                + 1 + _SHMEM_REDUCE_MIN_WRKDATA_SIZE));
+
+    if (NULL == sendbuff || NULL == recvbuff || NULL == pWrk) {
+        fprintf(stderr, "shmem_malloc failed.\n");
+        exit(1);
+    }
+
+    memset(sendbuff, 1, max_msg_size * numprocs);
+    memset(recvbuff, 0, max_msg_size * numprocs);
+
+    if (rank == 0 && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fflush(stdout);
+    }
+
+    for (kind = TEAM_WORLD; kind < TEAM_NUM; kind++) {
+        if (teams[kind].size < 2) {
+            continue;
+        }
+
+        for (coll = COLL_BROADCAST; coll < COLL_NUM; coll++) {
+            print_team_header(rank, kind, teams[kind].size, coll, full);
+
+            for (size = 4; size <= max_msg_size; size *= 2) {
+                if (size > LARGE_MESSAGE_SIZE) {
+                    skip = options.skip_large;
+                    iterations = options.iterations_large;
+                } else {
+                    skip = options.skip;
+                    iterations = options.iterations;
+                }
+
+                for (legacy = 0; legacy <= 1; legacy++) {
+                    latency[legacy] = 0;
+
+                    shmem_barrier_all();
+
+                    if (SHMEM_TEAM_INVALID != teams[kind].team) {
+                        latency[legacy] = run_coll(&teams[kind], coll, legacy,
+                                size, iterations, skip);
+                    }
+                }
+
+                shmem_barrier_all();
+
+                /* PEs outside of the team contribute zero */
+                shmem_double_sum_reduce(SHMEM_TEAM_WORLD, sum_time, latency,
+                        2);
+                shmem_double_max_reduce(SHMEM_TEAM_WORLD, max_time, latency,
+                        2);
+                avg_time[0] = sum_time[0] / teams[kind].size;
+                avg_time[1] = sum_time[1] / teams[kind].size;
+
+                print_team_data(rank, full, kind, coll, size, avg_time,
+                        max_time, iterations);
+            }
+        }
+    }
+
+    for (kind = TEAM_EVEN; kind < TEAM_NUM; kind++) {
+        if (SHMEM_TEAM_INVALID != teams[kind].team) {
+            shmem_team_destroy(teams[kind].team);
+        }
+    }
+
+    shmem_free(pWrk);
+    shmem_free(recvbuff);
+    shmem_free(sendbuff);
+    shmem_finalize();
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
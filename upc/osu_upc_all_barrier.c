@@ -59,6 +59,7 @@ int main(int argc, char *argv[])
     }
 
 
+    set_num_ranks(THREADS);
     print_header_pgas(HEADER, MYTHREAD, full);
     upc_barrier;
 
@@ -22,12 +22,13 @@ shared double latency[THREADS];
 
 int main(int argc, char *argv[])
 {
-    int i = 0, size = 0, iterations, po_ret;
+    int i = 0, j = 0, size = 0, iterations, po_ret;
     int skip;
     double t_start = 0, t_stop = 0, timer=0;
     int max_msg_size = 1<<20, full = 0;
 
     options.bench = UPC;
+    options.sync_in = options.sync_out = PGAS_SYNC_ALL;
 
     po_ret = process_options(argc, argv);
 
@@ -60,6 +61,7 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    set_num_ranks(THREADS);
     print_header_pgas(HEADER, MYTHREAD, full);
 
     src = upc_all_alloc(1, max_msg_size*sizeof(char));
@@ -83,7 +85,12 @@ int main(int argc, char *argv[])
         timer=0;        
         for(i=0; i < iterations + skip ; i++) {
             t_start = TIME();
-            upc_all_broadcast(dst, src, size, SYNC_MODE );
+            for (j = 0; j < options.pgas_chain; j++) {
+                upc_all_broadcast(dst, src, size, COLL_SYNC_MODE);
+            }
+            if (options.pgas_chain > 1) {
+                upc_barrier;
+            }
             t_stop = TIME();
 
             if(i>=skip){
@@ -92,7 +99,7 @@ int main(int argc, char *argv[])
             upc_barrier;
         }
         upc_barrier;
-        latency[MYTHREAD] = (1.0 * timer) / iterations;
+        latency[MYTHREAD] = (1.0 * timer) / (iterations * options.pgas_chain);
 
         upc_all_reduceD(&min_time, latency, UPC_MIN, THREADS, 1, NULL, SYNC_MODE);
         upc_all_reduceD(&max_time, latency, UPC_MAX, THREADS, 1, NULL, SYNC_MODE);
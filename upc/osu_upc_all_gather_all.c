@@ -20,12 +20,13 @@ shared double latency[THREADS];
 
 int main(int argc, char *argv[])
 {
-    int i = 0, size = 0, iterations, po_ret;
+    int i = 0, j = 0, size = 0, iterations, po_ret;
     int skip;
     double t_start = 0, t_stop = 0, timer=0;
     int max_msg_size = 1<<20, full = 0;
 
     options.bench = UPC;
+    options.sync_in = options.sync_out = PGAS_SYNC_ALL;
 
     po_ret = process_options(argc, argv);
 
@@ -57,6 +58,7 @@ int main(int argc, char *argv[])
         }
         return -1;
     }
+    set_num_ranks(THREADS);
     print_header_pgas(HEADER, MYTHREAD, full);
 
     src = upc_all_alloc(THREADS, max_msg_size*sizeof(char));
@@ -80,7 +82,12 @@ int main(int argc, char *argv[])
         timer=0;        
         for(i=0; i < iterations + skip ; i++) {
             t_start = TIME();
-            upc_all_gather_all(dst, src, size, SYNC_MODE );
+            for (j = 0; j < options.pgas_chain; j++) {
+                upc_all_gather_all(dst, src, size, COLL_SYNC_MODE);
+            }
+            if (options.pgas_chain > 1) {
+                upc_barrier;
+            }
             t_stop = TIME();
 
             if(i>=skip){
@@ -89,7 +96,7 @@ int main(int argc, char *argv[])
             upc_barrier;
         }
         upc_barrier;
-        latency[MYTHREAD] = (1.0 * timer) / iterations;
+        latency[MYTHREAD] = (1.0 * timer) / (iterations * options.pgas_chain);
 
         upc_all_reduceD(&min_time, latency, UPC_MIN, THREADS, 1, NULL, SYNC_MODE);
         upc_all_reduceD(&max_time, latency, UPC_MAX, THREADS, 1, NULL, SYNC_MODE);
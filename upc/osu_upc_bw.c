@@ -0,0 +1,192 @@
+#define BENCHMARK "OSU UPC Non-blocking Bandwidth Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * The threads below THREADS/2 issue a window of upc_memput_nb to, or of
+ * upc_memget_nb from, the thread THREADS/2 above and complete it with
+ * upc_sync on every handle, as osu_bw does with MPI_Isend and MPI_Waitall.
+ * The bandwidth of the pair of thread 0 is reported.
+ */
+
+#include <upc.h>
+#include <upc_nb.h>
+#include <../util/osu_util_pgas.h>
+
+enum nb_op {
+    OP_MEMPUT,
+    OP_MEMGET,
+    OP_NUM
+};
+
+static char const * op_name[] = {"upc_memput_nb", "upc_memget_nb"};
+static char const * metric_name[] = {"memput_bw_mbps", "memget_bw_mbps"};
+
+static shared [] char *remote;
+static char *local;
+static upc_handle_t *handle;
+
+/* Return the bandwidth in MB/s of loop windows of size bytes */
+static double
+run_bw (enum nb_op op, int size, int window, int loop, int skip)
+{
+    double t_start = 0, t_end = 0;
+    int i, j;
+
+    for (i = 0; i < loop + skip; i++) {
+        if (i == skip) {
+            wtime(&t_start);
+        }
+
+        for (j = 0; j < window; j++) {
+            handle[j] = OP_MEMPUT == op ?
+                upc_memput_nb(remote, local, size) :
+                upc_memget_nb(local, remote, size);
+        }
+
+        for (j = 0; j < window; j++) {
+            upc_sync(handle[j]);
+        }
+    }
+
+    wtime(&t_end);
+
+    return (double)size * window * loop / (t_end - t_start);
+}
+
+int main(int argc, char **argv)
+{
+    int peerid = (MYTHREAD + THREADS/2) % THREADS;
+    int iamsender = MYTHREAD < THREADS/2;
+    int window_array[] = WINDOW_SIZES;
+    int nwindows, w, window, size, loop, skip, po_ret;
+    double value[OP_NUM];
+    enum nb_op op;
+
+    options.bench = UPC;
+    options.subtype = PGAS_BW;
+
+    po_ret = process_options(argc, argv);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_usage_pgas_pt2pt(MYTHREAD, argv[0], "");
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_usage_pgas_pt2pt(MYTHREAD, argv[0], "");
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            if (MYTHREAD == 0) {
+                print_version_pgas(HEADER);
+            }
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if( THREADS == 1 ) {
+        if(MYTHREAD == 0) {
+            fprintf(stderr, "This test requires at least two UPC threads\n");
+        }
+        return 0;
+    }
+
+    set_header(HEADER);
+    set_num_ranks(THREADS);
+
+    limit_message_size_pgas(MYTHREAD, options.max_mem_limit / 2);
+
+    shared char *data = upc_all_alloc(THREADS, options.max_message_size*2);
+    remote = (shared [] char *)(data + peerid);
+    local = ((char *)(data+MYTHREAD)) + options.max_message_size;
+
+    memset(local, iamsender ? 'a' : 'b', options.max_message_size);
+
+    handle = (upc_handle_t *)malloc(sizeof(upc_handle_t) *
+            MAX(options.window_size, window_array[WINDOW_SIZES_COUNT - 1]));
+
+    if (NULL == handle) {
+        fprintf(stderr, "Failed to allocate memory (thread: %d)\n", MYTHREAD);
+        exit(EXIT_FAILURE);
+    }
+
+    if (!MYTHREAD && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "# [ pairs: %d ] Bandwidth (MB/s) of the first pair\n",
+                THREADS/2);
+        fflush(stdout);
+    }
+
+    nwindows = options.window_varied ? WINDOW_SIZES_COUNT : 1;
+
+    for (w = 0; w < nwindows; w++) {
+        window = options.window_varied ? window_array[w] : options.window_size;
+
+        if (!MYTHREAD && OUTPUT_TABLE == options.output_format) {
+            fprintf(stdout, "# Window: %d\n", window);
+            fprintf(stdout, "%-*s", 10, "# Size");
+            for (op = OP_MEMPUT; op < OP_NUM; op++) {
+                fprintf(stdout, "%*s", FIELD_WIDTH, op_name[op]);
+            }
+            fprintf(stdout, "\n");
+            fflush(stdout);
+        }
+
+        reset_message_sizes();
+        for (size = options.min_message_size;
+                size <= options.max_message_size;
+                size = next_message_size(size)) {
+            if(size > LARGE_MESSAGE_SIZE) {
+                loop = options.iterations_large;
+                skip = options.skip_large;
+            } else {
+                loop = options.iterations;
+                skip = options.skip;
+            }
+
+            for (op = OP_MEMPUT; op < OP_NUM; op++) {
+                upc_barrier;
+
+                if (iamsender) {
+                    value[op] = run_bw(op, size, window, loop, skip);
+                }
+
+                upc_barrier;
+            }
+
+            if (!MYTHREAD && OUTPUT_TABLE != options.output_format) {
+                struct result_metric_t metrics[OP_NUM + 1];
+
+                metrics[0].name = "window";
+                metrics[0].value = window;
+                for (op = OP_MEMPUT; op < OP_NUM; op++) {
+                    metrics[op + 1].name = metric_name[op];
+                    metrics[op + 1].value = value[op];
+                }
+
+                output_result(benchmark_num_ranks, size, OP_NUM + 1, metrics);
+            } else if (!MYTHREAD) {
+                fprintf(stdout, "%-*d", 10, size);
+                for (op = OP_MEMPUT; op < OP_NUM; op++) {
+                    fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                            value[op]);
+                }
+                fprintf(stdout, "\n");
+                fflush(stdout);
+            }
+        }
+    }
+
+    upc_barrier;
+
+    free(handle);
+
+    return 0;
+}
@@ -12,8 +12,8 @@
 #include <upc.h>
 #include <../util/osu_util_pgas.h>
 
-int skip = 1000;
-int loop = 10000;
+int skip;
+int loop;
 
 int main(int argc, char **argv) 
 {
@@ -22,6 +22,28 @@ int main(int argc, char **argv)
     int peerid = (MYTHREAD + THREADS/2) % THREADS; 
     int iamsender = 0;
     int i;
+    int po_ret;
+
+    options.bench = UPC;
+    options.subtype = PGAS_LAT;
+
+    po_ret = process_options(argc, argv);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_usage_pgas_pt2pt(MYTHREAD, argv[0], "");
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_usage_pgas_pt2pt(MYTHREAD, argv[0], "");
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            if (MYTHREAD == 0) {
+                print_version_pgas(HEADER);
+            }
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
 
     if( THREADS == 1 ) {
         if(MYTHREAD == 0) {
@@ -33,9 +55,11 @@ int main(int argc, char **argv)
     if ( MYTHREAD < THREADS/2 )
         iamsender = 1;
 
-    shared char *data = upc_all_alloc(THREADS, MAX_MESSAGE_SIZE*2);
+    limit_message_size_pgas(MYTHREAD, options.max_mem_limit / 2);
+
+    shared char *data = upc_all_alloc(THREADS, options.max_message_size*2);
     shared [] char *remote = (shared [] char *)(data + peerid);
-    char *local = ((char *)(data+MYTHREAD)) + MAX_MESSAGE_SIZE;
+    char *local = ((char *)(data+MYTHREAD)) + options.max_message_size;
 
     if ( !MYTHREAD ) {
         fprintf(stdout, HEADER);
@@ -44,22 +68,19 @@ int main(int argc, char **argv)
         fflush(stdout);
     }
 
-    for (int size = 1; size <= MAX_MESSAGE_SIZE; size*=2) {
+    for (int size = options.min_message_size;
+            size <= options.max_message_size; size = next_message_size(size)) {
 
-        if ( iamsender )
-            for(i = 0; i < size; i++) {
-                local[i] = 'a';
-            }
-        else
-            for(i = 0; i < size; i++) {
-                local[i] = 'b';
-            }
+        fill_host_buffer(local, iamsender ? 'a' : 'b', size);
 
         upc_barrier;
 
         if(size > LARGE_MESSAGE_SIZE) {
-            loop = UPC_LOOP_LARGE;
-            skip = UPC_SKIP_LARGE;
+            loop = options.iterations_large;
+            skip = options.skip_large;
+        } else {
+            loop = options.iterations;
+            skip = options.skip;
         }
 
         if( iamsender )
@@ -16,8 +16,8 @@ using namespace upcxx;
 
 #define VERIFY 0
 
-int skip = 1000;
-int loop = 10000;
+int skip;
+int loop;
 
 int
 main (int argc, char **argv)
@@ -29,6 +29,28 @@ main (int argc, char **argv)
     int peerid = (myrank() + ranks()/2) % ranks();
     int iamsender = 0;
     int i;
+    int po_ret;
+
+    options.bench = UPCXX;
+    options.subtype = PGAS_LAT;
+
+    po_ret = process_options(argc, argv);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_usage_pgas_pt2pt(myrank(), argv[0], "");
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_usage_pgas_pt2pt(myrank(), argv[0], "");
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            if (myrank() == 0) {
+                print_version_pgas(HEADER);
+            }
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
 
     if (ranks() == 1) {
         if (myrank() == 0) {
@@ -43,11 +65,13 @@ main (int argc, char **argv)
 
     shared_array<global_ptr<char>, 1> data_ptrs (ranks());
 
+    limit_message_size_pgas(myrank(), options.max_mem_limit);
+
     /*
      * allocate memory to each global pointer.
      */
     data_ptrs[myrank()] = allocate<char>(myrank(), sizeof(char)
-            * MAX_MESSAGE_SIZE);
+            * options.max_message_size);
 
     /*
      * put a barrier since allocate is non-blocking in upc++
@@ -73,24 +97,18 @@ main (int argc, char **argv)
         fflush(stdout);
     }
 
-    for (int size = 1; size <= MAX_MESSAGE_SIZE; size*=2) {
-        if (iamsender) {
-            for (i = 0; i < size; i++) {
-                char *lptr = (char *)local;
-                lptr[i] = 'a';
-            }
-        } else {
-            for (i = 0; i < size; i++) {
-                char *lptr = (char *)local;
-                lptr[i] = 'b';
-            }
-        }
+    for (int size = options.min_message_size;
+            size <= options.max_message_size; size = next_message_size(size)) {
+        fill_host_buffer((char *)local, iamsender ? 'a' : 'b', size);
 
         barrier();
 
         if (size > LARGE_MESSAGE_SIZE) {
-            loop = UPC_LOOP_LARGE;
-            skip = UPC_SKIP_LARGE;
+            loop = options.iterations_large;
+            skip = options.skip_large;
+        } else {
+            loop = options.iterations;
+            skip = options.skip;
         }
 
         if (iamsender) {
@@ -125,7 +143,7 @@ main (int argc, char **argv)
              * my local and my remote ptr should have same data
              */
             char *lptr = (char *)local;
-            for (int i = 0; i < MIN(20, MAX_MESSAGE_SIZE); i++) {
+            for (int i = 0; i < MIN(20, options.max_message_size); i++) {
                 printf("sender_rank():%d --- lptr[%d]=%c , rptr[%d]=%c \n",
                         myrank(), i, lptr[i], i, (char)remote[i]);
 
@@ -0,0 +1,280 @@
+#define BENCHMARK "OSU UPC++ Progress Attentiveness Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * The ranks below rank_n()/2 time upcxx::rpc round trips and upcxx::rget of
+ * PROGRESS_MSG_SIZE bytes to their peers rank_n()/2 ranks above, while the
+ * peers compute with the engine of the MPI non-blocking benchmarks.  A peer
+ * calls upcxx::progress after every INTERVAL us of computation, which is
+ * doubled from 1 to PROGRESS_MAX_INTERVAL us after a first row of a peer
+ * doing nothing but progress.  With -t thread the peer computes without
+ * calling progress and a thread holding the master persona progresses, so
+ * the RPCs run right away.  This needs the par thread mode of UPC++.
+ */
+
+#include <upcxx/upcxx.hpp>
+#include <osu_util_pgas.h>
+#include <atomic>
+#if UPCXX_THREADMODE
+#include <thread>
+#endif
+
+#define PROGRESS_MSG_SIZE       8
+#define PROGRESS_MAX_INTERVAL   1024
+
+static int partner;
+static char *local_buf;
+static upcxx::global_ptr<char> remote_buf;
+
+/* Set by the sender once it measured a row */
+static std::atomic<bool> done;
+
+#if UPCXX_THREADMODE
+/* Holds the master persona on the main thread of a peer between the rows */
+static upcxx::persona_scope *master_scope;
+#endif
+
+static void
+usage (int rank, char const * prog)
+{
+    if (rank == 0) {
+        fprintf(stdout, " USAGE : %s [-i ITER] [-x ITER] [-K KIND[:SIZE]] "
+                "[-t thread] [-hv]\n", prog);
+        fprintf(stdout, "  -i, --iterations   : Set number of timed operations "
+                "per interval to ITER.\n");
+        fprintf(stdout, "                       By default, the value of ITER "
+                "is %zu.\n", options.iterations);
+        fprintf(stdout, "  -x, --warmup       : Set number of warmup operations "
+                "per interval to ITER.\n");
+        fprintf(stdout, "                       By default, the value of ITER "
+                "is %zu.\n", options.skip);
+        fprintf(stdout, "  -K, --compute-kernel : Computation of the peer: "
+                "dummy (default), triad[:BYTES],\n");
+        fprintf(stdout, "                       gemm[:N], omp-triad or "
+                "omp-gemm, as for the MPI\n");
+        fprintf(stdout, "                       non-blocking collectives.\n");
+        fprintf(stdout, "  -t, --num_test_calls : thread, progress the peer "
+                "from a thread holding\n");
+        fprintf(stdout, "                       the master persona instead of "
+                "between computations.\n");
+        fprintf(stdout, "  -h, --help         : Print this help.\n");
+        fprintf(stdout, "  -v, --version      : Print version info.\n");
+        fprintf(stdout, "\n");
+        fflush(stdout);
+    }
+}
+
+/* Compute interval us at a time until the sender is done */
+static void
+serve (double interval)
+{
+    while (!done) {
+        if (interval > 0) {
+            do_compute_cpu(interval * 1e-6);
+        }
+
+        upcxx::progress();
+    }
+}
+
+#if UPCXX_THREADMODE
+static void
+serve_with_thread (double interval)
+{
+    /* The first row gives up the master persona placed by upcxx::init */
+    if (master_scope) {
+        delete master_scope;
+    } else {
+        upcxx::liberate_master_persona();
+    }
+
+    std::thread progress_thread([]() {
+        upcxx::persona_scope scope(upcxx::master_persona());
+
+        while (!done) {
+            upcxx::progress();
+        }
+    });
+
+    while (!done) {
+        if (interval > 0) {
+            do_compute_cpu(interval * 1e-6);
+        }
+    }
+
+    progress_thread.join();
+
+    master_scope = new upcxx::persona_scope(upcxx::master_persona());
+}
+#endif
+
+/* Return the average latency of skip + loop operations in us */
+static double
+run_op (int rpc, int loop, int skip)
+{
+    double t_start, timer = 0;
+    int i;
+
+    for (i = 0; i < loop + skip; i++) {
+        t_start = TIME();
+
+        if (rpc) {
+            upcxx::rpc(partner, []() {}).wait();
+        } else {
+            upcxx::rget(remote_buf, local_buf, PROGRESS_MSG_SIZE).wait();
+        }
+
+        if (i >= skip) {
+            timer += TIME() - t_start;
+        }
+    }
+
+    return timer / loop;
+}
+
+int
+main (int argc, char **argv)
+{
+    upcxx::init();
+
+    int rank = upcxx::rank_me();
+    int nranks = upcxx::rank_n();
+    int pairs = nranks / 2;
+    int iamsender = rank < pairs;
+    int iampeer = rank >= pairs && rank < 2 * pairs;
+    int interval, po_ret;
+    double value[2], total[2];
+    upcxx::global_ptr<char> buf;
+
+    options.bench = UPCXX;
+    options.subtype = PGAS_PROGRESS;
+
+    po_ret = process_options(argc, argv);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            usage(rank, argv[0]);
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            usage(rank, argv[0]);
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            if (rank == 0) {
+                print_version_pgas(HEADER);
+            }
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (nranks == 1) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two UPC++ ranks\n");
+        }
+        upcxx::finalize();
+        return EXIT_FAILURE;
+    }
+
+#if !UPCXX_THREADMODE
+    if (options.progress_thread) {
+        if (rank == 0) {
+            fprintf(stderr, "A progress thread requires UPCXX_THREADMODE=par\n");
+        }
+        upcxx::finalize();
+        return EXIT_FAILURE;
+    }
+#endif
+
+    partner = iamsender ? rank + pairs : rank - pairs;
+
+    set_header(HEADER);
+    set_num_ranks(nranks);
+
+    buf = upcxx::allocate<char>(PROGRESS_MSG_SIZE, MESSAGE_ALIGNMENT);
+    local_buf = buf.local();
+    memset(local_buf, 'a', PROGRESS_MSG_SIZE);
+
+    {
+        upcxx::dist_object<upcxx::global_ptr<char>> bufs(buf);
+
+        remote_buf = bufs.fetch(partner).wait();
+        upcxx::barrier();
+    }
+
+    allocate_host_arrays();
+    calibrate_host_compute();
+
+    if (rank == 0 && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "# [ pairs: %d ] Peer progress: %s\n", pairs,
+                options.progress_thread ? "thread with the master persona" :
+                "upcxx::progress after every interval");
+        fprintf(stdout, "%-*s%*s%*s\n", 14, "# Interval(us)", FIELD_WIDTH,
+                "RPC Latency(us)", FIELD_WIDTH, "rget Latency(us)");
+        fflush(stdout);
+    }
+
+    for (interval = 0; interval <= PROGRESS_MAX_INTERVAL;
+            interval = interval ? 2 * interval : 1) {
+        value[0] = value[1] = 0;
+        done = false;
+
+        upcxx::barrier();
+
+        if (iamsender) {
+            value[0] = run_op(1, options.iterations, options.skip);
+            value[1] = run_op(0, options.iterations, options.skip);
+
+            upcxx::rpc(partner, []() { done = true; }).wait();
+        } else if (iampeer) {
+#if UPCXX_THREADMODE
+            if (options.progress_thread) {
+                serve_with_thread(interval);
+            } else
+#endif
+            serve(interval);
+        }
+
+        upcxx::barrier();
+
+        upcxx::reduce_one(value, total, 2, upcxx::op_fast_add, 0).wait();
+
+        if (rank == 0 && OUTPUT_TABLE != options.output_format) {
+            struct result_metric_t metrics[] = {
+                {"progress_thread", (double)options.progress_thread},
+                {"rpc_latency_us", total[0] / pairs},
+                {"rget_latency_us", total[1] / pairs},
+            };
+
+            output_result(benchmark_num_ranks, interval, 3, metrics);
+        } else if (rank == 0) {
+            fprintf(stdout, "%-*d%*.*f%*.*f\n", 14, interval, FIELD_WIDTH,
+                    FLOAT_PRECISION, total[0] / pairs, FIELD_WIDTH,
+                    FLOAT_PRECISION, total[1] / pairs);
+            fflush(stdout);
+        }
+    }
+
+    upcxx::barrier();
+
+    free_host_compute();
+    upcxx::deallocate(buf);
+
+    upcxx::finalize();
+
+#if UPCXX_THREADMODE
+    delete master_scope;
+#endif
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -0,0 +1,275 @@
+#define BENCHMARK "OSU UPC++ rput/rget Latency and Bandwidth Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * The ranks below rank_n()/2 move data to and from their peer rank_n()/2
+ * ranks above with upcxx::rput and upcxx::rget.  Completion is tracked
+ * either through the future every operation returns, conjoined with
+ * upcxx::when_all, or through one promise all operations register with
+ * operation_cx::as_promise.  The latency waits for every operation, the
+ * bandwidth issues a window of operations and waits for the window.
+ * Latencies are averaged and bandwidths summed over the pairs.
+ */
+
+#include <upcxx/upcxx.hpp>
+#include <osu_util_pgas.h>
+
+#define RMA_WINDOW WINDOW_SIZE_LARGE
+
+enum rma_method {
+    METHOD_RPUT_FUTURE,
+    METHOD_RPUT_PROMISE,
+    METHOD_RGET_FUTURE,
+    METHOD_RGET_PROMISE,
+    METHOD_NUM
+};
+
+static char const * method_name[] = {"rput Future", "rput Promise",
+    "rget Future", "rget Promise"};
+
+static char const * latency_metric[] = {"rput_future_latency_us",
+    "rput_promise_latency_us", "rget_future_latency_us",
+    "rget_promise_latency_us"};
+
+static char const * bandwidth_metric[] = {"rput_future_bw_mbps",
+    "rput_promise_bw_mbps", "rget_future_bw_mbps", "rget_promise_bw_mbps"};
+
+static char *local_buf;
+static upcxx::global_ptr<char> remote_buf;
+
+/* Issue window operations of size bytes and wait for all of them */
+static void
+transfer (enum rma_method method, int size, int window)
+{
+    upcxx::future<> f = upcxx::make_future();
+    upcxx::promise<> p;
+    int j;
+
+    for (j = 0; j < window; j++) {
+        switch (method) {
+            case METHOD_RPUT_FUTURE:
+                f = upcxx::when_all(f, upcxx::rput(local_buf, remote_buf,
+                            size));
+                break;
+            case METHOD_RPUT_PROMISE:
+                upcxx::rput(local_buf, remote_buf, size,
+                        upcxx::operation_cx::as_promise(p));
+                break;
+            case METHOD_RGET_FUTURE:
+                f = upcxx::when_all(f, upcxx::rget(remote_buf, local_buf,
+                            size));
+                break;
+            default:
+                upcxx::rget(remote_buf, local_buf, size,
+                        upcxx::operation_cx::as_promise(p));
+                break;
+        }
+    }
+
+    f.wait();
+    p.finalize().wait();
+}
+
+/* Return the time per iteration of window operations in us */
+static double
+run_rma (enum rma_method method, int size, int window, int loop, int skip)
+{
+    double t_start = 0, t_end = 0;
+    int i;
+
+    for (i = 0; i < loop + skip; i++) {
+        if (i == skip) {
+            t_start = TIME();
+        }
+
+        transfer(method, size, window);
+    }
+
+    t_end = TIME();
+
+    return (t_end - t_start) / loop;
+}
+
+static void
+print_rma_header (int rank, char const * title)
+{
+    int method;
+
+    if (rank == 0 && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "# %s\n", title);
+        fprintf(stdout, "%-*s", 10, "# Size");
+        for (method = METHOD_RPUT_FUTURE; method < METHOD_NUM; method++) {
+            fprintf(stdout, "%*s", FIELD_WIDTH, method_name[method]);
+        }
+        fprintf(stdout, "\n");
+        fflush(stdout);
+    }
+}
+
+static void
+print_rma_data (int rank, int bw, int size, double const * value)
+{
+    struct result_metric_t metrics[METHOD_NUM];
+    int method;
+
+    if (rank != 0) {
+        return;
+    }
+
+    if (OUTPUT_TABLE != options.output_format) {
+        for (method = METHOD_RPUT_FUTURE; method < METHOD_NUM; method++) {
+            metrics[method].name = bw ? bandwidth_metric[method] :
+                latency_metric[method];
+            metrics[method].value = value[method];
+        }
+
+        output_result(benchmark_num_ranks, size, METHOD_NUM, metrics);
+        return;
+    }
+
+    fprintf(stdout, "%-*d", 10, size);
+    for (method = METHOD_RPUT_FUTURE; method < METHOD_NUM; method++) {
+        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, value[method]);
+    }
+    fprintf(stdout, "\n");
+    fflush(stdout);
+}
+
+int
+main (int argc, char **argv)
+{
+    upcxx::init();
+
+    int rank = upcxx::rank_me();
+    int nranks = upcxx::rank_n();
+    int pairs = nranks / 2;
+    int peer = (rank + pairs) % nranks;
+    int iamsender = rank < pairs;
+    int size, loop, skip, bw, method, po_ret;
+    double value[METHOD_NUM], total[METHOD_NUM];
+    upcxx::global_ptr<char> buf;
+
+    options.bench = UPCXX;
+    options.subtype = PGAS_LAT;
+
+    po_ret = process_options(argc, argv);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_usage_pgas_pt2pt(rank, argv[0], "");
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_usage_pgas_pt2pt(rank, argv[0], "");
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            if (rank == 0) {
+                print_version_pgas(HEADER);
+            }
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (nranks == 1) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two UPC++ ranks\n");
+        }
+        upcxx::finalize();
+        return EXIT_FAILURE;
+    }
+
+    set_header(HEADER);
+    set_num_ranks(nranks);
+
+    limit_message_size_pgas(rank, options.max_mem_limit);
+
+    /*
+     * One buffer per rank in the shared segment: the source and target of
+     * the sender, the remote side for its peer.
+     */
+    buf = upcxx::allocate<char>(options.max_message_size, MESSAGE_ALIGNMENT);
+
+    if (buf == nullptr) {
+        fprintf(stderr, "Failed to allocate %zu bytes in the shared segment "
+                "(rank: %d)\n", options.max_message_size, rank);
+        exit(EXIT_FAILURE);
+    }
+
+    local_buf = buf.local();
+    memset(local_buf, iamsender ? 'a' : 'b', options.max_message_size);
+
+    /* The directory of the buffers has to go before upcxx::finalize */
+    {
+        upcxx::dist_object<upcxx::global_ptr<char>> bufs(buf);
+
+        remote_buf = bufs.fetch(peer).wait();
+        upcxx::barrier();
+    }
+
+    if (rank == 0 && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "# [ pairs: %d ]\n", pairs);
+        fflush(stdout);
+    }
+
+    for (bw = 0; bw <= 1; bw++) {
+        print_rma_header(rank, bw ? "Bandwidth (MB/s)" : "Latency (us)");
+
+        reset_message_sizes();
+        for (size = options.min_message_size;
+                size <= options.max_message_size;
+                size = next_message_size(size)) {
+            if (size > LARGE_MESSAGE_SIZE) {
+                loop = options.iterations_large;
+                skip = options.skip_large;
+            } else {
+                loop = options.iterations;
+                skip = options.skip;
+            }
+
+            for (method = METHOD_RPUT_FUTURE; method < METHOD_NUM; method++) {
+                value[method] = 0;
+
+                upcxx::barrier();
+
+                /* The peers make progress in the barrier */
+                if (iamsender) {
+                    double t = run_rma((enum rma_method)method, size,
+                            bw ? RMA_WINDOW : 1, loop, skip);
+
+                    value[method] = bw ? (double)size * RMA_WINDOW / t : t;
+                }
+
+                upcxx::barrier();
+            }
+
+            upcxx::reduce_one(value, total, METHOD_NUM, upcxx::op_fast_add,
+                    0).wait();
+
+            for (method = METHOD_RPUT_FUTURE; method < METHOD_NUM && !bw;
+                    method++) {
+                total[method] /= pairs;
+            }
+
+            print_rma_data(rank, bw, size, total);
+        }
+    }
+
+    upcxx::barrier();
+
+    upcxx::deallocate(buf);
+
+    upcxx::finalize();
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
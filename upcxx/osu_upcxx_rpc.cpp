@@ -0,0 +1,174 @@
+#define BENCHMARK "OSU UPC++ RPC Latency and Throughput Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * The ranks below rank_n()/2 call upcxx::rpc on their peer rank_n()/2 ranks
+ * above, with a payload of size bytes serialized as a upcxx::view.  The
+ * round trip waits for the future of every call.  The throughput issues a
+ * window of calls, conjoined with upcxx::when_all, and waits for the window.
+ * The peers run the calls while progressing in upcxx::barrier.  Round trips
+ * are averaged and message rates summed over the pairs.
+ */
+
+#include <upcxx/upcxx.hpp>
+#include <osu_util_pgas.h>
+
+#define RPC_WINDOW WINDOW_SIZE_LARGE
+
+static char *payload;
+
+/* Return the time per iteration of window calls in us */
+static double
+run_rpc (int peer, int size, int window, int loop, int skip)
+{
+    double t_start = 0, t_end = 0;
+    int i, j;
+
+    for (i = 0; i < loop + skip; i++) {
+        upcxx::future<> f = upcxx::make_future();
+
+        if (i == skip) {
+            t_start = TIME();
+        }
+
+        for (j = 0; j < window; j++) {
+            f = upcxx::when_all(f, upcxx::rpc(peer,
+                        [](upcxx::view<char>) {},
+                        upcxx::make_view(payload, payload + size)));
+        }
+
+        f.wait();
+    }
+
+    t_end = TIME();
+
+    return (t_end - t_start) / loop;
+}
+
+int
+main (int argc, char **argv)
+{
+    upcxx::init();
+
+    int rank = upcxx::rank_me();
+    int nranks = upcxx::rank_n();
+    int pairs = nranks / 2;
+    int peer = (rank + pairs) % nranks;
+    int iamsender = rank < pairs;
+    int size, loop, skip, po_ret;
+    double value[2], total[2];
+
+    options.bench = UPCXX;
+    options.subtype = PGAS_LAT;
+
+    po_ret = process_options(argc, argv);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_usage_pgas_pt2pt(rank, argv[0], "");
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_usage_pgas_pt2pt(rank, argv[0], "");
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            if (rank == 0) {
+                print_version_pgas(HEADER);
+            }
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (nranks == 1) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two UPC++ ranks\n");
+        }
+        upcxx::finalize();
+        return EXIT_FAILURE;
+    }
+
+    set_header(HEADER);
+    set_num_ranks(nranks);
+
+    limit_message_size_pgas(rank, options.max_mem_limit);
+
+    payload = (char *)malloc(options.max_message_size);
+
+    if (NULL == payload) {
+        fprintf(stderr, "Failed to allocate memory (rank: %d)\n", rank);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(payload, 'a', options.max_message_size);
+
+    if (rank == 0 && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "# [ pairs: %d, window: %d ]\n", pairs, RPC_WINDOW);
+        fprintf(stdout, "%-*s%*s%*s\n", 10, "# Size", FIELD_WIDTH,
+                "Round Trip (us)", FIELD_WIDTH, "Messages/s");
+        fflush(stdout);
+    }
+
+    for (size = options.min_message_size; size <= options.max_message_size;
+            size = next_message_size(size)) {
+        if (size > LARGE_MESSAGE_SIZE) {
+            loop = options.iterations_large;
+            skip = options.skip_large;
+        } else {
+            loop = options.iterations;
+            skip = options.skip;
+        }
+
+        value[0] = value[1] = 0;
+
+        upcxx::barrier();
+
+        if (iamsender) {
+            value[0] = run_rpc(peer, size, 1, loop, skip);
+        }
+
+        upcxx::barrier();
+
+        if (iamsender) {
+            value[1] = 1e6 * RPC_WINDOW / run_rpc(peer, size, RPC_WINDOW,
+                    loop, skip);
+        }
+
+        upcxx::barrier();
+
+        upcxx::reduce_one(value, total, 2, upcxx::op_fast_add, 0).wait();
+        total[0] /= pairs;
+
+        if (rank == 0 && OUTPUT_TABLE != options.output_format) {
+            struct result_metric_t metrics[] = {
+                {"round_trip_us", total[0]},
+                {"messages_per_second", total[1]},
+            };
+
+            output_result(benchmark_num_ranks, size, 2, metrics);
+        } else if (rank == 0) {
+            fprintf(stdout, "%-*d%*.*f%*.*f\n", 10, size, FIELD_WIDTH,
+                    FLOAT_PRECISION, total[0], FIELD_WIDTH, FLOAT_PRECISION,
+                    total[1]);
+            fflush(stdout);
+        }
+    }
+
+    upcxx::barrier();
+
+    free(payload);
+
+    upcxx::finalize();
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -0,0 +1,326 @@
+#define BENCHMARK "OSU UPC++ RPC Message Rate Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * The ranks below rank_n()/2 send windows of RPCs to their peers rank_n()/2
+ * ranks above, with the payload of size bytes in a trivially serializable
+ * struct, a std::vector<char> or a upcxx::view<char>.  The windows of
+ * upcxx::rpc are waited for through their conjoined futures.  The windows
+ * of upcxx::rpc_ff are acknowledged by the peer with one rpc_ff back once it
+ * ran the last call of the window.  The struct is rounded up to the next
+ * power of two of the size and sent up to STRUCT_MAX_SIZE bytes only.
+ *
+ * The peers run the calls while progressing in upcxx::barrier.  The message
+ * rate is averaged over the pairs.
+ */
+
+#include <upcxx/upcxx.hpp>
+#include <osu_util_pgas.h>
+#include <vector>
+
+#define STRUCT_MAX_SIZE 8192
+
+enum rpc_method {
+    METHOD_RPC,
+    METHOD_RPC_FF,
+    METHOD_NUM
+};
+
+enum payload_kind {
+    PAYLOAD_STRUCT,
+    PAYLOAD_VECTOR,
+    PAYLOAD_VIEW,
+    PAYLOAD_NUM
+};
+
+static char const * column_name[METHOD_NUM][PAYLOAD_NUM] = {
+    {"rpc Struct", "rpc Vector", "rpc View"},
+    {"rpc_ff Struct", "rpc_ff Vector", "rpc_ff View"}};
+
+static char const * metric_name[METHOD_NUM][PAYLOAD_NUM] = {
+    {"rpc_struct_mps", "rpc_vector_mps", "rpc_view_mps"},
+    {"rpc_ff_struct_mps", "rpc_ff_vector_mps", "rpc_ff_view_mps"}};
+
+template <int N>
+struct fixed_payload {
+    char data[N];
+};
+
+static int partner;
+static int window;
+static char *payload;
+
+/* rpc_ff windows: calls run by the peer and windows it acknowledged */
+static long received;
+static long acked;
+
+static void
+count_received (void)
+{
+    if (0 == ++received % window) {
+        upcxx::rpc_ff(partner, []() { acked++; });
+    }
+}
+
+/* Return the messages per second of window calls carrying data */
+template <typename Payload>
+static double
+run_rpc_mr (enum rpc_method method, Payload const & data, int loop, int skip)
+{
+    double t_start = 0, t_end = 0;
+    long expected = acked;
+    int i, j;
+
+    for (i = 0; i < loop + skip; i++) {
+        if (i == skip) {
+            t_start = TIME();
+        }
+
+        if (METHOD_RPC == method) {
+            upcxx::future<> f = upcxx::make_future();
+
+            for (j = 0; j < window; j++) {
+                f = upcxx::when_all(f, upcxx::rpc(partner,
+                            [](upcxx::deserialized_type_t<Payload> const &) {},
+                            data));
+            }
+
+            f.wait();
+        } else {
+            for (j = 0; j < window; j++) {
+                upcxx::rpc_ff(partner,
+                        [](upcxx::deserialized_type_t<Payload> const &) {
+                            count_received();
+                        }, data);
+            }
+
+            for (expected++; acked < expected;) {
+                upcxx::progress();
+            }
+        }
+    }
+
+    t_end = TIME();
+
+    return 1e6 * window * loop / (t_end - t_start);
+}
+
+/* Pick the smallest struct of a power of two bytes holding size bytes */
+template <int N>
+static double
+run_struct (enum rpc_method method, int size, int loop, int skip)
+{
+    static fixed_payload<N> data;
+
+    if (size > N) {
+        return run_struct<2 * N>(method, size, loop, skip);
+    }
+
+    memcpy(data.data, payload, N);
+
+    return run_rpc_mr(method, data, loop, skip);
+}
+
+template <>
+double
+run_struct<2 * STRUCT_MAX_SIZE> (enum rpc_method, int, int, int)
+{
+    return 0;
+}
+
+static double
+run_payload (enum rpc_method method, enum payload_kind kind, int size,
+        int loop, int skip)
+{
+    switch (kind) {
+        case PAYLOAD_STRUCT:
+            return run_struct<1>(method, size, loop, skip);
+        case PAYLOAD_VECTOR:
+            return run_rpc_mr(method, std::vector<char>(payload,
+                        payload + size), loop, skip);
+        default:
+            return run_rpc_mr(method, upcxx::make_view(payload,
+                        payload + size), loop, skip);
+    }
+}
+
+static void
+print_rpc_header (int rank)
+{
+    int method, kind;
+
+    if (rank == 0 && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "# Window: %d\n", window);
+        fprintf(stdout, "%-*s", 10, "# Size");
+        for (method = METHOD_RPC; method < METHOD_NUM; method++) {
+            for (kind = PAYLOAD_STRUCT; kind < PAYLOAD_NUM; kind++) {
+                fprintf(stdout, "%*s", FIELD_WIDTH, column_name[method][kind]);
+            }
+        }
+        fprintf(stdout, "\n");
+        fflush(stdout);
+    }
+}
+
+static void
+print_rpc_data (int rank, int size, double const * rate)
+{
+    struct result_metric_t metrics[METHOD_NUM * PAYLOAD_NUM + 1];
+    int i;
+
+    if (rank != 0) {
+        return;
+    }
+
+    if (OUTPUT_TABLE != options.output_format) {
+        metrics[0].name = "window";
+        metrics[0].value = window;
+
+        for (i = 0; i < METHOD_NUM * PAYLOAD_NUM; i++) {
+            metrics[i + 1].name = metric_name[i / PAYLOAD_NUM][i % PAYLOAD_NUM];
+            metrics[i + 1].value = rate[i];
+        }
+
+        output_result(benchmark_num_ranks, size, METHOD_NUM * PAYLOAD_NUM + 1,
+                metrics);
+        return;
+    }
+
+    fprintf(stdout, "%-*d", 10, size);
+    for (i = 0; i < METHOD_NUM * PAYLOAD_NUM; i++) {
+        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, rate[i]);
+    }
+    fprintf(stdout, "\n");
+    fflush(stdout);
+}
+
+int
+main (int argc, char **argv)
+{
+    upcxx::init();
+
+    int rank = upcxx::rank_me();
+    int nranks = upcxx::rank_n();
+    int pairs = nranks / 2;
+    int iamsender = rank < pairs;
+    int window_array[] = WINDOW_SIZES;
+    int nwindows, w, size, loop, skip, method, kind, po_ret;
+    double rate[METHOD_NUM * PAYLOAD_NUM], total[METHOD_NUM * PAYLOAD_NUM];
+
+    options.bench = UPCXX;
+    options.subtype = PGAS_MR_WINDOW;
+
+    po_ret = process_options(argc, argv);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_usage_pgas_pt2pt(rank, argv[0], "");
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_usage_pgas_pt2pt(rank, argv[0], "");
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            if (rank == 0) {
+                print_version_pgas(HEADER);
+            }
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (nranks == 1) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two UPC++ ranks\n");
+        }
+        upcxx::finalize();
+        return EXIT_FAILURE;
+    }
+
+    /* A rank left over by an odd number of ranks keeps its partner unused */
+    partner = iamsender ? rank + pairs : rank - pairs;
+
+    set_header(HEADER);
+    set_num_ranks(nranks);
+
+    limit_message_size_pgas(rank, options.max_mem_limit);
+
+    payload = (char *)malloc(MAX(options.max_message_size, STRUCT_MAX_SIZE));
+
+    if (NULL == payload) {
+        fprintf(stderr, "Failed to allocate memory (rank: %d)\n", rank);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(payload, 'a', MAX(options.max_message_size, STRUCT_MAX_SIZE));
+
+    if (rank == 0 && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "# [ pairs: %d ] Messages/s per pair\n", pairs);
+        fflush(stdout);
+    }
+
+    nwindows = options.window_varied ? WINDOW_SIZES_COUNT : 1;
+
+    for (w = 0; w < nwindows; w++) {
+        window = options.window_varied ? window_array[w] : options.window_size;
+        print_rpc_header(rank);
+
+        reset_message_sizes();
+        for (size = options.min_message_size;
+                size <= options.max_message_size;
+                size = next_message_size(size)) {
+            if (size > LARGE_MESSAGE_SIZE) {
+                loop = options.iterations_large;
+                skip = options.skip_large;
+            } else {
+                loop = options.iterations;
+                skip = options.skip;
+            }
+
+            for (method = METHOD_RPC; method < METHOD_NUM; method++) {
+                for (kind = PAYLOAD_STRUCT; kind < PAYLOAD_NUM; kind++) {
+                    rate[method * PAYLOAD_NUM + kind] = 0;
+
+                    upcxx::barrier();
+                    received = 0;
+                    upcxx::barrier();
+
+                    if (iamsender) {
+                        rate[method * PAYLOAD_NUM + kind] = run_payload(
+                                (enum rpc_method)method,
+                                (enum payload_kind)kind, size, loop, skip);
+                    }
+
+                    upcxx::barrier();
+                }
+            }
+
+            upcxx::reduce_one(rate, total, METHOD_NUM * PAYLOAD_NUM,
+                    upcxx::op_fast_add, 0).wait();
+
+            for (kind = 0; kind < METHOD_NUM * PAYLOAD_NUM; kind++) {
+                total[kind] /= pairs;
+            }
+
+            print_rpc_data(rank, size, total);
+        }
+    }
+
+    upcxx::barrier();
+
+    free(payload);
+
+    upcxx::finalize();
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
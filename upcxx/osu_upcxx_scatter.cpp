@@ -84,6 +84,7 @@ main (int argc, char *argv[])
      */
     barrier();
 
+    set_num_ranks(ranks());
     print_header_pgas(HEADER, myrank(), full);
 
     for (size=1; size <=max_msg_size; size *= 2) {
@@ -0,0 +1,226 @@
+#define BENCHMARK "OSU UPC++ Team Collectives Latency Test"
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * upcxx::barrier, upcxx::broadcast and upcxx::reduce_all run on the world
+ * team, on the local team of the ranks sharing a node with rank 0 and on
+ * the lower half of the ranks, split off the world team with team::split.
+ * Every rank belongs to one team of each kind, the teams of a kind run at
+ * the same time and the results of the team of rank 0 are printed.
+ */
+
+#include <upcxx/upcxx.hpp>
+#include <osu_util_pgas.h>
+
+enum team_kind {
+    TEAM_WORLD,
+    TEAM_LOCAL,
+    TEAM_HALF,
+    TEAM_NUM
+};
+
+enum coll_kind {
+    COLL_BARRIER,
+    COLL_BROADCAST,
+    COLL_REDUCE_ALL,
+    COLL_NUM
+};
+
+static char const * team_name[] = {"world", "local", "lower half"};
+
+static char const * coll_name[] = {"upcxx::barrier", "upcxx::broadcast",
+    "upcxx::reduce_all"};
+
+static char *sendbuf, *recvbuf;
+
+/* Return the average latency of this rank for size bytes, in us */
+static double
+run_coll (upcxx::team & team, enum coll_kind coll, int size, int iterations,
+        int skip)
+{
+    double t_start, timer = 0;
+    int i;
+
+    for (i = 0; i < iterations + skip; i++) {
+        t_start = TIME();
+
+        switch (coll) {
+            case COLL_BARRIER:
+                upcxx::barrier(team);
+                break;
+            case COLL_BROADCAST:
+                upcxx::broadcast(sendbuf, size, 0, team).wait();
+                break;
+            default:
+                upcxx::reduce_all((int *)sendbuf, (int *)recvbuf,
+                        size / sizeof(int), upcxx::op_fast_add, team).wait();
+                break;
+        }
+
+        if (i >= skip) {
+            timer += TIME() - t_start;
+        }
+
+        upcxx::barrier(team);
+    }
+
+    return timer / iterations;
+}
+
+static void
+print_team_header (int rank, enum team_kind kind, int team_size,
+        enum coll_kind coll, int full)
+{
+    if (rank == 0 && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "# Team: %s (%d ranks), %s\n", team_name[kind],
+                team_size, coll_name[coll]);
+
+        if (COLL_BARRIER == coll) {
+            fprintf(stdout, "# Avg Latency(us)");
+        } else {
+            fprintf(stdout, "%-*s%*s", 10, "# Size", FIELD_WIDTH,
+                    "Avg Latency(us)");
+        }
+
+        if (full) {
+            fprintf(stdout, "%*s%*s%*s", FIELD_WIDTH, "Min Latency(us)",
+                    FIELD_WIDTH, "Max Latency(us)", 12, "Iterations");
+        }
+
+        fprintf(stdout, "\n");
+        fflush(stdout);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+    upcxx::init();
+
+    int rank = upcxx::rank_me();
+    int nranks = upcxx::rank_n();
+    int size, max_size, iterations, skip, full, po_ret;
+    double latency, avg_time, min_time, max_time;
+    enum team_kind kind;
+    enum coll_kind coll;
+
+    options.bench = UPCXX;
+
+    po_ret = process_options(argc, argv);
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_usage_pgas(rank, argv[0], 1);
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_usage_pgas(rank, argv[0], 1);
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            if (rank == 0) {
+                print_version_pgas(HEADER);
+            }
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (nranks < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+        upcxx::finalize();
+        return EXIT_FAILURE;
+    }
+
+    max_size = options.max_message_size;
+    full = options.show_full;
+    set_header(HEADER);
+    set_num_ranks(nranks);
+
+    /* Split collectively, the lower and the upper half each form a team */
+    upcxx::team half = upcxx::world().split(rank < nranks / 2 ? 0 : 1, rank);
+    upcxx::team * teams[TEAM_NUM] = {&upcxx::world(), &upcxx::local_team(),
+        &half};
+
+    sendbuf = (char *)malloc(max_size);
+    recvbuf = (char *)malloc(max_size);
+
+    if (NULL == sendbuf || NULL == recvbuf) {
+        fprintf(stderr, "Failed to allocate memory (rank: %d)\n", rank);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(sendbuf, 1, max_size);
+    memset(recvbuf, 0, max_size);
+
+    if (rank == 0 && OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, HEADER);
+        fflush(stdout);
+    }
+
+    for (kind = TEAM_WORLD; kind < TEAM_NUM; kind = (enum team_kind)(kind + 1)) {
+        upcxx::team & team = *teams[kind];
+
+        /* Skipped by all ranks when the team of rank 0 is too small */
+        if (upcxx::broadcast(team.rank_n(), 0).wait() < 2) {
+            continue;
+        }
+
+        for (coll = COLL_BARRIER; coll < COLL_NUM;
+                coll = (enum coll_kind)(coll + 1)) {
+            print_team_header(rank, kind, team.rank_n(), coll, full);
+
+            for (size = 4; size <= max_size; size *= 2) {
+                if (size > LARGE_MESSAGE_SIZE) {
+                    skip = options.skip_large;
+                    iterations = options.iterations_large;
+                } else {
+                    skip = options.skip;
+                    iterations = options.iterations;
+                }
+
+                upcxx::barrier();
+
+                latency = team.rank_n() < 2 ? 0 :
+                    run_coll(team, coll, size, iterations, skip);
+
+                upcxx::barrier();
+
+                avg_time = upcxx::reduce_one(latency, upcxx::op_fast_add, 0,
+                        team).wait() / team.rank_n();
+                min_time = upcxx::reduce_one(latency, upcxx::op_fast_min, 0,
+                        team).wait();
+                max_time = upcxx::reduce_one(latency, upcxx::op_fast_max, 0,
+                        team).wait();
+
+                /* Rank 0 is rank 0 of each of its teams */
+                print_data_pgas(rank, full, COLL_BARRIER == coll ? 0 : size,
+                        avg_time, min_time, max_time, iterations);
+
+                if (COLL_BARRIER == coll) {
+                    break;
+                }
+            }
+        }
+    }
+
+    upcxx::barrier();
+
+    free(sendbuf);
+    free(recvbuf);
+
+    half.destroy();
+    upcxx::finalize();
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
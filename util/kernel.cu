@@ -8,25 +8,223 @@
  * copyright file COPYRIGHT in the top level OMB directory.
  */
 
+/*
+ * Every thread repeats a SAXPY on its element ITERS times in registers, so
+ * the duration of the kernel scales linearly with ITERS and can be calibrated
+ * to a target time without resizing the arrays.
+ */
 __global__ 
-void compute_kernel(float a, float * x, float * y, int N) 
+void compute_kernel(float a, float * x, float * y, int N, int iters) 
 {
     int i = blockIdx.x * blockDim.x + threadIdx.x;
     
     int count = 0;
     
     if (i < N) {
-        for(count=0; count < (N/8); count++) { 
-            y[i] = a * x[i] + y[i];
+        float xi = x[i], yi = y[i];
+
+        for(count=0; count < iters; count++) { 
+            yi = a * xi + yi;
         }
+
+        y[i] = yi;
     }
 }   
 
 extern "C" 
 void 
-call_kernel(float a, float * d_x, float * d_y, int N, cudaStream_t * stream)
+call_kernel(float a, float * d_x, float * d_y, int N, int iters,
+            cudaStream_t * stream)
+{
+    compute_kernel<<<(N+255)/256, 256, 0, *stream>>>(a, d_x, d_y, N, iters);
+}
+
+/*
+ * Count the bytes of BUF that differ from DATA, without copying the buffer to
+ * the host.  The bulk is compared eight bytes at a time, every thread sums its
+ * share of a grid-stride loop and adds it to *ERRORS once.
+ */
+__global__
+void check_kernel(unsigned char const * buf, unsigned char data, size_t size,
+                  unsigned long long * errors)
+{
+    size_t stride = (size_t)gridDim.x * blockDim.x;
+    size_t i = (size_t)blockIdx.x * blockDim.x + threadIdx.x;
+    size_t words = size / 8;
+    unsigned long long pattern = 0x0101010101010101ULL * data;
+    unsigned long long count = 0;
+    unsigned long long const * w = (unsigned long long const *)buf;
+
+    for (size_t k = i; k < words; k += stride) {
+        unsigned long long diff = w[k] ^ pattern;
+
+        for (; diff; diff >>= 8) {
+            count += 0 != (diff & 0xff);
+        }
+    }
+
+    for (size_t k = words * 8 + i; k < size; k += stride) {
+        count += buf[k] != data;
+    }
+
+    if (count) {
+        atomicAdd(errors, count);
+    }
+}
+
+extern "C"
+void
+call_check_kernel(void const * buf, int data, size_t size,
+                  unsigned long long * d_errors)
 {
-    compute_kernel<<<(N+255)/256, 256, 0, *stream>>>(a, d_x, d_y, N);
+    size_t blocks = (size / 8 + 255) / 256;
+
+    if (blocks > 1024) {
+        blocks = 1024;
+    }
+    if (0 == blocks) {
+        blocks = 1;
+    }
+
+    check_kernel<<<blocks, 256>>>((unsigned char const *)buf,
+                                  (unsigned char)data, size, d_errors);
 }
 
+/*
+ * Gather COUNT blocks of BLOCK bytes of BUF into PACKED, or scatter them back
+ * if UNPACK is set.  Block i starts at i * STRIDE + INCREASE * i * (i - 1) / 2,
+ * which covers every datatype of osu_latency_dt.  One thread moves one byte of
+ * a grid-stride loop, so a single launch packs the whole message.
+ */
+__global__
+void pack_kernel(char * packed, char * buf, size_t count, size_t block,
+                 size_t stride, size_t increase, int unpack)
+{
+    size_t step = (size_t)gridDim.x * blockDim.x;
+    size_t bytes = count * block;
+
+    for (size_t k = (size_t)blockIdx.x * blockDim.x + threadIdx.x; k < bytes;
+            k += step) {
+        size_t b = k / block;
+        size_t offset = b * stride + increase * b * (b - 1) / 2 + k % block;
+
+        if (unpack) {
+            buf[offset] = packed[k];
+        } else {
+            packed[k] = buf[offset];
+        }
+    }
+}
 
+extern "C"
+void
+call_pack_kernel(char * packed, char * buf, int count, size_t block,
+                 size_t stride, size_t increase, int unpack)
+{
+    size_t blocks = ((size_t)count * block + 255) / 256;
+
+    if (blocks > 1024) {
+        blocks = 1024;
+    }
+    if (0 == blocks) {
+        blocks = 1;
+    }
+
+    pack_kernel<<<blocks, 256>>>(packed, buf, count, block, stride, increase,
+                                 unpack);
+}
+
+/*
+ * INOUT = IN op INOUT for COUNT elements, one element per thread of a
+ * grid-stride loop.  DTYPE and OP are the values of enum reduce_dtype and
+ * enum reduce_op in osu_util.h: float, double, int and int64 with sum, prod,
+ * max and min, the user-defined operation being a sum.
+ */
+enum {
+    KERNEL_DTYPE_FLOAT = 1,
+    KERNEL_DTYPE_DOUBLE,
+    KERNEL_DTYPE_INT,
+    KERNEL_DTYPE_INT64
+};
+
+enum {
+    KERNEL_OP_SUM,
+    KERNEL_OP_PROD,
+    KERNEL_OP_MAX,
+    KERNEL_OP_MIN,
+    KERNEL_OP_MAXLOC,
+    KERNEL_OP_MINLOC,
+    KERNEL_OP_USER
+};
+
+template <typename T>
+__global__
+void reduce_kernel(T const * in, T * inout, size_t count, int op)
+{
+    size_t step = (size_t)gridDim.x * blockDim.x;
+
+    for (size_t k = (size_t)blockIdx.x * blockDim.x + threadIdx.x; k < count;
+            k += step) {
+        T a = in[k], b = inout[k];
+
+        switch (op) {
+            case KERNEL_OP_PROD:
+                b *= a;
+                break;
+            case KERNEL_OP_MAX:
+                b = a > b ? a : b;
+                break;
+            case KERNEL_OP_MIN:
+                b = a < b ? a : b;
+                break;
+            default:
+                b += a;
+                break;
+        }
+
+        inout[k] = b;
+    }
+}
+
+template <typename T>
+static void
+launch_reduce_kernel(void const * in, void * inout, size_t count, int op)
+{
+    size_t blocks = (count + 255) / 256;
+
+    if (blocks > 1024) {
+        blocks = 1024;
+    }
+    if (0 == blocks) {
+        blocks = 1;
+    }
+
+    reduce_kernel<T><<<blocks, 256>>>((T const *)in, (T *)inout, count, op);
+}
+
+extern "C"
+int
+call_reduce_kernel(void const * in, void * inout, size_t count, int dtype,
+                   int op)
+{
+    if (KERNEL_OP_MAXLOC == op || KERNEL_OP_MINLOC == op) {
+        return -1;
+    }
+
+    switch (dtype) {
+        case KERNEL_DTYPE_FLOAT:
+            launch_reduce_kernel<float>(in, inout, count, op);
+            return 0;
+        case KERNEL_DTYPE_DOUBLE:
+            launch_reduce_kernel<double>(in, inout, count, op);
+            return 0;
+        case KERNEL_DTYPE_INT:
+            launch_reduce_kernel<int>(in, inout, count, op);
+            return 0;
+        case KERNEL_DTYPE_INT64:
+            launch_reduce_kernel<long long>(in, inout, count, op);
+            return 0;
+        default:
+            return -1;
+    }
+}
@@ -14,19 +14,52 @@
 #include <openacc.h>
 #endif
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include <time.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+
 /*
  * GLOBAL VARIABLES
  */
 char const * benchmark_header = NULL;
 char const * benchmark_name = NULL;
+int benchmark_num_ranks = 0;
 int accel_enabled = 0;
 struct options_t options;
 
 struct bad_usage_t bad_usage;
 
+struct latency_hist_t latency_hist;
+struct sample_stats_t latency_stats;
+double convergence_error = 0.0;
+struct timer_info_t timer_info;
+struct pairing_t pairing;
+char * affinity_placement = NULL;
+
+static char const * locality_names[LOCALITY_CLASSES] = {
+    "Intra-socket", "Inter-socket", "Inter-node", "Inter-switch"
+};
+
+/* Short enough for "<title> (MB/s)" to fit a column */
+static char const * locality_titles[LOCALITY_CLASSES] = {
+    "Intra-sock", "Inter-sock", "Inter-node", "Inter-sw"
+};
+
+static char const * locality_keys[LOCALITY_CLASSES] = {
+    "intra_socket", "inter_socket", "inter_node", "inter_switch"
+};
+
 void
 print_header(int rank, int full)
 {
+    if (OUTPUT_TABLE != options.output_format) {
+        return;
+    }
+
     switch(options.bench) {
         case MBW_MR :
         case PT2PT :
@@ -41,25 +74,63 @@ print_header(int rank, int full)
                     case ROCM:
                         printf(benchmark_header, "-ROCM");
                         break;
+                    case SYCL:
+                        printf(benchmark_header, "-SYCL");
+                        break;
                     default:
                         printf(benchmark_header, "");
                         break;
                 }
 
+                print_affinity_summary();
+                print_timer_summary();
+
+                if (SEND_MODE_STANDARD < options.send_mode) {
+                    fprintf(stdout, "# Send mode: %s\n", send_mode_name());
+                }
+
+                if (LOOP_NULL == options.loop) {
+                    fprintf(stdout, "# Loop: null, harness overhead without "
+                            "messages\n");
+                } else if (options.show_loop) {
+                    fprintf(stdout, "# Loop: %s\n", latency_loop_name());
+                }
+
                 switch (options.accel) {
                     case CUDA:
                     case OPENACC:
                     case ROCM:
+                    case SYCL:
                         fprintf(stdout, "# Send Buffer on %s and Receive Buffer on %s\n",
                                'M' == options.src ? "MANAGED (M)" : ('D' == options.src ? "DEVICE (D)" : "HOST (H)"),
                                'M' == options.dst ? "MANAGED (M)" : ('D' == options.dst ? "DEVICE (D)" : "HOST (H)"));
                     default:
-                        if (options.subtype == BW && options.bench != MBW_MR) {
-                            fprintf(stdout, "%-*s%*s\n", 10, "# Size", FIELD_WIDTH, "Bandwidth (MB/s)");
+                        if (STREAM_ON == options.stream && options.bench != MBW_MR) {
+                            print_stream_header();
+                        } else if (VALIDATE_ON == options.validate) {
+                            fprintf(stdout, "%-*s%*s%*s", 10, "# Size", FIELD_WIDTH,
+                                    BW == options.subtype ? "Bandwidth (MB/s)" : "Latency (us)",
+                                    FIELD_WIDTH, "Validation");
+                            print_extra_header();
+                            fprintf(stdout, "\n");
+                        } else if (options.subtype == BW && options.bench != MBW_MR) {
+                            fprintf(stdout, "%-*s%*s", 10, "# Size", FIELD_WIDTH, "Bandwidth (MB/s)");
+                            print_extra_header();
+                            fprintf(stdout, "\n");
+                        } else if (options.subtype == LAT && options.show_locality) {
+                            char const * title = "Latency (us)";
+
+                            print_pairing_summary();
+                            print_locality_header(1, &title, "us");
                         } else if (options.subtype == LAT) {
-                            fprintf(stdout, "%-*s%*s\n", 10, "# Size", FIELD_WIDTH, "Latency (us)");
+                            fprintf(stdout, "%-*s%*s", 10, "# Size", FIELD_WIDTH, "Latency (us)");
+                            print_extra_header();
+                            fprintf(stdout, "\n");
                         } else if (options.subtype == LAT_DT) {
-                            fprintf(stdout, "%-*s%-*s%-*s%-*s%*s\n", 10, "# Size", 10, "# Block", 10, "# Stride", 10, "# Increase", FIELD_WIDTH, "Latency (us)");
+                            fprintf(stdout, "# Datatype: %s, user pack: %s (send), %s (receive)\n",
+                                    dt_layout_name(), dt_pack_name(options.src),
+                                    dt_pack_name(options.dst));
+                            fprintf(stdout, "%-*s%-*s%-*s%-*s%*s%*s\n", 10, "# Size", 10, "# Block", 10, "# Stride", 10, "# Increase", FIELD_WIDTH, "Latency (us)", FIELD_WIDTH, "User Pack (us)");
                         }
                         fflush(stdout);
                 }
@@ -68,6 +139,7 @@ print_header(int rank, int full)
         case COLLECTIVE :
             if (rank == 0) {
                 fprintf(stdout, HEADER, "");
+                print_timer_summary();
 
                 if (options.show_size) {
                     fprintf(stdout, "%-*s", 10, "# Size");
@@ -99,6 +171,29 @@ print_header(int rank, int full)
 void print_data (int rank, int full, int size, double avg_time,
                  double min_time, double max_time, int iterations)
 {
+    if (rank == 0) {
+        record_message_size(size, avg_time);
+        record_model_point(FIT_ALPHA_BETA, benchmark_num_ranks, size,
+                avg_time);
+    }
+
+    if (rank == 0) {
+        struct result_metric_t metrics[] = {
+            {"avg_latency_us", avg_time},
+            {"min_latency_us", min_time},
+            {"max_latency_us", max_time},
+            {"iterations", iterations},
+        };
+
+        if (OUTPUT_TABLE != options.output_format) {
+            output_result(benchmark_num_ranks, size, full ? 4 : 1, metrics);
+            return;
+        }
+
+        compare_baseline(benchmark_num_ranks, size, full ? 4 : 1, metrics);
+        checkpoint_result(benchmark_num_ranks, size, full ? 4 : 1, metrics);
+    }
+
     if (rank == 0) {
         if (options.show_size) {
             fprintf(stdout, "%-*d", 10, size);
@@ -321,551 +416,5188 @@ static int set_num_iterations (int value)
     return 0;
 }
 
-static int set_window_size (int value)
+static int set_convergence (char const * spec)
 {
-    if (1 > value) {
+    char * endptr;
+    double target, budget = DEF_CONVERGE_BUDGET;
+
+    target = strtod(spec, &endptr);
+
+    if (':' == *endptr) {
+        budget = strtod(endptr + 1, &endptr);
+    }
+
+    if (endptr == spec || '\0' != *endptr || 0.0 >= target || 0.0 >= budget) {
         return -1;
     }
 
-    options.window_size = value;
+    options.converge.target = target;
+    options.converge.budget = budget;
 
     return 0;
 }
 
-static int set_device_array_size (int value)
+static int set_cache_mode (char const * spec)
 {
-    if (value < 1 ) {
+    char * endptr;
+    long long pool_size;
+
+    if (0 == strcasecmp(spec, "hot")) {
+        options.cache_mode = CACHE_HOT;
+        return 0;
+    }
+
+    if (0 == strcasecmp(spec, "fresh")) {
+        options.cache_mode = CACHE_FRESH;
+        return 0;
+    }
+
+    if (strncasecmp(spec, "cold", 4) || ('\0' != spec[4] && ':' != spec[4])) {
         return -1;
     }
 
-    options.device_array_size = value;
+    options.cache_mode = CACHE_COLD;
+
+    if (':' == spec[4]) {
+        pool_size = strtoll(spec + 5, &endptr, 10);
+
+        if (endptr == spec + 5 || '\0' != *endptr || 0 >= pool_size) {
+            return -1;
+        }
+
+        options.cache_pool_size = pool_size;
+    } else {
+#ifdef _SC_LEVEL3_CACHE_SIZE
+        /*
+         * Every buffer of every rank on the node gets a pool this large, so
+         * together they are several times the size of the shared cache
+         */
+        pool_size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+        options.cache_pool_size = (0 < pool_size) ? pool_size
+                                                  : DEF_CACHE_POOL_SIZE;
+#else
+        options.cache_pool_size = DEF_CACHE_POOL_SIZE;
+#endif
+    }
 
     return 0;
 }
 
-static int set_num_probes (int value)
+/*
+ * KIND[:SIZE] with KIND dummy, triad, gemm, omp-triad or omp-gemm.  SIZE is
+ * the working set in bytes for the triad and the matrix order for the GEMM.
+ */
+static int set_compute_kernel (char const * spec)
 {
-    if (value < 0 ) {
+    char const * kind = spec;
+    char const * size = strchr(spec, ':');
+    size_t len = size ? (size_t)(size - spec) : strlen(spec);
+    char * endptr;
+    long long value;
+
+    options.compute_omp = 0;
+    if (4 < len && 0 == strncasecmp(kind, "omp-", 4)) {
+        options.compute_omp = 1;
+        kind += 4;
+        len -= 4;
+    }
+
+    if (5 == len && 0 == strncasecmp(kind, "dummy", 5) &&
+            !options.compute_omp && !size) {
+        options.compute_kernel = KERNEL_DUMMY;
+        return 0;
+    } else if (5 == len && 0 == strncasecmp(kind, "triad", 5)) {
+        options.compute_kernel = KERNEL_TRIAD;
+        options.compute_size = DEF_TRIAD_SIZE;
+    } else if (4 == len && 0 == strncasecmp(kind, "gemm", 4)) {
+        options.compute_kernel = KERNEL_GEMM;
+        options.compute_size = DEF_GEMM_SIZE;
+    } else {
         return -1;
     }
 
-    options.num_probes = value;
+#ifndef _OPENMP
+    if (options.compute_omp) {
+        return -1;
+    }
+#endif
+
+    if (size) {
+        value = strtoll(size + 1, &endptr, 10);
+
+        if (endptr == size + 1 || '\0' != *endptr || 0 >= value) {
+            return -1;
+        }
+        if (KERNEL_GEMM == options.compute_kernel && MAX_GEMM_SIZE < value) {
+            return -1;
+        }
+
+        options.compute_size = value;
+    }
 
     return 0;
 }
 
-static int set_max_memlimit (long long value)
+/*
+ * CHUNK[:DEPTH], the segment size in bytes and the number of segments in
+ * flight of the pipelined comparison.
+ */
+static int set_pipeline (char const * spec)
 {
-    options.max_mem_limit = value;
+    char * endptr;
+    long long chunk = strtoll(spec, &endptr, 10);
+    long depth = DEF_PIPELINE_DEPTH;
 
-    if (value < MAX_MEM_LOWER_LIMIT) {
-        options.max_mem_limit = MAX_MEM_LOWER_LIMIT;
-        fprintf(stderr,"Requested memory limit too low, using [%d] instead.",
-                MAX_MEM_LOWER_LIMIT);
+    if (endptr == spec || 0 >= chunk) {
+        return -1;
+    }
+
+    if (':' == *endptr) {
+        char const * p = endptr + 1;
+
+        depth = strtol(p, &endptr, 10);
+        if (endptr == p || 1 > depth || MAX_PIPELINE_DEPTH < depth) {
+            return -1;
+        }
+    }
+
+    if ('\0' != *endptr) {
+        return -1;
     }
 
+    options.pipeline = PIPELINE_ON;
+    options.pipeline_chunk = chunk;
+    options.pipeline_depth = depth;
+
     return 0;
 }
 
-void set_header (const char * header)
+/* SHAPE[:DIMS] with SHAPE face, graph or full and DIMS 1 to 3 */
+static int set_stencil (char const * spec)
 {
-    benchmark_header = header;
+    char const * dims = strchr(spec, ':');
+    size_t len = dims ? (size_t)(dims - spec) : strlen(spec);
+    char * endptr;
+    long value = DEF_STENCIL_DIMS;
+
+    if (4 == len && 0 == strncasecmp(spec, "face", 4)) {
+        options.stencil = STENCIL_FACE;
+    } else if (5 == len && 0 == strncasecmp(spec, "graph", 5)) {
+        options.stencil = STENCIL_GRAPH;
+    } else if (4 == len && 0 == strncasecmp(spec, "full", 4)) {
+        options.stencil = STENCIL_FULL;
+    } else {
+        return -1;
+    }
+
+    if (dims) {
+        value = strtol(dims + 1, &endptr, 10);
+
+        if (endptr == dims + 1 || '\0' != *endptr || 1 > value ||
+                MAX_STENCIL_DIMS < value) {
+            return -1;
+        }
+    }
+
+    options.stencil_dims = value;
+
+    return 0;
 }
 
-void set_benchmark_name (const char * name)
+/* Indexed by enum reduce_dtype and enum reduce_op */
+static char const * const dtype_names[] = {
+    NULL, "float", "double", "int", "int64", "float_int", "double_int", "2int"
+};
+
+static char const * const op_names[] = {
+    "sum", "prod", "max", "min", "maxloc", "minloc", "user"
+};
+
+static int set_reduce_dtype (char const * spec)
 {
-    benchmark_name = name;
+    int i;
+
+    for (i = DTYPE_FLOAT; i <= DTYPE_2INT; i++) {
+        if (0 == strcasecmp(spec, dtype_names[i])) {
+            options.dtype = (enum reduce_dtype)i;
+            return 0;
+        }
+    }
+
+    return -1;
 }
 
-static int set_dt_block_size (int value)
+static int set_reduce_op (char const * spec)
 {
-    if (value < 0 || value > MAX_DT_BLOCK_SIZE) {
-        return -1;
+    int i;
+
+    for (i = OP_SUM; i <= OP_USER; i++) {
+        if (0 == strcasecmp(spec, op_names[i])) {
+            options.op = (enum reduce_op)i;
+            return 0;
+        }
     }
 
-    options.dt_block_size = value;
+    return -1;
+}
 
-    return 0;
+static int set_group_op (char const * spec)
+{
+    static char const * const names[] = {"allreduce", "bcast", "alltoall",
+        "barrier"};
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        if (0 == strcasecmp(spec, names[i])) {
+            options.group_op = (enum group_op)(GROUP_OP_ALLREDUCE + i);
+            return 0;
+        }
+    }
+
+    return -1;
 }
 
-static int set_dt_stride_size (int value)
+static int set_send_mode (char const * spec)
 {
-    if (value < 0 || value > MAX_DT_STRIDE_SIZE) {
-        return -1;
+    static char const * const names[] = {"standard", "sync", "ready",
+        "buffered", "persistent"};
+    int i;
+
+    for (i = 0; i < 5; i++) {
+        if (0 == strcasecmp(spec, names[i])) {
+            options.send_mode = (enum send_mode)(SEND_MODE_STANDARD + i);
+            return 0;
+        }
     }
 
-    options.dt_stride_size = value;
+    return -1;
+}
+
+static int set_child_mode (char const * spec)
+{
+    static char const * const names[] = {"sleep", "touch", "buffers"};
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        if (0 == strcasecmp(spec, names[i])) {
+            options.child_mode = (enum child_mode)(CHILD_MODE_SLEEP + i);
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/* KEY=VALUE[,KEY=VALUE...] of --io-hints, returns 0 if well formed */
+static int check_io_hints (char const * spec)
+{
+    char const * item = spec, * eq, * end;
+
+    do {
+        end = strchr(item, ',');
+        end = end ? end : item + strlen(item);
+        eq = memchr(item, '=', end - item);
+
+        if (NULL == eq || eq == item || eq + 1 == end) {
+            return -1;
+        }
+
+        item = end + 1;
+    } while (*end);
 
     return 0;
 }
 
-static int set_dt_increase_size (int value)
+static char const * const residency_names[RESIDENCY_NUM] = {"fault",
+    "device", "host", "read-mostly", "preferred"};
+
+/* STATE[,STATE...] or all of --residency */
+static int set_residency (char const * spec)
 {
-    if (value < 0) {
-        return -1;
+    char const * item = spec, * end;
+    int i, mask = 0;
+
+    if (0 == strcasecmp(spec, "all")) {
+        options.residency = RESIDENCY_MASK_ALL;
+        return 0;
     }
 
-    options.dt_increase_size = value;
+    do {
+        end = strchr(item, ',');
+        end = end ? end : item + strlen(item);
+
+        for (i = 0; i < RESIDENCY_NUM; i++) {
+            if (strlen(residency_names[i]) == (size_t)(end - item) &&
+                    0 == strncasecmp(item, residency_names[i], end - item)) {
+                break;
+            }
+        }
+
+        if (RESIDENCY_NUM == i) {
+            return -1;
+        }
+
+        mask |= 1 << i;
+        item = end + 1;
+    } while (*end);
+
+    options.residency = mask;
 
     return 0;
 }
 
-void enable_accel_support (void)
+static int set_wildcard (char const * spec)
 {
-    accel_enabled = ((CUDA_ENABLED || OPENACC_ENABLED || ROCM_ENABLED) &&
-            !(options.subtype == LAT_MT || options.subtype == LAT_MP));
+    static char const * const names[] = {"none", "source", "tag", "both"};
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        if (0 == strcasecmp(spec, names[i])) {
+            options.wildcard = (enum tag_wildcard)(TAG_WILDCARD_OFF + i);
+            return 0;
+        }
+    }
+
+    return -1;
 }
 
-int process_options (int argc, char *argv[])
+/* K[,K...], kept in increasing order */
+static int set_groups (char const * spec)
 {
-    extern char * optarg;
-    extern int optind, optopt;
-
-    char const * optstring = NULL;
-    int c, ret = PO_OKAY;
+    char const * p;
+    char * endptr;
+    long k;
+    int i;
 
-    int option_index = 0;
+    options.num_group_counts = 0;
 
-    static struct option long_options[] = {
-            {"help",            no_argument,        0,  'h'},
-            {"version",         no_argument,        0,  'v'},
-            {"full",            no_argument,        0,  'f'},
-            {"message-size",    required_argument,  0,  'm'},
-            {"window-size",     required_argument,  0,  'W'},
-            {"num-test-calls",  required_argument,  0,  't'},
-            {"iterations",      required_argument,  0,  'i'},
-            {"warmup",          required_argument,  0,  'x'},
-            {"array-size",      required_argument,  0,  'a'},
-            {"sync-option",     required_argument,  0,  's'},
-            {"win-options",     required_argument,  0,  'w'},
-            {"mem-limit",       required_argument,  0,  'M'},
-            {"accelerator",     required_argument,  0,  'd'},
-            {"cuda-target",     required_argument,  0,  'r'},
-            {"print-rate",      required_argument,  0,  'R'},
-            {"num-pairs",       required_argument,  0,  'p'},
-            {"vary-window",     required_argument,  0,  'V'},
-            {"dt-block-size",   required_argument,  0,  'B'},
-            {"dt-stride-size",  required_argument,  0,  'S'},
-            {"dt-increase-size",required_argument,  0,  'I'}
-            
-    };
+    for (p = spec; *p; p = endptr + 1) {
+        k = strtol(p, &endptr, 10);
+        if (endptr == p || 1 > k ||
+                MAX_GROUP_COUNTS <= options.num_group_counts) {
+            return -1;
+        }
 
-    enable_accel_support();
+        for (i = options.num_group_counts;
+                i > 0 && options.group_counts[i - 1] > k; i--) {
+            options.group_counts[i] = options.group_counts[i - 1];
+        }
+        options.group_counts[i] = k;
+        options.num_group_counts++;
 
-    if (options.bench == PT2PT) {
-        if (accel_enabled) {
-            if (options.subtype == BW) {
-                optstring = "+:x:i:t:m:d:W:hv";
-            } else if (options.subtype == LAT_DT) {
-                optstring = "+:x:i:m:d:B:S:I:hv";
-            } else {
-                optstring = "+:x:i:m:d:hv";
-            }
-        } else{
-            if (options.subtype == LAT_MT) {
-                optstring = "+:hvm:x:i:t:";
-            } else if (options.subtype == LAT_MP) {
-                optstring = "+:hvm:x:i:t:";
-            } else if (options.subtype == LAT_DT) {
-                optstring = "+:hvm:x:i:B:S:I:";
-            } else if (options.subtype == BW) {
-                optstring = "+:hvm:x:i:t:W:";
-            } else {
-                optstring = "+:hvm:x:i:";
-            }
+        if (!*endptr) {
+            break;
+        } else if (',' != *endptr || !*(endptr + 1)) {
+            return -1;
         }
-    } else if (options.bench == COLLECTIVE) {
-        if (options.subtype == LAT) { /* Blocking */
-            optstring = "+:hvfm:i:x:M:a:";
-            if (accel_enabled) {
-                optstring = (CUDA_KERNEL_ENABLED) ? "+:d:hvfm:i:x:M:r:a:" : "+:d:hvfm:i:x:M:a:";
-            }
-        } else { /* Non-Blocking */
-            optstring = "+:hvfm:i:x:M:t:a:";
-            if (accel_enabled) {
-                optstring = (CUDA_KERNEL_ENABLED) ? "+:d:hvfm:i:x:M:t:r:a:" : "+:d:hvfm:i:x:M:t:a:";
-            }
+    }
+
+    return options.num_group_counts ? 0 : -1;
+}
+
+static int set_pairing (char const * spec)
+{
+    static struct {
+        char const * name;
+        enum pairing_type type;
+    } const patterns[] = {
+        {"block",           PAIRING_BLOCK},
+        {"intra-socket",    PAIRING_INTRA_SOCKET},
+        {"inter-socket",    PAIRING_INTER_SOCKET},
+        {"intra-node",      PAIRING_INTRA_NODE},
+        {"inter-node",      PAIRING_INTER_NODE},
+    };
+    char * endptr;
+    size_t i;
+
+    for (i = 0; i < sizeof(patterns) / sizeof(patterns[0]); i++) {
+        if (0 == strcasecmp(spec, patterns[i].name)) {
+            options.pairing = patterns[i].type;
+            return 0;
         }
-    } else if (options.bench == ONE_SIDED) {
-        if(options.subtype == BW) {
-            optstring = (accel_enabled) ? "+:w:s:hvm:d:x:i:W:" : "+:w:s:hvm:x:i:W:";
-        } else {
-            optstring = (accel_enabled) ? "+:w:s:hvm:d:x:i:" : "+:w:s:hvm:x:i:";
+    }
+
+    /* Switches are not discoverable, the user gives the nodes per switch */
+    if (0 == strncasecmp(spec, "cross-switch:", 13)) {
+        options.nodes_per_switch = strtol(spec + 13, &endptr, 10);
+
+        if (endptr != spec + 13 && '\0' == *endptr
+                && 0 < options.nodes_per_switch) {
+            options.pairing = PAIRING_CROSS_SWITCH;
+            return 0;
         }
-        
-    } else if (options.bench == MBW_MR){
-        optstring = (accel_enabled) ? "p:W:R:x:i:m:d:Vhv" : "p:W:R:x:i:m:Vhv";
-    } else if (options.bench == OSHM || options.bench == UPC || options.bench == UPCXX) {
-        optstring = ":hvfm:i:M:";
-    } else {
-        fprintf(stderr,"Invalid benchmark type");
-        exit(1);
     }
 
-    /* Set default options*/
-    options.accel = NONE;
-    options.show_size = 1;
-    options.show_full = 0;
-    options.num_probes = 0;
-    options.device_array_size = 32;
-    options.target = CPU;
-    options.min_message_size = MIN_MESSAGE_SIZE;
-    options.dt_block_size = MIN_MESSAGE_SIZE;
-    options.dt_stride_size = MIN_MESSAGE_SIZE;
-    options.dt_increase_size = 0;
-    if (options.bench == COLLECTIVE) {
-        options.max_message_size = MAX_MSG_SIZE_COLL;
-    } else {
-        options.max_message_size = MAX_MESSAGE_SIZE;
+    return -1;
+}
+
+static int set_window_size (int value)
+{
+    if (1 > value) {
+        return -1;
     }
-    options.max_mem_limit = MAX_MEM_LIMIT;
-    options.window_size_large = WINDOW_SIZE_LARGE;
-    options.window_size = WINDOW_SIZE_LARGE;
-    options.window_varied = 0;
-    options.print_rate = 1;
 
-    options.src = 'H';
-    options.dst = 'H';
+    options.window_size = value;
 
-    switch (options.subtype) {
-        case BW:
-            options.iterations = BW_LOOP_SMALL;
-            options.skip = BW_SKIP_SMALL;
-            options.iterations_large = BW_LOOP_LARGE;
+    return 0;
+}
+
+static int set_nbc_window (char const * spec)
+{
+    char * endptr;
+    long window = strtol(spec, &endptr, 10);
+
+    if (endptr == spec || 1 > window || MAX_NBC_WINDOW < window) {
+        return -1;
+    }
+
+    if ('\0' == *endptr || 0 == strcasecmp(endptr, ":shared")) {
+        options.nbc_window_mode = NBC_WINDOW_SHARED;
+    } else if (0 == strcasecmp(endptr, ":dup")) {
+        options.nbc_window_mode = NBC_WINDOW_DUP;
+    } else {
+        return -1;
+    }
+
+    options.nbc_window = window;
+
+    return 0;
+}
+
+static int parse_pgas_sync (char const * spec, size_t len, enum pgas_sync * sync)
+{
+    static char const * name[] = {"all", "my", "no"};
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        if (len == strlen(name[i]) && 0 == strncasecmp(spec, name[i], len)) {
+            *sync = (enum pgas_sync)(PGAS_SYNC_ALL + i);
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/* IN:OUT, each of all, my or no; a single value sets both */
+static int set_pgas_sync (char const * spec)
+{
+    char const * colon = strchr(spec, ':');
+
+    if (NULL == colon) {
+        if (parse_pgas_sync(spec, strlen(spec), &options.sync_in)) {
+            return -1;
+        }
+        options.sync_out = options.sync_in;
+
+        return 0;
+    }
+
+    if (parse_pgas_sync(spec, colon - spec, &options.sync_in) ||
+            parse_pgas_sync(colon + 1, strlen(colon + 1), &options.sync_out)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int set_allocator (char const * spec)
+{
+    static struct {
+        char const * name;
+        enum host_allocator allocator;
+    } const allocators[] = {
+        {"default",         ALLOC_DEFAULT},
+        {"thp",             ALLOC_THP},
+        {"hugetlb",         ALLOC_HUGETLB_2M},
+        {"hugetlb:2M",      ALLOC_HUGETLB_2M},
+        {"hugetlb:1G",      ALLOC_HUGETLB_1G},
+        {"mpi",             ALLOC_MPI},
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(allocators) / sizeof(allocators[0]); i++) {
+        if (0 == strcasecmp(spec, allocators[i].name)) {
+            options.allocator = allocators[i].allocator;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * CPU list such as "0-3,8,10-11"; CPUs are kept in the given order
+ */
+static int set_bind_cpus (char const * spec)
+{
+    char const * p = spec;
+    char * endptr;
+    long first, last;
+
+    options.num_bind_cpus = 0;
+
+    while (*p) {
+        first = strtol(p, &endptr, 10);
+        if (endptr == p || 0 > first) {
+            return -1;
+        }
+
+        last = first;
+        p = endptr;
+        if ('-' == *p) {
+            last = strtol(++p, &endptr, 10);
+            if (endptr == p || last < first) {
+                return -1;
+            }
+            p = endptr;
+        }
+
+        if (MAX_BIND_CPUS <= last ||
+                MAX_BIND_CPUS < options.num_bind_cpus + last - first + 1) {
+            return -1;
+        }
+
+        while (first <= last) {
+            options.bind_cpus[options.num_bind_cpus++] = first++;
+        }
+
+        if (',' == *p && *(p + 1)) {
+            p++;
+        } else if (*p) {
+            return -1;
+        }
+    }
+
+    return options.num_bind_cpus ? 0 : -1;
+}
+
+/*
+ * "rank", "list:D0,D1,...", "nic" or "nic:NAME"
+ */
+static int set_gpu_select (char const * spec)
+{
+    char const * p;
+    char * endptr;
+    long dev;
+
+    options.num_gpu_list = 0;
+    options.gpu_nic[0] = '\0';
+
+    if (0 == strcasecmp(spec, "rank")) {
+        options.gpu_select = GPU_SELECT_RANK;
+    } else if (0 == strcasecmp(spec, "nic")) {
+        options.gpu_select = GPU_SELECT_NIC;
+    } else if (0 == strncasecmp(spec, "nic:", 4)) {
+        if (!spec[4] || GPU_NIC_NAME_LEN <= strlen(spec + 4)) {
+            return -1;
+        }
+        options.gpu_select = GPU_SELECT_NIC;
+        strcpy(options.gpu_nic, spec + 4);
+    } else if (0 == strncasecmp(spec, "list:", 5)) {
+        options.gpu_select = GPU_SELECT_LIST;
+
+        for (p = spec + 5; *p; p = endptr + 1) {
+            dev = strtol(p, &endptr, 10);
+            if (endptr == p || 0 > dev || MAX_GPU_LIST <= options.num_gpu_list) {
+                return -1;
+            }
+
+            options.gpu_list[options.num_gpu_list++] = dev;
+
+            if (!*endptr) {
+                break;
+            } else if (',' != *endptr || !*(endptr + 1)) {
+                return -1;
+            }
+        }
+
+        return options.num_gpu_list ? 0 : -1;
+    } else {
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * "shared", "tag", "comm" (one communicator per thread) or "comm:N"
+ */
+static int set_thread_comm (char const * spec)
+{
+    char * endptr;
+
+    if (0 == strcasecmp(spec, "shared")) {
+        options.thread_comm = THREAD_COMM_SHARED;
+        return 0;
+    }
+
+    if (0 == strcasecmp(spec, "tag")) {
+        options.thread_comm = THREAD_COMM_TAG;
+        return 0;
+    }
+
+    if (0 == strcasecmp(spec, "comm")) {
+        options.thread_comm = THREAD_COMM_PRIVATE;
+        options.thread_comms = 0;
+        return 0;
+    }
+
+    if (0 == strncasecmp(spec, "comm:", 5)) {
+        options.thread_comms = strtol(spec + 5, &endptr, 10);
+
+        if (endptr != spec + 5 && '\0' == *endptr && 0 < options.thread_comms
+                && options.thread_comms <= MAX_NUM_THREADS) {
+            options.thread_comm = THREAD_COMM_PRIVATE;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+static int set_device_array_size (int value)
+{
+    if (value < 1 ) {
+        return -1;
+    }
+
+    options.device_array_size = value;
+
+    return 0;
+}
+
+static int set_num_probes (int value)
+{
+    if (value < 0 ) {
+        return -1;
+    }
+
+    options.num_probes = value;
+
+    return 0;
+}
+
+static int set_max_memlimit (long long value)
+{
+    options.max_mem_limit = value;
+
+    if (value < MAX_MEM_LOWER_LIMIT) {
+        options.max_mem_limit = MAX_MEM_LOWER_LIMIT;
+        fprintf(stderr,"Requested memory limit too low, using [%d] instead.",
+                MAX_MEM_LOWER_LIMIT);
+    }
+
+    return 0;
+}
+
+void set_header (const char * header)
+{
+    benchmark_header = header;
+}
+
+void set_benchmark_name (const char * name)
+{
+    benchmark_name = name;
+}
+
+void set_num_ranks (int nprocs)
+{
+    benchmark_num_ranks = nprocs;
+}
+
+static int set_output_format (char const * format)
+{
+    if (0 == strcasecmp(format, "table")) {
+        options.output_format = OUTPUT_TABLE;
+    } else if (0 == strcasecmp(format, "csv")) {
+        options.output_format = OUTPUT_CSV;
+    } else if (0 == strcasecmp(format, "json")) {
+        options.output_format = OUTPUT_JSON;
+    } else {
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Parse a message size schedule:
+ *
+ *   geometric:FACTOR                 min, min * FACTOR, ... up to max
+ *   linear:STEP                      min, min + STEP, ... up to max
+ *   list:SIZE[,SIZE...]              exactly the given sizes
+ *   adaptive[:POINTS[:THRESHOLD]]    power of two sweep, then up to POINTS
+ *                                    extra sizes bisecting the intervals
+ *                                    where the log-log slope of the result
+ *                                    jumps by more than THRESHOLD
+ */
+static int set_size_schedule (char const * spec)
+{
+    struct size_schedule_t * schedule = &options.schedule;
+    char buffer[4096];
+    char * kind, * arg, * endptr;
+
+    /* Parse a copy so that error messages can show the whole argument */
+    if (strlen(spec) >= sizeof(buffer)) {
+        return -1;
+    }
+
+    strcpy(buffer, spec);
+    kind = strtok(buffer, ":");
+    arg = strtok(NULL, "");
+
+    if (NULL == kind) {
+        return -1;
+    }
+
+    if (0 == strcasecmp(kind, "geometric")) {
+        if (NULL == arg) {
+            return -1;
+        }
+
+        schedule->factor = strtod(arg, &endptr);
+        if (*endptr || schedule->factor <= 1.0) {
+            return -1;
+        }
+
+        schedule->type = SCHEDULE_GEOMETRIC;
+    } else if (0 == strcasecmp(kind, "linear")) {
+        long long step;
+
+        if (NULL == arg) {
+            return -1;
+        }
+
+        step = strtoll(arg, &endptr, 10);
+        if (*endptr || step <= 0) {
+            return -1;
+        }
+
+        schedule->step = step;
+        schedule->type = SCHEDULE_LINEAR;
+    } else if (0 == strcasecmp(kind, "list")) {
+        char * token;
+        int i;
+
+        schedule->list_len = 0;
+
+        for (token = strtok(arg, ","); token; token = strtok(NULL, ",")) {
+            long long value = strtoll(token, &endptr, 10);
+
+            if (*endptr || value < 0 ||
+                    MAX_SCHEDULE_SIZES == schedule->list_len) {
+                return -1;
+            }
+
+            /* Keep the list sorted and free of duplicates */
+            for (i = schedule->list_len; i > 0 &&
+                    schedule->list[i - 1] > (size_t)value; i--) {
+                schedule->list[i] = schedule->list[i - 1];
+            }
+
+            if (i > 0 && schedule->list[i - 1] == (size_t)value) {
+                memmove(&schedule->list[i], &schedule->list[i + 1],
+                        (schedule->list_len - i) * sizeof(size_t));
+                continue;
+            }
+
+            schedule->list[i] = value;
+            schedule->list_len++;
+        }
+
+        if (0 == schedule->list_len) {
+            return -1;
+        }
+
+        schedule->type = SCHEDULE_LIST;
+    } else if (0 == strcasecmp(kind, "adaptive")) {
+        char * points = arg ? strtok(arg, ":") : NULL;
+        char * threshold = points ? strtok(NULL, ":") : NULL;
+
+        if (points) {
+            schedule->max_points = strtol(points, &endptr, 10);
+            if (*endptr || schedule->max_points < 0) {
+                return -1;
+            }
+        }
+
+        if (threshold) {
+            schedule->threshold = strtod(threshold, &endptr);
+            if (*endptr || schedule->threshold <= 0) {
+                return -1;
+            }
+        }
+
+        schedule->type = SCHEDULE_ADAPTIVE;
+    } else {
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Adaptive schedule state: results reported for each measured size (only
+ * filled in on the rank that prints) and the number of refinement points
+ * still allowed once the initial power of two sweep is done.
+ */
+static struct {
+    size_t size;
+    double value;
+} schedule_points[MAX_SCHEDULE_SIZES];
+static int schedule_num_points = 0;
+static int schedule_refining = 0;
+static int schedule_points_left = 0;
+
+static int checkpoint_sweep = 0;
+static void checkpoint_mark (size_t size);
+static int checkpoint_skip (size_t size);
+static void checkpoint_config_add (int c, char const * arg);
+
+void reset_message_sizes (void)
+{
+    checkpoint_sweep++;
+    schedule_num_points = 0;
+    schedule_refining = 0;
+    schedule_points_left = options.schedule.max_points;
+}
+
+void record_message_size (size_t size, double value)
+{
+    int i;
+
+    if (SCHEDULE_ADAPTIVE != options.schedule.type) {
+        return;
+    }
+
+    for (i = 0; i < schedule_num_points; i++) {
+        if (schedule_points[i].size == size) {
+            schedule_points[i].value = value;
+            return;
+        }
+    }
+
+    if (MAX_SCHEDULE_SIZES == schedule_num_points) {
+        return;
+    }
+
+    /* Insert sorted by size */
+    for (i = schedule_num_points; i > 0 && schedule_points[i - 1].size > size;
+            i--) {
+        schedule_points[i] = schedule_points[i - 1];
+    }
+
+    schedule_points[i].size = size;
+    schedule_points[i].value = value;
+    schedule_num_points++;
+}
+
+static double schedule_slope (int i)
+{
+    double v0 = schedule_points[i].value, v1 = schedule_points[i + 1].value;
+    double s0 = schedule_points[i].size, s1 = schedule_points[i + 1].size;
+
+    return log(v1 / v0) / log(s1 / s0);
+}
+
+static int schedule_usable (int i)
+{
+    return schedule_points[i].size > 0 && schedule_points[i].value > 0 &&
+        schedule_points[i + 1].value > 0;
+}
+
+/*
+ * Pick the next size to measure in the refinement phase: the midpoint of the
+ * interval whose log-log slope deviates most from its neighbours, if that
+ * deviation exceeds the threshold.  Returns 0 when nothing is left to refine.
+ */
+static size_t schedule_refine (size_t width)
+{
+    double best_deviation = options.schedule.threshold;
+    size_t best = 0;
+    int i;
+
+    if (schedule_points_left <= 0) {
+        return 0;
+    }
+
+    for (i = 0; i + 1 < schedule_num_points; i++) {
+        size_t lo = schedule_points[i].size, hi = schedule_points[i + 1].size;
+        double slope, reference = 0, deviation;
+        int neighbours = 0;
+
+        if (hi - lo < 2 * width || !schedule_usable(i)) {
+            continue;
+        }
+
+        slope = schedule_slope(i);
+
+        if (i > 0 && schedule_usable(i - 1)) {
+            reference += schedule_slope(i - 1);
+            neighbours++;
+        }
+
+        if (i + 2 < schedule_num_points && schedule_usable(i + 1)) {
+            reference += schedule_slope(i + 1);
+            neighbours++;
+        }
+
+        if (!neighbours) {
+            continue;
+        }
+
+        deviation = fabs(slope - reference / neighbours);
+        if (deviation > best_deviation) {
+            best_deviation = deviation;
+            best = (lo + (hi - lo) / 2) / width * width;
+        }
+    }
+
+    if (best) {
+        schedule_points_left--;
+    }
+
+    return best;
+}
+
+static size_t schedule_step (size_t size, size_t width)
+{
+    struct size_schedule_t const * schedule = &options.schedule;
+    size_t end = options.max_message_size + 1;
+    size_t next;
+    int i;
+
+    switch (schedule->type) {
+        case SCHEDULE_LINEAR:
+            next = size + schedule->step;
+            break;
+        case SCHEDULE_LIST:
+            next = end;
+            for (i = 0; i < schedule->list_len; i++) {
+                size_t candidate = (schedule->list[i] + width - 1) / width *
+                    width;
+
+                if (candidate > size) {
+                    next = candidate;
+                    break;
+                }
+            }
+            break;
+        case SCHEDULE_ADAPTIVE:
+            if (!schedule_refining) {
+                next = size ? size * 2 : width;
+                if (next <= options.max_message_size) {
+                    return next;
+                }
+                schedule_refining = 1;
+            }
+
+            next = schedule_refine(width);
+            agree_message_size(&next);
+
+            return next ? next : end;
+        default:
+            next = ceil(size * schedule->factor);
+            break;
+    }
+
+    /* Round up to whole elements and always make progress */
+    next = (next + width - 1) / width * width;
+    if (next <= size) {
+        next = size + width;
+    }
+
+    return next > options.max_message_size ? end : next;
+}
+
+static size_t schedule_next (size_t size, size_t width)
+{
+    size_t next = schedule_step(size, width);
+
+    checkpoint_mark(size);
+    while (next <= options.max_message_size && checkpoint_skip(next)) {
+        next = schedule_step(next, width);
+    }
+
+    return next;
+}
+
+size_t next_message_size (size_t size)
+{
+    return schedule_next(size, 1);
+}
+
+size_t next_message_count (size_t count, size_t width)
+{
+    size_t next = schedule_next(count * width, width);
+
+    if (next > options.max_message_size) {
+        return options.max_message_size / width + 1;
+    }
+
+    return next / width;
+}
+
+long resident_memory_kb (void)
+{
+    FILE * fp = fopen("/proc/self/statm", "r");
+    long size, resident;
+
+    if (NULL == fp) {
+        return -1;
+    }
+
+    if (2 != fscanf(fp, "%ld %ld", &size, &resident)) {
+        resident = -1;
+    }
+
+    fclose(fp);
+
+    return resident < 0 ? -1 : resident * (getpagesize() / 1024);
+}
+
+long available_memory_kb (void)
+{
+    FILE * fp = fopen("/proc/meminfo", "r");
+    char line[256];
+    long kb = -1;
+
+    if (NULL == fp) {
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        if (1 == sscanf(line, "MemAvailable: %ld", &kb)) {
+            break;
+        }
+    }
+
+    fclose(fp);
+
+    return kb;
+}
+
+int process_memory_kb (long * rss, long * hwm)
+{
+    FILE * fp = fopen("/proc/self/status", "r");
+    char line[256];
+    int found = 0;
+
+    if (NULL == fp) {
+        return -1;
+    }
+
+    while (found != 3 && fgets(line, sizeof(line), fp)) {
+        if (1 == sscanf(line, "VmRSS: %ld", rss)) {
+            found |= 1;
+        } else if (1 == sscanf(line, "VmHWM: %ld", hwm)) {
+            found |= 2;
+        }
+    }
+
+    fclose(fp);
+
+    return found == 3 ? 0 : -1;
+}
+
+void fill_host_buffer (void * buffer, int data, size_t size)
+{
+#ifdef _OPENMP
+    long chunk, chunks = (size + FILL_CHUNK - 1) / FILL_CHUNK;
+
+    if (size >= FILL_PARALLEL_SIZE) {
+        #pragma omp parallel for schedule(static)
+        for (chunk = 0; chunk < chunks; chunk++) {
+            size_t offset = (size_t)chunk * FILL_CHUNK;
+
+            memset((char *)buffer + offset, data, MIN(FILL_CHUNK,
+                        size - offset));
+        }
+        return;
+    }
+#endif
+
+    memset(buffer, data, size);
+}
+
+void touch_host_buffer (void * buffer, size_t size)
+{
+    size_t page = getpagesize(), offset;
+    volatile char * p = buffer;
+#ifdef _OPENMP
+    long chunk, chunks = (size + FILL_CHUNK - 1) / FILL_CHUNK;
+
+    if (size >= FILL_PARALLEL_SIZE) {
+        #pragma omp parallel for schedule(static) private(offset)
+        for (chunk = 0; chunk < chunks; chunk++) {
+            size_t end = MIN(size, (size_t)(chunk + 1) * FILL_CHUNK);
+
+            for (offset = (size_t)chunk * FILL_CHUNK; offset < end;
+                    offset += page) {
+                p[offset] = 0;
+            }
+        }
+        return;
+    }
+#endif
+
+    for (offset = 0; offset < size; offset += page) {
+        p[offset] = 0;
+    }
+}
+
+static int set_dt_block_size (int value)
+{
+    if (value < 0 || value > MAX_DT_BLOCK_SIZE) {
+        return -1;
+    }
+
+    options.dt_block_size = value;
+
+    return 0;
+}
+
+static int set_dt_stride_size (int value)
+{
+    if (value < 0 || value > MAX_DT_STRIDE_SIZE) {
+        return -1;
+    }
+
+    options.dt_stride_size = value;
+
+    return 0;
+}
+
+static int set_dt_increase_size (int value)
+{
+    if (value < 0) {
+        return -1;
+    }
+
+    options.dt_increase_size = value;
+
+    return 0;
+}
+
+static int set_rma_pattern (char const * value)
+{
+    if (!strcmp(value, "pairs")) {
+        options.rma_pattern = RMA_PAIRS;
+    } else if (!strcmp(value, "fanout")) {
+        options.rma_pattern = RMA_FANOUT;
+    } else if (!strcmp(value, "fanin")) {
+        options.rma_pattern = RMA_FANIN;
+    } else if (!strcmp(value, "many")) {
+        options.rma_pattern = RMA_MANY;
+    } else {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int set_dt_layout (char const * value)
+{
+    if (!strcmp(value, "vector")) {
+        options.dt_layout = DT_VECTOR;
+    } else if (!strcmp(value, "indexed")) {
+        options.dt_layout = DT_INDEXED;
+    } else if (!strcmp(value, "subarray")) {
+        options.dt_layout = DT_SUBARRAY;
+    } else if (!strcmp(value, "struct")) {
+        options.dt_layout = DT_STRUCT;
+    } else {
+        return -1;
+    }
+
+    return 0;
+}
+
+void enable_accel_support (void)
+{
+    accel_enabled = (ACCEL_ENABLED &&
+            !(options.subtype == LAT_MT || options.subtype == LAT_MP ||
+              options.subtype == LAT_PART || options.subtype == MR_MT ||
+              options.subtype == REG_CACHE || options.subtype == CONTENTION ||
+              options.subtype == RMA_MR || options.subtype == ATTACH ||
+              options.subtype == WIN_SETUP || options.subtype == SHM_WIN ||
+              options.subtype == COMM_SETUP || options.subtype == NOISE ||
+              options.subtype == CONGESTION || options.subtype == MULTI_GROUP ||
+              options.subtype == COMM_SCALING || options.subtype == COLL_DT ||
+              options.subtype == TAG_MATCH || options.subtype == PROBE_MT ||
+              options.subtype == LARGE_COUNT || options.subtype == IO ||
+              options.subtype == MANAGED_MEM));
+}
+
+/*
+ * Parse DIST:US[:PARAM] of --arrival-skew, PARAM being the slow rank of
+ * "slow" (default the last rank) and the standard deviation of "gaussian"
+ * (default US / 4).  Returns 0 on success.
+ */
+static int process_skew (char const * arg)
+{
+    char dist[16];
+    double us, param = -1;
+    int n;
+
+    n = sscanf(arg, "%15[a-z]:%lf:%lf", dist, &us, &param);
+
+    if (2 > n || 0 >= us) {
+        return 1;
+    }
+
+    if (0 == strcmp(dist, "uniform") && 2 == n) {
+        options.skew = SKEW_UNIFORM;
+    } else if (0 == strcmp(dist, "slow")) {
+        options.skew = SKEW_SLOW;
+    } else if (0 == strcmp(dist, "gaussian")) {
+        options.skew = SKEW_GAUSSIAN;
+        param = 3 == n ? param : us / 4;
+    } else {
+        return 1;
+    }
+
+    if (3 == n && 0 > param) {
+        return 1;
+    }
+
+    options.skew_us = us;
+    options.skew_param = param;
+
+    return 0;
+}
+
+/*
+ * Parse DIST[:PARAM] of --counts, PARAM being the exponent of "zipf"
+ * (default 1), the destinations per rank of "sparse" (default 2) and the
+ * ranks per block of "block" (default 4).  Returns 0 on success.
+ */
+static int process_counts (char const * arg)
+{
+    char dist[16];
+    double param = -1;
+    int n;
+
+    n = sscanf(arg, "%15[a-z]:%lf", dist, &param);
+
+    if (1 > n || (2 == n && 0 > param)) {
+        return 1;
+    }
+
+    if (0 == strcmp(dist, "uniform") && 1 == n) {
+        options.count_dist = COUNTS_UNIFORM;
+    } else if (0 == strcmp(dist, "zipf")) {
+        options.count_dist = COUNTS_ZIPF;
+        param = 2 == n ? param : 1;
+    } else if (0 == strcmp(dist, "sparse") || 0 == strcmp(dist, "block")) {
+        options.count_dist = 's' == dist[0] ? COUNTS_SPARSE : COUNTS_BLOCK;
+        param = 2 == n ? param : (COUNTS_SPARSE == options.count_dist ? 2 : 4);
+
+        if (1 > param || param != (int)param) {
+            return 1;
+        }
+    } else {
+        return 1;
+    }
+
+    options.count_param = param;
+
+    return 0;
+}
+
+/*
+ * Parse K[:Z] of --outliers, K slowest ranks beyond a robust z-score of Z.
+ * Returns 0 on success.
+ */
+static int process_outliers (char const * arg)
+{
+    int top, n;
+    double z = DEF_OUTLIER_Z;
+    char end;
+
+    n = sscanf(arg, "%d:%lf%c", &top, &z, &end);
+
+    if (1 > n || 2 < n || 1 > top || 0.0 >= z) {
+        return 1;
+    }
+
+    options.outlier_top = top;
+    options.outlier_z = z;
+
+    return 0;
+}
+
+/*
+ * Parse SECONDS[:SLICE_MS] of --stream.  Returns 0 on success.
+ */
+static int process_stream (char const * arg)
+{
+    double seconds;
+    int slice_ms = DEF_STREAM_SLICE_MS, n;
+    char end;
+
+    n = sscanf(arg, "%lf:%d%c", &seconds, &slice_ms, &end);
+
+    if ((1 != n && 2 != n) || 0 >= seconds || 0 >= slice_ms ||
+            seconds * 1000 < slice_ms) {
+        return 1;
+    }
+
+    options.stream = STREAM_ON;
+    options.stream_seconds = seconds;
+    options.stream_slice_ms = slice_ms;
+
+    return 0;
+}
+
+/*
+ * Parse PATTERN[:RANKS[:SIZE]] of --background, RANKS defaulting to half of
+ * the ranks (-1 until the number of ranks is known) and SIZE to the default
+ * of PATTERN.  Returns 0 on success.
+ */
+static int process_background (char const * arg)
+{
+    char pattern[16];
+    int ranks = -1, n;
+    long size = 0;
+
+    n = sscanf(arg, "%15[a-z]:%d:%ld", pattern, &ranks, &size);
+
+    if (1 > n || (2 <= n && 1 > ranks) || (3 == n && 1 > size)) {
+        return 1;
+    }
+
+    if (0 == strcmp(pattern, "stream")) {
+        options.background = BACKGROUND_STREAM;
+        size = 3 == n ? size : BACKGROUND_STREAM_SIZE;
+    } else if (0 == strcmp(pattern, "alltoall")) {
+        options.background = BACKGROUND_ALLTOALL;
+        size = 3 == n ? size : BACKGROUND_ALLTOALL_SIZE;
+    } else {
+        return 1;
+    }
+
+    options.background_ranks = ranks;
+    options.background_size = size;
+
+    return 0;
+}
+
+int process_options (int argc, char *argv[])
+{
+    extern char * optarg;
+    extern int optind, optopt;
+
+    char const * optstring = NULL;
+    int c, ret = PO_OKAY;
+
+    int option_index = 0;
+
+    static struct option long_options[] = {
+            {"help",            no_argument,        0,  'h'},
+            {"version",         no_argument,        0,  'v'},
+            {"full",            no_argument,        0,  'f'},
+            {"message-size",    required_argument,  0,  'm'},
+            {"window-size",     required_argument,  0,  'W'},
+            {"num-test-calls",  required_argument,  0,  't'},
+            {"iterations",      required_argument,  0,  'i'},
+            {"warmup",          required_argument,  0,  'x'},
+            {"array-size",      required_argument,  0,  'a'},
+            {"sync-option",     required_argument,  0,  's'},
+            {"win-options",     required_argument,  0,  'w'},
+            {"mem-limit",       required_argument,  0,  'M'},
+            {"accelerator",     required_argument,  0,  'd'},
+            {"cuda-target",     required_argument,  0,  'r'},
+            {"print-rate",      required_argument,  0,  'R'},
+            {"num-pairs",       required_argument,  0,  'p'},
+            {"vary-window",     required_argument,  0,  'V'},
+            {"dt-block-size",   required_argument,  0,  'B'},
+            {"dt-stride-size",  required_argument,  0,  'S'},
+            {"dt-increase-size",required_argument,  0,  'I'},
+            {"dt-type",         required_argument,  0,  'Q'},
+            {"percentiles",     no_argument,        0,  'z'},
+            {"output-format",   required_argument,  0,  'F'},
+            {"size-schedule",   required_argument,  0,  'D'},
+            {"converge",        required_argument,  0,  'C'},
+            {"cache-mode",      required_argument,  0,  'c'},
+            {"pairing",         required_argument,  0,  'P'},
+            {"matrix-file",     required_argument,  0,  'o'},
+            {"outlier-threshold",required_argument, 0,  'T'},
+            {"hierarchical",    no_argument,        0,  'H'},
+            {"pipeline",        required_argument,  0,  'L'},
+            {"stencil",         required_argument,  0,  'E'},
+            {"datatype",        required_argument,  0,  'y'},
+            {"op",              required_argument,  0,  'O'},
+            {"partitions",      required_argument,  0,  'n'},
+            {"thread-comm",     required_argument,  0,  'e'},
+            {"cpu-bind",        required_argument,  0,  'b'},
+            {"mem-node",        required_argument,  0,  'N'},
+            {"allocator",       required_argument,  0,  'A'},
+            {"buffers",         required_argument,  0,  'k'},
+            {"churn",           required_argument,  0,  'u'},
+            {"slots",           required_argument,  0,  'l'},
+            {"rma-pattern",     required_argument,  0,  'X'},
+            {"in-flight",       required_argument,  0,  'q'},
+            {"backend",         required_argument,  0,  'G'},
+            {"gpu-select",      required_argument,  0,  'g'},
+            {"validate",        no_argument,        0,  'j'},
+            {"compute-kernel",  required_argument,  0,  'K'},
+            {"mem-footprint",   no_argument,        0,  'U'},
+            {"pvars",           required_argument,  0,  'Y'},
+            {"tune",            required_argument,  0,  'J'},
+            {"counters",        required_argument,  0,  'Z'},
+            {"timer",           required_argument,  0,  OPT_TIMER},
+            {"global-clock",    no_argument,        0,  OPT_GLOBAL_CLOCK},
+            {"back-to-back",    optional_argument,  0,  OPT_BACK_TO_BACK},
+            {"arrival-skew",    required_argument,  0,  OPT_ARRIVAL_SKEW},
+            {"background",      required_argument,  0,  OPT_BACKGROUND},
+            {"groups",          required_argument,  0,  OPT_GROUPS},
+            {"group-op",        required_argument,  0,  OPT_GROUP_OP},
+            {"wildcard",        required_argument,  0,  OPT_WILDCARD},
+            {"order",           required_argument,  0,  OPT_MATCH_ORDER},
+            {"send-mode",       required_argument,  0,  OPT_SEND_MODE},
+            {"large-count",     required_argument,  0,  OPT_LARGE_COUNT},
+            {"stream",          required_argument,  0,  OPT_STREAM},
+            {"child-mode",      required_argument,  0,  OPT_CHILD_MODE},
+            {"file-view",       required_argument,  0,  OPT_FILE_VIEW},
+            {"io-hints",        required_argument,  0,  OPT_IO_HINTS},
+            {"io-file",         required_argument,  0,  OPT_IO_FILE},
+            {"residency",       required_argument,  0,  OPT_RESIDENCY},
+            {"baseline",        required_argument,  0,  OPT_BASELINE},
+            {"tolerance",       required_argument,  0,  OPT_TOLERANCE},
+            {"fit",             no_argument,        0,  OPT_FIT},
+            {"counts",          required_argument,  0,  OPT_COUNTS},
+            {"checkpoint",      required_argument,  0,  OPT_CHECKPOINT},
+            {"outliers",        required_argument,  0,  OPT_OUTLIERS},
+            {"loop",            required_argument,  0,  OPT_LOOP},
+            {0, 0, 0, 0}
+    };
+
+    enable_accel_support();
+
+    if (options.bench == PT2PT && options.subtype == MATRIX) {
+        optstring = "+:hvm:x:i:W:F:o:T:b:N:A:";
+    } else if (options.bench == PT2PT && options.subtype == HALO) {
+        optstring = "+:hvm:M:x:i:F:D:b:N:A:E:";
+    } else if (options.bench == PT2PT) {
+        if (accel_enabled) {
+            if (options.subtype == BW) {
+                optstring = "+:x:i:t:m:d:W:hvF:D:b:N:A:c:g:jUY:J:Z:";
+            } else if (options.subtype == LAT_DT) {
+                optstring = "+:x:i:m:d:B:S:I:Q:hvF:D:b:N:A:g:";
+            } else if (options.subtype == GPU_PEER) {
+                optstring = "+:x:i:m:M:d:hvF:D:b:N:g:";
+            } else if (options.subtype == GPU_PIPELINE) {
+                optstring = "+:x:i:m:M:d:hvF:D:b:N:g:a:";
+            } else {
+                optstring = "+:x:i:m:d:hvF:D:P:b:N:A:g:jUY:Z:";
+            }
+        } else{
+            if (options.subtype == LAT_MT) {
+                optstring = "+:hvm:x:i:t:F:D:b:N:A:";
+            } else if (options.subtype == LAT_PART) {
+                optstring = "+:hvm:x:i:t:n:F:D:b:N:A:";
+            } else if (options.subtype == MR_MT) {
+                optstring = "+:hvfm:x:i:t:W:e:F:D:b:N:A:";
+            } else if (options.subtype == REG_CACHE) {
+                optstring = "+:hvm:M:x:i:W:k:u:F:D:b:N:A:";
+            } else if (options.subtype == LAT_MP) {
+                optstring = "+:hvm:x:i:t:F:D:b:N:A:";
+            } else if (options.subtype == LAT_DT) {
+                optstring = "+:hvm:x:i:B:S:I:Q:F:D:b:N:A:";
+            } else if (options.subtype == BW) {
+                optstring = "+:hvm:x:i:t:W:F:D:b:N:A:c:jUY:J:Z:";
+            } else if (options.subtype == TAG_MATCH) {
+                optstring = "+:hvm:x:i:F:";
+            } else if (options.subtype == PROBE_MT) {
+                optstring = "+:hvm:x:i:t:F:D:b:N:";
+            } else if (options.subtype == LARGE_COUNT) {
+                optstring = "+:hvm:x:i:W:F:D:";
+            } else if (options.subtype == MANAGED_MEM) {
+                optstring = "+:hvm:x:i:M:F:D:";
+            } else if (options.subtype == GPU_PEER ||
+                    options.subtype == GPU_PIPELINE) {
+                optstring = "+:hvm:M:x:i:F:D:b:N:";
+            } else {
+                optstring = "+:hvm:x:i:F:D:P:b:N:A:jUY:Z:";
+            }
+        }
+    } else if (options.bench == COLLECTIVE) {
+        if (options.subtype == COMM_SETUP) {
+            optstring = "+:hvi:x:F:";
+        } else if (options.subtype == NOISE) {
+            optstring = "+:hvi:x:F:T:";
+        } else if (options.subtype == LARGE_COUNT ||
+                options.subtype == IO) {
+            optstring = "+:hvm:i:x:F:D:";
+        } else if (options.subtype == CONGESTION ||
+                options.subtype == MULTI_GROUP ||
+                options.subtype == COMM_SCALING) {
+            optstring = "+:hvm:i:x:M:F:";
+        } else if (options.subtype == COLL_DT) {
+            optstring = "+:hvm:i:x:M:F:B:S:I:Q:";
+        } else if (options.subtype == MANAGED_MEM) {
+            optstring = "+:hvm:i:x:M:F:D:";
+        } else if (options.subtype == REDUCE_LOCAL) {
+            optstring = accel_enabled ? "+:d:hvm:i:x:M:F:D:y:O:A:g:" :
+                "+:hvm:i:x:M:F:D:y:O:A:";
+        } else if (options.subtype == LAT) { /* Blocking */
+            optstring = "+:hvfm:i:x:M:a:zF:D:C:c:Hy:O:A:L:E:UY:J:Z:";
+            if (accel_enabled) {
+                optstring = (GPU_KERNEL_ENABLED) ? "+:d:hvfm:i:x:M:r:a:zF:D:C:c:Hy:O:A:G:g:L:E:UY:J:Z:" : "+:d:hvfm:i:x:M:a:zF:D:C:c:Hy:O:A:G:g:L:E:UY:J:Z:";
+            }
+        } else { /* Non-Blocking */
+            optstring = "+:hvfm:i:x:M:t:a:F:D:y:O:A:K:W:E:";
+            if (accel_enabled) {
+                optstring = (GPU_KERNEL_ENABLED) ? "+:d:hvfm:i:x:M:t:r:a:F:D:y:O:A:g:K:W:E:" : "+:d:hvfm:i:x:M:t:a:F:D:y:O:A:g:K:W:E:";
+            }
+        }
+    } else if (options.bench == ONE_SIDED) {
+        if (options.subtype == CONTENTION) {
+            optstring = "+:w:s:hvx:i:t:l:F:";
+        } else if (options.subtype == RMA_MR) {
+            optstring = "+:w:s:hvm:x:i:W:X:F:D:";
+        } else if (options.subtype == ATTACH) {
+            optstring = "+:hvm:x:i:k:M:F:D:";
+        } else if (options.subtype == WIN_SETUP) {
+            optstring = "+:w:s:hvm:x:i:M:F:D:";
+        } else if (options.subtype == SHM_WIN) {
+            optstring = "+:hvm:x:i:W:M:b:N:F:D:";
+        } else if(options.subtype == BW) {
+            optstring = (accel_enabled) ? "+:w:s:hvm:d:x:i:W:F:D:g:q:" : "+:w:s:hvm:x:i:W:F:D:q:";
+        } else {
+            optstring = (accel_enabled) ? "+:w:s:hvm:d:x:i:F:D:g:q:" : "+:w:s:hvm:x:i:F:D:q:";
+        }
+        
+    } else if (options.bench == MBW_MR){
+        optstring = (accel_enabled) ? "p:W:R:x:i:m:d:VhvF:D:P:b:N:A:g:" : "p:W:R:x:i:m:VhvF:D:P:b:N:A:";
+    } else if (options.bench == OSHM || options.bench == UPC || options.bench == UPCXX) {
+        if (options.subtype == PGAS_LAT || options.subtype == PGAS_MR) {
+            optstring = ":hvm:i:x:M:";
+        } else if (options.subtype == PGAS_NBC) {
+            optstring = ":hvfm:i:x:M:t:K:";
+        } else if (options.subtype == PGAS_MR_WINDOW ||
+                options.subtype == PGAS_BW) {
+            optstring = ":hvm:i:x:M:W:V";
+        } else if (options.subtype == PGAS_PROGRESS) {
+            optstring = ":hvi:x:K:t:";
+        } else if (options.subtype == PGAS_COMPARE) {
+            optstring = ":hvm:i:x:M:W:F:";
+        } else if (options.subtype == PGAS_DEVICE) {
+            optstring = ":hvm:i:x:M:W:";
+        } else if (PGAS_SYNC_NONE != options.sync_in) {
+            optstring = ":hvfm:i:x:M:F:s:W:";
+        } else {
+            optstring = ":hvfm:i:x:M:F:";
+        }
+    } else {
+        fprintf(stderr,"Invalid benchmark type");
+        exit(1);
+    }
+
+    /* Set default options*/
+    options.accel = NONE;
+    options.show_size = 1;
+    options.show_full = 0;
+    options.num_probes = 0;
+    options.nodes_per_switch = 0;
+    options.show_locality = 0;
+    options.show_loop = 0;
+    options.progress_thread = 0;
+    options.device_array_size = 32;
+    options.target = CPU;
+    options.min_message_size = MIN_MESSAGE_SIZE;
+    options.dt_block_size = MIN_MESSAGE_SIZE;
+    options.dt_stride_size = MIN_MESSAGE_SIZE;
+    options.dt_increase_size = 0;
+    options.dt_layout = DT_AUTO;
+    if (COLL_DT == options.subtype) {
+        options.dt_block_size = DEF_COLL_DT_BLOCK_SIZE;
+        options.dt_stride_size = DEF_COLL_DT_STRIDE_SIZE;
+    }
+    options.show_percentiles = 0;
+    options.output_format = OUTPUT_TABLE;
+    options.schedule.type = SCHEDULE_GEOMETRIC;
+    options.schedule.factor = 2.0;
+    options.schedule.list_len = 0;
+    options.schedule.max_points = DEF_ADAPTIVE_POINTS;
+    options.schedule.threshold = DEF_ADAPTIVE_THRESHOLD;
+    options.converge.target = 0.0;
+    options.converge.budget = DEF_CONVERGE_BUDGET;
+    options.cache_mode = CACHE_HOT;
+    options.cache_pool_size = DEF_CACHE_POOL_SIZE;
+    options.compute_kernel = KERNEL_DUMMY;
+    options.compute_size = 0;
+    options.compute_omp = 0;
+    options.op = OP_SUM;
+    options.num_bind_cpus = 0;
+    options.mem_node = -1;
+    options.allocator = ALLOC_DEFAULT;
+    options.gpu_select = GPU_SELECT_RANK;
+    options.num_gpu_list = 0;
+    options.gpu_nic[0] = '\0';
+    options.matrix_file = NULL;
+    options.outlier_threshold = DEF_OUTLIER_THRESHOLD;
+    options.baseline = NULL;
+    options.tolerance = DEF_BASELINE_TOLERANCE;
+    options.fit = 0;
+    options.checkpoint = NULL;
+    options.outlier_top = 0;
+    options.outlier_z = DEF_OUTLIER_Z;
+    if (options.bench == COLLECTIVE) {
+        options.max_message_size = MAX_MSG_SIZE_COLL;
+    } else {
+        options.max_message_size = MAX_MESSAGE_SIZE;
+    }
+    options.max_mem_limit = MAX_MEM_LIMIT;
+    options.window_size_large = WINDOW_SIZE_LARGE;
+    options.window_size = WINDOW_SIZE_LARGE;
+    options.window_varied = 0;
+    options.pgas_chain = 1;
+    options.print_rate = 1;
+
+    options.src = 'H';
+    options.dst = 'H';
+
+    switch (options.subtype) {
+        case BW:
+        case RMA_MR:
+        case SHM_WIN:
+            options.iterations = BW_LOOP_SMALL;
+            options.skip = BW_SKIP_SMALL;
+            options.iterations_large = BW_LOOP_LARGE;
+            options.skip_large = BW_SKIP_LARGE;
+            break;
+        case LAT_MT:
+            options.num_threads = DEF_NUM_THREADS;
+            options.min_message_size = 0;
+            options.sender_thread=-1;
+        case LAT_MP:
+            options.num_processes = DEF_NUM_PROCESSES;
+            options.min_message_size = 0;
+            options.sender_processes = DEF_NUM_PROCESSES;
+        case LAT:
+        case NBC:
+        case PERSISTENT:
+        case HALO:
+        case CONGESTION:
+        case MULTI_GROUP:
+        case COMM_SCALING:
+        case COLL_DT:
+        case REDUCE_LOCAL:
+        case MANAGED_MEM:
+        case GPU_PEER:
+            if (options.bench == COLLECTIVE || options.subtype == HALO) {
+                options.iterations = COLL_LOOP_SMALL;
+                options.skip = COLL_SKIP_SMALL;
+                options.iterations_large = COLL_LOOP_LARGE;
+                options.skip_large = COLL_SKIP_LARGE;
+            } else {
+                options.iterations = LAT_LOOP_SMALL;
+                options.skip = LAT_SKIP_SMALL;
+                options.iterations_large = LAT_LOOP_LARGE;
+                options.skip_large = LAT_SKIP_LARGE;
+            }
+            if (options.bench == PT2PT && options.subtype != HALO) {
+                options.min_message_size = 0;
+            }
+            break;
+        case TAG_MATCH:
+            options.iterations = TAG_MATCH_LOOP;
+            options.skip = TAG_MATCH_SKIP;
+            options.iterations_large = TAG_MATCH_LOOP_LARGE;
+            options.skip_large = TAG_MATCH_SKIP_LARGE;
+            options.min_message_size = 0;
+            options.max_message_size = TAG_MATCH_MAX_DEPTH;
+            break;
+        case LARGE_COUNT:
+            options.iterations = LARGE_COUNT_LOOP;
+            options.skip = LARGE_COUNT_SKIP;
+            options.iterations_large = LARGE_COUNT_LOOP;
+            options.skip_large = LARGE_COUNT_SKIP;
+            options.min_message_size = LARGE_COUNT_MIN_SIZE;
+            options.max_message_size = LARGE_COUNT_MAX_SIZE;
+            options.window_size = LARGE_COUNT_WINDOW;
+            break;
+        case IO:
+            options.iterations = IO_LOOP;
+            options.skip = IO_SKIP;
+            options.iterations_large = IO_LOOP;
+            options.skip_large = IO_SKIP;
+            options.min_message_size = IO_MIN_SIZE;
+            options.max_message_size = IO_MAX_SIZE;
+            break;
+        case PROBE_MT:
+            options.iterations = LAT_LOOP_SMALL;
+            options.skip = LAT_SKIP_SMALL;
+            options.iterations_large = LAT_LOOP_LARGE;
+            options.skip_large = LAT_SKIP_LARGE;
+            options.min_message_size = 0;
+            options.num_threads = DEF_PROBE_THREADS;
+            break;
+        case MR_MT:
+            options.iterations = BW_LOOP_SMALL;
+            options.skip = BW_SKIP_SMALL;
+            options.iterations_large = BW_LOOP_LARGE;
+            options.skip_large = BW_SKIP_LARGE;
+            options.num_threads = DEF_MR_THREADS;
+            options.thread_comm = THREAD_COMM_PRIVATE;
+            options.thread_comms = 0;
+            break;
+        case GPU_PIPELINE:
+            options.iterations = BW_LOOP_SMALL;
+            options.skip = BW_SKIP_SMALL;
+            options.iterations_large = BW_LOOP_LARGE;
             options.skip_large = BW_SKIP_LARGE;
+            options.min_message_size = PIPELINE_MIN_SIZE;
+            options.device_array_size = DEVICE_LOAD_ARRAY_SIZE;
+            break;
+        case REG_CACHE:
+            options.iterations = BW_LOOP_SMALL;
+            options.skip = BW_SKIP_SMALL;
+            options.iterations_large = BW_LOOP_LARGE;
+            options.skip_large = BW_SKIP_LARGE;
+            options.max_message_size = REGCACHE_MAX_MESSAGE_SIZE;
+            options.num_buffers = DEF_REGCACHE_BUFFERS;
+            options.buffer_churn = 0;
+            break;
+        case LAT_PART:
+            options.iterations = PART_LOOP_SMALL;
+            options.skip = PART_SKIP_SMALL;
+            options.iterations_large = PART_LOOP_LARGE;
+            options.skip_large = PART_SKIP_LARGE;
+            options.min_message_size = PART_MIN_MESSAGE_SIZE;
+            options.num_threads = DEF_PART_THREADS;
+            options.num_partitions = DEF_NUM_PARTITIONS;
+            break;
+        case MATRIX:
+            /* -m MIN:MAX are the latency and the bandwidth message size */
+            options.iterations = MATRIX_LOOP_LAT;
+            options.skip = MATRIX_SKIP_LAT;
+            options.iterations_large = MATRIX_LOOP_BW;
+            options.skip_large = MATRIX_SKIP_BW;
+            options.min_message_size = MATRIX_LAT_SIZE;
+            options.max_message_size = MATRIX_BW_SIZE;
+            options.window_size = MATRIX_WINDOW_SIZE;
+            break;
+        case CONTENTION:
+            options.iterations = LAT_LOOP_SMALL;
+            options.skip = LAT_SKIP_SMALL;
+            options.iterations_large = LAT_LOOP_LARGE;
+            options.skip_large = LAT_SKIP_LARGE;
+            options.rma_origins = 0;
+            options.rma_slots = DEF_RMA_SLOTS;
+            break;
+        case ATTACH:
+            options.iterations = ATTACH_LOOP_SMALL;
+            options.skip = ATTACH_SKIP_SMALL;
+            options.iterations_large = ATTACH_LOOP_LARGE;
+            options.skip_large = ATTACH_SKIP_LARGE;
+            options.max_message_size = ATTACH_MAX_MESSAGE_SIZE;
+            options.num_buffers = DEF_ATTACH_REGIONS;
+            break;
+        case COMM_SETUP:
+            options.iterations = COMM_SETUP_COUNT;
+            options.skip = COMM_SETUP_SKIP;
+            options.iterations_large = COMM_SETUP_COUNT;
+            options.skip_large = COMM_SETUP_SKIP;
+            break;
+        case NOISE:
+            options.iterations = NOISE_QUANTA;
+            options.skip = NOISE_SKIP;
+            options.iterations_large = NOISE_QUANTA;
+            options.skip_large = NOISE_SKIP;
+            break;
+        case WIN_SETUP:
+            options.iterations = WIN_SETUP_LOOP;
+            options.skip = WIN_SETUP_SKIP;
+            options.iterations_large = WIN_SETUP_LOOP;
+            options.skip_large = WIN_SETUP_SKIP;
+            break;
+        case LAT_DT:
+            options.iterations = LAT_DT_LOOP_SMALL;
+            options.skip = LAT_DT_SKIP_SMALL;
+            options.iterations_large = LAT_DT_LOOP_LARGE;
+            options.skip_large = LAT_DT_SKIP_LARGE;
+            break;
+        default:
+            break;
+    }
+
+    switch (options.bench) {
+        case UPCXX:
+        case UPC:
+            options.show_size = 0;
+        case OSHM:
+            if (PGAS_LAT == options.subtype || PGAS_NBC == options.subtype ||
+                    PGAS_PROGRESS == options.subtype) {
+                options.iterations = PGAS_LAT_LOOP_SMALL;
+                options.skip = PGAS_LAT_SKIP_SMALL;
+                options.iterations_large = PGAS_LAT_LOOP_LARGE;
+                options.skip_large = PGAS_LAT_SKIP_LARGE;
+                options.max_message_size = OSHM == options.bench ?
+                    MAX_MSG_SIZE_PT2PT : MAX_MESSAGE_SIZE;
+            } else if (PGAS_MR == options.subtype) {
+                options.iterations = OSHM_LOOP_SMALL_MR;
+                options.skip = 0;
+                options.iterations_large = OSHM_LOOP_LARGE_MR;
+                options.skip_large = 0;
+                options.max_message_size = MAX_MESSAGE_SIZE;
+            } else if (PGAS_BW == options.subtype ||
+                    PGAS_DEVICE == options.subtype) {
+                options.iterations = BW_LOOP_SMALL;
+                options.skip = BW_SKIP_SMALL;
+                options.iterations_large = BW_LOOP_LARGE;
+                options.skip_large = BW_SKIP_LARGE;
+                options.max_message_size = MAX_MESSAGE_SIZE;
+            } else if (PGAS_MR_WINDOW == options.subtype) {
+                options.iterations = OSHM_LOOP_SMALL_MR;
+                options.skip = PGAS_MR_WINDOW_SKIP;
+                options.iterations_large = OSHM_LOOP_LARGE_MR;
+                options.skip_large = PGAS_MR_WINDOW_SKIP;
+                options.max_message_size = LARGE_MESSAGE_SIZE;
+            } else {
+                options.iterations = OSHM_LOOP_SMALL;
+                options.skip = OSHM_SKIP_SMALL;
+                options.iterations_large = OSHM_LOOP_LARGE;
+                options.skip_large = OSHM_SKIP_LARGE;
+                options.max_message_size = 1<<20;
+            }
+            break;
+        default:
+            break;
+    }
+
+    /* Every option given goes into the configuration --checkpoint keys on */
+    checkpoint_config_add(0, NULL);
+    while ((c = getopt_long(argc, argv, optstring, long_options, &option_index)) != -1) {
+        bad_usage.opt = c;
+        bad_usage.optarg = NULL;
+        bad_usage.message = NULL;
+        checkpoint_config_add(c, optarg);
+
+        switch(c) {
+            case 'h':
+                return PO_HELP_MESSAGE;
+            case 'v':
+                return PO_VERSION_MESSAGE;
+            case 'm':
+                if (set_message_size(optarg)) {
+                    bad_usage.message = "Invalid Message Size";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 't':
+                if (options.bench == COLLECTIVE &&
+                        0 == strcasecmp(optarg, "thread")) {
+                    options.progress_thread = 1;
+                    options.num_probes = 0;
+                } else if (options.bench == COLLECTIVE) {
+                    options.progress_thread = 0;
+                    if (set_num_probes(atoi(optarg))){
+                        bad_usage.message = "Invalid Number of Probes";
+                        bad_usage.optarg = optarg;
+
+                        return PO_BAD_USAGE;
+                    }
+                } else if (options.subtype == PGAS_NBC) {
+                    if (set_num_probes(atoi(optarg))){
+                        bad_usage.message = "Invalid Number of Probes";
+                        bad_usage.optarg = optarg;
+
+                        return PO_BAD_USAGE;
+                    }
+                } else if (options.subtype == PGAS_PROGRESS) {
+                    if (strcasecmp(optarg, "thread")) {
+                        bad_usage.message = "Invalid Progress Mode";
+                        bad_usage.optarg = optarg;
+
+                        return PO_BAD_USAGE;
+                    }
+                    options.progress_thread = 1;
+                } else if (options.bench == PT2PT) {
+                    if (options.subtype == LAT_MT) {
+                        if (set_threads(optarg)){
+                            bad_usage.message = "Invalid Number of Threads";
+                            bad_usage.optarg = optarg;
+
+                            return PO_BAD_USAGE;
+                        }
+                    } else if (options.subtype == LAT_PART ||
+                            options.subtype == MR_MT ||
+                            options.subtype == PROBE_MT) {
+                        options.num_threads = atoi(optarg);
+                        if (MIN_NUM_THREADS > options.num_threads ||
+                                options.num_threads > MAX_NUM_THREADS) {
+                            bad_usage.message = "Invalid Number of Threads";
+                            bad_usage.optarg = optarg;
+
+                            return PO_BAD_USAGE;
+                        }
+                    } else if (options.subtype == LAT_MP) {
+                        if (set_processes(optarg)){
+                            bad_usage.message = "Invalid Number of Processes";
+                            bad_usage.optarg = optarg;
+
+                            return PO_BAD_USAGE;
+                        } 
+                    }
+                } else if (options.bench == ONE_SIDED &&
+                        options.subtype == CONTENTION) {
+                    options.rma_origins = atoi(optarg);
+                    if (1 > options.rma_origins) {
+                        bad_usage.message = "Invalid Number of Origins";
+                        bad_usage.optarg = optarg;
+
+                        return PO_BAD_USAGE;
+                    }
+                }
+                break;
+            case 'i':
+                if (set_num_iterations(atoi(optarg))) {
+                    bad_usage.message = "Invalid Number of Iterations";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'x':
+                if (set_num_warmup(atoi(optarg))) {
+                    bad_usage.message = "Invalid Number of Warmup Iterations";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'R':
+                options.print_rate = atoi(optarg);
+                if (0 != options.print_rate && 1 != options.print_rate) {
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'W':
+                if (options.bench == COLLECTIVE) {
+                    if (NBC_WINDOW_NONE == options.nbc_window_mode) {
+                        bad_usage.message = "Benchmark Does Not Support "
+                                "Multiple Outstanding Collectives";
+
+                        return PO_BAD_USAGE;
+                    }
+                    if (set_nbc_window(optarg)) {
+                        bad_usage.message = "Invalid Collective Window";
+                        bad_usage.optarg = optarg;
+
+                        return PO_BAD_USAGE;
+                    }
+                } else if (PGAS_SYNC_NONE != options.sync_in) {
+                    options.pgas_chain = atoi(optarg);
+                    if (1 > options.pgas_chain ||
+                            MAX_PGAS_CHAIN < options.pgas_chain) {
+                        bad_usage.message = "Invalid Collective Chain";
+                        bad_usage.optarg = optarg;
+
+                        return PO_BAD_USAGE;
+                    }
+                } else if (set_window_size(atoi(optarg))) {
+                    bad_usage.message = "Invalid Window Size";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'V':
+                options.window_varied = 1;
+                break;
+            case 'p':
+                options.pairs = atoi(optarg);
+                break;
+            case 'a':
+                if (set_device_array_size(atoi(optarg))){
+                    bad_usage.message = "Invalid Device Array Size";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'f':
+                options.show_full = 1;
+                break;
+            case 'F':
+                if (set_output_format(optarg)) {
+                    bad_usage.message = "Invalid Output Format";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'D':
+                if (options.bench == OSHM || options.bench == UPC ||
+                        options.bench == UPCXX) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                        "Size Schedules";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                if (set_size_schedule(optarg)) {
+                    bad_usage.message = "Invalid Size Schedule";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                if (SCHEDULE_ADAPTIVE == options.schedule.type &&
+                        (LAT_MT == options.subtype || LAT_MP == options.subtype ||
+                         LAT_PART == options.subtype || MR_MT == options.subtype ||
+                         REG_CACHE == options.subtype ||
+                         PROBE_MT == options.subtype)) {
+                    bad_usage.message = "Adaptive Size Schedule Not Supported "
+                        "By Multi-threaded/Multi-process Benchmarks";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'z':
+                options.show_percentiles = 1;
+                hist_reset(&latency_hist);
+                break;
+            case 'C':
+                if (options.bench != COLLECTIVE || options.subtype != LAT) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Convergence Mode";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                } else if (set_convergence(optarg)) {
+                    bad_usage.message = "Invalid Convergence Target";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'o':
+            case 'T':
+                if (options.subtype != MATRIX &&
+                        !(options.subtype == NOISE && 'T' == c)) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Matrix Options";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                } else if ('o' == c) {
+                    options.matrix_file = optarg;
+                } else if (0.0 >= (options.outlier_threshold = atof(optarg))) {
+                    bad_usage.message = "Invalid Outlier Threshold";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'P':
+                if (PAIRING_NONE == options.pairing) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Pairing Patterns";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                } else if (set_pairing(optarg)) {
+                    bad_usage.message = "Invalid Pairing Pattern";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                options.show_locality = 1;
+                break;
+            case 'y':
+            case 'O':
+                if (DTYPE_NONE == options.dtype) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Datatype/Operation Selection";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                } else if ('y' == c ? set_reduce_dtype(optarg) :
+                        set_reduce_op(optarg)) {
+                    bad_usage.message = ('y' == c) ? "Invalid Datatype" :
+                            "Invalid Operation";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'b':
+            case 'N':
+                if (options.bench != PT2PT && options.bench != MBW_MR &&
+                        options.subtype != SHM_WIN) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Affinity Options";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                if ('b' == c && set_bind_cpus(optarg)) {
+                    bad_usage.message = "Invalid CPU List";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                if ('N' == c) {
+                    options.mem_node = atoi(optarg);
+                    if (0 > options.mem_node || options.mem_node >= MAX_MEM_NODES) {
+                        bad_usage.message = "Invalid NUMA Node";
+                        bad_usage.optarg = optarg;
+
+                        return PO_BAD_USAGE;
+                    }
+                }
+                break;
+            case 'g':
+                if (!accel_enabled) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Accelerator Transfers";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                if (set_gpu_select(optarg)) {
+                    bad_usage.message = "Invalid GPU Selection Policy";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'e':
+                if (options.subtype != MR_MT) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Thread Communicator Mappings";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                if (set_thread_comm(optarg)) {
+                    bad_usage.message = "Invalid Thread Communicator Mapping";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'k':
+                if (options.subtype != REG_CACHE &&
+                        options.subtype != ATTACH) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Buffer Working Sets";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                options.num_buffers = atoi(optarg);
+                if (1 > options.num_buffers ||
+                        options.num_buffers > (options.subtype == ATTACH ?
+                            MAX_ATTACH_REGIONS : MAX_REGCACHE_BUFFERS)) {
+                    bad_usage.message = "Invalid Number of Buffers";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'u':
+                if (options.subtype != REG_CACHE) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Buffer Churn";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                options.buffer_churn = atoi(optarg);
+                if (0 > options.buffer_churn) {
+                    bad_usage.message = "Invalid Buffer Churn Interval";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'n':
+                if (options.subtype != LAT_PART) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Partitions";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                options.num_partitions = atoi(optarg);
+                if (1 > options.num_partitions ||
+                        options.num_partitions > MAX_NUM_PARTITIONS) {
+                    bad_usage.message = "Invalid Number of Partitions";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'l':
+                options.rma_slots = atoi(optarg);
+                if (1 > options.rma_slots ||
+                        options.rma_slots > MAX_RMA_SLOTS) {
+                    bad_usage.message = "Invalid Number of Slots";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'X':
+                if (RMA_PATTERN_NONE == options.rma_pattern) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "RMA Patterns";
+
+                    return PO_BAD_USAGE;
+                }
+                if (set_rma_pattern(optarg)) {
+                    bad_usage.message = "Invalid RMA Pattern";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'q':
+                if (0 == options.rma_inflight) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Request-Based RMA";
+
+                    return PO_BAD_USAGE;
+                }
+                options.rma_inflight = atoi(optarg);
+                if (1 > options.rma_inflight ||
+                        options.rma_inflight > MAX_RMA_INFLIGHT) {
+                    bad_usage.message = "Invalid Number of In-Flight Requests";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'G':
+                if (BACKEND_NONE == options.backend) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Collective Backends";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                if (0 == strcasecmp(optarg, "mpi")) {
+                    options.backend = BACKEND_MPI;
+                } else if (0 == strcasecmp(optarg, "nccl") ||
+                        0 == strcasecmp(optarg, "rccl")) {
+                    if (!NCCL_ENABLED) {
+                        bad_usage.message = "NCCL Support Not Enabled\n"
+                                "Please recompile benchmark with NCCL or RCCL support";
+                        bad_usage.optarg = optarg;
+
+                        return PO_BAD_USAGE;
+                    }
+                    options.backend = BACKEND_NCCL;
+                } else {
+                    bad_usage.message = "Invalid Collective Backend";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'H':
+                if (HIER_NONE == options.hierarchical) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Hierarchical Comparison";
+
+                    return PO_BAD_USAGE;
+                }
+                options.hierarchical = HIER_ON;
+                break;
+            case 'L':
+                if (PIPELINE_NONE == options.pipeline) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Pipelined Comparison";
+
+                    return PO_BAD_USAGE;
+                }
+                if (set_pipeline(optarg)) {
+                    bad_usage.message = "Invalid Pipeline Chunk or Depth";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'E':
+                if (STENCIL_NONE == options.stencil) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Stencils";
+
+                    return PO_BAD_USAGE;
+                }
+                if (set_stencil(optarg)) {
+                    bad_usage.message = "Invalid Stencil";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'K':
+                if ((options.bench != COLLECTIVE || (options.subtype != NBC &&
+                            options.subtype != PERSISTENT)) &&
+                        options.subtype != PGAS_NBC &&
+                        options.subtype != PGAS_PROGRESS) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Compute Kernels";
+
+                    return PO_BAD_USAGE;
+                }
+                if (set_compute_kernel(optarg)) {
+                    bad_usage.message = "Invalid Compute Kernel";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'j':
+                if (VALIDATE_NONE == options.validate) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Data Validation";
+
+                    return PO_BAD_USAGE;
+                }
+                options.validate = VALIDATE_ON;
+                break;
+            case 'U':
+                if (MEM_FOOTPRINT_NONE == options.mem_footprint) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Memory Footprint";
+
+                    return PO_BAD_USAGE;
+                }
+                options.mem_footprint = MEM_FOOTPRINT_ON;
+                break;
+            case 'Y':
+                if (PVARS_NONE == options.pvars) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "MPI_T Performance Variables";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                if (0 == strcmp(optarg, "list")) {
+                    options.pvars = PVARS_LIST;
+                } else {
+                    options.pvars = PVARS_ON;
+                    options.pvar_names = optarg;
+                }
+                break;
+            case 'J':
+                if (TUNE_NONE == options.tune) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "MPI_T Control Variable Tuning";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                options.tune = TUNE_ON;
+                options.tune_spec = optarg;
+                break;
+            case 'Z':
+                if (COUNTERS_NONE == options.counters) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Hardware Counters";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                options.counters = COUNTERS_ON;
+                options.counter_names = optarg;
+                break;
+            case OPT_ARRIVAL_SKEW:
+                if (SKEW_NONE == options.skew) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Arrival Skew";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                if (process_skew(optarg)) {
+                    bad_usage.message = "Invalid Arrival Skew";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case OPT_SEND_MODE:
+                if (SEND_MODE_NONE == options.send_mode) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Send Modes";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                if (set_send_mode(optarg)) {
+                    bad_usage.message = "Invalid Send Mode";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case OPT_LOOP:
+                if (LOOP_NONE == options.loop) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Loop Selection";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                options.show_loop = 1;
+                if (0 == strcmp(optarg, "auto")) {
+                    options.loop = LOOP_AUTO;
+                } else if (0 == strcmp(optarg, "generic")) {
+                    options.loop = LOOP_GENERIC;
+                } else if (0 == strcmp(optarg, "fast")) {
+                    options.loop = LOOP_FAST;
+                } else if (0 == strcmp(optarg, "null")) {
+                    options.loop = LOOP_NULL;
+                } else {
+                    bad_usage.message = "Invalid Loop";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case OPT_LARGE_COUNT:
+                if (LARGE_COUNT_NONE == options.large_count) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Large Counts";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                if (0 == strcasecmp(optarg, "c")) {
+                    options.large_count = LARGE_COUNT_C;
+                } else if (0 == strcasecmp(optarg, "datatype")) {
+                    options.large_count = LARGE_COUNT_DATATYPE;
+                } else {
+                    bad_usage.message = "Invalid Large Count Method";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case OPT_STREAM:
+                if (STREAM_NONE == options.stream) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Streaming";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                if (process_stream(optarg)) {
+                    bad_usage.message = "Invalid Stream Duration";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case OPT_CHILD_MODE:
+                if (CHILD_MODE_NONE == options.child_mode) {
+                    bad_usage.message = "Benchmark Does Not Fork Children";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                if (set_child_mode(optarg)) {
+                    bad_usage.message = "Invalid Child Mode";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case OPT_FILE_VIEW:
+            case OPT_IO_HINTS:
+            case OPT_IO_FILE:
+                if (FILE_VIEW_NONE == options.file_view) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "MPI-IO Options";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                if (OPT_IO_FILE == c) {
+                    options.io_file = optarg;
+                } else if (OPT_IO_HINTS == c) {
+                    if (check_io_hints(optarg)) {
+                        bad_usage.message = "Invalid MPI-IO Hints";
+                        bad_usage.optarg = optarg;
+
+                        return PO_BAD_USAGE;
+                    }
+                    options.io_hints = optarg;
+                } else if (0 == strcasecmp(optarg, "contiguous")) {
+                    options.file_view = FILE_VIEW_CONTIGUOUS;
+                } else if (0 == strcasecmp(optarg, "strided")) {
+                    options.file_view = FILE_VIEW_STRIDED;
+                } else {
+                    bad_usage.message = "Invalid File View";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case OPT_RESIDENCY:
+                if (RESIDENCY_MASK_NONE == options.residency) {
+                    bad_usage.message = "Benchmark Does Not Use Managed "
+                            "Memory";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                if (set_residency(optarg)) {
+                    bad_usage.message = "Invalid Residency";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case OPT_WILDCARD:
+            case OPT_MATCH_ORDER:
+                if (TAG_WILDCARD_NONE == options.wildcard) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Tag Matching Options";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                if (OPT_MATCH_ORDER == c && 0 == strcasecmp(optarg, "head")) {
+                    options.match_order = MATCH_ORDER_HEAD;
+                } else if (OPT_MATCH_ORDER == c &&
+                        0 == strcasecmp(optarg, "tail")) {
+                    options.match_order = MATCH_ORDER_TAIL;
+                } else if (OPT_MATCH_ORDER == c || set_wildcard(optarg)) {
+                    bad_usage.message = OPT_MATCH_ORDER == c ?
+                        "Invalid Match Order" : "Invalid Wildcard";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case OPT_GROUPS:
+            case OPT_GROUP_OP:
+                if (GROUP_OP_NONE == options.group_op) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Concurrent Groups";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                /* osu_comm_scaling picks its own communicators */
+                if (OPT_GROUPS == c && COMM_SCALING == options.subtype) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Group Counts";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                if (OPT_GROUPS == c ? set_groups(optarg) :
+                        set_group_op(optarg)) {
+                    bad_usage.message = OPT_GROUPS == c ?
+                        "Invalid Group Counts" : "Invalid Group Collective";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case OPT_BACKGROUND:
+                if (BACKGROUND_NONE == options.background) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Background Traffic";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                if (process_background(optarg)) {
+                    bad_usage.message = "Invalid Background Traffic";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case OPT_BACK_TO_BACK:
+                if (BACK_TO_BACK_NONE == options.back_to_back) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Back To Back Timing";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                options.back_to_back = BACK_TO_BACK_ON;
+                options.b2b_imbalance = 0;
+
+                if (optarg && (0 >= (options.b2b_imbalance = atof(optarg)))) {
+                    bad_usage.message = "Invalid Imbalance";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case OPT_GLOBAL_CLOCK:
+                if (GLOBAL_CLOCK_NONE == options.global_clock) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Global Clocks";
+
+                    return PO_BAD_USAGE;
+                }
+                options.global_clock = GLOBAL_CLOCK_ON;
+                break;
+            case OPT_TIMER:
+                if (0 == strcmp(optarg, "default")) {
+                    options.timer = TIMER_DEFAULT;
+                } else if (0 == strcmp(optarg, "gettimeofday")) {
+                    options.timer = TIMER_GETTIMEOFDAY;
+                } else if (0 == strcmp(optarg, "monotonic")) {
+                    options.timer = TIMER_MONOTONIC;
+                } else if (0 == strcmp(optarg, "cycles")) {
+                    options.timer = TIMER_CYCLES;
+                } else {
+                    bad_usage.message = "Invalid Timer";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                if (setup_timer()) {
+                    bad_usage.message = "Timer Not Available On This "
+                            "Platform";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case OPT_BASELINE:
+                if (load_baseline(optarg)) {
+                    bad_usage.message = "Cannot Read Baseline Results";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                options.baseline = optarg;
+                break;
+            case OPT_FIT:
+                options.fit = 1;
+                break;
+            case OPT_CHECKPOINT:
+                if (open_checkpoint(optarg)) {
+                    bad_usage.message = "Cannot Read Checkpoint";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                options.checkpoint = optarg;
+                break;
+            case OPT_OUTLIERS:
+                if (options.bench != COLLECTIVE || options.subtype != LAT) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Outlier Attribution";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                if (process_outliers(optarg)) {
+                    bad_usage.message = "Invalid Outlier Specification";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case OPT_COUNTS:
+                if (COUNTS_NONE == options.count_dist) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Count Distributions";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+
+                if (process_counts(optarg)) {
+                    bad_usage.message = "Invalid Count Distribution";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case OPT_TOLERANCE:
+                options.tolerance = atof(optarg);
+                if (0 > options.tolerance) {
+                    bad_usage.message = "Invalid Tolerance";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'A':
+                if (options.bench != PT2PT && options.bench != MBW_MR &&
+                        options.bench != COLLECTIVE) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Allocators";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                } else if (set_allocator(optarg)) {
+                    bad_usage.message = "Invalid Allocator";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'c':
+                if ((options.bench != COLLECTIVE || options.subtype != LAT) &&
+                        (options.bench != PT2PT || options.subtype != BW)) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Cache Modes";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                } else if (set_cache_mode(optarg)) {
+                    bad_usage.message = "Invalid Cache Mode";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'M':
+                /*
+                 * This function does not error but prints a warning message if
+                 * the value is too low.
+                 */
+                set_max_memlimit(atoll(optarg));
+                break;
+            case 'd':
+                if (!accel_enabled) {
+                    bad_usage.message = "Benchmark Does Not Support "
+                            "Accelerator Transfers";
+                    bad_usage.optarg = optarg;
+                    return PO_BAD_USAGE;
+                } else if (0 == strncasecmp(optarg, "cuda", 10)) {
+                    if (CUDA_ENABLED) {
+                        options.accel = CUDA;
+                    } else {
+                        bad_usage.message = "CUDA Support Not Enabled\n"
+                                "Please recompile benchmark with CUDA support";
+                        bad_usage.optarg = optarg;
+                        return PO_BAD_USAGE;
+                    }
+                } else if (0 == strncasecmp(optarg, "managed", 10)) {
+                    if (CUDA_ENABLED) {
+                        options.accel = MANAGED;
+                    } else {
+                        bad_usage.message = "CUDA Managed Memory Support Not Enabled\n"
+                                "Please recompile benchmark with CUDA support";
+                        bad_usage.optarg = optarg;
+                        return PO_BAD_USAGE;
+                    }
+                } else if (0 == strncasecmp(optarg, "openacc", 10)) {
+                    if (OPENACC_ENABLED) {
+                        options.accel = OPENACC;
+                    } else {
+                        bad_usage.message = "OpenACC Support Not Enabled\n"
+                                "Please recompile benchmark with OpenACC support";
+                        bad_usage.optarg = optarg;
+                        return PO_BAD_USAGE;
+                    }
+                } else if (0 == strncasecmp(optarg, "rocm", 10)) {
+                    if (ROCM_ENABLED) {
+                        options.accel = ROCM;
+                    } else {
+                        bad_usage.message = "ROCm Support Not Enabled\n"
+                                "Please recompile benchmark with ROCm support";
+                        bad_usage.optarg = optarg;
+                        return PO_BAD_USAGE;
+                    }
+                } else if (0 == strncasecmp(optarg, "sycl", 10)) {
+                    if (SYCL_ENABLED) {
+                        options.accel = SYCL;
+                    } else {
+                        bad_usage.message = "SYCL Support Not Enabled\n"
+                                "Please recompile benchmark with SYCL support";
+                        bad_usage.optarg = optarg;
+                        return PO_BAD_USAGE;
+                    }
+                } else {
+                    bad_usage.message = "Invalid Accel Type Specified";
+                    bad_usage.optarg = optarg;
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'r':
+                if (GPU_KERNEL_ENABLED) {
+                    if (0 == strncasecmp(optarg, "cpu", 10)) {
+                        options.target = CPU;
+                    } else if (0 == strncasecmp(optarg, "gpu", 10)) {
+                        options.target = GPU;
+                    } else if (0 == strncasecmp(optarg, "both", 10)) {
+                        options.target = BOTH;
+                    } else {
+                        bad_usage.message = "Please use cpu, gpu, or both";
+                        bad_usage.optarg = optarg;
+                        return PO_BAD_USAGE;
+                    }
+                } else {
+                    bad_usage.message = "GPU Kernel Support Not Enabled\n"
+                            "Please recompile benchmark with CUDA or ROCm Kernel support";
+                    bad_usage.optarg = optarg;
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'w':
+                ret = process_one_sided_options(c, optarg);
+                if (ret == PO_BAD_USAGE) {
+                    bad_usage.message = "Invalid option or invalid argument";
+                    bad_usage.opt = c;
+                    bad_usage.optarg = optarg;
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 's':
+                if (PGAS_SYNC_NONE != options.sync_in) {
+                    if (set_pgas_sync(optarg)) {
+                        bad_usage.message = "Invalid Synchronization Mode";
+                        bad_usage.optarg = optarg;
+
+                        return PO_BAD_USAGE;
+                    }
+                    break;
+                }
+                ret = process_one_sided_options(c, optarg);
+                if (ret == PO_BAD_USAGE) {
+                    bad_usage.message = "Invalid option or invalid argument";
+                    bad_usage.opt = c;
+                    bad_usage.optarg = optarg;
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'B':
+                if (set_dt_block_size(atoi(optarg))) {
+                    bad_usage.message = "Invalid block size";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'S':
+                if (set_dt_stride_size(atoi(optarg))) {
+                    bad_usage.message = "Invalid base stride size";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'I':
+                if (set_dt_increase_size(atoi(optarg))) {
+                    bad_usage.message = "Invalid increment stride size";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'Q':
+                if (set_dt_layout(optarg)) {
+                    bad_usage.message = "Invalid derived datatype";
+                    bad_usage.optarg = optarg;
+
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case ':':
+                bad_usage.message = "Option Missing Required Argument";
+                bad_usage.opt = optopt;
+                return PO_BAD_USAGE;
+            default:
+                bad_usage.message = "Invalid option";
+                bad_usage.opt = optopt;
+                return PO_BAD_USAGE;
+        }
+    }
+
+    /* An explicit size list overrides -m */
+    if (SCHEDULE_LIST == options.schedule.type) {
+        options.min_message_size = options.schedule.list[0];
+        options.max_message_size =
+            options.schedule.list[options.schedule.list_len - 1];
+    }
+
+    reset_message_sizes();
+
+    /*
+     * The memory operand follows the options, any further operands are left
+     * to the benchmark at argv[optind]
+     */
+    if (PGAS_MEMORY_NONE != options.pgas_memory) {
+        if (optind == argc) {
+            bad_usage.message = "Missing Memory Operand <heap|global>";
+
+            return PO_BAD_USAGE;
+        }
+
+        if (0 == strcmp(argv[optind], "heap")) {
+            options.pgas_memory = PGAS_MEMORY_HEAP;
+        } else if (0 == strcmp(argv[optind], "global")) {
+            options.pgas_memory = PGAS_MEMORY_GLOBAL;
+        } else {
+            bad_usage.message = "Invalid Memory Operand";
+            bad_usage.optarg = argv[optind];
+
+            return PO_BAD_USAGE;
+        }
+
+        optind++;
+    }
+
+    if (accel_enabled) {
+        if ((optind + 2) == argc) {
+            options.src = argv[optind][0];
+            options.dst = argv[optind + 1][0];
+            /* No need to check if '-d' is given */
+            if (NONE == options.accel) {
+                setAccel(options.src);
+                setAccel(options.dst);
+            }
+        } else if (optind != argc) {
+            return PO_BAD_USAGE;
+        }
+    }
+
+    /* The fast and null loops leave out everything but plain host messages */
+    if (LOOP_NONE != options.loop) {
+        int plain = NONE == options.accel && 'H' == options.src &&
+            'H' == options.dst && SEND_MODE_STANDARD == options.send_mode &&
+            GLOBAL_CLOCK_ON != options.global_clock;
+
+        if (LOOP_AUTO == options.loop) {
+            options.loop = plain ? LOOP_FAST : LOOP_GENERIC;
+        } else if (LOOP_GENERIC != options.loop && !plain) {
+            bad_usage.message = "Loop Requires Host Buffers, Standard Sends "
+                    "and No Global Clock";
+            bad_usage.opt = OPT_LOOP;
+            bad_usage.optarg = NULL;
+
+            return PO_BAD_USAGE;
+        }
+
+        if (LOOP_NULL == options.loop && VALIDATE_ON == options.validate) {
+            bad_usage.message = "Null Loop Sends No Data to Validate";
+            bad_usage.opt = OPT_LOOP;
+            bad_usage.optarg = NULL;
+
+            return PO_BAD_USAGE;
+        }
+    }
+
+    /*
+     * Vectors and subarrays have a constant stride, the growing stride of -I
+     * needs explicit displacements
+     */
+    if ((PT2PT == options.bench && LAT_DT == options.subtype) ||
+            COLL_DT == options.subtype) {
+        if (DT_AUTO == options.dt_layout) {
+            options.dt_layout = options.dt_increase_size ? DT_INDEXED
+                                                         : DT_VECTOR;
+        }
+
+        if (options.dt_increase_size && (DT_VECTOR == options.dt_layout ||
+                    DT_SUBARRAY == options.dt_layout)) {
+            bad_usage.message = "Increment Stride Requires an Indexed or "
+                    "Struct Datatype";
+            bad_usage.opt = 'I';
+
+            return PO_BAD_USAGE;
+        }
+    }
+
+    if (DTYPE_NONE != options.dtype) {
+        int pair_type = (DTYPE_FLOAT_INT <= options.dtype);
+        int loc_op = (OP_MAXLOC == options.op || OP_MINLOC == options.op);
+
+        if (pair_type != loc_op) {
+            bad_usage.message = "MAXLOC/MINLOC Require a Pair Datatype "
+                    "and Vice Versa";
+            bad_usage.opt = 'O';
+
+            return PO_BAD_USAGE;
+        }
+
+        /* The user function runs on the host */
+        if (OP_USER == options.op && NONE != options.accel) {
+            bad_usage.message = "User-defined Operation Requires Host Buffers";
+            bad_usage.opt = 'O';
+
+            return PO_BAD_USAGE;
+        }
+    }
+
+    /* NCCL takes device pointers and has no pair types or LOC operations */
+    if (BACKEND_NCCL == options.backend) {
+        if (NONE == options.accel || OPENACC == options.accel ||
+                SYCL == options.accel) {
+            bad_usage.message = "NCCL Backend Requires CUDA or ROCm Buffers";
+            bad_usage.opt = 'G';
+
+            return PO_BAD_USAGE;
+        }
+
+        if (DTYPE_FLOAT_INT == options.dtype ||
+                DTYPE_DOUBLE_INT == options.dtype ||
+                DTYPE_2INT == options.dtype || OP_MAXLOC == options.op ||
+                OP_MINLOC == options.op || OP_USER == options.op) {
+            bad_usage.message = "Datatype or Operation Not Supported By NCCL";
+            bad_usage.opt = 'G';
+
+            return PO_BAD_USAGE;
+        }
+    }
+
+    /* The node-level stages copy through host shared memory */
+    if (HIER_ON == options.hierarchical && NONE != options.accel) {
+        bad_usage.message = "Hierarchical Comparison Requires Host Buffers";
+        bad_usage.opt = 'H';
+
+        return PO_BAD_USAGE;
+    }
+
+    return PO_OKAY;
+}
+
+/* Set the initial accelerator type */
+int setAccel(char buf_type)
+{
+    switch (buf_type) {
+        case 'H':
+            break;
+        case 'D':
+        case 'M':
+            if (options.bench != PT2PT && options.bench != ONE_SIDED && options.bench != MBW_MR) {
+                bad_usage.opt = buf_type;
+                bad_usage.message = "This argument is only supported for one-sided and pt2pt benchmarks";
+                return PO_BAD_USAGE;
+            }
+            if (NONE == options.accel) {
+#if defined(_ENABLE_OPENACC_) && !defined(_ENABLE_CUDA_)
+                options.accel = OPENACC;
+#elif defined(_ENABLE_CUDA_)
+                options.accel = CUDA;
+#elif defined(_ENABLE_ROCM_)
+                options.accel = ROCM;
+#elif defined(_ENABLE_SYCL_)
+                options.accel = SYCL;
+#endif
+            }
+            break;
+        default:
+            return PO_BAD_USAGE;
+    }
+    return PO_OKAY;
+}
+
+
+double getMicrosecondTimeStamp()
+{
+    double retval;
+    struct timeval tv;
+
+    if (TIMER_DEFAULT != options.timer) {
+        return timer_now() * 1e6;
+    }
+
+    if (gettimeofday(&tv, NULL)) {
+        perror("gettimeofday");
+        abort();
+    }
+    retval = ((double)tv.tv_sec) * 1000000 + tv.tv_usec;
+    return retval;
+}
+
+/*
+ * Timers
+ */
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_CYCLE_COUNTER 1
+
+/* rdtscp waits for the instructions before it, unlike rdtsc */
+static inline uint64_t read_cycles (void)
+{
+    uint32_t lo, hi, aux;
+
+    __asm__ __volatile__ ("rdtscp" : "=a" (lo), "=d" (hi), "=c" (aux));
+
+    return ((uint64_t)hi << 32) | lo;
+}
+#elif defined(__aarch64__)
+#define HAVE_CYCLE_COUNTER 1
+
+static inline uint64_t read_cycles (void)
+{
+    uint64_t value;
+
+    __asm__ __volatile__ ("isb; mrs %0, cntvct_el0" : "=r" (value));
+
+    return value;
+}
+#endif
+
+#ifdef CLOCK_MONOTONIC_RAW
+#define TIMER_CLOCK CLOCK_MONOTONIC_RAW
+#else
+#define TIMER_CLOCK CLOCK_MONOTONIC
+#endif
+
+static double monotonic_now (void)
+{
+    struct timespec tp;
+
+    clock_gettime(TIMER_CLOCK, &tp);
+
+    return tp.tv_sec + tp.tv_nsec / 1e9;
+}
+
+double timer_now (void)
+{
+    struct timeval tv;
+
+    switch (options.timer) {
+        case TIMER_MONOTONIC:
+            return monotonic_now();
+#ifdef HAVE_CYCLE_COUNTER
+        case TIMER_CYCLES:
+            return read_cycles() / timer_info.cycles_per_sec;
+#endif
+        default:
+            /* Relative to the first call so that microseconds stay exact */
+            gettimeofday(&tv, NULL);
+            if (0 == timer_info.base_sec) {
+                timer_info.base_sec = tv.tv_sec;
+            }
+            return (tv.tv_sec - timer_info.base_sec) + tv.tv_usec / 1e6;
+    }
+}
+
+#define TIMER_CALIBRATION   0.02
+#define TIMER_SAMPLES       10000
+
+int setup_timer (void)
+{
+    double t, last, first, step;
+    int i;
+
+    if (TIMER_CYCLES == options.timer) {
+#if defined(__aarch64__)
+        uint64_t freq;
+
+        __asm__ __volatile__ ("mrs %0, cntfrq_el0" : "=r" (freq));
+        timer_info.cycles_per_sec = freq;
+#elif defined(HAVE_CYCLE_COUNTER)
+        /* The TSC has to be invariant, constant_tsc in /proc/cpuinfo */
+        uint64_t c_start = read_cycles();
+        double t_start = monotonic_now();
+
+        while (monotonic_now() - t_start < TIMER_CALIBRATION);
+        timer_info.cycles_per_sec = (read_cycles() - c_start) /
+            (monotonic_now() - t_start);
+#else
+        return -1;
+#endif
+    }
+
+    timer_info.resolution = 1e9;
+    first = last = timer_now();
+
+    for (i = 0; i < TIMER_SAMPLES; i++) {
+        t = timer_now();
+        step = t - last;
+
+        if (step > 0 && step < timer_info.resolution) {
+            timer_info.resolution = step;
+        }
+
+        last = t;
+    }
+
+    timer_info.overhead = (last - first) / TIMER_SAMPLES;
+
+    return 0;
+}
+
+void print_timer_summary (void)
+{
+    static char const * timer_name[] = {"default", "gettimeofday",
+        "monotonic", "cycles"};
+
+    if (TIMER_DEFAULT == options.timer ||
+            OUTPUT_TABLE != options.output_format) {
+        return;
+    }
+
+    fprintf(stdout, "# Timer: %s, resolution %.1f ns, overhead %.1f ns per "
+            "call\n", timer_name[options.timer], timer_info.resolution * 1e9,
+            timer_info.overhead * 1e9);
+    fflush(stdout);
+}
+
+static char const * accel_name (enum accel_type accel)
+{
+    switch (accel) {
+        case CUDA:
+            return "cuda";
+        case OPENACC:
+            return "openacc";
+        case MANAGED:
+            return "managed";
+        case ROCM:
+            return "rocm";
+        case SYCL:
+            return "sycl";
+        default:
+            return "none";
+    }
+}
+
+/*
+ * Benchmark title used to tag structured records: the name set with
+ * set_benchmark_name() if any, otherwise the header line without the leading
+ * "# " and the accelerator placeholder.
+ */
+static char const * output_benchmark_title (void)
+{
+    static char title[128];
+    size_t len;
+
+    /* Keep the two backends apart when their records are merged */
+    if (benchmark_name && BACKEND_NCCL == options.backend) {
+        snprintf(title, sizeof(title), "%s-nccl", benchmark_name);
+        return title;
+    }
+
+    if (benchmark_name) {
+        return benchmark_name;
+    }
+
+    if (NULL == benchmark_header) {
+        return "unknown";
+    }
+
+    snprintf(title, sizeof(title), benchmark_header, "");
+    len = strlen(title);
+    while (len && ('\n' == title[len - 1] || ' ' == title[len - 1])) {
+        title[--len] = '\0';
+    }
+
+    return ('#' == title[0] && ' ' == title[1]) ? title + 2 : title;
+}
+
+/* Integral metrics such as iteration counts are printed without decimals */
+static int metric_precision (double value)
+{
+    return (value == floor(value) && fabs(value) < 1e15) ? 0 : FLOAT_PRECISION;
+}
+
+static void output_csv (int nprocs, size_t size, int nmetrics,
+                        struct result_metric_t const * metrics)
+{
+    static char last_columns[1024] = "";
+    char columns[1024];
+    size_t len;
+    int i;
+
+    /* Print a new column header whenever the set of metrics changes */
+    len = snprintf(columns, sizeof(columns),
+            "benchmark,ranks,accel,src,dst,size");
+    for (i = 0; i < nmetrics && len < sizeof(columns); i++) {
+        len += snprintf(columns + len, sizeof(columns) - len, ",%s",
+                metrics[i].name);
+    }
+
+    if (strcmp(columns, last_columns)) {
+        fprintf(stdout, "%s\n", columns);
+        strcpy(last_columns, columns);
+    }
+
+    fprintf(stdout, "\"%s\",%d,%s,%c,%c,%zu", output_benchmark_title(), nprocs,
+            accel_name(options.accel), options.src, options.dst, size);
+    for (i = 0; i < nmetrics; i++) {
+        fprintf(stdout, ",%.*f", metric_precision(metrics[i].value),
+                metrics[i].value);
+    }
+    fprintf(stdout, "\n");
+}
+
+/* One -F json record, truncated to LEN bytes, tagged with CONFIG if given */
+static int format_json (char * buf, size_t len, char const * config,
+                        int nprocs, size_t size, int nmetrics,
+                        struct result_metric_t const * metrics)
+{
+    int n, i;
+
+    n = snprintf(buf, len, "{\"benchmark\": \"%s\", ",
+            output_benchmark_title());
+#ifdef PACKAGE_VERSION
+    n += snprintf(buf + n, len - MIN(len, (size_t)n), "\"version\": \"%s\", ",
+            PACKAGE_VERSION);
+#endif
+    if (config) {
+        n += snprintf(buf + n, len - MIN(len, (size_t)n),
+                "\"config\": \"%s\", ", config);
+    }
+    n += snprintf(buf + n, len - MIN(len, (size_t)n), "\"ranks\": %d, "
+            "\"accel\": \"%s\", \"src\": \"%c\", \"dst\": \"%c\", "
+            "\"size\": %zu", nprocs, accel_name(options.accel), options.src,
+            options.dst, size);
+    for (i = 0; i < nmetrics; i++) {
+        n += snprintf(buf + n, len - MIN(len, (size_t)n), ", \"%s\": %.*f",
+                metrics[i].name, metric_precision(metrics[i].value),
+                metrics[i].value);
+    }
+    n += snprintf(buf + n, len - MIN(len, (size_t)n), "}\n");
+
+    return n;
+}
+
+static void output_json (int nprocs, size_t size, int nmetrics,
+                         struct result_metric_t const * metrics)
+{
+    char line[4096];
+
+    format_json(line, sizeof(line), NULL, nprocs, size, nmetrics, metrics);
+    fputs(line, stdout);
+}
+
+void output_result (int nprocs, size_t size, int nmetrics,
+                    struct result_metric_t const * metrics)
+{
+    compare_baseline(nprocs, size, nmetrics, metrics);
+    checkpoint_result(nprocs, size, nmetrics, metrics);
+
+    switch (options.output_format) {
+        case OUTPUT_CSV:
+            output_csv(nprocs, size, nmetrics, metrics);
             break;
-        case LAT_MT:
-            options.num_threads = DEF_NUM_THREADS;
-            options.min_message_size = 0;
-            options.sender_thread=-1;
-        case LAT_MP:
-            options.num_processes = DEF_NUM_PROCESSES;
-            options.min_message_size = 0;
-            options.sender_processes = DEF_NUM_PROCESSES;
-        case LAT:
-        case NBC:
-            if (options.bench == COLLECTIVE) {
-                options.iterations = COLL_LOOP_SMALL;
-                options.skip = COLL_SKIP_SMALL;
-                options.iterations_large = COLL_LOOP_LARGE;
-                options.skip_large = COLL_SKIP_LARGE;
+        case OUTPUT_JSON:
+            output_json(nprocs, size, nmetrics, metrics);
+            break;
+        default:
+            fprintf(stdout, "%-*zu", 10, size);
+            for (int i = 0; i < nmetrics; i++) {
+                fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                        metrics[i].value);
+            }
+            fprintf(stdout, "\n");
+            break;
+    }
+
+    fflush(stdout);
+}
+
+/*
+ * Baseline Comparison
+ */
+#define BASELINE_MAX_METRICS 32
+
+struct baseline_record_t {
+    char benchmark[128];
+    int ranks;
+    char accel[16];
+    char src;
+    char dst;
+    size_t size;
+    int nmetrics;
+    char name[BASELINE_MAX_METRICS][64];
+    double value[BASELINE_MAX_METRICS];
+};
+
+static struct {
+    struct baseline_record_t * records;
+    int num;
+    int capacity;
+    int compared;
+    int regressions;
+    int reported;
+} baseline = {0};
+
+/*
+ * Reports left for the end of the run: the model fit of --fit and the
+ * baseline summary, whose regressions turn into the exit status
+ */
+static void results_atexit (void)
+{
+    print_model_fit();
+
+    if (!baseline.reported) {
+        return;
+    }
+
+    fprintf(stderr, "# Baseline: %d metrics compared, %d regressions beyond "
+            "%.1f%%\n", baseline.compared, baseline.regressions,
+            options.tolerance);
+
+    /* exit() has no way to change the status it was called with */
+    if (baseline.regressions) {
+        fflush(NULL);
+        _exit(EXIT_FAILURE);
+    }
+}
+
+static void watch_results (void)
+{
+    static int registered = 0;
+
+    if (!registered) {
+        registered = 1;
+        atexit(results_atexit);
+    }
+}
+
+static struct baseline_record_t * baseline_add (void)
+{
+    if (baseline.num == baseline.capacity) {
+        int capacity = baseline.capacity ? 2 * baseline.capacity : 64;
+        struct baseline_record_t * records = realloc(baseline.records,
+                capacity * sizeof(struct baseline_record_t));
+
+        if (NULL == records) {
+            return NULL;
+        }
+
+        baseline.records = records;
+        baseline.capacity = capacity;
+    }
+
+    memset(&baseline.records[baseline.num], 0,
+            sizeof(struct baseline_record_t));
+
+    return &baseline.records[baseline.num++];
+}
+
+/* Store field KEY of a result record, the unknown ones are metrics */
+static void baseline_set (struct baseline_record_t * record, char const * key,
+                          char const * value)
+{
+    if (0 == strcmp(key, "benchmark")) {
+        snprintf(record->benchmark, sizeof(record->benchmark), "%s", value);
+    } else if (0 == strcmp(key, "ranks")) {
+        record->ranks = atoi(value);
+    } else if (0 == strcmp(key, "accel")) {
+        snprintf(record->accel, sizeof(record->accel), "%s", value);
+    } else if (0 == strcmp(key, "src")) {
+        record->src = value[0];
+    } else if (0 == strcmp(key, "dst")) {
+        record->dst = value[0];
+    } else if (0 == strcmp(key, "size")) {
+        record->size = strtoull(value, NULL, 10);
+    } else if (strcmp(key, "version") &&
+            record->nmetrics < BASELINE_MAX_METRICS) {
+        snprintf(record->name[record->nmetrics], sizeof(record->name[0]),
+                "%s", key);
+        record->value[record->nmetrics++] = atof(value);
+    }
+}
+
+/* Next comma separated field of a CSV row, without its quotes */
+static char * csv_field (char ** cursor)
+{
+    char * field = *cursor, * end;
+
+    if (NULL == field) {
+        return NULL;
+    }
+
+    if ('"' == *field) {
+        end = strchr(++field, '"');
+        if (end) {
+            *end++ = '\0';
+        }
+        *cursor = (end && ',' == *end) ? end + 1 : NULL;
+
+        return field;
+    }
+
+    end = strchr(field, ',');
+    if (end) {
+        *end++ = '\0';
+    }
+    *cursor = end;
+
+    return field;
+}
+
+/* Next "key": value pair of a flat JSON object */
+static int json_pair (char ** cursor, char ** key, char ** value)
+{
+    char * p = strchr(*cursor, '"'), * end;
+
+    if (NULL == p || NULL == (end = strchr(++p, '"'))) {
+        return 0;
+    }
+
+    *key = p;
+    *end = '\0';
+
+    for (p = end + 1; ' ' == *p || ':' == *p; p++);
+
+    if ('"' == *p) {
+        if (NULL == (end = strchr(++p, '"'))) {
+            return 0;
+        }
+    } else {
+        end = p + strcspn(p, ",}");
+    }
+
+    *value = p;
+    *cursor = *end ? end + 1 : end;
+    *end = '\0';
+
+    return 1;
+}
+
+int load_baseline (char const * path)
+{
+    char line[4096], columns[4096] = "";
+    FILE * file = fopen(path, "r");
+
+    if (NULL == file) {
+        return -1;
+    }
+
+    /* osu_suite parses the options of every benchmark it runs */
+    baseline.num = 0;
+
+    while (fgets(line, sizeof(line), file)) {
+        struct baseline_record_t * record;
+        char * cursor = line, * key, * value;
+
+        line[strcspn(line, "\r\n")] = '\0';
+
+        if ('#' == line[0] || '\0' == line[0]) {
+            continue;
+        }
+
+        /* CSV column headers name the fields of the rows below them */
+        if (0 == strncmp(line, "benchmark,", strlen("benchmark,"))) {
+            strcpy(columns, line);
+            continue;
+        }
+
+        if (NULL == (record = baseline_add())) {
+            fclose(file);
+            return -1;
+        }
+
+        if ('{' == line[0]) {
+            while (json_pair(&cursor, &key, &value)) {
+                baseline_set(record, key, value);
+            }
+        } else if (columns[0]) {
+            char names[4096], * name_cursor = names;
+
+            strcpy(names, columns);
+            while (cursor && name_cursor) {
+                key = csv_field(&name_cursor);
+                baseline_set(record, key, csv_field(&cursor));
+            }
+        } else {
+            baseline.num--;
+        }
+    }
+
+    fclose(file);
+
+    return baseline.num ? 0 : -1;
+}
+
+/*
+ * 1 if higher values of the metric NAME are better, -1 if lower ones are and
+ * 0 if it does not measure performance
+ */
+static int metric_direction (char const * name)
+{
+    static char const * const higher[] = {"bps", "bandwidth", "bw", "rate",
+        "speedup", "mps", "per_sec", "overlap"};
+    static char const * const lower[] = {"latency", "slowdown", "loss"};
+    char lowered[64];
+    size_t len, i;
+
+    if (0 == strcmp(name, "stddev_us")) {
+        return 0;
+    }
+
+    for (len = 0; name[len] && len < sizeof(lowered) - 1; len++) {
+        lowered[len] = tolower((unsigned char)name[len]);
+    }
+    lowered[len] = '\0';
+
+    for (i = 0; i < sizeof(higher) / sizeof(higher[0]); i++) {
+        if (strstr(lowered, higher[i])) {
+            return 1;
+        }
+    }
+
+    for (i = 0; i < sizeof(lower) / sizeof(lower[0]); i++) {
+        if (strstr(lowered, lower[i])) {
+            return -1;
+        }
+    }
+
+    if ((len > 3 && 0 == strcmp(lowered + len - 3, "_us")) ||
+            (len > 3 && 0 == strcmp(lowered + len - 3, "_ms")) ||
+            (len > 2 && 0 == strcmp(lowered + len - 2, "_s"))) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static double metric_value (int nmetrics,
+                            struct result_metric_t const * metrics,
+                            char const * name)
+{
+    int i;
+
+    for (i = 0; i < nmetrics; i++) {
+        if (0 == strcmp(metrics[i].name, name)) {
+            return metrics[i].value;
+        }
+    }
+
+    return -1.0;
+}
+
+static double record_value (struct baseline_record_t const * record,
+                            char const * name)
+{
+    int i;
+
+    for (i = 0; i < record->nmetrics; i++) {
+        if (0 == strcmp(record->name[i], name)) {
+            return record->value[i];
+        }
+    }
+
+    return -1.0;
+}
+
+/* The record of the same configuration and size that carries metric NAME */
+static struct baseline_record_t const * baseline_find (int nprocs,
+                                                       size_t size,
+                                                       char const * name)
+{
+    char const * title = output_benchmark_title();
+    char const * accel = accel_name(options.accel);
+    int i;
+
+    for (i = 0; i < baseline.num; i++) {
+        struct baseline_record_t const * record = &baseline.records[i];
+
+        if (record->size == size && record->ranks == nprocs &&
+                record->src == options.src && record->dst == options.dst &&
+                0 == strcmp(record->accel, accel) &&
+                0 == strcmp(record->benchmark, title) &&
+                0.0 <= record_value(record, name)) {
+            return record;
+        }
+    }
+
+    return NULL;
+}
+
+void compare_baseline (int nprocs, size_t size, int nmetrics,
+                       struct result_metric_t const * metrics)
+{
+    double n1, s1;
+    int i;
+
+    if (NULL == options.baseline) {
+        return;
+    }
+
+    if (!baseline.reported) {
+        baseline.reported = 1;
+        watch_results();
+    }
+
+    n1 = metric_value(nmetrics, metrics, "samples");
+    s1 = metric_value(nmetrics, metrics, "stddev_us");
+
+    for (i = 0; i < nmetrics; i++) {
+        struct baseline_record_t const * record;
+        int direction = metric_direction(metrics[i].name);
+        double value = metrics[i].value, base, change, n0, s0;
+        int significant = 1;
+
+        if (0 == direction || NULL == (record = baseline_find(nprocs, size,
+                        metrics[i].name))) {
+            continue;
+        }
+
+        base = record_value(record, metrics[i].name);
+        if (0.0 >= base) {
+            continue;
+        }
+
+        baseline.compared++;
+
+        /* Positive when the metric got worse */
+        change = 100.0 * (value - base) / base * -direction;
+        if (change <= options.tolerance) {
+            continue;
+        }
+
+        /* Welch's t statistic of the two means, normal approximation */
+        n0 = record_value(record, "samples");
+        s0 = record_value(record, "stddev_us");
+        if (0 == i && n0 > 1 && n1 > 1 && s0 >= 0.0 && s1 >= 0.0 &&
+                s0 + s1 > 0.0) {
+            double t = fabs(value - base) /
+                sqrt(s0 * s0 / n0 + s1 * s1 / n1);
+
+            significant = t > 1.96;
+        }
+
+        if (!significant) {
+            continue;
+        }
+
+        baseline.regressions++;
+        fprintf(stderr, "# Regression: %s size %zu %s %.*f, baseline %.*f "
+                "(%.1f%% worse)\n", record->benchmark, size, metrics[i].name,
+                FLOAT_PRECISION, value, FLOAT_PRECISION, base, change);
+    }
+}
+
+/*
+ * Checkpointing
+ */
+/* A line of the checkpoint with a "completed" field */
+struct checkpoint_marker_t {
+    char benchmark[128];
+    char config[17];
+    int ranks;
+    char accel[16];
+    char src;
+    char dst;
+    size_t size;
+    int sweep;
+};
+
+static struct {
+    char * path;
+    struct checkpoint_marker_t * markers;
+    int num;
+    int capacity;
+    int fd;
+    int pending;
+    uint64_t config;
+} checkpoint = {NULL, NULL, 0, 0, -1, 0, 0};
+
+/* Options that only change what is reported or which sizes are swept */
+static int checkpoint_config_neutral (int c)
+{
+    switch (c) {
+        case 'm':
+        case 'F':
+        case OPT_BASELINE:
+        case OPT_TOLERANCE:
+        case OPT_FIT:
+        case OPT_CHECKPOINT:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/*
+ * Fold option C and its argument into the FNV-1a hash of the options given,
+ * in order, or start over when C is 0.  The long and short forms of an option
+ * hash alike, and so do "--opt value" and "--opt=value".
+ */
+static void checkpoint_config_add (int c, char const * arg)
+{
+    unsigned char const * p = (unsigned char const *)(arg ? arg : "");
+
+    if (0 == c) {
+        checkpoint.config = 14695981039346656037ULL;
+        return;
+    }
+
+    if (checkpoint_config_neutral(c)) {
+        return;
+    }
+
+    checkpoint.config = (checkpoint.config ^ (uint64_t)(unsigned)c) *
+        1099511628211ULL;
+    do {
+        checkpoint.config = (checkpoint.config ^ *p) * 1099511628211ULL;
+    } while (*p++);
+}
+
+static char const * checkpoint_config_name (void)
+{
+    static char name[17];
+
+    snprintf(name, sizeof(name), "%016" PRIx64, checkpoint.config);
+
+    return name;
+}
+
+static struct checkpoint_marker_t * checkpoint_add (void)
+{
+    if (checkpoint.num == checkpoint.capacity) {
+        int capacity = checkpoint.capacity ? 2 * checkpoint.capacity : 64;
+        struct checkpoint_marker_t * markers = realloc(checkpoint.markers,
+                capacity * sizeof(struct checkpoint_marker_t));
+
+        if (NULL == markers) {
+            return NULL;
+        }
+
+        checkpoint.markers = markers;
+        checkpoint.capacity = capacity;
+    }
+
+    memset(&checkpoint.markers[checkpoint.num], 0,
+            sizeof(struct checkpoint_marker_t));
+
+    return &checkpoint.markers[checkpoint.num++];
+}
+
+int open_checkpoint (char const * path)
+{
+    char line[4096];
+    FILE * file;
+
+    /* The start of the sweep numbering of every benchmark osu_suite runs */
+    checkpoint_sweep = 0;
+    checkpoint.pending = 0;
+
+    /*
+     * Load the file once: osu_suite parses the options of every benchmark,
+     * and the markers written in the meantime must not change what the
+     * ranks skip
+     */
+    if (checkpoint.path) {
+        return strcmp(checkpoint.path, path) ? -1 : 0;
+    }
+
+    if (NULL == (checkpoint.path = strdup(path))) {
+        return -1;
+    }
+
+    if (NULL == (file = fopen(path, "r"))) {
+        return ENOENT == errno ? 0 : -1;
+    }
+
+    while (fgets(line, sizeof(line), file)) {
+        struct checkpoint_marker_t * marker;
+        char * cursor = line, * key, * value;
+        size_t len = strcspn(line, "\r\n");
+        int completed = 0, sized = 0;
+
+        /* Skip the line a killed run may have left torn */
+        if ('{' != line[0] || 0 == len || '}' != line[len - 1]) {
+            continue;
+        }
+
+        if (NULL == (marker = checkpoint_add())) {
+            fclose(file);
+            return -1;
+        }
+
+        while (json_pair(&cursor, &key, &value)) {
+            if (0 == strcmp(key, "benchmark")) {
+                snprintf(marker->benchmark, sizeof(marker->benchmark), "%s",
+                        value);
+            } else if (0 == strcmp(key, "config")) {
+                snprintf(marker->config, sizeof(marker->config), "%s", value);
+            } else if (0 == strcmp(key, "ranks")) {
+                marker->ranks = atoi(value);
+            } else if (0 == strcmp(key, "accel")) {
+                snprintf(marker->accel, sizeof(marker->accel), "%s", value);
+            } else if (0 == strcmp(key, "src")) {
+                marker->src = value[0];
+            } else if (0 == strcmp(key, "dst")) {
+                marker->dst = value[0];
+            } else if (0 == strcmp(key, "size")) {
+                marker->size = strtoull(value, NULL, 10);
+                sized = 1;
+            } else if (0 == strcmp(key, "sweep")) {
+                marker->sweep = atoi(value);
+            } else if (0 == strcmp(key, "completed")) {
+                completed = 1;
+            }
+        }
+
+        /*
+         * Result records only tell that a size was started, and the markers
+         * without a size that older osu_suite runs wrote for whole benchmarks
+         * do not tell which options they ran with
+         */
+        if (!completed || !sized) {
+            checkpoint.num--;
+        }
+    }
+
+    fclose(file);
+
+    return 0;
+}
+
+/* Append LINE with a single write, so that it lands whole or torn at the end */
+static void checkpoint_write (char const * line, size_t len)
+{
+    if (-1 == checkpoint.fd) {
+        checkpoint.fd = open(checkpoint.path, O_WRONLY | O_APPEND | O_CREAT,
+                0644);
+
+        if (-1 == checkpoint.fd) {
+            fprintf(stderr, "Warning: cannot write checkpoint %s: %s\n",
+                    checkpoint.path, strerror(errno));
+            checkpoint.fd = -2;
+        }
+    }
+
+    if (0 <= checkpoint.fd && (ssize_t)len != write(checkpoint.fd, line,
+                len)) {
+        fprintf(stderr, "Warning: cannot write checkpoint %s: %s\n",
+                checkpoint.path, strerror(errno));
+        close(checkpoint.fd);
+        checkpoint.fd = -2;
+    }
+}
+
+static int checkpoint_find (int nprocs, size_t size, int sweep)
+{
+    char const * title = output_benchmark_title();
+    char const * accel = accel_name(options.accel);
+    char const * config = checkpoint_config_name();
+    int i;
+
+    for (i = 0; i < checkpoint.num; i++) {
+        struct checkpoint_marker_t const * marker = &checkpoint.markers[i];
+
+        if (marker->size == size && marker->ranks == nprocs &&
+                marker->sweep == sweep && marker->src == options.src &&
+                marker->dst == options.dst &&
+                0 == strcmp(marker->benchmark, title) &&
+                0 == strcmp(marker->accel, accel) &&
+                0 == strcmp(marker->config, config)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void checkpoint_write_marker (int nprocs, size_t size)
+{
+    char line[512];
+    int len;
+
+    len = snprintf(line, sizeof(line), "{\"benchmark\": \"%s\", \"config\": "
+            "\"%s\", \"ranks\": %d, \"accel\": \"%s\", \"src\": \"%c\", "
+            "\"dst\": \"%c\", \"size\": %zu, \"sweep\": %d, "
+            "\"completed\": 1}\n", output_benchmark_title(),
+            checkpoint_config_name(), nprocs, accel_name(options.accel),
+            options.src, options.dst, size, checkpoint_sweep);
+
+    checkpoint_write(line, MIN((size_t)len, sizeof(line) - 1));
+}
+
+void checkpoint_result (int nprocs, size_t size, int nmetrics,
+                        struct result_metric_t const * metrics)
+{
+    char line[4096];
+    int len;
+
+    if (NULL == options.checkpoint) {
+        return;
+    }
+
+    /*
+     * The first size of a sweep is measured again on resume, keep the
+     * records FILE already has for it
+     */
+    if (SCHEDULE_ADAPTIVE != options.schedule.type &&
+            checkpoint_find(checkpoint_num_ranks(), size, checkpoint_sweep)) {
+        return;
+    }
+
+    len = format_json(line, sizeof(line), checkpoint_config_name(), nprocs,
+            size, nmetrics, metrics);
+    checkpoint_write(line, MIN((size_t)len, sizeof(line) - 1));
+    checkpoint.pending = 1;
+}
+
+/* Called by the size iterators when SIZE is done */
+static void checkpoint_mark (size_t size)
+{
+    if (NULL == options.checkpoint || !checkpoint.pending) {
+        return;
+    }
+
+    checkpoint.pending = 0;
+    checkpoint_write_marker(checkpoint_num_ranks(), size);
+}
+
+/* Whether a previous run completed SIZE; adaptive schedules are not skipped */
+static int checkpoint_skip (size_t size)
+{
+    if (NULL == options.checkpoint || 0 == checkpoint.num ||
+            SCHEDULE_ADAPTIVE == options.schedule.type) {
+        return 0;
+    }
+
+    return checkpoint_find(checkpoint_num_ranks(), size, checkpoint_sweep);
+}
+
+/*
+ * Model Fitting
+ */
+#define FIT_MAX_REGIMES     3
+#define FIT_MIN_POINTS      4
+
+static struct {
+    size_t size;
+    double value;
+} model_points[MAX_SCHEDULE_SIZES];
+static int model_num_points = 0;
+static int model_nprocs = 0;
+static enum fit_model model_kind = FIT_ALPHA_BETA;
+
+void record_model_point (enum fit_model model, int nprocs, size_t size,
+                         double time_us)
+{
+    int i;
+
+    if (!options.fit || 0.0 >= time_us) {
+        return;
+    }
+
+    watch_results();
+    model_kind = model;
+    model_nprocs = nprocs;
+
+    for (i = 0; i < model_num_points; i++) {
+        if (model_points[i].size == size) {
+            model_points[i].value = time_us;
+            return;
+        }
+    }
+
+    if (MAX_SCHEDULE_SIZES == model_num_points) {
+        return;
+    }
+
+    /* Insert sorted by size, the adaptive schedule reports out of order */
+    for (i = model_num_points; i > 0 && model_points[i - 1].size > size;
+            i--) {
+        model_points[i] = model_points[i - 1];
+    }
+
+    model_points[i].size = size;
+    model_points[i].value = time_us;
+    model_num_points++;
+}
+
+/*
+ * Least squares line through points LO to HI - 1 in relative terms, every
+ * point weighted with 1 / T^2, so that small and large sizes count alike.
+ * Time does not fall with the size, so a negative slope is clamped to a
+ * constant, the weighted mean.  Returns the sum of the squared relative
+ * residuals.
+ */
+static double fit_segment (int lo, int hi, double * a, double * b)
+{
+    double s = 0, sx = 0, sy = 0, sxx = 0, sxy = 0, det, cost = 0;
+    int i;
+
+    for (i = lo; i < hi; i++) {
+        double x = model_points[i].size, y = model_points[i].value;
+        double w = 1.0 / (y * y);
+
+        s += w;
+        sx += w * x;
+        sy += w * y;
+        sxx += w * x * x;
+        sxy += w * x * y;
+    }
+
+    det = s * sxx - sx * sx;
+    *b = (fabs(det) > 1e-12 * s * sxx) ? (s * sxy - sx * sy) / det : 0.0;
+    *b = MAX(*b, 0.0);
+    *a = (sy - *b * sx) / s;
+
+    for (i = lo; i < hi; i++) {
+        double y = model_points[i].value;
+        double r = (y - *a - *b * model_points[i].size) / y;
+
+        cost += r * r;
+    }
+
+    return cost;
+}
+
+/*
+ * Split the sizes into up to FIT_MAX_REGIMES contiguous regimes of at least
+ * FIT_MIN_POINTS sizes, each with its own line.  The split of every regime
+ * count minimizes the total cost, and the Bayesian information criterion
+ * picks the count, so a breakpoint is only kept where a protocol switch
+ * really bends the curve.  Returns the number of regimes, their first
+ * points in START and the end in START[regimes].
+ */
+static int fit_regimes (int start[FIT_MAX_REGIMES + 1])
+{
+    double cost[FIT_MAX_REGIMES + 1][MAX_SCHEDULE_SIZES + 1];
+    int from[FIT_MAX_REGIMES + 1][MAX_SCHEDULE_SIZES + 1];
+    int n = model_num_points, k, j, i, best = 1;
+    double best_bic = HUGE_VAL;
+
+    for (k = 0; k <= FIT_MAX_REGIMES; k++) {
+        for (j = 0; j <= n; j++) {
+            cost[k][j] = HUGE_VAL;
+        }
+    }
+    cost[0][0] = 0.0;
+
+    for (k = 1; k <= FIT_MAX_REGIMES; k++) {
+        for (j = k * FIT_MIN_POINTS; j <= n; j++) {
+            for (i = (k - 1) * FIT_MIN_POINTS; i <= j - FIT_MIN_POINTS; i++) {
+                double a, b, c;
+
+                if (HUGE_VAL == cost[k - 1][i]) {
+                    continue;
+                }
+
+                c = cost[k - 1][i] + fit_segment(i, j, &a, &b);
+                if (c < cost[k][j]) {
+                    cost[k][j] = c;
+                    from[k][j] = i;
+                }
+            }
+        }
+    }
+
+    for (k = 1; k <= FIT_MAX_REGIMES; k++) {
+        double bic;
+
+        if (HUGE_VAL == cost[k][n]) {
+            continue;
+        }
+
+        /* Two coefficients per regime and one per breakpoint */
+        bic = n * log(cost[k][n] / n + 1e-12) + (3 * k - 1) * log(n);
+        if (bic < best_bic) {
+            best_bic = bic;
+            best = k;
+        }
+    }
+
+    start[best] = n;
+    for (k = best, j = n; k > 0; k--) {
+        j = start[k - 1] = from[k][j];
+    }
+
+    return best;
+}
+
+void print_model_fit (void)
+{
+    static char const * const models[] = {"alpha-beta", "LogGP gap",
+        "LogGP overhead"};
+    static char const * const formulas[] = {"T(n) = alpha + beta * n",
+        "g(n) = g + G * n", "o(n) = o + O * n"};
+    static char const * const constant[][2] = {{"alpha", "fit_alpha_us"},
+        {"g", "fit_g_us"}, {"o", "fit_o_us"}};
+    static char const * const slope[][2] = {{"beta", "fit_beta_ps_per_byte"},
+        {"G", "fit_G_ps_per_byte"}, {"O", "fit_O_ps_per_byte"}};
+    int start[FIT_MAX_REGIMES + 1], regimes, r;
+    char title[64];
+
+    if (model_num_points < FIT_MIN_POINTS) {
+        model_num_points = 0;
+        return;
+    }
+
+    regimes = fit_regimes(start);
+
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "# Model fit: %s, %s, %d regime%s\n",
+                models[model_kind], formulas[model_kind], regimes,
+                1 == regimes ? "" : "s");
+        snprintf(title, sizeof(title), "%s (us)", constant[model_kind][0]);
+        fprintf(stdout, "# %-8s%*s%*s", "Regime", 24, "Sizes", FIELD_WIDTH,
+                title);
+        snprintf(title, sizeof(title), "%s (ps/B)", slope[model_kind][0]);
+        fprintf(stdout, "%*s%*s%*s\n", FIELD_WIDTH, title, FIELD_WIDTH,
+                "1/slope (MB/s)", FIELD_WIDTH, "Error (%)");
+    }
+
+    for (r = 0; r < regimes; r++) {
+        int lo = start[r], hi = start[r + 1];
+        double a, b, cost = fit_segment(lo, hi, &a, &b);
+        double bandwidth = b > 0.0 ? 1.0 / b : 0.0;
+        double error = 100.0 * sqrt(cost / (hi - lo));
+
+        if (OUTPUT_TABLE == options.output_format) {
+            char sizes[64];
+
+            snprintf(sizes, sizeof(sizes), "%zu-%zu", model_points[lo].size,
+                    model_points[hi - 1].size);
+            fprintf(stdout, "# %-8d%*s%*.*f%*.*f", r + 1, 24, sizes,
+                    FIELD_WIDTH, FLOAT_PRECISION, a, FIELD_WIDTH,
+                    FLOAT_PRECISION, b * 1e6);
+            if (bandwidth > 0.0) {
+                fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                        bandwidth);
             } else {
-                options.iterations = LAT_LOOP_SMALL;
-                options.skip = LAT_SKIP_SMALL;
-                options.iterations_large = LAT_LOOP_LARGE;
-                options.skip_large = LAT_SKIP_LARGE;
+                fprintf(stdout, "%*s", FIELD_WIDTH, "latency-bound");
             }
-            if (options.bench == PT2PT) {
-                options.min_message_size = 0;
+            fprintf(stdout, "%*.*f\n", FIELD_WIDTH, FLOAT_PRECISION, error);
+        } else {
+            struct result_metric_t metrics[7] = {
+                {"fit_regime", r + 1},
+                {"fit_max_size", model_points[hi - 1].size},
+                {constant[model_kind][1], a},
+                {slope[model_kind][1], b * 1e6},
+                {"fit_bandwidth_MBps", bandwidth},
+                {"fit_latency_bound", 0.0 >= bandwidth},
+                {"fit_error_pct", error},
+            };
+
+            output_result(model_nprocs, model_points[lo].size, 7, metrics);
+        }
+    }
+
+    fflush(stdout);
+    model_num_points = 0;
+}
+
+/* Bandwidths become the time per message of the stream they were measured on */
+static void record_result_point (int size, double value)
+{
+    if (BW == options.subtype) {
+        record_model_point(FIT_LOGGP_GAP, benchmark_num_ranks, size,
+                value > 0.0 ? size / value : 0.0);
+    } else {
+        record_model_point(FIT_ALPHA_BETA, benchmark_num_ranks, size, value);
+    }
+}
+
+/*
+ * Print a single "size value" line for point-to-point style benchmarks.  The
+ * metric is bandwidth for BW benchmarks and latency for everything else.
+ */
+void print_result (int size, double value)
+{
+    struct result_metric_t metrics[1 + MAX_EXTRA_COLUMNS];
+
+    record_message_size(size, value);
+
+    metrics[0].name = (BW == options.subtype) ? "bandwidth_MBps" : "latency_us";
+    metrics[0].value = value;
+    record_result_point(size, value);
+
+    if (OUTPUT_TABLE == options.output_format) {
+        compare_baseline(benchmark_num_ranks, size, 1, metrics);
+        checkpoint_result(benchmark_num_ranks, size,
+                add_extra_metrics(metrics, 1), metrics);
+        fprintf(stdout, "%-*d%*.*f", 10, size, FIELD_WIDTH,
+                FLOAT_PRECISION, value);
+        print_extra_values();
+        fprintf(stdout, "\n");
+        fflush(stdout);
+        return;
+    }
+
+    output_result(benchmark_num_ranks, size, add_extra_metrics(metrics, 1),
+            metrics);
+}
+
+/*
+ * print_result() with the outcome of validate_pt2pt() for the same size, as a
+ * Pass/Fail column or as the number of corrupted bytes.
+ */
+void print_validated_result (int size, double value, size_t errors)
+{
+    struct result_metric_t metrics[2 + MAX_EXTRA_COLUMNS];
+
+    record_message_size(size, value);
+
+    metrics[0].name = (BW == options.subtype) ? "bandwidth_MBps" : "latency_us";
+    metrics[0].value = value;
+    metrics[1].name = "validation_errors";
+    metrics[1].value = errors;
+    record_result_point(size, value);
+
+    if (OUTPUT_TABLE == options.output_format) {
+        compare_baseline(benchmark_num_ranks, size, 1, metrics);
+        checkpoint_result(benchmark_num_ranks, size,
+                add_extra_metrics(metrics, 2), metrics);
+        fprintf(stdout, "%-*d%*.*f%*s", 10, size, FIELD_WIDTH,
+                FLOAT_PRECISION, value, FIELD_WIDTH, errors ? "Fail" : "Pass");
+        print_extra_values();
+        fprintf(stdout, "\n");
+        fflush(stdout);
+        return;
+    }
+
+    output_result(benchmark_num_ranks, size, add_extra_metrics(metrics, 2),
+            metrics);
+}
+
+struct extra_columns_t extra_columns = {0};
+
+void print_extra_header (void)
+{
+    int i;
+
+    for (i = 0; i < extra_columns.num; i++) {
+        fprintf(stdout, "%*s", extra_columns.width[i], extra_columns.name[i]);
+    }
+}
+
+void print_extra_values (void)
+{
+    int i;
+
+    for (i = 0; i < extra_columns.num; i++) {
+        if (extra_columns.integer[i]) {
+            fprintf(stdout, "%*d", extra_columns.width[i],
+                    (int)extra_columns.value[i]);
+        } else {
+            fprintf(stdout, "%*.*f", extra_columns.width[i], FLOAT_PRECISION,
+                    extra_columns.value[i]);
+        }
+    }
+}
+
+/* Appends the extra columns to METRICS and returns the new number of metrics */
+int add_extra_metrics (struct result_metric_t * metrics, int nmetrics)
+{
+    int i;
+
+    for (i = 0; i < extra_columns.num; i++) {
+        metrics[nmetrics].name = extra_columns.name[i];
+        metrics[nmetrics++].value = extra_columns.value[i];
+    }
+
+    return nmetrics;
+}
+
+char const * reduce_dtype_name (void)
+{
+    return dtype_names[options.dtype];
+}
+
+char const * reduce_op_name (void)
+{
+    return op_names[options.op];
+}
+
+char const * pairing_name (enum pairing_type type)
+{
+    switch (type) {
+        case PAIRING_INTRA_SOCKET:
+            return "intra-socket";
+        case PAIRING_INTER_SOCKET:
+            return "inter-socket";
+        case PAIRING_INTRA_NODE:
+            return "intra-node";
+        case PAIRING_INTER_NODE:
+            return "inter-node";
+        case PAIRING_CROSS_SWITCH:
+            return "cross-switch";
+        default:
+            return "block";
+    }
+}
+
+char const * host_allocator_name (void)
+{
+    switch (options.allocator) {
+        case ALLOC_THP:
+            return "thp";
+        case ALLOC_HUGETLB_2M:
+            return "hugetlb:2M";
+        case ALLOC_HUGETLB_1G:
+            return "hugetlb:1G";
+        case ALLOC_MPI:
+            return "mpi";
+        default:
+            return "default";
+    }
+}
+
+char const * residency_name (enum residency_state state)
+{
+    return residency_names[state];
+}
+
+char const * compute_kernel_name (void)
+{
+    switch (options.compute_kernel) {
+        case KERNEL_TRIAD:
+            return options.compute_omp ? "omp-triad" : "triad";
+        case KERNEL_GEMM:
+            return options.compute_omp ? "omp-gemm" : "gemm";
+        default:
+            return "dummy";
+    }
+}
+
+/*
+ * Host Compute Engine
+ *
+ * The computation that the non-blocking benchmarks overlap with
+ * communication, shared by all runtimes.  allocate_host_arrays() sets up the
+ * kernel of -K, calibrate_host_compute() times one chunk of it once per run,
+ * and do_compute_cpu() then runs as many chunks as fit in the requested time.
+ * compute_host_chunks() runs a fixed amount of work instead, the quantum of
+ * osu_noise.
+ * Times are taken with a monotonic clock so that the kernel does not depend
+ * on the timer of the runtime.
+ */
+
+/* The scalar of the stream triad */
+#define TRIAD_SCALAR 2.0
+
+/* A 2-D matrix for the default dummy computation */
+#define DIM 25
+static float **a, *x, *y;
+
+/* Arrays and positions of the -K compute kernels, see triad_chunks() */
+#define TRIAD_CHUNK 1024
+#define GEMM_BLOCK  16
+
+#ifdef _OPENMP
+#define COMPUTE_PARALLEL_FOR \
+    _Pragma("omp parallel for if (options.compute_omp) schedule(static)")
+#else
+#define COMPUTE_PARALLEL_FOR
+#endif
+
+static double *triad_a, *triad_b, *triad_c;
+static long triad_len, triad_pos;
+static double *gemm_a, *gemm_b, *gemm_c;
+static int gemm_n, gemm_blocks;
+static long gemm_pos;
+static int compute_threads = 1;
+static double host_chunk_seconds = 0.0;
+
+/* Chunks run and time spent in do_compute_cpu() since the last report */
+static double host_chunks_done = 0.0;
+static double host_compute_time = 0.0;
+
+static double compute_clock (void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void compute_on_host (void)
+{
+    int i = 0, j = 0;
+    for (i = 0; i < DIM; i++)
+        for (j = 0; j < DIM; j++)
+            x[i] = x[i] + a[i][j]*a[j][i] + y[j];
+}
+
+/*
+ * One chunk of the triad streams TRIAD_CHUNK elements of each array per
+ * thread, continuing where the last chunk stopped, so that the whole working
+ * set cycles through memory.  One chunk of the GEMM multiplies a pair of
+ * GEMM_BLOCK x GEMM_BLOCK blocks into C per thread; the threads of a chunk
+ * always work on different blocks of C.
+ */
+static void triad_chunks (long chunks)
+{
+    long c, i, start, end;
+
+    for (c = 0; c < chunks; c++) {
+        start = triad_pos;
+        end = start + (long)TRIAD_CHUNK * compute_threads;
+        if (end > triad_len) {
+            end = triad_len;
+        }
+
+        COMPUTE_PARALLEL_FOR
+        for (i = start; i < end; i++) {
+            triad_a[i] = triad_b[i] + TRIAD_SCALAR * triad_c[i];
+        }
+
+        triad_pos = (end == triad_len) ? 0 : end;
+    }
+}
+
+static void gemm_block (long pos)
+{
+    long nb = gemm_blocks, n = gemm_n;
+    long bj = pos % nb, bi = (pos / nb) % nb, bk = pos / (nb * nb);
+    long i, j, k;
+    long i_end = (bi + 1) * GEMM_BLOCK < n ? (bi + 1) * GEMM_BLOCK : n;
+    long j_end = (bj + 1) * GEMM_BLOCK < n ? (bj + 1) * GEMM_BLOCK : n;
+    long k_end = (bk + 1) * GEMM_BLOCK < n ? (bk + 1) * GEMM_BLOCK : n;
+
+    for (i = bi * GEMM_BLOCK; i < i_end; i++) {
+        for (k = bk * GEMM_BLOCK; k < k_end; k++) {
+            double aik = gemm_a[i * n + k];
+
+            for (j = bj * GEMM_BLOCK; j < j_end; j++) {
+                gemm_c[i * n + j] += aik * gemm_b[k * n + j];
             }
+        }
+    }
+}
+
+static void gemm_chunks (long chunks)
+{
+    long tiles = (long)gemm_blocks * gemm_blocks;
+    long total = tiles * gemm_blocks;
+    long width = compute_threads < tiles ? compute_threads : tiles;
+    long c, p, start;
+
+    for (c = 0; c < chunks; c++) {
+        start = gemm_pos;
+
+        COMPUTE_PARALLEL_FOR
+        for (p = 0; p < width; p++) {
+            gemm_block((start + p) % total);
+        }
+
+        gemm_pos = (start + width) % total;
+    }
+}
+
+static void run_host_kernel (long chunks)
+{
+    long c;
+
+    switch (options.compute_kernel) {
+        case KERNEL_TRIAD:
+            triad_chunks(chunks);
             break;
-        case LAT_DT:
-            options.iterations = LAT_DT_LOOP_SMALL;
-            options.skip = LAT_DT_SKIP_SMALL;
-            options.iterations_large = LAT_DT_LOOP_LARGE;
-            options.skip_large = LAT_DT_SKIP_LARGE;
+        case KERNEL_GEMM:
+            gemm_chunks(chunks);
             break;
         default:
+            for (c = 0; c < chunks; c++) {
+                compute_on_host();
+            }
             break;
     }
+}
 
-    switch (options.bench) {
-        case UPCXX:
-        case UPC:
-            options.show_size = 0;
-        case OSHM:
-            options.iterations = OSHM_LOOP_SMALL;
-            options.skip = OSHM_SKIP_SMALL;
-            options.iterations_large = OSHM_LOOP_LARGE;
-            options.skip_large = OSHM_SKIP_LARGE;
-            options.max_message_size = 1<<20;
+/*
+ * Time one chunk of the host kernel, over enough chunks to last at least a
+ * millisecond, once per run.  The best of a few tries is kept so that a
+ * descheduled try does not make the kernel look slower than it is.
+ */
+#define CALIBRATION_TRIES   5
+
+void calibrate_host_compute (void)
+{
+    double elapsed = 0.0;
+    long chunks = 1;
+    int i;
+
+    if (host_chunk_seconds > 0.0) {
+        return;
+    }
+
+    run_host_kernel(1);
+
+    for (;;) {
+        elapsed = compute_clock();
+        run_host_kernel(chunks);
+        elapsed = compute_clock() - elapsed;
+
+        if (elapsed >= 1e-3 || chunks >= (1L << 30)) {
+            break;
+        }
+        chunks *= 2;
+    }
+
+    for (i = 1; i < CALIBRATION_TRIES; i++) {
+        double t = compute_clock();
+
+        run_host_kernel(chunks);
+        t = compute_clock() - t;
+        elapsed = t < elapsed ? t : elapsed;
+    }
+
+    host_chunk_seconds = elapsed / chunks;
+}
+
+void compute_host_chunks (long chunks)
+{
+    run_host_kernel(chunks);
+}
+
+/* Seconds of one chunk of the kernel, 0 before calibrate_host_compute() */
+double host_chunk_time (void)
+{
+    return host_chunk_seconds;
+}
+
+/*
+ * Run as many chunks as the calibration says fit in the remaining time
+ * between two clock reads, and repeat until TARGET_SECONDS have passed.
+ */
+void do_compute_cpu (double target_seconds)
+{
+    double t_start = compute_clock();
+    double time_elapsed = 0.0;
+    long chunks;
+
+    while (time_elapsed < target_seconds) {
+        chunks = 1;
+        if (host_chunk_seconds > 0.0 &&
+                (target_seconds - time_elapsed) / host_chunk_seconds > 1.0) {
+            chunks = (target_seconds - time_elapsed) / host_chunk_seconds;
+        }
+
+        run_host_kernel(chunks);
+        host_chunks_done += chunks;
+        time_elapsed = compute_clock() - t_start;
+    }
+    host_compute_time += time_elapsed;
+}
+
+/*
+ * Compute for SECONDS on the host.  With -t CALLS the time is split into CALLS
+ * pieces, each followed by a call of PROGRESS on ARG, and the time spent in
+ * those calls is returned.
+ */
+double do_compute_and_progress (double seconds, void (*progress)(void *),
+        void * arg)
+{
+    double t, test_time = 0.0;
+    int num_tests;
+
+    if (!options.num_probes) {
+        do_compute_cpu(seconds);
+
+        return 0.0;
+    }
+
+    for (num_tests = 0; num_tests < options.num_probes; num_tests++) {
+        do_compute_cpu(seconds / options.num_probes);
+        t = compute_clock();
+        progress(arg);
+        test_time += compute_clock() - t;
+    }
+
+    return test_time;
+}
+
+/*
+ * Throughput lost by the host kernel since the last call, in percent of its
+ * calibrated chunk time.  Resets the counters.
+ */
+double host_compute_slowdown_local (void)
+{
+    double slowdown = 0.0;
+
+    if (host_chunks_done > 0.0 && host_chunk_seconds > 0.0) {
+        slowdown = 100.0 * (host_compute_time / host_chunks_done /
+                host_chunk_seconds - 1.0);
+    }
+
+    host_chunks_done = 0.0;
+    host_compute_time = 0.0;
+
+    return slowdown;
+}
+
+static double * allocate_kernel_array (size_t count)
+{
+    double * array = (double *)malloc(count * sizeof(double));
+
+    if (NULL == array) {
+        fprintf(stderr, "Error allocating compute kernel arrays\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return array;
+}
+
+void allocate_host_arrays (void)
+{
+    int i=0, j=0;
+    long k;
+
+    /* Every data buffer of the collectives asks for the arrays */
+    if (a) {
+        return;
+    }
+
+#ifdef _OPENMP
+    compute_threads = options.compute_omp ? omp_get_max_threads() : 1;
+#endif
+
+    /* Pages are first touched by the threads that will use them */
+    switch (options.compute_kernel) {
+        case KERNEL_TRIAD:
+            triad_len = options.compute_size / (3 * sizeof(double));
+            if (triad_len < TRIAD_CHUNK) {
+                triad_len = TRIAD_CHUNK;
+            }
+            triad_pos = 0;
+            triad_a = allocate_kernel_array(triad_len);
+            triad_b = allocate_kernel_array(triad_len);
+            triad_c = allocate_kernel_array(triad_len);
+
+            COMPUTE_PARALLEL_FOR
+            for (k = 0; k < triad_len; k++) {
+                triad_a[k] = 0.0;
+                triad_b[k] = 1.0;
+                triad_c[k] = 2.0;
+            }
+            break;
+        case KERNEL_GEMM:
+            gemm_n = options.compute_size;
+            gemm_blocks = (gemm_n + GEMM_BLOCK - 1) / GEMM_BLOCK;
+            gemm_pos = 0;
+            gemm_a = allocate_kernel_array((size_t)gemm_n * gemm_n);
+            gemm_b = allocate_kernel_array((size_t)gemm_n * gemm_n);
+            gemm_c = allocate_kernel_array((size_t)gemm_n * gemm_n);
+
+            COMPUTE_PARALLEL_FOR
+            for (k = 0; k < (long)gemm_n * gemm_n; k++) {
+                gemm_a[k] = 1e-3;
+                gemm_b[k] = 1e-3;
+                gemm_c[k] = 0.0;
+            }
             break;
         default:
             break;
     }
 
-    while ((c = getopt_long(argc, argv, optstring, long_options, &option_index)) != -1) {
-        bad_usage.opt = c;
-        bad_usage.optarg = NULL;
-        bad_usage.message = NULL;
+    a = (float **)malloc(DIM * sizeof(float *));
 
-        switch(c) {
-            case 'h':
-                return PO_HELP_MESSAGE;
-            case 'v':
-                return PO_VERSION_MESSAGE;
-            case 'm':
-                if (set_message_size(optarg)) {
-                    bad_usage.message = "Invalid Message Size";
-                    bad_usage.optarg = optarg;
+    for (i = 0; i < DIM; i++) {
+        a[i] = (float *)malloc(DIM * sizeof(float));
+    }
 
-                    return PO_BAD_USAGE;
-                }
-                break;
-            case 't':
-                if (options.bench == COLLECTIVE) {
-                    if (set_num_probes(atoi(optarg))){
-                        bad_usage.message = "Invalid Number of Probes";
-                        bad_usage.optarg = optarg;
+    x = (float *)malloc(DIM * sizeof(float));
+    y = (float *)malloc(DIM * sizeof(float));
+
+    for (i = 0; i < DIM; i++) {
+        x[i] = y[i] = 1.0f;
+        for (j = 0; j < DIM; j++) {
+            a[i][j] = 2.0f;
+        }
+    }
+}
+
+void free_host_compute (void)
+{
+    int i = 0;
+
+    if (x) {
+        free(x);
+    }
+    if (y) {
+        free(y);
+    }
+
+    if (a) {
+        for (i = 0; i < DIM; i++) {
+            free(a[i]);
+        }
+        free(a);
+    }
+
+    x = NULL;
+    y = NULL;
+    a = NULL;
+
+    free(triad_a);
+    free(triad_b);
+    free(triad_c);
+    free(gemm_a);
+    free(gemm_b);
+    free(gemm_c);
+
+    triad_a = triad_b = triad_c = NULL;
+    gemm_a = gemm_b = gemm_c = NULL;
+    host_chunk_seconds = 0.0;
+}
+
+char const * thread_comm_name (void)
+{
+    switch (options.thread_comm) {
+        case THREAD_COMM_SHARED:
+            return "shared";
+        case THREAD_COMM_TAG:
+            return "tag";
+        default:
+            return "comm";
+    }
+}
+
+char const * send_mode_name (void)
+{
+    switch (options.send_mode) {
+        case SEND_MODE_SYNC:
+            return "sync";
+        case SEND_MODE_READY:
+            return "ready";
+        case SEND_MODE_BUFFERED:
+            return "buffered";
+        case SEND_MODE_PERSISTENT:
+            return "persistent";
+        default:
+            return "standard";
+    }
+}
+
+char const * latency_loop_name (void)
+{
+    switch (options.loop) {
+        case LOOP_FAST:
+            return "fast";
+        case LOOP_NULL:
+            return "null";
+        default:
+            return "generic";
+    }
+}
+
+char const * rma_pattern_name (void)
+{
+    switch (options.rma_pattern) {
+        case RMA_FANOUT:
+            return "fanout";
+        case RMA_FANIN:
+            return "fanin";
+        case RMA_MANY:
+            return "many";
+        default:
+            return "pairs";
+    }
+}
+
+char const * dt_layout_name (void)
+{
+    switch (options.dt_layout) {
+        case DT_INDEXED:
+            return "indexed";
+        case DT_SUBARRAY:
+            return "subarray";
+        case DT_STRUCT:
+            return "struct";
+        default:
+            return "vector";
+    }
+}
+
+/* How dt_pack() moves the blocks of a buffer of the given kind */
+char const * dt_pack_name (char buf_type)
+{
+    if ('D' != buf_type && 'M' != buf_type) {
+        return "host memcpy";
+    } else if (OPENACC == options.accel) {
+        return "openacc loop";
+    } else if (GPU_KERNEL_ENABLED) {
+        return "device kernel";
+    } else {
+        return "device memcpy";
+    }
+}
+
+void print_affinity_summary (void)
+{
+    if (NULL == affinity_placement || OUTPUT_TABLE != options.output_format) {
+        return;
+    }
+
+    fprintf(stdout, "%s", affinity_placement);
+    fflush(stdout);
+}
+
+void print_pairing_summary (void)
+{
+    int i;
+
+    if (OUTPUT_TABLE != options.output_format) {
+        return;
+    }
+
+    fprintf(stdout, "# Pairing: %s, %d pairs (", pairing_name(options.pairing),
+            pairing.num_pairs);
+
+    for (i = 0; i < LOCALITY_CLASSES; i++) {
+        fprintf(stdout, "%s%s %d", i ? ", " : "", locality_names[i],
+                pairing.class_pairs[i]);
+    }
+
+    fprintf(stdout, ")\n");
+    fflush(stdout);
+}
+
+/*
+ * Header of --stream, which replaces the size column by the time slices
+ */
+void print_stream_header (void)
+{
+    fprintf(stdout, "# Streaming %zu bytes for %g s in slices of %d ms\n",
+            options.max_message_size, options.stream_seconds,
+            options.stream_slice_ms);
+    fprintf(stdout, "%-*s%*s\n", 12, "# Time (s)", FIELD_WIDTH,
+            "Bandwidth (MB/s)");
+    fflush(stdout);
+}
+
+/*
+ * Locality breakdown columns; only classes that have pairs get a column
+ */
+void print_locality_header (int ntitles, char const * const * titles,
+                            char const * unit)
+{
+    char title[64];
+    int i;
+
+    fprintf(stdout, "%-*s", 10, "# Size");
+
+    for (i = 0; i < ntitles; i++) {
+        fprintf(stdout, "%*s", FIELD_WIDTH, titles[i]);
+    }
+
+    for (i = 0; i < LOCALITY_CLASSES; i++) {
+        if (pairing.class_pairs[i]) {
+            snprintf(title, sizeof(title), "%s (%s)", locality_titles[i], unit);
+            fprintf(stdout, "%*s", FIELD_WIDTH, title);
+        }
+    }
+
+    fprintf(stdout, "\n");
+    fflush(stdout);
+}
+
+void print_locality_result (int size, int nmetrics,
+                            struct result_metric_t const * metrics,
+                            double const * by_class)
+{
+    struct result_metric_t all[8];
+    char names[LOCALITY_CLASSES][64];
+    int i, n = 0;
+
+    record_message_size(size, metrics[0].value);
+
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "%-*d", 10, size);
+
+        for (i = 0; i < nmetrics; i++) {
+            fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                    metrics[i].value);
+        }
+
+        for (i = 0; i < LOCALITY_CLASSES; i++) {
+            if (pairing.class_pairs[i]) {
+                fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                        by_class[i]);
+            }
+        }
+
+        fprintf(stdout, "\n");
+        fflush(stdout);
+        return;
+    }
+
+    for (i = 0; i < nmetrics && n < 4; i++) {
+        all[n++] = metrics[i];
+    }
+
+    for (i = 0; i < LOCALITY_CLASSES; i++) {
+        if (pairing.class_pairs[i]) {
+            snprintf(names[i], sizeof(names[i]), "%s_%s", locality_keys[i],
+                    metrics[0].name);
+            all[n].name = names[i];
+            all[n++].value = by_class[i];
+        }
+    }
+
+    output_result(benchmark_num_ranks, size, n, all);
+}
+
+void hist_reset (struct latency_hist_t * hist)
+{
+    memset(hist, 0, sizeof(struct latency_hist_t));
+    hist->min = -1.0;
+}
+
+static int hist_bucket_index (uint64_t nsec)
+{
+    int exponent = 0;
+    uint64_t v = nsec;
+
+    if (nsec < HIST_SUB_BUCKETS) {
+        return (int)nsec;
+    }
+
+    while (v >>= 1) {
+        exponent++;
+    }
+
+    if (exponent > HIST_MAX_EXPONENT) {
+        return HIST_NUM_BUCKETS - 1;
+    }
 
-                        return PO_BAD_USAGE;
-                    }
-                } else if (options.bench == PT2PT) {
-                    if (options.subtype == LAT_MT) {
-                        if (set_threads(optarg)){
-                            bad_usage.message = "Invalid Number of Threads";
-                            bad_usage.optarg = optarg;
+    return HIST_SUB_BUCKETS * (exponent - HIST_SUB_BITS + 1) +
+        (int)((nsec >> (exponent - HIST_SUB_BITS)) - HIST_SUB_BUCKETS);
+}
 
-                            return PO_BAD_USAGE;
-                        }
-                    } else if (options.subtype == LAT_MP) {
-                        if (set_processes(optarg)){
-                            bad_usage.message = "Invalid Number of Processes";
-                            bad_usage.optarg = optarg;
+/* Midpoint of a bucket, in microseconds */
+static double hist_bucket_value (int index)
+{
+    int exponent;
+    uint64_t width, lower;
 
-                            return PO_BAD_USAGE;
-                        } 
-                    }
-                }
-                break;
-            case 'i':
-                if (set_num_iterations(atoi(optarg))) {
-                    bad_usage.message = "Invalid Number of Iterations";
-                    bad_usage.optarg = optarg;
+    if (index < HIST_SUB_BUCKETS) {
+        return index / 1e3;
+    }
 
-                    return PO_BAD_USAGE;
-                }
-                break;
-            case 'x':
-                if (set_num_warmup(atoi(optarg))) {
-                    bad_usage.message = "Invalid Number of Warmup Iterations";
-                    bad_usage.optarg = optarg;
+    exponent = index / HIST_SUB_BUCKETS + HIST_SUB_BITS - 1;
+    width = (uint64_t)1 << (exponent - HIST_SUB_BITS);
+    lower = ((uint64_t)1 << exponent) + (index % HIST_SUB_BUCKETS) * width;
 
-                    return PO_BAD_USAGE;
-                }
-                break;
-            case 'R':
-                options.print_rate = atoi(optarg);
-                if (0 != options.print_rate && 1 != options.print_rate) {
-                    return PO_BAD_USAGE;
-                }
-                break;
-            case 'W':
-                if (set_window_size(atoi(optarg))) {
-                    bad_usage.message = "Invalid Window Size";
-                    bad_usage.optarg = optarg;
+    return (lower + width / 2.0) / 1e3;
+}
 
-                    return PO_BAD_USAGE;
-                }
-                break;
-            case 'V':
-                options.window_varied = 1;
-                break;
-            case 'p':
-                options.pairs = atoi(optarg);
-                break;
-            case 'a':
-                if (set_device_array_size(atoi(optarg))){
-                    bad_usage.message = "Invalid Device Array Size";
-                    bad_usage.optarg = optarg;
+void hist_record (struct latency_hist_t * hist, double seconds)
+{
+    double usec = seconds * 1e6;
+    uint64_t nsec = (seconds > 0) ? (uint64_t)(seconds * 1e9) : 0;
 
-                    return PO_BAD_USAGE;
-                }
-                break;
-            case 'f':
-                options.show_full = 1;
-                break;
-            case 'M':
-                /*
-                 * This function does not error but prints a warning message if
-                 * the value is too low.
-                 */
-                set_max_memlimit(atoll(optarg));
-                break;
-            case 'd':
-                if (!accel_enabled) {
-                    bad_usage.message = "Benchmark Does Not Support "
-                            "Accelerator Transfers";
-                    bad_usage.optarg = optarg;
-                    return PO_BAD_USAGE;
-                } else if (0 == strncasecmp(optarg, "cuda", 10)) {
-                    if (CUDA_ENABLED) {
-                        options.accel = CUDA;
-                    } else {
-                        bad_usage.message = "CUDA Support Not Enabled\n"
-                                "Please recompile benchmark with CUDA support";
-                        bad_usage.optarg = optarg;
-                        return PO_BAD_USAGE;
-                    }
-                } else if (0 == strncasecmp(optarg, "managed", 10)) {
-                    if (CUDA_ENABLED) {
-                        options.accel = MANAGED;
-                    } else {
-                        bad_usage.message = "CUDA Managed Memory Support Not Enabled\n"
-                                "Please recompile benchmark with CUDA support";
-                        bad_usage.optarg = optarg;
-                        return PO_BAD_USAGE;
-                    }
-                } else if (0 == strncasecmp(optarg, "openacc", 10)) {
-                    if (OPENACC_ENABLED) {
-                        options.accel = OPENACC;
-                    } else {
-                        bad_usage.message = "OpenACC Support Not Enabled\n"
-                                "Please recompile benchmark with OpenACC support";
-                        bad_usage.optarg = optarg;
-                        return PO_BAD_USAGE;
-                    }
-                } else if (0 == strncasecmp(optarg, "rocm", 10)) {
-                    if (ROCM_ENABLED) {
-                        options.accel = ROCM;
-                    } else {
-                        bad_usage.message = "ROCm Support Not Enabled\n"
-                                "Please recompile benchmark with ROCm support";
-                        bad_usage.optarg = optarg;
-                        return PO_BAD_USAGE;
-                    }
-                } else {
-                    bad_usage.message = "Invalid Accel Type Specified";
-                    bad_usage.optarg = optarg;
-                    return PO_BAD_USAGE;
-                }
-                break;
-            case 'r':
-                if (CUDA_KERNEL_ENABLED) {
-                    if (0 == strncasecmp(optarg, "cpu", 10)) {
-                        options.target = CPU;
-                    } else if (0 == strncasecmp(optarg, "gpu", 10)) {
-                        options.target = GPU;
-                    } else if (0 == strncasecmp(optarg, "both", 10)) {
-                        options.target = BOTH;
-                    } else {
-                        bad_usage.message = "Please use cpu, gpu, or both";
-                        bad_usage.optarg = optarg;
-                        return PO_BAD_USAGE;
-                    }
-                } else {
-                    bad_usage.message = "CUDA Kernel Support Not Enabled\n"
-                            "Please recompile benchmark with CUDA Kernel support";
-                    bad_usage.optarg = optarg;
-                    return PO_BAD_USAGE;
-                }
-                break;
-            case 'w':
-                ret = process_one_sided_options(c, optarg);
-                if (ret == PO_BAD_USAGE) {
-                    bad_usage.message = "Invalid option or invalid argument";
-                    bad_usage.opt = c;
-                    bad_usage.optarg = optarg;
-                    return PO_BAD_USAGE;
-                }
-                break;
-            case 's':
-                ret = process_one_sided_options(c, optarg);
-                if (ret == PO_BAD_USAGE) {
-                    bad_usage.message = "Invalid option or invalid argument";
-                    bad_usage.opt = c;
-                    bad_usage.optarg = optarg;
-                    return PO_BAD_USAGE;
-                }
-                break;
-            case 'B':
-                if (set_dt_block_size(atoi(optarg))) {
-                    bad_usage.message = "Invalid block size";
-                    bad_usage.optarg = optarg;
+    hist->bucket[hist_bucket_index(nsec)]++;
+    hist->count++;
 
-                    return PO_BAD_USAGE;
-                }
-                break;
-            case 'S':
-                if (set_dt_stride_size(atoi(optarg))) {
-                    bad_usage.message = "Invalid base stride size";
-                    bad_usage.optarg = optarg;
+    if (usec > hist->max) {
+        hist->max = usec;
+    }
 
-                    return PO_BAD_USAGE;
-                }
-                break;
-            case 'I':
-                if (set_dt_increase_size(atoi(optarg))) {
-                    bad_usage.message = "Invalid increment stride size";
-                    bad_usage.optarg = optarg;
+    if (hist->min < 0 || usec < hist->min) {
+        hist->min = usec;
+    }
+}
 
-                    return PO_BAD_USAGE;
-                }
-                break;
-            case ':':
-                bad_usage.message = "Option Missing Required Argument";
-                bad_usage.opt = optopt;
-                return PO_BAD_USAGE;
-            default:
-                bad_usage.message = "Invalid option";
-                bad_usage.opt = optopt;
-                return PO_BAD_USAGE;
-        }
+/*
+ * Returns the latency (us) below which the given percentage of the recorded
+ * samples fall.  The result is clamped to the exact observed min/max.
+ */
+double hist_percentile (struct latency_hist_t const * hist, double percentile)
+{
+    uint64_t target, seen = 0;
+    double value;
+    int i;
+
+    if (0 == hist->count) {
+        return 0.0;
     }
 
-    if (accel_enabled) {
-        if ((optind + 2) == argc) {
-            options.src = argv[optind][0];
-            options.dst = argv[optind + 1][0];
-            /* No need to check if '-d' is given */
-            if (NONE == options.accel) {
-                setAccel(options.src);
-                setAccel(options.dst);
-            }
-        } else if (optind != argc) {
-            return PO_BAD_USAGE;
+    target = (uint64_t)ceil(percentile / 100.0 * hist->count);
+    if (target < 1) {
+        target = 1;
+    }
+
+    for (i = 0; i < HIST_NUM_BUCKETS; i++) {
+        seen += hist->bucket[i];
+        if (seen >= target) {
+            break;
         }
     }
 
-    return PO_OKAY;
+    value = hist_bucket_value(i);
+    value = MAX(value, hist->min);
+    value = MIN(value, hist->max);
+
+    return value;
 }
 
-/* Set the initial accelerator type */
-int setAccel(char buf_type)
+void record_latency (double seconds)
 {
-    switch (buf_type) {
-        case 'H':
-            break;
-        case 'D':
-        case 'M':
-            if (options.bench != PT2PT && options.bench != ONE_SIDED && options.bench != MBW_MR) {
-                bad_usage.opt = buf_type;
-                bad_usage.message = "This argument is only supported for one-sided and pt2pt benchmarks";
-                return PO_BAD_USAGE;
-            }
-            if (NONE == options.accel) {
-#if defined(_ENABLE_OPENACC_) && !defined(_ENABLE_CUDA_)
-                options.accel = OPENACC;
-#elif defined(_ENABLE_CUDA_)
-                options.accel = CUDA;
-#elif defined(_ENABLE_ROCM_)
-                options.accel = ROCM;
-#endif
-            }
-            break;
-        default:
-            return PO_BAD_USAGE;
+    if (options.show_percentiles) {
+        hist_record(&latency_hist, seconds);
     }
-    return PO_OKAY;
+
+    stats_record(&latency_stats, seconds);
 }
 
+void stats_reset (struct sample_stats_t * stats)
+{
+    memset(stats, 0, sizeof(struct sample_stats_t));
+}
 
-double getMicrosecondTimeStamp()
+void stats_record (struct sample_stats_t * stats, double value)
 {
-    double retval;
-    struct timeval tv;
-    if (gettimeofday(&tv, NULL)) {
-        perror("gettimeofday");
-        abort();
+    double delta = value - stats->mean;
+
+    /* Welford's update keeps the variance stable over long runs */
+    stats->count++;
+    stats->mean += delta / stats->count;
+    stats->m2 += delta * (value - stats->mean);
+}
+
+/*
+ * Half width of the 95% confidence interval of the mean, in percent of the
+ * mean, using the normal approximation
+ */
+double stats_relative_error (struct sample_stats_t const * stats)
+{
+    double stddev;
+
+    if (2 > stats->count || 0.0 >= stats->mean) {
+        return HUGE_VAL;
     }
-    retval = ((double)tv.tv_sec) * 1000000 + tv.tv_usec;
-    return retval;
+
+    stddev = sqrt(stats->m2 / (stats->count - 1));
+
+    return 100.0 * 1.96 * stddev / sqrt((double)stats->count) / stats->mean;
 }
 
 void wtime(double *t)
 {
     static int sec = -1;
     struct timeval tv;
+
+    if (TIMER_DEFAULT != options.timer) {
+        *t = timer_now() * 1e6;
+        return;
+    }
+
     //gettimeofday(&tv, (void *)0);
     gettimeofday(&tv, 0);
     if (sec < 0) sec = tv.tv_sec;
@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <math.h>
 #include <string.h>
+#include <strings.h>
 #include <stdint.h>
 #include <getopt.h>
 #include <pthread.h>
@@ -61,6 +62,17 @@
 #   define CUDA_KERNEL_ENABLED 0
 #endif
 
+#ifdef _ENABLE_ROCM_KERNEL_
+#   define ROCM_KERNEL_ENABLED 1
+#else
+#   define ROCM_KERNEL_ENABLED 0
+#endif
+
+#if defined(_ENABLE_CUDA_KERNEL_) || defined(_ENABLE_ROCM_KERNEL_)
+#   define _ENABLE_GPU_KERNEL_ 1
+#endif
+#define GPU_KERNEL_ENABLED (CUDA_KERNEL_ENABLED || ROCM_KERNEL_ENABLED)
+
 #ifdef _ENABLE_ROCM_
 #   define ROCM_ENABLED 1
 #   include "hip/hip_runtime.h"
@@ -68,6 +80,31 @@
 #   define ROCM_ENABLED 0
 #endif
 
+#ifdef _ENABLE_SYCL_
+#   define SYCL_ENABLED 1
+#   include <level_zero/ze_api.h>
+#else
+#   define SYCL_ENABLED 0
+#endif
+
+#if defined(_ENABLE_OPENACC_) || defined(_ENABLE_CUDA_) || \
+    defined(_ENABLE_ROCM_) || defined(_ENABLE_SYCL_)
+#   define _ENABLE_ACCEL_ 1
+#endif
+#define ACCEL_ENABLED (CUDA_ENABLED || OPENACC_ENABLED || ROCM_ENABLED || \
+        SYCL_ENABLED)
+
+#ifdef _ENABLE_NCCL_
+#   define NCCL_ENABLED 1
+#   ifdef _ENABLE_ROCM_
+#       include <rccl/rccl.h>
+#   else
+#       include <nccl.h>
+#   endif
+#else
+#   define NCCL_ENABLED 0
+#endif
+
 #ifndef BENCHMARK
 #   define BENCHMARK "MPI%s BENCHMARK NAME UNSET"
 #endif
@@ -123,6 +160,31 @@ do {                                                                    \
 } while (0)
 #endif
 
+#if defined(_ENABLE_SYCL_)
+#define ZE_CHECK(stmt)                                                  \
+do {                                                                    \
+   ze_result_t ze_errno = (stmt);                                       \
+   if (ZE_RESULT_SUCCESS != ze_errno) {                                 \
+       fprintf(stderr, "[%s:%d] Level Zero call '%s' failed with "      \
+        "0x%x\n", __FILE__, __LINE__, #stmt, (unsigned)ze_errno);       \
+       exit(EXIT_FAILURE);                                              \
+   }                                                                    \
+} while (0)
+#endif
+
+#if defined(_ENABLE_NCCL_)
+#define NCCL_CHECK(stmt)                                                \
+do {                                                                    \
+   ncclResult_t nccl_err = (stmt);                                      \
+   if (ncclSuccess != nccl_err) {                                       \
+       fprintf(stderr, "[%s:%d] NCCL call '%s' failed with %d: %s \n",  \
+        __FILE__, __LINE__, #stmt, nccl_err,                            \
+        ncclGetErrorString(nccl_err));                                  \
+       exit(EXIT_FAILURE);                                              \
+   }                                                                    \
+} while (0)
+#endif
+
 #define TIME() getMicrosecondTimeStamp()
 double getMicrosecondTimeStamp();
 
@@ -133,7 +195,22 @@ min_time, double max_time, int iterations) __attribute__((unused));
 void print_data_nbc (int rank, int full, int size, double ovrl, double
 cpu, double comm, double wait, double init, int iterations);
 
+/*
+ * Host compute of the overlap benchmarks, see the Host Compute Engine in
+ * osu_util.c.  do_compute_and_progress() calls PROGRESS on ARG between the
+ * -t pieces of the computation and returns the time spent in those calls.
+ * compute_host_chunks() runs a fixed number of chunks of the kernel, each of
+ * which takes host_chunk_time() seconds once calibrated.
+ */
 void allocate_host_arrays();
+void free_host_compute (void);
+void calibrate_host_compute (void);
+void compute_host_chunks (long chunks);
+double host_chunk_time (void);
+void do_compute_cpu (double target_seconds);
+double do_compute_and_progress (double seconds, void (*progress)(void *),
+        void * arg);
+double host_compute_slowdown_local (void);
 
 void
 calculate_and_print_stats(int rank, int size, int numprocs,
@@ -158,10 +235,19 @@ enum mpi_req{
 #define LAT_DT_SKIP_SMALL 100
 #define LAT_DT_LOOP_LARGE 100
 #define LAT_DT_SKIP_LARGE 10
+#define MATRIX_LOOP_LAT 100
+#define MATRIX_SKIP_LAT 10
+#define MATRIX_LOOP_BW 10
+#define MATRIX_SKIP_BW 2
+#define MATRIX_LAT_SIZE 8
+#define MATRIX_BW_SIZE (1 << 20)
+#define MATRIX_WINDOW_SIZE 16
+#define DEF_OUTLIER_THRESHOLD 2.0
 #define COLL_LOOP_SMALL 1000
 #define COLL_SKIP_SMALL 100
 #define COLL_LOOP_LARGE 100
 #define COLL_SKIP_LARGE 10
+#define PERSISTENT_INIT_ITERS 10
 #define OSHM_LOOP_SMALL 1000
 #define OSHM_LOOP_LARGE 100
 #define OSHM_SKIP_SMALL 200
@@ -169,6 +255,11 @@ enum mpi_req{
 #define OSHM_LOOP_SMALL_MR 500
 #define OSHM_LOOP_LARGE_MR 50
 #define OSHM_LOOP_ATOMIC 500
+#define PGAS_LAT_LOOP_SMALL 10000
+#define PGAS_LAT_SKIP_SMALL 1000
+#define PGAS_LAT_LOOP_LARGE 100
+#define PGAS_LAT_SKIP_LARGE 10
+#define PGAS_MR_WINDOW_SKIP 10
 
 #define MAX_MESSAGE_SIZE (1 << 22)
 #define MAX_MSG_SIZE_PT2PT (1<<20)
@@ -185,10 +276,31 @@ enum mpi_req{
 #define MESSAGE_ALIGNMENT 64
 #define MESSAGE_ALIGNMENT_MR (1<<12)
 
+#define MAX_BIND_CPUS 1024
+#define MAX_MEM_NODES 256
+#define MAX_GPU_LIST 64
+#define GPU_NIC_NAME_LEN 32
+
 #define MAX_DT_BLOCK_SIZE (1 << 20)
 #define MAX_DT_STRIDE_SIZE (1 << 20)
 #define MAX_DT_REPEAT_COUNT 65536
 
+/* Blocks of osu_coll_dt, every other 16 bytes of the buffer */
+#define DEF_COLL_DT_BLOCK_SIZE 16
+#define DEF_COLL_DT_STRIDE_SIZE 32
+
+/*
+ * Constructor of the derived datatype of osu_latency_dt, osu_multi_lat_dt and
+ * osu_coll_dt.  DT_AUTO picks the vector, or the indexed type when -I is given.
+ */
+enum dt_layout {
+    DT_AUTO,
+    DT_VECTOR,
+    DT_INDEXED,
+    DT_SUBARRAY,
+    DT_STRUCT
+};
+
 enum po_ret_type {
     PO_CUDA_NOT_AVAIL,
     PO_OPENACC_NOT_AVAIL,
@@ -203,7 +315,522 @@ enum accel_type {
     CUDA,
     OPENACC,
     MANAGED,
-    ROCM
+    ROCM,
+    SYCL
+};
+
+enum output_format {
+    OUTPUT_TABLE,
+    OUTPUT_CSV,
+    OUTPUT_JSON
+};
+
+enum size_schedule_type {
+    SCHEDULE_GEOMETRIC,
+    SCHEDULE_LINEAR,
+    SCHEDULE_LIST,
+    SCHEDULE_ADAPTIVE
+};
+
+#define MAX_SCHEDULE_SIZES 256
+#define DEF_ADAPTIVE_POINTS 16
+#define DEF_ADAPTIVE_THRESHOLD 0.5
+
+struct size_schedule_t {
+    enum size_schedule_type type;
+    double factor;
+    size_t step;
+    size_t list[MAX_SCHEDULE_SIZES];
+    int list_len;
+    int max_points;
+    double threshold;
+};
+
+/*
+ * Convergence mode: iterate until the 95% confidence interval of the mean
+ * latency is within target percent of the mean on every rank, or until budget
+ * seconds have been spent on the message size.  A target of 0 disables it.
+ */
+#define DEF_CONVERGE_BUDGET 5.0
+#define CONVERGE_MIN_ITERATIONS 16
+
+struct convergence_t {
+    double target;
+    double budget;
+};
+
+/*
+ * Baseline comparison, --baseline FILE --tolerance PCT: every reported metric
+ * is compared with the same benchmark, rank count, buffers, size and metric
+ * of a CSV or JSON result file, and counts as a regression when it is more
+ * than PCT percent worse.
+ */
+#define DEF_BASELINE_TOLERANCE 5.0
+
+/*
+ * Outlier ranks of --outliers K[:Z]: the K slowest ranks of every message
+ * size are listed, and ranks whose robust z-score is beyond Z are counted as
+ * outliers.
+ */
+#define DEF_OUTLIER_Z 3.5
+
+/*
+ * Cache-cold mode: data buffers of the blocking collectives are backed by a
+ * pool of at least pool_size bytes beyond the message and every iteration
+ * uses the next page aligned slot of the pool.  Fresh mode allocates a new
+ * buffer for every iteration instead, so the MPI library cannot reuse a
+ * memory registration.
+ */
+#define DEF_CACHE_POOL_SIZE (64 * 1024 * 1024)
+
+enum cache_mode {
+    CACHE_HOT,
+    CACHE_COLD,
+    CACHE_FRESH
+};
+
+/*
+ * Host computation that the non-blocking collectives overlap with, selected
+ * with -K.  The dummy kernel stays in the caches; the stream triad moves
+ * compute_size bytes through memory and the blocked GEMM multiplies two
+ * compute_size x compute_size matrices.
+ */
+#define DEF_TRIAD_SIZE      (96 * 1024 * 1024)
+#define DEF_GEMM_SIZE       256
+#define MAX_GEMM_SIZE       8192
+
+enum compute_kernel {
+    KERNEL_DUMMY,
+    KERNEL_TRIAD,
+    KERNEL_GEMM
+};
+
+/*
+ * Device selection policies of -g, applied to the node-local rank
+ */
+enum gpu_select_policy {
+    GPU_SELECT_RANK,
+    GPU_SELECT_LIST,
+    GPU_SELECT_NIC
+};
+
+/*
+ * Host buffer allocators selected with -A
+ */
+enum host_allocator {
+    ALLOC_DEFAULT,
+    ALLOC_THP,
+    ALLOC_HUGETLB_2M,
+    ALLOC_HUGETLB_1G,
+    ALLOC_MPI
+};
+
+/*
+ * Pairing patterns of the multi-pair benchmarks.  PAIRING_NONE marks
+ * benchmarks that do not support -P; the others preset options.pairing to
+ * PAIRING_BLOCK, which pairs rank i with rank i + pairs.
+ */
+enum pairing_type {
+    PAIRING_NONE,
+    PAIRING_BLOCK,
+    PAIRING_INTRA_SOCKET,
+    PAIRING_INTER_SOCKET,
+    PAIRING_INTRA_NODE,
+    PAIRING_INTER_NODE,
+    PAIRING_CROSS_SWITCH
+};
+
+/*
+ * Thread to communicator mapping of osu_mbw_mr_mt.  SHARED puts every thread
+ * on MPI_COMM_WORLD with one tag, TAG gives each thread its own tag, and
+ * PRIVATE spreads the threads round robin over options.thread_comms
+ * duplicates of MPI_COMM_WORLD (0 means one per thread).
+ */
+enum thread_comm_mode {
+    THREAD_COMM_SHARED,
+    THREAD_COMM_TAG,
+    THREAD_COMM_PRIVATE
+};
+
+/*
+ * Hierarchical comparison of osu_allreduce and osu_bcast.  HIER_NONE marks
+ * benchmarks that do not support -H, the others preset HIER_OFF.
+ */
+enum hier_mode {
+    HIER_NONE,
+    HIER_OFF,
+    HIER_ON
+};
+
+/*
+ * Segmented pipeline comparison of osu_allreduce and osu_bcast, -L
+ * CHUNK[:DEPTH].  PIPELINE_NONE marks benchmarks that do not support -L, the
+ * others preset PIPELINE_OFF.
+ */
+#define DEF_PIPELINE_DEPTH  4
+#define MAX_PIPELINE_DEPTH  64
+
+enum pipeline_mode {
+    PIPELINE_NONE,
+    PIPELINE_OFF,
+    PIPELINE_ON
+};
+
+/*
+ * Stencil of the neighborhood collectives, -E SHAPE[:DIMS]: the face
+ * neighbors on a Cartesian communicator, the same neighbors on a distributed
+ * graph communicator, or all neighbors including edges and corners on a
+ * distributed graph.  STENCIL_NONE marks benchmarks that do not support -E.
+ */
+#define DEF_STENCIL_DIMS        3
+#define MAX_STENCIL_DIMS        3
+#define MAX_STENCIL_NEIGHBORS   26
+
+enum stencil_shape {
+    STENCIL_NONE,
+    STENCIL_FACE,
+    STENCIL_GRAPH,
+    STENCIL_FULL
+};
+
+/*
+ * Library that runs the blocking collectives on device buffers.  BACKEND_NONE
+ * marks benchmarks that do not support -G, the others preset BACKEND_MPI.
+ */
+enum coll_backend {
+    BACKEND_NONE,
+    BACKEND_MPI,
+    BACKEND_NCCL
+};
+
+/*
+ * Data validation of osu_latency, osu_bw and osu_bibw.  VALIDATE_NONE marks
+ * benchmarks that do not support -j, the others preset VALIDATE_OFF.
+ */
+enum validate_mode {
+    VALIDATE_NONE,
+    VALIDATE_OFF,
+    VALIDATE_ON
+};
+
+/*
+ * Memory footprint samples of -U.  MEM_FOOTPRINT_NONE marks benchmarks that do
+ * not support it, the others preset MEM_FOOTPRINT_OFF.
+ */
+enum mem_footprint_mode {
+    MEM_FOOTPRINT_NONE,
+    MEM_FOOTPRINT_OFF,
+    MEM_FOOTPRINT_ON
+};
+
+/*
+ * MPI_T pvar capture of -Y NAMES, or -Y list to print the pvars of the
+ * library.  PVARS_NONE marks benchmarks that do not support it, the others
+ * preset PVARS_OFF.
+ */
+enum pvar_mode {
+    PVARS_NONE,
+    PVARS_OFF,
+    PVARS_ON,
+    PVARS_LIST
+};
+
+/*
+ * MPI_T cvar sweep of -J NAME=V1:V2[,NAME=V1:V2].  TUNE_NONE marks
+ * benchmarks that do not support it, the others preset TUNE_OFF.
+ */
+enum tune_mode {
+    TUNE_NONE,
+    TUNE_OFF,
+    TUNE_ON
+};
+
+/*
+ * Hardware counters of -Z EVENTS around the loop of every size.
+ * COUNTERS_NONE marks benchmarks that do not support it, the others preset
+ * COUNTERS_OFF.
+ */
+enum counter_mode {
+    COUNTERS_NONE,
+    COUNTERS_OFF,
+    COUNTERS_ON
+};
+
+/*
+ * Clock behind osu_wtime(), TIME() and wtime(), --timer NAME.  TIMER_DEFAULT
+ * keeps MPI_Wtime in the MPI benchmarks and gettimeofday in the PGAS ones.
+ */
+enum timer_type {
+    TIMER_DEFAULT,
+    TIMER_GETTIMEOFDAY,
+    TIMER_MONOTONIC,
+    TIMER_CYCLES
+};
+
+/*
+ * Offsets and drifts of the clocks against rank 0, --global-clock, for one
+ * way latencies and the entry and exit times of collectives.
+ * GLOBAL_CLOCK_NONE marks benchmarks that do not support it, the others
+ * preset GLOBAL_CLOCK_OFF.
+ */
+enum global_clock_mode {
+    GLOBAL_CLOCK_NONE,
+    GLOBAL_CLOCK_OFF,
+    GLOBAL_CLOCK_ON
+};
+
+/*
+ * Blocks of collectives issued back to back without a barrier between them,
+ * --back-to-back[=IMBALANCE].  BACK_TO_BACK_NONE marks benchmarks that do not
+ * support it, the others preset BACK_TO_BACK_OFF.
+ */
+enum back_to_back_mode {
+    BACK_TO_BACK_NONE,
+    BACK_TO_BACK_OFF,
+    BACK_TO_BACK_ON
+};
+
+/*
+ * Arrival skew of --arrival-skew DIST:US[:PARAM], a delay of every rank
+ * before each collective drawn from DIST.  SKEW_NONE marks benchmarks that do
+ * not support it, the others preset SKEW_OFF.
+ */
+enum skew_mode {
+    SKEW_NONE,
+    SKEW_OFF,
+    SKEW_UNIFORM,
+    SKEW_SLOW,
+    SKEW_GAUSSIAN
+};
+
+/*
+ * Count distribution of --counts DIST[:PARAM], the bytes every rank of the v
+ * and w collectives exchanges with every other rank.  COUNTS_NONE marks
+ * benchmarks that do not support it, the others preset COUNTS_UNIFORM.
+ */
+enum count_dist {
+    COUNTS_NONE,
+    COUNTS_UNIFORM,
+    COUNTS_ZIPF,
+    COUNTS_SPARSE,
+    COUNTS_BLOCK
+};
+
+/*
+ * Background traffic of --background PATTERN[:RANKS[:SIZE]], generated by the
+ * last RANKS ranks while the others measure.  BACKGROUND_NONE marks
+ * benchmarks that do not support it.
+ */
+enum background_mode {
+    BACKGROUND_NONE,
+    BACKGROUND_STREAM,
+    BACKGROUND_ALLTOALL
+};
+
+/*
+ * Collective that every group of osu_multi_group runs, --group-op OP.
+ * GROUP_OP_NONE marks benchmarks that do not support it.
+ */
+enum group_op {
+    GROUP_OP_NONE,
+    GROUP_OP_ALLREDUCE,
+    GROUP_OP_BCAST,
+    GROUP_OP_ALLTOALL,
+    GROUP_OP_BARRIER
+};
+
+/*
+ * Wildcards of the receives of osu_tag_match, --wildcard KIND, and the
+ * position of the matching entry in the queue, --order.  TAG_WILDCARD_NONE
+ * marks benchmarks that support neither, the others preset TAG_WILDCARD_OFF.
+ */
+enum tag_wildcard {
+    TAG_WILDCARD_NONE,
+    TAG_WILDCARD_OFF,
+    TAG_WILDCARD_SOURCE,
+    TAG_WILDCARD_TAG,
+    TAG_WILDCARD_BOTH
+};
+
+enum match_order {
+    MATCH_ORDER_TAIL,
+    MATCH_ORDER_HEAD
+};
+
+/*
+ * Send mode of osu_latency and osu_bw, --send-mode MODE.  SEND_MODE_NONE
+ * marks benchmarks that only use the standard mode, the others preset
+ * SEND_MODE_STANDARD.
+ */
+enum send_mode {
+    SEND_MODE_NONE,
+    SEND_MODE_STANDARD,
+    SEND_MODE_SYNC,
+    SEND_MODE_READY,
+    SEND_MODE_BUFFERED,
+    SEND_MODE_PERSISTENT
+};
+
+/*
+ * Timed loop of osu_latency, --loop NAME.  LOOP_FAST is specialized for host
+ * buffers, standard blocking sends and a fixed tag, LOOP_GENERIC handles
+ * every option and LOOP_NULL leaves the messages out to time the harness
+ * alone.  LOOP_NONE marks benchmarks with a single loop, the others preset
+ * LOOP_AUTO, which process_options() resolves to the fast loop whenever the
+ * options allow it.  The header names the loop only after an explicit --loop,
+ * so that the default output stays the same.
+ */
+enum latency_loop {
+    LOOP_NONE,
+    LOOP_AUTO,
+    LOOP_GENERIC,
+    LOOP_FAST,
+    LOOP_NULL
+};
+
+/*
+ * How osu_bw_large and osu_bcast_large pass counts beyond INT_MAX,
+ * --large-count c|datatype.  LARGE_COUNT_NONE marks benchmarks without
+ * large counts; LARGE_COUNT_AUTO takes the MPI-4 _c functions if the
+ * library has them and the derived datatype otherwise.
+ */
+enum large_count {
+    LARGE_COUNT_NONE,
+    LARGE_COUNT_AUTO,
+    LARGE_COUNT_C,
+    LARGE_COUNT_DATATYPE
+};
+
+/*
+ * Time-based streaming of osu_bw, osu_put_bw and osu_mbw_mr, --stream
+ * SECONDS[:SLICE_MS].  STREAM_NONE marks benchmarks that cannot stream, the
+ * others preset STREAM_OFF.
+ */
+enum stream_mode {
+    STREAM_NONE,
+    STREAM_OFF,
+    STREAM_ON
+};
+
+#define DEF_STREAM_SLICE_MS 100
+
+/*
+ * What the forked children of osu_latency_mp do, --child-mode MODE.
+ * CHILD_MODE_NONE marks benchmarks that do not fork, osu_latency_mp presets
+ * CHILD_MODE_SLEEP.
+ */
+enum child_mode {
+    CHILD_MODE_NONE,
+    CHILD_MODE_SLEEP,
+    CHILD_MODE_TOUCH,
+    CHILD_MODE_BUFFERS
+};
+
+/*
+ * File view of the MPI-IO benchmarks, --file-view contiguous|strided.
+ * FILE_VIEW_NONE marks benchmarks without a file, the others preset
+ * FILE_VIEW_CONTIGUOUS.
+ */
+enum file_view {
+    FILE_VIEW_NONE,
+    FILE_VIEW_CONTIGUOUS,
+    FILE_VIEW_STRIDED
+};
+
+/*
+ * Where the pages of the managed buffers are before every timed iteration,
+ * --residency STATE[,STATE...]:
+ *
+ *   fault        on the host, the communication migrates them on demand
+ *   device       prefetched from the host to the device
+ *   host         prefetched from the device to the host
+ *   read-mostly  advised read mostly and prefetched to the device, which
+ *                leaves a read-only copy on the host
+ *   preferred    on the host with the device as preferred location
+ *
+ * options.residency is a mask of 1 << RESIDENCY_*, RESIDENCY_MASK_NONE marks
+ * benchmarks without managed buffers, the others preset RESIDENCY_MASK_ALL.
+ */
+enum residency_state {
+    RESIDENCY_FAULT,
+    RESIDENCY_DEVICE,
+    RESIDENCY_HOST,
+    RESIDENCY_READ_MOSTLY,
+    RESIDENCY_PREFERRED,
+    RESIDENCY_NUM
+};
+
+#define RESIDENCY_MASK_NONE 0
+#define RESIDENCY_MASK_ALL  ((1 << RESIDENCY_NUM) - 1)
+
+/* Group counts of --groups K[,K...] */
+#define MAX_GROUP_COUNTS 32
+
+/* Value of the long options without a short letter */
+#define OPT_TIMER           256
+#define OPT_GLOBAL_CLOCK    257
+#define OPT_BACK_TO_BACK    258
+#define OPT_ARRIVAL_SKEW    259
+#define OPT_BACKGROUND      260
+#define OPT_GROUPS          261
+#define OPT_GROUP_OP        262
+#define OPT_WILDCARD        263
+#define OPT_MATCH_ORDER     264
+#define OPT_SEND_MODE       265
+#define OPT_LARGE_COUNT     266
+#define OPT_STREAM          267
+#define OPT_CHILD_MODE      268
+#define OPT_FILE_VIEW       269
+#define OPT_IO_HINTS        270
+#define OPT_IO_FILE         271
+#define OPT_RESIDENCY       272
+#define OPT_BASELINE        273
+#define OPT_TOLERANCE       274
+#define OPT_FIT             275
+#define OPT_COUNTS          276
+#define OPT_CHECKPOINT      277
+#define OPT_OUTLIERS        278
+#define OPT_LOOP            279
+
+/*
+ * Window mode of the non-blocking collectives, -W WINDOW[:dup]: WINDOW
+ * collectives on disjoint buffers are in flight at once, all on
+ * MPI_COMM_WORLD or each on a duplicate of it.  NBC_WINDOW_NONE marks
+ * benchmarks that do not support -W, the others preset NBC_WINDOW_OFF.
+ */
+#define MAX_NBC_WINDOW  64
+
+enum nbc_window_mode {
+    NBC_WINDOW_NONE,
+    NBC_WINDOW_OFF,
+    NBC_WINDOW_SHARED,
+    NBC_WINDOW_DUP
+};
+
+/*
+ * Datatype and operation of the reduction benchmarks.  DTYPE_NONE marks
+ * benchmarks that do not support -y/-O, the others preset DTYPE_FLOAT.  The
+ * pair types are only valid with the MAXLOC/MINLOC operations.
+ */
+enum reduce_dtype {
+    DTYPE_NONE,
+    DTYPE_FLOAT,
+    DTYPE_DOUBLE,
+    DTYPE_INT,
+    DTYPE_INT64,
+    DTYPE_FLOAT_INT,
+    DTYPE_DOUBLE_INT,
+    DTYPE_2INT
+};
+
+enum reduce_op {
+    OP_SUM,
+    OP_PROD,
+    OP_MAX,
+    OP_MIN,
+    OP_MAXLOC,
+    OP_MINLOC,
+    OP_USER
 };
 
 enum target_type {
@@ -228,7 +855,40 @@ enum test_subtype {
     LAT_MT,
     LAT_MP,
     LAT_DT,
+    LAT_PART,
+    MR_MT,
+    REG_CACHE,
     NBC,
+    PERSISTENT,
+    MATRIX,
+    HALO,
+    COMM_SETUP,
+    NOISE,
+    CONGESTION,
+    MULTI_GROUP,
+    COMM_SCALING,
+    COLL_DT,
+    TAG_MATCH,
+    PROBE_MT,
+    LARGE_COUNT,
+    IO,
+    REDUCE_LOCAL,
+    MANAGED_MEM,
+    GPU_PEER,
+    GPU_PIPELINE,
+    CONTENTION,
+    RMA_MR,
+    ATTACH,
+    WIN_SETUP,
+    SHM_WIN,
+    PGAS_LAT,
+    PGAS_MR,
+    PGAS_NBC,
+    PGAS_MR_WINDOW,
+    PGAS_PROGRESS,
+    PGAS_BW,
+    PGAS_COMPARE,
+    PGAS_DEVICE,
 };
 
 enum test_synctype {
@@ -256,6 +916,45 @@ enum SYNC {
 #endif
 };
 
+/*
+ * Memory of the buffers of the point-to-point OpenSHMEM benchmarks, given as
+ * the operand after the options: the symmetric heap or global (static)
+ * variables.  PGAS_MEMORY_NONE means the benchmark takes no such operand.
+ */
+enum pgas_memory {
+    PGAS_MEMORY_NONE,
+    PGAS_MEMORY_GLOBAL,
+    PGAS_MEMORY_HEAP
+};
+
+/*
+ * Synchronization of the UPC collectives on entry and on exit, set with
+ * -s IN:OUT and mapped to UPC_IN_*SYNC | UPC_OUT_*SYNC by COLL_SYNC_MODE.
+ * PGAS_SYNC_NONE means the benchmark has no such option.  Up to
+ * MAX_PGAS_CHAIN collectives are chained back to back with -W.
+ */
+#define MAX_PGAS_CHAIN  64
+
+enum pgas_sync {
+    PGAS_SYNC_NONE,
+    PGAS_SYNC_ALL,
+    PGAS_SYNC_MY,
+    PGAS_SYNC_NO
+};
+
+/*
+ * Which ranks of osu_rma_mbw_mr are origins and which targets: the two
+ * halves paired up like osu_mbw_mr, rank 0 to all others, all others to
+ * rank 0, or every rank of the first half to every rank of the second.
+ */
+enum rma_pattern {
+    RMA_PATTERN_NONE,
+    RMA_PAIRS,
+    RMA_FANOUT,
+    RMA_FANIN,
+    RMA_MANY
+};
+
 /*variables*/
 extern char const *win_info[20];
 extern char const *sync_info[20];
@@ -274,6 +973,7 @@ struct options_t {
     size_t skip_large;
     size_t window_size_large;
     int num_probes;
+    int progress_thread;
     int device_array_size;
 
     enum benchmark_type bench;
@@ -299,6 +999,99 @@ struct options_t {
     int dt_block_size;
     int dt_stride_size;
     int dt_increase_size;
+    enum dt_layout dt_layout;
+
+    int show_percentiles;
+    enum output_format output_format;
+    struct size_schedule_t schedule;
+    struct convergence_t converge;
+    enum cache_mode cache_mode;
+    size_t cache_pool_size;
+    enum pairing_type pairing;
+    int nodes_per_switch;
+    int show_locality;
+    char const * matrix_file;
+    double outlier_threshold;
+    enum hier_mode hierarchical;
+    enum pipeline_mode pipeline;
+    size_t pipeline_chunk;
+    int pipeline_depth;
+    enum stencil_shape stencil;
+    int stencil_dims;
+    enum coll_backend backend;
+    enum validate_mode validate;
+    enum mem_footprint_mode mem_footprint;
+    enum pvar_mode pvars;
+    char const * pvar_names;
+    enum tune_mode tune;
+    char const * tune_spec;
+    enum counter_mode counters;
+    char const * counter_names;
+    enum timer_type timer;
+    enum global_clock_mode global_clock;
+    enum back_to_back_mode back_to_back;
+    double b2b_imbalance;
+    enum skew_mode skew;
+    double skew_us;
+    double skew_param;
+    enum count_dist count_dist;
+    double count_param;
+    int outlier_top;
+    double outlier_z;
+    enum background_mode background;
+    int background_ranks;
+    size_t background_size;
+    enum group_op group_op;
+    int group_counts[MAX_GROUP_COUNTS];
+    int num_group_counts;
+    enum tag_wildcard wildcard;
+    enum match_order match_order;
+    enum send_mode send_mode;
+    enum latency_loop loop;
+    int show_loop;
+    enum large_count large_count;
+    enum stream_mode stream;
+    double stream_seconds;
+    int stream_slice_ms;
+    enum child_mode child_mode;
+    enum file_view file_view;
+    char const * io_hints;
+    char const * io_file;
+    int residency;
+    enum nbc_window_mode nbc_window_mode;
+    int nbc_window;
+    enum compute_kernel compute_kernel;
+    size_t compute_size;
+    int compute_omp;
+    enum reduce_dtype dtype;
+    enum reduce_op op;
+    int num_partitions;
+    enum thread_comm_mode thread_comm;
+    int thread_comms;
+    int num_buffers;
+    int buffer_churn;
+    int rma_origins;
+    int rma_slots;
+    int win_sweep;
+    int sync_sweep;
+    enum rma_pattern rma_pattern;
+    int rma_inflight;
+    enum pgas_memory pgas_memory;
+    enum pgas_sync sync_in;
+    enum pgas_sync sync_out;
+    int pgas_chain;
+    int bind_cpus[MAX_BIND_CPUS];
+    int num_bind_cpus;
+    int mem_node;
+    enum host_allocator allocator;
+    enum gpu_select_policy gpu_select;
+    int gpu_list[MAX_GPU_LIST];
+    int num_gpu_list;
+    char gpu_nic[GPU_NIC_NAME_LEN];
+    char const * baseline;
+    double tolerance;
+    int fit;
+    char const * checkpoint;
 };
 
 struct bad_usage_t{
@@ -325,8 +1118,354 @@ int setAccel(char);
  */
 void set_header (const char * header);
 void set_benchmark_name (const char * name);
+void set_num_ranks (int nprocs);
 void enable_accel_support (void);
 
+/*
+ * Structured Output
+ *
+ * Every reported data point is a message size plus a list of named metrics.
+ * In OUTPUT_CSV and OUTPUT_JSON mode the human readable table headers are
+ * suppressed and each data point becomes one CSV row or one JSON object per
+ * line, tagged with the benchmark name, rank count and buffer configuration.
+ */
+struct result_metric_t {
+    char const * name;
+    double value;
+};
+
+extern int benchmark_num_ranks;
+
+void output_result (int nprocs, size_t size, int nmetrics,
+                    struct result_metric_t const * metrics);
+void print_result (int size, double value);
+void print_validated_result (int size, double value, size_t errors);
+
+/*
+ * Baseline Comparison
+ *
+ * load_baseline() reads the records of a result file written with -F csv or
+ * -F json.  compare_baseline() is called by the result printers for every
+ * data point: metrics whose name tells whether higher (bandwidth, rates,
+ * speedups) or lower (latencies, times, slowdowns) is better are compared
+ * with the matching record, the others are ignored.  When both sides carry
+ * the samples and stddev_us of their first metric, a regression also has to
+ * pass a Welch t-test at the 95% level.  Regressions are reported on stderr
+ * and make the process exit with EXIT_FAILURE.
+ */
+int load_baseline (char const * path);
+void compare_baseline (int nprocs, size_t size, int nmetrics,
+                       struct result_metric_t const * metrics);
+
+/*
+ * Checkpointing
+ *
+ * With --checkpoint FILE every result record is appended to FILE as a JSON
+ * line, in the format of -F json, with one write(2) as soon as it is known,
+ * so a run that is killed leaves at most a torn last line, which is ignored.
+ * Moving on from a message size appends a completion marker for it.  Records
+ * and markers carry a hash of the options given, except those that only
+ * change the output or the size range.  open_checkpoint() loads the markers
+ * once per path, so the benchmarks of an osu_suite run all see the file as it
+ * was when the run started; a restarted run with the same configuration then
+ * gets the completed sizes skipped by the size iterators.  The first size of
+ * a sweep is always measured again, but its records are not written twice.
+ * All ranks must see FILE at the same path.  The records are written by the
+ * process that reports them, rank 0.
+ */
+int open_checkpoint (char const * path);
+void checkpoint_result (int nprocs, size_t size, int nmetrics,
+                        struct result_metric_t const * metrics);
+int checkpoint_num_ranks (void);
+
+/*
+ * Model Fitting
+ *
+ * With --fit the result printers pass the time of every reported size to
+ * record_model_point() on the rank that prints: latencies for the
+ * alpha-beta model, the time per message of bandwidth and message rate
+ * tests for the LogGP gap g and gap per byte G, and the time the
+ * non-blocking collectives leave uncovered by computation for the LogGP
+ * overhead o.  print_model_fit() fits the points with one line per
+ * protocol regime, reports the parameters and forgets the points; it runs
+ * when the process exits, osu_suite calls it after every benchmark.
+ */
+enum fit_model {
+    FIT_ALPHA_BETA,
+    FIT_LOGGP_GAP,
+    FIT_LOGGP_OVERHEAD
+};
+
+void record_model_point (enum fit_model model, int nprocs, size_t size,
+                         double time_us);
+void print_model_fit (void);
+
+/*
+ * Extra Result Columns
+ *
+ * Columns that the MPI layer fills after every message size, in the order
+ * their options were set up: the MPI_T pvars of -Y, the hardware counters of
+ * -Z, the global clock times of --global-clock, the back to back times of
+ * --back-to-back, the arrival skew times of --arrival-skew, the load balance
+ * of --counts and the slowest ranks of --outliers.  The result printers
+ * append them to their rows, the columns marked INTEGER, such as counts and
+ * rank numbers, without decimals.  NUM is 0 without any of these options.
+ */
+#define MAX_PVAR_COLUMNS    8
+#define MAX_COUNTER_COLUMNS 8
+#define MAX_CLOCK_COLUMNS   3
+#define MAX_B2B_COLUMNS     3
+#define MAX_SKEW_COLUMNS    2
+#define MAX_COUNT_COLUMNS   3
+#define MAX_OUTLIER_COLUMNS 3
+#define MAX_EXTRA_COLUMNS   (MAX_PVAR_COLUMNS + MAX_COUNTER_COLUMNS + \
+        MAX_CLOCK_COLUMNS + MAX_B2B_COLUMNS + MAX_SKEW_COLUMNS + \
+        MAX_COUNT_COLUMNS + MAX_OUTLIER_COLUMNS)
+
+struct extra_columns_t {
+    int num;
+    char name[MAX_EXTRA_COLUMNS][64];
+    int width[MAX_EXTRA_COLUMNS];
+    int integer[MAX_EXTRA_COLUMNS];
+    double value[MAX_EXTRA_COLUMNS];
+};
+
+extern struct extra_columns_t extra_columns;
+
+void print_extra_header (void);
+void print_extra_values (void);
+int add_extra_metrics (struct result_metric_t * metrics, int nmetrics);
+
+/*
+ * Message Size Schedules
+ *
+ * Size loops step with next_message_size() (sizes in bytes) or
+ * next_message_count() (sizes in elements of WIDTH bytes).  Both return a
+ * value past options.max_message_size once the schedule is exhausted.  In
+ * adaptive mode every reported data point must be passed to
+ * record_message_size() on rank 0, and every rank has to call the iterator
+ * the same number of times since refinement points are agreed through
+ * agree_message_size(), which each runtime provides.  Benchmarks that sweep
+ * the sizes more than once call reset_message_sizes() before every sweep.
+ */
+size_t next_message_size (size_t size);
+size_t next_message_count (size_t count, size_t width);
+void record_message_size (size_t size, double value);
+void reset_message_sizes (void);
+void agree_message_size (size_t * size);
+
+/*
+ * Resident Memory
+ *
+ * resident_memory_kb() returns the resident set size of the calling process
+ * in kilobytes, read from /proc/self/statm, or -1 where it is not available.
+ * process_memory_kb() reads the resident set size and its high water mark
+ * (VmRSS and VmHWM of /proc/self/status) in kilobytes and returns 0, or -1
+ * where they are not available.  available_memory_kb() returns MemAvailable
+ * of /proc/meminfo, the memory of the node that can be allocated without
+ * swapping, or -1.
+ */
+long resident_memory_kb (void);
+int process_memory_kb (long * rss, long * hwm);
+long available_memory_kb (void);
+
+/*
+ * Buffer Initialization
+ *
+ * fill_host_buffer() is memset() for buffers of any size: from
+ * FILL_PARALLEL_SIZE bytes on, the OpenMP threads of the process, see
+ * OMP_NUM_THREADS, fill chunks of FILL_CHUNK bytes in parallel, so that a
+ * buffer of gigabytes is set at the memory bandwidth of the node rather than
+ * of one core.  The threads inherit the CPU binding of the rank, so the
+ * pages they touch first stay on its NUMA nodes.  touch_host_buffer() only
+ * writes a zero to one byte of every page, which faults them in, for buffers
+ * whose contents do not matter.  Device buffers are set with set_buffer(),
+ * which takes the device memset of their runtime.
+ */
+#define FILL_PARALLEL_SIZE (8 << 20)
+#define FILL_CHUNK (1 << 20)
+
+void fill_host_buffer (void * buffer, int data, size_t size);
+void touch_host_buffer (void * buffer, size_t size);
+
+/*
+ * Timers
+ *
+ * setup_timer() calibrates the cycle counter against CLOCK_MONOTONIC_RAW and
+ * measures the resolution, the smallest step seen between two calls, and
+ * the overhead per call of the clock chosen with --timer; it returns -1 when
+ * the clock is not available on this platform.  timer_now() reads that clock
+ * in seconds.  print_timer_summary() adds both numbers to the header.
+ */
+struct timer_info_t {
+    double resolution;
+    double overhead;
+    double cycles_per_sec;
+    long base_sec;
+};
+
+extern struct timer_info_t timer_info;
+
+int setup_timer (void);
+double timer_now (void);
+void print_timer_summary (void);
+
+/*
+ * Pair Locality
+ *
+ * After setup_pairing() every rank knows its place in the pairing: vrank is
+ * below num_pairs for senders, in [num_pairs, 2 * num_pairs) for receivers
+ * and beyond for idle ranks, so the multi-pair benchmarks can keep their
+ * block ordering logic and only look up the partner.
+ */
+enum locality_class {
+    LOCALITY_INTRA_SOCKET,
+    LOCALITY_INTER_SOCKET,
+    LOCALITY_INTER_NODE,
+    LOCALITY_INTER_SWITCH,
+    LOCALITY_CLASSES
+};
+
+struct pairing_t {
+    int num_pairs;
+    int vrank;
+    int partner;
+    int locality;
+    int class_pairs[LOCALITY_CLASSES];
+};
+
+extern struct pairing_t pairing;
+
+char const * reduce_dtype_name (void);
+char const * reduce_op_name (void);
+char const * pairing_name (enum pairing_type type);
+char const * thread_comm_name (void);
+char const * send_mode_name (void);
+char const * latency_loop_name (void);
+char const * compute_kernel_name (void);
+char const * host_allocator_name (void);
+char const * dt_layout_name (void);
+char const * rma_pattern_name (void);
+char const * dt_pack_name (char buf_type);
+char const * residency_name (enum residency_state state);
+
+/*
+ * Placement report of setup_affinity(), one line per rank; only set on rank
+ * 0 and only if -b or -N was given.
+ */
+extern char * affinity_placement;
+void print_affinity_summary (void);
+void print_pairing_summary (void);
+void print_stream_header (void);
+void print_locality_header (int ntitles, char const * const * titles,
+                            char const * unit);
+void print_locality_result (int size, int nmetrics,
+                            struct result_metric_t const * metrics,
+                            double const * by_class);
+
+#define DEF_MR_THREADS 8
+#define DEF_PROBE_THREADS 4
+
+#define DEF_REGCACHE_BUFFERS 64
+#define MAX_REGCACHE_BUFFERS 4096
+#define REGCACHE_MAX_MESSAGE_SIZE (1<<20)
+
+/*
+ * The hot counters of osu_fop_contention sit one cache line apart, so origins
+ * on different slots contend for the atomic unit and not for the line.
+ */
+#define DEF_RMA_SLOTS 1
+#define MAX_RMA_SLOTS 4096
+#define RMA_SLOT_SPACING 64
+
+/*
+ * Requests kept in flight by the request-based RMA tests, a benchmark that
+ * leaves rma_inflight at 0 does not take -q.
+ */
+#define DEF_RMA_INFLIGHT 16
+#define MAX_RMA_INFLIGHT MAX_REQ_NUM
+
+/*
+ * osu_win_attach attaches a fresh set of regions every iteration, which is
+ * far slower than a transfer, hence the short loops.
+ */
+#define DEF_ATTACH_REGIONS 64
+#define MAX_ATTACH_REGIONS 4096
+#define ATTACH_MAX_MESSAGE_SIZE (1<<20)
+#define ATTACH_LOOP_SMALL 100
+#define ATTACH_SKIP_SMALL 10
+#define ATTACH_LOOP_LARGE 20
+#define ATTACH_SKIP_LARGE 2
+
+/* osu_win_setup times whole windows, a few of them are plenty */
+#define WIN_SETUP_LOOP 10
+#define WIN_SETUP_SKIP 1
+
+/* osu_comm_setup holds up to this many communicators per step by default */
+#define COMM_SETUP_COUNT 128
+#define COMM_SETUP_SKIP 4
+
+/* osu_noise times this many fixed work quanta per rank by default */
+#define NOISE_QUANTA 1000000
+#define NOISE_SKIP 10000
+
+/* osu_tag_match sweeps the queue depth with -m, 0-byte messages */
+#define TAG_MATCH_MAX_DEPTH 4096
+#define TAG_MATCH_LARGE_DEPTH 256
+#define TAG_MATCH_LOOP 1000
+#define TAG_MATCH_SKIP 10
+#define TAG_MATCH_LOOP_LARGE 100
+#define TAG_MATCH_SKIP_LARGE 5
+
+/*
+ * osu_bw_large and osu_bcast_large sweep from 1 MB to 8 GB, the derived
+ * datatype fallback sends chunks of LARGE_COUNT_CHUNK bytes, and the buffers
+ * may take LARGE_COUNT_MEM_SHARE of the memory available on a node.
+ */
+#define LARGE_COUNT_MIN_SIZE (1 << 20)
+#define LARGE_COUNT_MAX_SIZE ((size_t)1 << 33)
+#define LARGE_COUNT_LOOP 10
+#define LARGE_COUNT_SKIP 2
+#define LARGE_COUNT_WINDOW 4
+#define LARGE_COUNT_CHUNK (1 << 30)
+#define LARGE_COUNT_MEM_SHARE 0.75
+
+/*
+ * The MPI-IO benchmarks write and read a file of BYTES per rank, the strided
+ * view interleaves the ranks in blocks of IO_STRIDE_BLOCK bytes.
+ */
+#define IO_MIN_SIZE 4096
+#define IO_MAX_SIZE (1 << 24)
+#define IO_LOOP 20
+#define IO_SKIP 2
+#define IO_STRIDE_BLOCK 4096
+#define IO_DEF_FILE "osu_io.tmp"
+
+/*
+ * osu_bw_pipeline sweeps the window over messages from 64 KB, with the dummy
+ * compute kernel on arrays of DEVICE_LOAD_ARRAY_SIZE floats busying the GPU
+ * for DEVICE_LOAD_FACTOR times the idle duration of the transfers, scaled
+ * from a calibration run of DEVICE_LOAD_CALIBRATION seconds.
+ */
+#define PIPELINE_MIN_SIZE (1 << 16)
+#define DEVICE_LOAD_ARRAY_SIZE (1 << 20)
+#define DEVICE_LOAD_FACTOR 2.0
+#define DEVICE_LOAD_CALIBRATION 1e-3
+
+/* Defaults of the background traffic of osu_congestion */
+#define BACKGROUND_STREAM_SIZE (1 << 20)
+#define BACKGROUND_ALLTOALL_SIZE (1 << 16)
+#define BACKGROUND_WINDOW 64
+
+#define DEF_PART_THREADS 4
+#define DEF_NUM_PARTITIONS 16
+#define MAX_NUM_PARTITIONS 1024
+#define PART_MIN_MESSAGE_SIZE 1024
+#define PART_LOOP_SMALL 1000
+#define PART_SKIP_SMALL 100
+#define PART_LOOP_LARGE 100
+#define PART_SKIP_LARGE 10
+
 #define DEF_NUM_THREADS 2
 #define MIN_NUM_THREADS 1
 #define MAX_NUM_THREADS 128
@@ -336,6 +1475,56 @@ void enable_accel_support (void);
 #define MAX_NUM_PROCESSES 128
 #define CHILD_SLEEP_SECONDS 2
 
+/*
+ * The writing children of osu_latency_mp touch an inherited heap arena of
+ * this size and allocate and touch a fresh one of the same size per pass.
+ */
+#define CHILD_ARENA_SIZE (64 << 20)
+
+/*
+ * Per-iteration latency histograms
+ *
+ * Samples are kept in nanoseconds.  Values below HIST_SUB_BUCKETS ns get an
+ * exact bucket, larger values are split into HIST_SUB_BUCKETS linear
+ * sub-buckets per power of two, which bounds the relative error of a reported
+ * percentile by 1/HIST_SUB_BUCKETS.
+ */
+#define HIST_SUB_BITS 5
+#define HIST_SUB_BUCKETS (1 << HIST_SUB_BITS)
+#define HIST_MAX_EXPONENT 40
+#define HIST_NUM_BUCKETS (HIST_SUB_BUCKETS * (HIST_MAX_EXPONENT - HIST_SUB_BITS + 2))
+
+struct latency_hist_t {
+    uint64_t count;
+    double min;
+    double max;
+    uint64_t bucket[HIST_NUM_BUCKETS];
+};
+
+extern struct latency_hist_t latency_hist;
+
+void hist_reset (struct latency_hist_t * hist);
+void hist_record (struct latency_hist_t * hist, double seconds);
+double hist_percentile (struct latency_hist_t const * hist, double percentile);
+void record_latency (double seconds);
+
+/*
+ * Running mean and variance of the timed iterations, maintained by
+ * record_latency() and reset after every message size
+ */
+struct sample_stats_t {
+    uint64_t count;
+    double mean;
+    double m2;
+};
+
+extern struct sample_stats_t latency_stats;
+extern double convergence_error;
+
+void stats_reset (struct sample_stats_t * stats);
+void stats_record (struct sample_stats_t * stats, double value);
+double stats_relative_error (struct sample_stats_t const * stats);
+
 #define WINDOW_SIZES {1, 2, 4, 8, 16, 32, 64, 128}
 #define WINDOW_SIZES_COUNT   (8)
 
@@ -9,6 +9,17 @@
  */
 
 #include "osu_util_mpi.h"
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <dirent.h>
+#include <ctype.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 MPI_Request request[MAX_REQ_NUM];
 MPI_Status  reqstat[MAX_REQ_NUM];
@@ -21,17 +32,25 @@ MPI_Aint disp_local;
 /* A is the A in DAXPY for the Compute Kernel */
 #define A 2.0
 #define DEBUG 0
+
 /*
- * We are using a 2-D matrix to perform dummy
- * computation in non-blocking collective benchmarks
+ * Loss of host compute throughput while overlapping, reported next to the
+ * overlap whenever the collective is progressed with -t, by probes or by the
+ * progress thread.
  */
-#define DIM 25
-static float **a, *x, *y;
+#define SHOW_SLOWDOWN   ((options.num_probes || options.progress_thread) && \
+        (CPU == options.target || BOTH == options.target))
+static double compute_slowdown = 0.0;
+static double host_compute_slowdown (int numprocs);
+static void join_progress_thread (void);
+static int buffer_pool_put (void * buffer);
 
 #ifdef _ENABLE_CUDA_
 CUcontext cuContext;
 #endif
 
+static void format_gpu_placement (char * buf, size_t len);
+
 char const *win_info[20] = {
     "MPI_Win_create",
 #if MPI_VERSION >= 3
@@ -51,1460 +70,8941 @@ char const *sync_info[20] = {
 #endif
 };
 
+double osu_wtime (void)
+{
+    return TIMER_DEFAULT == options.timer ? MPI_Wtime() : timer_now();
+}
+
+#ifdef _ENABLE_GPU_KERNEL_
+/*
+ * The dummy compute kernels go round robin to a pool of non-blocking streams
+ * that lives as long as the device arrays.  No stream is created inside the
+ * timed loop, and waiting for the compute waits for these streams only, not
+ * for the streams the MPI library uses to progress the collective.
+ */
+#define GPU_COMPUTE_STREAMS 4
+#define MAX_KERNEL_ITERS (1<<30)
+
 #ifdef _ENABLE_CUDA_KERNEL_
-/* Using new stream for kernels on gpu */
-static cudaStream_t stream;
+typedef cudaStream_t gpu_stream_t;
+typedef cudaEvent_t gpu_event_t;
+#else
+typedef hipStream_t gpu_stream_t;
+typedef hipEvent_t gpu_event_t;
+#endif
+
+static gpu_stream_t compute_stream[GPU_COMPUTE_STREAMS];
+static gpu_event_t calib_start, calib_stop;
+static int next_stream = 0;
+static int pending_streams = 0;
 
 static int is_alloc = 0;
 
 /* Arrays on device for dummy compute */
 static float *d_x, *d_y;
-#endif
 
-void set_device_memory (void * ptr, int data, size_t size)
-{
-#ifdef _ENABLE_OPENACC_
-    size_t i;
-    char * p = (char *)ptr;
+/* Kernel iterations calibrated by init_arrays and their measured duration */
+static int kernel_iters = 1;
+static double kernel_seconds = 0.0;
 #endif
 
-    switch (options.accel) {
+/*
+ * Device Backends
+ *
+ * The checks of the CUDA and ROCm calls exit on failure, so the operations
+ * that return a status only report what the API lets fail quietly: no
+ * device, no context, or no OpenACC memory.
+ */
 #ifdef _ENABLE_CUDA_
-        case CUDA:
-            CUDA_CHECK(cudaMemset(ptr, data, size));
-            break;
-#endif
-#ifdef _ENABLE_OPENACC_
-        case OPENACC:
-#pragma acc parallel copyin(size) deviceptr(p)
-            for(i = 0; i < size; i++) {
-                p[i] = data;
-            }
-            break;
-#endif
-#ifdef _ENABLE_ROCM_
-        case ROCM:
-            ROCM_CHECK(hipMemset(ptr, data, size));
-            break;
-#endif
-        default:
-            break;
-    }
+static int cuda_device_count (int * count)
+{
+    CUDA_CHECK(cudaGetDeviceCount(count));
+
+    return 0;
 }
 
-int free_device_buffer (void * buf)
+static int cuda_set_device (int dev)
 {
-    if (buf == NULL)
-        return 0;
-    switch (options.accel) {
-#ifdef _ENABLE_CUDA_
-        case CUDA:
-            CUDA_CHECK(cudaFree(buf));
-            break;
-#endif
-#ifdef _ENABLE_OPENACC_
-        case OPENACC:
-            acc_free(buf);
-            break;
-#endif
-#ifdef _ENABLE_ROCM_
-        case ROCM:
-            ROCM_CHECK(hipFree(buf));
-            break;
-#endif
-        default:
-            /* unknown device */
-            return 1;
+    CUdevice cuDevice;
+
+    CUDA_CHECK(cudaSetDevice(dev));
+
+    if (CUDA_SUCCESS != cuInit(0) ||
+            CUDA_SUCCESS != cuDeviceGet(&cuDevice, dev) ||
+            CUDA_SUCCESS != cuDevicePrimaryCtxRetain(&cuContext, cuDevice)) {
+        return 1;
     }
 
-    buf = NULL;
     return 0;
 }
 
-void *align_buffer (void * ptr, unsigned long align_size)
+static int cuda_bus_id (int dev, char * bus_id, int len)
 {
-    unsigned long buf = (((unsigned long)ptr + (align_size - 1)) / align_size * align_size);
-    return (void *) buf;
+    return cudaSuccess == cudaDeviceGetPCIBusId(bus_id, len, dev) ? 0 : -1;
 }
 
+static int cuda_finalize (void)
+{
+    /* reset the device to release all resources */
+    CUDA_CHECK(cudaDeviceReset());
+
+    return 0;
+}
 
-void usage_one_sided (char const * name)
+static int cuda_alloc (void ** buffer, size_t size, int managed)
 {
-    if (accel_enabled) {
-        fprintf(stdout, "Usage: %s [options] [SRC DST]\n\n", name);
-        fprintf(stdout, "SRC and DST are buffer types for the source and destination\n");
-        fprintf(stdout, "SRC and DST may be `D' or `H' which specifies whether\n"
-                        "the buffer is allocated on the accelerator device or host\n"
-                        "memory for each mpi rank\n\n");
+    if (managed) {
+        CUDA_CHECK(cudaMallocManaged(buffer, size, cudaMemAttachGlobal));
     } else {
-        fprintf(stdout, "Usage: %s [options]\n", name);
+        CUDA_CHECK(cudaMalloc(buffer, size));
     }
 
-    fprintf(stdout, "Options:\n");
+    return 0;
+}
 
-    if (accel_enabled) {
-        fprintf(stdout, "  -d --accelerator <type>       accelerator device buffers can be of <type> "
-                   "`cuda', `openacc', or `rocm'\n");
-    }
-    fprintf(stdout, "\n");
+static void cuda_release (void * buffer)
+{
+    CUDA_CHECK(cudaFree(buffer));
+}
 
-#if MPI_VERSION >= 3
-    fprintf(stdout, "  -w --win-option <win_option>\n");
-    fprintf(stdout, "            <win_option> can be any of the follows:\n");
-    fprintf(stdout, "            create            use MPI_Win_create to create an MPI Window object\n");
-    if (accel_enabled) {
-        fprintf(stdout, "            allocate          use MPI_Win_allocate to create an MPI Window object (not valid when using device memory)\n");
-    } else {
-        fprintf(stdout, "            allocate          use MPI_Win_allocate to create an MPI Window object\n");
-    }
-    fprintf(stdout, "            dynamic           use MPI_Win_create_dynamic to create an MPI Window object\n");
-    fprintf(stdout, "\n");
-#endif
+static void cuda_memset (void * buffer, int data, size_t size)
+{
+    CUDA_CHECK(cudaMemset(buffer, data, size));
+}
 
-    fprintf(stdout, "  -s, --sync-option <sync_option>\n");
-    fprintf(stdout, "            <sync_option> can be any of the follows:\n");
-    fprintf(stdout, "            pscw              use Post/Start/Complete/Wait synchronization calls \n");
-    fprintf(stdout, "            fence             use MPI_Win_fence synchronization call\n");
-    if (options.synctype == ALL_SYNC) {
-        fprintf(stdout, "            lock              use MPI_Win_lock/unlock synchronizations calls\n");
-#if MPI_VERSION >= 3
-        fprintf(stdout, "            flush             use MPI_Win_flush synchronization call\n");
-        fprintf(stdout, "            flush_local       use MPI_Win_flush_local synchronization call\n");
-        fprintf(stdout, "            lock_all          use MPI_Win_lock_all/unlock_all synchronization calls\n");
-#endif
-    }
-    fprintf(stdout, "\n");
-    if (options.show_size) {
-        fprintf(stdout, "  -m, --message-size          [MIN:]MAX  set the minimum and/or the maximum message size to MIN and/or MAX\n");
-        fprintf(stdout, "                              bytes respectively. Examples:\n");
-        fprintf(stdout, "                              -m 128      // min = default, max = 128\n");
-        fprintf(stdout, "                              -m 2:128    // min = 2, max = 128\n");
-        fprintf(stdout, "                              -m 2:       // min = 2, max = default\n");
-        fprintf(stdout, "  -M, --mem-limit SIZE        set per process maximum memory consumption to SIZE bytes\n");
-        fprintf(stdout, "                              (default %d)\n", MAX_MEM_LIMIT);
-    }
-    fprintf(stdout, "  -x, --warmup ITER           number of warmup iterations to skip before timing"
-                   "(default 100)\n");
-    
-    if(options.subtype == BW) {
-        fprintf(stdout, "  -W, --window-size SIZE      set number of messages to send before synchronization (default 64)\n");
-    }
-    
-    fprintf(stdout, "  -i, --iterations ITER       number of iterations for timing (default 10000)\n");
+static void cuda_memcpy (void * dest, void const * src, size_t size,
+        enum device_copy kind)
+{
+    CUDA_CHECK(cudaMemcpy(dest, src, size, COPY_TO_HOST == kind ?
+                cudaMemcpyDeviceToHost : COPY_TO_DEVICE == kind ?
+                cudaMemcpyHostToDevice : cudaMemcpyDeviceToDevice));
+}
 
-    fprintf(stdout, "  -h, --help                  print this help message\n");
-    fflush(stdout);
+static void cuda_sync (void)
+{
+    CUDA_CHECK(cudaDeviceSynchronize());
 }
 
-int process_one_sided_options (int opt, char *arg)
+static void cuda_stream_create (void ** stream)
 {
-    switch(opt) {
-        case 'w':
-#if MPI_VERSION >= 3
-            if (0 == strcasecmp(arg, "create")) {
-                options.win = WIN_CREATE;
-            } else if (0 == strcasecmp(arg, "allocate")) {
-                options.win = WIN_ALLOCATE;
-            } else if (0 == strcasecmp(arg, "dynamic")) {
-                options.win = WIN_DYNAMIC;
-            } else
-#endif
-            {
-                return PO_BAD_USAGE;
-            }
-            break;
-        case 's':
-            if (0 == strcasecmp(arg, "pscw")) {
-                options.sync = PSCW;
-            } else if (0 == strcasecmp(arg, "fence")) {
-                options.sync = FENCE;
-            } else if (options.synctype== ALL_SYNC) {
-                if (0 == strcasecmp(arg, "lock")) {
-                    options.sync = LOCK;
-                }
-#if MPI_VERSION >= 3
-                else if (0 == strcasecmp(arg, "flush")) {
-                    options.sync = FLUSH;
-                } else if (0 == strcasecmp(arg, "flush_local")) {
-                    options.sync = FLUSH_LOCAL;
-                } else if (0 == strcasecmp(arg, "lock_all")) {
-                    options.sync = LOCK_ALL;
-                }
-#endif
-                else {
-                    return PO_BAD_USAGE;
-                }
-            } else {
-                return PO_BAD_USAGE;
-            }
-            break;
-        default:
-            return PO_BAD_USAGE;
-    }
+    cudaStream_t s;
 
-    return PO_OKAY;
+    CUDA_CHECK(cudaStreamCreateWithFlags(&s, cudaStreamNonBlocking));
+    *stream = s;
 }
 
-void usage_mbw_mr()
+static void cuda_stream_sync (void * stream)
 {
-    if (accel_enabled) {
-        fprintf(stdout, "Usage: osu_mbw_mr [options] [SRC DST]\n\n");
-        fprintf(stdout, "SRC and DST are buffer types for the source and destination\n");
-        fprintf(stdout, "SRC and DST may be `D', `H', or 'M' which specifies whether\n"
-                        "the buffer is allocated on the accelerator device memory, host\n"
-                        "memory or using CUDA Unified memory respectively for each mpi rank\n\n");
-    } else {
-        fprintf(stdout, "Usage: osu_mbw_mr [options]\n");
-    }
+    CUDA_CHECK(cudaStreamSynchronize((cudaStream_t)stream));
+}
 
-    fprintf(stdout, "Options:\n");
-    fprintf(stdout, "  -R=<0,1>, --print-rate         Print uni-directional message rate (default 1)\n");
-    fprintf(stdout, "  -p=<pairs>, --num-pairs        Number of pairs involved (default np / 2)\n");
-    fprintf(stdout, "  -W=<window>, --window-size     Number of messages sent before acknowledgement (default 64)\n");
-    fprintf(stdout, "                                 [cannot be used with -v]\n");
-    fprintf(stdout, "  -V, --vary-window              Vary the window size (default no)\n");
-    fprintf(stdout, "                                 [cannot be used with -W]\n");
-    if (options.show_size) {
-        fprintf(stdout, "  -m, --message-size          [MIN:]MAX  set the minimum and/or the maximum message size to MIN and/or MAX\n");
-        fprintf(stdout, "                              bytes respectively. Examples:\n");
-        fprintf(stdout, "                              -m 128      // min = default, max = 128\n");
-        fprintf(stdout, "                              -m 2:128    // min = 2, max = 128\n");
-        fprintf(stdout, "                              -m 2:       // min = 2, max = default\n");
-        fprintf(stdout, "  -M, --mem-limit SIZE        set per process maximum memory consumption to SIZE bytes\n");
-        fprintf(stdout, "                              (default %d)\n", MAX_MEM_LIMIT);
-    }
-    if (accel_enabled) {
-        fprintf(stdout, "  -d, --accelerator  TYPE     use accelerator device buffers, which can be of TYPE `cuda', \n");
-        fprintf(stdout, "                              `managed', `openacc', or `rocm' (uses standard host buffers if not specified)\n");
-    }
-    fprintf(stdout, "  -h, --help                     Print this help\n");
-    fprintf(stdout, "\n");
-    fprintf(stdout, "  Note: This benchmark relies on block ordering of the ranks.  Please see\n");
-    fprintf(stdout, "        the README for more information.\n");
-    fflush(stdout);
+static void cuda_stream_destroy (void * stream)
+{
+    CUDA_CHECK(cudaStreamDestroy((cudaStream_t)stream));
 }
 
-void print_bad_usage_message (int rank)
+static struct device_backend const cuda_backend = {
+    .name = "cuda",
+    .device_count = cuda_device_count,
+    .set_device = cuda_set_device,
+    .bus_id = cuda_bus_id,
+    .finalize = cuda_finalize,
+    .alloc = cuda_alloc,
+    .release = cuda_release,
+    .memset = cuda_memset,
+    .memcpy = cuda_memcpy,
+    .sync = cuda_sync,
+    .stream_create = cuda_stream_create,
+    .stream_sync = cuda_stream_sync,
+    .stream_destroy = cuda_stream_destroy,
+};
+#endif /* #ifdef _ENABLE_CUDA_ */
+
+#ifdef _ENABLE_ROCM_
+static int rocm_device_count (int * count)
 {
-    if (rank) {
-        return;
-    }
+    ROCM_CHECK(hipGetDeviceCount(count));
 
-    if (bad_usage.optarg) {
-        fprintf(stderr, "%s [-%c %s]\n\n", bad_usage.message,
-                (char)bad_usage.opt, bad_usage.optarg);
-    } else {
-        fprintf(stderr, "%s [-%c]\n\n", bad_usage.message,
-                (char)bad_usage.opt);
-    }
-    fflush(stderr);
+    return 0;
+}
 
-    if (options.bench != ONE_SIDED) {
-        print_help_message(rank);
-    }
+static int rocm_set_device (int dev)
+{
+    ROCM_CHECK(hipSetDevice(dev));
+
+    return 0;
 }
 
-void print_help_message (int rank)
+static int rocm_bus_id (int dev, char * bus_id, int len)
 {
-    if (rank) {
-        return;
-    }
+    return hipSuccess == hipDeviceGetPCIBusId(bus_id, len, dev) ? 0 : -1;
+}
 
-    if (accel_enabled && (options.bench == PT2PT)) {
-        fprintf(stdout, "Usage: %s [options] [SRC DST]\n\n", benchmark_name);
-        fprintf(stdout, "SRC and DST are buffer types for the source and destination\n");
-        fprintf(stdout, "SRC and DST may be `D', `H', or 'M' which specifies whether\n"
-                        "the buffer is allocated on the accelerator device memory, host\n"
-                        "memory or using CUDA Unified memory respectively for each mpi rank\n\n");
-    } else {
-        fprintf(stdout, "Usage: %s [options]\n", benchmark_name);
-        fprintf(stdout, "Options:\n");
-    }
+static int rocm_finalize (void)
+{
+    ROCM_CHECK(hipDeviceReset());
 
-    if (accel_enabled && (options.subtype != LAT_MT) && (options.subtype != LAT_MP)) {
-        fprintf(stdout, "  -d, --accelerator  TYPE     use accelerator device buffers, which can be of TYPE `cuda', \n");
-        fprintf(stdout, "                              `managed', `openacc', or `rocm' (uses standard host buffers if not specified)\n");
-    }
+    return 0;
+}
 
-    if (options.show_size) {
-        fprintf(stdout, "  -m, --message-size          [MIN:]MAX  set the minimum and/or the maximum message size to MIN and/or MAX\n");
-        fprintf(stdout, "                              bytes respectively. Examples:\n");
-        fprintf(stdout, "                              -m 128      // min = default, max = 128\n");
-        fprintf(stdout, "                              -m 2:128    // min = 2, max = 128\n");
-        fprintf(stdout, "                              -m 2:       // min = 2, max = default\n");
-        fprintf(stdout, "  -M, --mem-limit SIZE        set per process maximum memory consumption to SIZE bytes\n");
-        fprintf(stdout, "                              (default %d)\n", MAX_MEM_LIMIT);
+static int rocm_alloc (void ** buffer, size_t size, int managed)
+{
+    if (managed) {
+        ROCM_CHECK(hipMallocManaged(buffer, size, hipMemAttachGlobal));
+    } else {
+        ROCM_CHECK(hipMalloc(buffer, size));
     }
 
-    if (options.subtype == LAT_DT) {
-        fprintf(stdout, "  -B, --dt-block-size SIZE    set block size used by derived datatype (DDT)\n");
-        fprintf(stdout, "  -S, --dt-stride-size SIZE   set base stride size used by derived datatype (DDT)\n");
-        fprintf(stdout, "  -I, --dt-increase-size SIZE set increment stride size used by derived datatype (DDT)\n");
-        fprintf(stdout, "                                  DDT is a vector determined by block size and stride size\n");
-        fprintf(stdout, "                                  repeat count is calculated by (message size / block size)\n");
-        fprintf(stdout, "                                  block size and stride size both have to be smaller then 65536\n");
-    }
+    return 0;
+}
 
-    fprintf(stdout, "  -i, --iterations ITER       set iterations per message size to ITER (default 1000 for small\n");
-    fprintf(stdout, "                              messages, 100 for large messages)\n");
-    fprintf(stdout, "  -x, --warmup ITER           set number of warmup iterations to skip before timing (default 200)\n");
-
-    if (options.subtype == BW) {
-        fprintf(stdout, "  -W, --window-size SIZE      set number of messages to send before synchronization (default 64)\n");
-    }
+static void rocm_release (void * buffer)
+{
+    ROCM_CHECK(hipFree(buffer));
+}
 
-    if (options.bench == COLLECTIVE) {
-        fprintf(stdout, "  -f, --full                  print full format listing (MIN/MAX latency and ITERATIONS\n");
-        fprintf(stdout, "                              displayed in addition to AVERAGE latency)\n");
+static void rocm_memset (void * buffer, int data, size_t size)
+{
+    ROCM_CHECK(hipMemset(buffer, data, size));
+}
 
-        if (options.subtype == NBC) {
-            fprintf(stdout, "  -t, --num_test_calls CALLS  set the number of MPI_Test() calls during the dummy computation, \n");
-            fprintf(stdout, "                              set CALLS to 100, 1000, or any number > 0.\n");
-        }
+static void rocm_memcpy (void * dest, void const * src, size_t size,
+        enum device_copy kind)
+{
+    ROCM_CHECK(hipMemcpy(dest, src, size, COPY_TO_HOST == kind ?
+                hipMemcpyDeviceToHost : COPY_TO_DEVICE == kind ?
+                hipMemcpyHostToDevice : hipMemcpyDeviceToDevice));
+}
 
-        if (CUDA_KERNEL_ENABLED) {
-            fprintf(stdout, "  -r, --cuda-target TARGET    set the compute target for dummy computation\n");
-            fprintf(stdout, "                              set TARGET to cpu (default) to execute \n");
-            fprintf(stdout, "                              on CPU only, set to gpu for executing kernel \n");
-            fprintf(stdout, "                              on the GPU only, and set to both for compute on both.\n");
+static void rocm_sync (void)
+{
+    ROCM_CHECK(hipDeviceSynchronize());
+}
 
-            fprintf(stdout, "  -a, --array-size SIZE       set the size of arrays to be allocated on device (GPU) \n");
-            fprintf(stdout, "                              for dummy compute on device (GPU) (default 32) \n");
-        }
-    }
-    if (LAT_MT == options.subtype) {
-        fprintf(stdout, "  -t, --num_threads           SEND:[RECV]  set the sender and receiver number of threads \n");
-        fprintf(stdout, "                              min: %d default: (receiver threads: %d sender threads: 1), max: %d.\n", MIN_NUM_THREADS, DEF_NUM_THREADS, MAX_NUM_THREADS);
-        fprintf(stdout, "                              Examples: \n");
-        fprintf(stdout, "                              -t 4        // receiver threads = 4 and sender threads = 1\n");
-        fprintf(stdout, "                              -t 4:6      // sender threads = 4 and receiver threads = 6\n");
-        fprintf(stdout, "                              -t 2:       // not defined\n");
-    }
+static void rocm_stream_create (void ** stream)
+{
+    hipStream_t s;
 
-    if (LAT_MP == options.subtype) {
-        fprintf(stdout, "  -t, --num_processes         SEND:[RECV]  set the sender and receiver number of processes \n");
-        fprintf(stdout, "                              min: %d default: (receiver processes: %d sender processes: 1), max: %d.\n",\
-                                                       MIN_NUM_PROCESSES, DEF_NUM_PROCESSES, MAX_NUM_PROCESSES);
-        fprintf(stdout, "                              Examples: \n");
-        fprintf(stdout, "                              -t 4        // receiver processes = 4 and sender processes = 1\n");
-        fprintf(stdout, "                              -t 4:6      // sender processes = 4 and receiver processes = 6\n");
-        fprintf(stdout, "                              -t 2:       // not defined\n");
-    }
+    ROCM_CHECK(hipStreamCreateWithFlags(&s, hipStreamNonBlocking));
+    *stream = s;
+}
 
-    fprintf(stdout, "  -h, --help                  print this help\n");
-    fprintf(stdout, "  -v, --version               print version info\n");
-    fprintf(stdout, "\n");
-    fflush(stdout);
+static void rocm_stream_sync (void * stream)
+{
+    ROCM_CHECK(hipStreamSynchronize((hipStream_t)stream));
 }
 
-void print_help_message_get_acc_lat (int rank)
+static void rocm_stream_destroy (void * stream)
 {
-    if (rank) {
-        return;
-    }
+    ROCM_CHECK(hipStreamDestroy((hipStream_t)stream));
+}
 
-    if (bad_usage.optarg) {
-        fprintf(stderr, "%s [-%c %s]\n\n", bad_usage.message,
-                (char)bad_usage.opt, bad_usage.optarg);
-    } else {
-        fprintf(stderr, "%s [-%c]\n\n", bad_usage.message,
-                (char)bad_usage.opt);
-    }
-    fflush(stderr);
+static struct device_backend const rocm_backend = {
+    .name = "rocm",
+    .device_count = rocm_device_count,
+    .set_device = rocm_set_device,
+    .bus_id = rocm_bus_id,
+    .finalize = rocm_finalize,
+    .alloc = rocm_alloc,
+    .release = rocm_release,
+    .memset = rocm_memset,
+    .memcpy = rocm_memcpy,
+    .sync = rocm_sync,
+    .stream_create = rocm_stream_create,
+    .stream_sync = rocm_stream_sync,
+    .stream_destroy = rocm_stream_destroy,
+};
+#endif /* #ifdef _ENABLE_ROCM_ */
 
-    fprintf(stdout, "Usage: ./osu_get_acc_latency -w <win_option>  -s < sync_option> [-x ITER] [-i ITER]\n");
-    if (options.show_size) {
-        fprintf(stdout, "  -m, --message-size          [MIN:]MAX  set the minimum and/or the maximum message size to MIN and/or MAX\n");
-        fprintf(stdout, "                              bytes respectively. Examples:\n");
-        fprintf(stdout, "                              -m 128      // min = default, max = 128\n");
-        fprintf(stdout, "                              -m 2:128    // min = 2, max = 128\n");
-        fprintf(stdout, "                              -m 2:       // min = 2, max = default\n");
-        fprintf(stdout, "  -M, --mem-limit SIZE        set per process maximum memory consumption to SIZE bytes\n");
-        fprintf(stdout, "                              (default %d)\n", MAX_MEM_LIMIT);
-    }
+#ifdef _ENABLE_OPENACC_
+/* OpenACC has no bus id and no managed memory, its streams are async queues */
+static int openacc_device_count (int * count)
+{
+    *count = acc_get_num_devices(acc_device_not_host);
 
-    fprintf(stdout, "  -x ITER       number of warmup iterations to skip before timing"
-            "(default 100)\n");
-    fprintf(stdout, "  -i ITER       number of iterations for timing (default 10000)\n");
-    fprintf(stdout, "\n");
-    fprintf(stdout, "win_option:\n");
-    fprintf(stdout, "  create            use MPI_Win_create to create an MPI Window object\n");
-    fprintf(stdout, "  allocate          use MPI_Win_allocate to create an MPI Window object\n");
-    fprintf(stdout, "  dynamic           use MPI_Win_create_dynamic to create an MPI Window object\n");
-    fprintf(stdout, "\n");
+    return 0;
+}
 
-    fprintf(stdout, "sync_option:\n");
-    fprintf(stdout, "  lock              use MPI_Win_lock/unlock synchronizations calls\n");
-    fprintf(stdout, "  flush             use MPI_Win_flush synchronization call\n");
-    fprintf(stdout, "  flush_local       use MPI_Win_flush_local synchronization call\n");
-    fprintf(stdout, "  lock_all          use MPI_Win_lock_all/unlock_all synchronization calls\n");
-    fprintf(stdout, "  pscw              use Post/Start/Complete/Wait synchronization calls \n");
-    fprintf(stdout, "  fence             use MPI_Win_fence synchronization call\n");
-    fprintf(stdout, "\n");
+static int openacc_set_device (int dev)
+{
+    acc_set_device_num(dev, acc_device_not_host);
 
-    fflush(stdout);
+    return 0;
 }
 
-void print_header_one_sided (int rank, enum WINDOW win, enum SYNC sync)
+static int openacc_finalize (void)
 {
-    if(rank == 0) {
-        switch (options.accel) {
-            case CUDA:
-                printf(benchmark_header, "-CUDA");
-                break;
-            case OPENACC:
-                printf(benchmark_header, "-OPENACC");
-                break;
-            case ROCM:
-                printf(benchmark_header, "-ROCM");
-                break;
-            default:
-                printf(benchmark_header, "");
-                break;
-        }
-        fprintf(stdout, "# Window creation: %s\n",
-                win_info[win]);
-        fprintf(stdout, "# Synchronization: %s\n",
-                sync_info[sync]);
+    acc_shutdown(acc_device_nvidia);
 
-        switch (options.accel) {
-            case CUDA:
-            case OPENACC:
-            case ROCM:
-                fprintf(stdout, "# Rank 0 Memory on %s and Rank 1 Memory on %s\n",
-                       'M' == options.src ? "MANAGED (M)" : ('D' == options.src ? "DEVICE (D)" : "HOST (H)"),
-                       'M' == options.dst ? "MANAGED (M)" : ('D' == options.dst ? "DEVICE (D)" : "HOST (H)"));
-            default:
-                if (options.subtype == BW) {
-                    fprintf(stdout, "%-*s%*s\n", 10, "# Size", FIELD_WIDTH, "Bandwidth (MB/s)");
-                } else {
-                    fprintf(stdout, "%-*s%*s\n", 10, "# Size", FIELD_WIDTH, "Latency (us)");
-                }
-                fflush(stdout);
-        }
-    }
+    return 0;
 }
 
-void print_version_message (int rank)
+static int openacc_alloc (void ** buffer, size_t size, int managed)
 {
-    if (rank) {
-        return;
-    }
+    *buffer = managed ? NULL : acc_malloc(size);
 
-    switch (options.accel) {
-        case CUDA:
-            printf(benchmark_header, "-CUDA");
-            break;
-        case OPENACC:
-            printf(benchmark_header, "-OPENACC");
-            break;
-        case MANAGED:
-            printf(benchmark_header, "-CUDA MANAGED");
-            break;
-        case ROCM:
-            printf(benchmark_header, "-ROCM");
-            break;
-        default:
-            printf(benchmark_header, "");
-            break;
-    }
+    return NULL == *buffer;
+}
 
-    fflush(stdout);
+static void openacc_release (void * buffer)
+{
+    acc_free(buffer);
 }
 
-void print_preamble_nbc (int rank)
+static void openacc_memset (void * buffer, int data, size_t size)
 {
-    if (rank) {
-        return;
+    size_t i;
+    char * p = (char *)buffer;
+
+    #pragma acc parallel loop deviceptr(p)
+    for (i = 0; i < size; i++) {
+        p[i] = data;
     }
+}
 
-    fprintf(stdout, "\n");
+static void openacc_memcpy (void * dest, void const * src, size_t size,
+        enum device_copy kind)
+{
+    size_t i;
+    char * d = (char *)dest;
+    char const * s = (char const *)src;
 
-    switch (options.accel) {
-        case CUDA:
-            printf(benchmark_header, "-CUDA");
-            break;
-        case OPENACC:
-            printf(benchmark_header, "-OPENACC");
+    switch (kind) {
+        case COPY_TO_HOST:
+            acc_memcpy_from_device(dest, (void *)src, size);
             break;
-        case MANAGED:
-            printf(benchmark_header, "-MANAGED");
-            break;
-        case ROCM:
-            printf(benchmark_header, "-ROCM");
+        case COPY_TO_DEVICE:
+            acc_memcpy_to_device(dest, (void *)src, size);
             break;
         default:
-            printf(benchmark_header, "");
+            /* acc_memcpy_device is OpenACC 2.6, a loop works everywhere */
+            #pragma acc parallel loop deviceptr(d, s)
+            for (i = 0; i < size; i++) {
+                d[i] = s[i];
+            }
             break;
     }
+}
 
-    fprintf(stdout, "# Overall = Coll. Init + Compute + MPI_Test + MPI_Wait\n\n");
+static void openacc_sync (void)
+{
+    acc_wait_all();
+}
 
-    if (options.show_size) {
-        fprintf(stdout, "%-*s", 10, "# Size");
-        fprintf(stdout, "%*s", FIELD_WIDTH, "Overall(us)");
-    } else {
-        fprintf(stdout, "%*s", FIELD_WIDTH, "Overall(us)");
-    }
+static void openacc_stream_create (void ** stream)
+{
+    static intptr_t next_queue = 1;
 
-    if (options.show_full) {
-        fprintf(stdout, "%*s", FIELD_WIDTH, "Compute(us)");
-        fprintf(stdout, "%*s", FIELD_WIDTH, "Coll. Init(us)");
-        fprintf(stdout, "%*s", FIELD_WIDTH, "MPI_Test(us)");
-        fprintf(stdout, "%*s", FIELD_WIDTH, "MPI_Wait(us)");
-        fprintf(stdout, "%*s", FIELD_WIDTH, "Pure Comm.(us)");
-        fprintf(stdout, "%*s\n", FIELD_WIDTH, "Overlap(%)");
+    *stream = (void *)next_queue++;
+}
 
-    } else {
-        fprintf(stdout, "%*s", FIELD_WIDTH, "Compute(us)");
-        fprintf(stdout, "%*s", FIELD_WIDTH, "Pure Comm.(us)");
-        fprintf(stdout, "%*s\n", FIELD_WIDTH, "Overlap(%)");
-    }
+static void openacc_stream_sync (void * stream)
+{
+    acc_wait((int)(intptr_t)stream);
+}
 
-    fflush(stdout);
+static void openacc_stream_destroy (void * stream)
+{
+    acc_wait((int)(intptr_t)stream);
 }
 
-void display_nbc_params()
+static struct device_backend const openacc_backend = {
+    .name = "openacc",
+    .device_count = openacc_device_count,
+    .set_device = openacc_set_device,
+    .bus_id = NULL,
+    .finalize = openacc_finalize,
+    .alloc = openacc_alloc,
+    .release = openacc_release,
+    .memset = openacc_memset,
+    .memcpy = openacc_memcpy,
+    .sync = openacc_sync,
+    .stream_create = openacc_stream_create,
+    .stream_sync = openacc_stream_sync,
+    .stream_destroy = openacc_stream_destroy,
+};
+#endif /* #ifdef _ENABLE_OPENACC_ */
+
+#ifdef _ENABLE_SYCL_
+/*
+ * SYCL buffers are Level Zero USM allocations on the devices of the first
+ * GPU driver, in a context of their own.  The fills and copies go through a
+ * synchronous immediate command list and are complete when they return, the
+ * streams are asynchronous immediate command lists.
+ */
+#define LEVEL_ZERO_ALIGNMENT 64
+
+static struct {
+    ze_driver_handle_t driver;
+    ze_device_handle_t * devices;
+    uint32_t count;
+    ze_device_handle_t device;
+    ze_context_handle_t context;
+    ze_command_list_handle_t list;
+} level_zero;
+
+static void level_zero_release_context (void)
 {
-    if (options.show_full) {
-        fprintf(stdout, "%*s", FIELD_WIDTH, "Compute(us)");
-        fprintf(stdout, "%*s", FIELD_WIDTH, "Coll. Init(us)");
-        fprintf(stdout, "%*s", FIELD_WIDTH, "MPI_Test(us)");
-        fprintf(stdout, "%*s", FIELD_WIDTH, "MPI_Wait(us)");
-        fprintf(stdout, "%*s", FIELD_WIDTH, "Pure Comm.(us)");
-        fprintf(stdout, "%*s\n", FIELD_WIDTH, "Overlap(%)");
+    if (NULL != level_zero.list) {
+        ZE_CHECK(zeCommandListDestroy(level_zero.list));
+        level_zero.list = NULL;
+    }
 
-    } else {
-        fprintf(stdout, "%*s", FIELD_WIDTH, "Compute(us)");
-        fprintf(stdout, "%*s", FIELD_WIDTH, "Pure Comm.(us)");
-        fprintf(stdout, "%*s\n", FIELD_WIDTH, "Overlap(%)");
+    if (NULL != level_zero.context) {
+        ZE_CHECK(zeContextDestroy(level_zero.context));
+        level_zero.context = NULL;
     }
 }
 
-void print_preamble (int rank)
+static int level_zero_device_count (int * count)
 {
-    if (rank) {
-        return;
-    }
+    uint32_t drivers = 1;
 
-    fprintf(stdout, "\n");
+    *count = 0;
 
-    switch (options.accel) {
-        case CUDA:
-            printf(benchmark_header, "-CUDA");
-            break;
-        case OPENACC:
-            printf(benchmark_header, "-OPENACC");
-            break;
-        case ROCM:
-            printf(benchmark_header, "-ROCM");
-            break;
-        default:
-            printf(benchmark_header, "");
-            break;
+    if (ZE_RESULT_SUCCESS != zeInit(ZE_INIT_FLAG_GPU_ONLY) ||
+            ZE_RESULT_SUCCESS != zeDriverGet(&drivers, &level_zero.driver) ||
+            0 == drivers) {
+        return 1;
     }
 
-    if (options.show_size) {
-        fprintf(stdout, "%-*s", 10, "# Size");
-        fprintf(stdout, "%*s", FIELD_WIDTH, "Avg Latency(us)");
-    } else {
-        fprintf(stdout, "# Avg Latency(us)");
-    }
+    if (NULL == level_zero.devices) {
+        ZE_CHECK(zeDeviceGet(level_zero.driver, &level_zero.count, NULL));
 
-    if (options.show_full) {
-        fprintf(stdout, "%*s", FIELD_WIDTH, "Min Latency(us)");
-        fprintf(stdout, "%*s", FIELD_WIDTH, "Max Latency(us)");
-        fprintf(stdout, "%*s\n", 12, "Iterations");
-    } else {
-        fprintf(stdout, "\n");
+        level_zero.devices = malloc(MAX(1, level_zero.count) *
+                sizeof(*level_zero.devices));
+        if (NULL == level_zero.devices) {
+            return 1;
+        }
+
+        ZE_CHECK(zeDeviceGet(level_zero.driver, &level_zero.count,
+                    level_zero.devices));
     }
 
-    fflush(stdout);
+    *count = level_zero.count;
+
+    return 0;
 }
 
-void calculate_and_print_stats(int rank, int size, int numprocs,
-                          double timer, double latency,
-                          double test_time, double cpu_time,
-                          double wait_time, double init_time)
+static int level_zero_set_device (int dev)
 {
-    double test_total   = (test_time * 1e6) / options.iterations;
-    double tcomp_total  = (cpu_time * 1e6) / options.iterations;
-    double overall_time = (timer * 1e6) / options.iterations;
-    double wait_total   = (wait_time * 1e6) / options.iterations;
-    double init_total   = (init_time * 1e6) / options.iterations;
-    double comm_time   = latency;
-
-    if(rank != 0) {
-        MPI_CHECK(MPI_Reduce(&test_total, &test_total, 1, MPI_DOUBLE, MPI_SUM, 0,
-                   MPI_COMM_WORLD));
-        MPI_CHECK(MPI_Reduce(&comm_time, &comm_time, 1, MPI_DOUBLE, MPI_SUM, 0,
-                   MPI_COMM_WORLD));
-        MPI_CHECK(MPI_Reduce(&overall_time, &overall_time, 1, MPI_DOUBLE, MPI_SUM, 0,
-                   MPI_COMM_WORLD));
-        MPI_CHECK(MPI_Reduce(&tcomp_total, &tcomp_total, 1, MPI_DOUBLE, MPI_SUM, 0,
-                   MPI_COMM_WORLD));
-        MPI_CHECK(MPI_Reduce(&wait_total, &wait_total, 1, MPI_DOUBLE, MPI_SUM, 0,
-                   MPI_COMM_WORLD));
-        MPI_CHECK(MPI_Reduce(&init_total, &init_total, 1, MPI_DOUBLE, MPI_SUM, 0,
-                   MPI_COMM_WORLD));
-    } else {
-        MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, &test_total, 1, MPI_DOUBLE, MPI_SUM, 0,
-                   MPI_COMM_WORLD));
-        MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, &comm_time, 1, MPI_DOUBLE, MPI_SUM, 0,
-                   MPI_COMM_WORLD));
-        MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, &overall_time, 1, MPI_DOUBLE, MPI_SUM, 0,
-                   MPI_COMM_WORLD));
-        MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, &tcomp_total, 1, MPI_DOUBLE, MPI_SUM, 0,
-                   MPI_COMM_WORLD));
-        MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, &wait_total, 1, MPI_DOUBLE, MPI_SUM, 0,
-                   MPI_COMM_WORLD));
-        MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, &init_total, 1, MPI_DOUBLE, MPI_SUM, 0,
-                   MPI_COMM_WORLD));
-    }
+    ze_context_desc_t context_desc = {ZE_STRUCTURE_TYPE_CONTEXT_DESC};
+    ze_command_queue_desc_t queue_desc = {
+        ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC};
 
-    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+    /* A second selection, by rebind_accel, replaces the first */
+    level_zero_release_context();
 
-    /* Overall Time (Overlapped) */
-    overall_time = overall_time/numprocs;
-    /* Computation Time */
-    tcomp_total = tcomp_total/numprocs;
-    /* Time taken by MPI_Test calls */
-    test_total = test_total/numprocs;
-    /* Pure Communication Time */
-    comm_time = comm_time/numprocs;
-    /* Time for MPI_Wait() call */
-    wait_total = wait_total/numprocs;
-    /* Time for the NBC call */
-    init_total = init_total/numprocs;
+    level_zero.device = level_zero.devices[dev];
+    queue_desc.mode = ZE_COMMAND_QUEUE_MODE_SYNCHRONOUS;
 
-    print_stats_nbc(rank, size, overall_time, tcomp_total, comm_time,
-                    wait_total, init_total, test_total);
+    ZE_CHECK(zeContextCreate(level_zero.driver, &context_desc,
+                &level_zero.context));
+    ZE_CHECK(zeCommandListCreateImmediate(level_zero.context,
+                level_zero.device, &queue_desc, &level_zero.list));
 
+    return 0;
 }
 
-void print_stats_nbc (int rank, int size, double overall_time,
-                 double cpu_time, double comm_time,
-                 double wait_time, double init_time,
-                 double test_time)
+static int level_zero_bus_id (int dev, char * bus_id, int len)
 {
-    if (rank) {
-        return;
+    ze_pci_ext_properties_t pci = {ZE_STRUCTURE_TYPE_PCI_EXT_PROPERTIES};
+
+    if (ZE_RESULT_SUCCESS != zeDevicePciGetPropertiesExt(
+                level_zero.devices[dev], &pci)) {
+        return -1;
     }
 
-    double overlap;
+    snprintf(bus_id, len, "%04x:%02x:%02x.%x", pci.address.domain,
+            pci.address.bus, pci.address.device, pci.address.function);
 
-    /* Note : cpu_time received in this function includes time for
-       *      dummy compute as well as test calls so we will subtract
-       *      the test_time for overlap calculation as test is an
-       *      overhead
-       */
+    return 0;
+}
 
-    overlap = MAX(0, 100 - (((overall_time - (cpu_time - test_time)) / comm_time) * 100));
+static int level_zero_finalize (void)
+{
+    level_zero_release_context();
 
-    if (options.show_size) {
-        fprintf(stdout, "%-*d", 10, size);
-        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, overall_time);
-    } else {
-        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, overall_time);
-    }
+    free(level_zero.devices);
+    level_zero.devices = NULL;
 
-    if (options.show_full) {
-        fprintf(stdout, "%*.*f%*.*f%*.*f%*.*f%*.*f%*.*f\n",
-                FIELD_WIDTH, FLOAT_PRECISION, (cpu_time - test_time),
-                FIELD_WIDTH, FLOAT_PRECISION, init_time,
-                FIELD_WIDTH, FLOAT_PRECISION, test_time,
-                FIELD_WIDTH, FLOAT_PRECISION, wait_time,
-                FIELD_WIDTH, FLOAT_PRECISION, comm_time,
-                FIELD_WIDTH, FLOAT_PRECISION, overlap);
+    return 0;
+}
+
+static int level_zero_alloc (void ** buffer, size_t size, int managed)
+{
+    ze_device_mem_alloc_desc_t device_desc = {
+        ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC};
+    ze_host_mem_alloc_desc_t host_desc = {
+        ZE_STRUCTURE_TYPE_HOST_MEM_ALLOC_DESC};
+
+    /* Level Zero rejects empty allocations */
+    size = MAX(1, size);
+
+    if (managed) {
+        ZE_CHECK(zeMemAllocShared(level_zero.context, &device_desc,
+                    &host_desc, size, LEVEL_ZERO_ALIGNMENT, level_zero.device,
+                    buffer));
     } else {
-        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, (cpu_time - test_time));
-        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, comm_time);
-        fprintf(stdout, "%*.*f\n", FIELD_WIDTH, FLOAT_PRECISION, overlap);
+        ZE_CHECK(zeMemAllocDevice(level_zero.context, &device_desc, size,
+                    LEVEL_ZERO_ALIGNMENT, level_zero.device, buffer));
     }
 
-    fflush(stdout);
+    return 0;
 }
 
-void print_stats (int rank, int size, double avg_time, double min_time, double max_time)
+static void level_zero_release (void * buffer)
 {
-    if (rank) {
-        return;
-    }
+    ZE_CHECK(zeMemFree(level_zero.context, buffer));
+}
 
-    if (options.show_size) {
-        fprintf(stdout, "%-*d", 10, size);
-        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, avg_time);
-    } else {
-        fprintf(stdout, "%*.*f", 17, FLOAT_PRECISION, avg_time);
-    }
+static void level_zero_memset (void * buffer, int data, size_t size)
+{
+    unsigned char pattern = data;
 
-    if (options.show_full) {
-        fprintf(stdout, "%*.*f%*.*f%*lu\n",
-                FIELD_WIDTH, FLOAT_PRECISION, min_time,
-                FIELD_WIDTH, FLOAT_PRECISION, max_time,
-                12, options.iterations);
-    } else {
-        fprintf(stdout, "\n");
-    }
+    ZE_CHECK(zeCommandListAppendMemoryFill(level_zero.list, buffer, &pattern,
+                sizeof(pattern), size, NULL, 0, NULL));
+}
 
-    fflush(stdout);
+static void level_zero_memcpy (void * dest, void const * src, size_t size,
+        enum device_copy kind)
+{
+    /* USM pointers tell the direction themselves */
+    (void)kind;
+
+    ZE_CHECK(zeCommandListAppendMemoryCopy(level_zero.list, dest, src, size,
+                NULL, 0, NULL));
 }
 
-void set_buffer_pt2pt (void * buffer, int rank, enum accel_type type, int data, size_t size)
+static void level_zero_sync (void)
 {
-    char buf_type = 'H';
+    ZE_CHECK(zeCommandListHostSynchronize(level_zero.list, UINT64_MAX));
+}
 
-    if (options.bench == MBW_MR) {
-        buf_type = (rank < options.pairs) ? options.src : options.dst;
-    } else {
-        buf_type = (rank == 0) ? options.src : options.dst;
-    }
+static void level_zero_stream_create (void ** stream)
+{
+    ze_command_queue_desc_t queue_desc = {
+        ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC};
+    ze_command_list_handle_t list;
 
-    switch (buf_type) {
-        case 'H':
-            memset(buffer, data, size);
-            break;
-        case 'D':
-        case 'M':
-#ifdef _ENABLE_OPENACC_
-            if (type == OPENACC) {
-                size_t i;
-                char * p = (char *)buffer;
-                #pragma acc parallel loop deviceptr(p)
-                for (i = 0; i < size; i++) {
-                    p[i] = data;
-                }
-                break;
-            } else
-#endif
-#ifdef _ENABLE_CUDA_
-            {
-                CUDA_CHECK(cudaMemset(buffer, data, size));
-            }
-#endif
-#ifdef _ENABLE_ROCM_
-            {
-                ROCM_CHECK(hipMemset(buffer, data, size));
-            }
-#endif
-            break;
-    }
+    queue_desc.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+
+    ZE_CHECK(zeCommandListCreateImmediate(level_zero.context,
+                level_zero.device, &queue_desc, &list));
+    *stream = list;
 }
 
-void set_buffer (void * buffer, enum accel_type type, int data, size_t size)
+static void level_zero_stream_sync (void * stream)
 {
-#ifdef _ENABLE_OPENACC_
-    size_t i;
-    char * p = (char *)buffer;
-#endif
-    switch (type) {
-        case NONE:
-            memset(buffer, data, size);
-            break;
-        case CUDA:
-        case MANAGED:
-#ifdef _ENABLE_CUDA_
-            CUDA_CHECK(cudaMemset(buffer, data, size));
-#endif
-            break;
-        case OPENACC:
-#ifdef _ENABLE_OPENACC_
-            #pragma acc parallel loop deviceptr(p)
-            for (i = 0; i < size; i++) {
-                p[i] = data;
-            }
-#endif
-            break;
-        case ROCM:
-#ifdef _ENABLE_ROCM_
-            ROCM_CHECK(hipMemset(buffer, data, size));
-#endif
-            break;
-    }
+    ZE_CHECK(zeCommandListHostSynchronize((ze_command_list_handle_t)stream,
+                UINT64_MAX));
 }
 
-int allocate_memory_coll (void ** buffer, size_t size, enum accel_type type)
+static void level_zero_stream_destroy (void * stream)
 {
-    if (options.target == CPU || options.target == BOTH) {
-        allocate_host_arrays();
-    }
+    ZE_CHECK(zeCommandListDestroy((ze_command_list_handle_t)stream));
+}
 
-    size_t alignment = sysconf(_SC_PAGESIZE);
+static struct device_backend const level_zero_backend = {
+    .name = "sycl",
+    .device_count = level_zero_device_count,
+    .set_device = level_zero_set_device,
+    .bus_id = level_zero_bus_id,
+    .finalize = level_zero_finalize,
+    .alloc = level_zero_alloc,
+    .release = level_zero_release,
+    .memset = level_zero_memset,
+    .memcpy = level_zero_memcpy,
+    .sync = level_zero_sync,
+    .stream_create = level_zero_stream_create,
+    .stream_sync = level_zero_stream_sync,
+    .stream_destroy = level_zero_stream_destroy,
+};
+#endif /* #ifdef _ENABLE_SYCL_ */
 
+struct device_backend const * device_backend (enum accel_type type)
+{
     switch (type) {
-        case NONE:
-            return posix_memalign(buffer, alignment, size);
 #ifdef _ENABLE_CUDA_
         case CUDA:
-            CUDA_CHECK(cudaMalloc(buffer, size));
-            return 0;
         case MANAGED:
-            CUDA_CHECK(cudaMallocManaged(buffer, size, cudaMemAttachGlobal));
-            return 0;
+            return &cuda_backend;
 #endif
 #ifdef _ENABLE_OPENACC_
         case OPENACC:
-            *buffer = acc_malloc(size);
-            if (NULL == *buffer) {
-                return 1;
-            } else {
-                return 0;
-            }
+            return &openacc_backend;
 #endif
 #ifdef _ENABLE_ROCM_
         case ROCM:
-            ROCM_CHECK(hipMalloc(buffer, size));
-            return 0;
+            return &rocm_backend;
+#endif
+#ifdef _ENABLE_SYCL_
+        case SYCL:
+            return &level_zero_backend;
 #endif
         default:
-            return 1;
+            return NULL;
     }
 }
 
-int allocate_device_buffer (char ** buffer, size_t buffer_size)
+#ifdef _ENABLE_GPU_KERNEL_
+/* Whether the kernels of kernel.cu or kernel_rocm.hip run on TYPE buffers */
+static int device_kernels (enum accel_type type)
 {
-    switch (options.accel) {
-#ifdef _ENABLE_CUDA_
-        case CUDA:
-             CUDA_CHECK(cudaMalloc((void **)buffer, buffer_size));
-            break;
-#endif
-#ifdef _ENABLE_OPENACC_
-        case OPENACC:
-            *buffer = acc_malloc(buffer_size);
-            if (NULL == *buffer) {
-                fprintf(stderr, "Could not allocate device memory\n");
-                return 1;
-            }
-            break;
-#endif
-#ifdef _ENABLE_ROCM_
-        case ROCM:
-             ROCM_CHECK(hipMalloc((void **)buffer, buffer_size));
-            break;
-#endif
-        default:
-            fprintf(stderr, "Could not allocate device memory\n");
-            return 1;
-    }
-
-    return 0;
+    return CUDA_KERNEL_ENABLED ? CUDA == type || MANAGED == type :
+        ROCM == type;
 }
 
-int allocate_device_buffer_one_sided (char ** buffer, size_t size)
+/* Backend of the API the kernels were built for, whatever -d selects */
+static struct device_backend const * kernel_backend (void)
 {
-    switch (options.accel) {
-#ifdef _ENABLE_CUDA_
-        case CUDA:
-            CUDA_CHECK(cudaMalloc((void **)buffer, size));
-            break;
-        case MANAGED:
-            CUDA_CHECK(cudaMallocManaged((void **)buffer, size, cudaMemAttachGlobal));
-            break;
-#endif
-#ifdef _ENABLE_OPENACC_
-        case OPENACC:
-            *buffer = acc_malloc(size);
-            if (NULL == *buffer) {
-                fprintf(stderr, "Could not allocate device memory\n");
-                return 1;
-            }
-            break;
-#endif
-#ifdef _ENABLE_ROCM_
-        case ROCM:
-             ROCM_CHECK(hipMalloc((void **)buffer, size));
-            break;
+    return device_backend(CUDA_KERNEL_ENABLED ? CUDA : ROCM);
+}
 #endif
-        default:
-            fprintf(stderr, "Could not allocate device memory\n");
-            return 1;
-    }
 
-    return 0;
+void set_device_memory (void * ptr, int data, size_t size)
+{
+    struct device_backend const * device = device_backend(options.accel);
+
+    if (NULL != device) {
+        device->memset(ptr, data, size);
+    }
 }
 
-int allocate_managed_buffer (char ** buffer, size_t buffer_size)
+int free_device_buffer (void * buf)
 {
-    switch (options.accel) {
-#ifdef _ENABLE_CUDA_
-        case CUDA:
-            CUDA_CHECK(cudaMallocManaged((void **)buffer, buffer_size, cudaMemAttachGlobal));
-            break;
-#endif
-        default:
-            fprintf(stderr, "Could not allocate device memory\n");
-            return 1;
+    struct device_backend const * device = device_backend(options.accel);
+
+    if (buf == NULL || buffer_pool_put(buf))
+        return 0;
 
+    if (NULL == device) {
+        /* unknown device */
+        return 1;
     }
+
+    device->release(buf);
+
     return 0;
 }
 
-int allocate_memory_pt2pt_mul (char ** sbuf, char ** rbuf, int rank, int pairs)
+void *align_buffer (void * ptr, unsigned long align_size)
 {
-    unsigned long align_size = sysconf(_SC_PAGESIZE);
-    size_t buffer_size = options.max_message_size;
-    int rep_count;
-    if (options.subtype == LAT_DT) {
-        if (options.dt_increase_size == 0)
-            rep_count = 0;
-        else
-            rep_count = options.max_message_size / options.dt_block_size;
-        buffer_size = options.max_message_size * options.dt_stride_size / options.dt_block_size +
+    unsigned long buf = (((unsigned long)ptr + (align_size - 1)) / align_size * align_size);
+    return (void *) buf;
+}
+
+
+void usage_one_sided (char const * name)
+{
+    if (accel_enabled) {
+        fprintf(stdout, "Usage: %s [options] [SRC DST]\n\n", name);
+        fprintf(stdout, "SRC and DST are buffer types for the source and destination\n");
+        fprintf(stdout, "SRC and DST may be `D' or `H' which specifies whether\n"
+                        "the buffer is allocated on the accelerator device or host\n"
+                        "memory for each mpi rank\n\n");
+    } else {
+        fprintf(stdout, "Usage: %s [options]\n", name);
+    }
+
+    fprintf(stdout, "Options:\n");
+
+    if (accel_enabled) {
+        fprintf(stdout, "  -d --accelerator <type>       accelerator device buffers can be of <type> "
+                   "`cuda', `openacc', `rocm', or `sycl'\n");
+        fprintf(stdout, "  -g --gpu-select <policy>      pick the GPU of each local rank: rank (default), "
+                   "list:D0[,D1...], nic or nic:NAME\n");
+    }
+    fprintf(stdout, "\n");
+
+    /*
+     * osu_win_attach always uses MPI_Win_create_dynamic and osu_win_shared
+     * MPI_Win_allocate_shared, both under lock_all
+     */
+    if (options.subtype != ATTACH && options.subtype != SHM_WIN) {
+#if MPI_VERSION >= 3
+        fprintf(stdout, "  -w --win-option <win_option>\n");
+        fprintf(stdout, "            <win_option> can be any of the follows:\n");
+        if (options.subtype == CONTENTION || options.subtype == WIN_SETUP) {
+            fprintf(stdout, "            all               run every window creation mode below (default)\n");
+        } else if (options.subtype == RMA_MR) {
+            fprintf(stdout, "            all               run every window creation mode below\n");
+        }
+        fprintf(stdout, "            create            use MPI_Win_create to create an MPI Window object\n");
+        if (accel_enabled) {
+            fprintf(stdout, "            allocate          use MPI_Win_allocate to create an MPI Window object (not valid when using device memory)\n");
+        } else {
+            fprintf(stdout, "            allocate          use MPI_Win_allocate to create an MPI Window object\n");
+        }
+        fprintf(stdout, "            dynamic           use MPI_Win_create_dynamic to create an MPI Window object\n");
+        fprintf(stdout, "\n");
+#endif
+
+        fprintf(stdout, "  -s, --sync-option <sync_option>\n");
+        fprintf(stdout, "            <sync_option> can be any of the follows:\n");
+        if (options.subtype == CONTENTION || options.subtype == RMA_MR) {
+            fprintf(stdout, "            all               run every synchronization mode below (default)\n");
+        } else if (options.subtype == WIN_SETUP) {
+            fprintf(stdout, "            all               run every synchronization mode below\n");
+        }
+        /* Request-based operations are only valid in passive target epochs */
+        if (!options.rma_inflight) {
+            fprintf(stdout, "            pscw              use Post/Start/Complete/Wait synchronization calls \n");
+            fprintf(stdout, "            fence             use MPI_Win_fence synchronization call\n");
+        }
+        if (options.synctype == ALL_SYNC) {
+            fprintf(stdout, "            lock              use MPI_Win_lock/unlock synchronizations calls\n");
+#if MPI_VERSION >= 3
+            fprintf(stdout, "            flush             use MPI_Win_flush synchronization call\n");
+            fprintf(stdout, "            flush_local       use MPI_Win_flush_local synchronization call\n");
+            fprintf(stdout, "            lock_all          use MPI_Win_lock_all/unlock_all synchronization calls\n");
+#endif
+        }
+        fprintf(stdout, "\n");
+    }
+    if (options.subtype == ATTACH) {
+        fprintf(stdout, "  -k, --buffers MAX           sweep the attached regions over powers of two up to MAX\n");
+        fprintf(stdout, "                              (default %d, max %d)\n", DEF_ATTACH_REGIONS, MAX_ATTACH_REGIONS);
+    }
+    if (options.subtype == CONTENTION) {
+        fprintf(stdout, "  -t ORIGINS                  sweep the origins over the powers of two up to ORIGINS\n");
+        fprintf(stdout, "                              (default all ranks but the target)\n");
+        fprintf(stdout, "  -l, --slots SLOTS           spread the origins round robin over SLOTS counters of the\n");
+        fprintf(stdout, "                              target, one cache line apart (default %d)\n", DEF_RMA_SLOTS);
+    } else if (options.show_size) {
+        fprintf(stdout, "  -m, --message-size          [MIN:]MAX  set the minimum and/or the maximum message size to MIN and/or MAX\n");
+        fprintf(stdout, "                              bytes respectively. Examples:\n");
+        fprintf(stdout, "                              -m 128      // min = default, max = 128\n");
+        fprintf(stdout, "                              -m 2:128    // min = 2, max = 128\n");
+        fprintf(stdout, "                              -m 2:       // min = 2, max = default\n");
+        fprintf(stdout, "  -M, --mem-limit SIZE        set per process maximum memory consumption to SIZE bytes\n");
+        fprintf(stdout, "                              (default %d)\n", MAX_MEM_LIMIT);
+    }
+    fprintf(stdout, "  -x, --warmup ITER           number of warmup iterations to skip before timing"
+                   "(default 100)\n");
+    
+    if(options.subtype == BW || options.subtype == RMA_MR ||
+            options.subtype == SHM_WIN) {
+        fprintf(stdout, "  -W, --window-size SIZE      set number of messages to send before synchronization (default 64)\n");
+    }
+    if (options.subtype == SHM_WIN) {
+        fprintf(stdout, "  -b, --cpu-bind CPUS         bind the ranks of each node to CPUS (e.g. 0-3,8), split\n");
+        fprintf(stdout, "                              evenly in local rank order\n");
+        fprintf(stdout, "  -N, --mem-node NODE         bind every window segment to NUMA node NODE instead of\n");
+        fprintf(stdout, "                              leaving it where its owner first touches it\n");
+    }
+    if (options.subtype == RMA_MR) {
+        fprintf(stdout, "  -X, --rma-pattern PATTERN   origins and targets: pairs (first half to second half,\n");
+        fprintf(stdout, "                              default), fanout (rank 0 to all), fanin (all to rank 0)\n");
+        fprintf(stdout, "                              or many (every rank of the first half to every rank of\n");
+        fprintf(stdout, "                              the second half)\n");
+    }
+    if (options.rma_inflight) {
+        fprintf(stdout, "  -q, --in-flight REQUESTS    keep up to REQUESTS request-based operations in flight\n");
+        fprintf(stdout, "                              (default %d)\n", options.rma_inflight);
+    }
+    
+    fprintf(stdout, "  -i, --iterations ITER       number of iterations for timing (default 10000)\n");
+
+    fprintf(stdout, "  -F, --output-format FORMAT  print results as FORMAT: table (default), csv, or json\n");
+    fprintf(stdout, "                              (one JSON object per line)\n");
+    if (options.subtype != CONTENTION) {
+        fprintf(stdout, "  -D, --size-schedule SPEC    step through message sizes according to SPEC:\n");
+        fprintf(stdout, "                              geometric:FACTOR, linear:STEP, list:SIZE[,SIZE...] or\n");
+        fprintf(stdout, "                              adaptive[:POINTS[:THRESHOLD]] (default geometric:2)\n");
+    }
+    if (STREAM_NONE != options.stream) {
+        fprintf(stdout, "  --stream SECONDS[:SLICE_MS] send the largest message size for SECONDS and print the\n");
+        fprintf(stdout, "                              bandwidth of every SLICE_MS slice (default %d ms)\n",
+                DEF_STREAM_SLICE_MS);
+    }
+    fprintf(stdout, "  --timer NAME                clock of the timed loops: default (MPI_Wtime), gettimeofday,\n");
+    fprintf(stdout, "                              monotonic (CLOCK_MONOTONIC_RAW) or cycles (rdtscp/cntvct)\n");
+    fprintf(stdout, "  --baseline FILE             compare the results with the csv or json results in FILE\n");
+    fprintf(stdout, "                              and exit with an error if any of them regressed\n");
+    fprintf(stdout, "  --tolerance PCT             slowdown tolerated by --baseline (default %.0f%%)\n",
+            DEF_BASELINE_TOLERANCE);
+    fprintf(stdout, "  --fit                       fit alpha-beta or LogGP parameters per protocol regime\n");
+    fprintf(stdout, "                              to the results and print them at the end\n");
+    fprintf(stdout, "  --checkpoint FILE           append the results to FILE as they complete and skip\n");
+    fprintf(stdout, "                              the message sizes FILE marks completed\n");
+    fprintf(stdout, "  -h, --help                  print this help message\n");
+    fflush(stdout);
+}
+
+int process_one_sided_options (int opt, char *arg)
+{
+    switch(opt) {
+        case 'w':
+            /* Benchmarks that sweep preset win_sweep */
+            if ((options.subtype == CONTENTION || options.subtype == RMA_MR ||
+                        options.subtype == WIN_SETUP) &&
+                    0 == strcasecmp(arg, "all")) {
+                options.win_sweep = 1;
+                break;
+            }
+            options.win_sweep = 0;
+#if MPI_VERSION >= 3
+            if (0 == strcasecmp(arg, "create")) {
+                options.win = WIN_CREATE;
+            } else if (0 == strcasecmp(arg, "allocate")) {
+                options.win = WIN_ALLOCATE;
+            } else if (0 == strcasecmp(arg, "dynamic")) {
+                options.win = WIN_DYNAMIC;
+            } else
+#endif
+            {
+                return PO_BAD_USAGE;
+            }
+            break;
+        case 's':
+            if ((options.subtype == CONTENTION || options.subtype == RMA_MR ||
+                        options.subtype == WIN_SETUP) &&
+                    0 == strcasecmp(arg, "all")) {
+                options.sync_sweep = 1;
+                break;
+            }
+            options.sync_sweep = 0;
+            if (0 == strcasecmp(arg, "pscw")) {
+                options.sync = PSCW;
+            } else if (0 == strcasecmp(arg, "fence")) {
+                options.sync = FENCE;
+            } else if (options.synctype== ALL_SYNC) {
+                if (0 == strcasecmp(arg, "lock")) {
+                    options.sync = LOCK;
+                }
+#if MPI_VERSION >= 3
+                else if (0 == strcasecmp(arg, "flush")) {
+                    options.sync = FLUSH;
+                } else if (0 == strcasecmp(arg, "flush_local")) {
+                    options.sync = FLUSH_LOCAL;
+                } else if (0 == strcasecmp(arg, "lock_all")) {
+                    options.sync = LOCK_ALL;
+                }
+#endif
+                else {
+                    return PO_BAD_USAGE;
+                }
+            } else {
+                return PO_BAD_USAGE;
+            }
+            break;
+        default:
+            return PO_BAD_USAGE;
+    }
+
+    return PO_OKAY;
+}
+
+void usage_mbw_mr()
+{
+    if (accel_enabled) {
+        fprintf(stdout, "Usage: %s [options] [SRC DST]\n\n", benchmark_name);
+        fprintf(stdout, "SRC and DST are buffer types for the source and destination\n");
+        fprintf(stdout, "SRC and DST may be `D', `H', or 'M' which specifies whether\n"
+                        "the buffer is allocated on the accelerator device memory, host\n"
+                        "memory or using CUDA Unified memory respectively for each mpi rank\n\n");
+    } else {
+        fprintf(stdout, "Usage: %s [options]\n", benchmark_name);
+    }
+
+    fprintf(stdout, "Options:\n");
+    fprintf(stdout, "  -R=<0,1>, --print-rate         Print the message rate (default 1)\n");
+    fprintf(stdout, "  -p=<pairs>, --num-pairs        Number of pairs involved (default np / 2)\n");
+    fprintf(stdout, "  -W=<window>, --window-size     Number of messages sent before acknowledgement (default 64)\n");
+    fprintf(stdout, "                                 [cannot be used with -v]\n");
+    fprintf(stdout, "  -V, --vary-window              Vary the window size (default no)\n");
+    fprintf(stdout, "                                 [cannot be used with -W]\n");
+    fprintf(stdout, "  -P, --pairing PATTERN          pair ranks by PATTERN: block (default), intra-socket,\n");
+    fprintf(stdout, "                                 inter-socket, intra-node, inter-node or\n");
+    fprintf(stdout, "                                 cross-switch:NODES_PER_SWITCH, and break results down\n");
+    fprintf(stdout, "                                 by locality [cannot be used with -V]\n");
+    fprintf(stdout, "  --stream SECONDS[:SLICE_MS]    send the largest message size for SECONDS and print the\n");
+    fprintf(stdout, "                                 bandwidth of every SLICE_MS slice (default %d ms)\n",
+            DEF_STREAM_SLICE_MS);
+    if (options.show_size) {
+        fprintf(stdout, "  -m, --message-size          [MIN:]MAX  set the minimum and/or the maximum message size to MIN and/or MAX\n");
+        fprintf(stdout, "                              bytes respectively. Examples:\n");
+        fprintf(stdout, "                              -m 128      // min = default, max = 128\n");
+        fprintf(stdout, "                              -m 2:128    // min = 2, max = 128\n");
+        fprintf(stdout, "                              -m 2:       // min = 2, max = default\n");
+        fprintf(stdout, "  -M, --mem-limit SIZE        set per process maximum memory consumption to SIZE bytes\n");
+        fprintf(stdout, "                              (default %d)\n", MAX_MEM_LIMIT);
+    }
+    if (accel_enabled) {
+        fprintf(stdout, "  -d, --accelerator  TYPE     use accelerator device buffers, which can be of TYPE `cuda', \n");
+        fprintf(stdout, "                              `managed', `openacc', `rocm', or `sycl' (uses standard host buffers if not specified)\n");
+        fprintf(stdout, "  -g, --gpu-select POLICY     pick the GPU of each local rank by POLICY: rank (default),\n");
+        fprintf(stdout, "                              list:D0[,D1...], nic (spread over the NICs, closest GPU\n");
+        fprintf(stdout, "                              first) or nic:NAME (the GPUs closest to NIC NAME)\n");
+    }
+    fprintf(stdout, "  -A, --allocator MODE           allocate host buffers with MODE: default, thp,\n");
+    fprintf(stdout, "                                 hugetlb[:2M|:1G] or mpi (MPI_Alloc_mem)\n");
+    fprintf(stdout, "  -b, --cpu-bind CPUS            bind the ranks of each node to CPUS (e.g. 0-3,8), split\n");
+    fprintf(stdout, "                                 evenly in local rank order\n");
+    fprintf(stdout, "  -N, --mem-node NODE            bind the message buffers to NUMA node NODE\n");
+    fprintf(stdout, "  -F, --output-format FORMAT     print results as FORMAT: table (default), csv, or json\n");
+    fprintf(stdout, "                                 (one JSON object per line)\n");
+    fprintf(stdout, "  -D, --size-schedule SPEC       step through message sizes according to SPEC:\n");
+    fprintf(stdout, "                                 geometric:FACTOR, linear:STEP, list:SIZE[,SIZE...] or\n");
+    fprintf(stdout, "                                 adaptive[:POINTS[:THRESHOLD]] (default geometric:2)\n");
+    fprintf(stdout, "  --timer NAME                   clock of the timed loops: default (MPI_Wtime), gettimeofday,\n");
+    fprintf(stdout, "                                 monotonic (CLOCK_MONOTONIC_RAW) or cycles (rdtscp/cntvct)\n");
+    fprintf(stdout, "  --baseline FILE                compare the results with the csv or json results in FILE\n");
+    fprintf(stdout, "                                 and exit with an error if any of them regressed\n");
+    fprintf(stdout, "  --tolerance PCT                slowdown tolerated by --baseline (default %.0f%%)\n",
+            DEF_BASELINE_TOLERANCE);
+    fprintf(stdout, "  --fit                          fit alpha-beta or LogGP parameters per protocol regime\n");
+    fprintf(stdout, "                                 to the results and print them at the end\n");
+    fprintf(stdout, "  --checkpoint FILE              append the results to FILE as they complete and skip\n");
+    fprintf(stdout, "                                 the message sizes FILE marks completed\n");
+    fprintf(stdout, "  -h, --help                     Print this help\n");
+    fprintf(stdout, "\n");
+    fprintf(stdout, "  Note: This benchmark relies on block ordering of the ranks.  Please see\n");
+    fprintf(stdout, "        the README for more information.\n");
+    fflush(stdout);
+}
+
+/* Name of a long option without a short letter */
+static char const * long_only_name (int opt)
+{
+    switch (opt) {
+        case OPT_TIMER:
+            return "timer";
+        case OPT_GLOBAL_CLOCK:
+            return "global-clock";
+        case OPT_BACK_TO_BACK:
+            return "back-to-back";
+        case OPT_ARRIVAL_SKEW:
+            return "arrival-skew";
+        case OPT_BACKGROUND:
+            return "background";
+        case OPT_GROUPS:
+            return "groups";
+        case OPT_GROUP_OP:
+            return "group-op";
+        case OPT_WILDCARD:
+            return "wildcard";
+        case OPT_MATCH_ORDER:
+            return "order";
+        case OPT_SEND_MODE:
+            return "send-mode";
+        case OPT_LARGE_COUNT:
+            return "large-count";
+        case OPT_STREAM:
+            return "stream";
+        case OPT_CHILD_MODE:
+            return "child-mode";
+        case OPT_FILE_VIEW:
+            return "file-view";
+        case OPT_IO_HINTS:
+            return "io-hints";
+        case OPT_IO_FILE:
+            return "io-file";
+        case OPT_RESIDENCY:
+            return "residency";
+        case OPT_BASELINE:
+            return "baseline";
+        case OPT_TOLERANCE:
+            return "tolerance";
+        case OPT_FIT:
+            return "fit";
+        case OPT_COUNTS:
+            return "counts";
+        case OPT_CHECKPOINT:
+            return "checkpoint";
+        case OPT_OUTLIERS:
+            return "outliers";
+        case OPT_LOOP:
+            return "loop";
+        default:
+            return "?";
+    }
+}
+
+void print_bad_usage_message (int rank)
+{
+    if (rank) {
+        return;
+    }
+
+    if (OPT_TIMER <= bad_usage.opt) {
+        fprintf(stderr, "%s [--%s%s%s]\n\n", bad_usage.message,
+                long_only_name(bad_usage.opt), bad_usage.optarg ? " " : "",
+                bad_usage.optarg ? bad_usage.optarg : "");
+    } else if (bad_usage.optarg) {
+        fprintf(stderr, "%s [-%c %s]\n\n", bad_usage.message,
+                (char)bad_usage.opt, bad_usage.optarg);
+    } else {
+        fprintf(stderr, "%s [-%c]\n\n", bad_usage.message,
+                (char)bad_usage.opt);
+    }
+    fflush(stderr);
+
+    if (options.bench != ONE_SIDED) {
+        print_help_message(rank);
+    }
+}
+
+void print_help_message (int rank)
+{
+    if (rank) {
+        return;
+    }
+
+    if (accel_enabled && (options.bench == PT2PT)) {
+        fprintf(stdout, "Usage: %s [options] [SRC DST]\n\n", benchmark_name);
+        fprintf(stdout, "SRC and DST are buffer types for the source and destination\n");
+        fprintf(stdout, "SRC and DST may be `D', `H', or 'M' which specifies whether\n"
+                        "the buffer is allocated on the accelerator device memory, host\n"
+                        "memory or using CUDA Unified memory respectively for each mpi rank\n\n");
+    } else {
+        fprintf(stdout, "Usage: %s [options]\n", benchmark_name);
+        fprintf(stdout, "Options:\n");
+    }
+
+    if (accel_enabled && (options.subtype != LAT_MT) && (options.subtype != LAT_MP)
+            && (options.subtype != LAT_PART) && (options.subtype != MR_MT)
+            && (options.subtype != REG_CACHE)
+            && (options.subtype != MATRIX) && (options.subtype != HALO)) {
+        fprintf(stdout, "  -d, --accelerator  TYPE     use accelerator device buffers, which can be of TYPE `cuda', \n");
+        fprintf(stdout, "                              `managed', `openacc', `rocm', or `sycl' (uses standard host buffers if not specified)\n");
+        fprintf(stdout, "  -g, --gpu-select POLICY     pick the GPU of each local rank by POLICY: rank (default),\n");
+        fprintf(stdout, "                              list:D0[,D1...], nic (spread over the NICs, closest GPU\n");
+        fprintf(stdout, "                              first) or nic:NAME (the GPUs closest to NIC NAME)\n");
+    }
+
+    if (options.show_size) {
+        fprintf(stdout, "  -m, --message-size          [MIN:]MAX  set the minimum and/or the maximum message size to MIN and/or MAX\n");
+        fprintf(stdout, "                              bytes respectively. Examples:\n");
+        fprintf(stdout, "                              -m 128      // min = default, max = 128\n");
+        fprintf(stdout, "                              -m 2:128    // min = 2, max = 128\n");
+        fprintf(stdout, "                              -m 2:       // min = 2, max = default\n");
+        fprintf(stdout, "  -M, --mem-limit SIZE        set per process maximum memory consumption to SIZE bytes\n");
+        fprintf(stdout, "                              (default %d)\n", MAX_MEM_LIMIT);
+    }
+
+    if (options.subtype == LAT_DT || options.subtype == COLL_DT) {
+        fprintf(stdout, "  -B, --dt-block-size SIZE    set block size used by derived datatype (DDT)\n");
+        fprintf(stdout, "  -S, --dt-stride-size SIZE   set base stride size used by derived datatype (DDT)\n");
+        fprintf(stdout, "  -I, --dt-increase-size SIZE set increment stride size used by derived datatype (DDT)\n");
+        fprintf(stdout, "  -Q, --dt-type TYPE          build the DDT as a vector, indexed, subarray or struct type\n");
+        fprintf(stdout, "                              (default vector, or indexed if -I is given; -I needs indexed\n");
+        fprintf(stdout, "                              or struct)\n");
+        fprintf(stdout, "                                  DDT blocks are determined by block size and stride size\n");
+        fprintf(stdout, "                                  repeat count is calculated by (message size / block size)\n");
+        fprintf(stdout, "                                  block size and stride size both have to be smaller then 65536\n");
+    }
+
+    if (options.subtype == COMM_SETUP) {
+        fprintf(stdout, "  -i, --iterations COUNT      hold up to COUNT communicators per call and step, reported at\n");
+        fprintf(stdout, "                              every power of two (default %d)\n", COMM_SETUP_COUNT);
+        fprintf(stdout, "  -x, --warmup COUNT          create and free COUNT communicators before timing (default %d)\n", COMM_SETUP_SKIP);
+    } else if (options.subtype == TAG_MATCH) {
+        fprintf(stdout, "  -m, --message-size [MIN:]MAX  sweep the queue depth from MIN to MAX (default 0:%d)\n",
+                TAG_MATCH_MAX_DEPTH);
+        fprintf(stdout, "  -i, --iterations ITER       set iterations per depth to ITER (default %d, %d above\n",
+                TAG_MATCH_LOOP, TAG_MATCH_LOOP_LARGE);
+        fprintf(stdout, "                              a depth of %d)\n", TAG_MATCH_LARGE_DEPTH);
+        fprintf(stdout, "  -x, --warmup ITER           set number of warmup iterations per depth (default %d)\n",
+                TAG_MATCH_SKIP);
+        fprintf(stdout, "  --wildcard KIND             receive with none (default), source (MPI_ANY_SOURCE),\n");
+        fprintf(stdout, "                              tag (MPI_ANY_TAG on the matching receive) or both\n");
+        fprintf(stdout, "  --order POS                 the matching entry is at the tail (default) or the head\n");
+        fprintf(stdout, "                              of the queue\n");
+    } else if (options.subtype == LARGE_COUNT) {
+        fprintf(stdout, "  -m, --message-size [MIN:]MAX  sweep the message size from MIN to MAX bytes (default\n");
+        fprintf(stdout, "                              %d:%zu), MAX is lowered to what the memory of the\n",
+                LARGE_COUNT_MIN_SIZE, LARGE_COUNT_MAX_SIZE);
+        fprintf(stdout, "                              nodes holds\n");
+        fprintf(stdout, "  -i, --iterations ITER       set iterations per message size to ITER (default %d)\n", LARGE_COUNT_LOOP);
+        fprintf(stdout, "  -x, --warmup ITER           set number of warmup iterations to skip before timing (default %d)\n", LARGE_COUNT_SKIP);
+        if (PT2PT == options.bench) {
+            fprintf(stdout, "  -W, --window-size SIZE      set number of messages to send before synchronization (default %d)\n", LARGE_COUNT_WINDOW);
+        }
+        fprintf(stdout, "  --large-count METHOD        pass counts beyond INT_MAX with the MPI-4 _c functions (c,\n");
+        fprintf(stdout, "                              the default where available) or a derived datatype of\n");
+        fprintf(stdout, "                              %d MB chunks (datatype)\n", LARGE_COUNT_CHUNK >> 20);
+    } else if (options.subtype == IO) {
+        fprintf(stdout, "  -m, --message-size [MIN:]MAX  sweep the bytes per rank and call from MIN to MAX (default\n");
+        fprintf(stdout, "                              %d:%d)\n", IO_MIN_SIZE, IO_MAX_SIZE);
+        fprintf(stdout, "  -i, --iterations ITER       set iterations per message size to ITER (default %d)\n", IO_LOOP);
+        fprintf(stdout, "  -x, --warmup ITER           set number of warmup iterations to skip before timing (default %d)\n", IO_SKIP);
+        fprintf(stdout, "  --file-view VIEW            contiguous (default), a block per rank, or strided, the ranks\n");
+        fprintf(stdout, "                              interleaved in blocks of %d bytes\n", IO_STRIDE_BLOCK);
+        fprintf(stdout, "  --io-hints KEY=VAL[,...]    MPI_Info hints of MPI_File_open, e.g. cb_nodes=4,\n");
+        fprintf(stdout, "                              cb_buffer_size=16777216,romio_cb_write=enable\n");
+        fprintf(stdout, "  --io-file PATH              file to write and read, deleted on close (default %s)\n", IO_DEF_FILE);
+    } else if (options.subtype == NOISE) {
+        fprintf(stdout, "  -i, --iterations COUNT      time COUNT work quanta per rank (default %d)\n", NOISE_QUANTA);
+        fprintf(stdout, "  -x, --warmup COUNT          run COUNT quanta first to find the fastest (default %d)\n", NOISE_SKIP);
+        fprintf(stdout, "  -T, --outlier-threshold F   count a quantum as noise when it takes more than F times\n");
+        fprintf(stdout, "                              the fastest one (default %.1f)\n", DEF_OUTLIER_THRESHOLD);
+    } else {
+        fprintf(stdout, "  -i, --iterations ITER       set iterations per message size to ITER (default 1000 for small\n");
+        fprintf(stdout, "                              messages, 100 for large messages)\n");
+        fprintf(stdout, "  -x, --warmup ITER           set number of warmup iterations to skip before timing (default 200)\n");
+    }
+
+    if (options.subtype == BW) {
+        fprintf(stdout, "  -W, --window-size SIZE      set number of messages to send before synchronization (default 64)\n");
+    }
+
+    if (options.subtype == MATRIX) {
+        fprintf(stdout, "                              [-m MIN:MAX sets the latency size (default %d) and the\n",
+                MATRIX_LAT_SIZE);
+        fprintf(stdout, "                              bandwidth size (default %d); -i and -x count round trips\n",
+                MATRIX_BW_SIZE);
+        fprintf(stdout, "                              for latency and windows for bandwidth]\n");
+        fprintf(stdout, "  -W, --window-size SIZE      set number of messages per bandwidth window (default %d)\n",
+                MATRIX_WINDOW_SIZE);
+        fprintf(stdout, "  -T, --outlier-threshold F   report links more than F times slower than the median\n");
+        fprintf(stdout, "                              (default %.1f)\n", DEF_OUTLIER_THRESHOLD);
+        fprintf(stdout, "  -o, --matrix-file FILE      write the latency and bandwidth matrices to FILE in binary\n");
+    }
+
+    if (PAIRING_NONE != options.pairing) {
+        fprintf(stdout, "  -P, --pairing PATTERN       pair ranks by PATTERN: block (default, rank i with i + np/2),\n");
+        fprintf(stdout, "                              intra-socket, inter-socket, intra-node, inter-node or\n");
+        fprintf(stdout, "                              cross-switch:NODES_PER_SWITCH, and break results down by locality\n");
+    }
+
+    if (VALIDATE_NONE != options.validate) {
+        fprintf(stdout, "  -j, --validate              after timing each size, exchange one untimed message and check\n");
+        fprintf(stdout, "                              the received data where it lives (device buffers with a kernel)\n");
+    }
+
+    if (MEM_FOOTPRINT_NONE != options.mem_footprint) {
+        fprintf(stdout, "  -U, --mem-footprint         sample VmRSS, VmHWM and the MPI_T memory pvars before and after\n");
+        fprintf(stdout, "                              MPI_Init, after the allocation and after every size, and print\n");
+        fprintf(stdout, "                              them per rank and summed per node at the end\n");
+    }
+
+    if (PVARS_NONE != options.pvars) {
+        fprintf(stdout, "  -Y, --pvars NAMES           add a column per MPI_T pvar of the comma separated NAMES,\n");
+        fprintf(stdout, "                              started and stopped around the loop of every size, or\n");
+        fprintf(stdout, "                              \"-Y list\" to print the pvars of the MPI library\n");
+    }
+
+    if (COUNTERS_NONE != options.counters) {
+        fprintf(stdout, "  -Z, --counters EVENTS       add a column per hardware counter averaged over the ranks per\n");
+        fprintf(stdout, "                              iteration: cycles, instructions, llc-misses, dtlb-misses,\n");
+        fprintf(stdout, "                              branch-misses, page-faults, context-switches, or default\n");
+    }
+
+    if (SEND_MODE_NONE != options.send_mode) {
+        fprintf(stdout, "  --send-mode MODE            send with MPI_Send/MPI_Isend: standard (default), sync\n");
+        fprintf(stdout, "                              (MPI_Ssend), ready (MPI_Rsend, receives posted first),\n");
+        fprintf(stdout, "                              buffered (MPI_Bsend, attached buffer) or persistent\n");
+        fprintf(stdout, "                              (MPI_Send_init/MPI_Start)\n");
+    }
+
+    if (LOOP_NONE != options.loop) {
+        fprintf(stdout, "  --loop NAME                 timed loop: auto (default, fast whenever the options allow),\n");
+        fprintf(stdout, "                              generic, fast (host buffers, standard sends, fixed tag) or\n");
+        fprintf(stdout, "                              null (no messages, the overhead of the harness itself)\n");
+    }
+
+    if (STREAM_NONE != options.stream) {
+        fprintf(stdout, "  --stream SECONDS[:SLICE_MS] send the largest message size for SECONDS and print the\n");
+        fprintf(stdout, "                              bandwidth of every SLICE_MS slice (default %d ms)\n",
+                DEF_STREAM_SLICE_MS);
+    }
+
+    if (GLOBAL_CLOCK_NONE != options.global_clock) {
+        fprintf(stdout, "  --global-clock              put the clocks of all ranks on the clock of rank 0 and add\n");
+        if (PT2PT == options.bench) {
+            fprintf(stdout, "                              the one way latencies of both directions\n");
+        } else {
+            fprintf(stdout, "                              the entry skew and the first and last exit after the\n");
+            fprintf(stdout, "                              entry of rank 0 per iteration\n");
+        }
+    }
+
+    if (SKEW_NONE != options.skew) {
+        fprintf(stdout, "  --arrival-skew DIST:US[:P]  delay every rank before each collective with the host\n");
+        fprintf(stdout, "                              compute: uniform:US up to US microseconds, slow:US[:RANK]\n");
+        fprintf(stdout, "                              one slow rank (default the last), gaussian:US[:SIGMA] mean\n");
+        fprintf(stdout, "                              US and deviation SIGMA (default US/4); adds the total and\n");
+        fprintf(stdout, "                              the excess latency after the last arrival\n");
+    }
+
+    if (COUNTS_NONE != options.count_dist) {
+        fprintf(stdout, "  --counts DIST[:P]           bytes every rank exchanges with every other rank, the\n");
+        fprintf(stdout, "                              message size on average: uniform (default), zipf[:S]\n");
+        fprintf(stdout, "                              rank weights falling as 1/(rank+1)^S (default 1),\n");
+        fprintf(stdout, "                              sparse[:K] K random destinations per rank (default 2),\n");
+        fprintf(stdout, "                              block[:B] within blocks of B ranks (default 4); adds\n");
+        fprintf(stdout, "                              the load imbalance, the largest load and the density\n");
+    }
+
+    if (BACKGROUND_NONE != options.background) {
+        fprintf(stdout, "  --background PAT[:N[:SIZE]] the last N ranks (default half) generate background\n");
+        fprintf(stdout, "                              traffic while the others measure: stream, windows of\n");
+        fprintf(stdout, "                              %d sends of SIZE bytes (default %d) to a partner, or\n",
+                BACKGROUND_WINDOW, BACKGROUND_STREAM_SIZE);
+        fprintf(stdout, "                              alltoall of SIZE bytes per rank (default %d)\n",
+                BACKGROUND_ALLTOALL_SIZE);
+    }
+
+    if (GROUP_OP_NONE != options.group_op && COMM_SCALING != options.subtype) {
+        fprintf(stdout, "  --groups K[,K...]           run K groups at the same time, each of the ranks divided\n");
+        fprintf(stdout, "                              by the largest K (default 1,2,4,... up to half the ranks)\n");
+        fprintf(stdout, "  --group-op OP               collective of every group: allreduce (default), bcast,\n");
+        fprintf(stdout, "                              alltoall or barrier\n");
+    } else if (GROUP_OP_NONE != options.group_op) {
+        fprintf(stdout, "  --group-op OP               collective of every communicator: allreduce (default),\n");
+        fprintf(stdout, "                              bcast, alltoall or barrier\n");
+    }
+
+    if (BACK_TO_BACK_NONE != options.back_to_back) {
+        fprintf(stdout, "  --back-to-back[=US]         also time blocks of -i collectives without barriers and add\n");
+        fprintf(stdout, "                              the time per collective and the collectives per second, and\n");
+        fprintf(stdout, "                              with US a second block after a random delay of up to US\n");
+        fprintf(stdout, "                              microseconds before every collective\n");
+    }
+
+    if (TUNE_NONE != options.tune) {
+        fprintf(stdout, "  -J, --tune NAME=V1:V2[,...] time every size once per combination of the values of the\n");
+        fprintf(stdout, "                              MPI_T cvars, on a communicator created after writing them,\n");
+        fprintf(stdout, "                              and print the best setting per size at the end\n");
+    }
+
+    if (options.bench == COLLECTIVE && options.subtype != COMM_SETUP &&
+            options.subtype != NOISE && options.subtype != CONGESTION &&
+            options.subtype != MULTI_GROUP && options.subtype != LARGE_COUNT &&
+            options.subtype != COMM_SCALING && options.subtype != COLL_DT &&
+            options.subtype != IO && options.subtype != MANAGED_MEM) {
+        if (options.subtype != REDUCE_LOCAL) {
+            fprintf(stdout, "  -f, --full                  print full format listing (MIN/MAX latency and ITERATIONS\n");
+            fprintf(stdout, "                              displayed in addition to AVERAGE latency)\n");
+        }
+
+        if (options.subtype == LAT) {
+            fprintf(stdout, "  -z, --percentiles           record every timed iteration in a latency histogram and\n");
+            fprintf(stdout, "                              print P50/P90/P99/P99.9/max across all ranks\n");
+            fprintf(stdout, "  -C, --converge PCT[:SECS]   iterate until the 95%% confidence interval of the mean is\n");
+            fprintf(stdout, "                              within PCT percent on every rank or SECS seconds (default %.0f)\n", DEF_CONVERGE_BUDGET);
+            fprintf(stdout, "                              have been spent per message size; -i is ignored\n");
+            fprintf(stdout, "  -c, --cache-mode MODE       hot (default) reuses the same buffers every iteration, cold[:BYTES]\n");
+            fprintf(stdout, "                              rotates through a BYTES pool (default the last level cache size),\n");
+            fprintf(stdout, "                              fresh allocates new buffers every iteration\n");
+            fprintf(stdout, "  --outliers K[:Z]            list the K slowest ranks and their hosts after every size and\n");
+            fprintf(stdout, "                              count those with a robust z-score beyond Z (default %.1f)\n",
+                    DEF_OUTLIER_Z);
+        }
+
+        if (BACKEND_NONE != options.backend && NCCL_ENABLED && accel_enabled) {
+            fprintf(stdout, "  -G, --backend LIB           run the collective with LIB: mpi (default) or nccl, which is\n");
+            fprintf(stdout, "                              RCCL on ROCm builds; nccl is timed with device events and\n");
+            fprintf(stdout, "                              needs device buffers\n");
+        }
+
+        if (HIER_NONE != options.hierarchical) {
+            fprintf(stdout, "  -H, --hierarchical          also time a two-level composition (node shared memory plus node\n");
+            fprintf(stdout, "                              leaders) on the same buffers and report it next to the native call\n");
+        }
+
+        if (PIPELINE_NONE != options.pipeline) {
+            fprintf(stdout, "  -L, --pipeline CHUNK[:DEPTH]  also time the collective split into CHUNK byte segments,\n");
+            fprintf(stdout, "                              DEPTH of them (default %d, max %d) in flight as non-blocking\n", DEF_PIPELINE_DEPTH, MAX_PIPELINE_DEPTH);
+            fprintf(stdout, "                              collectives, and report which of the two is faster\n");
+        }
+
+        if (DTYPE_NONE != options.dtype) {
+            fprintf(stdout, "  -y, --datatype TYPE         reduce elements of TYPE: float (default), double, int, int64,\n");
+            fprintf(stdout, "                              or the pair types float_int, double_int and 2int\n");
+            fprintf(stdout, "  -O, --op OP                 reduce with OP: sum (default), prod, max, min, maxloc or minloc\n");
+            fprintf(stdout, "                              (pair types only), or user, a user-defined vectorized sum\n");
+        }
+
+        if (options.subtype == NBC || options.subtype == PERSISTENT) {
+            fprintf(stdout, "  -t, --num_test_calls CALLS  set the number of MPI_Test() calls during the dummy computation, \n");
+            fprintf(stdout, "                              set CALLS to 100, 1000, or any number > 0.\n");
+            fprintf(stdout, "                              \"-t thread\" instead polls MPI_Test from a helper thread\n");
+            fprintf(stdout, "                              while the main thread computes (needs MPI_THREAD_MULTIPLE)\n");
+            fprintf(stdout, "  -K, --compute-kernel KIND[:SIZE]  host computation to overlap: dummy (default),\n");
+            fprintf(stdout, "                              triad[:BYTES] (memory bound stream triad, working set\n");
+            fprintf(stdout, "                              default %d MB) or gemm[:N] (compute bound blocked GEMM of\n", DEF_TRIAD_SIZE >> 20);
+            fprintf(stdout, "                              order N, default %d); omp-triad and omp-gemm run them on\n", DEF_GEMM_SIZE);
+            fprintf(stdout, "                              OMP_NUM_THREADS threads\n");
+        }
+
+        if (NBC_WINDOW_NONE != options.nbc_window_mode) {
+            fprintf(stdout, "  -W, --window-size WINDOW[:dup]  keep WINDOW collectives on disjoint buffers in flight\n");
+            fprintf(stdout, "                              (max %d) and report their throughput and completion\n", MAX_NBC_WINDOW);
+            fprintf(stdout, "                              latency instead of the overlap; with :dup each one runs on\n");
+            fprintf(stdout, "                              its own duplicate of MPI_COMM_WORLD\n");
+        }
+
+        if (GPU_KERNEL_ENABLED && options.subtype != REDUCE_LOCAL) {
+            fprintf(stdout, "  -r, --cuda-target TARGET    set the compute target for dummy computation\n");
+            fprintf(stdout, "                              set TARGET to cpu (default) to execute \n");
+            fprintf(stdout, "                              on CPU only, set to gpu for executing kernel \n");
+            fprintf(stdout, "                              on the GPU only, and set to both for compute on both.\n");
+
+            fprintf(stdout, "  -a, --array-size SIZE       set the size of arrays to be allocated on device (GPU) \n");
+            fprintf(stdout, "                              for dummy compute on device (GPU) (default 32), the \n");
+            fprintf(stdout, "                              kernel iterations are calibrated to the latency \n");
+        }
+    }
+    if (HALO == options.subtype) {
+        fprintf(stdout, "  -E, --stencil face[:DIMS]   exchange the faces of a DIMS-D grid (1 to 3, default %d)\n", DEF_STENCIL_DIMS);
+    } else if (STENCIL_NONE != options.stencil) {
+        fprintf(stdout, "  -E, --stencil SHAPE[:DIMS]  exchange halos on a DIMS-D grid (1 to 3, default %d) with SHAPE:\n", DEF_STENCIL_DIMS);
+        fprintf(stdout, "                              face (default, Cartesian communicator), graph (the face\n");
+        fprintf(stdout, "                              neighbors on a distributed graph) or full (edges and corners too)\n");
+    }
+
+    if (LAT_MT == options.subtype) {
+        fprintf(stdout, "  -t, --num_threads           SEND:[RECV]  set the sender and receiver number of threads \n");
+        fprintf(stdout, "                              min: %d default: (receiver threads: %d sender threads: 1), max: %d.\n", MIN_NUM_THREADS, DEF_NUM_THREADS, MAX_NUM_THREADS);
+        fprintf(stdout, "                              Examples: \n");
+        fprintf(stdout, "                              -t 4        // receiver threads = 4 and sender threads = 1\n");
+        fprintf(stdout, "                              -t 4:6      // sender threads = 4 and receiver threads = 6\n");
+        fprintf(stdout, "                              -t 2:       // not defined\n");
+    }
+
+    if (LAT_PART == options.subtype) {
+        fprintf(stdout, "  -t, --num_threads THREADS   sweep the sender threads over powers of two up to THREADS\n");
+        fprintf(stdout, "                              (default %d, max %d)\n", DEF_PART_THREADS, MAX_NUM_THREADS);
+        fprintf(stdout, "  -n, --partitions PARTS      sweep the partitions over powers of two up to PARTS, at least\n");
+        fprintf(stdout, "                              one per thread (default %d, max %d)\n", DEF_NUM_PARTITIONS, MAX_NUM_PARTITIONS);
+    }
+
+    if (MR_MT == options.subtype) {
+        fprintf(stdout, "  -t, --num_threads THREADS   sweep the threads per rank over powers of two up to THREADS\n");
+        fprintf(stdout, "                              (default %d, max %d)\n", DEF_MR_THREADS, MAX_NUM_THREADS);
+        fprintf(stdout, "  -W, --window-size SIZE      set number of messages in flight per thread (default %d)\n", WINDOW_SIZE_LARGE);
+        fprintf(stdout, "  -e, --thread-comm MAPPING   map the threads to communicators, MAPPING is one of\n");
+        fprintf(stdout, "                              shared  all threads on MPI_COMM_WORLD with one tag\n");
+        fprintf(stdout, "                              tag     all threads on MPI_COMM_WORLD, one tag each\n");
+        fprintf(stdout, "                              comm    one communicator per thread (default)\n");
+        fprintf(stdout, "                              comm:N  threads spread round robin over N communicators\n");
+        fprintf(stdout, "  -f, --full                  print the message rate of every thread\n");
+    }
+
+    if (PROBE_MT == options.subtype) {
+        fprintf(stdout, "  -t, --num_threads THREADS   sweep the threads per rank over powers of two up to THREADS\n");
+        fprintf(stdout, "                              (default %d, max %d)\n", DEF_PROBE_THREADS, MAX_NUM_THREADS);
+    }
+
+    if (REG_CACHE == options.subtype) {
+        fprintf(stdout, "  -W, --window-size SIZE      set number of messages in flight (default %d)\n", WINDOW_SIZE_LARGE);
+        fprintf(stdout, "  -k, --buffers MAX           sweep the working set over powers of two up to MAX distinct\n");
+        fprintf(stdout, "                              buffers per rank (default %d, max %d)\n", DEF_REGCACHE_BUFFERS, MAX_REGCACHE_BUFFERS);
+        fprintf(stdout, "  -u, --churn ITERS           free and reallocate one buffer of the working set every ITERS\n");
+        fprintf(stdout, "                              iterations (default 0, never)\n");
+    }
+
+    if (LAT_MP == options.subtype) {
+        fprintf(stdout, "  -t, --num_processes         SEND:[RECV]  set the sender and receiver number of processes \n");
+        fprintf(stdout, "                              min: %d default: (receiver processes: %d sender processes: 1), max: %d.\n",\
+                                                       MIN_NUM_PROCESSES, DEF_NUM_PROCESSES, MAX_NUM_PROCESSES);
+        fprintf(stdout, "                              Examples: \n");
+        fprintf(stdout, "                              -t 4        // receiver processes = 4 and sender processes = 1\n");
+        fprintf(stdout, "                              -t 4:6      // sender processes = 4 and receiver processes = 6\n");
+        fprintf(stdout, "                              -t 2:       // not defined\n");
+        fprintf(stdout, "  --child-mode MODE           sleep (default) while the parents run the latency test,\n");
+        fprintf(stdout, "                              touch (write an inherited heap arena and allocate fresh\n");
+        fprintf(stdout, "                              memory) or buffers (touch and the message buffers); both\n");
+        fprintf(stdout, "                              time latency and bandwidth before, during and after them\n");
+    }
+
+    if (RESIDENCY_MASK_NONE != options.residency) {
+        fprintf(stdout, "  --residency STATE[,...]     where the pages of the managed buffers are before every\n");
+        fprintf(stdout, "                              iteration: fault (host, migrated on demand), device, host,\n");
+        fprintf(stdout, "                              read-mostly, preferred (device preferred) or all (default)\n");
+    }
+
+    if (PT2PT == options.bench && BW == options.subtype) {
+        fprintf(stdout, "  -c, --cache-mode MODE       hot (default) reuses the same buffers every iteration, cold[:BYTES]\n");
+        fprintf(stdout, "                              rotates through a BYTES pool (default the last level cache size),\n");
+        fprintf(stdout, "                              fresh allocates new buffers for every message\n");
+    }
+
+    if ((PT2PT == options.bench && TAG_MATCH != options.subtype &&
+                PROBE_MT != options.subtype && LARGE_COUNT != options.subtype &&
+                MANAGED_MEM != options.subtype && GPU_PEER != options.subtype &&
+                GPU_PIPELINE != options.subtype) ||
+            (COLLECTIVE == options.bench && COMM_SETUP != options.subtype &&
+             NOISE != options.subtype && CONGESTION != options.subtype &&
+             MULTI_GROUP != options.subtype && LARGE_COUNT != options.subtype &&
+             COMM_SCALING != options.subtype && COLL_DT != options.subtype &&
+             IO != options.subtype && MANAGED_MEM != options.subtype)) {
+        fprintf(stdout, "  -A, --allocator MODE        allocate host buffers with MODE: default (posix_memalign),\n");
+        fprintf(stdout, "                              thp (2MB aligned, transparent huge pages), hugetlb[:2M|:1G]\n");
+        fprintf(stdout, "                              (explicit huge pages) or mpi (MPI_Alloc_mem)\n");
+    }
+
+    if (PT2PT == options.bench && TAG_MATCH != options.subtype &&
+            LARGE_COUNT != options.subtype && MANAGED_MEM != options.subtype) {
+        fprintf(stdout, "  -b, --cpu-bind CPUS         bind the ranks of each node to CPUS (e.g. 0-3,8), split\n");
+        fprintf(stdout, "                              evenly in local rank order; threads take one CPU of\n");
+        fprintf(stdout, "                              their rank's share each\n");
+        fprintf(stdout, "  -N, --mem-node NODE         bind the message buffers to NUMA node NODE\n");
+    }
+
+    if (GPU_PIPELINE == options.subtype && GPU_KERNEL_ENABLED) {
+        fprintf(stdout, "  -a, --array-size SIZE       busy the GPU with the dummy compute kernel on arrays of\n");
+        fprintf(stdout, "                              SIZE floats (default %d)\n", DEVICE_LOAD_ARRAY_SIZE);
+    }
+
+    fprintf(stdout, "  -F, --output-format FORMAT  print results as FORMAT: table (default), csv, or json\n");
+    fprintf(stdout, "                              (one JSON object per line)\n");
+
+    if (MATRIX != options.subtype && COMM_SETUP != options.subtype &&
+            NOISE != options.subtype && CONGESTION != options.subtype &&
+            MULTI_GROUP != options.subtype && TAG_MATCH != options.subtype &&
+            COMM_SCALING != options.subtype && COLL_DT != options.subtype) {
+        fprintf(stdout, "  -D, --size-schedule SPEC    step through message sizes according to SPEC:\n");
+        fprintf(stdout, "                              geometric:FACTOR, linear:STEP, list:SIZE[,SIZE...] or\n");
+        fprintf(stdout, "                              adaptive[:POINTS[:THRESHOLD]] (default geometric:2)\n");
+    }
+
+    fprintf(stdout, "  --timer NAME                clock of the timed loops: default (MPI_Wtime), gettimeofday,\n");
+    fprintf(stdout, "                              monotonic (CLOCK_MONOTONIC_RAW) or cycles (rdtscp/cntvct)\n");
+    fprintf(stdout, "  --baseline FILE             compare the results with the csv or json results in FILE\n");
+    fprintf(stdout, "                              and exit with an error if any of them regressed\n");
+    fprintf(stdout, "  --tolerance PCT             slowdown tolerated by --baseline (default %.0f%%)\n",
+            DEF_BASELINE_TOLERANCE);
+    fprintf(stdout, "  --fit                       fit alpha-beta or LogGP parameters per protocol regime\n");
+    fprintf(stdout, "                              to the results and print them at the end\n");
+    fprintf(stdout, "  --checkpoint FILE           append the results to FILE as they complete and skip\n");
+    fprintf(stdout, "                              the message sizes FILE marks completed\n");
+    fprintf(stdout, "  -h, --help                  print this help\n");
+    fprintf(stdout, "  -v, --version               print version info\n");
+    fprintf(stdout, "\n");
+    fflush(stdout);
+}
+
+void print_help_message_get_acc_lat (int rank)
+{
+    if (rank) {
+        return;
+    }
+
+    if (OPT_TIMER <= bad_usage.opt) {
+        fprintf(stderr, "%s [--%s%s%s]\n\n", bad_usage.message,
+                long_only_name(bad_usage.opt), bad_usage.optarg ? " " : "",
+                bad_usage.optarg ? bad_usage.optarg : "");
+    } else if (bad_usage.optarg) {
+        fprintf(stderr, "%s [-%c %s]\n\n", bad_usage.message,
+                (char)bad_usage.opt, bad_usage.optarg);
+    } else {
+        fprintf(stderr, "%s [-%c]\n\n", bad_usage.message,
+                (char)bad_usage.opt);
+    }
+    fflush(stderr);
+
+    fprintf(stdout, "Usage: ./osu_get_acc_latency -w <win_option>  -s < sync_option> [-x ITER] [-i ITER]\n");
+    if (options.show_size) {
+        fprintf(stdout, "  -m, --message-size          [MIN:]MAX  set the minimum and/or the maximum message size to MIN and/or MAX\n");
+        fprintf(stdout, "                              bytes respectively. Examples:\n");
+        fprintf(stdout, "                              -m 128      // min = default, max = 128\n");
+        fprintf(stdout, "                              -m 2:128    // min = 2, max = 128\n");
+        fprintf(stdout, "                              -m 2:       // min = 2, max = default\n");
+        fprintf(stdout, "  -M, --mem-limit SIZE        set per process maximum memory consumption to SIZE bytes\n");
+        fprintf(stdout, "                              (default %d)\n", MAX_MEM_LIMIT);
+    }
+
+    fprintf(stdout, "  -x ITER       number of warmup iterations to skip before timing"
+            "(default 100)\n");
+    fprintf(stdout, "  -i ITER       number of iterations for timing (default 10000)\n");
+    fprintf(stdout, "\n");
+    fprintf(stdout, "win_option:\n");
+    fprintf(stdout, "  create            use MPI_Win_create to create an MPI Window object\n");
+    fprintf(stdout, "  allocate          use MPI_Win_allocate to create an MPI Window object\n");
+    fprintf(stdout, "  dynamic           use MPI_Win_create_dynamic to create an MPI Window object\n");
+    fprintf(stdout, "\n");
+
+    fprintf(stdout, "sync_option:\n");
+    fprintf(stdout, "  lock              use MPI_Win_lock/unlock synchronizations calls\n");
+    fprintf(stdout, "  flush             use MPI_Win_flush synchronization call\n");
+    fprintf(stdout, "  flush_local       use MPI_Win_flush_local synchronization call\n");
+    fprintf(stdout, "  lock_all          use MPI_Win_lock_all/unlock_all synchronization calls\n");
+    fprintf(stdout, "  pscw              use Post/Start/Complete/Wait synchronization calls \n");
+    fprintf(stdout, "  fence             use MPI_Win_fence synchronization call\n");
+    fprintf(stdout, "\n");
+
+    fflush(stdout);
+}
+
+void print_header_one_sided (int rank, enum WINDOW win, enum SYNC sync)
+{
+    if(rank == 0 && OUTPUT_TABLE == options.output_format) {
+        switch (options.accel) {
+            case CUDA:
+                printf(benchmark_header, "-CUDA");
+                break;
+            case OPENACC:
+                printf(benchmark_header, "-OPENACC");
+                break;
+            case ROCM:
+                printf(benchmark_header, "-ROCM");
+                break;
+            case SYCL:
+                printf(benchmark_header, "-SYCL");
+                break;
+            default:
+                printf(benchmark_header, "");
+                break;
+        }
+        print_timer_summary();
+        fprintf(stdout, "# Window creation: %s\n",
+                win_info[win]);
+        fprintf(stdout, "# Synchronization: %s\n",
+                sync_info[sync]);
+
+        switch (options.accel) {
+            case CUDA:
+            case OPENACC:
+            case ROCM:
+            case SYCL:
+                fprintf(stdout, "# Rank 0 Memory on %s and Rank 1 Memory on %s\n",
+                       'M' == options.src ? "MANAGED (M)" : ('D' == options.src ? "DEVICE (D)" : "HOST (H)"),
+                       'M' == options.dst ? "MANAGED (M)" : ('D' == options.dst ? "DEVICE (D)" : "HOST (H)"));
+            default:
+                if (STREAM_ON == options.stream) {
+                    print_stream_header();
+                } else if (options.subtype == BW) {
+                    fprintf(stdout, "%-*s%*s\n", 10, "# Size", FIELD_WIDTH, "Bandwidth (MB/s)");
+                } else {
+                    fprintf(stdout, "%-*s%*s\n", 10, "# Size", FIELD_WIDTH, "Latency (us)");
+                }
+                fflush(stdout);
+        }
+    }
+}
+
+void print_version_message (int rank)
+{
+    if (rank) {
+        return;
+    }
+
+    switch (options.accel) {
+        case CUDA:
+            printf(benchmark_header, "-CUDA");
+            break;
+        case OPENACC:
+            printf(benchmark_header, "-OPENACC");
+            break;
+        case MANAGED:
+            printf(benchmark_header, "-CUDA MANAGED");
+            break;
+        case ROCM:
+            printf(benchmark_header, "-ROCM");
+            break;
+        case SYCL:
+            printf(benchmark_header, "-SYCL");
+            break;
+        default:
+            printf(benchmark_header, "");
+            break;
+    }
+
+    fflush(stdout);
+}
+
+void print_preamble_nbc (int rank)
+{
+    if (rank || OUTPUT_TABLE != options.output_format) {
+        return;
+    }
+
+    fprintf(stdout, "\n");
+
+    switch (options.accel) {
+        case CUDA:
+            printf(benchmark_header, "-CUDA");
+            break;
+        case OPENACC:
+            printf(benchmark_header, "-OPENACC");
+            break;
+        case MANAGED:
+            printf(benchmark_header, "-MANAGED");
+            break;
+        case ROCM:
+            printf(benchmark_header, "-ROCM");
+            break;
+        case SYCL:
+            printf(benchmark_header, "-SYCL");
+            break;
+        default:
+            printf(benchmark_header, "");
+            break;
+    }
+
+    print_timer_summary();
+    print_reduction_summary();
+    print_count_summary();
+
+    if (STENCIL_NONE != options.stencil) {
+        print_stencil_summary();
+    }
+
+    if (KERNEL_TRIAD == options.compute_kernel) {
+        fprintf(stdout, "# Compute: %s, %zu MB working set", compute_kernel_name(),
+                options.compute_size >> 20);
+    } else if (KERNEL_GEMM == options.compute_kernel) {
+        fprintf(stdout, "# Compute: %s, %zu x %zu doubles", compute_kernel_name(),
+                options.compute_size, options.compute_size);
+    }
+#ifdef _OPENMP
+    if (KERNEL_DUMMY != options.compute_kernel && options.compute_omp) {
+        fprintf(stdout, ", %d OpenMP threads", omp_get_max_threads());
+    }
+#endif
+    if (KERNEL_DUMMY != options.compute_kernel) {
+        fprintf(stdout, "\n");
+    }
+
+    if (NBC_WINDOW_OFF < options.nbc_window_mode) {
+        fprintf(stdout, "# Window: %d outstanding collectives, %s communicators\n",
+                options.nbc_window, (NBC_WINDOW_DUP == options.nbc_window_mode) ?
+                "duplicated" : "shared");
+        fprintf(stdout, "# Op latency is from posting a collective to its MPI_Waitany\n\n");
+        fprintf(stdout, "%-*s%*s%*s%*s%*s%*s\n", 10, "# Size", 10, "Window",
+                FIELD_WIDTH, "Ops/s", FIELD_WIDTH, "MB/s",
+                FIELD_WIDTH, "Avg Op(us)", FIELD_WIDTH, "Max Op(us)");
+        fflush(stdout);
+
+        return;
+    }
+
+    if (options.progress_thread) {
+        fprintf(stdout, "# Progress: helper thread polling MPI_Test, no probes in the compute\n");
+    } else if (options.num_probes) {
+        fprintf(stdout, "# Progress: %d MPI_Test probes in the compute\n",
+                options.num_probes);
+    }
+
+    if (PERSISTENT == options.subtype) {
+        fprintf(stdout, "# Overall = MPI_Start + Compute + MPI_Test + MPI_Wait\n");
+        fprintf(stdout, "# Persistent init is the one-off cost of the *_init call\n\n");
+    } else {
+        fprintf(stdout, "# Overall = Coll. Init + Compute + MPI_Test + MPI_Wait\n\n");
+    }
+
+    if (options.show_size) {
+        fprintf(stdout, "%-*s", 10, "# Size");
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Overall(us)");
+    } else {
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Overall(us)");
+    }
+
+    if (options.show_full) {
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Compute(us)");
+        fprintf(stdout, "%*s", FIELD_WIDTH, (PERSISTENT == options.subtype) ?
+                "MPI_Start(us)" : "Coll. Init(us)");
+        fprintf(stdout, "%*s", FIELD_WIDTH, "MPI_Test(us)");
+        fprintf(stdout, "%*s", FIELD_WIDTH, "MPI_Wait(us)");
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Pure Comm.(us)");
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Overlap(%)");
+
+    } else {
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Compute(us)");
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Pure Comm.(us)");
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Overlap(%)");
+    }
+
+    if (PERSISTENT == options.subtype) {
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Persist Init(us)");
+    }
+
+    if (SHOW_SLOWDOWN) {
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Slowdown(%)");
+    }
+
+    print_extra_header();
+    fprintf(stdout, "\n");
+    fflush(stdout);
+}
+
+void display_nbc_params()
+{
+    if (options.show_full) {
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Compute(us)");
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Coll. Init(us)");
+        fprintf(stdout, "%*s", FIELD_WIDTH, "MPI_Test(us)");
+        fprintf(stdout, "%*s", FIELD_WIDTH, "MPI_Wait(us)");
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Pure Comm.(us)");
+        fprintf(stdout, "%*s\n", FIELD_WIDTH, "Overlap(%)");
+
+    } else {
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Compute(us)");
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Pure Comm.(us)");
+        fprintf(stdout, "%*s\n", FIELD_WIDTH, "Overlap(%)");
+    }
+}
+
+void print_preamble (int rank)
+{
+    if (0 == rank && options.outlier_top) {
+        setup_rank_outliers();
+    }
+
+    if (rank || OUTPUT_TABLE != options.output_format) {
+        return;
+    }
+
+    fprintf(stdout, "\n");
+
+    switch (options.accel) {
+        case CUDA:
+            printf(benchmark_header, "-CUDA");
+            break;
+        case OPENACC:
+            printf(benchmark_header, "-OPENACC");
+            break;
+        case ROCM:
+            printf(benchmark_header, "-ROCM");
+            break;
+        case SYCL:
+            printf(benchmark_header, "-SYCL");
+            break;
+        default:
+            printf(benchmark_header, "");
+            break;
+    }
+
+    print_timer_summary();
+
+    if (HIER_ON == options.hierarchical) {
+        print_hierarchy_summary();
+    }
+
+    if (PIPELINE_ON == options.pipeline) {
+        fprintf(stdout, "# Pipeline: %zu byte chunks, %d in flight\n",
+                options.pipeline_chunk, options.pipeline_depth);
+    }
+
+    if (STENCIL_NONE != options.stencil) {
+        print_stencil_summary();
+    }
+
+    if (BACKEND_NCCL == options.backend) {
+        fprintf(stdout, "# Backend: %s, timed with device events\n",
+                ROCM == options.accel ? "RCCL" : "NCCL");
+    }
+
+    print_reduction_summary();
+    print_count_summary();
+
+    if (options.show_size) {
+        fprintf(stdout, "%-*s", 10, "# Size");
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Avg Latency(us)");
+    } else {
+        fprintf(stdout, "# Avg Latency(us)");
+    }
+
+    if (options.show_full) {
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Min Latency(us)");
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Max Latency(us)");
+        fprintf(stdout, "%*s", 12, "Iterations");
+    }
+
+    if (options.show_percentiles) {
+        fprintf(stdout, "%*s", FIELD_WIDTH, "P50(us)");
+        fprintf(stdout, "%*s", FIELD_WIDTH, "P90(us)");
+        fprintf(stdout, "%*s", FIELD_WIDTH, "P99(us)");
+        fprintf(stdout, "%*s", FIELD_WIDTH, "P99.9(us)");
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Max Iter(us)");
+    }
+
+    if (options.converge.target > 0.0) {
+        if (!options.show_full) {
+            fprintf(stdout, "%*s", 12, "Iterations");
+        }
+        fprintf(stdout, "%*s", 12, "CI(+/-%)");
+    }
+
+    if (HIER_ON == options.hierarchical) {
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Hier Avg(us)");
+        fprintf(stdout, "%*s", 12, "Speedup");
+    }
+
+    if (PIPELINE_ON == options.pipeline) {
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Pipe Avg(us)");
+        fprintf(stdout, "%*s", 12, "Winner");
+    }
+
+    if (STENCIL_NONE != options.stencil) {
+        fprintf(stdout, "%*s", FIELD_WIDTH, "P2P Avg(us)");
+        fprintf(stdout, "%*s", 12, "Speedup");
+    }
+
+    print_extra_header();
+    fprintf(stdout, "\n");
+    fflush(stdout);
+}
+
+void calculate_and_print_stats(int rank, int size, int numprocs,
+                          double timer, double latency,
+                          double test_time, double cpu_time,
+                          double wait_time, double init_time)
+{
+    double test_total   = (test_time * 1e6) / options.iterations;
+    double tcomp_total  = (cpu_time * 1e6) / options.iterations;
+    double overall_time = (timer * 1e6) / options.iterations;
+    double wait_total   = (wait_time * 1e6) / options.iterations;
+    double init_total   = (init_time * 1e6) / options.iterations;
+    double comm_time   = latency;
+
+    if(rank != 0) {
+        MPI_CHECK(MPI_Reduce(&test_total, &test_total, 1, MPI_DOUBLE, MPI_SUM, 0,
+                   MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Reduce(&comm_time, &comm_time, 1, MPI_DOUBLE, MPI_SUM, 0,
+                   MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Reduce(&overall_time, &overall_time, 1, MPI_DOUBLE, MPI_SUM, 0,
+                   MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Reduce(&tcomp_total, &tcomp_total, 1, MPI_DOUBLE, MPI_SUM, 0,
+                   MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Reduce(&wait_total, &wait_total, 1, MPI_DOUBLE, MPI_SUM, 0,
+                   MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Reduce(&init_total, &init_total, 1, MPI_DOUBLE, MPI_SUM, 0,
+                   MPI_COMM_WORLD));
+    } else {
+        MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, &test_total, 1, MPI_DOUBLE, MPI_SUM, 0,
+                   MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, &comm_time, 1, MPI_DOUBLE, MPI_SUM, 0,
+                   MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, &overall_time, 1, MPI_DOUBLE, MPI_SUM, 0,
+                   MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, &tcomp_total, 1, MPI_DOUBLE, MPI_SUM, 0,
+                   MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, &wait_total, 1, MPI_DOUBLE, MPI_SUM, 0,
+                   MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, &init_total, 1, MPI_DOUBLE, MPI_SUM, 0,
+                   MPI_COMM_WORLD));
+    }
+
+    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+    /* Overall Time (Overlapped) */
+    overall_time = overall_time/numprocs;
+    /* Computation Time */
+    tcomp_total = tcomp_total/numprocs;
+    /* Time taken by MPI_Test calls */
+    test_total = test_total/numprocs;
+    /* Pure Communication Time */
+    comm_time = comm_time/numprocs;
+    /* Time for MPI_Wait() call */
+    wait_total = wait_total/numprocs;
+    /* Time for the NBC call */
+    init_total = init_total/numprocs;
+
+    if (PERSISTENT == options.subtype) {
+        MPI_CHECK(MPI_Reduce(rank ? &persistent_init_latency : MPI_IN_PLACE,
+                    &persistent_init_latency, 1, MPI_DOUBLE, MPI_SUM, 0,
+                    MPI_COMM_WORLD));
+        persistent_init_latency /= numprocs;
+    }
+
+    if (SHOW_SLOWDOWN) {
+        compute_slowdown = host_compute_slowdown(numprocs);
+    }
+
+    print_stats_nbc(rank, size, overall_time, tcomp_total, comm_time,
+                    wait_total, init_total, test_total);
+
+}
+
+void print_stats_nbc (int rank, int size, double overall_time,
+                 double cpu_time, double comm_time,
+                 double wait_time, double init_time,
+                 double test_time)
+{
+    if (rank) {
+        return;
+    }
+
+    double overlap;
+    int numprocs;
+
+    /* Note : cpu_time received in this function includes time for
+       *      dummy compute as well as test calls so we will subtract
+       *      the test_time for overlap calculation as test is an
+       *      overhead
+       */
+
+    overlap = MAX(0, 100 - (((overall_time - (cpu_time - test_time)) / comm_time) * 100));
+
+    record_message_size(size, overall_time);
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    record_model_point(FIT_LOGGP_OVERHEAD, numprocs, size,
+            overall_time - (cpu_time - test_time));
+
+    if (OUTPUT_TABLE != options.output_format) {
+        int nmetrics = options.show_full ? 7 : 4;
+        struct result_metric_t metrics[9 + MAX_EXTRA_COLUMNS] = {
+            {"overall_us", overall_time},
+            {"compute_us", cpu_time - test_time},
+            {"pure_comm_us", comm_time},
+            {"overlap_pct", overlap},
+            {"coll_init_us", init_time},
+            {"mpi_test_us", test_time},
+            {"mpi_wait_us", wait_time},
+        };
+
+        if (PERSISTENT == options.subtype) {
+            metrics[4].name = "mpi_start_us";
+            metrics[nmetrics++] = (struct result_metric_t){"persistent_init_us",
+                persistent_init_latency};
+        }
+
+        if (SHOW_SLOWDOWN) {
+            metrics[nmetrics++] = (struct result_metric_t){"compute_slowdown_pct",
+                compute_slowdown};
+        }
+
+        nmetrics = add_extra_metrics(metrics, nmetrics);
+        output_result(numprocs, size, nmetrics, metrics);
+        return;
+    }
+
+    if (options.show_size) {
+        fprintf(stdout, "%-*d", 10, size);
+        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, overall_time);
+    } else {
+        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, overall_time);
+    }
+
+    if (options.show_full) {
+        fprintf(stdout, "%*.*f%*.*f%*.*f%*.*f%*.*f%*.*f",
+                FIELD_WIDTH, FLOAT_PRECISION, (cpu_time - test_time),
+                FIELD_WIDTH, FLOAT_PRECISION, init_time,
+                FIELD_WIDTH, FLOAT_PRECISION, test_time,
+                FIELD_WIDTH, FLOAT_PRECISION, wait_time,
+                FIELD_WIDTH, FLOAT_PRECISION, comm_time,
+                FIELD_WIDTH, FLOAT_PRECISION, overlap);
+    } else {
+        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, (cpu_time - test_time));
+        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, comm_time);
+        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, overlap);
+    }
+
+    if (PERSISTENT == options.subtype) {
+        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                persistent_init_latency);
+    }
+
+    if (SHOW_SLOWDOWN) {
+        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                compute_slowdown);
+    }
+
+    print_extra_values();
+    fprintf(stdout, "\n");
+    fflush(stdout);
+}
+
+/*
+ * Adaptive size schedules decide on rank 0; every rank follows its choice.
+ */
+void agree_message_size (size_t * size)
+{
+    uint64_t value = *size;
+
+    MPI_CHECK(MPI_Bcast(&value, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD));
+    *size = value;
+}
+
+/*
+ * The ranks of the completion markers of --checkpoint: those of the benchmark
+ * as osu_suite or the benchmark set them, otherwise the whole job.
+ */
+int checkpoint_num_ranks (void)
+{
+    int initialized = 0, numprocs = 0;
+
+    if (benchmark_num_ranks) {
+        return benchmark_num_ranks;
+    }
+
+    MPI_CHECK(MPI_Initialized(&initialized));
+    if (initialized) {
+        MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    }
+
+    return numprocs;
+}
+
+/*
+ * Merge the per-rank latency histograms into rank 0.  Must be called by all
+ * ranks of MPI_COMM_WORLD.
+ */
+void hist_reduce (int rank, struct latency_hist_t * hist)
+{
+    double min_time = hist->min < 0 ? HUGE_VAL : hist->min;
+
+    if (rank == 0) {
+        MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, hist->bucket, HIST_NUM_BUCKETS,
+                    MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, &hist->count, 1, MPI_UINT64_T,
+                    MPI_SUM, 0, MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, &hist->max, 1, MPI_DOUBLE, MPI_MAX,
+                    0, MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Reduce(MPI_IN_PLACE, &min_time, 1, MPI_DOUBLE, MPI_MIN,
+                    0, MPI_COMM_WORLD));
+        hist->min = min_time;
+    } else {
+        MPI_CHECK(MPI_Reduce(hist->bucket, NULL, HIST_NUM_BUCKETS, MPI_UINT64_T,
+                    MPI_SUM, 0, MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Reduce(&hist->count, NULL, 1, MPI_UINT64_T, MPI_SUM, 0,
+                    MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Reduce(&hist->max, NULL, 1, MPI_DOUBLE, MPI_MAX, 0,
+                    MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Reduce(&min_time, NULL, 1, MPI_DOUBLE, MPI_MIN, 0,
+                    MPI_COMM_WORLD));
+    }
+}
+
+/*
+ * Topology discovery
+ *
+ * Nodes are told apart with MPI_Comm_split_type() and numbered by their first
+ * rank, sockets are read from sysfs for the CPU the rank currently runs on,
+ * so ranks should be bound for the socket classes to be meaningful.
+ */
+static int current_socket (void)
+{
+    char path[128], stat[1024], * field;
+    int i, cpu = -1, socket = 0;
+    FILE * fp;
+
+    /* Field 39 of /proc/self/stat is the CPU the process last ran on */
+    if (NULL != (fp = fopen("/proc/self/stat", "r"))) {
+        if (fgets(stat, sizeof(stat), fp) && (field = strrchr(stat, ')'))) {
+            for (i = 2; i < 39 && field; i++) {
+                field = strchr(field + 1, ' ');
+            }
+
+            if (field) {
+                cpu = atoi(field + 1);
+            }
+        }
+        fclose(fp);
+    }
+
+    if (0 > cpu) {
+        return 0;
+    }
+
+    snprintf(path, sizeof(path),
+            "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+
+    if (NULL != (fp = fopen(path, "r"))) {
+        if (1 != fscanf(fp, "%d", &socket)) {
+            socket = 0;
+        }
+        fclose(fp);
+    }
+
+    return socket;
+}
+
+static int classify_pair (int const * location, int a, int b)
+{
+    int node_a = location[2 * a], node_b = location[2 * b];
+
+    if (node_a != node_b) {
+        if (options.nodes_per_switch && node_a / options.nodes_per_switch
+                != node_b / options.nodes_per_switch) {
+            return LOCALITY_INTER_SWITCH;
+        }
+
+        return LOCALITY_INTER_NODE;
+    }
+
+    return (location[2 * a + 1] != location[2 * b + 1])
+        ? LOCALITY_INTER_SOCKET : LOCALITY_INTRA_SOCKET;
+}
+
+static int pair_matches (int locality)
+{
+    switch (options.pairing) {
+        case PAIRING_INTRA_SOCKET:
+            return LOCALITY_INTRA_SOCKET == locality;
+        case PAIRING_INTER_SOCKET:
+            return LOCALITY_INTER_SOCKET == locality;
+        case PAIRING_INTRA_NODE:
+            return LOCALITY_INTER_NODE > locality;
+        case PAIRING_INTER_NODE:
+            return LOCALITY_INTER_NODE <= locality;
+        case PAIRING_CROSS_SWITCH:
+            return LOCALITY_INTER_SWITCH == locality;
+        default:
+            return 1;
+    }
+}
+
+/*
+ * Every rank runs the same deterministic matching on the gathered locations,
+ * so no further communication is needed.  Block pairing reproduces the rank i
+ * / rank i + pairs layout; the other patterns greedily pair each free rank
+ * with the lowest free rank that has the requested locality.  Returns 0 on
+ * success and -1 if no pair matches the pattern.
+ */
+int setup_pairing (int rank, int nprocs, int max_pairs)
+{
+    int * location, * partner, * order;
+    int i, j, me[2], npairs = 0, idle;
+    MPI_Comm node_comm, leader_comm;
+    int node_rank, node = 0;
+
+    MPI_CHECK(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0,
+                MPI_INFO_NULL, &node_comm));
+    MPI_CHECK(MPI_Comm_rank(node_comm, &node_rank));
+    MPI_CHECK(MPI_Comm_split(MPI_COMM_WORLD, node_rank ? MPI_UNDEFINED : 0,
+                rank, &leader_comm));
+
+    if (0 == node_rank) {
+        MPI_CHECK(MPI_Comm_rank(leader_comm, &node));
+        MPI_CHECK(MPI_Comm_free(&leader_comm));
+    }
+
+    MPI_CHECK(MPI_Bcast(&node, 1, MPI_INT, 0, node_comm));
+    MPI_CHECK(MPI_Comm_free(&node_comm));
+
+    me[0] = node;
+    me[1] = current_socket();
+
+    location = malloc(2 * nprocs * sizeof(int));
+    partner = malloc(nprocs * sizeof(int));
+    order = malloc(nprocs * sizeof(int));
+
+    if (NULL == location || NULL == partner || NULL == order) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    MPI_CHECK(MPI_Allgather(me, 2, MPI_INT, location, 2, MPI_INT,
+                MPI_COMM_WORLD));
+
+    for (i = 0; i < nprocs; i++) {
+        partner[i] = -1;
+    }
+
+    /* order[k] is the sender of pair k */
+    if (PAIRING_BLOCK == options.pairing || PAIRING_NONE == options.pairing) {
+        for (npairs = 0; npairs < max_pairs && npairs + max_pairs < nprocs;
+                npairs++) {
+            partner[npairs] = npairs + max_pairs;
+            partner[npairs + max_pairs] = npairs;
+            order[npairs] = npairs;
+        }
+    } else {
+        for (i = 0; i < nprocs && npairs < max_pairs; i++) {
+            if (0 <= partner[i]) {
+                continue;
+            }
+
+            for (j = i + 1; j < nprocs; j++) {
+                if (0 > partner[j] && pair_matches(classify_pair(location, i, j))) {
+                    partner[i] = j;
+                    partner[j] = i;
+                    order[npairs++] = i;
+                    break;
+                }
+            }
+        }
+    }
+
+    memset(&pairing, 0, sizeof(pairing));
+    pairing.num_pairs = npairs;
+    pairing.partner = partner[rank];
+    pairing.locality = -1;
+    pairing.vrank = 2 * npairs;
+
+    for (i = 0; i < npairs; i++) {
+        int locality = classify_pair(location, order[i], partner[order[i]]);
+
+        pairing.class_pairs[locality]++;
+
+        if (order[i] == rank || partner[order[i]] == rank) {
+            pairing.vrank = (order[i] == rank) ? i : i + npairs;
+            pairing.locality = locality;
+        }
+    }
+
+    /* Idle ranks keep their relative order after the paired ones */
+    for (i = 0, idle = 2 * npairs; i < rank; i++) {
+        if (0 > partner[i]) {
+            idle++;
+        }
+    }
+
+    if (0 > pairing.partner) {
+        pairing.vrank = idle;
+    }
+
+    free(location);
+    free(partner);
+    free(order);
+
+    return npairs ? 0 : -1;
+}
+
+/*
+ * Sum VALUE over the ranks of each locality class; idle ranks contribute
+ * nothing.  SUMS needs LOCALITY_CLASSES entries and is only valid on rank 0.
+ */
+void reduce_by_locality (double value, double * sums)
+{
+    double local[LOCALITY_CLASSES] = {0};
+
+    if (0 <= pairing.locality) {
+        local[pairing.locality] = value;
+    }
+
+    MPI_CHECK(MPI_Reduce(local, sums, LOCALITY_CLASSES, MPI_DOUBLE, MPI_SUM, 0,
+                MPI_COMM_WORLD));
+}
+
+/*
+ * Clock Offset
+ *
+ * Both ranks of the pair must call this.  The lower rank runs ROUNDS ping
+ * pongs and keeps the midpoint estimate of the round trip with the smallest
+ * RTT, which bounds the error by half of that RTT.  Returns the peer's
+ * MPI_Wtime() minus the local one.
+ */
+#define CLOCK_OFFSET_TAG 0x7c10
+
+double estimate_clock_offset (int peer, int rounds)
+{
+    int rank, r;
+    double t0, t1, remote, rtt, best_rtt = -1.0, offset = 0.0;
+
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+
+    for (r = 0; r < rounds; r++) {
+        if (rank < peer) {
+            t0 = osu_wtime();
+            MPI_CHECK(MPI_Send(&t0, 1, MPI_DOUBLE, peer, CLOCK_OFFSET_TAG,
+                        MPI_COMM_WORLD));
+            MPI_CHECK(MPI_Recv(&remote, 1, MPI_DOUBLE, peer, CLOCK_OFFSET_TAG,
+                        MPI_COMM_WORLD, MPI_STATUS_IGNORE));
+            t1 = osu_wtime();
+
+            rtt = t1 - t0;
+            if (best_rtt < 0 || rtt < best_rtt) {
+                best_rtt = rtt;
+                offset = remote - (t0 + t1) / 2;
+            }
+        } else {
+            MPI_CHECK(MPI_Recv(&t0, 1, MPI_DOUBLE, peer, CLOCK_OFFSET_TAG,
+                        MPI_COMM_WORLD, MPI_STATUS_IGNORE));
+            remote = osu_wtime();
+            MPI_CHECK(MPI_Send(&remote, 1, MPI_DOUBLE, peer, CLOCK_OFFSET_TAG,
+                        MPI_COMM_WORLD));
+        }
+    }
+
+    if (rank < peer) {
+        MPI_CHECK(MPI_Send(&offset, 1, MPI_DOUBLE, peer, CLOCK_OFFSET_TAG,
+                    MPI_COMM_WORLD));
+    } else {
+        MPI_CHECK(MPI_Recv(&offset, 1, MPI_DOUBLE, peer, CLOCK_OFFSET_TAG,
+                    MPI_COMM_WORLD, MPI_STATUS_IGNORE));
+        offset = -offset;
+    }
+
+    return offset;
+}
+
+/*
+ * Global Clock
+ *
+ * sync_global_clock() estimates the offset of every rank against rank 0 with
+ * estimate_clock_offset(), one rank after the other.  Once a second has
+ * passed since the first call, the change of the offset since then gives the
+ * drift, so global_wtime() can extrapolate between calls: it returns the
+ * time on the clock of rank 0 in seconds since the first synchronization.  The
+ * benchmarks call start_global_clock() before every size, which syncs again
+ * and resets the samples, mark the timed iterations with mark_global_time(),
+ * and stop_global_clock() turns the samples into the extra columns:
+ *
+ *   pt2pt       the one way latency 0 to 1 and 1 to 0, the time between the
+ *               send of one rank and the end of the receive on the other
+ *   collective  per iteration the entry skew, the last entry minus the
+ *               first, and the first and the last exit after the entry of
+ *               rank 0, averaged over the iterations
+ */
+#define GLOBAL_CLOCK_ROUNDS         20
+#define GLOBAL_CLOCK_MIN_BASELINE   1.0
+
+static struct {
+    double offset;
+    double drift;
+    double sync_time;
+    double first_offset;
+    double first_time;
+    double base;
+    int synced;
+    int base_column;
+    int num_columns;
+    int capacity;
+    int count;
+    double * entry;
+    double * exit;
+    double sum[GT_NUM * 2];
+} global_clock;
+
+static char const * one_way_column[] = {"0->1 (us)", "1->0 (us)"};
+static char const * skew_column[] = {"Entry skew (us)", "First exit (us)",
+    "Last exit (us)"};
+
+void sync_global_clock (void)
+{
+    int rank, numprocs, peer;
+    double offset = 0, now;
+
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+
+    for (peer = 1; peer < numprocs; peer++) {
+        if (0 == rank) {
+            estimate_clock_offset(peer, GLOBAL_CLOCK_ROUNDS);
+        } else if (peer == rank) {
+            offset = estimate_clock_offset(0, GLOBAL_CLOCK_ROUNDS);
+        }
+    }
+
+    now = osu_wtime();
+
+    /*
+     * Against the first sync, the longer baseline averages out the error of
+     * the offsets, which over a short one would dominate the drift
+     */
+    if (global_clock.synced &&
+            now - global_clock.first_time > GLOBAL_CLOCK_MIN_BASELINE) {
+        global_clock.drift = (offset - global_clock.first_offset) /
+            (now - global_clock.first_time);
+    }
+
+    global_clock.offset = offset;
+    global_clock.sync_time = now;
+
+    if (!global_clock.synced) {
+        global_clock.first_offset = offset;
+        global_clock.first_time = now;
+
+        /* All ranks start counting at the same instant of rank 0 */
+        global_clock.base = now + offset;
+        MPI_CHECK(MPI_Bcast(&global_clock.base, 1, MPI_DOUBLE, 0,
+                    MPI_COMM_WORLD));
+        global_clock.synced = 1;
+    }
+}
+
+/*
+ * Local osu_wtime() T on the global clock, against the last sync; times taken
+ * before it are extrapolated back with the drift
+ */
+double to_global_time (double t)
+{
+    return t + global_clock.offset + global_clock.drift *
+        (t - global_clock.sync_time) - global_clock.base;
+}
+
+double global_wtime (void)
+{
+    return to_global_time(osu_wtime());
+}
+
+/*
+ * Collective.  Returns 0 when the benchmark should go on, which it also does
+ * without --global-clock, and 1 when the sample arrays cannot be allocated.
+ */
+int setup_global_clock (int rank)
+{
+    char const ** names = PT2PT == options.bench ? one_way_column :
+        skew_column;
+    int i, n;
+
+    if (GLOBAL_CLOCK_ON != options.global_clock) {
+        return 0;
+    }
+
+    if (COLLECTIVE == options.bench) {
+        global_clock.capacity = MAX(options.iterations,
+                options.iterations_large);
+        global_clock.entry = malloc(sizeof(double) * 4 *
+                global_clock.capacity);
+
+        if (NULL == global_clock.entry) {
+            fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+            return 1;
+        }
+
+        global_clock.exit = global_clock.entry + 2 * global_clock.capacity;
+    }
+
+    global_clock.base_column = extra_columns.num;
+    global_clock.num_columns = PT2PT == options.bench ? 2 : 3;
+
+    for (i = 0; i < global_clock.num_columns; i++) {
+        n = global_clock.base_column + i;
+        snprintf(extra_columns.name[n], sizeof(extra_columns.name[n]), "%s",
+                names[i]);
+        extra_columns.width[n] = MAX(FIELD_WIDTH, (int)strlen(names[i]) + 2);
+    }
+
+    extra_columns.num += global_clock.num_columns;
+    sync_global_clock();
+
+    return 0;
+}
+
+void start_global_clock (void)
+{
+    if (GLOBAL_CLOCK_ON != options.global_clock) {
+        return;
+    }
+
+    sync_global_clock();
+    memset(global_clock.sum, 0, sizeof(global_clock.sum));
+    global_clock.count = 0;
+}
+
+/* I counts the timed iterations from 0, the collectives keep one per index */
+void mark_global_time (enum global_event event, int i)
+{
+    double t = global_wtime();
+
+    if (COLLECTIVE != options.bench) {
+        global_clock.sum[event] += t;
+        return;
+    }
+
+    if (i >= global_clock.capacity) {
+        return;
+    }
+
+    /* The negated copies give the minimum with the same MPI_MAX */
+    if (GT_ENTRY == event) {
+        global_clock.entry[i] = t;
+        global_clock.entry[global_clock.capacity + i] = -t;
+    } else {
+        global_clock.exit[i] = t;
+        global_clock.exit[global_clock.capacity + i] = -t;
+    }
+
+    global_clock.count = MAX(global_clock.count, i + 1);
+}
+
+/* Collective, ITERATIONS is the number of timed iterations */
+void stop_global_clock (int iterations)
+{
+    double local[2 * GT_NUM], sum[2 * GT_NUM], * value, * all = NULL;
+    double skew = 0, first = 0, last = 0;
+    int rank, i, n, c = global_clock.capacity;
+
+    if (GLOBAL_CLOCK_ON != options.global_clock) {
+        return;
+    }
+
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    value = &extra_columns.value[global_clock.base_column];
+
+    if (COLLECTIVE != options.bench) {
+        /* Rank 0 sends and receives into the first pair, rank 1 the second */
+        memset(local, 0, sizeof(local));
+        if (rank < 2) {
+            local[rank * GT_NUM + GT_SEND] = global_clock.sum[GT_SEND];
+            local[rank * GT_NUM + GT_RECV] = global_clock.sum[GT_RECV];
+        }
+
+        MPI_CHECK(MPI_Reduce(local, sum, 2 * GT_NUM, MPI_DOUBLE, MPI_SUM, 0,
+                    MPI_COMM_WORLD));
+
+        if (0 == rank && iterations) {
+            value[0] = (sum[GT_NUM + GT_RECV] - sum[GT_SEND]) * 1e6 /
+                iterations;
+            value[1] = (sum[GT_RECV] - sum[GT_NUM + GT_SEND]) * 1e6 /
+                iterations;
+        }
+
+        return;
+    }
+
+    n = global_clock.count;
+
+    if (0 == rank) {
+        all = malloc(sizeof(double) * 4 * c);
+
+        if (NULL == all) {
+            fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+            MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+        }
+    }
+
+    /* entry, -entry, exit and -exit lie back to back in one array */
+    MPI_CHECK(MPI_Reduce(global_clock.entry, all, 4 * c, MPI_DOUBLE, MPI_MAX,
+                0, MPI_COMM_WORLD));
+
+    if (0 != rank) {
+        return;
+    }
+
+    for (i = 0; i < n; i++) {
+        skew += all[i] + all[c + i];
+        first += -all[3 * c + i] - global_clock.entry[i];
+        last += all[2 * c + i] - global_clock.entry[i];
+    }
+
+    if (n) {
+        value[0] = skew * 1e6 / n;
+        value[1] = first * 1e6 / n;
+        value[2] = last * 1e6 / n;
+    }
+
+    free(all);
+}
+
+void cleanup_global_clock (void)
+{
+    free(global_clock.entry);
+    global_clock.entry = global_clock.exit = NULL;
+}
+
+/*
+ * Send Modes
+ *
+ * With --send-mode the point-to-point benchmarks send in the MPI mode of
+ * options.send_mode.  The buffered mode needs an attached buffer large
+ * enough for COUNT messages of BYTES in flight, setup_send_mode() attaches
+ * one.  MPI may reclaim the space of a message well after its send request
+ * completed, so a benchmark that reuses the buffer for the next COUNT
+ * messages calls drain_send_mode() first.  The persistent mode starts requests the benchmark creates with
+ * MPI_Send_init once per message size, mode_isend() and mode_send() then
+ * take that request instead of creating one.  The ready mode is only correct
+ * if the peer has posted the receive, which is up to the benchmark.
+ */
+static void *send_mode_buffer = NULL;
+
+/* Room for the alignment the library may pad each buffered message to */
+#define SEND_MODE_ALIGNMENT     64
+
+int setup_send_mode (int rank, size_t bytes, int count)
+{
+    size_t size = (bytes + MPI_BSEND_OVERHEAD + SEND_MODE_ALIGNMENT) * count;
+
+    if (SEND_MODE_BUFFERED != options.send_mode) {
+        return 0;
+    }
+
+    /* MPI_Buffer_attach takes an int */
+    if (size > INT_MAX || NULL == (send_mode_buffer = malloc(size))) {
+        fprintf(stderr, "Could not attach a buffer of %zu bytes for "
+                "MPI_Bsend [rank %d]\n", size, rank);
+        return 1;
+    }
+
+    MPI_CHECK(MPI_Buffer_attach(send_mode_buffer, (int)size));
+
+    return 0;
+}
+
+/* Wait until the buffered messages are sent, so all of the buffer is free */
+void drain_send_mode (void)
+{
+    int size;
+
+    if (NULL != send_mode_buffer) {
+        MPI_CHECK(MPI_Buffer_detach(&send_mode_buffer, &size));
+        MPI_CHECK(MPI_Buffer_attach(send_mode_buffer, size));
+    }
+}
+
+void mode_isend (void *buf, int count, MPI_Datatype type, int dest, int tag,
+        MPI_Comm comm, MPI_Request *request)
+{
+    switch (options.send_mode) {
+        case SEND_MODE_SYNC:
+            MPI_CHECK(MPI_Issend(buf, count, type, dest, tag, comm, request));
+            break;
+        case SEND_MODE_READY:
+            MPI_CHECK(MPI_Irsend(buf, count, type, dest, tag, comm, request));
+            break;
+        case SEND_MODE_BUFFERED:
+            MPI_CHECK(MPI_Ibsend(buf, count, type, dest, tag, comm, request));
+            break;
+        case SEND_MODE_PERSISTENT:
+            MPI_CHECK(MPI_Start(request));
+            break;
+        default:
+            MPI_CHECK(MPI_Isend(buf, count, type, dest, tag, comm, request));
+            break;
+    }
+}
+
+void mode_send (void *buf, int count, MPI_Datatype type, int dest, int tag,
+        MPI_Comm comm, MPI_Request *request)
+{
+    switch (options.send_mode) {
+        case SEND_MODE_SYNC:
+            MPI_CHECK(MPI_Ssend(buf, count, type, dest, tag, comm));
+            break;
+        case SEND_MODE_READY:
+            MPI_CHECK(MPI_Rsend(buf, count, type, dest, tag, comm));
+            break;
+        case SEND_MODE_BUFFERED:
+            MPI_CHECK(MPI_Bsend(buf, count, type, dest, tag, comm));
+            break;
+        case SEND_MODE_PERSISTENT:
+            MPI_CHECK(MPI_Start(request));
+            MPI_CHECK(MPI_Wait(request, MPI_STATUS_IGNORE));
+            break;
+        default:
+            MPI_CHECK(MPI_Send(buf, count, type, dest, tag, comm));
+            break;
+    }
+}
+
+void cleanup_send_mode (void)
+{
+    int size;
+
+    if (NULL != send_mode_buffer) {
+        MPI_CHECK(MPI_Buffer_detach(&send_mode_buffer, &size));
+        free(send_mode_buffer);
+        send_mode_buffer = NULL;
+    }
+}
+
+/*
+ * Streaming
+ *
+ * With --stream the bandwidth benchmarks send the largest message size for
+ * options.stream_seconds instead of a fixed number of iterations and print
+ * the bandwidth of every slice of options.stream_slice_ms, which shows how
+ * the throughput holds up over time: dips from page faults, flow control,
+ * thermal throttling or other jobs on the fabric that an average hides.  The
+ * timed loop calls stream_step() before every window on every rank of COMM,
+ * rank 0 of COMM gives the bytes of the window that just completed to the
+ * slices it spans, pro rata, and an allreduce tells all ranks whether the
+ * time is up.  The allreduce also keeps the ranks in step, a window that
+ * another rank finishes late is counted at most one window late.
+ * Without --stream stream_step() is the usual loop condition and costs
+ * nothing.
+ */
+static struct {
+    double start;
+    double last;
+    int slices;
+    double *bytes;
+} stream;
+
+int setup_stream (int rank)
+{
+    char const *conflict = NULL;
+
+    if (STREAM_ON != options.stream) {
+        return 0;
+    }
+
+    if (TUNE_ON == options.tune) {
+        conflict = "-J";
+    } else if (SEND_MODE_READY == options.send_mode) {
+        conflict = "--send-mode ready";
+    } else if (options.window_varied) {
+        conflict = "-V";
+    }
+
+    if (conflict) {
+        if (0 == rank) {
+            fprintf(stderr, "--stream cannot be combined with %s\n",
+                    conflict);
+        }
+        return 1;
+    }
+
+    options.min_message_size = options.max_message_size;
+    stream.slices = (int)ceil(options.stream_seconds * 1e3 /
+            options.stream_slice_ms);
+
+    /* One slice more takes the bytes of the window that ends past the time */
+    stream.bytes = calloc(stream.slices + 1, sizeof(double));
+
+    if (NULL == stream.bytes) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        return 1;
+    }
+
+    return 0;
+}
+
+static void stream_record (double bytes, double from, double to)
+{
+    double slice = options.stream_slice_ms / 1e3, a, b;
+    int k = (int)(from / slice);
+
+    if (to <= from) {
+        stream.bytes[MIN(k, stream.slices)] += bytes;
+        return;
+    }
+
+    for (; k <= stream.slices && k * slice < to; k++) {
+        a = MAX(from, k * slice);
+        b = k == stream.slices ? to : MIN(to, (k + 1) * slice);
+        stream.bytes[k] += bytes * (b - a) / (to - from);
+    }
+}
+
+int stream_step (int i, double bytes, MPI_Comm comm)
+{
+    int rank, more = 1, all;
+    double now;
+
+    if (STREAM_ON != options.stream) {
+        return i < options.skip + options.iterations;
+    }
+
+    MPI_CHECK(MPI_Comm_rank(comm, &rank));
+
+    if (0 == rank && i >= options.skip) {
+        now = osu_wtime();
+
+        if (i == options.skip) {
+            stream.start = stream.last = now;
+        } else {
+            stream_record(bytes, stream.last - stream.start,
+                    now - stream.start);
+            stream.last = now;
+            more = now - stream.start < options.stream_seconds;
+        }
+    }
+
+    MPI_CHECK(MPI_Allreduce(&more, &all, 1, MPI_INT, MPI_MIN, comm));
+
+    return all;
+}
+
+void report_stream (int rank, size_t size)
+{
+    double slice = options.stream_slice_ms / 1e3, length, t, mbps;
+    double total = 0, min = 0, max = 0, t_min = 0, t_max = 0;
+    int k;
+
+    if (0 != rank) {
+        return;
+    }
+
+    for (k = 0; k < stream.slices; k++) {
+        length = MIN(slice, options.stream_seconds - k * slice);
+        t = k * slice + length;
+        mbps = stream.bytes[k] / 1e6 / length;
+        total += stream.bytes[k];
+
+        if (0 == k || mbps < min) {
+            min = mbps;
+            t_min = t;
+        }
+
+        if (0 == k || mbps > max) {
+            max = mbps;
+            t_max = t;
+        }
+
+        if (OUTPUT_TABLE == options.output_format) {
+            fprintf(stdout, "%-*.*f%*.*f\n", 12, 3, t, FIELD_WIDTH,
+                    FLOAT_PRECISION, mbps);
+        } else {
+            struct result_metric_t metrics[2] = {
+                {"time_s", t},
+                {"bandwidth_MBps", mbps},
+            };
+
+            output_result(benchmark_num_ranks, size, 2, metrics);
+        }
+    }
+
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "# Sustained (MB/s): avg %.*f, min %.*f at %.3f s, "
+                "max %.*f at %.3f s\n", FLOAT_PRECISION,
+                total / 1e6 / options.stream_seconds, FLOAT_PRECISION, min,
+                t_min, FLOAT_PRECISION, max, t_max);
+    }
+
+    fflush(stdout);
+}
+
+void cleanup_stream (void)
+{
+    free(stream.bytes);
+    stream.bytes = NULL;
+}
+
+/*
+ * Large Count
+ *
+ * Messages of more than INT_MAX bytes do not fit the int count of the MPI-3
+ * functions.  With MPI-4 they can go through the _c functions, which take an
+ * MPI_Count; otherwise, or with --large-count datatype, they are sent as
+ * elements of a contiguous datatype of LARGE_COUNT_CHUNK bytes, in a struct
+ * with the remaining bytes where the size is not a multiple of it.  Messages
+ * that fit an int always take the plain functions.
+ */
+int setup_large_count (int rank)
+{
+    if (LARGE_COUNT_AUTO == options.large_count) {
+#if MPI_VERSION >= 4
+        options.large_count = LARGE_COUNT_C;
+#else
+        options.large_count = LARGE_COUNT_DATATYPE;
+#endif
+    }
+
+#if MPI_VERSION < 4
+    if (LARGE_COUNT_C == options.large_count) {
+        if (0 == rank) {
+            fprintf(stderr, "The MPI library does not provide the MPI-4 "
+                    "large-count functions\n");
+        }
+
+        return 1;
+    }
+#endif
+
+    return 0;
+}
+
+char const * large_count_path (size_t bytes)
+{
+    if (bytes <= INT_MAX) {
+        return "int";
+    }
+
+    return LARGE_COUNT_C == options.large_count ? "MPI_Count" : "datatype";
+}
+
+/* Count of the committed datatype TYPE for BYTES bytes */
+static int large_count_type (size_t bytes, MPI_Datatype * type)
+{
+    MPI_Datatype types[2];
+    MPI_Aint displs[2];
+    int blocks[2];
+    size_t chunks = bytes / LARGE_COUNT_CHUNK;
+
+    MPI_CHECK(MPI_Type_contiguous(LARGE_COUNT_CHUNK, MPI_CHAR, &types[0]));
+
+    if (0 == bytes % LARGE_COUNT_CHUNK) {
+        *type = types[0];
+        MPI_CHECK(MPI_Type_commit(type));
+
+        return chunks;
+    }
+
+    types[1] = MPI_CHAR;
+    blocks[0] = chunks;
+    blocks[1] = bytes % LARGE_COUNT_CHUNK;
+    displs[0] = 0;
+    displs[1] = chunks * LARGE_COUNT_CHUNK;
+
+    MPI_CHECK(MPI_Type_create_struct(2, blocks, displs, types, type));
+    MPI_CHECK(MPI_Type_commit(type));
+    MPI_CHECK(MPI_Type_free(&types[0]));
+
+    return 1;
+}
+
+void large_count_isend (void * buf, size_t bytes, int dest, int tag,
+        MPI_Comm comm, MPI_Request * request)
+{
+    MPI_Datatype type;
+    int count;
+
+    if (bytes <= INT_MAX) {
+        MPI_CHECK(MPI_Isend(buf, bytes, MPI_CHAR, dest, tag, comm, request));
+        return;
+    }
+
+#if MPI_VERSION >= 4
+    if (LARGE_COUNT_C == options.large_count) {
+        MPI_CHECK(MPI_Isend_c(buf, bytes, MPI_CHAR, dest, tag, comm,
+                    request));
+        return;
+    }
+#endif
+
+    count = large_count_type(bytes, &type);
+    MPI_CHECK(MPI_Isend(buf, count, type, dest, tag, comm, request));
+    MPI_CHECK(MPI_Type_free(&type));
+}
+
+void large_count_irecv (void * buf, size_t bytes, int source, int tag,
+        MPI_Comm comm, MPI_Request * request)
+{
+    MPI_Datatype type;
+    int count;
+
+    if (bytes <= INT_MAX) {
+        MPI_CHECK(MPI_Irecv(buf, bytes, MPI_CHAR, source, tag, comm,
+                    request));
+        return;
+    }
+
+#if MPI_VERSION >= 4
+    if (LARGE_COUNT_C == options.large_count) {
+        MPI_CHECK(MPI_Irecv_c(buf, bytes, MPI_CHAR, source, tag, comm,
+                    request));
+        return;
+    }
+#endif
+
+    count = large_count_type(bytes, &type);
+    MPI_CHECK(MPI_Irecv(buf, count, type, source, tag, comm, request));
+    MPI_CHECK(MPI_Type_free(&type));
+}
+
+void large_count_bcast (void * buf, size_t bytes, int root, MPI_Comm comm)
+{
+    MPI_Datatype type;
+    int count;
+
+    if (bytes <= INT_MAX) {
+        MPI_CHECK(MPI_Bcast(buf, bytes, MPI_CHAR, root, comm));
+        return;
+    }
+
+#if MPI_VERSION >= 4
+    if (LARGE_COUNT_C == options.large_count) {
+        MPI_CHECK(MPI_Bcast_c(buf, bytes, MPI_CHAR, root, comm));
+        return;
+    }
+#endif
+
+    count = large_count_type(bytes, &type);
+    MPI_CHECK(MPI_Bcast(buf, count, type, root, comm));
+    MPI_CHECK(MPI_Type_free(&type));
+}
+
+/*
+ * The largest buffer every rank of COMM can allocate BUFFERS times, its share
+ * of LARGE_COUNT_MEM_SHARE of the memory available on its node, or 0 where
+ * the available memory is not known.
+ */
+size_t large_count_memory_limit (MPI_Comm comm, int buffers)
+{
+    MPI_Comm node_comm;
+    int local_ranks;
+    long kb = available_memory_kb();
+    double limit, min_limit;
+
+    MPI_CHECK(MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0,
+                MPI_INFO_NULL, &node_comm));
+    MPI_CHECK(MPI_Comm_size(node_comm, &local_ranks));
+    MPI_CHECK(MPI_Comm_free(&node_comm));
+
+    limit = kb < 0 ? -1.0 :
+        kb * 1024.0 * LARGE_COUNT_MEM_SHARE / local_ranks / buffers;
+
+    /* A rank that does not know takes no part in the minimum */
+    if (limit < 0) {
+        limit = (double)SIZE_MAX;
+    }
+
+    MPI_CHECK(MPI_Allreduce(&limit, &min_limit, 1, MPI_DOUBLE, MPI_MIN,
+                comm));
+
+    return min_limit >= (double)SIZE_MAX ? 0 : (size_t)min_limit;
+}
+
+/*
+ * MPI-IO
+ *
+ * The MPI-IO benchmarks share one file on MPI_COMM_WORLD, opened with the
+ * hints of --io-hints and deleted when it is closed.  Every rank accesses
+ * BYTES per call through its file view: with the contiguous view a block of
+ * BYTES at rank * BYTES, with the strided view blocks of IO_STRIDE_BLOCK
+ * bytes that alternate between the ranks, the pattern that makes collective
+ * buffering pay off.  Either way the calls go to offset 0 of the view and
+ * every iteration overwrites the same NPROCS * BYTES of the file.
+ */
+static struct {
+    MPI_Info info;
+    MPI_Datatype filetype;
+    int nodes;
+} io = {MPI_INFO_NULL, MPI_DATATYPE_NULL, 0};
+
+int setup_io (int rank, MPI_File *fh)
+{
+    char *spec, *item, *save = NULL, message[MPI_MAX_ERROR_STRING];
+    MPI_Comm node_comm;
+    int local_rank, leader, rc, length;
+
+    if (NULL == options.io_file) {
+        options.io_file = IO_DEF_FILE;
+    }
+
+    /* process_options() checked the syntax */
+    if (options.io_hints) {
+        spec = strdup(options.io_hints);
+        MPI_CHECK(MPI_Info_create(&io.info));
+
+        for (item = strtok_r(spec, ",", &save); item;
+                item = strtok_r(NULL, ",", &save)) {
+            char *eq = strchr(item, '=');
+
+            *eq = '\0';
+            MPI_CHECK(MPI_Info_set(io.info, item, eq + 1));
+        }
+
+        free(spec);
+    }
+
+    MPI_CHECK(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0,
+                MPI_INFO_NULL, &node_comm));
+    MPI_CHECK(MPI_Comm_rank(node_comm, &local_rank));
+    MPI_CHECK(MPI_Comm_free(&node_comm));
+
+    leader = 0 == local_rank;
+    MPI_CHECK(MPI_Allreduce(&leader, &io.nodes, 1, MPI_INT, MPI_SUM,
+                MPI_COMM_WORLD));
+
+    rc = MPI_File_open(MPI_COMM_WORLD, (char *)options.io_file,
+            MPI_MODE_CREATE | MPI_MODE_RDWR | MPI_MODE_DELETE_ON_CLOSE,
+            io.info, fh);
+
+    if (MPI_SUCCESS != rc) {
+        if (0 == rank) {
+            MPI_Error_string(rc, message, &length);
+            fprintf(stderr, "Could not open %s: %s\n", options.io_file,
+                    message);
+        }
+        return 1;
+    }
+
+    return 0;
+}
+
+void set_io_view (MPI_File fh, int rank, int nprocs, size_t size)
+{
+    MPI_Datatype vector;
+    MPI_Offset disp = (MPI_Offset)rank * size;
+    int block, blocks;
+
+    if (MPI_DATATYPE_NULL != io.filetype) {
+        MPI_CHECK(MPI_Type_free(&io.filetype));
+    }
+
+    if (FILE_VIEW_STRIDED != options.file_view || 0 == size) {
+        MPI_CHECK(MPI_File_set_view(fh, disp, MPI_BYTE, MPI_BYTE, "native",
+                    io.info));
+        return;
+    }
+
+    block = MIN(size, IO_STRIDE_BLOCK);
+    blocks = (size + block - 1) / block;
+
+    MPI_CHECK(MPI_Type_vector(blocks, block, block * nprocs, MPI_BYTE,
+                &vector));
+    MPI_CHECK(MPI_Type_create_resized(vector, 0,
+                (MPI_Aint)blocks * block * nprocs, &io.filetype));
+    MPI_CHECK(MPI_Type_free(&vector));
+    MPI_CHECK(MPI_Type_commit(&io.filetype));
+
+    MPI_CHECK(MPI_File_set_view(fh, (MPI_Offset)rank * block, MPI_BYTE,
+                io.filetype, "native", io.info));
+}
+
+/* The aggregator hints of ROMIO and Lustre, and whatever the user set */
+void print_io_header (int rank, int nprocs, MPI_File fh)
+{
+    static char const * const keys[] = {"cb_nodes", "cb_buffer_size",
+        "romio_cb_write", "romio_cb_read", "striping_factor",
+        "striping_unit"};
+    char key[MPI_MAX_INFO_KEY + 1], value[MPI_MAX_INFO_VAL + 1];
+    int i, nkeys, flag, printed = 0;
+    MPI_Info info;
+
+    if (0 != rank || OUTPUT_TABLE != options.output_format) {
+        return;
+    }
+
+    printf(benchmark_header, "");
+    print_timer_summary();
+    fprintf(stdout, "# File: %s, %s view, %d ranks on %d nodes\n",
+            options.io_file, FILE_VIEW_STRIDED == options.file_view ?
+            "strided" : "contiguous", nprocs, io.nodes);
+
+    MPI_CHECK(MPI_File_get_info(fh, &info));
+    fprintf(stdout, "# Hints:");
+
+    for (i = 0; i < (int)(sizeof(keys) / sizeof(keys[0])); i++) {
+        MPI_CHECK(MPI_Info_get(info, keys[i], MPI_MAX_INFO_VAL, value,
+                    &flag));
+        if (flag) {
+            fprintf(stdout, " %s=%s", keys[i], value);
+            printed++;
+        }
+    }
+
+    if (MPI_INFO_NULL != io.info) {
+        MPI_CHECK(MPI_Info_get_nkeys(io.info, &nkeys));
+
+        for (i = 0; i < nkeys; i++) {
+            MPI_CHECK(MPI_Info_get_nthkey(io.info, i, key));
+            MPI_CHECK(MPI_Info_get(info, key, MPI_MAX_INFO_VAL, value,
+                        &flag));
+            if (flag && NULL == strstr(" cb_nodes cb_buffer_size "
+                        "romio_cb_write romio_cb_read striping_factor "
+                        "striping_unit ", key)) {
+                fprintf(stdout, " %s=%s", key, value);
+                printed++;
+            } else if (!flag) {
+                fprintf(stdout, " %s=(ignored)", key);
+                printed++;
+            }
+        }
+    }
+
+    fprintf(stdout, "%s\n", printed ? "" : " none");
+    MPI_CHECK(MPI_Info_free(&info));
+
+    fprintf(stdout, "%-*s%*s%*s%*s%*s%*s\n", 10, "# Size", FIELD_WIDTH,
+            "Avg Latency(us)", FIELD_WIDTH, "Min Latency(us)", FIELD_WIDTH,
+            "Max Latency(us)", FIELD_WIDTH, "GB/s", FIELD_WIDTH,
+            "GB/s per node");
+    fflush(stdout);
+}
+
+/*
+ * Latency per call of every rank, and the bandwidth of all ranks together:
+ * NPROCS * SIZE bytes in the time of the slowest rank.
+ */
+void report_io (int rank, int nprocs, size_t size, double latency)
+{
+    double min, max, sum, avg, gbps;
+
+    MPI_CHECK(MPI_Reduce(&latency, &min, 1, MPI_DOUBLE, MPI_MIN, 0,
+                MPI_COMM_WORLD));
+    MPI_CHECK(MPI_Reduce(&latency, &max, 1, MPI_DOUBLE, MPI_MAX, 0,
+                MPI_COMM_WORLD));
+    MPI_CHECK(MPI_Reduce(&latency, &sum, 1, MPI_DOUBLE, MPI_SUM, 0,
+                MPI_COMM_WORLD));
+
+    if (0 != rank) {
+        return;
+    }
+
+    avg = sum / nprocs;
+    gbps = (double)size * nprocs / max / 1e3;
+    record_message_size(size, avg);
+
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "%-*zu%*.*f%*.*f%*.*f%*.*f%*.*f\n", 10, size,
+                FIELD_WIDTH, FLOAT_PRECISION, avg, FIELD_WIDTH,
+                FLOAT_PRECISION, min, FIELD_WIDTH, FLOAT_PRECISION, max,
+                FIELD_WIDTH, FLOAT_PRECISION, gbps, FIELD_WIDTH,
+                FLOAT_PRECISION, gbps / io.nodes);
+        fflush(stdout);
+    } else {
+        struct result_metric_t metrics[5] = {
+            {"avg_latency_us", avg},
+            {"min_latency_us", min},
+            {"max_latency_us", max},
+            {"bandwidth_GBps", gbps},
+            {"bandwidth_GBps_per_node", gbps / io.nodes},
+        };
+
+        output_result(nprocs, size, 5, metrics);
+    }
+}
+
+void cleanup_io (MPI_File *fh)
+{
+    MPI_CHECK(MPI_File_close(fh));
+
+    if (MPI_DATATYPE_NULL != io.filetype) {
+        MPI_CHECK(MPI_Type_free(&io.filetype));
+    }
+
+    if (MPI_INFO_NULL != io.info) {
+        MPI_CHECK(MPI_Info_free(&io.info));
+    }
+}
+
+/*
+ * Managed Memory Residency
+ *
+ * The managed memory benchmarks bring the pages of their buffers into a
+ * state of --residency before every iteration.  prepare_residency() first
+ * moves them, untimed, to where the state starts from: the device for the
+ * host state, the host for all others.  It then times the prefetch that
+ * establishes the state, which is the migration cost on its own, and is 0
+ * for fault and preferred, whose pages are left to be migrated on demand.
+ * The advice of read-mostly and preferred is given by advise_residency()
+ * once for all iterations of the state.  Without CUDA both are no-ops.
+ */
+void advise_residency (void * buffer, size_t size,
+        enum residency_state state, int set)
+{
+#ifdef _ENABLE_CUDA_
+    int dev;
+
+    if (0 == size) {
+        return;
+    }
+
+    CUDA_CHECK(cudaGetDevice(&dev));
+
+    switch (state) {
+        case RESIDENCY_READ_MOSTLY:
+            CUDA_CHECK(cudaMemAdvise(buffer, size, set ?
+                        cudaMemAdviseSetReadMostly :
+                        cudaMemAdviseUnsetReadMostly, dev));
+            break;
+        case RESIDENCY_PREFERRED:
+            CUDA_CHECK(cudaMemAdvise(buffer, size, set ?
+                        cudaMemAdviseSetPreferredLocation :
+                        cudaMemAdviseUnsetPreferredLocation, dev));
+            break;
+        default:
+            break;
+    }
+#endif
+}
+
+/* Seconds the prefetch into STATE took */
+double prepare_residency (void * buffer, size_t size,
+        enum residency_state state)
+{
+#ifdef _ENABLE_CUDA_
+    double t_start;
+    int dev;
+
+    if (0 == size) {
+        return 0.0;
+    }
+
+    CUDA_CHECK(cudaGetDevice(&dev));
+    CUDA_CHECK(cudaMemPrefetchAsync(buffer, size,
+                RESIDENCY_HOST == state ? dev : cudaCpuDeviceId, 0));
+    CUDA_CHECK(cudaDeviceSynchronize());
+
+    if (RESIDENCY_FAULT == state || RESIDENCY_PREFERRED == state) {
+        return 0.0;
+    }
+
+    t_start = osu_wtime();
+    CUDA_CHECK(cudaMemPrefetchAsync(buffer, size,
+                RESIDENCY_HOST == state ? cudaCpuDeviceId : dev, 0));
+    CUDA_CHECK(cudaDeviceSynchronize());
+
+    return osu_wtime() - t_start;
+#else
+    return 0.0;
+#endif
+}
+
+/*
+ * Back to Back Collectives
+ *
+ * With --back-to-back the collective benchmarks time, after the usual loop
+ * with a barrier between the iterations, a block of -i collectives that
+ * follow each other directly, as applications issue them.  The block starts
+ * after a barrier and ends when the last rank is done, so the slowest rank
+ * gives the time per collective and the throughput.  With an imbalance every
+ * rank waits a random time of up to that many microseconds before each
+ * collective in a second block, the same sequence on every run.
+ *
+ *     for (pass = 0; pass < back_to_back_passes(); pass++) {
+ *         start_back_to_back(pass);
+ *         for (i = 0; i < options.iterations; i++) {
+ *             back_to_back_delay(pass);
+ *             ...collective...
+ *         }
+ *         stop_back_to_back(pass, options.iterations);
+ *     }
+ */
+static struct {
+    int base_column;
+    double t_start;
+    unsigned int seed;
+} back_to_back;
+
+static char const * b2b_column[] = {"B2B (us/op)", "B2B (ops/s)",
+    "Imbalanced (us/op)"};
+
+int setup_back_to_back (int rank)
+{
+    int i, n;
+
+    if (BACK_TO_BACK_ON != options.back_to_back) {
+        return 0;
+    }
+
+    back_to_back.base_column = extra_columns.num;
+
+    for (i = 0; i < back_to_back_passes() + 1; i++) {
+        n = extra_columns.num++;
+        snprintf(extra_columns.name[n], sizeof(extra_columns.name[n]), "%s",
+                b2b_column[i]);
+        extra_columns.width[n] = MAX(FIELD_WIDTH,
+                (int)strlen(b2b_column[i]) + 2);
+    }
+
+    return 0;
+}
+
+int back_to_back_passes (void)
+{
+    if (BACK_TO_BACK_ON != options.back_to_back) {
+        return 0;
+    }
+
+    return 0 < options.b2b_imbalance ? 2 : 1;
+}
+
+void start_back_to_back (int pass)
+{
+    int rank;
+
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    back_to_back.seed = 1 + rank;
+
+    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+    back_to_back.t_start = osu_wtime();
+}
+
+void back_to_back_delay (int pass)
+{
+    double t_end;
+
+    if (0 == pass) {
+        return;
+    }
+
+    t_end = osu_wtime() + options.b2b_imbalance * 1e-6 *
+        rand_r(&back_to_back.seed) / RAND_MAX;
+
+    while (osu_wtime() < t_end);
+}
+
+/* Collective, COUNT is the number of collectives in the block */
+void stop_back_to_back (int pass, int count)
+{
+    double elapsed = osu_wtime() - back_to_back.t_start, max_elapsed;
+    double * value = &extra_columns.value[back_to_back.base_column];
+    int rank;
+
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Reduce(&elapsed, &max_elapsed, 1, MPI_DOUBLE, MPI_MAX, 0,
+                MPI_COMM_WORLD));
+
+    if (0 != rank || 0 >= count || 0 >= max_elapsed) {
+        return;
+    }
+
+    if (0 == pass) {
+        value[0] = max_elapsed * 1e6 / count;
+        value[1] = count / max_elapsed;
+    } else {
+        value[2] = max_elapsed * 1e6 / count;
+    }
+}
+
+/*
+ * Arrival Skew
+ *
+ * With --arrival-skew every rank computes for a delay drawn from the
+ * distribution, with the calibrated host compute of the non-blocking
+ * benchmarks, between the barrier that ends one iteration and the
+ * collective of the next.  Times are taken from the end of that barrier on
+ * every rank: the arrival is when the rank enters the collective and the
+ * exit when it leaves.  Per iteration the total latency is the last exit and
+ * the excess latency the last exit minus the last arrival, what the
+ * collective adds once everybody is there; both are averaged over the
+ * iterations into the extra columns.
+ *
+ *     arrival_delay();
+ *     t_start = osu_wtime();
+ *     ...collective...
+ *     t_stop = osu_wtime();
+ *     record_arrival(i - options.skip, t_start, t_stop);
+ */
+static struct {
+    int base_column;
+    int capacity;
+    int count;
+    int slow_rank;
+    unsigned int seed;
+    double t_ref;
+    double * arrival;
+} arrival_skew;
+
+static char const * arrival_column[] = {"Total (us)", "Excess (us)"};
+
+int setup_arrival_skew (int rank)
+{
+    int i, n, numprocs;
+
+    if (SKEW_NONE == options.skew || SKEW_OFF == options.skew) {
+        return 0;
+    }
+
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+
+    arrival_skew.slow_rank = SKEW_SLOW == options.skew &&
+        0 <= options.skew_param ? (int)options.skew_param : numprocs - 1;
+
+    if (arrival_skew.slow_rank >= numprocs) {
+        if (0 == rank) {
+            fprintf(stderr, "Slow rank %d of --arrival-skew is beyond the "
+                    "%d ranks\n", arrival_skew.slow_rank, numprocs);
+        }
+
+        return 1;
+    }
+
+    /* Arrivals and exits lie back to back in one array */
+    arrival_skew.capacity = MAX(options.iterations, options.iterations_large);
+    arrival_skew.arrival = malloc(sizeof(double) * 2 * arrival_skew.capacity);
+
+    if (NULL == arrival_skew.arrival) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        return 1;
+    }
+
+    arrival_skew.seed = 1 + rank;
+    allocate_host_arrays();
+    calibrate_host_compute();
+
+    arrival_skew.base_column = extra_columns.num;
+
+    for (i = 0; i < MAX_SKEW_COLUMNS; i++) {
+        n = extra_columns.num++;
+        snprintf(extra_columns.name[n], sizeof(extra_columns.name[n]), "%s",
+                arrival_column[i]);
+        extra_columns.width[n] = MAX(FIELD_WIDTH,
+                (int)strlen(arrival_column[i]) + 2);
+    }
+
+    return 0;
+}
+
+static double skew_delay (void)
+{
+    int rank;
+    double u1, u2, delay;
+
+    switch (options.skew) {
+        case SKEW_UNIFORM:
+            return options.skew_us * rand_r(&arrival_skew.seed) / RAND_MAX;
+        case SKEW_SLOW:
+            MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+            return rank == arrival_skew.slow_rank ? options.skew_us : 0;
+        default:
+            /* Box-Muller, clipped at no delay */
+            u1 = (rand_r(&arrival_skew.seed) + 1.0) / (RAND_MAX + 1.0);
+            u2 = (rand_r(&arrival_skew.seed) + 1.0) / (RAND_MAX + 1.0);
+            delay = options.skew_us + options.skew_param *
+                sqrt(-2 * log(u1)) * cos(2 * M_PI * u2);
+            return delay > 0 ? delay : 0;
+    }
+}
+
+void start_arrival_skew (void)
+{
+    arrival_skew.count = 0;
+}
+
+void arrival_delay (void)
+{
+    double delay;
+
+    arrival_skew.t_ref = osu_wtime();
+    delay = skew_delay();
+
+    if (delay > 0) {
+        do_compute_cpu(delay * 1e-6);
+    }
+}
+
+/* I counts the timed iterations from 0 */
+void record_arrival (int i, double t_start, double t_stop)
+{
+    if (0 > i || i >= arrival_skew.capacity) {
+        return;
+    }
+
+    arrival_skew.arrival[i] = t_start - arrival_skew.t_ref;
+    arrival_skew.arrival[arrival_skew.capacity + i] = t_stop -
+        arrival_skew.t_ref;
+    arrival_skew.count = MAX(arrival_skew.count, i + 1);
+}
+
+/* Collective */
+void stop_arrival_skew (void)
+{
+    double * all = NULL, total = 0, excess = 0;
+    int rank, i, n = arrival_skew.count, c = arrival_skew.capacity;
+
+    if (SKEW_NONE == options.skew || SKEW_OFF == options.skew) {
+        return;
+    }
+
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+
+    if (0 == rank) {
+        all = malloc(sizeof(double) * 2 * c);
+
+        if (NULL == all) {
+            fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+            MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+        }
+    }
+
+    MPI_CHECK(MPI_Reduce(arrival_skew.arrival, all, 2 * c, MPI_DOUBLE,
+                MPI_MAX, 0, MPI_COMM_WORLD));
+
+    if (0 != rank) {
+        return;
+    }
+
+    for (i = 0; i < n; i++) {
+        total += all[c + i];
+        excess += all[c + i] - all[i];
+    }
+
+    if (n) {
+        extra_columns.value[arrival_skew.base_column] = total * 1e6 / n;
+        extra_columns.value[arrival_skew.base_column + 1] = excess * 1e6 / n;
+    }
+
+    free(all);
+}
+
+void cleanup_arrival_skew (void)
+{
+    free(arrival_skew.arrival);
+    arrival_skew.arrival = NULL;
+}
+
+/*
+ * Count Distributions
+ *
+ * The v and w collectives send W(i,j) times the message size from rank i to
+ * rank j, rounded to whole bytes.  The weights of every row add up to the P
+ * ranks, so that every distribution moves the volume of the uniform one:
+ *
+ *     zipf:S      W(i,j) = P z_i * P z_j / Z^2, z_k = 1/(k+1)^S, Z their sum
+ *     sparse:K    W(i,j) = P/K to K destinations drawn for rank i from the
+ *                 other ranks, the same draws on every rank
+ *     block:B     W(i,j) = P/|b| within every block b of B consecutive ranks
+ *
+ * Every rank keeps its row and column of W.  set_counts() turns them into
+ * counts and displacements for one message size and, but for the uniform
+ * distribution, puts the load balance in the extra columns: the largest load
+ * of a rank, the bytes it sends and receives, over the average load, that
+ * largest load and the share of the pairs that exchange data.
+ *
+ *     bufsize = count_buffer_size(numprocs);
+ *     ...
+ *     footprint = set_counts(rank, numprocs, size, sendcounts, sdispls,
+ *             recvcounts, rdispls);
+ */
+static struct {
+    int base_column;
+    double peak;
+    double * send_weight;
+    double * recv_weight;
+} count_weights;
+
+static char const * count_column[] = {"Imbalance", "Max Load(B)",
+    "Nonzero(%)"};
+
+/* The same stream of draws for sender S on every rank */
+static uint64_t count_draw (uint64_t * state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+
+    return z ^ (z >> 31);
+}
+
+/*
+ * Floyd's sampling of K of the N = P - 1 other ranks of sender S into DEST,
+ * MARK being N zeroed flags it leaves zeroed
+ */
+static void sparse_destinations (int s, int numprocs, int k, int * dest,
+                                 char * mark)
+{
+    uint64_t state = s + 1;
+    int i, j, t, n = numprocs - 1;
+
+    for (i = 0, j = n - k; j < n; i++, j++) {
+        t = count_draw(&state) % (j + 1);
+        t = mark[t] ? j : t;
+        mark[t] = 1;
+        dest[i] = t;
+    }
+
+    for (i = 0; i < k; i++) {
+        mark[dest[i]] = 0;
+        dest[i] = (s + 1 + dest[i]) % numprocs;
+    }
+}
+
+static int setup_sparse_weights (int rank, int numprocs)
+{
+    int s, i, k = MIN((int)options.count_param, numprocs - 1);
+    int * dest = malloc(sizeof(int) * k);
+    char * mark = calloc(numprocs, 1);
+
+    if (NULL == dest || NULL == mark) {
+        free(dest);
+        free(mark);
+        return 1;
+    }
+
+    for (s = 0; s < numprocs; s++) {
+        sparse_destinations(s, numprocs, k, dest, mark);
+
+        for (i = 0; i < k; i++) {
+            if (s == rank) {
+                count_weights.send_weight[dest[i]] = (double)numprocs / k;
+            }
+
+            if (dest[i] == rank) {
+                count_weights.recv_weight[s] = (double)numprocs / k;
+            }
+        }
+    }
+
+    free(dest);
+    free(mark);
+
+    return 0;
+}
+
+static void setup_zipf_weights (int rank, int numprocs)
+{
+    double z = 0;
+    int j;
+
+    for (j = 0; j < numprocs; j++) {
+        z += pow(j + 1, -options.count_param);
+    }
+
+    for (j = 0; j < numprocs; j++) {
+        count_weights.send_weight[j] = numprocs * numprocs *
+            pow((double)(rank + 1) * (j + 1), -options.count_param) / (z * z);
+        count_weights.recv_weight[j] = count_weights.send_weight[j];
+    }
+}
+
+static void setup_block_weights (int rank, int numprocs)
+{
+    int b = (int)options.count_param, first = rank / b * b;
+    int last = MIN(first + b, numprocs), j;
+
+    for (j = first; j < last; j++) {
+        count_weights.send_weight[j] = (double)numprocs / (last - first);
+        count_weights.recv_weight[j] = count_weights.send_weight[j];
+    }
+}
+
+/* Collective, lowers the max message size to fit the heaviest rank */
+int setup_count_distribution (int rank, int numprocs)
+{
+    double send = 0, recv = 0;
+    int i, j, n;
+
+    if (COUNTS_NONE == options.count_dist) {
+        return 0;
+    }
+
+    count_weights.send_weight = calloc(2 * numprocs, sizeof(double));
+
+    if (NULL == count_weights.send_weight) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        return 1;
+    }
+
+    count_weights.recv_weight = count_weights.send_weight + numprocs;
+
+    switch (options.count_dist) {
+        case COUNTS_ZIPF:
+            setup_zipf_weights(rank, numprocs);
+            break;
+        case COUNTS_SPARSE:
+            if (setup_sparse_weights(rank, numprocs)) {
+                fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+                return 1;
+            }
+            break;
+        case COUNTS_BLOCK:
+            setup_block_weights(rank, numprocs);
+            break;
+        default:
+            for (j = 0; j < numprocs; j++) {
+                count_weights.send_weight[j] = 1;
+                count_weights.recv_weight[j] = 1;
+            }
+            break;
+    }
+
+    for (j = 0; j < numprocs; j++) {
+        send += count_weights.send_weight[j];
+        recv += count_weights.recv_weight[j];
+    }
+
+    count_weights.peak = MAX(send, recv) / numprocs;
+    MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &count_weights.peak, 1, MPI_DOUBLE,
+                MPI_MAX, MPI_COMM_WORLD));
+
+    if (options.max_message_size * numprocs * count_weights.peak >
+            options.max_mem_limit) {
+        size_t limit = options.max_mem_limit / (numprocs * count_weights.peak);
+
+        if (0 == rank) {
+            fprintf(stderr, "Warning! The heaviest rank exchanges %.2f times "
+                    "the uniform volume.\nContinuing with max message size "
+                    "of %zu bytes\n", count_weights.peak, limit);
+        }
+        options.max_message_size = limit;
+    }
+
+    if (COUNTS_UNIFORM == options.count_dist) {
+        return 0;
+    }
+
+    count_weights.base_column = extra_columns.num;
+
+    for (i = 0; i < MAX_COUNT_COLUMNS; i++) {
+        n = extra_columns.num++;
+        snprintf(extra_columns.name[n], sizeof(extra_columns.name[n]), "%s",
+                count_column[i]);
+        extra_columns.width[n] = MAX(FIELD_WIDTH,
+                (int)strlen(count_column[i]) + 2);
+    }
+
+    return 0;
+}
+
+/*
+ * Bytes of the send and of the receive buffer of this rank for the counts of
+ * the max message size, every smaller size fitting into them
+ */
+size_t count_buffer_size (int numprocs)
+{
+    size_t size = options.max_message_size, send = 0, recv = 0;
+    int j;
+
+    if (NULL == count_weights.send_weight) {
+        return size * numprocs;
+    }
+
+    for (j = 0; j < numprocs; j++) {
+        send += (size_t)(size * count_weights.send_weight[j] + 0.5);
+        recv += (size_t)(size * count_weights.recv_weight[j] + 0.5);
+    }
+
+    return MAX(send, recv);
+}
+
+/*
+ * Collective, fills the counts and displacements of SIZE and returns the
+ * larger of the bytes RANK sends and receives
+ */
+size_t set_counts (int rank, int numprocs, size_t size, int * sendcounts,
+                   int * sdispls, int * recvcounts, int * rdispls)
+{
+    double load, max_load = 0, sum_load = 0, nonzero = 0;
+    size_t send = 0, recv = 0;
+    int j;
+
+    for (j = 0; j < numprocs; j++) {
+        sendcounts[j] = NULL == count_weights.send_weight ? size :
+            (int)(size * count_weights.send_weight[j] + 0.5);
+        recvcounts[j] = NULL == count_weights.recv_weight ? size :
+            (int)(size * count_weights.recv_weight[j] + 0.5);
+        sdispls[j] = send;
+        rdispls[j] = recv;
+        send += sendcounts[j];
+        recv += recvcounts[j];
+        nonzero += 0 < sendcounts[j];
+    }
+
+    if (COUNTS_NONE == options.count_dist ||
+            COUNTS_UNIFORM == options.count_dist) {
+        return MAX(send, recv);
+    }
+
+    load = send + recv;
+    MPI_CHECK(MPI_Reduce(&load, &max_load, 1, MPI_DOUBLE, MPI_MAX, 0,
+                MPI_COMM_WORLD));
+    MPI_CHECK(MPI_Reduce(&load, &sum_load, 1, MPI_DOUBLE, MPI_SUM, 0,
+                MPI_COMM_WORLD));
+    MPI_CHECK(MPI_Reduce(rank ? &nonzero : MPI_IN_PLACE, &nonzero, 1,
+                MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD));
+
+    if (0 == rank) {
+        double * value = &extra_columns.value[count_weights.base_column];
+
+        value[0] = sum_load > 0 ? max_load * numprocs / sum_load : 1;
+        value[1] = max_load;
+        value[2] = 100.0 * nonzero / ((double)numprocs * numprocs);
+    }
+
+    return MAX(send, recv);
+}
+
+void print_count_summary (void)
+{
+    switch (options.count_dist) {
+        case COUNTS_ZIPF:
+            fprintf(stdout, "# Counts: zipf, rank weights 1/(rank+1)^%.2f\n",
+                    options.count_param);
+            break;
+        case COUNTS_SPARSE:
+            fprintf(stdout, "# Counts: sparse, %d random destinations per "
+                    "rank\n", (int)options.count_param);
+            break;
+        case COUNTS_BLOCK:
+            fprintf(stdout, "# Counts: block diagonal, blocks of %d ranks\n",
+                    (int)options.count_param);
+            break;
+        default:
+            break;
+    }
+}
+
+void cleanup_count_distribution (void)
+{
+    free(count_weights.send_weight);
+    count_weights.send_weight = count_weights.recv_weight = NULL;
+}
+
+/*
+ * Outlier Ranks
+ *
+ * With --outliers K[:Z] print_stats() gathers the mean latency of the timed
+ * iterations every rank passed to record_latency() on rank 0, together with
+ * the hosts of the ranks on the first message size.  The robust z-score of a
+ * rank is its distance from the median latency in units of 1.4826 times the
+ * median absolute deviation, which is the standard deviation for normal data
+ * but is not dragged along by the slow ranks themselves; the mean absolute
+ * deviation stands in when more than half of the ranks agree exactly, and
+ * the unit is at least 1% of the median, so that ranks which only differ by
+ * timer noise are not told apart.  Ranks beyond Z above the median are
+ * outliers.  The extra columns carry their
+ * number and the slowest rank, the K slowest ranks are listed after the row.
+ */
+#define OUTLIER_HOST_LEN    64
+
+static struct {
+    int base_column;
+    int numprocs;
+    char * hosts;
+    double * latency;
+    double * scratch;
+    int * order;
+    double median;
+    double scale;
+    int outliers;
+} rank_outliers;
+
+static char const * outlier_column[] = {"Outliers", "Slowest Rank",
+    "Slowest (us)"};
+
+/* Once on rank 0, before the header is printed */
+void setup_rank_outliers (void)
+{
+    int i, n;
+
+    rank_outliers.base_column = extra_columns.num;
+
+    for (i = 0; i < MAX_OUTLIER_COLUMNS; i++) {
+        n = extra_columns.num++;
+        snprintf(extra_columns.name[n], sizeof(extra_columns.name[n]), "%s",
+                outlier_column[i]);
+        extra_columns.width[n] = MAX(FIELD_WIDTH,
+                (int)strlen(outlier_column[i]) + 2);
+        /* The number of outliers and the slowest rank */
+        extra_columns.integer[n] = (i < 2);
+    }
+}
+
+static int compare_doubles (void const * a, void const * b)
+{
+    double x = *(double const *)a, y = *(double const *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Slowest first, lower ranks first among equals */
+static int compare_rank_latency (void const * a, void const * b)
+{
+    int x = *(int const *)a, y = *(int const *)b;
+    double lx = rank_outliers.latency[x], ly = rank_outliers.latency[y];
+
+    return lx != ly ? (lx < ly) - (lx > ly) : x - y;
+}
+
+static double sorted_median (double * values, int n)
+{
+    qsort(values, n, sizeof(double), compare_doubles);
+
+    return n % 2 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+}
+
+static double outlier_z (int r)
+{
+    return rank_outliers.scale > 0 ? (rank_outliers.latency[r] -
+            rank_outliers.median) / rank_outliers.scale : 0;
+}
+
+/* Collective */
+void reduce_rank_outliers (int rank)
+{
+    char host[OUTLIER_HOST_LEN] = "";
+    double latency = latency_stats.count ? 1e6 * latency_stats.mean : 0;
+    double mean_deviation = 0;
+    int numprocs, i, len;
+
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+
+    if (numprocs != rank_outliers.numprocs) {
+        MPI_CHECK(MPI_Get_processor_name(host, &len));
+        host[MIN(len, OUTLIER_HOST_LEN - 1)] = '\0';
+
+        if (0 == rank) {
+            rank_outliers.hosts = malloc((size_t)numprocs * OUTLIER_HOST_LEN);
+            rank_outliers.latency = malloc(numprocs * sizeof(double));
+            rank_outliers.scratch = malloc(numprocs * sizeof(double));
+            rank_outliers.order = malloc(numprocs * sizeof(int));
+
+            if (NULL == rank_outliers.hosts || NULL == rank_outliers.latency
+                    || NULL == rank_outliers.scratch ||
+                    NULL == rank_outliers.order) {
+                fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+                MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+            }
+        }
+
+        MPI_CHECK(MPI_Gather(host, OUTLIER_HOST_LEN, MPI_CHAR,
+                    rank_outliers.hosts, OUTLIER_HOST_LEN, MPI_CHAR, 0,
+                    MPI_COMM_WORLD));
+        rank_outliers.numprocs = numprocs;
+    }
+
+    MPI_CHECK(MPI_Gather(&latency, 1, MPI_DOUBLE, rank_outliers.latency, 1,
+                MPI_DOUBLE, 0, MPI_COMM_WORLD));
+
+    if (0 != rank) {
+        return;
+    }
+
+    memcpy(rank_outliers.scratch, rank_outliers.latency,
+            numprocs * sizeof(double));
+    rank_outliers.median = sorted_median(rank_outliers.scratch, numprocs);
+
+    for (i = 0; i < numprocs; i++) {
+        rank_outliers.scratch[i] = fabs(rank_outliers.latency[i] -
+                rank_outliers.median);
+        mean_deviation += rank_outliers.scratch[i] / numprocs;
+        rank_outliers.order[i] = i;
+    }
+
+    rank_outliers.scale = 1.4826 * sorted_median(rank_outliers.scratch,
+            numprocs);
+    if (0 >= rank_outliers.scale) {
+        rank_outliers.scale = 1.2533 * mean_deviation;
+    }
+    rank_outliers.scale = MAX(rank_outliers.scale, 0.01 *
+            rank_outliers.median);
+
+    qsort(rank_outliers.order, numprocs, sizeof(int), compare_rank_latency);
+
+    rank_outliers.outliers = 0;
+    for (i = 0; i < numprocs && outlier_z(rank_outliers.order[i]) >
+            options.outlier_z; i++) {
+        rank_outliers.outliers++;
+    }
+
+    extra_columns.value[rank_outliers.base_column] = rank_outliers.outliers;
+    extra_columns.value[rank_outliers.base_column + 1] =
+        rank_outliers.order[0];
+    extra_columns.value[rank_outliers.base_column + 2] =
+        rank_outliers.latency[rank_outliers.order[0]];
+}
+
+/* The K slowest ranks of the last size, outliers marked with a star */
+void print_rank_outliers (FILE * out, int size)
+{
+    int i, r, top = MIN(options.outlier_top, rank_outliers.numprocs);
+
+    fprintf(out, "# Size %d: median %.*f us, %d of %d ranks beyond z %.1f\n",
+            size, FLOAT_PRECISION, rank_outliers.median,
+            rank_outliers.outliers, rank_outliers.numprocs,
+            options.outlier_z);
+    fprintf(out, "#   %8s  %-24s%*s%10s\n", "Rank", "Host", FIELD_WIDTH,
+            "Latency (us)", "z");
+
+    for (i = 0; i < top; i++) {
+        r = rank_outliers.order[i];
+        fprintf(out, "#   %8d  %-24.*s%*.*f%10.2f%s\n", r, OUTLIER_HOST_LEN,
+                rank_outliers.hosts + (size_t)r * OUTLIER_HOST_LEN,
+                FIELD_WIDTH, FLOAT_PRECISION, rank_outliers.latency[r],
+                outlier_z(r), i < rank_outliers.outliers ? " *" : "");
+    }
+
+    fflush(out);
+}
+
+/*
+ * Performance Variables
+ *
+ * -Y selects MPI_T pvars by name.  Pvars bound to a communicator are bound
+ * to MPI_COMM_WORLD, arrays are summed over their elements.  Around the loop
+ * of every size start_pvars() and stop_pvars() start, read and stop them;
+ * counters, aggregates and timers report the change over the loop summed
+ * over the ranks, all other classes the value at its end, and the watermarks
+ * are reset at its start where the library allows it, as the maximum over
+ * the ranks.
+ */
+#define MAX_PVAR_ELEMENTS   256
+
+#if MPI_VERSION >= 3
+static MPI_T_pvar_session pvar_session;
+static MPI_T_pvar_handle pvar_handle[MAX_PVAR_COLUMNS];
+static MPI_Datatype pvar_type[MAX_PVAR_COLUMNS];
+static int pvar_count[MAX_PVAR_COLUMNS];
+static int pvar_class[MAX_PVAR_COLUMNS];
+static int pvar_continuous[MAX_PVAR_COLUMNS];
+static int pvar_readonly[MAX_PVAR_COLUMNS];
+static double pvar_start_value[MAX_PVAR_COLUMNS];
+static int num_pvars = 0;
+static MPI_Comm pvar_comm;
+
+static int is_pvar_type (MPI_Datatype datatype)
+{
+    return MPI_INT == datatype || MPI_UNSIGNED == datatype ||
+        MPI_UNSIGNED_LONG == datatype || MPI_UNSIGNED_LONG_LONG == datatype ||
+        MPI_DOUBLE == datatype;
+}
+
+static int is_pvar_delta (int var_class)
+{
+    return MPI_T_PVAR_CLASS_COUNTER == var_class ||
+        MPI_T_PVAR_CLASS_AGGREGATE == var_class ||
+        MPI_T_PVAR_CLASS_TIMER == var_class;
+}
+
+static double read_pvar (MPI_T_pvar_session session, MPI_T_pvar_handle handle,
+        MPI_Datatype datatype, int count)
+{
+    static union {
+        int i;
+        unsigned u;
+        unsigned long ul;
+        unsigned long long ull;
+        double d;
+    } buf[MAX_PVAR_ELEMENTS];
+    double sum = 0;
+    int k;
+
+    if (MPI_SUCCESS != MPI_T_pvar_read(session, handle, buf)) {
+        return 0;
+    }
+
+    for (k = 0; k < count; k++) {
+        if (MPI_INT == datatype) {
+            sum += ((int *)buf)[k];
+        } else if (MPI_UNSIGNED == datatype) {
+            sum += ((unsigned *)buf)[k];
+        } else if (MPI_UNSIGNED_LONG == datatype) {
+            sum += ((unsigned long *)buf)[k];
+        } else if (MPI_UNSIGNED_LONG_LONG == datatype) {
+            sum += ((unsigned long long *)buf)[k];
+        } else {
+            sum += ((double *)buf)[k];
+        }
+    }
+
+    return sum;
+}
+
+static void list_pvars (int num)
+{
+    char name[128], desc[256];
+    int i, name_len, desc_len, verbosity, var_class, bind, readonly;
+    int continuous, atomic;
+    MPI_Datatype datatype;
+    MPI_T_enum enumtype;
+
+    fprintf(stdout, "# %d MPI_T performance variables\n", num);
+    fprintf(stdout, "%-*s%-*s%s\n", 8, "# Index", 48, "Name", "Description");
+
+    for (i = 0; i < num; i++) {
+        name_len = sizeof(name);
+        desc_len = sizeof(desc);
+
+        if (MPI_SUCCESS != MPI_T_pvar_get_info(i, name, &name_len,
+                    &verbosity, &var_class, &datatype, &enumtype, desc,
+                    &desc_len, &bind, &readonly, &continuous, &atomic)) {
+            continue;
+        }
+
+        fprintf(stdout, "%-*d%-*s%s\n", 8, i, 48, name, desc);
+    }
+
+    fflush(stdout);
+}
+
+/* Returns the index of the first pvar called NAME that can be read, or -1 */
+static int find_pvar (char const * name, int num)
+{
+    char pvar_name[128], desc[256];
+    int i, name_len, desc_len, verbosity, var_class, bind, readonly;
+    int continuous, atomic;
+    MPI_Datatype datatype;
+    MPI_T_enum enumtype;
+
+    for (i = 0; i < num; i++) {
+        name_len = sizeof(pvar_name);
+        desc_len = sizeof(desc);
+
+        if (MPI_SUCCESS == MPI_T_pvar_get_info(i, pvar_name, &name_len,
+                    &verbosity, &var_class, &datatype, &enumtype, desc,
+                    &desc_len, &bind, &readonly, &continuous, &atomic) &&
+                0 == strcmp(name, pvar_name) && is_pvar_type(datatype) &&
+                (MPI_T_BIND_NO_OBJECT == bind ||
+                 MPI_T_BIND_MPI_COMM == bind)) {
+            int n = num_pvars;
+
+            pvar_type[n] = datatype;
+            pvar_class[n] = var_class;
+            pvar_continuous[n] = continuous;
+            pvar_readonly[n] = readonly;
+
+            return i;
+        }
+    }
+
+    return -1;
+}
+#endif
+
+/*
+ * Returns 0 when the benchmark should go on, which it also does without -Y,
+ * and 1 after listing the pvars with "-Y list" or when a pvar cannot be used,
+ * which rank 0 reports.
+ */
+int setup_pvars (int rank)
+{
+#if MPI_VERSION >= 3
+    char names[1024], * name, * saveptr = NULL;
+    int provided, num, index, count;
+#endif
+
+    if (PVARS_ON != options.pvars && PVARS_LIST != options.pvars) {
+        return 0;
+    }
+
+#if MPI_VERSION >= 3
+    if (MPI_SUCCESS != MPI_T_init_thread(MPI_THREAD_SINGLE, &provided) ||
+            MPI_SUCCESS != MPI_T_pvar_get_num(&num)) {
+        if (0 == rank) {
+            fprintf(stderr, "The MPI_T interface is not available\n");
+        }
+
+        return 1;
+    }
+
+    if (PVARS_LIST == options.pvars) {
+        if (0 == rank) {
+            list_pvars(num);
+        }
+
+        MPI_T_finalize();
+        return 1;
+    }
+
+    pvar_comm = MPI_COMM_WORLD;
+    MPI_CHECK(MPI_T_pvar_session_create(&pvar_session));
+
+    snprintf(names, sizeof(names), "%s", options.pvar_names);
+
+    for (name = strtok_r(names, ",", &saveptr); NULL != name;
+            name = strtok_r(NULL, ",", &saveptr)) {
+        int n = num_pvars;
+
+        if (MAX_PVAR_COLUMNS == n) {
+            if (0 == rank) {
+                fprintf(stderr, "At most %d MPI_T pvars can be selected\n",
+                        MAX_PVAR_COLUMNS);
+            }
+
+            cleanup_pvars();
+            return 1;
+        }
+
+        index = find_pvar(name, num);
+
+        if (0 > index || MPI_SUCCESS != MPI_T_pvar_handle_alloc(pvar_session,
+                    index, &pvar_comm, &pvar_handle[n], &count)) {
+            if (0 == rank) {
+                fprintf(stderr, "MPI_T pvar [%s] not found or not readable\n",
+                        name);
+            }
+
+            cleanup_pvars();
+            return 1;
+        }
+
+        if (count > MAX_PVAR_ELEMENTS) {
+            if (0 == rank) {
+                fprintf(stderr, "MPI_T pvar [%s] has more than %d elements\n",
+                        name, MAX_PVAR_ELEMENTS);
+            }
+
+            MPI_T_pvar_handle_free(pvar_session, &pvar_handle[n]);
+            cleanup_pvars();
+            return 1;
+        }
+
+        pvar_count[n] = count;
+        snprintf(extra_columns.name[n], sizeof(extra_columns.name[n]), "%s",
+                name);
+        extra_columns.width[n] = MAX(FIELD_WIDTH, (int)strlen(name) + 2);
+        extra_columns.num++;
+        num_pvars++;
+    }
+
+    return 0;
+#else
+    if (0 == rank) {
+        fprintf(stderr, "MPI_T pvars need an MPI-3 library\n");
+    }
+
+    return 1;
+#endif
+}
+
+void start_pvars (void)
+{
+#if MPI_VERSION >= 3
+    int i;
+
+    for (i = 0; i < num_pvars; i++) {
+        if (!pvar_readonly[i] && (MPI_T_PVAR_CLASS_HIGHWATERMARK ==
+                    pvar_class[i] || MPI_T_PVAR_CLASS_LOWWATERMARK ==
+                    pvar_class[i])) {
+            MPI_T_pvar_reset(pvar_session, pvar_handle[i]);
+        }
+
+        if (!pvar_continuous[i]) {
+            MPI_T_pvar_start(pvar_session, pvar_handle[i]);
+        }
+
+        pvar_start_value[i] = read_pvar(pvar_session, pvar_handle[i],
+                pvar_type[i], pvar_count[i]);
+    }
+#endif
+}
+
+/* Collective, rank 0 finds the values in extra_columns */
+void stop_pvars (void)
+{
+#if MPI_VERSION >= 3
+    double sum[MAX_PVAR_COLUMNS] = {0}, max[MAX_PVAR_COLUMNS] = {0};
+    double total[MAX_PVAR_COLUMNS], highest[MAX_PVAR_COLUMNS];
+    double value;
+    int i, n = num_pvars;
+
+    if (0 == n) {
+        return;
+    }
+
+    for (i = 0; i < n; i++) {
+        value = read_pvar(pvar_session, pvar_handle[i], pvar_type[i],
+                pvar_count[i]);
+
+        if (!pvar_continuous[i]) {
+            MPI_T_pvar_stop(pvar_session, pvar_handle[i]);
+        }
+
+        if (is_pvar_delta(pvar_class[i])) {
+            sum[i] = value - pvar_start_value[i];
+        } else {
+            max[i] = value;
+        }
+    }
+
+    MPI_CHECK(MPI_Reduce(sum, total, n, MPI_DOUBLE, MPI_SUM, 0,
+                MPI_COMM_WORLD));
+    MPI_CHECK(MPI_Reduce(max, highest, n, MPI_DOUBLE, MPI_MAX, 0,
+                MPI_COMM_WORLD));
+
+    for (i = 0; i < n; i++) {
+        extra_columns.value[i] = is_pvar_delta(pvar_class[i]) ? total[i] :
+            highest[i];
+    }
+#endif
+}
+
+void cleanup_pvars (void)
+{
+#if MPI_VERSION >= 3
+    int i;
+
+    if (PVARS_ON != options.pvars) {
+        return;
+    }
+
+    for (i = 0; i < num_pvars; i++) {
+        MPI_T_pvar_handle_free(pvar_session, &pvar_handle[i]);
+    }
+
+    MPI_T_pvar_session_free(&pvar_session);
+    MPI_T_finalize();
+    num_pvars = 0;
+    options.pvars = PVARS_OFF;
+#endif
+}
+
+/*
+ * Control Variable Tuning
+ *
+ * -J NAME=V1:V2[,NAME=V1:V2] sweeps the product of the candidate values of
+ * up to MAX_TUNE_CVARS MPI_T cvars.  For every size the benchmark runs its
+ * timed loop once per setting on a duplicate of MPI_COMM_WORLD created after
+ * the cvars were written, so that cvars the library reads when it sets up a
+ * communicator, like collective algorithm selectors, apply as well.
+ * Afterwards the cvars get their original values back.  Rank 0 keeps the
+ * best and the worst setting of every size for print_tuning_table().
+ */
+#define MAX_TUNE_CVARS      4
+#define MAX_TUNE_VALUES     16
+#define MAX_TUNE_SETTINGS   256
+
+struct tune_result_t {
+    size_t size;
+    int best;
+    double best_value;
+    double worst_value;
+};
+
+static int num_tune_cvars = 0, num_settings = 1;
+static MPI_Comm tune_comm = MPI_COMM_NULL;
+static struct tune_result_t * tune_results = NULL;
+static int num_tune_results = 0, max_tune_results = 0;
+static int tune_best = -1;
+static double tune_best_value, tune_worst_value;
+
+#if MPI_VERSION >= 3
+struct tune_cvar_t {
+    char name[64];
+    MPI_T_cvar_handle handle;
+    MPI_Datatype datatype;
+    MPI_T_enum enumtype;
+    int num_values;
+    char label[MAX_TUNE_VALUES][32];
+    double value[MAX_TUNE_VALUES];
+    double original;
+};
+
+static struct tune_cvar_t tune_cvar[MAX_TUNE_CVARS];
+static MPI_Comm tune_bind_comm;
+
+static int is_cvar_type (MPI_Datatype datatype)
+{
+    return MPI_INT == datatype || MPI_UNSIGNED == datatype ||
+        MPI_UNSIGNED_LONG == datatype || MPI_UNSIGNED_LONG_LONG == datatype ||
+        MPI_DOUBLE == datatype;
+}
+
+static double read_cvar (struct tune_cvar_t const * cvar)
+{
+    union {
+        int i;
+        unsigned u;
+        unsigned long ul;
+        unsigned long long ull;
+        double d;
+    } buf;
+
+    if (MPI_SUCCESS != MPI_T_cvar_read(cvar->handle, &buf)) {
+        return 0;
+    }
+
+    if (MPI_INT == cvar->datatype) {
+        return buf.i;
+    } else if (MPI_UNSIGNED == cvar->datatype) {
+        return buf.u;
+    } else if (MPI_UNSIGNED_LONG == cvar->datatype) {
+        return buf.ul;
+    } else if (MPI_UNSIGNED_LONG_LONG == cvar->datatype) {
+        return buf.ull;
+    }
+
+    return buf.d;
+}
+
+static int write_cvar (struct tune_cvar_t const * cvar, double value)
+{
+    union {
+        int i;
+        unsigned u;
+        unsigned long ul;
+        unsigned long long ull;
+        double d;
+    } buf;
+
+    if (MPI_INT == cvar->datatype) {
+        buf.i = (int)value;
+    } else if (MPI_UNSIGNED == cvar->datatype) {
+        buf.u = (unsigned)value;
+    } else if (MPI_UNSIGNED_LONG == cvar->datatype) {
+        buf.ul = (unsigned long)value;
+    } else if (MPI_UNSIGNED_LONG_LONG == cvar->datatype) {
+        buf.ull = (unsigned long long)value;
+    } else {
+        buf.d = value;
+    }
+
+    return MPI_T_cvar_write(cvar->handle, &buf);
+}
+
+/* A candidate is the name of an item of an enumerated cvar or a number */
+static int parse_cvar_value (struct tune_cvar_t * cvar, char const * str)
+{
+    char item[64], * end;
+    int num_items, i, value, len = sizeof(item);
+    double number;
+
+    if (MPI_T_ENUM_NULL != cvar->enumtype &&
+            MPI_SUCCESS == MPI_T_enum_get_info(cvar->enumtype, &num_items,
+                item, &len)) {
+        for (i = 0; i < num_items; i++) {
+            len = sizeof(item);
+            if (MPI_SUCCESS == MPI_T_enum_get_item(cvar->enumtype, i, &value,
+                        item, &len) && 0 == strcmp(item, str)) {
+                cvar->value[cvar->num_values] = value;
+                return 0;
+            }
+        }
+    }
+
+    number = strtod(str, &end);
+
+    if (end == str || '\0' != *end) {
+        return -1;
+    }
+
+    cvar->value[cvar->num_values] = number;
+
+    return 0;
+}
+
+static int find_cvar (struct tune_cvar_t * cvar, int num)
+{
+    char name[128], desc[256];
+    int i, name_len, desc_len, verbosity, bind, scope, count;
+
+    for (i = 0; i < num; i++) {
+        name_len = sizeof(name);
+        desc_len = sizeof(desc);
+
+        if (MPI_SUCCESS != MPI_T_cvar_get_info(i, name, &name_len, &verbosity,
+                    &cvar->datatype, &cvar->enumtype, desc, &desc_len, &bind,
+                    &scope) || 0 != strcmp(name, cvar->name)) {
+            continue;
+        }
+
+        if (!is_cvar_type(cvar->datatype) || MPI_T_SCOPE_CONSTANT == scope ||
+                MPI_T_SCOPE_READONLY == scope ||
+                (MPI_T_BIND_NO_OBJECT != bind &&
+                 MPI_T_BIND_MPI_COMM != bind)) {
+            return -1;
+        }
+
+        if (MPI_SUCCESS != MPI_T_cvar_handle_alloc(i, &tune_bind_comm,
+                    &cvar->handle, &count) || 1 != count) {
+            return -1;
+        }
+
+        return 0;
+    }
+
+    return -1;
+}
+
+/*
+ * Parses NAME=V1:V2 into CVAR and returns NULL, or an error message after
+ * releasing the cvar handle.
+ */
+static char const * parse_tune_cvar (struct tune_cvar_t * cvar, char * spec,
+        int num)
+{
+    char * values = strchr(spec, '='), * value, * saveptr = NULL;
+    char const * error = NULL;
+
+    if (NULL != values) {
+        *values++ = '\0';
+    }
+
+    snprintf(cvar->name, sizeof(cvar->name), "%s", spec);
+
+    if (NULL == values) {
+        return "expected NAME=VALUE[:VALUE]";
+    }
+
+    if (find_cvar(cvar, num)) {
+        return "not found or not writable";
+    }
+
+    cvar->num_values = 0;
+    cvar->original = read_cvar(cvar);
+
+    for (value = strtok_r(values, ":", &saveptr); NULL != value && !error;
+            value = strtok_r(NULL, ":", &saveptr)) {
+        if (MAX_TUNE_VALUES == cvar->num_values) {
+            error = "too many values";
+        } else if (parse_cvar_value(cvar, value)) {
+            error = "invalid value";
+        } else {
+            snprintf(cvar->label[cvar->num_values], sizeof(cvar->label[0]),
+                    "%s", value);
+            cvar->num_values++;
+        }
+    }
+
+    if (!error && !cvar->num_values) {
+        error = "no values";
+    }
+
+    if (error) {
+        MPI_T_cvar_handle_free(&cvar->handle);
+    }
+
+    return error;
+}
+#endif
+
+/*
+ * Returns 0 when the benchmark should go on, which it also does without -J,
+ * and 1 when a cvar cannot be tuned, which rank 0 reports.
+ */
+int setup_tuning (int rank)
+{
+#if MPI_VERSION >= 3
+    char spec[1024], * cvar, * saveptr = NULL;
+    char const * error = NULL, * name = "";
+    int provided, num;
+#endif
+
+    if (TUNE_ON != options.tune) {
+        return 0;
+    }
+
+#if MPI_VERSION >= 3
+    if (MPI_SUCCESS != MPI_T_init_thread(MPI_THREAD_SINGLE, &provided) ||
+            MPI_SUCCESS != MPI_T_cvar_get_num(&num)) {
+        if (0 == rank) {
+            fprintf(stderr, "The MPI_T interface is not available\n");
+        }
+
+        return 1;
+    }
+
+    tune_bind_comm = MPI_COMM_WORLD;
+    snprintf(spec, sizeof(spec), "%s", options.tune_spec);
+
+    for (cvar = strtok_r(spec, ",", &saveptr); NULL != cvar && NULL == error;
+            cvar = strtok_r(NULL, ",", &saveptr)) {
+        name = cvar;
+
+        if (MAX_TUNE_CVARS == num_tune_cvars) {
+            error = "too many cvars";
+        } else if (NULL == (error = parse_tune_cvar(
+                        &tune_cvar[num_tune_cvars], cvar, num))) {
+            num_settings *= tune_cvar[num_tune_cvars++].num_values;
+        } else {
+            name = tune_cvar[num_tune_cvars].name;
+        }
+    }
+
+    if (NULL == error && num_settings > MAX_TUNE_SETTINGS) {
+        error = "too many settings";
+    }
+
+    if (NULL != error) {
+        if (0 == rank) {
+            fprintf(stderr, "Cannot tune MPI_T cvar [%s]: %s\n", name, error);
+        }
+
+        cleanup_tuning();
+        return 1;
+    }
+
+    return 0;
+#else
+    if (0 == rank) {
+        fprintf(stderr, "MPI_T cvars need an MPI-3 library\n");
+    }
+
+    return 1;
+#endif
+}
+
+int num_tune_settings (void)
+{
+    return num_settings;
+}
+
+/*
+ * Collective, returns the communicator to time SETTING on.  A negative
+ * SETTING restores the original values and returns MPI_COMM_WORLD.
+ */
+MPI_Comm apply_tune_setting (int setting)
+{
+#if MPI_VERSION >= 3
+    int c, restore = 0 > setting;
+
+    if (TUNE_ON != options.tune) {
+        return MPI_COMM_WORLD;
+    }
+
+    if (MPI_COMM_NULL != tune_comm) {
+        MPI_CHECK(MPI_Comm_free(&tune_comm));
+    }
+
+    for (c = 0; c < num_tune_cvars; c++) {
+        struct tune_cvar_t const * cvar = &tune_cvar[c];
+
+        if (restore) {
+            MPI_CHECK(write_cvar(cvar, cvar->original));
+        } else {
+            MPI_CHECK(write_cvar(cvar,
+                        cvar->value[setting % cvar->num_values]));
+            setting /= cvar->num_values;
+        }
+    }
+
+    if (restore) {
+        return MPI_COMM_WORLD;
+    }
+
+    MPI_CHECK(MPI_Comm_dup(MPI_COMM_WORLD, &tune_comm));
+
+    return tune_comm;
+#else
+    return MPI_COMM_WORLD;
+#endif
+}
+
+/*
+ * Rank 0, VALUE is a bandwidth for BW benchmarks and a latency otherwise.
+ * Returns 1 if SETTING is the best of the size so far.
+ */
+int record_tune_result (int setting, double value)
+{
+    int better = BW == options.subtype ? value > tune_best_value :
+        value < tune_best_value;
+    int worse = BW == options.subtype ? value < tune_worst_value :
+        value > tune_worst_value;
+
+    if (0 == setting || worse) {
+        tune_worst_value = value;
+    }
+
+    if (0 > tune_best || better) {
+        tune_best = setting;
+        tune_best_value = value;
+
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Collective, restores the original cvars after the settings of SIZE and
+ * returns, on rank 0, the value of the best setting.
+ */
+double finish_tune_size (size_t size)
+{
+    double best = tune_best_value;
+
+    if (TUNE_ON == options.tune) {
+        apply_tune_setting(-1);
+    }
+
+    if (TUNE_ON == options.tune && 0 <= tune_best) {
+        if (num_tune_results == max_tune_results) {
+            max_tune_results = max_tune_results ? 2 * max_tune_results : 64;
+            tune_results = realloc(tune_results,
+                    sizeof(struct tune_result_t) * max_tune_results);
+
+            if (NULL == tune_results) {
+                fprintf(stderr, "Could not allocate the tuning table\n");
+                MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+            }
+        }
+
+        tune_results[num_tune_results].size = size;
+        tune_results[num_tune_results].best = tune_best;
+        tune_results[num_tune_results].best_value = tune_best_value;
+        tune_results[num_tune_results].worst_value = tune_worst_value;
+        num_tune_results++;
+    }
+
+    tune_best = -1;
+
+    return best;
+}
+
+void print_tuning_table (int rank)
+{
+#if MPI_VERSION >= 3
+    char const * unit = BW == options.subtype ? "MB/s" : "us";
+    struct result_metric_t metrics[2 + MAX_TUNE_CVARS];
+    int r, c, setting, numprocs;
+
+    if (TUNE_ON != options.tune || 0 != rank) {
+        return;
+    }
+
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "\n# Tuning table, best of %d settings per size\n",
+                num_settings);
+        fprintf(stdout, "%-*s", 10, "# Size");
+        for (c = 0; c < num_tune_cvars; c++) {
+            fprintf(stdout, "%*s", MAX(FIELD_WIDTH,
+                        (int)strlen(tune_cvar[c].name) + 2), tune_cvar[c].name);
+        }
+        fprintf(stdout, "%*s%s)%*s%s)\n", FIELD_WIDTH - 2 - (int)strlen(unit),
+                "Best (", unit, FIELD_WIDTH - 3 - (int)strlen(unit), "Worst (",
+                unit);
+    }
+
+    for (r = 0; r < num_tune_results; r++) {
+        struct tune_result_t const * result = &tune_results[r];
+
+        setting = result->best;
+
+        if (OUTPUT_TABLE == options.output_format) {
+            fprintf(stdout, "%-*zu", 10, result->size);
+            for (c = 0; c < num_tune_cvars; c++) {
+                fprintf(stdout, "%*s", MAX(FIELD_WIDTH,
+                            (int)strlen(tune_cvar[c].name) + 2),
+                        tune_cvar[c].label[setting % tune_cvar[c].num_values]);
+                setting /= tune_cvar[c].num_values;
+            }
+            fprintf(stdout, "%*.*f%*.*f\n", FIELD_WIDTH, FLOAT_PRECISION,
+                    result->best_value, FIELD_WIDTH, FLOAT_PRECISION,
+                    result->worst_value);
+        } else {
+            for (c = 0; c < num_tune_cvars; c++) {
+                metrics[c].name = tune_cvar[c].name;
+                metrics[c].value =
+                    tune_cvar[c].value[setting % tune_cvar[c].num_values];
+                setting /= tune_cvar[c].num_values;
+            }
+            metrics[c].name = "tune_best";
+            metrics[c].value = result->best_value;
+            metrics[c + 1].name = "tune_worst";
+            metrics[c + 1].value = result->worst_value;
+
+            output_result(numprocs, result->size, c + 2, metrics);
+        }
+    }
+
+    fflush(stdout);
+#endif
+}
+
+void cleanup_tuning (void)
+{
+#if MPI_VERSION >= 3
+    int c;
+
+    if (TUNE_ON != options.tune) {
+        return;
+    }
+
+    for (c = 0; c < num_tune_cvars; c++) {
+        MPI_T_cvar_handle_free(&tune_cvar[c].handle);
+    }
+
+    MPI_T_finalize();
+    free(tune_results);
+    tune_results = NULL;
+    num_tune_results = max_tune_results = num_tune_cvars = 0;
+    num_settings = 1;
+    options.tune = TUNE_OFF;
+#endif
+}
+
+/*
+ * Hardware Counters
+ *
+ * -Z EVENTS opens one perf_event counter per event for the calling process,
+ * user space only so that the default perf_event_paranoid setting allows it,
+ * through the raw system call as for the CPU affinity.  start_counters() and
+ * stop_counters() enable them around the loop of every size, and the counts
+ * per iteration, scaled up when the kernel multiplexed the counters, are
+ * averaged over the ranks into the extra columns after the pvars.
+ */
+#if defined(__linux__) && defined(__NR_perf_event_open)
+#define HAVE_PERF_EVENT 1
+
+struct counter_event_t {
+    char const * name;
+    uint32_t type;
+    uint64_t config;
+};
+
+static struct counter_event_t const counter_events[] = {
+    {"cycles",          PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions",    PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"llc-misses",      PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"dtlb-misses",     PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB |
+        (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {"branch-misses",   PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {"page-faults",     PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+    {"context-switches",PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+};
+
+#define NUM_COUNTER_EVENTS  (int)(sizeof(counter_events) / sizeof(counter_events[0]))
+#define DEF_COUNTER_EVENTS  "cycles,instructions,llc-misses,dtlb-misses"
+
+static int counter_fd[MAX_COUNTER_COLUMNS];
+#endif
+
+static int num_counters = 0, counter_base = 0;
+
+#ifdef HAVE_PERF_EVENT
+static int open_counter (char const * name)
+{
+    struct perf_event_attr attr;
+    int e;
+
+    for (e = 0; e < NUM_COUNTER_EVENTS; e++) {
+        if (0 == strcmp(name, counter_events[e].name)) {
+            break;
+        }
+    }
+
+    if (NUM_COUNTER_EVENTS == e) {
+        return -1;
+    }
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = counter_events[e].type;
+    attr.config = counter_events[e].config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+        PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+/*
+ * Collective.  Returns 0 when the benchmark should go on, which it also does
+ * without -Z, and 1 when an event is unknown or could not be opened on some
+ * rank, which that rank reports.  "default" stands for DEF_COUNTER_EVENTS.
+ */
+int setup_counters (int rank)
+{
+#ifdef HAVE_PERF_EVENT
+    char names[256], * name, * saveptr = NULL;
+    char const * failed = NULL;
+    int local = 0, global;
+#endif
+
+    if (COUNTERS_ON != options.counters) {
+        return 0;
+    }
+
+#ifdef HAVE_PERF_EVENT
+    snprintf(names, sizeof(names), "%s",
+            strcmp(options.counter_names, "default") ? options.counter_names :
+            DEF_COUNTER_EVENTS);
+    counter_base = extra_columns.num;
+
+    for (name = strtok_r(names, ",", &saveptr); NULL != name && !failed;
+            name = strtok_r(NULL, ",", &saveptr)) {
+        int n = counter_base + num_counters;
+
+        if (MAX_COUNTER_COLUMNS == num_counters ||
+                0 > (counter_fd[num_counters] = open_counter(name))) {
+            failed = name;
+            local = 1;
+            break;
+        }
+
+        snprintf(extra_columns.name[n], sizeof(extra_columns.name[n]),
+                "%s/iter", name);
+        extra_columns.width[n] = MAX(FIELD_WIDTH,
+                (int)strlen(extra_columns.name[n]) + 2);
+        num_counters++;
+    }
+
+    MPI_CHECK(MPI_Allreduce(&local, &global, 1, MPI_INT, MPI_MAX,
+                MPI_COMM_WORLD));
+
+    if (global) {
+        if (failed) {
+            fprintf(stderr, "Could not open hardware counter [%s] on rank %d "
+                    "(known: cycles, instructions, llc-misses, dtlb-misses, "
+                    "branch-misses, page-faults, context-switches)\n", failed,
+                    rank);
+        }
+
+        cleanup_counters();
+        return 1;
+    }
+
+    extra_columns.num += num_counters;
+
+    return 0;
+#else
+    if (0 == rank) {
+        fprintf(stderr, "Hardware counters need Linux perf_event\n");
+    }
+
+    return 1;
+#endif
+}
+
+void start_counters (void)
+{
+#ifdef HAVE_PERF_EVENT
+    int i;
+
+    for (i = 0; i < num_counters; i++) {
+        ioctl(counter_fd[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter_fd[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+/* Collective, ITERATIONS is the number of iterations of the loop */
+void stop_counters (double iterations)
+{
+#ifdef HAVE_PERF_EVENT
+    double local[MAX_COUNTER_COLUMNS], sum[MAX_COUNTER_COLUMNS];
+    uint64_t count[3];
+    int i, numprocs;
+
+    if (0 == num_counters) {
+        return;
+    }
+
+    for (i = 0; i < num_counters; i++) {
+        ioctl(counter_fd[i], PERF_EVENT_IOC_DISABLE, 0);
+
+        /* count[1] and count[2] are the times enabled and running */
+        if (sizeof(count) != read(counter_fd[i], count, sizeof(count)) ||
+                0 == count[2]) {
+            local[i] = 0;
+        } else {
+            local[i] = (double)count[0] * count[1] / count[2] / iterations;
+        }
+    }
+
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    MPI_CHECK(MPI_Reduce(local, sum, num_counters, MPI_DOUBLE, MPI_SUM, 0,
+                MPI_COMM_WORLD));
+
+    for (i = 0; i < num_counters; i++) {
+        extra_columns.value[counter_base + i] = sum[i] / numprocs;
+    }
+#endif
+}
+
+void cleanup_counters (void)
+{
+#ifdef HAVE_PERF_EVENT
+    int i;
+
+    for (i = 0; i < num_counters; i++) {
+        close(counter_fd[i]);
+    }
+#endif
+
+    num_counters = 0;
+}
+
+/*
+ * Memory Footprint
+ *
+ * The samples stay on the rank until mem_footprint_report(), so nothing is
+ * communicated between the timed sizes.  Every sample holds VmRSS and VmHWM
+ * in KB and, once MPI is initialized, the first MAX_MEM_PVARS MPI_T
+ * performance variables not bound to an object whose name mentions memory,
+ * in the units of the library; the pvars of earlier samples read as 0.
+ */
+#define MAX_MEM_PVARS   4
+#define MEM_VALUES      (2 + MAX_MEM_PVARS)
+#define MEM_STATS       6
+
+struct mem_sample_t {
+    enum mem_point point;
+    size_t size;
+    double value[MEM_VALUES];
+};
+
+static char const * mem_point_name[] = {"before MPI_Init", "after MPI_Init",
+    "after alloc", "after size"};
+
+static struct mem_sample_t * mem_samples = NULL;
+static int num_mem_samples = 0, max_mem_samples = 0;
+static int num_mem_pvars = 0;
+static char mem_pvar_name[MAX_MEM_PVARS][64];
+
+#if MPI_VERSION >= 3
+static int mem_pvars_state = 0;
+static MPI_T_pvar_session mem_pvar_session;
+static MPI_T_pvar_handle mem_pvar_handle[MAX_MEM_PVARS];
+static MPI_Datatype mem_pvar_type[MAX_MEM_PVARS];
+
+static int is_mem_pvar (char const * name, int var_class,
+        MPI_Datatype datatype, int bind)
+{
+    char lower[64];
+    int i;
+
+    if (MPI_T_BIND_NO_OBJECT != bind) {
+        return 0;
+    }
+
+    if (MPI_T_PVAR_CLASS_SIZE != var_class &&
+            MPI_T_PVAR_CLASS_LEVEL != var_class &&
+            MPI_T_PVAR_CLASS_HIGHWATERMARK != var_class &&
+            MPI_T_PVAR_CLASS_COUNTER != var_class) {
+        return 0;
+    }
+
+    if (!is_pvar_type(datatype)) {
+        return 0;
+    }
+
+    for (i = 0; name[i] && i < (int)sizeof(lower) - 1; i++) {
+        lower[i] = tolower((unsigned char)name[i]);
+    }
+    lower[i] = '\0';
+
+    return NULL != strstr(lower, "mem");
+}
+
+static void setup_mem_pvars (void)
+{
+    char name[64], desc[256];
+    int provided, num, i, name_len, desc_len, verbosity, var_class, bind;
+    int readonly, continuous, atomic, count;
+    MPI_Datatype datatype;
+    MPI_T_enum enumtype;
+    MPI_T_pvar_handle handle;
+
+    mem_pvars_state = -1;
+
+    if (MPI_SUCCESS != MPI_T_init_thread(MPI_THREAD_SINGLE, &provided)) {
+        return;
+    }
+
+    if (MPI_SUCCESS != MPI_T_pvar_get_num(&num) ||
+            MPI_SUCCESS != MPI_T_pvar_session_create(&mem_pvar_session)) {
+        MPI_T_finalize();
+        return;
+    }
+
+    mem_pvars_state = 1;
+
+    for (i = 0; i < num && num_mem_pvars < MAX_MEM_PVARS; i++) {
+        name_len = sizeof(name);
+        desc_len = sizeof(desc);
+
+        if (MPI_SUCCESS != MPI_T_pvar_get_info(i, name, &name_len,
+                    &verbosity, &var_class, &datatype, &enumtype, desc,
+                    &desc_len, &bind, &readonly, &continuous, &atomic) ||
+                !is_mem_pvar(name, var_class, datatype, bind)) {
+            continue;
+        }
+
+        if (MPI_SUCCESS != MPI_T_pvar_handle_alloc(mem_pvar_session, i, NULL,
+                    &handle, &count)) {
+            continue;
+        }
+
+        if (1 != count || (!continuous && MPI_SUCCESS !=
+                    MPI_T_pvar_start(mem_pvar_session, handle))) {
+            MPI_T_pvar_handle_free(mem_pvar_session, &handle);
+            continue;
+        }
+
+        mem_pvar_handle[num_mem_pvars] = handle;
+        mem_pvar_type[num_mem_pvars] = datatype;
+        snprintf(mem_pvar_name[num_mem_pvars], sizeof(mem_pvar_name[0]), "%s",
+                name);
+        num_mem_pvars++;
+    }
+}
+
+static void cleanup_mem_pvars (void)
+{
+    int i;
+
+    if (1 != mem_pvars_state) {
+        return;
+    }
+
+    for (i = 0; i < num_mem_pvars; i++) {
+        MPI_T_pvar_handle_free(mem_pvar_session, &mem_pvar_handle[i]);
+    }
+
+    MPI_T_pvar_session_free(&mem_pvar_session);
+    MPI_T_finalize();
+    mem_pvars_state = 0;
+}
+#endif
+
+void mem_footprint_sample (enum mem_point point, size_t size)
+{
+    struct mem_sample_t * sample;
+    long rss, hwm;
+#if MPI_VERSION >= 3
+    int initialized = 0, i;
+#endif
+
+    if (MEM_FOOTPRINT_ON != options.mem_footprint) {
+        return;
+    }
+
+    if (num_mem_samples == max_mem_samples) {
+        max_mem_samples = max_mem_samples ? 2 * max_mem_samples : 64;
+        mem_samples = realloc(mem_samples,
+                sizeof(struct mem_sample_t) * max_mem_samples);
+
+        if (NULL == mem_samples) {
+            fprintf(stderr, "Could not allocate the memory samples\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    sample = &mem_samples[num_mem_samples++];
+    memset(sample, 0, sizeof(struct mem_sample_t));
+    sample->point = point;
+    sample->size = size;
+
+    if (0 == process_memory_kb(&rss, &hwm)) {
+        sample->value[0] = rss;
+        sample->value[1] = hwm;
+    }
+
+#if MPI_VERSION >= 3
+    MPI_CHECK(MPI_Initialized(&initialized));
+
+    if (initialized && 0 == mem_pvars_state) {
+        setup_mem_pvars();
+    }
+
+    for (i = 0; i < num_mem_pvars; i++) {
+        sample->value[2 + i] = read_pvar(mem_pvar_session,
+                mem_pvar_handle[i], mem_pvar_type[i], 1);
+    }
+#endif
+}
+
+/*
+ * Every rank must have taken the same samples.  Per variable and sample the
+ * minimum, average and maximum over the ranks and over the nodes, a node
+ * being the sum of its ranks, are printed by rank 0.
+ */
+void mem_footprint_report (int rank)
+{
+    int nvalues = 2 + num_mem_pvars, n = num_mem_samples * nvalues;
+    int nprocs, nnodes = 0, node_rank, s, v, k;
+    double * local, * node, * stat[MEM_STATS];
+    MPI_Comm node_comm, leader_comm;
+    char const * stat_name[MEM_STATS] = {"rank_min", "rank_avg", "rank_max",
+        "node_min", "node_avg", "node_max"};
+
+    if (MEM_FOOTPRINT_ON != options.mem_footprint || 0 == n) {
+        return;
+    }
+
+    local = malloc(sizeof(double) * n * (2 + MEM_STATS));
+
+    if (NULL == local) {
+        fprintf(stderr, "Could not allocate the memory report\n");
+        MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+    }
+
+    node = local + n;
+    for (k = 0; k < MEM_STATS; k++) {
+        stat[k] = node + (k + 1) * n;
+    }
+
+    for (s = 0; s < num_mem_samples; s++) {
+        for (v = 0; v < nvalues; v++) {
+            local[s * nvalues + v] = mem_samples[s].value[v];
+        }
+    }
+
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    MPI_CHECK(MPI_Reduce(local, stat[0], n, MPI_DOUBLE, MPI_MIN, 0,
+                MPI_COMM_WORLD));
+    MPI_CHECK(MPI_Reduce(local, stat[1], n, MPI_DOUBLE, MPI_SUM, 0,
+                MPI_COMM_WORLD));
+    MPI_CHECK(MPI_Reduce(local, stat[2], n, MPI_DOUBLE, MPI_MAX, 0,
+                MPI_COMM_WORLD));
+
+    MPI_CHECK(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+                MPI_INFO_NULL, &node_comm));
+    MPI_CHECK(MPI_Comm_rank(node_comm, &node_rank));
+    MPI_CHECK(MPI_Reduce(local, node, n, MPI_DOUBLE, MPI_SUM, 0, node_comm));
+    MPI_CHECK(MPI_Comm_split(MPI_COMM_WORLD, node_rank ? MPI_UNDEFINED : 0,
+                rank, &leader_comm));
+
+    if (0 == node_rank) {
+        MPI_CHECK(MPI_Comm_size(leader_comm, &nnodes));
+        MPI_CHECK(MPI_Reduce(node, stat[3], n, MPI_DOUBLE, MPI_MIN, 0,
+                    leader_comm));
+        MPI_CHECK(MPI_Reduce(node, stat[4], n, MPI_DOUBLE, MPI_SUM, 0,
+                    leader_comm));
+        MPI_CHECK(MPI_Reduce(node, stat[5], n, MPI_DOUBLE, MPI_MAX, 0,
+                    leader_comm));
+        MPI_CHECK(MPI_Comm_free(&leader_comm));
+    }
+
+    MPI_CHECK(MPI_Comm_free(&node_comm));
+
+    if (0 == rank) {
+        for (k = 0; k < n; k++) {
+            stat[1][k] /= nprocs;
+            stat[4][k] /= nnodes;
+        }
+
+        if (OUTPUT_TABLE == options.output_format) {
+            fprintf(stdout, "\n# Memory footprint, %d ranks on %d nodes, a node "
+                    "is the sum of its ranks\n", nprocs, nnodes);
+        }
+
+        for (v = 0; v < nvalues; v++) {
+            if (OUTPUT_TABLE == options.output_format) {
+                fprintf(stdout, "# %s%s\n", v > 1 ? "MPI_T pvar " : "",
+                        v == 0 ? "VmRSS (KB)" : v == 1 ? "VmHWM (KB)" :
+                        mem_pvar_name[v - 2]);
+                fprintf(stdout, "%-*s%*s%*s%*s%*s%*s%*s%*s\n", 18, "# Point",
+                        10, "Size", FIELD_WIDTH, "Rank Min", FIELD_WIDTH,
+                        "Rank Avg", FIELD_WIDTH, "Rank Max", FIELD_WIDTH,
+                        "Node Min", FIELD_WIDTH, "Node Avg", FIELD_WIDTH,
+                        "Node Max");
+            }
+
+            for (s = 0; s < num_mem_samples; s++) {
+                struct mem_sample_t const * sample = &mem_samples[s];
+
+                if (OUTPUT_TABLE == options.output_format) {
+                    fprintf(stdout, "%-*s", 18, mem_point_name[sample->point]);
+                    if (MEM_AFTER_SIZE == sample->point) {
+                        fprintf(stdout, "%*zu", 10, sample->size);
+                    } else {
+                        fprintf(stdout, "%*s", 10, "-");
+                    }
+                    for (k = 0; k < MEM_STATS; k++) {
+                        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                                stat[k][s * nvalues + v]);
+                    }
+                    fprintf(stdout, "\n");
+                } else {
+                    struct result_metric_t metrics[2 + MEM_STATS];
+
+                    metrics[0].name = "mem_point";
+                    metrics[0].value = sample->point;
+                    metrics[1].name = "mem_variable";
+                    metrics[1].value = v;
+                    for (k = 0; k < MEM_STATS; k++) {
+                        metrics[2 + k].name = stat_name[k];
+                        metrics[2 + k].value = stat[k][s * nvalues + v];
+                    }
+
+                    output_result(nprocs, sample->size, 2 + MEM_STATS, metrics);
+                }
+            }
+        }
+
+        fflush(stdout);
+    }
+
+    free(local);
+    free(mem_samples);
+    mem_samples = NULL;
+    num_mem_samples = max_mem_samples = 0;
+
+#if MPI_VERSION >= 3
+    cleanup_mem_pvars();
+#endif
+}
+
+/*
+ * CPU and Memory Affinity
+ *
+ * The raw system calls are used so that neither _GNU_SOURCE nor libnuma is
+ * required.  The -b CPU list is split evenly between the ranks of a node in
+ * local rank order; with fewer CPUs than ranks every rank gets one CPU round
+ * robin.  Threads started by the multi-threaded tests call bind_thread() to
+ * take one CPU of their rank's share each.
+ */
+#define AFFINITY_BITS       (8 * sizeof(unsigned long))
+#define AFFINITY_WORDS      (MAX_BIND_CPUS / AFFINITY_BITS)
+#define AFFINITY_LINE_LEN   256
+#define MPOL_BIND_MODE      2       /* MPOL_BIND of <numaif.h> */
+#define MPOL_MF_MOVE_FLAG   (1 << 1)
+
+static struct {
+    int cpus[MAX_BIND_CPUS];
+    int ncpus;
+} affinity;
+
+static int set_cpu_mask (int const * cpus, int ncpus)
+{
+#ifdef SYS_sched_setaffinity
+    unsigned long mask[AFFINITY_WORDS] = {0};
+    int i;
+
+    for (i = 0; i < ncpus; i++) {
+        mask[cpus[i] / AFFINITY_BITS] |= 1UL << (cpus[i] % AFFINITY_BITS);
+    }
+
+    return syscall(SYS_sched_setaffinity, 0, sizeof(mask), mask) ? -1 : 0;
+#else
+    return -1;
+#endif
+}
+
+/*
+ * Format the mask the kernel actually applied as a list of ranges
+ */
+static void format_cpu_mask (char * buf, size_t len)
+{
+    unsigned long mask[AFFINITY_WORDS] = {0};
+    size_t used = 0;
+    int cpu, first = -1;
+
+    buf[0] = '\0';
+#ifdef SYS_sched_getaffinity
+    if (0 > syscall(SYS_sched_getaffinity, 0, sizeof(mask), mask)) {
+        snprintf(buf, len, "unknown");
+        return;
+    }
+#endif
+
+    for (cpu = 0; cpu <= MAX_BIND_CPUS; cpu++) {
+        int set = cpu < MAX_BIND_CPUS &&
+            (mask[cpu / AFFINITY_BITS] >> (cpu % AFFINITY_BITS)) & 1;
+
+        if (set && 0 > first) {
+            first = cpu;
+        } else if (!set && 0 <= first && used < len) {
+            used += snprintf(buf + used, len - used, "%s%d", used ? "," : "",
+                    first);
+            if (cpu - 1 > first && used < len) {
+                used += snprintf(buf + used, len - used, "-%d", cpu - 1);
+            }
+            first = -1;
+        }
+    }
+}
+
+int setup_affinity (void)
+{
+    MPI_Comm node_comm;
+    char name[MPI_MAX_PROCESSOR_NAME];
+    char cpus[AFFINITY_LINE_LEN / 2];
+    char line[AFFINITY_LINE_LEN], mem[32];
+    char * lines = NULL;
+    int rank, nprocs, local_rank, local_size, name_len, share, i;
+    char gpu[AFFINITY_LINE_LEN / 4];
+    int status = 0;
+
+    if (rebind_accel()) {
+        return -1;
+    }
+
+    if (0 == options.num_bind_cpus && 0 > options.mem_node &&
+            NONE == options.accel) {
+        return 0;
+    }
+
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nprocs));
+    MPI_CHECK(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+                MPI_INFO_NULL, &node_comm));
+    MPI_CHECK(MPI_Comm_rank(node_comm, &local_rank));
+    MPI_CHECK(MPI_Comm_size(node_comm, &local_size));
+    MPI_CHECK(MPI_Comm_free(&node_comm));
+
+    if (options.num_bind_cpus) {
+        share = options.num_bind_cpus / local_size;
+
+        if (share) {
+            affinity.ncpus = share;
+            memcpy(affinity.cpus, options.bind_cpus + local_rank * share,
+                    share * sizeof(int));
+        } else {
+            affinity.ncpus = 1;
+            affinity.cpus[0] = options.bind_cpus[local_rank % options.num_bind_cpus];
+        }
+
+        status = set_cpu_mask(affinity.cpus, affinity.ncpus);
+    }
+
+    MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &status, 1, MPI_INT, MPI_MIN,
+                MPI_COMM_WORLD));
+    if (status) {
+        return -1;
+    }
+
+    MPI_CHECK(MPI_Get_processor_name(name, &name_len));
+    format_cpu_mask(cpus, sizeof(cpus));
+    if (0 > options.mem_node) {
+        snprintf(mem, sizeof(mem), "first touch");
+    } else {
+        snprintf(mem, sizeof(mem), "node %d", options.mem_node);
+    }
+    format_gpu_placement(gpu, sizeof(gpu));
+    snprintf(line, sizeof(line), "# Rank %d on %.64s: CPUs %s, memory %s%s\n",
+            rank, name, cpus, mem, gpu);
+
+    if (0 == rank) {
+        lines = malloc((size_t)nprocs * AFFINITY_LINE_LEN);
+        affinity_placement = malloc((size_t)nprocs * AFFINITY_LINE_LEN + 1);
+        if (NULL == lines || NULL == affinity_placement) {
+            fprintf(stderr, "Error allocating affinity report\n");
+            MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+        }
+    }
+
+    MPI_CHECK(MPI_Gather(line, AFFINITY_LINE_LEN, MPI_CHAR, lines,
+                AFFINITY_LINE_LEN, MPI_CHAR, 0, MPI_COMM_WORLD));
+
+    if (0 == rank) {
+        affinity_placement[0] = '\0';
+        for (i = 0; i < nprocs; i++) {
+            strcat(affinity_placement, lines + (size_t)i * AFFINITY_LINE_LEN);
+        }
+        free(lines);
+    }
+
+    return 0;
+}
+
+void bind_thread (int id)
+{
+    if (affinity.ncpus) {
+        set_cpu_mask(&affinity.cpus[id % affinity.ncpus], 1);
+    }
+}
+
+/*
+ * Bind the pages of BUF to options.mem_node.  Pages that were touched
+ * already are migrated.
+ */
+int bind_memory (void * buf, size_t size)
+{
+    if (0 > options.mem_node || 0 == size) {
+        return 0;
+    }
+
+#ifdef SYS_mbind
+    unsigned long nodemask[AFFINITY_WORDS] = {0};
+    uintptr_t page = getpagesize();
+    uintptr_t start = (uintptr_t)buf & ~(page - 1);
+    uintptr_t end = (uintptr_t)buf + size;
+
+    nodemask[options.mem_node / AFFINITY_BITS] |=
+        1UL << (options.mem_node % AFFINITY_BITS);
+
+    return syscall(SYS_mbind, start, end - start, MPOL_BIND_MODE, nodemask,
+            MAX_BIND_CPUS, MPOL_MF_MOVE_FLAG) ? -1 : 0;
+#else
+    return -1;
+#endif
+}
+
+/*
+ * Reductions
+ *
+ * The user-defined operation is a sum with an explicitly vectorized kernel.
+ * It serves as a baseline for the library's built-in MPI_SUM, which may or
+ * may not be vectorized for a given datatype.  The same kernels, for sum,
+ * prod, max and min, are the host reference of osu_reduce_local.  The vectors
+ * are as wide as the registers the compiler targets, AVX-512, AVX or else
+ * SSE2 and NEON, since wider ones are split up into scalar comparisons.
+ */
+#if defined(__GNUC__)
+#if defined(__AVX512F__)
+#define SIMD_BYTES 64
+#elif defined(__AVX__)
+#define SIMD_BYTES 32
+#else
+#define SIMD_BYTES 16
+#endif
+#define DEFINE_REDUCE_KERNEL(NAME, TYPE, MASK, VEC_OP, OP)                  \
+typedef TYPE NAME##_vec __attribute__((vector_size(SIMD_BYTES)));          \
+typedef MASK NAME##_mask __attribute__((vector_size(SIMD_BYTES)));         \
+static void NAME (TYPE const * in, TYPE * inout, int len)                  \
+{                                                                           \
+    int const lanes = SIMD_BYTES / sizeof(TYPE);                            \
+    int i = 0;                                                              \
+                                                                            \
+    for (; i + lanes <= len; i += lanes) {                                  \
+        NAME##_vec a, b;                                                    \
+                                                                            \
+        memcpy(&a, in + i, sizeof(a));                                      \
+        memcpy(&b, inout + i, sizeof(b));                                   \
+        VEC_OP(NAME, a, b);                                                 \
+        memcpy(inout + i, &b, sizeof(b));                                   \
+    }                                                                       \
+                                                                            \
+    for (; i < len; i++) {                                                  \
+        OP(in[i], inout[i]);                                                \
+    }                                                                       \
+}
+
+/* Max and min select the lanes with the mask of the comparison */
+#define VEC_SUM(NAME, A, B)     ((B) += (A))
+#define VEC_PROD(NAME, A, B)    ((B) *= (A))
+#define VEC_SELECT(NAME, A, B, CMP)                                         \
+    do {                                                                    \
+        NAME##_mask m = (A) CMP (B);                                        \
+                                                                            \
+        (B) = (NAME##_vec)(((NAME##_mask)(A) & m) |                         \
+                ((NAME##_mask)(B) & ~m));                                   \
+    } while (0)
+#define VEC_MAX(NAME, A, B)     VEC_SELECT(NAME, A, B, >)
+#define VEC_MIN(NAME, A, B)     VEC_SELECT(NAME, A, B, <)
+#else
+#define DEFINE_REDUCE_KERNEL(NAME, TYPE, MASK, VEC_OP, OP)                  \
+static void NAME (TYPE const * in, TYPE * inout, int len)                  \
+{                                                                           \
+    int i;                                                                  \
+                                                                            \
+    for (i = 0; i < len; i++) {                                             \
+        OP(in[i], inout[i]);                                                \
+    }                                                                       \
+}
+#endif
+
+#define SCALAR_SUM(A, B)        ((B) += (A))
+#define SCALAR_PROD(A, B)       ((B) *= (A))
+#define SCALAR_MAX(A, B)        ((B) = (A) > (B) ? (A) : (B))
+#define SCALAR_MIN(A, B)        ((B) = (A) < (B) ? (A) : (B))
+
+#define DEFINE_REDUCE_KERNELS(SUFFIX, TYPE, MASK)                           \
+DEFINE_REDUCE_KERNEL(sum_##SUFFIX, TYPE, MASK, VEC_SUM, SCALAR_SUM)         \
+DEFINE_REDUCE_KERNEL(prod_##SUFFIX, TYPE, MASK, VEC_PROD, SCALAR_PROD)      \
+DEFINE_REDUCE_KERNEL(max_##SUFFIX, TYPE, MASK, VEC_MAX, SCALAR_MAX)         \
+DEFINE_REDUCE_KERNEL(min_##SUFFIX, TYPE, MASK, VEC_MIN, SCALAR_MIN)
+
+DEFINE_REDUCE_KERNELS(float, float, int32_t)
+DEFINE_REDUCE_KERNELS(double, double, int64_t)
+DEFINE_REDUCE_KERNELS(int, int, int32_t)
+DEFINE_REDUCE_KERNELS(int64, int64_t, int64_t)
+
+static void user_sum (void * in, void * inout, int * len,
+        MPI_Datatype * datatype)
+{
+    if (MPI_FLOAT == *datatype) {
+        sum_float(in, inout, *len);
+    } else if (MPI_DOUBLE == *datatype) {
+        sum_double(in, inout, *len);
+    } else if (MPI_INT == *datatype) {
+        sum_int(in, inout, *len);
+    } else if (MPI_INT64_T == *datatype) {
+        sum_int64(in, inout, *len);
+    }
+}
+
+static MPI_Op user_op = MPI_OP_NULL;
+
+MPI_Datatype reduction_datatype (void)
+{
+    switch (options.dtype) {
+        case DTYPE_DOUBLE:
+            return MPI_DOUBLE;
+        case DTYPE_INT:
+            return MPI_INT;
+        case DTYPE_INT64:
+            return MPI_INT64_T;
+        case DTYPE_FLOAT_INT:
+            return MPI_FLOAT_INT;
+        case DTYPE_DOUBLE_INT:
+            return MPI_DOUBLE_INT;
+        case DTYPE_2INT:
+            return MPI_2INT;
+        default:
+            return MPI_FLOAT;
+    }
+}
+
+/* Element stride in the buffers, which exceeds the size for the pair types */
+size_t reduction_extent (void)
+{
+    MPI_Aint lb, extent;
+
+    MPI_CHECK(MPI_Type_get_extent(reduction_datatype(), &lb, &extent));
+
+    return extent;
+}
+
+MPI_Op reduction_op (void)
+{
+    switch (options.op) {
+        case OP_PROD:
+            return MPI_PROD;
+        case OP_MAX:
+            return MPI_MAX;
+        case OP_MIN:
+            return MPI_MIN;
+        case OP_MAXLOC:
+            return MPI_MAXLOC;
+        case OP_MINLOC:
+            return MPI_MINLOC;
+        case OP_USER:
+            if (MPI_OP_NULL == user_op) {
+                MPI_CHECK(MPI_Op_create(user_sum, 1, &user_op));
+            }
+            return user_op;
+        default:
+            return MPI_SUM;
+    }
+}
+
+void free_reduction_op (void)
+{
+    if (MPI_OP_NULL != user_op) {
+        MPI_CHECK(MPI_Op_free(&user_op));
+    }
+}
+
+void print_reduction_summary (void)
+{
+    if (DTYPE_NONE == options.dtype ||
+            (DTYPE_FLOAT == options.dtype && OP_SUM == options.op)) {
+        return;
+    }
+
+    fprintf(stdout, "# Datatype: %s, Operation: %s\n", reduce_dtype_name(),
+            reduce_op_name());
+}
+
+#define REDUCE_BY_OP(SUFFIX)                                                \
+    switch (options.op) {                                                   \
+        case OP_SUM:                                                        \
+        case OP_USER:                                                       \
+            sum_##SUFFIX(in, inout, count);                                 \
+            return 0;                                                       \
+        case OP_PROD:                                                       \
+            prod_##SUFFIX(in, inout, count);                                \
+            return 0;                                                       \
+        case OP_MAX:                                                        \
+            max_##SUFFIX(in, inout, count);                                 \
+            return 0;                                                       \
+        case OP_MIN:                                                        \
+            min_##SUFFIX(in, inout, count);                                 \
+            return 0;                                                       \
+        default:                                                            \
+            return -1;                                                      \
+    }
+
+/*
+ * INOUT = IN op INOUT on host buffers of COUNT elements with the vectorized
+ * kernels, -1 for the pair types, which have none.
+ */
+int reduction_reference (void const * in, void * inout, int count)
+{
+    switch (options.dtype) {
+        case DTYPE_FLOAT:
+            REDUCE_BY_OP(float)
+        case DTYPE_DOUBLE:
+            REDUCE_BY_OP(double)
+        case DTYPE_INT:
+            REDUCE_BY_OP(int)
+        case DTYPE_INT64:
+            REDUCE_BY_OP(int64)
+        default:
+            return -1;
+    }
+}
+
+/*
+ * The same on device buffers with the reduction kernel, synchronized.  -1
+ * without the kernels, for managed and OpenACC buffers and for the pair
+ * types.
+ */
+int reduction_kernel (void const * in, void * inout, int count)
+{
+#if defined(_ENABLE_CUDA_KERNEL_) || defined(_ENABLE_ROCM_KERNEL_)
+    if ((CUDA != options.accel && ROCM != options.accel) ||
+            call_reduce_kernel(in, inout, count, options.dtype, options.op)) {
+        return -1;
+    }
+
+#ifdef _ENABLE_CUDA_KERNEL_
+    CUDA_CHECK(cudaDeviceSynchronize());
+#else
+    ROCM_CHECK(hipDeviceSynchronize());
+#endif
+
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+/*
+ * Hierarchical collectives
+ *
+ * Two-level compositions for the -H comparison: the ranks of a node share one
+ * MPI_Win_allocate_shared() segment, node leaders run the native collective
+ * among themselves and the result is read back from the segment.  The
+ * segment holds one input slot per local rank followed by the result.
+ */
+static struct {
+    MPI_Comm node_comm;
+    MPI_Comm leader_comm;
+    MPI_Win win;
+    char * slots;
+    char * result;
+    size_t slot_size;
+    int node_rank;
+    int node_size;
+    int num_nodes;
+    int min_ppn;
+    int max_ppn;
+} hierarchy = {
+    .node_comm = MPI_COMM_NULL,
+    .leader_comm = MPI_COMM_NULL,
+    .win = MPI_WIN_NULL,
+};
+
+double hierarchical_latency = 0.0;
+double persistent_init_latency = 0.0;
+
+/*
+ * Make the stores of every local rank visible to the others.  The window is
+ * kept in a passive epoch so MPI_Win_sync() is legal at any point.
+ */
+static void node_sync (void)
+{
+    MPI_CHECK(MPI_Win_sync(hierarchy.win));
+    MPI_CHECK(MPI_Barrier(hierarchy.node_comm));
+    MPI_CHECK(MPI_Win_sync(hierarchy.win));
+}
+
+/*
+ * Set up the node and leader communicators and a shared segment for messages
+ * of up to SIZE bytes.  WITH_SLOTS reserves the per-rank input slots that
+ * the reduction needs.  Collective over MPI_COMM_WORLD.
+ */
+int setup_hierarchy (size_t size, int with_slots)
+{
+    MPI_Aint seg_size;
+    int disp_unit, rank, ppn[2];
+
+    hierarchy.slot_size = (size + 63) & ~(size_t)63;
+
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+                MPI_INFO_NULL, &hierarchy.node_comm));
+    MPI_CHECK(MPI_Comm_rank(hierarchy.node_comm, &hierarchy.node_rank));
+    MPI_CHECK(MPI_Comm_size(hierarchy.node_comm, &hierarchy.node_size));
+    MPI_CHECK(MPI_Comm_split(MPI_COMM_WORLD, hierarchy.node_rank ?
+                MPI_UNDEFINED : 0, rank, &hierarchy.leader_comm));
+
+    if (MPI_COMM_NULL != hierarchy.leader_comm) {
+        MPI_CHECK(MPI_Comm_size(hierarchy.leader_comm, &hierarchy.num_nodes));
+    }
+    MPI_CHECK(MPI_Bcast(&hierarchy.num_nodes, 1, MPI_INT, 0,
+                hierarchy.node_comm));
+
+    ppn[0] = -hierarchy.node_size;
+    ppn[1] = hierarchy.node_size;
+    MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, ppn, 2, MPI_INT, MPI_MAX,
+                MPI_COMM_WORLD));
+    hierarchy.min_ppn = -ppn[0];
+    hierarchy.max_ppn = ppn[1];
+
+    seg_size = hierarchy.node_rank ? 0 : (MPI_Aint)hierarchy.slot_size *
+        ((with_slots ? hierarchy.node_size : 0) + 1);
+
+    if (MPI_SUCCESS != MPI_Win_allocate_shared(seg_size, 1, MPI_INFO_NULL,
+                hierarchy.node_comm, &hierarchy.slots, &hierarchy.win)) {
+        return -1;
+    }
+
+    MPI_CHECK(MPI_Win_shared_query(hierarchy.win, 0, &seg_size, &disp_unit,
+                &hierarchy.slots));
+    MPI_CHECK(MPI_Win_lock_all(MPI_MODE_NOCHECK, hierarchy.win));
+
+    hierarchy.result = hierarchy.slots + (with_slots ?
+            hierarchy.node_size * hierarchy.slot_size : 0);
+
+    return 0;
+}
+
+void cleanup_hierarchy (void)
+{
+    if (MPI_WIN_NULL == hierarchy.win) {
+        return;
+    }
+
+    MPI_CHECK(MPI_Win_unlock_all(hierarchy.win));
+    MPI_CHECK(MPI_Win_free(&hierarchy.win));
+    MPI_CHECK(MPI_Comm_free(&hierarchy.node_comm));
+
+    if (MPI_COMM_NULL != hierarchy.leader_comm) {
+        MPI_CHECK(MPI_Comm_free(&hierarchy.leader_comm));
+    }
+}
+
+/*
+ * Allreduce of COUNT elements: every local rank reduces its share of the node
+ * slots into the result, the leaders allreduce the node results and all ranks
+ * copy the global result out.  OP must be commutative.
+ */
+void hier_allreduce (void const * sendbuf, void * recvbuf, int count,
+        MPI_Datatype datatype, MPI_Op op)
+{
+    MPI_Aint lb, extent;
+    int chunk = (count + hierarchy.node_size - 1) / hierarchy.node_size;
+    int lo = hierarchy.node_rank * chunk;
+    int hi = (lo + chunk < count) ? lo + chunk : count;
+    int r;
+
+    MPI_CHECK(MPI_Type_get_extent(datatype, &lb, &extent));
+
+    memcpy(hierarchy.slots + hierarchy.node_rank * hierarchy.slot_size,
+            sendbuf, count * extent);
+    node_sync();
+
+    if (lo < hi) {
+        memcpy(hierarchy.result + lo * extent, hierarchy.slots + lo * extent,
+                (hi - lo) * extent);
+
+        for (r = 1; r < hierarchy.node_size; r++) {
+            MPI_CHECK(MPI_Reduce_local(hierarchy.slots + r *
+                        hierarchy.slot_size + lo * extent,
+                        hierarchy.result + lo * extent, hi - lo, datatype, op));
+        }
+    }
+    node_sync();
+
+    if (MPI_COMM_NULL != hierarchy.leader_comm && 1 < hierarchy.num_nodes) {
+        MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, hierarchy.result, count,
+                    datatype, op, hierarchy.leader_comm));
+    }
+    node_sync();
+
+    memcpy(recvbuf, hierarchy.result, count * extent);
+}
+
+/*
+ * Broadcast of SIZE bytes from rank 0, which is always the first leader: the
+ * leaders broadcast into their node segment and the other ranks copy it out.
+ */
+void hier_bcast (void * buffer, size_t size)
+{
+    int rank;
+
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+
+    if (MPI_COMM_NULL != hierarchy.leader_comm) {
+        if (0 == rank) {
+            memcpy(hierarchy.result, buffer, size);
+        }
+
+        if (1 < hierarchy.num_nodes) {
+            MPI_CHECK(MPI_Bcast(hierarchy.result, (int)size, MPI_CHAR, 0,
+                        hierarchy.leader_comm));
+        }
+    }
+    node_sync();
+
+    if (rank) {
+        memcpy(buffer, hierarchy.result, size);
+    }
+
+    /* Do not let the root overwrite the segment before everyone has read it */
+    node_sync();
+}
+
+void print_hierarchy_summary (void)
+{
+    fprintf(stdout, "# Hierarchical: %d node(s), %d", hierarchy.num_nodes,
+            hierarchy.min_ppn);
+    if (hierarchy.max_ppn != hierarchy.min_ppn) {
+        fprintf(stdout, "-%d", hierarchy.max_ppn);
+    }
+    fprintf(stdout, " rank(s) per node\n");
+}
+
+/*
+ * Segmented pipelines of -L, built from the non-blocking collectives.  The
+ * buffer is cut into chunks of options.pipeline_chunk bytes and at most
+ * options.pipeline_depth of them are in flight, so the transfer of one chunk
+ * overlaps the reduction or forwarding of the previous ones.  Every rank
+ * issues the chunks in the same order, as MPI requires.
+ */
+double pipelined_latency = 0.0;
+
+void pipelined_allreduce (void const * sendbuf, void * recvbuf, int count,
+        MPI_Datatype datatype, MPI_Op op)
+{
+    MPI_Request requests[MAX_PIPELINE_DEPTH];
+    MPI_Aint lb, extent;
+    int depth = options.pipeline_depth, chunk, offset, seg = 0, slot;
+
+    MPI_CHECK(MPI_Type_get_extent(datatype, &lb, &extent));
+    chunk = MAX(1, (int)(options.pipeline_chunk / extent));
+
+    for (offset = 0; offset < count; offset += chunk, seg++) {
+        slot = seg % depth;
+        if (seg >= depth) {
+            MPI_CHECK(MPI_Wait(&requests[slot], MPI_STATUS_IGNORE));
+        }
+
+        MPI_CHECK(MPI_Iallreduce((char const *)sendbuf + offset * extent,
+                    (char *)recvbuf + offset * extent,
+                    MIN(chunk, count - offset), datatype, op, MPI_COMM_WORLD,
+                    &requests[slot]));
+    }
+
+    MPI_CHECK(MPI_Waitall(MIN(seg, depth), requests, MPI_STATUSES_IGNORE));
+}
+
+void pipelined_bcast (void * buffer, size_t size)
+{
+    MPI_Request requests[MAX_PIPELINE_DEPTH];
+    size_t chunk = options.pipeline_chunk, offset;
+    int depth = options.pipeline_depth, seg = 0, slot;
+
+    for (offset = 0; offset < size; offset += chunk, seg++) {
+        slot = seg % depth;
+        if (seg >= depth) {
+            MPI_CHECK(MPI_Wait(&requests[slot], MPI_STATUS_IGNORE));
+        }
+
+        MPI_CHECK(MPI_Ibcast((char *)buffer + offset,
+                    (int)MIN(chunk, size - offset), MPI_CHAR, 0,
+                    MPI_COMM_WORLD, &requests[slot]));
+    }
+
+    MPI_CHECK(MPI_Waitall(MIN(seg, depth), requests, MPI_STATUSES_IGNORE));
+}
+
+/*
+ * Neighborhood collectives on a non-periodic process grid of
+ * options.stencil_dims dimensions.  Without wrap-around no rank is a neighbor
+ * twice or its own neighbor, so the messages of the neighborhood collective
+ * and of the hand-written exchange match one to one.  Ranks on the boundary
+ * have fewer neighbors: the Cartesian communicator gives them MPI_PROC_NULL,
+ * the distributed graphs leave them out.
+ */
+static struct {
+    MPI_Comm comm;
+    int dims[MAX_STENCIL_DIMS];
+    int num_neighbors;
+    int max_neighbors;
+    int neighbors[MAX_STENCIL_NEIGHBORS];
+    int boundary[MAX_STENCIL_NEIGHBORS];
+} stencil = {.comm = MPI_COMM_NULL};
+
+static void count_neighbors (void)
+{
+    int j;
+
+    stencil.max_neighbors = 0;
+    for (j = 0; j < stencil.num_neighbors; j++) {
+        stencil.max_neighbors += (MPI_PROC_NULL != stencil.neighbors[j]);
+    }
+
+    MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &stencil.max_neighbors, 1, MPI_INT,
+                MPI_MAX, MPI_COMM_WORLD));
+}
+
+double p2p_halo_latency = 0.0;
+
+MPI_Comm setup_stencil (void)
+{
+    int ndims = options.stencil_dims, periods[MAX_STENCIL_DIMS] = {0};
+    int coords[MAX_STENCIL_DIMS], neighbor[MAX_STENCIL_DIMS];
+    int weights[MAX_STENCIL_NEIGHBORS];
+    int numprocs, rank, i, j, k, index, inside;
+    MPI_Comm cart;
+
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+
+    for (i = 0; i < ndims; i++) {
+        stencil.dims[i] = 0;
+    }
+    MPI_CHECK(MPI_Dims_create(numprocs, ndims, stencil.dims));
+    MPI_CHECK(MPI_Cart_create(MPI_COMM_WORLD, ndims, stencil.dims, periods, 0,
+                &cart));
+
+    stencil.num_neighbors = 0;
+
+    /* The order of MPI_Neighbor_* on a Cartesian communicator, -1 then +1 */
+    if (STENCIL_FACE == options.stencil) {
+        for (i = 0; i < ndims; i++) {
+            MPI_CHECK(MPI_Cart_shift(cart, i, 1,
+                        &stencil.neighbors[stencil.num_neighbors],
+                        &stencil.neighbors[stencil.num_neighbors + 1]));
+            stencil.boundary[stencil.num_neighbors++] = 1;
+            stencil.boundary[stencil.num_neighbors++] = 1;
+        }
+
+        stencil.comm = cart;
+        count_neighbors();
+
+        return stencil.comm;
+    }
+
+    MPI_CHECK(MPI_Cart_coords(cart, rank, ndims, coords));
+
+    for (index = 0; index < (ndims == 3 ? 27 : ndims == 2 ? 9 : 3); index++) {
+        for (i = 0, j = index, k = 0, inside = 1; i < ndims; i++, j /= 3) {
+            neighbor[i] = coords[i] + j % 3 - 1;
+            k += (1 != j % 3);
+            inside &= (0 <= neighbor[i] && neighbor[i] < stencil.dims[i]);
+        }
+
+        if (0 == k || !inside || (STENCIL_GRAPH == options.stencil && 1 < k)) {
+            continue;
+        }
+
+        MPI_CHECK(MPI_Cart_rank(cart, neighbor,
+                    &stencil.neighbors[stencil.num_neighbors]));
+        weights[stencil.num_neighbors] = 1;
+        stencil.boundary[stencil.num_neighbors++] = k;
+    }
+
+    /*
+     * Unit weights rather than MPI_UNWEIGHTED, which some compilers flag as
+     * an out of bounds read when the sentinel is a small constant pointer
+     */
+    MPI_CHECK(MPI_Dist_graph_create_adjacent(MPI_COMM_WORLD,
+                stencil.num_neighbors, stencil.neighbors, weights,
+                stencil.num_neighbors, stencil.neighbors, weights,
+                MPI_INFO_NULL, 0, &stencil.comm));
+    MPI_CHECK(MPI_Comm_free(&cart));
+    count_neighbors();
+
+    return stencil.comm;
+}
+
+int stencil_neighbors (void)
+{
+    return stencil.num_neighbors;
+}
+
+/*
+ * Byte counts and displacements of the halo of a subdomain whose faces are
+ * SIZE bytes.  A neighbor that differs in k coordinates shares a boundary of
+ * ndims - k dimensions, so in 3-D the edges get SIZE^(1/2) and the corners
+ * one byte, as for a cube.  Returns the total.
+ */
+size_t stencil_layout (size_t size, int * counts, int * displs)
+{
+    int ndims = options.stencil_dims, j;
+    size_t total = 0;
+    double bytes;
+
+    for (j = 0; j < stencil.num_neighbors; j++) {
+        bytes = (1 == ndims) ? (double)size :
+            pow((double)size, (ndims - stencil.boundary[j]) / (ndims - 1.0));
+
+        counts[j] = MAX(1, (int)(bytes + 0.5));
+        displs[j] = total;
+        total += counts[j];
+    }
+
+    return total;
+}
+
+/* The same exchange as MPI_Neighbor_alltoallv with MPI_Isend/MPI_Irecv */
+void p2p_halo_exchange (void const * sendbuf, void * recvbuf,
+        int const * counts, int const * displs)
+{
+    MPI_Request requests[2 * MAX_STENCIL_NEIGHBORS];
+    int j, n = stencil.num_neighbors;
+
+    for (j = 0; j < n; j++) {
+        MPI_CHECK(MPI_Irecv((char *)recvbuf + displs[j], counts[j], MPI_CHAR,
+                    stencil.neighbors[j], 1, stencil.comm, &requests[j]));
+    }
+    for (j = 0; j < n; j++) {
+        MPI_CHECK(MPI_Isend((char const *)sendbuf + displs[j], counts[j],
+                    MPI_CHAR, stencil.neighbors[j], 1, stencil.comm,
+                    &requests[n + j]));
+    }
+
+    MPI_CHECK(MPI_Waitall(2 * n, requests, MPI_STATUSES_IGNORE));
+}
+
+void cleanup_stencil (void)
+{
+    if (MPI_COMM_NULL != stencil.comm) {
+        MPI_CHECK(MPI_Comm_free(&stencil.comm));
+    }
+}
+
+void print_stencil_summary (void)
+{
+    static char const * const shapes[] = {
+        NULL, "face neighbors, Cartesian", "face neighbors, distributed graph",
+        "all neighbors, distributed graph"
+    };
+    int i;
+
+    fprintf(stdout, "# Stencil: %d-D %s, %d", options.stencil_dims,
+            shapes[options.stencil], stencil.dims[0]);
+    for (i = 1; i < options.stencil_dims; i++) {
+        fprintf(stdout, "x%d", stencil.dims[i]);
+    }
+    fprintf(stdout, " ranks, up to %d neighbors\n", stencil.max_neighbors);
+
+    if (STENCIL_FULL == options.stencil && 1 < options.stencil_dims) {
+        fprintf(stdout, "# Size is that of a face, edges and corners get "
+                "their share of it\n");
+    }
+}
+
+#ifdef _ENABLE_NCCL_
+#ifdef _ENABLE_ROCM_
+static hipStream_t nccl_stream;
+static hipEvent_t nccl_start, nccl_stop;
+#else
+static cudaStream_t nccl_stream;
+static cudaEvent_t nccl_start, nccl_stop;
+#endif
+
+static ncclComm_t nccl_comm;
+static int nccl_size;
+
+static ncclDataType_t nccl_datatype (MPI_Datatype datatype)
+{
+    if (MPI_FLOAT == datatype) {
+        return ncclFloat;
+    } else if (MPI_DOUBLE == datatype) {
+        return ncclDouble;
+    } else if (MPI_INT == datatype) {
+        return ncclInt32;
+    } else if (MPI_INT64_T == datatype) {
+        return ncclInt64;
+    }
+
+    return ncclChar;
+}
+
+static ncclRedOp_t nccl_op (MPI_Op op)
+{
+    if (MPI_PROD == op) {
+        return ncclProd;
+    } else if (MPI_MAX == op) {
+        return ncclMax;
+    } else if (MPI_MIN == op) {
+        return ncclMin;
+    }
+
+    return ncclSum;
+}
+#endif
+
+/*
+ * The NCCL communicator spans MPI_COMM_WORLD, with the unique id broadcast
+ * over MPI.  Collectives are issued on a stream of their own and timed with
+ * events around the call, so the time is what the device spent rather than
+ * what MPI_Wtime sees of an asynchronous launch.
+ */
+int init_nccl (void)
+{
+#ifdef _ENABLE_NCCL_
+    ncclUniqueId id;
+    int rank;
+
+    MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &nccl_size));
+
+    if (0 == rank) {
+        NCCL_CHECK(ncclGetUniqueId(&id));
+    }
+    MPI_CHECK(MPI_Bcast(&id, sizeof(id), MPI_BYTE, 0, MPI_COMM_WORLD));
+
+#ifdef _ENABLE_ROCM_
+    ROCM_CHECK(hipStreamCreateWithFlags(&nccl_stream, hipStreamNonBlocking));
+    ROCM_CHECK(hipEventCreate(&nccl_start));
+    ROCM_CHECK(hipEventCreate(&nccl_stop));
+#else
+    CUDA_CHECK(cudaStreamCreateWithFlags(&nccl_stream, cudaStreamNonBlocking));
+    CUDA_CHECK(cudaEventCreate(&nccl_start));
+    CUDA_CHECK(cudaEventCreate(&nccl_stop));
+#endif
+
+    NCCL_CHECK(ncclCommInitRank(&nccl_comm, nccl_size, id, rank));
+
+    return 0;
+#else
+    return 1;
+#endif
+}
+
+void cleanup_nccl (void)
+{
+#ifdef _ENABLE_NCCL_
+    NCCL_CHECK(ncclCommDestroy(nccl_comm));
+#ifdef _ENABLE_ROCM_
+    ROCM_CHECK(hipEventDestroy(nccl_start));
+    ROCM_CHECK(hipEventDestroy(nccl_stop));
+    ROCM_CHECK(hipStreamDestroy(nccl_stream));
+#else
+    CUDA_CHECK(cudaEventDestroy(nccl_start));
+    CUDA_CHECK(cudaEventDestroy(nccl_stop));
+    CUDA_CHECK(cudaStreamDestroy(nccl_stream));
+#endif
+#endif
+}
+
+/*
+ * Run one collective with NCCL and return its device time in seconds.  COUNT
+ * is in elements of DATATYPE and, for allgather and alltoall, per rank as in
+ * the MPI calls.  NCCL has no alltoall, it is composed of grouped send and
+ * receive pairs.
+ */
+double nccl_collective (enum nccl_coll coll, void const * sendbuf,
+        void * recvbuf, size_t count, MPI_Datatype datatype, MPI_Op op,
+        int root)
+{
+#ifdef _ENABLE_NCCL_
+    ncclDataType_t type = nccl_datatype(datatype);
+    float ms = 0.0f;
+    int extent, peer;
+
+    MPI_CHECK(MPI_Type_size(datatype, &extent));
+
+#ifdef _ENABLE_ROCM_
+    ROCM_CHECK(hipEventRecord(nccl_start, nccl_stream));
+#else
+    CUDA_CHECK(cudaEventRecord(nccl_start, nccl_stream));
+#endif
+
+    switch (coll) {
+        case NCCL_ALLREDUCE:
+            NCCL_CHECK(ncclAllReduce(sendbuf, recvbuf, count, type,
+                        nccl_op(op), nccl_comm, nccl_stream));
+            break;
+        case NCCL_REDUCE:
+            NCCL_CHECK(ncclReduce(sendbuf, recvbuf, count, type, nccl_op(op),
+                        root, nccl_comm, nccl_stream));
+            break;
+        case NCCL_BCAST:
+            NCCL_CHECK(ncclBroadcast(recvbuf, recvbuf, count, type, root,
+                        nccl_comm, nccl_stream));
+            break;
+        case NCCL_ALLGATHER:
+            NCCL_CHECK(ncclAllGather(sendbuf, recvbuf, count, type, nccl_comm,
+                        nccl_stream));
+            break;
+        case NCCL_ALLTOALL:
+            NCCL_CHECK(ncclGroupStart());
+            for (peer = 0; peer < nccl_size; peer++) {
+                NCCL_CHECK(ncclSend((char const *)sendbuf +
+                            peer * count * extent, count, type, peer,
+                            nccl_comm, nccl_stream));
+                NCCL_CHECK(ncclRecv((char *)recvbuf + peer * count * extent,
+                            count, type, peer, nccl_comm, nccl_stream));
+            }
+            NCCL_CHECK(ncclGroupEnd());
+            break;
+    }
+
+#ifdef _ENABLE_ROCM_
+    ROCM_CHECK(hipEventRecord(nccl_stop, nccl_stream));
+    ROCM_CHECK(hipEventSynchronize(nccl_stop));
+    ROCM_CHECK(hipEventElapsedTime(&ms, nccl_start, nccl_stop));
+#else
+    CUDA_CHECK(cudaEventRecord(nccl_stop, nccl_stream));
+    CUDA_CHECK(cudaEventSynchronize(nccl_stop));
+    CUDA_CHECK(cudaEventElapsedTime(&ms, nccl_start, nccl_stop));
+#endif
+
+    return ms / 1e3;
+#else
+    fprintf(stderr, "NCCL support not enabled\n");
+    MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+
+    return 0.0;
+#endif
+}
+
+int continue_iterations (int i)
+{
+    static double start_time;
+    static uint64_t next_check;
+    double local[2], global[2];
+
+    if (0.0 >= options.converge.target) {
+        return i < options.iterations + options.skip;
+    }
+
+    if (0 == i) {
+        stats_reset(&latency_stats);
+        start_time = osu_wtime();
+        next_check = CONVERGE_MIN_ITERATIONS;
+        convergence_error = HUGE_VAL;
+    }
+
+    if (i < options.skip || latency_stats.count < next_check) {
+        return 1;
+    }
+
+    /*
+     * Every rank has to be converged, and the budget is judged by the slowest
+     * rank, so one reduction gives all ranks the same decision.  Checks are
+     * spaced geometrically to keep their cost a small fraction of the run.
+     */
+    local[0] = stats_relative_error(&latency_stats);
+    local[1] = osu_wtime() - start_time;
+    MPI_CHECK(MPI_Allreduce(local, global, 2, MPI_DOUBLE, MPI_MAX,
+                MPI_COMM_WORLD));
+    convergence_error = global[0];
+
+    if (global[0] <= options.converge.target
+            || global[1] >= options.converge.budget) {
+        options.iterations = latency_stats.count;
+        return 0;
+    }
+
+    next_check += next_check / 4;
+
+    return 1;
+}
+
+void print_stats (int rank, int size, double avg_time, double min_time, double max_time)
+{
+    struct result_metric_t samples[2];
+    int numprocs;
+
+    /*
+     * The histogram merge is collective, so it has to happen before the
+     * non-root ranks bail out.
+     */
+    if (options.show_percentiles) {
+        hist_reduce(rank, &latency_hist);
+    }
+
+    if (options.outlier_top) {
+        reduce_rank_outliers(rank);
+    }
+
+    if (rank) {
+        hist_reset(&latency_hist);
+        stats_reset(&latency_stats);
+        return;
+    }
+
+    record_message_size(size, avg_time);
+    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numprocs));
+    record_model_point(FIT_ALPHA_BETA, numprocs, size, avg_time);
+
+    /* The spread of the iterations of rank 0 backs the baseline t-test */
+    samples[0] = (struct result_metric_t){"samples", latency_stats.count};
+    samples[1] = (struct result_metric_t){"stddev_us", 1 < latency_stats.count ?
+        1e6 * sqrt(latency_stats.m2 / (latency_stats.count - 1)) : 0.0};
+    stats_reset(&latency_stats);
+
+    if (OUTPUT_TABLE != options.output_format) {
+        int nmetrics = 1;
+        struct result_metric_t metrics[19 + MAX_EXTRA_COLUMNS] = {
+            {"avg_latency_us", avg_time}};
+
+        if (options.show_full) {
+            metrics[nmetrics++] = (struct result_metric_t){"min_latency_us", min_time};
+            metrics[nmetrics++] = (struct result_metric_t){"max_latency_us", max_time};
+            metrics[nmetrics++] = (struct result_metric_t){"iterations", options.iterations};
+        }
+
+        if (options.show_percentiles) {
+            metrics[nmetrics++] = (struct result_metric_t){"p50_us",
+                hist_percentile(&latency_hist, 50.0)};
+            metrics[nmetrics++] = (struct result_metric_t){"p90_us",
+                hist_percentile(&latency_hist, 90.0)};
+            metrics[nmetrics++] = (struct result_metric_t){"p99_us",
+                hist_percentile(&latency_hist, 99.0)};
+            metrics[nmetrics++] = (struct result_metric_t){"p99_9_us",
+                hist_percentile(&latency_hist, 99.9)};
+            metrics[nmetrics++] = (struct result_metric_t){"max_iter_us",
+                latency_hist.max};
+            hist_reset(&latency_hist);
+        }
+
+        if (options.converge.target > 0.0) {
+            if (!options.show_full) {
+                metrics[nmetrics++] = (struct result_metric_t){"iterations",
+                    options.iterations};
+            }
+            metrics[nmetrics++] = (struct result_metric_t){"ci_percent",
+                convergence_error};
+        }
+
+        if (HIER_ON == options.hierarchical) {
+            metrics[nmetrics++] = (struct result_metric_t){"hier_avg_latency_us",
+                hierarchical_latency};
+            metrics[nmetrics++] = (struct result_metric_t){"hier_speedup",
+                avg_time / hierarchical_latency};
+        }
+
+        if (PIPELINE_ON == options.pipeline) {
+            metrics[nmetrics++] = (struct result_metric_t){"pipe_avg_latency_us",
+                pipelined_latency};
+            metrics[nmetrics++] = (struct result_metric_t){"pipe_speedup",
+                avg_time / pipelined_latency};
+        }
+
+        if (STENCIL_NONE != options.stencil) {
+            metrics[nmetrics++] = (struct result_metric_t){"p2p_avg_latency_us",
+                p2p_halo_latency};
+            metrics[nmetrics++] = (struct result_metric_t){"p2p_speedup",
+                avg_time / p2p_halo_latency};
+        }
+
+        if (samples[0].value) {
+            metrics[nmetrics++] = samples[0];
+            metrics[nmetrics++] = samples[1];
+        }
+
+        nmetrics = add_extra_metrics(metrics, nmetrics);
+        output_result(numprocs, size, nmetrics, metrics);
+
+        /* Host names have no place in the records */
+        if (options.outlier_top) {
+            print_rank_outliers(stderr, size);
+        }
+        return;
+    }
+
+    if (options.baseline || options.checkpoint) {
+        struct result_metric_t metrics[3] = {{"avg_latency_us", avg_time},
+            samples[0], samples[1]};
+
+        compare_baseline(numprocs, size, 3, metrics);
+        checkpoint_result(numprocs, size, samples[0].value ? 3 : 1, metrics);
+    }
+
+    if (options.show_size) {
+        fprintf(stdout, "%-*d", 10, size);
+        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, avg_time);
+    } else {
+        fprintf(stdout, "%*.*f", 17, FLOAT_PRECISION, avg_time);
+    }
+
+    if (options.show_full) {
+        fprintf(stdout, "%*.*f%*.*f%*lu",
+                FIELD_WIDTH, FLOAT_PRECISION, min_time,
+                FIELD_WIDTH, FLOAT_PRECISION, max_time,
+                12, options.iterations);
+    }
+
+    if (options.show_percentiles) {
+        fprintf(stdout, "%*.*f%*.*f%*.*f%*.*f%*.*f",
+                FIELD_WIDTH, FLOAT_PRECISION, hist_percentile(&latency_hist, 50.0),
+                FIELD_WIDTH, FLOAT_PRECISION, hist_percentile(&latency_hist, 90.0),
+                FIELD_WIDTH, FLOAT_PRECISION, hist_percentile(&latency_hist, 99.0),
+                FIELD_WIDTH, FLOAT_PRECISION, hist_percentile(&latency_hist, 99.9),
+                FIELD_WIDTH, FLOAT_PRECISION, latency_hist.max);
+        hist_reset(&latency_hist);
+    }
+
+    if (options.converge.target > 0.0) {
+        if (!options.show_full) {
+            fprintf(stdout, "%*lu", 12, options.iterations);
+        }
+        fprintf(stdout, "%*.*f", 12, 2, convergence_error);
+    }
+
+    if (HIER_ON == options.hierarchical) {
+        fprintf(stdout, "%*.*f%*.*f",
+                FIELD_WIDTH, FLOAT_PRECISION, hierarchical_latency,
+                12, 2, avg_time / hierarchical_latency);
+    }
+
+    if (PIPELINE_ON == options.pipeline) {
+        fprintf(stdout, "%*.*f%*s",
+                FIELD_WIDTH, FLOAT_PRECISION, pipelined_latency,
+                12, (pipelined_latency < avg_time) ? "pipeline" : "native");
+    }
+
+    if (STENCIL_NONE != options.stencil) {
+        fprintf(stdout, "%*.*f%*.*f",
+                FIELD_WIDTH, FLOAT_PRECISION, p2p_halo_latency,
+                12, 2, avg_time / p2p_halo_latency);
+    }
+
+    print_extra_values();
+    fprintf(stdout, "\n");
+    fflush(stdout);
+
+    if (options.outlier_top) {
+        print_rank_outliers(stdout, size);
+    }
+}
+
+void set_buffer_pt2pt (void * buffer, int rank, enum accel_type type, int data, size_t size)
+{
+    struct device_backend const * device = device_backend(type);
+    char buf_type = 'H';
+
+    if (options.bench == MBW_MR) {
+        buf_type = (rank < options.pairs) ? options.src : options.dst;
+    } else {
+        buf_type = (rank == 0) ? options.src : options.dst;
+    }
+
+    switch (buf_type) {
+        case 'H':
+            fill_host_buffer(buffer, data, size);
+            break;
+        case 'D':
+        case 'M':
+            if (NULL != device) {
+                device->memset(buffer, data, size);
+            }
+            break;
+    }
+}
+
+void set_buffer (void * buffer, enum accel_type type, int data, size_t size)
+{
+    struct device_backend const * device = device_backend(type);
+
+    if (NONE == type) {
+        fill_host_buffer(buffer, data, size);
+    } else if (NULL != device) {
+        device->memset(buffer, data, size);
+    }
+}
+
+/*
+ * Number of bytes in the SIZE bytes at P that are not DATA.  The common case
+ * of an intact buffer is decided by a single OR over 64-bit words, a loop the
+ * compiler turns into vector code; only a corrupted buffer is counted byte by
+ * byte.
+ */
+static size_t check_host_memory (unsigned char const * p, int data, size_t size)
+{
+    uint64_t pattern = 0x0101010101010101ULL * (unsigned char)data;
+    uint64_t diff = 0, word;
+    size_t words = size / sizeof(word);
+    size_t errors = 0, i;
+
+    for (i = 0; i < words; i++) {
+        memcpy(&word, p + i * sizeof(word), sizeof(word));
+        diff |= word ^ pattern;
+    }
+    for (i = words * sizeof(word); i < size; i++) {
+        diff |= p[i] ^ (unsigned char)data;
+    }
+
+    if (0 == diff) {
+        return 0;
+    }
+
+    for (i = 0; i < size; i++) {
+        errors += p[i] != (unsigned char)data;
+    }
+
+    return errors;
+}
+
+#ifdef _ENABLE_ACCEL_
+/*
+ * Device buffers are checked in place by the check kernel, which only sends
+ * back a counter.  Builds without the kernels, and the accelerators they do
+ * not run on, stage the buffer through the host instead.
+ */
+static size_t check_device_memory (void const * buffer, enum accel_type type,
+        int data, size_t size)
+{
+    struct device_backend const * device = device_backend(type);
+    size_t errors;
+    void * host;
+
+#ifdef _ENABLE_GPU_KERNEL_
+    if (device_kernels(type)) {
+        static unsigned long long * d_errors = NULL;
+        unsigned long long count = 0;
+
+        if (NULL == d_errors) {
+            device->alloc((void **)&d_errors, sizeof(*d_errors), 0);
+        }
+        device->memset(d_errors, 0, sizeof(*d_errors));
+        call_check_kernel(buffer, data, size, d_errors);
+        device->memcpy(&count, d_errors, sizeof(count), COPY_TO_HOST);
+
+        return count;
+    }
+#endif
+
+    if (NULL == device) {
+        return 0;
+    }
+
+    host = malloc(size ? size : 1);
+    if (NULL == host) {
+        fprintf(stderr, "Error allocating validation buffer\n");
+        return size;
+    }
+
+    device->memcpy(host, buffer, size, COPY_TO_HOST);
+    errors = check_host_memory(host, data, size);
+    free(host);
+
+    return errors;
+}
+#endif
+
+/*
+ * Counterpart of set_buffer_pt2pt(): the number of bytes of BUFFER, on the
+ * side of RANK, that do not hold DATA.
+ */
+size_t check_buffer_pt2pt (void * buffer, int rank, enum accel_type type, int data, size_t size)
+{
+    char buf_type = (rank == 0) ? options.src : options.dst;
+
+    if ('H' == buf_type || NONE == type) {
+        return check_host_memory(buffer, data, size);
+    }
+
+#ifdef _ENABLE_OPENACC_
+    if (OPENACC == type) {
+        size_t i, errors = 0;
+        unsigned char * p = (unsigned char *)buffer;
+        #pragma acc parallel loop deviceptr(p) reduction(+:errors)
+        for (i = 0; i < size; i++) {
+            errors += p[i] != (unsigned char)data;
+        }
+
+        return errors;
+    }
+#endif
+#ifdef _ENABLE_ACCEL_
+    return check_device_memory(buffer, type, data, size);
+#else
+    return 0;
+#endif
+}
+
+/*
+ * Untimed exchange that follows the timed loop of a size: both ranks send
+ * S_BUF, refilled with 'a', into R_BUF reset to 'b' and check what arrived.
+ * The rotated slots of -c are not checked, only the transfer path is.
+ * Returns the corrupted bytes of both ranks on every rank.
+ */
+size_t validate_pt2pt (void * s_buf, void * r_buf, size_t size, int rank)
+{
+    unsigned long errors;
+    MPI_Request req;
+    int peer = 1 - rank;
+
+    set_buffer_pt2pt(s_buf, rank, options.accel, 'a', size);
+    set_buffer_pt2pt(r_buf, rank, options.accel, 'b', size);
+
+    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+    MPI_CHECK(MPI_Irecv(r_buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD, &req));
+    MPI_CHECK(MPI_Send(s_buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD));
+    MPI_CHECK(MPI_Wait(&req, MPI_STATUS_IGNORE));
+
+    errors = check_buffer_pt2pt(r_buf, rank, options.accel, 'a', size);
+
+    MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &errors, 1, MPI_UNSIGNED_LONG,
+                MPI_SUM, MPI_COMM_WORLD));
+
+    return errors;
+}
+
+/*
+ * Host buffer allocators
+ *
+ * Buffers that do not come from posix_memalign are remembered together with
+ * their allocator so that free_host_buffer() can hand them back the right
+ * way.  The multi-threaded tests allocate from several threads at once.
+ */
+#define THP_ALIGNMENT       (2UL * 1024 * 1024)
+
+#ifndef MAP_HUGE_SHIFT
+#   define MAP_HUGE_SHIFT   26
+#endif
+
+struct host_alloc_t {
+    void * buffer;
+    size_t size;
+    enum host_allocator allocator;
+};
+
+static struct host_alloc_t * host_allocs = NULL;
+static int host_allocs_size = 0;
+static pthread_mutex_t host_allocs_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int remember_host_buffer (void * buffer, size_t size)
+{
+    struct host_alloc_t * grown;
+    int i, ret = 0;
+
+    pthread_mutex_lock(&host_allocs_mutex);
+    for (i = 0; i < host_allocs_size; i++) {
+        if (NULL == host_allocs[i].buffer) {
+            break;
+        }
+    }
+
+    /* fresh buffers may keep a whole window of allocations alive */
+    if (i == host_allocs_size) {
+        grown = realloc(host_allocs, sizeof(*host_allocs) *
+                (host_allocs_size ? 2 * host_allocs_size : 64));
+        if (NULL == grown) {
+            ret = 1;
+        } else {
+            host_allocs = grown;
+            host_allocs_size = host_allocs_size ? 2 * host_allocs_size : 64;
+            memset(host_allocs + i, 0, sizeof(*host_allocs) *
+                    (host_allocs_size - i));
+        }
+    }
+
+    if (0 == ret) {
+        host_allocs[i].buffer = buffer;
+        host_allocs[i].size = size;
+        host_allocs[i].allocator = options.allocator;
+    }
+    pthread_mutex_unlock(&host_allocs_mutex);
+
+    return ret;
+}
+
+static void * map_huge_pages (size_t size, int shift)
+{
+#ifdef MAP_HUGETLB
+    void * buffer = mmap(NULL, size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (shift << MAP_HUGE_SHIFT),
+            -1, 0);
+
+    return (MAP_FAILED == buffer) ? NULL : buffer;
+#else
+    return NULL;
+#endif
+}
+
+int allocate_host_buffer (void ** buffer, size_t size)
+{
+    size_t page;
+
+    switch (options.allocator) {
+        case ALLOC_THP:
+            if (posix_memalign(buffer, THP_ALIGNMENT, size)) {
+                return 1;
+            }
+#ifdef MADV_HUGEPAGE
+            madvise(*buffer, size, MADV_HUGEPAGE);
+#endif
+            return 0;
+        case ALLOC_HUGETLB_2M:
+        case ALLOC_HUGETLB_1G:
+            page = (ALLOC_HUGETLB_1G == options.allocator) ? 1UL << 30
+                                                           : 1UL << 21;
+            size = (size + page - 1) / page * page;
+            size = (size) ? size : page;
+            *buffer = map_huge_pages(size,
+                    (ALLOC_HUGETLB_1G == options.allocator) ? 30 : 21);
+            if (NULL == *buffer) {
+                fprintf(stderr, "Could not map %zu bytes of %s pages, check "
+                        "/proc/sys/vm/nr_hugepages\n", size,
+                        host_allocator_name());
+                return 1;
+            }
+            break;
+        case ALLOC_MPI:
+            MPI_CHECK(MPI_Alloc_mem(size ? size : 1, MPI_INFO_NULL, buffer));
+            break;
+        default:
+            return posix_memalign(buffer, sysconf(_SC_PAGESIZE), size);
+    }
+
+    if (remember_host_buffer(*buffer, size)) {
+        fprintf(stderr, "Error allocating host buffer table\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+void free_host_buffer (void * buffer)
+{
+    enum host_allocator allocator = ALLOC_DEFAULT;
+    size_t size = 0;
+    int i;
+
+    if (NULL == buffer) {
+        return;
+    }
+
+    pthread_mutex_lock(&host_allocs_mutex);
+    for (i = 0; i < host_allocs_size; i++) {
+        if (host_allocs[i].buffer == buffer) {
+            allocator = host_allocs[i].allocator;
+            size = host_allocs[i].size;
+            host_allocs[i].buffer = NULL;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&host_allocs_mutex);
+
+    switch (allocator) {
+        case ALLOC_HUGETLB_2M:
+        case ALLOC_HUGETLB_1G:
+            munmap(buffer, size);
+            break;
+        case ALLOC_MPI:
+            MPI_CHECK(MPI_Free_mem(buffer));
+            break;
+        default:
+            free(buffer);
+            break;
+    }
+}
+
+/*
+ * Buffer pool
+ *
+ * When enabled (osu_suite runs many benchmarks in one process) the buffers
+ * of allocate_memory_coll(), allocate_memory_pt2pt() and
+ * allocate_memory_one_sided() are recorded here, and releasing them parks
+ * them instead of freeing them.  A later request, from the same benchmark,
+ * the next one or another thread, is handed the smallest parked buffer that
+ * is large enough and comes from the same allocator, so device memory, huge
+ * pages and the registrations the MPI library keeps for them survive from
+ * one benchmark to the next.  Host buffers are keyed by the allocator of
+ * --allocator and its alignment, device buffers by their accelerator type.
+ * Device buffers stay valid because cleanup_accel() keeps the device while
+ * the pool is enabled.
+ */
+#define BUFFER_POOL_SIZE 128
+
+static struct {
+    void * buffer;
+    size_t size;
+    size_t alignment;
+    enum accel_type type;
+    enum host_allocator allocator;
+    int in_use;
+} buffer_pool[BUFFER_POOL_SIZE];
+
+static struct {
+    size_t held;
+    size_t peak;
+    unsigned long allocations;
+    unsigned long reuses;
+} pool_stats;
+
+static int buffer_pool_enabled = 0;
+static pthread_mutex_t buffer_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void release_buffer (void * buffer, enum accel_type type);
+
+/* Alignment of what allocate_host_buffer() returns, 0 for device memory */
+static size_t buffer_alignment (enum accel_type type)
+{
+    if (NONE != type) {
+        return 0;
+    }
+
+    switch (options.allocator) {
+        case ALLOC_THP:
+            return THP_ALIGNMENT;
+        case ALLOC_HUGETLB_2M:
+            return 1UL << 21;
+        case ALLOC_HUGETLB_1G:
+            return 1UL << 30;
+        default:
+            return sysconf(_SC_PAGESIZE);
+    }
+}
+
+void set_buffer_pool (int enable)
+{
+    int i;
+
+    pthread_mutex_lock(&buffer_pool_mutex);
+    buffer_pool_enabled = enable;
+
+    if (enable) {
+        pthread_mutex_unlock(&buffer_pool_mutex);
+        return;
+    }
+
+    for (i = 0; i < BUFFER_POOL_SIZE; i++) {
+        if (buffer_pool[i].buffer && !buffer_pool[i].in_use) {
+            release_buffer(buffer_pool[i].buffer, buffer_pool[i].type);
+        }
+        buffer_pool[i].buffer = NULL;
+    }
+    memset(&pool_stats, 0, sizeof(pool_stats));
+    pthread_mutex_unlock(&buffer_pool_mutex);
+}
+
+static int buffer_pool_get (void ** buffer, size_t size, enum accel_type type)
+{
+    size_t alignment = buffer_alignment(type);
+    int i, best = -1;
+
+    if (!buffer_pool_enabled) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&buffer_pool_mutex);
+    for (i = 0; i < BUFFER_POOL_SIZE; i++) {
+        if (buffer_pool[i].buffer && !buffer_pool[i].in_use &&
+                buffer_pool[i].type == type &&
+                buffer_pool[i].alignment == alignment &&
+                (NONE != type ||
+                 buffer_pool[i].allocator == options.allocator) &&
+                buffer_pool[i].size >= size &&
+                (best < 0 || buffer_pool[i].size < buffer_pool[best].size)) {
+            best = i;
+        }
+    }
+
+    if (best >= 0) {
+        buffer_pool[best].in_use = 1;
+        *buffer = buffer_pool[best].buffer;
+        pool_stats.reuses++;
+    }
+    pthread_mutex_unlock(&buffer_pool_mutex);
+
+    return best >= 0;
+}
+
+static void buffer_pool_add (void * buffer, size_t size, enum accel_type type)
+{
+    int i;
+
+    if (!buffer_pool_enabled) {
+        return;
+    }
+
+    pthread_mutex_lock(&buffer_pool_mutex);
+    for (i = 0; i < BUFFER_POOL_SIZE; i++) {
+        if (NULL == buffer_pool[i].buffer) {
+            buffer_pool[i].buffer = buffer;
+            buffer_pool[i].size = size;
+            buffer_pool[i].alignment = buffer_alignment(type);
+            buffer_pool[i].type = type;
+            buffer_pool[i].allocator = options.allocator;
+            buffer_pool[i].in_use = 1;
+            pool_stats.held += size;
+            pool_stats.peak = MAX(pool_stats.peak, pool_stats.held);
+            pool_stats.allocations++;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&buffer_pool_mutex);
+}
+
+static int buffer_pool_put (void * buffer)
+{
+    int i, found = 0;
+
+    if (!buffer_pool_enabled) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&buffer_pool_mutex);
+    for (i = 0; i < BUFFER_POOL_SIZE; i++) {
+        if (buffer_pool[i].buffer == buffer && buffer_pool[i].in_use) {
+            buffer_pool[i].in_use = 0;
+            found = 1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&buffer_pool_mutex);
+
+    return found;
+}
+
+/*
+ * Footprint of the pool, the largest over the processes of MPI_COMM_WORLD.
+ * Collective, rank 0 prints on stderr next to the status of osu_suite.
+ */
+void print_buffer_pool_summary (int rank)
+{
+    double local[5], global[5];
+    int i, buffers = 0;
+
+    pthread_mutex_lock(&buffer_pool_mutex);
+    for (i = 0; i < BUFFER_POOL_SIZE; i++) {
+        buffers += NULL != buffer_pool[i].buffer;
+    }
+    local[0] = buffers;
+    local[1] = pool_stats.held;
+    local[2] = pool_stats.peak;
+    local[3] = pool_stats.allocations;
+    local[4] = pool_stats.reuses;
+    pthread_mutex_unlock(&buffer_pool_mutex);
+
+    MPI_CHECK(MPI_Reduce(local, global, 5, MPI_DOUBLE, MPI_MAX, 0,
+                MPI_COMM_WORLD));
+
+    if (0 == rank) {
+        fprintf(stderr, "# Buffer pool: %.0f buffers, %.2f MB held, %.2f MB "
+                "peak, %.0f allocations, %.0f reuses (per process maximum)\n",
+                global[0], global[1] / 1e6, global[2] / 1e6, global[3],
+                global[4]);
+    }
+}
+
+static int allocate_buffer (void ** buffer, size_t size, enum accel_type type)
+{
+    struct device_backend const * device = device_backend(type);
+
+    if (NONE == type) {
+        return allocate_host_buffer(buffer, size);
+    }
+
+    return NULL == device ? 1 : device->alloc(buffer, size, MANAGED == type);
+}
+
+int allocate_memory_coll (void ** buffer, size_t size, enum accel_type type)
+{
+    int ret;
+
+    if (options.target == CPU || options.target == BOTH) {
+        allocate_host_arrays();
+    }
+
+    if (buffer_pool_get(buffer, size, type)) {
+        return 0;
+    }
+
+    ret = allocate_buffer(buffer, size, type);
+    if (0 == ret) {
+        buffer_pool_add(*buffer, size, type);
+    }
+
+    return ret;
+}
+
+/*
+ * Rotating buffers
+ *
+ * In CACHE_COLD mode allocate_rotating_buffer() backs a buffer with an extra
+ * options.cache_pool_size bytes and rotate_buffer() returns a different page
+ * aligned slot of it every iteration, so successive iterations do not find
+ * their data in the caches.  In CACHE_FRESH mode rotate_buffer() returns a
+ * newly allocated buffer every iteration, releasing the one that was handed
+ * out RING iterations earlier; RING must cover the operations in flight.  In
+ * CACHE_HOT mode both are pass-throughs.
+ */
+#define ROTATION_TABLE_SIZE 8
+
+static struct {
+    void * buffer;
+    size_t size;
+    enum accel_type type;
+    int ring;
+    void ** fresh;
+} rotation_table[ROTATION_TABLE_SIZE];
+
+static int register_rotation (void * buffer, size_t size, enum accel_type type,
+        int ring)
+{
+    int i;
+
+    for (i = 0; i < ROTATION_TABLE_SIZE; i++) {
+        if (NULL == rotation_table[i].buffer) {
+            rotation_table[i].buffer = buffer;
+            rotation_table[i].size = size;
+            rotation_table[i].type = type;
+            rotation_table[i].ring = ring;
+            rotation_table[i].fresh = NULL;
+
+            if (CACHE_FRESH == options.cache_mode) {
+                rotation_table[i].fresh = calloc(ring, sizeof(void *));
+                if (NULL == rotation_table[i].fresh) {
+                    rotation_table[i].buffer = NULL;
+                    return 1;
+                }
+            }
+            break;
+        }
+    }
+
+    return 0;
+}
+
+static void unregister_rotation (void * buffer)
+{
+    int i, j;
+
+    for (i = 0; i < ROTATION_TABLE_SIZE; i++) {
+        if (buffer && rotation_table[i].buffer == buffer) {
+            if (rotation_table[i].fresh) {
+                for (j = 0; j < rotation_table[i].ring; j++) {
+                    if (rotation_table[i].fresh[j]) {
+                        release_buffer(rotation_table[i].fresh[j],
+                                rotation_table[i].type);
+                    }
+                }
+                free(rotation_table[i].fresh);
+            }
+            rotation_table[i].buffer = NULL;
+        }
+    }
+}
+
+int allocate_rotating_buffer (void ** buffer, size_t size, enum accel_type type)
+{
+    size_t pool_size;
+
+    if (CACHE_HOT == options.cache_mode) {
+        return allocate_memory_coll(buffer, size, type);
+    }
+
+    pool_size = (CACHE_COLD == options.cache_mode)
+        ? size + options.cache_pool_size : size;
+
+    if (allocate_memory_coll(buffer, pool_size, type)) {
+        return 1;
+    }
+
+    /* Touch the whole pool so that no slot is backed by the zero page */
+    if (NONE == type) {
+        touch_host_buffer(*buffer, pool_size);
+    } else {
+        set_buffer(*buffer, type, 0, pool_size);
+    }
+
+    /* collectives complete every operation before starting the next one */
+    return register_rotation(*buffer, pool_size, type, 1);
+}
+
+void * rotate_buffer (void * buffer, size_t size, int iteration)
+{
+    int i, slot;
+    size_t page_size, stride, slots;
+
+    if (CACHE_HOT == options.cache_mode || NULL == buffer) {
+        return buffer;
+    }
+
+    for (i = 0; i < ROTATION_TABLE_SIZE; i++) {
+        if (rotation_table[i].buffer == buffer) {
+            break;
+        }
+    }
+
+    if (ROTATION_TABLE_SIZE == i || rotation_table[i].size < size) {
+        return buffer;
+    }
+
+    if (CACHE_FRESH == options.cache_mode) {
+        slot = iteration % rotation_table[i].ring;
+
+        if (rotation_table[i].fresh[slot]) {
+            release_buffer(rotation_table[i].fresh[slot],
+                    rotation_table[i].type);
+            rotation_table[i].fresh[slot] = NULL;
+        }
+
+        if (allocate_buffer(&rotation_table[i].fresh[slot], size ? size : 1,
+                    rotation_table[i].type)) {
+            fprintf(stderr, "Could not allocate a fresh buffer\n");
+            MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+        }
+
+        return rotation_table[i].fresh[slot];
+    }
+
+    /*
+     * Page aligned slots keep the hardware prefetcher from pulling in the
+     * next slot while the current one is in use
+     */
+    page_size = sysconf(_SC_PAGESIZE);
+    stride = (size + page_size - 1) / page_size * page_size;
+    stride = (stride) ? stride : page_size;
+    slots = (rotation_table[i].size - size) / stride + 1;
+
+    return (char *)buffer + (iteration % slots) * stride;
+}
+
+/* A host buffer of allocate_host_buffer(), from the pool when it has one */
+static int allocate_pooled_host (void ** buffer, size_t size)
+{
+    if (buffer_pool_get(buffer, size, NONE)) {
+        return 0;
+    }
+
+    if (allocate_host_buffer(buffer, size)) {
+        return 1;
+    }
+
+    buffer_pool_add(*buffer, size, NONE);
+
+    return 0;
+}
+
+/*
+ * Host buffers of the point-to-point tests, which keep up to
+ * options.window_size messages in flight per buffer
+ */
+static int allocate_pt2pt_host (char ** buffer, size_t size)
+{
+    size_t pool_size = (CACHE_COLD == options.cache_mode)
+        ? size + options.cache_pool_size : size;
+
+    if (allocate_pooled_host((void **)buffer, pool_size)) {
+        return 1;
+    }
+
+    if (CACHE_HOT == options.cache_mode) {
+        return 0;
+    }
+
+    touch_host_buffer(*buffer, pool_size);
+
+    return register_rotation(*buffer, pool_size, NONE, options.window_size);
+}
+
+static void free_pt2pt_host (void * buffer)
+{
+    unregister_rotation(buffer);
+
+    if (!buffer_pool_put(buffer)) {
+        free_host_buffer(buffer);
+    }
+}
+
+/* A device buffer of TYPE, from the pool when it has one */
+static int allocate_pooled_device (char ** buffer, size_t size,
+        enum accel_type type)
+{
+    if (buffer_pool_get((void **)buffer, size, type)) {
+        return 0;
+    }
+
+    if (allocate_buffer((void **)buffer, size, type)) {
+        fprintf(stderr, "Could not allocate device memory\n");
+        return 1;
+    }
+
+    buffer_pool_add(*buffer, size, type);
+
+    return 0;
+}
+
+int allocate_device_buffer (char ** buffer, size_t buffer_size)
+{
+    return allocate_pooled_device(buffer, buffer_size, options.accel);
+}
+
+int allocate_device_buffer_one_sided (char ** buffer, size_t size)
+{
+    return allocate_pooled_device(buffer, size, options.accel);
+}
+
+int allocate_managed_buffer (char ** buffer, size_t buffer_size)
+{
+    /* The 'M' buffers of -d cuda */
+    if (CUDA != options.accel) {
+        fprintf(stderr, "Could not allocate device memory\n");
+        return 1;
+    }
+
+    return allocate_pooled_device(buffer, buffer_size, MANAGED);
+}
+
+int allocate_memory_pt2pt_mul (char ** sbuf, char ** rbuf, int rank, int pairs)
+{
+    size_t buffer_size = options.max_message_size;
+    int rep_count;
+    if (options.subtype == LAT_DT) {
+        if (options.dt_increase_size == 0)
+            rep_count = 0;
+        else
+            rep_count = options.max_message_size / options.dt_block_size;
+        buffer_size = options.max_message_size * options.dt_stride_size / options.dt_block_size +
+                      rep_count * (rep_count + 1) / 2 * options.dt_increase_size;
+    }
+
+    if (rank < pairs) {
+        if ('D' == options.src) {
+            if (allocate_device_buffer(sbuf, buffer_size)) {
+                fprintf(stderr, "Error allocating cuda memory\n");
+                return 1;
+            }
+
+            if (allocate_device_buffer(rbuf, buffer_size)) {
+                fprintf(stderr, "Error allocating cuda memory\n");
+                return 1;
+            }
+        } else if ('M' == options.src) {
+            if (allocate_managed_buffer(sbuf, buffer_size)) {
+                fprintf(stderr, "Error allocating cuda unified memory\n");
+                return 1;
+            }
+
+            if (allocate_managed_buffer(rbuf, buffer_size)) {
+                fprintf(stderr, "Error allocating cuda unified memory\n");
+                return 1;
+            }
+        } else {
+            if (allocate_pt2pt_host(sbuf, buffer_size)) {
+                fprintf(stderr, "Error allocating host memory\n");
+                return 1;
+            }
+
+            if (allocate_pt2pt_host(rbuf, buffer_size)) {
+                fprintf(stderr, "Error allocating host memory\n");
+                return 1;
+            }
+
+            if (bind_memory(*sbuf, buffer_size) ||
+                    bind_memory(*rbuf, buffer_size)) {
+                fprintf(stderr, "Error binding host memory to NUMA node %d\n",
+                        options.mem_node);
+                return 1;
+            }
+
+            fill_host_buffer(*sbuf, 0, options.max_message_size);
+            fill_host_buffer(*rbuf, 0, options.max_message_size);
+        }
+    } else {
+        if ('D' == options.dst) {
+            if (allocate_device_buffer(sbuf, buffer_size)) {
+                fprintf(stderr, "Error allocating cuda memory\n");
+                return 1;
+            }
+
+            if (allocate_device_buffer(rbuf, buffer_size)) {
+                fprintf(stderr, "Error allocating cuda memory\n");
+                return 1;
+            }
+        } else if ('M' == options.dst) {
+            if (allocate_managed_buffer(sbuf, buffer_size)) {
+                fprintf(stderr, "Error allocating cuda unified memory\n");
+                return 1;
+            }
+
+            if (allocate_managed_buffer(rbuf, buffer_size)) {
+                fprintf(stderr, "Error allocating cuda unified memory\n");
+                return 1;
+            }
+        } else {
+            if (allocate_pt2pt_host(sbuf, buffer_size)) {
+                fprintf(stderr, "Error allocating host memory\n");
+                return 1;
+            }
+
+            if (allocate_pt2pt_host(rbuf, buffer_size)) {
+                fprintf(stderr, "Error allocating host memory\n");
+                return 1;
+            }
+
+            if (bind_memory(*sbuf, buffer_size) ||
+                    bind_memory(*rbuf, buffer_size)) {
+                fprintf(stderr, "Error binding host memory to NUMA node %d\n",
+                        options.mem_node);
+                return 1;
+            }
+            fill_host_buffer(*sbuf, 0, options.max_message_size);
+            fill_host_buffer(*rbuf, 0, options.max_message_size);
+        }
+    }
+
+    return 0;
+}
+
+int allocate_memory_pt2pt (char ** sbuf, char ** rbuf, int rank)
+{
+    size_t buffer_size = options.max_message_size;
+    int rep_count;
+    if (options.subtype == LAT_DT) {
+        if (options.dt_increase_size == 0)
+            rep_count = 0;
+        else
+            rep_count = options.max_message_size / options.dt_block_size;
+        buffer_size = options.max_message_size * options.dt_stride_size / options.dt_block_size +
                       rep_count * (rep_count + 1) / 2 * options.dt_increase_size;
     }
 
-    if (rank < pairs) {
-        if ('D' == options.src) {
-            if (allocate_device_buffer(sbuf, buffer_size)) {
-                fprintf(stderr, "Error allocating cuda memory\n");
-                return 1;
+    switch (rank) {
+        case 0:
+            if ('D' == options.src) {
+                if (allocate_device_buffer(sbuf, buffer_size)) {
+                    fprintf(stderr, "Error allocating cuda memory\n");
+                    return 1;
+                }
+
+                if (allocate_device_buffer(rbuf, buffer_size)) {
+                    fprintf(stderr, "Error allocating cuda memory\n");
+                    return 1;
+                }
+            } else if ('M' == options.src) {
+                if (allocate_managed_buffer(sbuf, buffer_size)) {
+                    fprintf(stderr, "Error allocating cuda unified memory\n");
+                    return 1;
+                }
+
+                if (allocate_managed_buffer(rbuf, buffer_size)) {
+                    fprintf(stderr, "Error allocating cuda unified memory\n");
+                    return 1;
+                }
+            } else {
+                if (allocate_pt2pt_host(sbuf, buffer_size)) {
+                    fprintf(stderr, "Error allocating host memory\n");
+                    return 1;
+                }
+
+                if (allocate_pt2pt_host(rbuf, buffer_size)) {
+                    fprintf(stderr, "Error allocating host memory\n");
+                    return 1;
+                }
+
+                if (bind_memory(*sbuf, buffer_size) ||
+                        bind_memory(*rbuf, buffer_size)) {
+                    fprintf(stderr, "Error binding host memory to NUMA node %d\n",
+                            options.mem_node);
+                    return 1;
+                }
+            }
+            break;
+        case 1:
+            if ('D' == options.dst) {
+                if (allocate_device_buffer(sbuf, buffer_size)) {
+                    fprintf(stderr, "Error allocating cuda memory\n");
+                    return 1;
+                }
+
+                if (allocate_device_buffer(rbuf, buffer_size)) {
+                    fprintf(stderr, "Error allocating cuda memory\n");
+                    return 1;
+                }
+            } else if ('M' == options.dst) {
+                if (allocate_managed_buffer(sbuf, buffer_size)) {
+                    fprintf(stderr, "Error allocating cuda unified memory\n");
+                    return 1;
+                }
+
+                if (allocate_managed_buffer(rbuf, buffer_size)) {
+                    fprintf(stderr, "Error allocating cuda unified memory\n");
+                    return 1;
+                }
+            } else {
+                if (allocate_pt2pt_host(sbuf, buffer_size)) {
+                    fprintf(stderr, "Error allocating host memory\n");
+                    return 1;
+                }
+
+                if (allocate_pt2pt_host(rbuf, buffer_size)) {
+                    fprintf(stderr, "Error allocating host memory\n");
+                    return 1;
+                }
+
+                if (bind_memory(*sbuf, buffer_size) ||
+                        bind_memory(*rbuf, buffer_size)) {
+                    fprintf(stderr, "Error binding host memory to NUMA node %d\n",
+                            options.mem_node);
+                    return 1;
+                }
+            }
+            break;
+    }
+
+    return 0;
+}
+
+void allocate_memory_one_sided(int rank, char **user_buf,
+        char **win_base, size_t size, enum WINDOW type, MPI_Win *win)
+{
+    int page_size;
+    int purehost = 0;
+    int mem_on_dev = 0;
+
+    page_size = getpagesize();
+    assert(page_size <= MAX_ALIGNMENT);
+
+    if ('H' == options.src && 'H' == options.dst) {
+        purehost = 1;
+    }
+
+    if (rank == 0) {
+        mem_on_dev = ('H' == options.src) ? 0 : 1;
+    } else {
+        mem_on_dev = ('H' == options.dst) ? 0 : 1;
+    }
+
+    /* always allocate device buffers explicitly since most MPI libraries do not
+     * support allocating device buffers during window creation */
+    if (mem_on_dev) {
+        CHECK(allocate_device_buffer_one_sided(user_buf, size));
+        set_device_memory(*user_buf, 'a', size);
+        CHECK(allocate_device_buffer_one_sided(win_base, size));
+        set_device_memory(*win_base, 'a', size);
+    } else {
+        CHECK(allocate_pooled_host((void **)user_buf, size));
+        fill_host_buffer(*user_buf, 'a', size);
+        /* only explicitly allocate buffer for win_base when NOT using MPI_Win_allocate */
+        if (type != WIN_ALLOCATE) {
+            CHECK(allocate_pooled_host((void **)win_base, size));
+            fill_host_buffer(*win_base, 'a', size);
+        }
+    }
+
+#if MPI_VERSION >= 3
+    MPI_Status  reqstat;
+
+    switch (type) {
+        case WIN_CREATE:
+            MPI_CHECK(MPI_Win_create(*win_base, size, 1, MPI_INFO_NULL, MPI_COMM_WORLD, win));
+            break;
+        case WIN_DYNAMIC:
+            MPI_CHECK(MPI_Win_create_dynamic(MPI_INFO_NULL, MPI_COMM_WORLD, win));
+            MPI_CHECK(MPI_Win_attach(*win, (void *)*win_base, size));
+            MPI_CHECK(MPI_Get_address(*win_base, &disp_local));
+            if(rank == 0){
+                MPI_CHECK(MPI_Send(&disp_local, 1, MPI_AINT, 1, 1, MPI_COMM_WORLD));
+                MPI_CHECK(MPI_Recv(&disp_remote, 1, MPI_AINT, 1, 1, MPI_COMM_WORLD, &reqstat));
+            } else {
+                MPI_CHECK(MPI_Recv(&disp_remote, 1, MPI_AINT, 0, 1, MPI_COMM_WORLD, &reqstat));
+                MPI_CHECK(MPI_Send(&disp_local, 1, MPI_AINT, 0, 1, MPI_COMM_WORLD));
+            }
+            break;
+        default:
+            if (purehost) {
+                MPI_CHECK(MPI_Win_allocate(size, 1, MPI_INFO_NULL, MPI_COMM_WORLD, (void*) win_base, win));
+            } else {
+                MPI_CHECK(MPI_Win_create(*win_base, size, 1, MPI_INFO_NULL, MPI_COMM_WORLD, win));
+            }
+            break;
+    }
+#else
+    MPI_CHECK(MPI_Win_create(*win_base, size, 1, MPI_INFO_NULL, MPI_COMM_WORLD, win));
+#endif
+}
+
+static void release_buffer (void * buffer, enum accel_type type)
+{
+    struct device_backend const * device = device_backend(type);
+
+    if (NONE == type) {
+        free_host_buffer(buffer);
+    } else if (NULL != device) {
+        device->release(buffer);
+    }
+}
+
+void free_buffer (void * buffer, enum accel_type type)
+{
+    unregister_rotation(buffer);
+
+    if (!buffer_pool_put(buffer)) {
+        release_buffer(buffer, type);
+    }
+
+    /* Free dummy compute related resources */
+    if (CPU == options.target || BOTH == options.target) {
+        free_host_arrays();
+    }
+
+    join_progress_thread();
+
+    if (GPU == options.target || BOTH == options.target) {
+#ifdef _ENABLE_GPU_KERNEL_
+        free_device_arrays();
+#endif /* #ifdef _ENABLE_GPU_KERNEL_ */
+    }
+}
+
+#ifdef _ENABLE_ACCEL_
+/* Set by init_accel when the device had to be picked before the local rank was known */
+static int accel_deferred = 0;
+
+/* Device picked for this process, shown in the affinity summary */
+static struct {
+    int dev;
+    char bus_id[32];
+    char nic[GPU_NIC_NAME_LEN];
+} gpu_placement = {-1, "", ""};
+
+/*
+ * Once MPI is initialized the local rank comes from a shared memory split of
+ * MPI_COMM_WORLD.  Before that, which is when the benchmarks select their
+ * device, it is taken from the environment of the common launchers.
+ */
+int omb_get_local_rank()
+{
+    char *str = NULL;
+    int local_rank = -1;
+    int initialized = 0, finalized = 0;
+    MPI_Comm node_comm;
+
+    MPI_CHECK(MPI_Initialized(&initialized));
+    MPI_CHECK(MPI_Finalized(&finalized));
+
+    if (initialized && !finalized) {
+        MPI_CHECK(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0,
+                    MPI_INFO_NULL, &node_comm));
+        MPI_CHECK(MPI_Comm_rank(node_comm, &local_rank));
+        MPI_CHECK(MPI_Comm_free(&node_comm));
+    } else if ((str = getenv("MV2_COMM_WORLD_LOCAL_RANK")) != NULL) {
+        local_rank = atoi(str);
+    } else if ((str = getenv("OMPI_COMM_WORLD_LOCAL_RANK")) != NULL) {
+        local_rank = atoi(str);
+    } else if ((str = getenv("MPI_LOCALRANKID")) != NULL) {
+        local_rank = atoi(str);
+    } else if ((str = getenv("PMIX_LOCAL_RANK")) != NULL) {
+        local_rank = atoi(str);
+    } else if ((str = getenv("PALS_LOCAL_RANKID")) != NULL) {
+        local_rank = atoi(str);
+    } else if ((str = getenv("SLURM_LOCALID")) != NULL) {
+        local_rank = atoi(str);
+    } else if ((str = getenv("LOCAL_RANK")) != NULL) {
+        local_rank = atoi(str);
+    }
+
+    return local_rank;
+}
+
+static int gpu_bus_id (int dev, char * bus_id, int len)
+{
+    struct device_backend const * device = device_backend(options.accel);
+
+    if (NULL == device || NULL == device->bus_id) {
+        return -1;
+    }
+
+    return device->bus_id(dev, bus_id, len);
+}
+
+/* Resolved sysfs path of a PCI function, e.g. /sys/devices/pci0000:00/... */
+static int pci_device_path (char const * bus_id, char * path)
+{
+    char link[64];
+    int i;
+
+    i = snprintf(link, sizeof(link), "/sys/bus/pci/devices/");
+    for (; *bus_id && i < (int)sizeof(link) - 1; bus_id++) {
+        link[i++] = tolower((unsigned char)*bus_id);
+    }
+    link[i] = '\0';
+
+    return realpath(link, path) ? 0 : -1;
+}
+
+/*
+ * Number of PCIe hops between two devices: the bridges below their common
+ * ancestor in the sysfs tree, counted on both sides.
+ */
+static int pci_distance (char const * a, char const * b)
+{
+    char const * p = a;
+    char const * q = b;
+    int hops = 0;
+
+    while (*p && *p == *q) {
+        p++;
+        q++;
+    }
+
+    /* Back up to the last component both paths share */
+    if (!(('\0' == *p || '/' == *p) && ('\0' == *q || '/' == *q))) {
+        while (p > a && '/' != *p) {
+            p--;
+            q--;
+        }
+    }
+
+    for (; *p; p++) {
+        hops += '/' == *p;
+    }
+    for (; *q; q++) {
+        hops += '/' == *q;
+    }
+
+    return hops;
+}
+
+static int compare_names (void const * a, void const * b)
+{
+    return strcmp((char const *)a, (char const *)b);
+}
+
+#define MAX_SELECT_NICS 32
+#define MAX_SELECT_GPUS 64
+
+/*
+ * Map the local rank to a device.  "rank" uses the rank modulo the device
+ * count, "list" indexes the given device list.  "nic" spreads the local ranks
+ * over the RDMA devices in /sys/class/infiniband and gives every rank a GPU
+ * whose closest NIC is its own, or the GPUs closest to the named NIC with
+ * nic:NAME, so that every GPU buffer goes out through the shortest PCIe path.
+ */
+static int select_accel_device (int local_rank, int dev_count)
+{
+    static char nic_name[MAX_SELECT_NICS][GPU_NIC_NAME_LEN];
+    static char nic_path[MAX_SELECT_NICS][PATH_MAX];
+    static char gpu_path[MAX_SELECT_GPUS][PATH_MAX];
+    int nearest[MAX_SELECT_GPUS], distance[MAX_SELECT_GPUS];
+    int candidates[MAX_SELECT_GPUS];
+    char link[PATH_MAX];
+    DIR * dir;
+    struct dirent * entry;
+    int nnics = 0, ngpus, ncand = 0, nic = -1, best, dev, d, i;
+
+    if (0 > local_rank) {
+        local_rank = 0;
+    }
+
+    if (GPU_SELECT_LIST == options.gpu_select) {
+        return options.gpu_list[local_rank % options.num_gpu_list] % dev_count;
+    }
+
+    dev = local_rank % dev_count;
+
+    if (GPU_SELECT_NIC != options.gpu_select) {
+        return dev;
+    }
+
+    if (NULL != (dir = opendir("/sys/class/infiniband"))) {
+        while (NULL != (entry = readdir(dir)) && nnics < MAX_SELECT_NICS) {
+            if ('.' != entry->d_name[0] &&
+                    GPU_NIC_NAME_LEN > strlen(entry->d_name)) {
+                strcpy(nic_name[nnics++], entry->d_name);
+            }
+        }
+        closedir(dir);
+    }
+    qsort(nic_name, nnics, GPU_NIC_NAME_LEN, compare_names);
+
+    for (i = 0; i < nnics; i++) {
+        snprintf(link, sizeof(link), "/sys/class/infiniband/%s/device",
+                nic_name[i]);
+        if (NULL == realpath(link, nic_path[i])) {
+            nic_path[i][0] = '\0';
+        }
+        if (options.gpu_nic[0] && 0 == strcmp(options.gpu_nic, nic_name[i])) {
+            nic = i;
+        }
+    }
+
+    ngpus = dev_count < MAX_SELECT_GPUS ? dev_count : MAX_SELECT_GPUS;
+    for (d = 0; d < ngpus; d++) {
+        char bus_id[32];
+
+        if (gpu_bus_id(d, bus_id, sizeof(bus_id)) ||
+                pci_device_path(bus_id, gpu_path[d])) {
+            nnics = 0;
+            break;
+        }
+    }
+
+    if (0 == nnics || (options.gpu_nic[0] && 0 > nic)) {
+        if (0 == local_rank) {
+            fprintf(stderr, "Warning: NIC topology not available, selecting "
+                    "GPUs by local rank\n");
+        }
+        return dev;
+    }
+
+    if (0 > nic) {
+        nic = local_rank % nnics;
+    }
+
+    /* Nearest NIC of every GPU, and its distance to the chosen one */
+    for (d = 0; d < ngpus; d++) {
+        nearest[d] = 0;
+        for (i = 1; i < nnics; i++) {
+            if (pci_distance(gpu_path[d], nic_path[i]) <
+                    pci_distance(gpu_path[d], nic_path[nearest[d]])) {
+                nearest[d] = i;
+            }
+        }
+        distance[d] = pci_distance(gpu_path[d], nic_path[nic]);
+    }
+
+    if (!options.gpu_nic[0]) {
+        for (d = 0; d < ngpus; d++) {
+            if (nic == nearest[d]) {
+                candidates[ncand++] = d;
+            }
+        }
+    }
+
+    if (0 == ncand) {
+        best = distance[0];
+        for (d = 1; d < ngpus; d++) {
+            best = distance[d] < best ? distance[d] : best;
+        }
+        for (d = 0; d < ngpus; d++) {
+            if (best == distance[d]) {
+                candidates[ncand++] = d;
+            }
+        }
+    }
+
+    dev = candidates[(options.gpu_nic[0] ? local_rank : local_rank / nnics) % ncand];
+    strcpy(gpu_placement.nic, nic_name[nic]);
+
+    return dev;
+}
+
+static int set_accel_device (int local_rank)
+{
+    struct device_backend const * device = device_backend(options.accel);
+    int dev_count = 0;
+    int dev_id = 0;
+
+    if (NULL == device) {
+        fprintf(stderr, "Invalid device type, should be cuda, openacc, rocm, or sycl\n");
+        return 1;
+    }
+
+    if (device->device_count(&dev_count) || 0 >= dev_count) {
+        fprintf(stderr, "No %s device found\n", device->name);
+        return 1;
+    }
+
+    dev_id = select_accel_device(local_rank, dev_count);
+    if (device->set_device(dev_id)) {
+        return 1;
+    }
+
+    gpu_placement.dev = dev_id;
+    if (gpu_bus_id(dev_id, gpu_placement.bus_id, sizeof(gpu_placement.bus_id))) {
+        gpu_placement.bus_id[0] = '\0';
+    }
+
+    return 0;
+}
+#endif /* #ifdef _ENABLE_ACCEL_ */
+
+int init_accel (void)
+{
+#ifdef _ENABLE_ACCEL_
+    int local_rank = omb_get_local_rank();
+
+    /*
+     * Without a launcher variable the point-to-point benchmarks select the
+     * device again from setup_affinity(), once MPI can tell the local rank.
+     */
+    if (0 > local_rank) {
+        accel_deferred = 1;
+
+        if (PT2PT != options.bench && MBW_MR != options.bench) {
+            fprintf(stderr, "Warning: OMB could not identify the local rank of the process.\n");
+            fprintf(stderr, "         This can lead to multiple processes using the same GPU.\n");
+            fprintf(stderr, "         Please use the get_local_rank script in the OMB repo for this.\n");
+        }
+    }
+
+    return set_accel_device(local_rank);
+#else
+    fprintf(stderr, "Invalid device type, should be cuda, openacc, rocm, or sycl\n");
+    return 1;
+#endif
+}
+
+/*
+ * Redo the device selection of init_accel with the local rank from MPI, if
+ * the environment did not provide it.
+ */
+int rebind_accel (void)
+{
+#ifdef _ENABLE_ACCEL_
+    int local_rank;
+
+    if (!accel_deferred || NONE == options.accel) {
+        return 0;
+    }
+
+    accel_deferred = 0;
+    local_rank = omb_get_local_rank();
+
+    /* The deferred selection already used local rank 0 */
+    if (0 >= local_rank) {
+        return 0;
+    }
+
+    return set_accel_device(local_rank);
+#else
+    return 0;
+#endif
+}
+
+/* ", GPU 2 (0000:3b:00.0) near mlx5_0" for the affinity summary */
+static void format_gpu_placement (char * buf, size_t len)
+{
+    buf[0] = '\0';
+
+#ifdef _ENABLE_ACCEL_
+    if (NONE != options.accel && 0 <= gpu_placement.dev) {
+        int n = snprintf(buf, len, ", GPU %d", gpu_placement.dev);
+
+        if (gpu_placement.bus_id[0] && n < (int)len) {
+            n += snprintf(buf + n, len - n, " (%s)", gpu_placement.bus_id);
+        }
+        if (gpu_placement.nic[0] && n < (int)len) {
+            snprintf(buf + n, len - n, " near %s", gpu_placement.nic);
+        }
+    }
+#endif
+}
+
+/*
+ * Device Peer Copies
+ *
+ * osu_gpu_peer compares MPI on device buffers of two ranks of a node with
+ * the copies the library could use instead, issued by rank 0 on a stream of
+ * its own:
+ *
+ *   Peer  cudaMemcpyPeerAsync (hipMemcpyPeerAsync) from the device of rank
+ *         0 into a buffer that rank 0 allocates on the device of rank 1,
+ *         found by its PCI bus id, so it needs that device to be visible
+ *   IPC   cudaMemcpyAsync (hipMemcpyAsync) into a buffer of rank 1 that
+ *         rank 0 maps from the IPC memory handle rank 1 sends it
+ *
+ * Peer access between the two devices is enabled when the devices allow
+ * it, otherwise the driver stages the copies through the host.
+ */
+static struct {
+    int dev;
+    int peer_dev;
+    int access;
+    void * peer_buf;
+    void * ipc_buf;
+    void * ipc_target;
+#ifdef _ENABLE_CUDA_
+    cudaStream_t cuda_stream;
+#endif
+#ifdef _ENABLE_ROCM_
+    hipStream_t rocm_stream;
+#endif
+} peer_copy = {-1, -1, 0, NULL, NULL, NULL};
+
+int setup_peer_copy (int rank, size_t size)
+{
+    char bus_id[32] = "";
+    MPI_Comm node_comm;
+    int node_size;
+
+    MPI_CHECK(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0,
+                MPI_INFO_NULL, &node_comm));
+    MPI_CHECK(MPI_Comm_size(node_comm, &node_size));
+    MPI_CHECK(MPI_Comm_free(&node_comm));
+
+    if (2 != node_size) {
+        if (0 == rank) {
+            fprintf(stderr, "This test requires both processes on the same "
+                    "node\n");
+        }
+
+        return 1;
+    }
+
+    size = MAX(1, size);
+
+    switch (options.accel) {
+#ifdef _ENABLE_CUDA_
+        case CUDA:
+            CUDA_CHECK(cudaGetDevice(&peer_copy.dev));
+            break;
+#endif
+#ifdef _ENABLE_ROCM_
+        case ROCM:
+            ROCM_CHECK(hipGetDevice(&peer_copy.dev));
+            break;
+#endif
+        default:
+            if (0 == rank) {
+                fprintf(stderr, "This test requires CUDA or ROCm device "
+                        "buffers, please run it with -d cuda or -d rocm\n");
             }
 
-            if (allocate_device_buffer(rbuf, buffer_size)) {
-                fprintf(stderr, "Error allocating cuda memory\n");
-                return 1;
+            return 1;
+    }
+
+    if (1 == rank) {
+#if defined(_ENABLE_CUDA_) || defined(_ENABLE_ROCM_)
+        gpu_bus_id(peer_copy.dev, bus_id, sizeof(bus_id));
+#endif
+        MPI_CHECK(MPI_Send(bus_id, sizeof(bus_id), MPI_CHAR, 0, 1,
+                    MPI_COMM_WORLD));
+    } else {
+        MPI_CHECK(MPI_Recv(bus_id, sizeof(bus_id), MPI_CHAR, 1, 1,
+                    MPI_COMM_WORLD, MPI_STATUS_IGNORE));
+    }
+
+    switch (options.accel) {
+#ifdef _ENABLE_CUDA_
+        case CUDA:
+            if (1 == rank) {
+                cudaIpcMemHandle_t handle;
+
+                CUDA_CHECK(cudaMalloc(&peer_copy.ipc_target, size));
+                CUDA_CHECK(cudaIpcGetMemHandle(&handle, peer_copy.ipc_target));
+                MPI_CHECK(MPI_Send(&handle, sizeof(handle), MPI_BYTE, 0, 1,
+                            MPI_COMM_WORLD));
+                break;
             }
-        } else if ('M' == options.src) {
-            if (allocate_managed_buffer(sbuf, buffer_size)) {
-                fprintf(stderr, "Error allocating cuda unified memory\n");
-                return 1;
+
+            {
+                cudaIpcMemHandle_t handle;
+
+                MPI_CHECK(MPI_Recv(&handle, sizeof(handle), MPI_BYTE, 1, 1,
+                            MPI_COMM_WORLD, MPI_STATUS_IGNORE));
+                CUDA_CHECK(cudaIpcOpenMemHandle(&peer_copy.ipc_buf, handle,
+                            cudaIpcMemLazyEnablePeerAccess));
             }
 
-            if (allocate_managed_buffer(rbuf, buffer_size)) {
-                fprintf(stderr, "Error allocating cuda unified memory\n");
-                return 1;
+            CUDA_CHECK(cudaStreamCreate(&peer_copy.cuda_stream));
+
+            if (!bus_id[0] || cudaSuccess !=
+                    cudaDeviceGetByPCIBusId(&peer_copy.peer_dev, bus_id)) {
+                peer_copy.peer_dev = -1;
+                cudaGetLastError();
+                break;
             }
-        } else {
-            if (posix_memalign((void**)sbuf, align_size, buffer_size)) {
-                fprintf(stderr, "Error allocating host memory\n");
-                return 1;
+
+            if (peer_copy.peer_dev == peer_copy.dev) {
+                peer_copy.access = 1;
+            } else {
+                CUDA_CHECK(cudaDeviceCanAccessPeer(&peer_copy.access,
+                            peer_copy.dev, peer_copy.peer_dev));
+                if (peer_copy.access && cudaSuccess !=
+                        cudaDeviceEnablePeerAccess(peer_copy.peer_dev, 0)) {
+                    /* cudaErrorPeerAccessAlreadyEnabled after IPC mapping */
+                    cudaGetLastError();
+                }
             }
 
-            if (posix_memalign((void**)rbuf, align_size, buffer_size)) {
-                fprintf(stderr, "Error allocating host memory\n");
-                return 1;
+            CUDA_CHECK(cudaSetDevice(peer_copy.peer_dev));
+            CUDA_CHECK(cudaMalloc(&peer_copy.peer_buf, size));
+            CUDA_CHECK(cudaSetDevice(peer_copy.dev));
+            break;
+#endif
+#ifdef _ENABLE_ROCM_
+        case ROCM:
+            if (1 == rank) {
+                hipIpcMemHandle_t handle;
+
+                ROCM_CHECK(hipMalloc(&peer_copy.ipc_target, size));
+                ROCM_CHECK(hipIpcGetMemHandle(&handle, peer_copy.ipc_target));
+                MPI_CHECK(MPI_Send(&handle, sizeof(handle), MPI_BYTE, 0, 1,
+                            MPI_COMM_WORLD));
+                break;
             }
 
-            memset(*sbuf, 0, options.max_message_size);
-            memset(*rbuf, 0, options.max_message_size);
-        }
-    } else {
-        if ('D' == options.dst) {
-            if (allocate_device_buffer(sbuf, buffer_size)) {
-                fprintf(stderr, "Error allocating cuda memory\n");
-                return 1;
+            {
+                hipIpcMemHandle_t handle;
+
+                MPI_CHECK(MPI_Recv(&handle, sizeof(handle), MPI_BYTE, 1, 1,
+                            MPI_COMM_WORLD, MPI_STATUS_IGNORE));
+                ROCM_CHECK(hipIpcOpenMemHandle(&peer_copy.ipc_buf, handle,
+                            hipIpcMemLazyEnablePeerAccess));
             }
 
-            if (allocate_device_buffer(rbuf, buffer_size)) {
-                fprintf(stderr, "Error allocating cuda memory\n");
-                return 1;
+            ROCM_CHECK(hipStreamCreate(&peer_copy.rocm_stream));
+
+            if (!bus_id[0] || hipSuccess !=
+                    hipDeviceGetByPCIBusId(&peer_copy.peer_dev, bus_id)) {
+                peer_copy.peer_dev = -1;
+                hipGetLastError();
+                break;
             }
-        } else if ('M' == options.dst) {
-            if (allocate_managed_buffer(sbuf, buffer_size)) {
-                fprintf(stderr, "Error allocating cuda unified memory\n");
-                return 1;
+
+            if (peer_copy.peer_dev == peer_copy.dev) {
+                peer_copy.access = 1;
+            } else {
+                ROCM_CHECK(hipDeviceCanAccessPeer(&peer_copy.access,
+                            peer_copy.dev, peer_copy.peer_dev));
+                if (peer_copy.access && hipSuccess !=
+                        hipDeviceEnablePeerAccess(peer_copy.peer_dev, 0)) {
+                    hipGetLastError();
+                }
             }
 
-            if (allocate_managed_buffer(rbuf, buffer_size)) {
-                fprintf(stderr, "Error allocating cuda unified memory\n");
-                return 1;
+            ROCM_CHECK(hipSetDevice(peer_copy.peer_dev));
+            ROCM_CHECK(hipMalloc(&peer_copy.peer_buf, size));
+            ROCM_CHECK(hipSetDevice(peer_copy.dev));
+            break;
+#endif
+        default:
+            break;
+    }
+
+    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+    return 0;
+}
+
+/* Whether rank 0 can time PATH, the peer copy needs the device of rank 1 */
+int peer_copy_available (enum peer_copy path)
+{
+    return PEER_COPY_PEER == path ? NULL != peer_copy.peer_buf :
+        NULL != peer_copy.ipc_buf;
+}
+
+int peer_access_enabled (void)
+{
+    return peer_copy.access;
+}
+
+/* Microseconds of one copy of SIZE bytes along PATH, on rank 0 */
+double time_peer_copy (enum peer_copy path, void const * s_buf, size_t size)
+{
+    double t_start = 0.0;
+    int i;
+
+    for (i = 0; i < options.iterations + options.skip; i++) {
+        if (i == options.skip) {
+            t_start = osu_wtime();
+        }
+
+        switch (options.accel) {
+#ifdef _ENABLE_CUDA_
+            case CUDA:
+                if (PEER_COPY_PEER == path) {
+                    CUDA_CHECK(cudaMemcpyPeerAsync(peer_copy.peer_buf,
+                                peer_copy.peer_dev, s_buf, peer_copy.dev, size,
+                                peer_copy.cuda_stream));
+                } else {
+                    CUDA_CHECK(cudaMemcpyAsync(peer_copy.ipc_buf, s_buf, size,
+                                cudaMemcpyDeviceToDevice,
+                                peer_copy.cuda_stream));
+                }
+                CUDA_CHECK(cudaStreamSynchronize(peer_copy.cuda_stream));
+                break;
+#endif
+#ifdef _ENABLE_ROCM_
+            case ROCM:
+                if (PEER_COPY_PEER == path) {
+                    ROCM_CHECK(hipMemcpyPeerAsync(peer_copy.peer_buf,
+                                peer_copy.peer_dev, s_buf, peer_copy.dev, size,
+                                peer_copy.rocm_stream));
+                } else {
+                    ROCM_CHECK(hipMemcpyAsync(peer_copy.ipc_buf, s_buf, size,
+                                hipMemcpyDeviceToDevice,
+                                peer_copy.rocm_stream));
+                }
+                ROCM_CHECK(hipStreamSynchronize(peer_copy.rocm_stream));
+                break;
+#endif
+            default:
+                break;
+        }
+    }
+
+    return (osu_wtime() - t_start) * 1e6 / options.iterations;
+}
+
+/* Collective over both ranks, the mapping closes before rank 1 frees */
+void free_peer_copy (int rank)
+{
+    switch (options.accel) {
+#ifdef _ENABLE_CUDA_
+        case CUDA:
+            if (peer_copy.ipc_buf) {
+                CUDA_CHECK(cudaIpcCloseMemHandle(peer_copy.ipc_buf));
+                CUDA_CHECK(cudaStreamDestroy(peer_copy.cuda_stream));
             }
-        } else {
-            if (posix_memalign((void**)sbuf, align_size, buffer_size)) {
-                fprintf(stderr, "Error allocating host memory\n");
-                return 1;
+            if (peer_copy.peer_buf) {
+                CUDA_CHECK(cudaFree(peer_copy.peer_buf));
             }
-
-            if (posix_memalign((void**)rbuf, align_size, buffer_size)) {
-                fprintf(stderr, "Error allocating host memory\n");
-                return 1;
+            break;
+#endif
+#ifdef _ENABLE_ROCM_
+        case ROCM:
+            if (peer_copy.ipc_buf) {
+                ROCM_CHECK(hipIpcCloseMemHandle(peer_copy.ipc_buf));
+                ROCM_CHECK(hipStreamDestroy(peer_copy.rocm_stream));
             }
-            memset(*sbuf, 0, options.max_message_size);
-            memset(*rbuf, 0, options.max_message_size);
+            if (peer_copy.peer_buf) {
+                ROCM_CHECK(hipFree(peer_copy.peer_buf));
+            }
+            break;
+#endif
+        default:
+            break;
+    }
+
+    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
+
+    if (1 == rank && peer_copy.ipc_target) {
+#ifdef _ENABLE_CUDA_
+        if (CUDA == options.accel) {
+            CUDA_CHECK(cudaFree(peer_copy.ipc_target));
         }
+#endif
+#ifdef _ENABLE_ROCM_
+        if (ROCM == options.accel) {
+            ROCM_CHECK(hipFree(peer_copy.ipc_target));
+        }
+#endif
     }
 
-    return 0;
+    peer_copy.peer_buf = peer_copy.ipc_buf = peer_copy.ipc_target = NULL;
 }
 
-int allocate_memory_pt2pt (char ** sbuf, char ** rbuf, int rank)
+int cleanup_accel (void)
 {
-    unsigned long align_size = sysconf(_SC_PAGESIZE);
-    size_t buffer_size = options.max_message_size;
-    int rep_count;
-    if (options.subtype == LAT_DT) {
-        if (options.dt_increase_size == 0)
-            rep_count = 0;
-        else
-            rep_count = options.max_message_size / options.dt_block_size;
-        buffer_size = options.max_message_size * options.dt_stride_size / options.dt_block_size +
-                      rep_count * (rep_count + 1) / 2 * options.dt_increase_size;
+    struct device_backend const * device = device_backend(options.accel);
+
+    /* Parked device buffers of the buffer pool need the device */
+    if (buffer_pool_enabled) {
+        return 0;
+    }
+
+    if (NULL == device) {
+        fprintf(stderr, "Invalid accel type, should be cuda, openacc, rocm, or sycl\n");
+        return 1;
+    }
+
+    return device->finalize();
+}
+
+#ifdef _ENABLE_GPU_KERNEL_
+static void create_compute_streams (void)
+{
+    int i;
+
+    for (i = 0; i < GPU_COMPUTE_STREAMS; i++) {
+        void * stream;
+
+        kernel_backend()->stream_create(&stream);
+        compute_stream[i] = stream;
+    }
+
+#ifdef _ENABLE_CUDA_KERNEL_
+    CUDA_CHECK(cudaEventCreate(&calib_start));
+    CUDA_CHECK(cudaEventCreate(&calib_stop));
+#else
+    ROCM_CHECK(hipEventCreate(&calib_start));
+    ROCM_CHECK(hipEventCreate(&calib_stop));
+#endif
+
+    next_stream = 0;
+    pending_streams = 0;
+}
+
+static void destroy_compute_streams (void)
+{
+    int i;
+
+    for (i = 0; i < GPU_COMPUTE_STREAMS; i++) {
+        kernel_backend()->stream_destroy(compute_stream[i]);
+    }
+
+#ifdef _ENABLE_CUDA_KERNEL_
+    CUDA_CHECK(cudaEventDestroy(calib_start));
+    CUDA_CHECK(cudaEventDestroy(calib_stop));
+#else
+    ROCM_CHECK(hipEventDestroy(calib_start));
+    ROCM_CHECK(hipEventDestroy(calib_stop));
+#endif
+}
+
+static void launch_compute (int iters)
+{
+    call_kernel(A, d_x, d_y, options.device_array_size, iters,
+            &compute_stream[next_stream]);
+
+    next_stream = (next_stream + 1) % GPU_COMPUTE_STREAMS;
+    if (pending_streams < GPU_COMPUTE_STREAMS) {
+        pending_streams++;
+    }
+}
+
+/* Wait for the kernels launched since the last call */
+static void wait_compute (void)
+{
+    int i, k;
+
+    for (i = 1; i <= pending_streams; i++) {
+        k = (next_stream + GPU_COMPUTE_STREAMS - i) % GPU_COMPUTE_STREAMS;
+        kernel_backend()->stream_sync(compute_stream[k]);
+    }
+
+    pending_streams = 0;
+}
+
+/* Device time of one kernel of ITERS iterations, in seconds */
+static double time_compute (int iters)
+{
+    float ms = 0.0f;
+
+#ifdef _ENABLE_CUDA_KERNEL_
+    CUDA_CHECK(cudaEventRecord(calib_start, compute_stream[0]));
+    call_kernel(A, d_x, d_y, options.device_array_size, iters,
+            &compute_stream[0]);
+    CUDA_CHECK(cudaEventRecord(calib_stop, compute_stream[0]));
+    CUDA_CHECK(cudaEventSynchronize(calib_stop));
+    CUDA_CHECK(cudaEventElapsedTime(&ms, calib_start, calib_stop));
+#else
+    ROCM_CHECK(hipEventRecord(calib_start, compute_stream[0]));
+    call_kernel(A, d_x, d_y, options.device_array_size, iters,
+            &compute_stream[0]);
+    ROCM_CHECK(hipEventRecord(calib_stop, compute_stream[0]));
+    ROCM_CHECK(hipEventSynchronize(calib_stop));
+    ROCM_CHECK(hipEventElapsedTime(&ms, calib_start, calib_stop));
+#endif
+
+    return ms / 1e3;
+}
+
+void free_device_arrays()
+{
+    if (is_alloc) {
+        kernel_backend()->release(d_x);
+        kernel_backend()->release(d_y);
+        destroy_compute_streams();
+
+        is_alloc = 0;
     }
+}
+#endif
 
-    switch (rank) {
-        case 0:
-            if ('D' == options.src) {
-                if (allocate_device_buffer(sbuf, buffer_size)) {
-                    fprintf(stderr, "Error allocating cuda memory\n");
-                    return 1;
-                }
+void free_host_arrays()
+{
+    free_host_compute();
 
-                if (allocate_device_buffer(rbuf, buffer_size)) {
-                    fprintf(stderr, "Error allocating cuda memory\n");
-                    return 1;
-                }
-            } else if ('M' == options.src) {
-                if (allocate_managed_buffer(sbuf, buffer_size)) {
-                    fprintf(stderr, "Error allocating cuda unified memory\n");
-                    return 1;
-                }
+    join_progress_thread();
+}
 
-                if (allocate_managed_buffer(rbuf, buffer_size)) {
-                    fprintf(stderr, "Error allocating cuda unified memory\n");
-                    return 1;
-                }
+void free_memory (void * sbuf, void * rbuf, int rank)
+{
+    switch (rank) {
+        case 0:
+            if ('D' == options.src || 'M' == options.src) {
+                free_device_buffer(sbuf);
+                free_device_buffer(rbuf);
             } else {
-                if (posix_memalign((void**)sbuf, align_size, buffer_size)) {
-                    fprintf(stderr, "Error allocating host memory\n");
-                    return 1;
-                }
-
-                if (posix_memalign((void**)rbuf, align_size, buffer_size)) {
-                    fprintf(stderr, "Error allocating host memory\n");
-                    return 1;
-                }
+                free_pt2pt_host(sbuf);
+                free_pt2pt_host(rbuf);
             }
             break;
         case 1:
-            if ('D' == options.dst) {
-                if (allocate_device_buffer(sbuf, buffer_size)) {
-                    fprintf(stderr, "Error allocating cuda memory\n");
-                    return 1;
-                }
-
-                if (allocate_device_buffer(rbuf, buffer_size)) {
-                    fprintf(stderr, "Error allocating cuda memory\n");
-                    return 1;
-                }
-            } else if ('M' == options.dst) {
-                if (allocate_managed_buffer(sbuf, buffer_size)) {
-                    fprintf(stderr, "Error allocating cuda unified memory\n");
-                    return 1;
-                }
-
-                if (allocate_managed_buffer(rbuf, buffer_size)) {
-                    fprintf(stderr, "Error allocating cuda unified memory\n");
-                    return 1;
-                }
+            if ('D' == options.dst || 'M' == options.dst) {
+                free_device_buffer(sbuf);
+                free_device_buffer(rbuf);
             } else {
-                if (posix_memalign((void**)sbuf, align_size, buffer_size)) {
-                    fprintf(stderr, "Error allocating host memory\n");
-                    return 1;
-                }
-
-                if (posix_memalign((void**)rbuf, align_size, buffer_size)) {
-                    fprintf(stderr, "Error allocating host memory\n");
-                    return 1;
-                }
+                free_pt2pt_host(sbuf);
+                free_pt2pt_host(rbuf);
             }
             break;
     }
-
-    return 0;
 }
 
-void allocate_memory_one_sided(int rank, char **user_buf,
-        char **win_base, size_t size, enum WINDOW type, MPI_Win *win)
+void free_memory_pt2pt_mul (void * sbuf, void * rbuf, int rank, int pairs)
 {
-    int page_size;
-    int purehost = 0;
-    int mem_on_dev = 0;
+    if (rank < pairs) {
+        if ('D' == options.src || 'M' == options.src) {
+            free_device_buffer(sbuf);
+            free_device_buffer(rbuf);
+        } else {
+            free_pt2pt_host(sbuf);
+            free_pt2pt_host(rbuf);
+        }
+    } else {
+        if ('D' == options.dst || 'M' == options.dst) {
+            free_device_buffer(sbuf);
+            free_device_buffer(rbuf);
+        } else {
+            free_pt2pt_host(sbuf);
+            free_pt2pt_host(rbuf);
+        }
+    }
+}
 
-    page_size = getpagesize();
-    assert(page_size <= MAX_ALIGNMENT);
+/*
+ * Every derived datatype of osu_latency_dt and osu_multi_lat_dt describes the
+ * same blocks of dt_block_size bytes, block i starting at
+ *
+ *     i * dt_stride_size + dt_increase_size * i * (i - 1) / 2
+ *
+ * so only the constructor differs between them, and dt_pack() can gather any
+ * of them with the same formula.
+ */
+static int dt_lengths[MAX_DT_REPEAT_COUNT];
+static int dt_displs[MAX_DT_REPEAT_COUNT];
+static MPI_Aint dt_byte_displs[MAX_DT_REPEAT_COUNT];
+static MPI_Datatype dt_types[MAX_DT_REPEAT_COUNT];
 
-    if ('H' == options.src && 'H' == options.dst) {
-        purehost = 1;
+static size_t dt_block_offset (size_t i)
+{
+    /* i * (i - 1) wraps to 0 for i == 0 */
+    return i * options.dt_stride_size +
+        options.dt_increase_size * i * (i - 1) / 2;
+}
+
+/*
+ * The subarray is a REP_COUNT x dt_stride_size byte matrix of which the first
+ * dt_block_size columns are sent.  The struct alternates MPI_CHAR and MPI_INT
+ * blocks when the block size allows it, so the library cannot treat it as a
+ * plain indexed type.  Returns the number of blocks.
+ */
+int create_dt_type (int size, MPI_Datatype * type)
+{
+    int rep_count = size / options.dt_block_size;
+    int sizes[2], subsizes[2], starts[2] = {0, 0};
+    int mixed = (0 == options.dt_block_size % sizeof(int));
+    int i;
+
+    switch (options.dt_layout) {
+        case DT_INDEXED:
+            for (i = 0; i < rep_count; i++) {
+                dt_lengths[i] = options.dt_block_size;
+                dt_displs[i] = dt_block_offset(i);
+            }
+            MPI_CHECK(MPI_Type_indexed(rep_count, dt_lengths, dt_displs,
+                        MPI_CHAR, type));
+            break;
+        case DT_SUBARRAY:
+            sizes[0] = rep_count;
+            sizes[1] = options.dt_stride_size;
+            subsizes[0] = rep_count;
+            subsizes[1] = options.dt_block_size;
+            MPI_CHECK(MPI_Type_create_subarray(2, sizes, subsizes, starts,
+                        MPI_ORDER_C, MPI_CHAR, type));
+            break;
+        case DT_STRUCT:
+            for (i = 0; i < rep_count; i++) {
+                dt_byte_displs[i] = dt_block_offset(i);
+                if (mixed && (i & 1)) {
+                    dt_lengths[i] = options.dt_block_size / sizeof(int);
+                    dt_types[i] = MPI_INT;
+                } else {
+                    dt_lengths[i] = options.dt_block_size;
+                    dt_types[i] = MPI_CHAR;
+                }
+            }
+            MPI_CHECK(MPI_Type_create_struct(rep_count, dt_lengths,
+                        dt_byte_displs, dt_types, type));
+            break;
+        default:
+            MPI_CHECK(MPI_Type_vector(rep_count, options.dt_block_size,
+                        options.dt_stride_size, MPI_CHAR, type));
+            break;
     }
+    MPI_CHECK(MPI_Type_commit(type));
 
-    if (rank == 0) {
-        mem_on_dev = ('H' == options.src) ? 0 : 1;
-    } else {
-        mem_on_dev = ('H' == options.dst) ? 0 : 1;
+    return rep_count;
+}
+
+/*
+ * The contiguous staging buffer of the user-side pack lives in the same kind
+ * of memory as the buffers it is packed from.
+ */
+int allocate_dt_pack_buffer (char ** buffer, char buf_type)
+{
+    switch (buf_type) {
+        case 'D':
+            return allocate_device_buffer(buffer, options.max_message_size);
+        case 'M':
+            return allocate_managed_buffer(buffer, options.max_message_size);
+        default:
+            return allocate_pt2pt_host(buffer, options.max_message_size);
     }
+}
 
-    /* always allocate device buffers explicitly since most MPI libraries do not
-     * support allocating device buffers during window creation */
-    if (mem_on_dev) {
-        CHECK(allocate_device_buffer_one_sided(user_buf, size));
-        set_device_memory(*user_buf, 'a', size);
-        CHECK(allocate_device_buffer_one_sided(win_base, size));
-        set_device_memory(*win_base, 'a', size);
+void free_dt_pack_buffer (char * buffer, char buf_type)
+{
+    if ('D' == buf_type || 'M' == buf_type) {
+        free_device_buffer(buffer);
     } else {
-        CHECK(posix_memalign((void **)user_buf, page_size, size));
-        memset(*user_buf, 'a', size);
-        /* only explicitly allocate buffer for win_base when NOT using MPI_Win_allocate */
-        if (type != WIN_ALLOCATE) {
-            CHECK(posix_memalign((void **)win_base, page_size, size));
-            memset(*win_base, 'a', size);
-        }
+        free_pt2pt_host(buffer);
     }
+}
 
-#if MPI_VERSION >= 3
-    MPI_Status  reqstat;
+/*
+ * Gather COUNT blocks of BUF into PACKED, or scatter them back if UNPACK is
+ * set, the way an application packs its halos itself.  Device buffers go
+ * through a single pack kernel when the kernels are built, and through one
+ * copy per block otherwise.  The call returns once the data is in place.
+ */
+void dt_pack (char * packed, char * buf, int count, char buf_type, int unpack)
+{
+    struct device_backend const * device = device_backend(options.accel);
+    size_t block = options.dt_block_size;
+    size_t i;
 
-    switch (type) {
-        case WIN_CREATE:
-            MPI_CHECK(MPI_Win_create(*win_base, size, 1, MPI_INFO_NULL, MPI_COMM_WORLD, win));
-            break;
-        case WIN_DYNAMIC:
-            MPI_CHECK(MPI_Win_create_dynamic(MPI_INFO_NULL, MPI_COMM_WORLD, win));
-            MPI_CHECK(MPI_Win_attach(*win, (void *)*win_base, size));
-            MPI_CHECK(MPI_Get_address(*win_base, &disp_local));
-            if(rank == 0){
-                MPI_CHECK(MPI_Send(&disp_local, 1, MPI_AINT, 1, 1, MPI_COMM_WORLD));
-                MPI_CHECK(MPI_Recv(&disp_remote, 1, MPI_AINT, 1, 1, MPI_COMM_WORLD, &reqstat));
+    if ('D' != buf_type && 'M' != buf_type) {
+        for (i = 0; i < (size_t)count; i++) {
+            if (unpack) {
+                memcpy(buf + dt_block_offset(i), packed + i * block, block);
             } else {
-                MPI_CHECK(MPI_Recv(&disp_remote, 1, MPI_AINT, 0, 1, MPI_COMM_WORLD, &reqstat));
-                MPI_CHECK(MPI_Send(&disp_local, 1, MPI_AINT, 0, 1, MPI_COMM_WORLD));
+                memcpy(packed + i * block, buf + dt_block_offset(i), block);
             }
-            break;
-        default:
-            if (purehost) {
-                MPI_CHECK(MPI_Win_allocate(size, 1, MPI_INFO_NULL, MPI_COMM_WORLD, (void*) win_base, win));
+        }
+
+        return;
+    }
+
+#ifdef _ENABLE_OPENACC_
+    if (OPENACC == options.accel) {
+        size_t bytes = count * block;
+        size_t stride = options.dt_stride_size;
+        size_t increase = options.dt_increase_size;
+
+        #pragma acc parallel loop deviceptr(packed, buf)
+        for (i = 0; i < bytes; i++) {
+            size_t b = i / block;
+            size_t offset = b * stride + increase * b * (b - 1) / 2 + i % block;
+
+            if (unpack) {
+                buf[offset] = packed[i];
             } else {
-                MPI_CHECK(MPI_Win_create(*win_base, size, 1, MPI_INFO_NULL, MPI_COMM_WORLD, win));
+                packed[i] = buf[offset];
             }
-            break;
+        }
+
+        return;
     }
-#else
-    MPI_CHECK(MPI_Win_create(*win_base, size, 1, MPI_INFO_NULL, MPI_COMM_WORLD, win));
 #endif
-}
 
-void free_buffer (void * buffer, enum accel_type type)
-{
-    switch (type) {
-        case NONE:
-            free(buffer);
-            break;
-        case MANAGED:
-        case CUDA:
-#ifdef _ENABLE_CUDA_
-            CUDA_CHECK(cudaFree(buffer));
-#endif
-            break;
-        case OPENACC:
-#ifdef _ENABLE_OPENACC_
-            acc_free(buffer);
-#endif
-            break;
-        case ROCM:
-#ifdef _ENABLE_ROCM_
-            ROCM_CHECK(hipFree(buffer));
-#endif
-            break;
+#ifdef _ENABLE_GPU_KERNEL_
+    if (device_kernels(options.accel)) {
+        call_pack_kernel(packed, buf, count, block, options.dt_stride_size,
+                options.dt_increase_size, unpack);
+        kernel_backend()->sync();
+
+        return;
     }
+#endif
 
-    /* Free dummy compute related resources */
-    if (CPU == options.target || BOTH == options.target) {
-        free_host_arrays();
+    if (NULL == device) {
+        return;
     }
 
-    if (GPU == options.target || BOTH == options.target) {
-#ifdef _ENABLE_CUDA_KERNEL_
-        free_device_arrays();
-#endif /* #ifdef _ENABLE_CUDA_KERNEL_ */
+    for (i = 0; i < (size_t)count; i++) {
+        char * blk = buf + dt_block_offset(i);
+        char * pkd = packed + i * block;
+
+        device->memcpy(unpack ? blk : pkd, unpack ? pkd : blk, block,
+                COPY_ON_DEVICE);
     }
+    device->sync();
 }
 
-#if defined(_ENABLE_OPENACC_) || defined(_ENABLE_CUDA_) || defined(_ENABLE_ROCM_)
-int omb_get_local_rank()
+void free_memory_one_sided (void *user_buf, void *win_baseptr, enum WINDOW win_type, MPI_Win win, int rank)
 {
-    char *str = NULL;
-    int local_rank = -1;
-
-    if ((str = getenv("MV2_COMM_WORLD_LOCAL_RANK")) != NULL) {
-        local_rank = atoi(str);
-    } else if ((str = getenv("OMPI_COMM_WORLD_LOCAL_RANK")) != NULL) {
-        local_rank = atoi(str);
-    } else if ((str = getenv("MPI_LOCALRANKID")) != NULL) {
-        local_rank = atoi(str);
-    } else if ((str = getenv("LOCAL_RANK")) != NULL) {
-        local_rank = atoi(str);
+    MPI_CHECK(MPI_Win_free(&win));
+    /* if MPI_Win_allocate is specified, win_baseptr would be freed by MPI_Win_free,
+     * so only need to free the user_buf */
+    if (win_type == WIN_ALLOCATE) {
+        free_memory(user_buf, NULL, rank);
     } else {
-        fprintf(stderr, "Warning: OMB could not identify the local rank of the process.\n");
-        fprintf(stderr, "         This can lead to multiple processes using the same GPU.\n");
-        fprintf(stderr, "         Please use the get_local_rank script in the OMB repo for this.\n");
+        free_memory(user_buf, win_baseptr, rank);
     }
+}
 
-    return local_rank;
+double dummy_compute(double seconds, MPI_Request* request)
+{
+    double test_time = 0.0;
+
+    test_time = do_compute_and_probe(seconds, request);
+
+    return test_time;
 }
-#endif /* defined(_ENABLE_OPENACC_) || defined(_ENABLE_CUDA_) || defined(_ENABLE_ROCM_) */
 
-int init_accel (void)
+#ifdef _ENABLE_GPU_KERNEL_
+/*
+ * Launch a kernel scaled from the calibration to last SECONDS on the device
+ * and return at once, the kernel overlaps with whatever the host does next.
+ */
+void do_compute_gpu(double seconds)
 {
-#ifdef _ENABLE_CUDA_
-    CUresult curesult = CUDA_SUCCESS;
-    CUdevice cuDevice;
-#endif
-#if defined(_ENABLE_OPENACC_) || defined(_ENABLE_CUDA_) || defined(_ENABLE_ROCM_)
-    int local_rank = -1, dev_count = 0;
-    int dev_id = 0;
+    double iters = kernel_iters;
 
-    local_rank = omb_get_local_rank();
+    if (kernel_seconds > 0.0) {
+        iters = kernel_iters * seconds / kernel_seconds;
+    }
+    if (iters < 1) {
+        iters = 1;
+    } else if (iters > MAX_KERNEL_ITERS) {
+        iters = MAX_KERNEL_ITERS;
+    }
+
+    launch_compute((int)iters);
+}
 #endif
 
-    switch (options.accel) {
-#ifdef _ENABLE_CUDA_
-        case MANAGED:
-        case CUDA:
-            if (local_rank >= 0) {
-                CUDA_CHECK(cudaGetDeviceCount(&dev_count));
-                dev_id = local_rank % dev_count;
+/*
+ * Progress thread of -t thread.  It is started on first use and sleeps until
+ * do_compute_and_probe() hands it the request of the collective, then calls
+ * MPI_Test until the request completes or the main thread is done computing.
+ * The main thread only resumes to MPI_Wait once the thread has let go of the
+ * request.
+ */
+enum progress_state {
+    PROGRESS_IDLE,
+    PROGRESS_POLL,
+    PROGRESS_EXIT
+};
+
+static struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    MPI_Request * request;
+    enum progress_state state;
+    int busy;
+    int started;
+} progress = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+static void * progress_thread (void * arg)
+{
+    MPI_Request * request;
+    int flag;
+
+    pthread_mutex_lock(&progress.lock);
+
+    for (;;) {
+        while (PROGRESS_POLL != progress.state || !progress.busy) {
+            if (PROGRESS_EXIT == progress.state) {
+                pthread_mutex_unlock(&progress.lock);
+                return NULL;
             }
-            CUDA_CHECK(cudaSetDevice(dev_id));
 
-            curesult = cuInit(0);
-            if (curesult != CUDA_SUCCESS) {
-                return 1;
+            /* The compute ended before the request was picked up */
+            if (progress.busy) {
+                progress.busy = 0;
+                pthread_cond_broadcast(&progress.cond);
             }
 
-            curesult = cuDeviceGet(&cuDevice, dev_id);
-            if (curesult != CUDA_SUCCESS) {
-                return 1;
-            }
+            pthread_cond_wait(&progress.cond, &progress.lock);
+        }
 
-            curesult = cuDevicePrimaryCtxRetain(&cuContext, cuDevice);
-            if (curesult != CUDA_SUCCESS) {
-                return 1;
-            }
-            break;
-#endif
-#ifdef _ENABLE_OPENACC_
-        case OPENACC:
-            if (local_rank >= 0) {
-                dev_count = acc_get_num_devices(acc_device_not_host);
-                assert(dev_count > 0);
-                dev_id = local_rank % dev_count;
-            }
+        request = progress.request;
+        pthread_mutex_unlock(&progress.lock);
 
-            acc_set_device_num (dev_id, acc_device_not_host);
-            break;
-#endif
-#ifdef _ENABLE_ROCM_
-        case ROCM:
-            if (local_rank >= 0) {
-                ROCM_CHECK(hipGetDeviceCount(&dev_count));
-                dev_id = local_rank % dev_count;
-            }
-            ROCM_CHECK(hipSetDevice(dev_id));
-            break;
-#endif
-        default:
-            fprintf(stderr, "Invalid device type, should be cuda, openacc, or rocm\n");
-            return 1;
+        flag = 0;
+        while (!flag && PROGRESS_POLL ==
+                __atomic_load_n(&progress.state, __ATOMIC_ACQUIRE)) {
+            MPI_CHECK(MPI_Test(request, &flag, MPI_STATUS_IGNORE));
+        }
+
+        pthread_mutex_lock(&progress.lock);
+        progress.busy = 0;
+        pthread_cond_broadcast(&progress.cond);
     }
 
-    return 0;
+    return arg;
 }
 
-int cleanup_accel (void)
+static void start_progress (MPI_Request * request)
 {
-#ifdef _ENABLE_CUDA_
-    CUresult curesult = CUDA_SUCCESS;
-#endif
+    pthread_mutex_lock(&progress.lock);
 
-    switch (options.accel) {
-#ifdef _ENABLE_CUDA_
-        case MANAGED:
-        case CUDA:
-            /* reset the device to release all resources */
-            CUDA_CHECK(cudaDeviceReset());
-            break;
-#endif
-#ifdef _ENABLE_OPENACC_
-        case OPENACC:
-            acc_shutdown(acc_device_nvidia);
-            break;
-#endif
-#ifdef _ENABLE_ROCM_
-        case ROCM:
-            ROCM_CHECK(hipDeviceReset());
-            break;
-#endif
-        default:
-            fprintf(stderr, "Invalid accel type, should be cuda or openacc\n");
-            return 1;
+    if (!progress.started) {
+        progress.state = PROGRESS_IDLE;
+        if (pthread_create(&progress.thread, NULL, progress_thread, NULL)) {
+            fprintf(stderr, "Error creating the progress thread\n");
+            MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE));
+        }
+        progress.started = 1;
     }
 
-    return 0;
+    progress.request = request;
+    progress.busy = 1;
+    __atomic_store_n(&progress.state, PROGRESS_POLL, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&progress.cond);
+
+    pthread_mutex_unlock(&progress.lock);
 }
 
-#ifdef _ENABLE_CUDA_KERNEL_
-void free_device_arrays()
+static void stop_progress (void)
 {
-    if (is_alloc) {
-        CUDA_CHECK(cudaFree(d_x));
-        CUDA_CHECK(cudaFree(d_y));
+    pthread_mutex_lock(&progress.lock);
 
-        is_alloc = 0;
+    __atomic_store_n(&progress.state, PROGRESS_IDLE, __ATOMIC_RELEASE);
+    while (progress.busy) {
+        pthread_cond_wait(&progress.cond, &progress.lock);
     }
+
+    pthread_mutex_unlock(&progress.lock);
 }
-#endif
 
-void free_host_arrays()
+static void join_progress_thread (void)
 {
-    int i = 0;
-
-    if (x) {
-        free(x);
+    if (!progress.started) {
+        return;
     }
-    if (y) {
-        free(y);
+
+    pthread_mutex_lock(&progress.lock);
+    progress.state = PROGRESS_EXIT;
+    pthread_cond_broadcast(&progress.cond);
+    pthread_mutex_unlock(&progress.lock);
+
+    pthread_join(progress.thread, NULL);
+    progress.started = 0;
+}
+
+/*
+ * MPI_Init of the non-blocking collectives.  The progress thread calls
+ * MPI_Test while the main thread is outside of MPI, but MPI_Wtime and the
+ * handover make MPI_THREAD_MULTIPLE the only safe level for it.
+ */
+int init_mpi_nbc (int * argc, char *** argv)
+{
+    int provided = MPI_THREAD_SINGLE, rank, err;
+
+    if (!options.progress_thread) {
+        return MPI_Init(argc, argv);
     }
 
-    if (a) {
-        for (i = 0; i < DIM; i++) {
-            free(a[i]);
+    err = MPI_Init_thread(argc, argv, MPI_THREAD_MULTIPLE, &provided);
+
+    if (MPI_SUCCESS == err && MPI_THREAD_MULTIPLE != provided) {
+        MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
+        if (0 == rank) {
+            fprintf(stderr, "MPI_Init_thread must return MPI_THREAD_MULTIPLE "
+                    "for -t thread!\n");
         }
-        free(a);
+
+        MPI_CHECK(MPI_Finalize());
+        exit(EXIT_FAILURE);
     }
 
-    x = NULL;
-    y = NULL;
-    a = NULL;
+    return err;
 }
 
-void free_memory (void * sbuf, void * rbuf, int rank)
+/*
+ * Throughput lost by the host kernel while overlapping, in percent of its
+ * calibrated chunk time, averaged over the ranks.  Resets the counters.
+ */
+static double host_compute_slowdown (int numprocs)
 {
-    switch (rank) {
-        case 0:
-            if ('D' == options.src || 'M' == options.src) {
-                free_device_buffer(sbuf);
-                free_device_buffer(rbuf);
-            } else {
-                if (sbuf) {
-                    free(sbuf);
-                }
-                if (rbuf) {
-                    free(rbuf);
-                }
-            }
-            break;
-        case 1:
-            if ('D' == options.dst || 'M' == options.dst) {
-                free_device_buffer(sbuf);
-                free_device_buffer(rbuf);
-            } else {
-                if (sbuf) {
-                    free(sbuf);
-                }
-                if (rbuf) {
-                    free(rbuf);
-                }
-            }
-            break;
-    }
+    double slowdown = host_compute_slowdown_local();
+
+    MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &slowdown, 1, MPI_DOUBLE, MPI_SUM,
+                MPI_COMM_WORLD));
+
+    return slowdown / numprocs;
 }
 
-void free_memory_pt2pt_mul (void * sbuf, void * rbuf, int rank, int pairs)
+/*
+ * Window mode of the non-blocking collectives.  Slot k of the window works on
+ * its own stride of the buffers and, with :dup, on its own communicator, so
+ * the library may progress the collectives independently of each other.
+ */
+static MPI_Comm nbc_window_comm[MAX_NBC_WINDOW];
+
+int nbc_window_slots (void)
 {
-    if (rank < pairs) {
-        if ('D' == options.src || 'M' == options.src) {
-            free_device_buffer(sbuf);
-            free_device_buffer(rbuf);
-        } else {
-            free(sbuf);
-            free(rbuf);
+    return (NBC_WINDOW_OFF < options.nbc_window_mode) ? options.nbc_window : 1;
+}
+
+/*
+ * Shrinks the message size so that SCALE times the window fits the memory
+ * limit, then creates the communicators of the slots.
+ */
+void setup_nbc_window (int rank, size_t scale)
+{
+    size_t limit;
+    int k;
+
+    if (NBC_WINDOW_OFF >= options.nbc_window_mode) {
+        return;
+    }
+
+    limit = options.max_mem_limit / (scale * options.nbc_window);
+    if (options.max_message_size > limit) {
+        if (0 == rank) {
+            fprintf(stderr, "Warning! Increase the Max Memory Limit to be able "
+                    "to keep %d collectives of %ld bytes in flight.\n"
+                    "Continuing with max message size of %zu bytes\n",
+                    options.nbc_window, options.max_message_size, limit);
         }
-    } else {
-        if ('D' == options.dst || 'M' == options.dst) {
-            free_device_buffer(sbuf);
-            free_device_buffer(rbuf);
+        options.max_message_size = limit;
+    }
+
+    for (k = 0; k < options.nbc_window; k++) {
+        if (NBC_WINDOW_DUP == options.nbc_window_mode) {
+            MPI_CHECK(MPI_Comm_dup(MPI_COMM_WORLD, &nbc_window_comm[k]));
         } else {
-            free(sbuf);
-            free(rbuf);
+            nbc_window_comm[k] = MPI_COMM_WORLD;
         }
     }
 }
 
-void free_memory_one_sided (void *user_buf, void *win_baseptr, enum WINDOW win_type, MPI_Win win, int rank)
+void free_nbc_window (void)
 {
-    MPI_CHECK(MPI_Win_free(&win));
-    /* if MPI_Win_allocate is specified, win_baseptr would be freed by MPI_Win_free,
-     * so only need to free the user_buf */
-    if (win_type == WIN_ALLOCATE) {
-        free_memory(user_buf, NULL, rank);
-    } else {
-        free_memory(user_buf, win_baseptr, rank);
+    int k;
+
+    if (NBC_WINDOW_DUP != options.nbc_window_mode) {
+        return;
+    }
+
+    for (k = 0; k < options.nbc_window; k++) {
+        MPI_CHECK(MPI_Comm_free(&nbc_window_comm[k]));
     }
 }
 
-double dummy_compute(double seconds, MPI_Request* request)
+static void post_nbc (struct nbc_window_t const * coll, int slot, int count,
+        MPI_Request * request)
 {
-    double test_time = 0.0;
-
-    test_time = do_compute_and_probe(seconds, request);
-
-    return test_time;
+    char * sendbuf = (char *)coll->sendbuf + slot * coll->send_stride;
+    char * recvbuf = (char *)coll->recvbuf + slot * coll->recv_stride;
+    MPI_Comm comm = nbc_window_comm[slot];
+
+    switch (coll->coll) {
+        case NBC_IALLREDUCE:
+            MPI_CHECK(MPI_Iallreduce(sendbuf, recvbuf, count, coll->datatype,
+                        coll->op, comm, request));
+            break;
+        case NBC_IREDUCE:
+            MPI_CHECK(MPI_Ireduce(sendbuf, recvbuf, count, coll->datatype,
+                        coll->op, coll->root, comm, request));
+            break;
+        case NBC_IBCAST:
+            MPI_CHECK(MPI_Ibcast(sendbuf, count, coll->datatype, coll->root,
+                        comm, request));
+            break;
+        case NBC_IALLGATHER:
+            MPI_CHECK(MPI_Iallgather(sendbuf, count, coll->datatype, recvbuf,
+                        count, coll->datatype, comm, request));
+            break;
+        case NBC_IALLTOALL:
+            MPI_CHECK(MPI_Ialltoall(sendbuf, count, coll->datatype, recvbuf,
+                        count, coll->datatype, comm, request));
+            break;
+    }
 }
 
-#ifdef _ENABLE_CUDA_KERNEL_
-void do_compute_gpu(double seconds)
+/*
+ * Posts the whole window back to back and drains it with MPI_Waitany, so the
+ * completion latency of a collective includes the time it spent queued
+ * behind the others.  SIZE is the message size in bytes that is reported.
+ */
+void run_nbc_window (int rank, int numprocs, struct nbc_window_t const * coll,
+        int count, size_t size)
 {
-    double time_elapsed = 0.0, t1 = 0.0, t2 = 0.0;
+    MPI_Request requests[MAX_NBC_WINDOW];
+    double posted[MAX_NBC_WINDOW];
+    double t_start, t_stop, now, op_time;
+    double timer = 0.0, op_total = 0.0, op_max = 0.0;
+    double ops_per_sec, bandwidth, avg_op;
+    int window = options.nbc_window;
+    int i, k, slot;
 
-    {
-        t1 = MPI_Wtime();
+    MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
-        /* Execute Dummy Kernel on GPU if set by user */
-        if (options.target == BOTH || options.target == GPU) {
-            {
-                CUDA_CHECK(cudaStreamCreate(&stream));
-                call_kernel(A, d_x, d_y, options.device_array_size, &stream);
+    for (i = 0; i < options.iterations + options.skip; i++) {
+        t_start = osu_wtime();
+        for (k = 0; k < window; k++) {
+            posted[k] = osu_wtime();
+            post_nbc(coll, k, count, &requests[k]);
+        }
+
+        for (k = 0; k < window; k++) {
+            MPI_CHECK(MPI_Waitany(window, requests, &slot, MPI_STATUS_IGNORE));
+            now = osu_wtime();
+
+            if (i >= options.skip) {
+                op_time = now - posted[slot];
+                op_total += op_time;
+                op_max = MAX(op_max, op_time);
             }
         }
+        t_stop = osu_wtime();
 
-        t2 = MPI_Wtime();
-        time_elapsed += (t2-t1);
+        if (i >= options.skip) {
+            timer += t_stop - t_start;
+        }
+        MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
     }
-}
-#endif
 
-void
-compute_on_host()
-{
-    int i = 0, j = 0;
-    for (i = 0; i < DIM; i++)
-        for (j = 0; j < DIM; j++)
-            x[i] = x[i] + a[i][j]*a[j][i] + y[j];
-}
+    MPI_CHECK(MPI_Reduce(rank ? &timer : MPI_IN_PLACE, &timer, 1, MPI_DOUBLE,
+                MPI_SUM, 0, MPI_COMM_WORLD));
+    MPI_CHECK(MPI_Reduce(rank ? &op_total : MPI_IN_PLACE, &op_total, 1,
+                MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD));
+    MPI_CHECK(MPI_Reduce(rank ? &op_max : MPI_IN_PLACE, &op_max, 1, MPI_DOUBLE,
+                MPI_MAX, 0, MPI_COMM_WORLD));
 
-static inline void do_compute_cpu(double target_seconds)
-{
-    double t1 = 0.0, t2 = 0.0;
-    double time_elapsed = 0.0;
-    while (time_elapsed < target_seconds) {
-        t1 = MPI_Wtime();
-        compute_on_host();
-        t2 = MPI_Wtime();
-        time_elapsed += (t2-t1);
+    if (rank) {
+        return;
     }
-    if (DEBUG) {
-        fprintf(stderr, "time elapsed = %f\n", (time_elapsed * 1e6));
+
+    timer /= numprocs;
+    ops_per_sec = (double)options.iterations * window / timer;
+    bandwidth = ops_per_sec * size / 1e6;
+    avg_op = op_total * 1e6 / numprocs / ((double)options.iterations * window);
+    op_max *= 1e6;
+
+    record_message_size(size, timer * 1e6 / options.iterations);
+
+    if (OUTPUT_TABLE == options.output_format) {
+        fprintf(stdout, "%-*zu%*d%*.*f%*.*f%*.*f%*.*f\n", 10, size, 10, window,
+                FIELD_WIDTH, FLOAT_PRECISION, ops_per_sec,
+                FIELD_WIDTH, FLOAT_PRECISION, bandwidth,
+                FIELD_WIDTH, FLOAT_PRECISION, avg_op,
+                FIELD_WIDTH, FLOAT_PRECISION, op_max);
+        fflush(stdout);
+    } else {
+        struct result_metric_t metrics[5] = {
+            {"window", window},
+            {"ops_per_sec", ops_per_sec},
+            {"bandwidth_MBps", bandwidth},
+            {"avg_op_latency_us", avg_op},
+            {"max_op_latency_us", op_max},
+        };
+
+        output_result(numprocs, size, 5, metrics);
     }
 }
 
+/* Progress callback of do_compute_and_progress() */
+static void test_request (void * request)
+{
+    int flag = 0;
+
+    MPI_CHECK(MPI_Test((MPI_Request *)request, &flag, MPI_STATUS_IGNORE));
+}
+
 double do_compute_and_probe(double seconds, MPI_Request* request)
 {
-    double t1 = 0.0, t2 = 0.0;
     double test_time = 0.0;
-    int num_tests = 0;
     double target_seconds_for_compute = 0.0;
+#ifdef _ENABLE_GPU_KERNEL_
+    double t1 = 0.0, t2 = 0.0;
+    int num_tests = 0;
     int flag = 0;
     MPI_Status status;
+#endif
 
     if (options.num_probes) {
         target_seconds_for_compute = (double) seconds/options.num_probes;
@@ -1518,16 +9018,24 @@ double do_compute_and_probe(double seconds, MPI_Request* request)
         }
     }
 
-#ifdef _ENABLE_CUDA_KERNEL_
+    if (options.progress_thread) {
+        start_progress(request);
+    }
+
+#ifdef _ENABLE_GPU_KERNEL_
+    /*
+     * The kernel runs asynchronously while the host probes, so it is given
+     * the whole compute time rather than one probe interval.
+     */
     if (options.target == GPU) {
         if (options.num_probes) {
             /* Do the dummy compute on GPU only */
-            do_compute_gpu(target_seconds_for_compute);
+            do_compute_gpu(seconds);
             num_tests = 0;
             while (num_tests < options.num_probes) {
-                t1 = MPI_Wtime();
+                t1 = osu_wtime();
                 MPI_CHECK(MPI_Test(request, &flag, &status));
-                t2 = MPI_Wtime();
+                t2 = osu_wtime();
                 test_time += (t2-t1);
                 num_tests++;
             }
@@ -1537,12 +9045,12 @@ double do_compute_and_probe(double seconds, MPI_Request* request)
     } else if (options.target == BOTH) {
         if (options.num_probes) {
             /* Do the dummy compute on GPU and CPU*/
-            do_compute_gpu(target_seconds_for_compute);
+            do_compute_gpu(seconds);
             num_tests = 0;
             while (num_tests < options.num_probes) {
-                t1 = MPI_Wtime();
+                t1 = osu_wtime();
                 MPI_CHECK(MPI_Test(request, &flag, &status));
-                t2 = MPI_Wtime();
+                t2 = osu_wtime();
                 test_time += (t2-t1);
                 num_tests++;
                 do_compute_cpu(target_seconds_for_compute);
@@ -1554,49 +9062,20 @@ double do_compute_and_probe(double seconds, MPI_Request* request)
     } else
 #endif
     if (options.target == CPU) {
-        if (options.num_probes) {
-            num_tests = 0;
-            while (num_tests < options.num_probes) {
-                do_compute_cpu(target_seconds_for_compute);
-                t1 = MPI_Wtime();
-                MPI_CHECK(MPI_Test(request, &flag, &status));
-                t2 = MPI_Wtime();
-                test_time += (t2-t1);
-                num_tests++;
-            }
-        } else {
-            do_compute_cpu(target_seconds_for_compute);
-        }
+        test_time = do_compute_and_progress(seconds, test_request, request);
     }
 
-#ifdef _ENABLE_CUDA_KERNEL_
+#ifdef _ENABLE_GPU_KERNEL_
     if (options.target == GPU || options.target == BOTH) {
-        CUDA_CHECK(cudaDeviceSynchronize());
-        CUDA_CHECK(cudaStreamDestroy(stream));
+        wait_compute();
     }
 #endif
 
-    return test_time;
-}
-
-void allocate_host_arrays()
-{
-    int i=0, j=0;
-    a = (float **)malloc(DIM * sizeof(float *));
-
-    for (i = 0; i < DIM; i++) {
-        a[i] = (float *)malloc(DIM * sizeof(float));
+    if (options.progress_thread) {
+        stop_progress();
     }
 
-    x = (float *)malloc(DIM * sizeof(float));
-    y = (float *)malloc(DIM * sizeof(float));
-
-    for (i = 0; i < DIM; i++) {
-        x[i] = y[i] = 1.0f;
-        for (j = 0; j < DIM; j++) {
-            a[i][j] = 2.0f;
-        }
-    }
+    return test_time;
 }
 
 void allocate_atomic_memory(int rank,
@@ -1719,6 +9198,50 @@ void free_atomic_memory (void *sbuf, void *win_baseptr, void *tbuf, void *cbuf,
     }
 }
 
+#ifdef _ENABLE_GPU_KERNEL_
+/*
+ * The arrays keep the size given with -a and the kernel iterations are
+ * scaled instead, timing each try with events on the device so that the
+ * launch overhead on the host does not count as compute.
+ */
+static void calibrate_device_compute (double target_time)
+{
+    double elapsed = 0.0;
+
+    if (!is_alloc) {
+        allocate_device_arrays(options.device_array_size);
+    }
+
+    /* Warm up the kernel once before timing it */
+    time_compute(1);
+
+    kernel_iters = 1;
+    elapsed = time_compute(kernel_iters);
+
+    while (elapsed < target_time && kernel_iters < MAX_KERNEL_ITERS) {
+        double scale = 1024.0;
+
+        if (elapsed > 0.0 && target_time / elapsed < scale) {
+            scale = target_time / elapsed;
+        }
+        if (kernel_iters * scale >= MAX_KERNEL_ITERS) {
+            kernel_iters = MAX_KERNEL_ITERS;
+        } else {
+            kernel_iters = (int)(kernel_iters * scale) + 1;
+        }
+
+        elapsed = time_compute(kernel_iters);
+    }
+
+    kernel_seconds = elapsed;
+
+    if (DEBUG) {
+        fprintf(stderr, "kernel iterations = %d, kernel time = %f\n",
+                kernel_iters, kernel_seconds * 1e6);
+    }
+}
+#endif
+
 void init_arrays(double target_time)
 {
 
@@ -1727,62 +9250,78 @@ void init_arrays(double target_time)
                 (target_time * 1e6));
     }
 
-#ifdef _ENABLE_CUDA_KERNEL_
-    if (options.target == GPU || options.target == BOTH) {
-    /* Setting size of arrays for Dummy Compute */
-    int N = options.device_array_size;
-
-    /* Device Arrays for Dummy Compute */
-    allocate_device_arrays(N);
+    if (options.target == CPU || options.target == BOTH) {
+        calibrate_host_compute();
+    }
 
-    double t1 = 0.0, t2 = 0.0;
+#ifdef _ENABLE_GPU_KERNEL_
+    if (options.target == GPU || options.target == BOTH) {
+        calibrate_device_compute(target_time);
+    }
+#endif
 
-    while (1) {
-        t1 = MPI_Wtime();
+}
 
-        if (options.target == GPU || options.target == BOTH) {
-            CUDA_CHECK(cudaStreamCreate(&stream));
-            call_kernel(A, d_x, d_y, N, &stream);
+/*
+ * Device Load
+ *
+ * osu_bw_pipeline keeps the GPU busy while it transfers, with the dummy
+ * compute kernel of the non-blocking collectives on -a floats, launched on
+ * one of their compute streams so that it does not serialize with the
+ * streams of the MPI library.  setup_device_load() calibrates the kernel
+ * once, start_device_load() launches it scaled to SECONDS and returns at
+ * once, stop_device_load() waits for it.  Without GPU kernel support
+ * setup_device_load() fails and the others are no-ops.
+ */
+int setup_device_load (void)
+{
+#ifdef _ENABLE_GPU_KERNEL_
+    if (!device_kernels(options.accel) || MANAGED == options.accel) {
+        return 1;
+    }
 
-            CUDA_CHECK(cudaDeviceSynchronize());
-            CUDA_CHECK(cudaStreamDestroy(stream));
-        }
+    calibrate_device_compute(DEVICE_LOAD_CALIBRATION);
 
-        t2 = MPI_Wtime();
-        if ((t2-t1) < target_time)
-        {
-            N += 32;
+    return 0;
+#else
+    return 1;
+#endif
+}
 
-            /* Now allocate arrays of size N */
-            allocate_device_arrays(N);
-        } else {
-            break;
-        }
-    }
+void start_device_load (double seconds)
+{
+#ifdef _ENABLE_GPU_KERNEL_
+    do_compute_gpu(seconds);
+#endif
+}
 
-    /* we reach here with desired N so save it and pass it to options */
-    options.device_array_size = N;
-    if (DEBUG) {
-        fprintf(stderr, "correct N = %d\n", N);
-        }
-    }
+void stop_device_load (void)
+{
+#ifdef _ENABLE_GPU_KERNEL_
+    wait_compute();
 #endif
+}
 
+void cleanup_device_load (void)
+{
+#ifdef _ENABLE_GPU_KERNEL_
+    free_device_arrays();
+#endif
 }
 
-#ifdef _ENABLE_CUDA_KERNEL_
+#ifdef _ENABLE_GPU_KERNEL_
 void allocate_device_arrays(int n)
 {
     /* First free the old arrays */
     free_device_arrays();
 
     /* Allocate Device Arrays for Dummy Compute */
-    CUDA_CHECK(cudaMalloc((void**)&d_x, n * sizeof(float)));
-
-    CUDA_CHECK(cudaMalloc((void**)&d_y, n * sizeof(float)));
+    kernel_backend()->alloc((void **)&d_x, n * sizeof(float), 0);
+    kernel_backend()->alloc((void **)&d_y, n * sizeof(float), 0);
 
-    CUDA_CHECK(cudaMemset(d_x, 1.0f, n));
-    CUDA_CHECK(cudaMemset(d_y, 2.0f, n));
+    kernel_backend()->memset(d_x, 1, n);
+    kernel_backend()->memset(d_y, 2, n);
+    create_compute_streams();
     is_alloc = 1;
 }
 #endif
@@ -23,9 +23,35 @@ do {                                                             \
    assert(MPI_SUCCESS == mpi_errno);                             \
 } while (0)
 
+/*
+ * Persistent collectives are part of MPI-4; Open MPI 4.x provides them with an
+ * MPIX_ prefix through its pcollreq extension.
+ */
+#if MPI_VERSION < 4 && defined(OPEN_MPI) && OPEN_MPI
+#include <mpi-ext.h>
+#endif
+
+#if MPI_VERSION < 4 && defined(OMPI_HAVE_MPI_EXT_PCOLLREQ)
+#define MPI_Allgather_init  MPIX_Allgather_init
+#define MPI_Allreduce_init  MPIX_Allreduce_init
+#define MPI_Alltoall_init   MPIX_Alltoall_init
+#define MPI_Barrier_init    MPIX_Barrier_init
+#define MPI_Bcast_init      MPIX_Bcast_init
+#define MPI_Gather_init     MPIX_Gather_init
+#define MPI_Reduce_init     MPIX_Reduce_init
+#define MPI_Scatter_init    MPIX_Scatter_init
+#endif
+
 extern MPI_Aint disp_remote;
 extern MPI_Aint disp_local;
 
+/*
+ * Timers
+ *
+ * osu_wtime() is MPI_Wtime by default and the clock of --timer otherwise.
+ */
+double osu_wtime (void);
+
 /*
  * Non-blocking Collectives
  */
@@ -34,10 +60,49 @@ void allocate_device_arrays(int n);
 double dummy_compute(double target_secs, MPI_Request *request);
 void init_arrays(double seconds);
 double do_compute_and_probe(double seconds, MPI_Request *request);
+int init_mpi_nbc (int * argc, char *** argv);
 void free_host_arrays();
 
+enum nbc_coll {
+    NBC_IALLREDUCE,
+    NBC_IREDUCE,
+    NBC_IBCAST,
+    NBC_IALLGATHER,
+    NBC_IALLTOALL
+};
+
+/* One collective of the -W window, slot k uses the buffers at k * stride */
+struct nbc_window_t {
+    enum nbc_coll coll;
+    void * sendbuf;
+    void * recvbuf;
+    size_t send_stride;
+    size_t recv_stride;
+    MPI_Datatype datatype;
+    MPI_Op op;
+    int root;
+};
+
+int nbc_window_slots (void);
+void setup_nbc_window (int rank, size_t scale);
+void free_nbc_window (void);
+void run_nbc_window (int rank, int numprocs, struct nbc_window_t const * coll,
+        int count, size_t size);
+
 #ifdef _ENABLE_CUDA_KERNEL_
-extern void call_kernel(float a, float *d_x, float *d_y, int N, cudaStream_t *stream);
+extern void call_kernel(float a, float *d_x, float *d_y, int N, int iters,
+                        cudaStream_t *stream);
+#elif defined(_ENABLE_ROCM_KERNEL_)
+extern void call_kernel(float a, float *d_x, float *d_y, int N, int iters,
+                        hipStream_t *stream);
+#endif
+#ifdef _ENABLE_GPU_KERNEL_
+extern void call_check_kernel(void const *buf, int data, size_t size,
+                              unsigned long long *d_errors);
+extern void call_pack_kernel(char *packed, char *buf, int count, size_t block,
+                             size_t stride, size_t increase, int unpack);
+extern int call_reduce_kernel(void const *in, void *inout, size_t count,
+                              int dtype, int op);
 void free_device_arrays();
 #endif
 
@@ -52,21 +117,319 @@ void print_preamble_nbc (int rank);
 void print_stats (int rank, int size, double avg, double min, double max);
 void print_stats_nbc (int rank, int size, double ovrl, double cpu, double comm,
                       double wait, double init, double test);
+void hist_reduce (int rank, struct latency_hist_t * hist);
+
+/*
+ * Iteration Control
+ *
+ * Loop condition for the timed loop of the blocking collectives, where I
+ * counts warmup and timed iterations.  In convergence mode it is collective
+ * and, once it returns 0, options.iterations holds the number of timed
+ * iterations that were run.
+ */
+int continue_iterations (int i);
+
+/*
+ * Topology and Pairing
+ */
+int setup_pairing (int rank, int nprocs, int max_pairs);
+void reduce_by_locality (double value, double * sums);
+
+/*
+ * Clock Offset
+ */
+double estimate_clock_offset (int peer, int rounds);
+
+/*
+ * Global Clock
+ */
+enum global_event {
+    GT_SEND,
+    GT_RECV,
+    GT_NUM,
+    GT_ENTRY = GT_SEND,
+    GT_EXIT = GT_RECV
+};
+
+void sync_global_clock (void);
+double global_wtime (void);
+double to_global_time (double t);
+int setup_global_clock (int rank);
+void start_global_clock (void);
+void mark_global_time (enum global_event event, int i);
+void stop_global_clock (int iterations);
+void cleanup_global_clock (void);
+
+/*
+ * Send Modes
+ */
+int setup_send_mode (int rank, size_t bytes, int count);
+void drain_send_mode (void);
+void mode_isend (void *buf, int count, MPI_Datatype type, int dest, int tag,
+        MPI_Comm comm, MPI_Request *request);
+void mode_send (void *buf, int count, MPI_Datatype type, int dest, int tag,
+        MPI_Comm comm, MPI_Request *request);
+void cleanup_send_mode (void);
+
+/*
+ * Streaming
+ */
+int setup_stream (int rank);
+int stream_step (int i, double bytes, MPI_Comm comm);
+void report_stream (int rank, size_t size);
+void cleanup_stream (void);
+
+/*
+ * MPI-IO
+ */
+int setup_io (int rank, MPI_File *fh);
+void set_io_view (MPI_File fh, int rank, int nprocs, size_t size);
+void print_io_header (int rank, int nprocs, MPI_File fh);
+void report_io (int rank, int nprocs, size_t size, double latency);
+void cleanup_io (MPI_File *fh);
+
+/*
+ * Managed Memory Residency
+ */
+void advise_residency (void * buffer, size_t size,
+        enum residency_state state, int set);
+double prepare_residency (void * buffer, size_t size,
+        enum residency_state state);
+
+/*
+ * Device Peer Copies
+ */
+enum peer_copy {
+    PEER_COPY_PEER,
+    PEER_COPY_IPC,
+    PEER_COPY_NUM
+};
+
+int setup_peer_copy (int rank, size_t size);
+int peer_copy_available (enum peer_copy path);
+int peer_access_enabled (void);
+double time_peer_copy (enum peer_copy path, void const * s_buf, size_t size);
+void free_peer_copy (int rank);
+
+/*
+ * Device Load
+ */
+int setup_device_load (void);
+void start_device_load (double seconds);
+void stop_device_load (void);
+void cleanup_device_load (void);
+
+/*
+ * Large Count
+ */
+int setup_large_count (int rank);
+char const * large_count_path (size_t bytes);
+void large_count_isend (void * buf, size_t bytes, int dest, int tag,
+        MPI_Comm comm, MPI_Request * request);
+void large_count_irecv (void * buf, size_t bytes, int source, int tag,
+        MPI_Comm comm, MPI_Request * request);
+void large_count_bcast (void * buf, size_t bytes, int root, MPI_Comm comm);
+size_t large_count_memory_limit (MPI_Comm comm, int buffers);
+
+/*
+ * Back to Back Collectives
+ */
+int setup_back_to_back (int rank);
+int back_to_back_passes (void);
+void start_back_to_back (int pass);
+void back_to_back_delay (int pass);
+void stop_back_to_back (int pass, int count);
+
+/*
+ * Arrival Skew
+ */
+int setup_arrival_skew (int rank);
+void start_arrival_skew (void);
+void arrival_delay (void);
+void record_arrival (int i, double t_start, double t_stop);
+void stop_arrival_skew (void);
+void cleanup_arrival_skew (void);
+
+/*
+ * Count Distributions
+ */
+int setup_count_distribution (int rank, int numprocs);
+size_t count_buffer_size (int numprocs);
+size_t set_counts (int rank, int numprocs, size_t size, int * sendcounts,
+                   int * sdispls, int * recvcounts, int * rdispls);
+void print_count_summary (void);
+void cleanup_count_distribution (void);
+
+/*
+ * Outlier Ranks
+ */
+void setup_rank_outliers (void);
+void reduce_rank_outliers (int rank);
+void print_rank_outliers (FILE * out, int size);
+
+/*
+ * Performance Variables
+ */
+int setup_pvars (int rank);
+void start_pvars (void);
+void stop_pvars (void);
+void cleanup_pvars (void);
+
+/*
+ * Hardware Counters
+ */
+int setup_counters (int rank);
+void start_counters (void);
+void stop_counters (double iterations);
+void cleanup_counters (void);
+
+/*
+ * Control Variable Tuning
+ */
+int setup_tuning (int rank);
+int num_tune_settings (void);
+MPI_Comm apply_tune_setting (int setting);
+int record_tune_result (int setting, double value);
+double finish_tune_size (size_t size);
+void print_tuning_table (int rank);
+void cleanup_tuning (void);
+
+/*
+ * Memory Footprint
+ */
+enum mem_point {
+    MEM_BEFORE_INIT,
+    MEM_AFTER_INIT,
+    MEM_AFTER_ALLOC,
+    MEM_AFTER_SIZE
+};
+
+void mem_footprint_sample (enum mem_point point, size_t size);
+void mem_footprint_report (int rank);
+
+/*
+ * CPU and Memory Affinity
+ */
+int setup_affinity (void);
+void bind_thread (int id);
+int bind_memory (void * buf, size_t size);
+
+/*
+ * Reductions
+ */
+MPI_Datatype reduction_datatype (void);
+MPI_Op reduction_op (void);
+size_t reduction_extent (void);
+void free_reduction_op (void);
+void print_reduction_summary (void);
+int reduction_reference (void const * in, void * inout, int count);
+int reduction_kernel (void const * in, void * inout, int count);
+
+/*
+ * Hierarchical Collectives
+ */
+int setup_hierarchy (size_t size, int with_slots);
+void cleanup_hierarchy (void);
+void hier_allreduce (void const * sendbuf, void * recvbuf, int count,
+        MPI_Datatype datatype, MPI_Op op);
+void hier_bcast (void * buffer, size_t size);
+void print_hierarchy_summary (void);
+
+/*
+ * Pipelined Collectives
+ */
+void pipelined_allreduce (void const * sendbuf, void * recvbuf, int count,
+        MPI_Datatype datatype, MPI_Op op);
+void pipelined_bcast (void * buffer, size_t size);
+
+/*
+ * Neighborhood Collectives
+ */
+MPI_Comm setup_stencil (void);
+int stencil_neighbors (void);
+size_t stencil_layout (size_t size, int * counts, int * displs);
+void p2p_halo_exchange (void const * sendbuf, void * recvbuf,
+        int const * counts, int const * displs);
+void cleanup_stencil (void);
+void print_stencil_summary (void);
+
+/*
+ * NCCL/RCCL Backend
+ */
+enum nccl_coll {
+    NCCL_ALLREDUCE,
+    NCCL_REDUCE,
+    NCCL_BCAST,
+    NCCL_ALLGATHER,
+    NCCL_ALLTOALL
+};
+
+int init_nccl (void);
+void cleanup_nccl (void);
+double nccl_collective (enum nccl_coll coll, void const * sendbuf,
+        void * recvbuf, size_t count, MPI_Datatype datatype, MPI_Op op,
+        int root);
 
 /*
  * Memory Management
  */
 int allocate_memory_coll (void ** buffer, size_t size, enum accel_type type);
 void free_buffer (void * buffer, enum accel_type type);
+void set_buffer_pool (int enable);
+void print_buffer_pool_summary (int rank);
+int allocate_host_buffer (void ** buffer, size_t size);
+void free_host_buffer (void * buffer);
+int allocate_rotating_buffer (void ** buffer, size_t size, enum accel_type type);
+void * rotate_buffer (void * buffer, size_t size, int iteration);
 void set_buffer (void * buffer, enum accel_type type, int data, size_t size);
 void set_buffer_pt2pt (void * buffer, int rank, enum accel_type type, int data, size_t size);
+size_t check_buffer_pt2pt (void * buffer, int rank, enum accel_type type, int data, size_t size);
+size_t validate_pt2pt (void * s_buf, void * r_buf, size_t size, int rank);
 
 /*
- * CUDA Context Management
+ * Device Backends
+ *
+ * Every accelerator of -d is a table of the operations the benchmarks need
+ * on device memory, so that the buffer management does not switch on the
+ * accelerator at every call.  The SYCL backend drives the Intel GPUs with
+ * Level Zero, whose USM pointers are what SYCL and the MPI libraries take.
+ * Streams are opaque: CUDA and HIP streams, OpenACC async queues and Level
+ * Zero immediate command lists.
  */
+enum device_copy {
+    COPY_TO_HOST,
+    COPY_TO_DEVICE,
+    COPY_ON_DEVICE
+};
+
+struct device_backend {
+    char const * name;
+    int (*device_count)(int * count);
+    int (*set_device)(int dev);
+    int (*bus_id)(int dev, char * bus_id, int len);
+    int (*finalize)(void);
+    int (*alloc)(void ** buffer, size_t size, int managed);
+    void (*release)(void * buffer);
+    void (*memset)(void * buffer, int data, size_t size);
+    void (*memcpy)(void * dest, void const * src, size_t size,
+            enum device_copy kind);
+    void (*sync)(void);
+    void (*stream_create)(void ** stream);
+    void (*stream_sync)(void * stream);
+    void (*stream_destroy)(void * stream);
+};
+
+/* Backend of TYPE, NULL for host memory and accelerators not built in */
+struct device_backend const * device_backend (enum accel_type type);
+
 int init_accel (void);
 int cleanup_accel (void);
+int rebind_accel (void);
 
+extern double hierarchical_latency;
+extern double pipelined_latency;
+extern double p2p_halo_latency;
+extern double persistent_init_latency;
 extern MPI_Request request[MAX_REQ_NUM];
 extern MPI_Status  reqstat[MAX_REQ_NUM];
 extern MPI_Request send_request[MAX_REQ_NUM];
@@ -78,6 +441,10 @@ int allocate_memory_pt2pt_mul (char **sbuf, char **rbuf, int rank, int pairs);
 void print_header_pt2pt (int rank, int type);
 void free_memory (void *sbuf, void *rbuf, int rank);
 void free_memory_pt2pt_mul (void *sbuf, void *rbuf, int rank, int pairs);
+int create_dt_type (int size, MPI_Datatype *type);
+int allocate_dt_pack_buffer (char **buffer, char buf_type);
+void free_dt_pack_buffer (char *buffer, char buf_type);
+void dt_pack (char *packed, char *buf, int count, char buf_type, int unpack);
 void print_header(int rank, int full);
 void usage_one_sided (char const *);
 void print_header_one_sided (int, enum WINDOW, enum SYNC);
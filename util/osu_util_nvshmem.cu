@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+#include "osu_util_nvshmem.h"
+
+#define NVSHMEM_CUDA_CHECK(stmt)                                        \
+do {                                                                    \
+   cudaError_t cuda_err = (stmt);                                       \
+   if (cudaSuccess != cuda_err) {                                       \
+       fprintf(stderr, "[%s:%d] CUDA call '%s' failed with %d: %s \n",  \
+        __FILE__, __LINE__, #stmt, cuda_err,                            \
+        cudaGetErrorString(cuda_err));                                  \
+       exit(EXIT_FAILURE);                                              \
+   }                                                                    \
+} while (0)
+
+static char const * scope_names[SCOPE_NUM] = {"thread", "warp", "block"};
+static int const scope_threads[SCOPE_NUM] = {1, 32, NVSHMEM_BLOCK_THREADS};
+
+void init_nvshmem (int * mype, int * npes)
+{
+    nvshmem_init();
+
+    *mype = nvshmem_my_pe();
+    *npes = nvshmem_n_pes();
+
+    NVSHMEM_CUDA_CHECK(cudaSetDevice(nvshmem_team_my_pe(NVSHMEMX_TEAM_NODE)));
+}
+
+char const * device_scope_name (enum device_scope scope)
+{
+    return scope_names[scope];
+}
+
+/* Nanoseconds of the global timer, common to the SMs of the GPU */
+static __device__ inline unsigned long long global_timer (void)
+{
+    unsigned long long t;
+
+    asm volatile("mov.u64 %0, %%globaltimer;" : "=l"(t));
+
+    return t;
+}
+
+/*
+ * One operation at SCOPE, by the first thread, the first warp or the whole
+ * block of the kernel
+ */
+static __device__ inline void device_op (int op, int scope, void * dest,
+        void const * src, size_t size, int peer, int nbi)
+{
+    switch (scope) {
+        case SCOPE_THREAD:
+            if (0 != threadIdx.x) {
+                break;
+            }
+
+            if (DEVICE_PUT == op) {
+                nbi ? nvshmem_putmem_nbi(dest, src, size, peer) :
+                    nvshmem_putmem(dest, src, size, peer);
+            } else {
+                nbi ? nvshmem_getmem_nbi(dest, src, size, peer) :
+                    nvshmem_getmem(dest, src, size, peer);
+            }
+            break;
+        case SCOPE_WARP:
+            if (threadIdx.x >= warpSize) {
+                break;
+            }
+
+            if (DEVICE_PUT == op) {
+                nbi ? nvshmemx_putmem_nbi_warp(dest, src, size, peer) :
+                    nvshmemx_putmem_warp(dest, src, size, peer);
+            } else {
+                nbi ? nvshmemx_getmem_nbi_warp(dest, src, size, peer) :
+                    nvshmemx_getmem_warp(dest, src, size, peer);
+            }
+            break;
+        default:
+            if (DEVICE_PUT == op) {
+                nbi ? nvshmemx_putmem_nbi_block(dest, src, size, peer) :
+                    nvshmemx_putmem_block(dest, src, size, peer);
+            } else {
+                nbi ? nvshmemx_getmem_nbi_block(dest, src, size, peer) :
+                    nvshmemx_getmem_block(dest, src, size, peer);
+            }
+            break;
+    }
+}
+
+/*
+ * ITERS rounds of WINDOW operations, each round completed by the first
+ * thread with nvshmem_quiet, and in ELAPSED the nanoseconds they took
+ */
+static __global__ void device_ops_kernel (int op, int scope, void * dest,
+        void const * src, size_t size, int peer, int window, int iters,
+        unsigned long long * elapsed)
+{
+    unsigned long long t_start = global_timer();
+    int i, j;
+
+    for (i = 0; i < iters; i++) {
+        for (j = 0; j < window; j++) {
+            device_op(op, scope, dest, src, size, peer, window > 1);
+        }
+
+        __syncthreads();
+        if (0 == threadIdx.x) {
+            nvshmem_quiet();
+        }
+        __syncthreads();
+    }
+
+    if (0 == threadIdx.x) {
+        *elapsed = global_timer() - t_start;
+    }
+}
+
+void time_device_ops (enum device_op op, enum device_scope scope,
+        void * dest, void const * src, size_t size, int peer, int window,
+        double * kernel, double * host)
+{
+    static unsigned long long * elapsed = NULL;
+    unsigned long long ns;
+    double t_start;
+
+    if (NULL == elapsed) {
+        NVSHMEM_CUDA_CHECK(cudaMalloc((void **)&elapsed, sizeof(*elapsed)));
+    }
+
+    if (options.skip) {
+        device_ops_kernel<<<1, scope_threads[scope]>>>(op, scope, dest, src,
+                size, peer, window, options.skip, elapsed);
+        NVSHMEM_CUDA_CHECK(cudaGetLastError());
+        NVSHMEM_CUDA_CHECK(cudaDeviceSynchronize());
+    }
+
+    t_start = TIME();
+    device_ops_kernel<<<1, scope_threads[scope]>>>(op, scope, dest, src,
+            size, peer, window, options.iterations, elapsed);
+    NVSHMEM_CUDA_CHECK(cudaGetLastError());
+    NVSHMEM_CUDA_CHECK(cudaDeviceSynchronize());
+    *host = (TIME() - t_start) / options.iterations;
+
+    NVSHMEM_CUDA_CHECK(cudaMemcpy(&ns, elapsed, sizeof(ns),
+                cudaMemcpyDeviceToHost));
+    *kernel = ns / 1e3 / options.iterations;
+}
+
+void print_header_nvshmem (int mype)
+{
+    if (0 != mype) {
+        return;
+    }
+
+    fprintf(stdout, benchmark_header, "");
+    fprintf(stdout, "# Window size: %d, %d threads per block\n",
+            options.window_size, NVSHMEM_BLOCK_THREADS);
+    fprintf(stdout, "%-*s%*s%*s%*s%*s%*s\n", 10, "# Size", 8, "Scope",
+            FIELD_WIDTH, "Kernel Lat(us)", FIELD_WIDTH, "Host Lat(us)",
+            FIELD_WIDTH, "Kernel BW(MB/s)", FIELD_WIDTH, "Host BW(MB/s)");
+    fflush(stdout);
+}
+
+void print_data_nvshmem (int mype, size_t size, enum device_scope scope,
+        double kernel_latency, double host_latency, double kernel_bw,
+        double host_bw)
+{
+    if (0 != mype) {
+        return;
+    }
+
+    fprintf(stdout, "%-*zu%*s%*.*f%*.*f%*.*f%*.*f\n", 10, size, 8,
+            device_scope_name(scope), FIELD_WIDTH, FLOAT_PRECISION,
+            kernel_latency, FIELD_WIDTH, FLOAT_PRECISION, host_latency,
+            FIELD_WIDTH, FLOAT_PRECISION, kernel_bw, FIELD_WIDTH,
+            FLOAT_PRECISION, host_bw);
+    fflush(stdout);
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
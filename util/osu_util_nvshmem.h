@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2002-2021 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * GPU-initiated communication of the NVSHMEM benchmarks, compiled by nvcc
+ * with relocatable device code.  The utilities are C, hence the linkage.
+ */
+
+#include <nvshmem.h>
+#include <nvshmemx.h>
+
+extern "C" {
+#include "osu_util_pgas.h"
+}
+
+/* Threads of the kernel that issues the block-level operations */
+#define NVSHMEM_BLOCK_THREADS 256
+
+/*
+ * Group of threads that issues every operation: a single thread with
+ * nvshmem_putmem, a warp with nvshmemx_putmem_warp or a thread block with
+ * nvshmemx_putmem_block, and the same for the gets.
+ */
+enum device_scope {
+    SCOPE_THREAD,
+    SCOPE_WARP,
+    SCOPE_BLOCK,
+    SCOPE_NUM
+};
+
+enum device_op {
+    DEVICE_PUT,
+    DEVICE_GET
+};
+
+/*
+ * Initialize NVSHMEM and select the GPU of the PE by its rank on the node,
+ * before any symmetric allocation.
+ */
+void init_nvshmem(int * mype, int * npes);
+char const * device_scope_name(enum device_scope scope);
+
+/*
+ * Time options.iterations rounds of WINDOW operations of SIZE bytes between
+ * DEST and SRC on PEER, issued from a kernel at SCOPE and completed with
+ * nvshmem_quiet at the end of every round, after options.skip untimed
+ * rounds.  The operations are blocking for a WINDOW of 1 and non-blocking
+ * otherwise.  KERNEL receives the microseconds per round that the kernel
+ * measured with the GPU global timer, HOST those that the host observed from
+ * the launch to the completion of the kernel, launch overhead included.
+ */
+void time_device_ops(enum device_op op, enum device_scope scope, void * dest,
+        void const * src, size_t size, int peer, int window, double * kernel,
+        double * host);
+
+/*
+ * Print the column headers, and one row of latencies in microseconds and
+ * bandwidths in MB/s of SCOPE, on PE 0
+ */
+void print_header_nvshmem(int mype);
+void print_data_nvshmem(int mype, size_t size, enum device_scope scope,
+        double kernel_latency, double host_latency, double kernel_bw,
+        double host_bw);
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -19,8 +19,19 @@ void usage_oshm_pt2pt(int myid)
 
 void print_header_pgas (const char *header, int rank, int full)
 {
-    if(rank == 0) {
+    set_header(header);
+
+    if(rank == 0 && OUTPUT_TABLE == options.output_format) {
         fprintf(stdout, header, "");
+        print_timer_summary();
+
+        if (PGAS_SYNC_NONE != options.sync_in) {
+            static char const * sync_name[] = {"", "all", "my", "no"};
+
+            fprintf(stdout, "# Sync: %s:%s, %d chained collective(s) per "
+                    "iteration\n", sync_name[options.sync_in],
+                    sync_name[options.sync_out], options.pgas_chain);
+        }
 
         if (options.show_size) {
             fprintf(stdout, "%-*s", 10, "# Size");
@@ -48,6 +59,23 @@ void print_header_pgas (const char *header, int rank, int full)
 void print_data_pgas (int rank, int full, int size, double avg_time, double
 min_time, double max_time, int iterations)
 {
+    if(rank == 0) {
+        struct result_metric_t metrics[] = {
+            {"avg_latency_us", avg_time},
+            {"min_latency_us", min_time},
+            {"max_latency_us", max_time},
+            {"iterations", iterations},
+        };
+
+        if (OUTPUT_TABLE != options.output_format) {
+            output_result(benchmark_num_ranks, size, full ? 4 : 1, metrics);
+            return;
+        }
+
+        compare_baseline(benchmark_num_ranks, size, full ? 4 : 1, metrics);
+        checkpoint_result(benchmark_num_ranks, size, full ? 4 : 1, metrics);
+    }
+
     if(rank == 0) {
         if (size) {
             fprintf(stdout, "%-*d", 10, size);
@@ -77,16 +105,29 @@ void print_usage_pgas(int rank, const char * prog, int has_size)
 {
     if (rank == 0) {
         if (has_size) {
-            fprintf(stdout, " USAGE : %s [-m SIZE] [-i ITER] [-f] [-hv] [-M SIZE]\n", prog);
+            fprintf(stdout, " USAGE : %s [-m SIZE] [-i ITER] [-x ITER] [-f] [-hv] [-M SIZE]%s\n", prog,
+                    PGAS_SYNC_NONE != options.sync_in ? " [-s IN:OUT] [-W N]" : "");
             fprintf(stdout, "  -m, --message-size : Set maximum message size to SIZE.\n");
             fprintf(stdout, "                       By default, the value of SIZE is 1MB.\n");
             fprintf(stdout, "  -i, --iterations   : Set number of iterations per message size to ITER.\n");
             fprintf(stdout, "                       By default, the value of ITER is 1000 for small messages\n");
             fprintf(stdout, "                       and 100 for large messages.\n");
+            fprintf(stdout, "  -x, --warmup       : Set number of warmup iterations per message size to ITER.\n");
+            fprintf(stdout, "                       By default, the value of ITER is 200 for small messages\n");
+            fprintf(stdout, "                       and 10 for large messages.\n");
             fprintf(stdout, "  -M, --mem-limit    : Set maximum memory consumption (per process) to SIZE. \n");
             fprintf(stdout, "                       By default, the value of SIZE is 512MB.\n");
         }
 
+        if (PGAS_SYNC_NONE != options.sync_in) {
+            fprintf(stdout, "  -s, --sync-option  : Synchronize the timed collectives as IN:OUT, each of\n");
+            fprintf(stdout, "                       all, my or no (UPC_IN_ALLSYNC ... UPC_OUT_NOSYNC).\n");
+            fprintf(stdout, "                       By default, the mode is all:all.\n");
+            fprintf(stdout, "  -W, --window-size  : Chain N collectives back to back per iteration\n");
+            fprintf(stdout, "                       (max %d), closed by one upc_barrier, and report\n", MAX_PGAS_CHAIN);
+            fprintf(stdout, "                       the time per collective.  By default, N is 1.\n");
+        }
+
         else {
             fprintf(stdout, " USAGE : %s [-i ITER] [-f] [-hv] \n", prog);
             fprintf(stdout, "  -i, --iterations   : Set number of iterations to ITER.\n");
@@ -97,6 +138,100 @@ void print_usage_pgas(int rank, const char * prog, int has_size)
         fprintf(stdout, "                      the MIN/MAX latency and number of ITERATIONS are\n");
         fprintf(stdout, "                      printed out in addition to the AVERAGE latency.\n");
 
+        fprintf(stdout, "  -F, --output-format: Print results as FORMAT: table (default), csv or\n");
+        fprintf(stdout, "                       json (one object per line).\n");
+        fprintf(stdout, "  --timer NAME       : Clock of the timed loops: default (gettimeofday),\n");
+        fprintf(stdout, "                       monotonic (CLOCK_MONOTONIC_RAW) or cycles.\n");
+        fprintf(stdout, "  --baseline FILE    : Compare the results with the csv or json results in\n");
+        fprintf(stdout, "                       FILE and exit with an error on regressions.\n");
+        fprintf(stdout, "  --tolerance PCT    : Slowdown tolerated by --baseline (default %.0f%%).\n",
+                DEF_BASELINE_TOLERANCE);
+        fprintf(stdout, "  --fit              : Fit alpha-beta parameters per protocol regime to\n");
+        fprintf(stdout, "                       the results and print them at the end.\n");
+        fprintf(stdout, "  --checkpoint FILE  : Append the results to FILE as they complete and\n");
+        fprintf(stdout, "                       skip the message sizes FILE marks completed.\n");
+        fprintf(stdout, "  -h, --help         : Print this help.\n");
+        fprintf(stdout, "  -v, --version      : Print version info.\n");
+        fprintf(stdout, "\n");
+        fflush(stdout);
+    }
+}
+
+void print_usage_pgas_pt2pt(int rank, const char * prog, const char * operands)
+{
+    if (rank == 0) {
+        int memory = PGAS_MEMORY_NONE != options.pgas_memory;
+
+        fprintf(stdout, " USAGE : %s [-m [MIN:]MAX] [-i ITER] [-x ITER] [-M SIZE]%s [-hv]%s%s\n",
+                prog, PGAS_NBC == options.subtype ? " [-t CALLS] [-K KIND[:SIZE]] [-f]" :
+                PGAS_MR_WINDOW == options.subtype || PGAS_BW == options.subtype ?
+                " [-W WINDOW] [-V]" : PGAS_COMPARE == options.subtype ?
+                " [-W WINDOW] [-F FORMAT]" : PGAS_DEVICE == options.subtype ?
+                " [-W WINDOW]" : "",
+                memory ? " <heap|global>" : "", operands);
+
+        if (memory) {
+            fprintf(stdout, "  heap|global        : Allocate the buffers on the symmetric heap or use\n");
+            fprintf(stdout, "                       global variables.\n");
+        }
+
+        fprintf(stdout, "  -m, --message-size : Set the minimum and/or the maximum message size to MIN\n");
+        fprintf(stdout, "                       and/or MAX bytes.  By default, MIN is %zu and MAX is %zu.\n",
+                options.min_message_size, options.max_message_size);
+        fprintf(stdout, "  -i, --iterations   : Set number of iterations per message size to ITER.\n");
+        fprintf(stdout, "                       By default, the value of ITER is %zu for small messages\n",
+                options.iterations);
+        fprintf(stdout, "                       and %zu for large messages.\n",
+                options.iterations_large);
+        fprintf(stdout, "  -x, --warmup       : Set number of warmup iterations per message size to ITER.\n");
+        fprintf(stdout, "                       By default, the value of ITER is %zu for small messages\n",
+                options.skip);
+        fprintf(stdout, "                       and %zu for large messages.\n",
+                options.skip_large);
+        fprintf(stdout, "  -M, --mem-limit    : Set maximum memory consumption (per process) to SIZE. \n");
+        fprintf(stdout, "                       By default, the value of SIZE is 512MB.\n");
+
+        if (PGAS_NBC == options.subtype) {
+            fprintf(stdout, "  -t, --num_test_calls : Split the computation into CALLS pieces with a\n");
+            fprintf(stdout, "                       progress call after each.  By default there are none.\n");
+            fprintf(stdout, "  -K, --compute-kernel : Host computation to overlap: dummy (default),\n");
+            fprintf(stdout, "                       triad[:BYTES], gemm[:N], omp-triad or omp-gemm, as for\n");
+            fprintf(stdout, "                       the MPI non-blocking collectives.\n");
+            fprintf(stdout, "  -f, --full         : Print the time of every phase.\n");
+        }
+
+        if (PGAS_MR_WINDOW == options.subtype || PGAS_BW == options.subtype) {
+            fprintf(stdout, "  -W, --window-size  : Set the number of messages in flight to WINDOW.\n");
+            fprintf(stdout, "                       By default, the value of WINDOW is %d.\n",
+                    options.window_size);
+            fprintf(stdout, "  -V, --vary-window  : Repeat the test for windows of 1 to 128 messages.\n");
+        }
+
+        if (PGAS_DEVICE == options.subtype) {
+            fprintf(stdout, "  -W, --window-size  : Set the number of non-blocking operations per\n");
+            fprintf(stdout, "                       completion of the bandwidth test to WINDOW.\n");
+            fprintf(stdout, "                       By default, the value of WINDOW is %d.\n",
+                    options.window_size);
+        }
+
+        if (PGAS_COMPARE == options.subtype) {
+            fprintf(stdout, "  -W, --window-size  : Set the number of gets in flight to WINDOW.\n");
+            fprintf(stdout, "                       By default, the value of WINDOW is %d.\n",
+                    options.window_size);
+            fprintf(stdout, "  -F, --output-format: Print results as FORMAT: table (default), csv or\n");
+            fprintf(stdout, "                       json (one object per line).\n");
+        }
+
+        fprintf(stdout, "  --timer NAME       : Clock of the timed loops: default (gettimeofday),\n");
+        fprintf(stdout, "                       monotonic (CLOCK_MONOTONIC_RAW) or cycles.\n");
+        fprintf(stdout, "  --baseline FILE    : Compare the results with the csv or json results in\n");
+        fprintf(stdout, "                       FILE and exit with an error on regressions.\n");
+        fprintf(stdout, "  --tolerance PCT    : Slowdown tolerated by --baseline (default %.0f%%).\n",
+                DEF_BASELINE_TOLERANCE);
+        fprintf(stdout, "  --fit              : Fit alpha-beta parameters per protocol regime to\n");
+        fprintf(stdout, "                       the results and print them at the end.\n");
+        fprintf(stdout, "  --checkpoint FILE  : Append the results to FILE as they complete and\n");
+        fprintf(stdout, "                       skip the message sizes FILE marks completed.\n");
         fprintf(stdout, "  -h, --help         : Print this help.\n");
         fprintf(stdout, "  -v, --version      : Print version info.\n");
         fprintf(stdout, "\n");
@@ -104,12 +239,123 @@ void print_usage_pgas(int rank, const char * prog, int has_size)
     }
 }
 
+/*
+ * Columns of the overlap tests, those of the MPI non-blocking collectives
+ * with INIT and WAIT naming the calls that start and complete the transfer.
+ */
+void print_header_overlap_pgas(int rank, const char * init, const char * wait)
+{
+    if (rank != 0) {
+        return;
+    }
+
+    fprintf(stdout, benchmark_header, "");
+
+    if (KERNEL_TRIAD == options.compute_kernel) {
+        fprintf(stdout, "# Compute: %s, %zu MB working set\n",
+                compute_kernel_name(), options.compute_size >> 20);
+    } else if (KERNEL_GEMM == options.compute_kernel) {
+        fprintf(stdout, "# Compute: %s, %zu x %zu doubles\n",
+                compute_kernel_name(), options.compute_size,
+                options.compute_size);
+    }
+
+    if (options.num_probes) {
+        fprintf(stdout, "# Progress: %d test calls in the compute\n",
+                options.num_probes);
+    }
+
+    fprintf(stdout, "# Overall = %s + Compute + Test + %s\n\n", init, wait);
+
+    fprintf(stdout, "%-*s%*s%*s", 10, "# Size", FIELD_WIDTH, "Overall(us)",
+            FIELD_WIDTH, "Compute(us)");
+
+    if (options.show_full) {
+        fprintf(stdout, "%*s(us)%*s(us)%*s(us)", FIELD_WIDTH - 4, init,
+                FIELD_WIDTH - 4, "Test", FIELD_WIDTH - 4, wait);
+    }
+
+    fprintf(stdout, "%*s%*s", FIELD_WIDTH, "Pure Comm.(us)", FIELD_WIDTH,
+            "Overlap(%)");
+
+    if (options.num_probes) {
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Slowdown(%)");
+    }
+
+    fprintf(stdout, "\n");
+    fflush(stdout);
+}
+
+/*
+ * Times in us per iteration.  CPU includes the test calls, which are an
+ * overhead and do not count as overlapped compute.
+ */
+void print_data_overlap_pgas(int rank, int size, double overall, double cpu,
+        double comm, double wait, double init, double test)
+{
+    double overlap, slowdown = host_compute_slowdown_local();
+
+    if (rank != 0) {
+        return;
+    }
+
+    overlap = MAX(0, 100 - (((overall - (cpu - test)) / comm) * 100));
+
+    fprintf(stdout, "%-*d%*.*f%*.*f", 10, size, FIELD_WIDTH, FLOAT_PRECISION,
+            overall, FIELD_WIDTH, FLOAT_PRECISION, cpu - test);
+
+    if (options.show_full) {
+        fprintf(stdout, "%*.*f%*.*f%*.*f", FIELD_WIDTH, FLOAT_PRECISION, init,
+                FIELD_WIDTH, FLOAT_PRECISION, test, FIELD_WIDTH,
+                FLOAT_PRECISION, wait);
+    }
+
+    fprintf(stdout, "%*.*f%*.*f", FIELD_WIDTH, FLOAT_PRECISION, comm,
+            FIELD_WIDTH, FLOAT_PRECISION, overlap);
+
+    if (options.num_probes) {
+        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, slowdown);
+    }
+
+    fprintf(stdout, "\n");
+    fflush(stdout);
+}
+
+void limit_message_size_pgas(int rank, size_t limit)
+{
+    if (options.max_message_size <= limit) {
+        return;
+    }
+
+    options.max_message_size = limit;
+
+    if (options.min_message_size > limit) {
+        options.min_message_size = limit;
+    }
+
+    if (rank == 0) {
+        fprintf(stderr, "Warning! Increase the Max Memory Limit to be able to "
+                "use larger messages.\nContinuing with messages up to %zu "
+                "bytes\n", limit);
+    }
+}
+
 void print_version_pgas(const char *header)
 {
     fprintf(stdout, header, "");
     fflush(stdout);
 }
 
+/* Adaptive size schedules are not available for the PGAS benchmarks */
+void agree_message_size (size_t * size)
+{
+}
+
+int checkpoint_num_ranks (void)
+{
+    return benchmark_num_ranks;
+}
+
 int process_one_sided_options (int opt, char *arg)
 {
     return PO_BAD_USAGE;
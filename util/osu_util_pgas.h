@@ -17,8 +17,27 @@
 #define MYBUFSIZE_MR (MAX_MESSAGE_SIZE * OSHM_LOOP_LARGE_MR + MESSAGE_ALIGNMENT_MR)
 #define SYNC_MODE (UPC_IN_ALLSYNC | UPC_OUT_ALLSYNC)
 
+/* Synchronization of the timed UPC collectives, as set with -s IN:OUT */
+#define COLL_SYNC_IN(mode) (PGAS_SYNC_NO == (mode) ? UPC_IN_NOSYNC : \
+        PGAS_SYNC_MY == (mode) ? UPC_IN_MYSYNC : UPC_IN_ALLSYNC)
+#define COLL_SYNC_OUT(mode) (PGAS_SYNC_NO == (mode) ? UPC_OUT_NOSYNC : \
+        PGAS_SYNC_MY == (mode) ? UPC_OUT_MYSYNC : UPC_OUT_ALLSYNC)
+#define COLL_SYNC_MODE (COLL_SYNC_IN(options.sync_in) | \
+        COLL_SYNC_OUT(options.sync_out))
+
 void usage_oshm_pt2pt(int myid);
 void print_header_pgas (const char *header, int rank, int full);
 void print_data_pgas (int rank, int full, int size, double avg_time, double min_time, double max_time, int iterations);
 void print_usage_pgas(int rank, const char * prog, int has_size);
+void print_usage_pgas_pt2pt(int rank, const char * prog, const char * operands);
 void print_version_pgas(const char *header);
+
+/*
+ * Cap options.max_message_size at limit bytes, the room one buffer of the
+ * point-to-point benchmarks has in global memory or under -M, with a warning.
+ */
+void limit_message_size_pgas(int rank, size_t limit);
+
+void print_header_overlap_pgas(int rank, const char * init, const char * wait);
+void print_data_overlap_pgas(int rank, int size, double overall, double cpu,
+        double comm, double wait, double init, double test);